@@ -15,6 +15,8 @@ set(onnxruntime_common_src_patterns
     "${ONNXRUNTIME_ROOT}/core/platform/env.cc"
     "${ONNXRUNTIME_ROOT}/core/platform/env_time.h"
     "${ONNXRUNTIME_ROOT}/core/platform/env_time.cc"
+    "${ONNXRUNTIME_ROOT}/core/platform/threadpool.h"
+    "${ONNXRUNTIME_ROOT}/core/platform/threadpool.cc"
 )
 
 if(WIN32)
@@ -41,7 +43,7 @@ if(NOT WIN32)
 	target_link_libraries(onnxruntime_common dl)
 endif()
 onnxruntime_add_include_to_target(onnxruntime_common gsl date)
-target_include_directories(onnxruntime_common PRIVATE ${ONNXRUNTIME_ROOT} PUBLIC "${CMAKE_CURRENT_SOURCE_DIR}/external/nsync/public")
+target_include_directories(onnxruntime_common PRIVATE ${ONNXRUNTIME_ROOT} ${eigen_INCLUDE_DIRS} PUBLIC "${CMAKE_CURRENT_SOURCE_DIR}/external/nsync/public")
 if(onnxruntime_USE_NSYNC)
     target_compile_definitions(onnxruntime_common PUBLIC USE_NSYNC)
 endif()
@@ -5,11 +5,18 @@ set(mlas_common_srcs
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/platform.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/threading.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/sgemm.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/qgemm.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/convolve.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/convtranspose.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/dwconv.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/snchwc.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/winograd.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/pooling.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/activate.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/compute.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/logistic.cpp
   ${ONNXRUNTIME_ROOT}/core/mlas/lib/tanh.cpp
+  ${ONNXRUNTIME_ROOT}/core/mlas/lib/cvtfp16.cpp
 )
 
 if (MSVC)
@@ -65,7 +72,19 @@ if (MSVC)
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/amd64/cvtfp16a.asm
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/amd64/LogisticKernelFma3.asm
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/amd64/TanhKernelFma3.asm
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/qgemm_kernel_avx2.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/snchwc_kernel_avx2.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/snchwc_kernel_avx512f.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/compute_kernel_avx2.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/compute_kernel_avx512f.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/cvtfp16_kernel_f16c.cpp
     )
+    set_source_files_properties(${ONNXRUNTIME_ROOT}/core/mlas/lib/qgemm_kernel_avx2.cpp PROPERTIES COMPILE_FLAGS "/arch:AVX2")
+    set_source_files_properties(${ONNXRUNTIME_ROOT}/core/mlas/lib/snchwc_kernel_avx2.cpp PROPERTIES COMPILE_FLAGS "/arch:AVX2")
+    set_source_files_properties(${ONNXRUNTIME_ROOT}/core/mlas/lib/snchwc_kernel_avx512f.cpp PROPERTIES COMPILE_FLAGS "/arch:AVX512")
+    set_source_files_properties(${ONNXRUNTIME_ROOT}/core/mlas/lib/compute_kernel_avx2.cpp PROPERTIES COMPILE_FLAGS "/arch:AVX2")
+    set_source_files_properties(${ONNXRUNTIME_ROOT}/core/mlas/lib/compute_kernel_avx512f.cpp PROPERTIES COMPILE_FLAGS "/arch:AVX512")
+    set_source_files_properties(${ONNXRUNTIME_ROOT}/core/mlas/lib/cvtfp16_kernel_f16c.cpp PROPERTIES COMPILE_FLAGS "/arch:AVX2")
 
   endif()
 
@@ -120,11 +139,21 @@ else()
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/SgemmKernelFma3.S
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/LogisticKernelFma3.S
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/TanhKernelFma3.S
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/qgemm_kernel_avx2.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/snchwc_kernel_avx2.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/compute_kernel_avx2.cpp
     )
     set_source_files_properties(${mlas_platform_srcs_avx2} PROPERTIES COMPILE_FLAGS "-mavx2 -mfma")
 
+    set(mlas_platform_srcs_f16c
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/cvtfp16_kernel_f16c.cpp
+    )
+    set_source_files_properties(${mlas_platform_srcs_f16c} PROPERTIES COMPILE_FLAGS "-mavx -mf16c")
+
     set(mlas_platform_srcs_avx512f
       ${ONNXRUNTIME_ROOT}/core/mlas/lib/x86_64/SgemmKernelAvx512F.S
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/snchwc_kernel_avx512f.cpp
+      ${ONNXRUNTIME_ROOT}/core/mlas/lib/compute_kernel_avx512f.cpp
     )
     set_source_files_properties(${mlas_platform_srcs_avx512f} PROPERTIES COMPILE_FLAGS "-mavx512f")
 
@@ -132,13 +161,32 @@ else()
       ${mlas_platform_srcs_sse2}
       ${mlas_platform_srcs_avx}
       ${mlas_platform_srcs_avx2}
+      ${mlas_platform_srcs_f16c}
       ${mlas_platform_srcs_avx512f}
     )
 
+    # The AVX512_VNNI kernels require a compiler that supports the instruction
+    # set extension. Older compilers fall back to the AVX2 kernels.
+
+    include(CheckCXXCompilerFlag)
+    check_cxx_compiler_flag("-mavx512vnni" HAS_AVX512VNNI)
+
+    if (HAS_AVX512VNNI)
+      set(mlas_platform_srcs_avx512vnni
+        ${ONNXRUNTIME_ROOT}/core/mlas/lib/qgemm_kernel_avx512vnni.cpp
+      )
+      set_source_files_properties(${mlas_platform_srcs_avx512vnni} PROPERTIES COMPILE_FLAGS "-mavx512f -mavx512bw -mavx512vl -mavx512vnni")
+      list(APPEND mlas_platform_srcs ${mlas_platform_srcs_avx512vnni})
+      set(mlas_private_compile_definitions MLAS_AVX512VNNI_SUPPORTED)
+    endif()
+
   endif()
 
 endif()
 
 add_library(onnxruntime_mlas STATIC ${mlas_common_srcs} ${mlas_platform_srcs})
-target_include_directories(onnxruntime_mlas PRIVATE ${ONNXRUNTIME_ROOT}/core/mlas/inc ${ONNXRUNTIME_ROOT}/core/mlas/lib)
+target_include_directories(onnxruntime_mlas PRIVATE ${ONNXRUNTIME_ROOT}/core/mlas/inc ${ONNXRUNTIME_ROOT}/core/mlas/lib ${ONNXRUNTIME_ROOT})
+target_compile_definitions(onnxruntime_mlas PRIVATE ${mlas_private_compile_definitions})
+#threading uses the onnxruntime thread pool
+target_link_libraries(onnxruntime_mlas onnxruntime_common)
 set_target_properties(onnxruntime_mlas PROPERTIES FOLDER "ONNXRuntime")
@@ -15,7 +15,3 @@ onnxruntime_add_include_to_target(onnxruntime_session onnxruntime_common onnxrun
 target_include_directories(onnxruntime_session PRIVATE ${ONNXRUNTIME_ROOT} ${eigen_INCLUDE_DIRS})
 add_dependencies(onnxruntime_session ${onnxruntime_EXTERNAL_DEPENDENCIES})
 set_target_properties(onnxruntime_session PROPERTIES FOLDER "ONNXRuntime")
-
-if(onnxruntime_USE_EIGEN_THREADPOOL)
-    target_compile_definitions(onnxruntime_session PUBLIC USE_EIGEN_THREADPOOL)
-endif()
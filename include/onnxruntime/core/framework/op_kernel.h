@@ -23,6 +23,9 @@ namespace onnxruntime {
 class ExecutionFrame;
 class OpKernelContext;
 class OpKernelWrapper;
+namespace concurrency {
+class ThreadPool;
+}
 
 class OpKernel {
  public:
@@ -46,6 +49,21 @@ class OpKernel {
     ORT_NOT_IMPLEMENTED(__FUNCTION__, " is not implemented");
   }
 
+  /**
+  Called once during session initialization for each input that is a constant initializer, after the kernel
+  is created. A kernel can override this to transform the tensor into the layout its Compute uses, such as
+  a packed weight matrix, instead of repeating the transformation on every run.
+  A feed can override an initializer, so Compute must only use the transformed copy when the input is still
+  backed by the same data.
+  @param tensor The constant initializer. It stays alive for the lifetime of the session.
+  @param input_idx The index of the input that is fed by the initializer.
+  @param is_packed Set to true if the kernel keeps its own transformed copy of the tensor.
+  */
+  virtual Status PrePack(const Tensor& /*tensor*/, int /*input_idx*/, bool& is_packed) {
+    is_packed = false;
+    return Status::OK();
+  }
+
   const OrtAllocatorInfo& Allocator(int id, OrtMemType mem_type) const {
     return op_kernel_info_.GetAllocatorInfo(id, mem_type);
   }
@@ -145,6 +163,13 @@ class OpKernelContext {
   */
   Fence_t OutputFence(int index) const;
 
+  /**
+  Return the thread pool to use for parallelizing the computation of the current node.
+  @returns Pointer to the intra-op thread pool of the session.
+  It is null if the computation should run on the calling thread only.
+  */
+  concurrency::ThreadPool* GetOperatorThreadPool() const;
+
  protected:
   onnxruntime::NodeIndex GetNodeIndex() const;
   const SessionState& GetSessionState() const;
@@ -97,6 +97,11 @@ class Tensor final {
   */
   const OrtAllocatorInfo& Location() const { return alloc_info_; }
 
+  /**
+     Returns true if the tensor owns its buffer, i.e. releases it when the tensor is released.
+  */
+  bool OwnsBuffer() const noexcept { return buffer_deleter_ != nullptr; }
+
   /**
      May return nullptr if tensor size is zero
   */
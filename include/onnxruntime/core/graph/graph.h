@@ -483,6 +483,10 @@ class Graph {
   /** Gets all the initializer tensors in this Graph. */
   const InitializedTensorSet& GetAllInitializedTensors() const noexcept;
 
+  /** Releases the raw data held by the initializer tensor with the provided name.
+  The TensorProto itself (name, type and shape) is kept. Only call this once the data has been copied elsewhere. */
+  void ReleaseInitializedTensorData(const std::string& tensor_name);
+
   /** Removes all initializer tensors from this Graph and releases the memory they were using. */
   void CleanAllInitializedTensors() noexcept;
 
@@ -142,6 +142,8 @@ ORT_RUNTIME_CLASS(RunOptions);
 ORT_RUNTIME_CLASS(TypeInfo);
 ORT_RUNTIME_CLASS(TensorTypeAndShapeInfo);
 ORT_RUNTIME_CLASS(SessionOptions);
+ORT_RUNTIME_CLASS(BatchingSession);
+ORT_RUNTIME_CLASS(IoBinding);
 
 // When passing in an allocator to any ORT function, be sure that the allocator object
 // is not destroyed until the last allocated object using it is freed.
@@ -152,10 +154,29 @@ typedef struct OrtAllocator {
   const struct OrtAllocatorInfo*(ORT_API_CALL* Info)(const struct OrtAllocator* this_);
 } OrtAllocator;
 
+// Statistics of an arena allocator, see OrtSessionGetAllocatorStats.
+typedef struct OrtAllocatorStats {
+  int64_t num_allocs;             // Number of allocations, including the ones served by the thread caches.
+  int64_t bytes_in_use;           // Number of bytes handed out to callers.
+  int64_t max_bytes_in_use;       // The peak of bytes_in_use.
+  int64_t total_allocated_bytes;  // Number of bytes reserved from the device.
+  int64_t bytes_limit;            // Upper bound of total_allocated_bytes.
+  int64_t num_cache_hits;         // Allocations served by a per-thread cache.
+  int64_t num_cache_misses;       // Cacheable allocations that fell through to the arena.
+  int64_t bytes_cached;           // Bytes currently parked in per-thread caches.
+  double fragmentation;           // 1 - bytes_in_use / total_allocated_bytes, 0 if nothing was allocated.
+} OrtAllocatorStats;
+
 typedef void(ORT_API_CALL* OrtLoggingFunction)(
     void* param, OrtLoggingLevel severity, const char* category, const char* logid, const char* code_location,
     const char* message);
 
+// Called when an asynchronous run completes. status is nullptr on success. The callee owns status and
+// the values in outputs and must free them with OrtReleaseStatus and OrtReleaseValue. The outputs array
+// itself is only valid during the call. outputs is nullptr on failure.
+typedef void(ORT_API_CALL* OrtRunCallback)(
+    void* user_data, OrtStatus* status, OrtValue** outputs, size_t num_outputs);
+
 /**
  * \param out Should be freed by `OrtReleaseEnv` after use
  */
@@ -170,6 +191,11 @@ ORT_API_STATUS(OrtCreateEnvWithCustomLogger, OrtLoggingFunction logging_function
                _In_ const char* logid,
                _Out_ OrtEnv** out);
 
+// Cap the instruction set used by the CPU kernels of the whole process at isa_level: "generic", "avx", "avx2",
+// "avx512f" or "avx512vnni". Meant for comparing the kernel variants on one machine. The MLAS_ISA_LEVEL environment
+// variable sets the initial level the same way. Fails if this changes the level while any session exists.
+ORT_API_STATUS(OrtSetMlasIsaLevel, _In_ const char* isa_level) ORT_ALL_ARGS_NONNULL;
+
 // TODO: document the path separator convention? '/' vs '\'
 // TODO: should specify the access characteristics of model_path. Is this read only during the
 // execution of OrtCreateSession, or does the OrtSession retain a handle to the file/directory
@@ -184,6 +210,72 @@ ORT_API_STATUS(OrtRun, _Inout_ OrtSession* sess,
                _In_ const char* const* input_names, _In_ const OrtValue* const* input, size_t input_len,
                _In_ const char* const* output_names, size_t output_names_len, _Out_ OrtValue** output);
 
+/**
+ * Run the session asynchronously on its thread pool. Returns once the run is queued.
+ * If this returns success, callback is called exactly once on a thread of the pool with the outputs in the
+ * order of output_names. The inputs must not be released or modified until then, and the callback must
+ * not release the session. OrtReleaseSession waits for the pending runs.
+ * \param run_options Optional. Must stay alive until the callback is called. OrtRunOptionsSetTerminate stops the run,
+ * including one that hasn't started yet.
+ */
+ORT_API_STATUS(OrtRunAsync, _Inout_ OrtSession* sess, _In_opt_ OrtRunOptions* run_options,
+               _In_ const char* const* input_names, _In_ const OrtValue* const* input, size_t input_len,
+               _In_ const char* const* output_names, size_t output_names_len,
+               _In_ OrtRunCallback callback, _In_opt_ void* user_data);
+/**
+ * Batch the requests to a session. Requests submitted with OrtBatchingSessionSubmit are queued, and
+ * compatible requests are concatenated along dim 0 and run together once max_batch_size rows are queued
+ * or the oldest request has waited for batch_timeout_micros microseconds.
+ * \param sess Must outlive the batching session.
+ * \param out Should be freed by `OrtReleaseBatchingSession` after use. Queued requests are run before it returns.
+ */
+ORT_API_STATUS(OrtCreateBatchingSession, _In_ OrtSession* sess, size_t max_batch_size, int64_t batch_timeout_micros,
+               _Out_ OrtBatchingSession** out);
+
+/**
+ * Queue a request. If this returns success, callback is called exactly once on the scheduler thread of the
+ * batching session with the outputs in the order of output_names. The inputs must not be released or
+ * modified until then. The scheduler doesn't run another batch until the callback returns.
+ */
+ORT_API_STATUS(OrtBatchingSessionSubmit, _Inout_ OrtBatchingSession* sess,
+               _In_ const char* const* input_names, _In_ const OrtValue* const* input, size_t input_len,
+               _In_ const char* const* output_names, size_t output_names_len,
+               _In_ OrtRunCallback callback, _In_opt_ void* user_data);
+
+/**
+ * Bind the inputs and outputs of a session by name once and run it repeatedly with OrtRunWithBinding.
+ * A bound output is written in place by the run, so binding a tensor created with
+ * OrtCreateTensorWithDataAsOrtValue over a caller owned buffer avoids allocating and copying the outputs.
+ * \param sess Must outlive the binding.
+ * \param out Should be freed by `OrtReleaseIoBinding` after use
+ */
+ORT_API_STATUS(OrtCreateIoBinding, _In_ OrtSession* sess, _Out_ OrtIoBinding** out);
+
+/**
+ * Bind an input, replacing the value previously bound to the same name. The binding shares the tensor of value,
+ * so new data written to its buffer is used by the next run without binding it again.
+ */
+ORT_API_STATUS(OrtBindInput, _Inout_ OrtIoBinding* binding, _In_ const char* name, _In_ const OrtValue* value);
+
+/**
+ * Bind an output, replacing the value previously bound to the same name. The run writes the output into
+ * value, whose shape must match the output's.
+ * \param value Optional. If null, the first run allocates the output and the following runs reuse it, so its
+ * shape must not change between runs unless the output is bound again.
+ */
+ORT_API_STATUS(OrtBindOutput, _Inout_ OrtIoBinding* binding, _In_ const char* name, _In_opt_ const OrtValue* value);
+
+ORT_API_STATUS(OrtRunWithBinding, _Inout_ OrtSession* sess, _In_opt_ OrtRunOptions* run_options,
+               _Inout_ OrtIoBinding* binding);
+
+/**
+ * Get the outputs of the last OrtRunWithBinding in the order they were first bound.
+ * \param output_len Must be the number of bound outputs.
+ * \param output Each value should be freed by `OrtReleaseValue` after use. It shares the buffer of the bound
+ * output, which the next run overwrites.
+ */
+ORT_API_STATUS(OrtGetBoundOutputValues, _In_ OrtIoBinding* binding, _Out_ OrtValue** output, size_t output_len);
+
 /**
  * \return A pointer of the newly created object. The pointer should be freed by OrtReleaseSessionOptions after use
  */
@@ -198,6 +290,12 @@ ORT_API(void, OrtDisableSequentialExecution, _In_ OrtSessionOptions* options);
 ORT_API(void, OrtEnableProfiling, _In_ OrtSessionOptions* options, _In_ const char* profile_file_prefix);
 ORT_API(void, OrtDisableProfiling, _In_ OrtSessionOptions* options);
 
+// Keep latency histograms of every op type and run and the mean and maximum latency of every node, see
+// OrtSessionGetMetrics.
+// Unlike profiling, this is cheap enough to leave on in production.
+ORT_API(void, OrtEnableMetrics, _In_ OrtSessionOptions* options);
+ORT_API(void, OrtDisableMetrics, _In_ OrtSessionOptions* options);
+
 // Enable the memory pattern optimization.
 // The idea is if the input shapes are the same, we could trace the internal memory allocation
 // and generate a memory pattern for future request. So next time we could just do one allocation
@@ -211,6 +309,19 @@ ORT_API(void, OrtDisableMemPattern, _In_ OrtSessionOptions* options);
 ORT_API(void, OrtEnableCpuMemArena, _In_ OrtSessionOptions* options);
 ORT_API(void, OrtDisableCpuMemArena, _In_ OrtSessionOptions* options);
 
+// Put a per-thread cache of small blocks in front of the CPU memory arena.
+// This reduces contention on the arena lock when several threads allocate concurrently.
+// Has no effect if the CPU memory arena is disabled.
+ORT_API(void, OrtEnableCpuMemArenaThreadCache, _In_ OrtSessionOptions* options);
+ORT_API(void, OrtDisableCpuMemArenaThreadCache, _In_ OrtSessionOptions* options);
+
+// Cache the model after graph optimization and partitioning in the file at cache_path.
+// If the file was written for the same model and configuration, session initialization loads it
+// and skips those steps. Otherwise the model is optimized as usual and the file is (re)written.
+// Only models loaded from a file are cached, as they are identified by the path, size and modification time of it.
+ORT_API(void, OrtEnableOptimizedModelCache, _In_ OrtSessionOptions* options, _In_ const char* cache_path);
+ORT_API(void, OrtDisableOptimizedModelCache, _In_ OrtSessionOptions* options);
+
 // < logger id to use for session output
 ORT_API(void, OrtSetSessionLogId, _In_ OrtSessionOptions* options, const char* logid);
 
@@ -220,6 +331,22 @@ ORT_API(void, OrtSetSessionLogVerbosityLevel, _In_ OrtSessionOptions* options, u
 // How many threads in the session thread pool.
 ORT_API(int, OrtSetSessionThreadPoolSize, _In_ OrtSessionOptions* options, int session_thread_pool_size);
 
+// How many threads are used to parallelize the execution within a node, including the thread calling OrtRun.
+// 0 uses the number of cores on the machine. 1 disables the parallelism within nodes.
+// Returns 0 on success, -1 if intra_op_num_threads is negative.
+ORT_API(int, OrtSetIntraOpNumThreads, _In_ OrtSessionOptions* options, int intra_op_num_threads);
+
+// Pin the intra-op worker threads to the given logical processors. Worker i is pinned to
+// processor_ids[i % processor_id_count]. Pass processor_id_count 0 to clear the affinity.
+// Returns 0 on success, -1 if processor_ids is null while processor_id_count is not 0.
+ORT_API(int, OrtSetIntraOpThreadAffinity, _In_ OrtSessionOptions* options,
+        _In_opt_ const size_t* processor_ids, size_t processor_id_count);
+
+// How many threads run independent branches of the graph concurrently when sequential execution is enabled,
+// including the thread calling OrtRun. 0 or 1 runs all the nodes on the calling thread.
+// Returns 0 on success, -1 if branch_parallel_num_threads is negative.
+ORT_API(int, OrtSetBranchParallelNumThreads, _In_ OrtSessionOptions* options, int branch_parallel_num_threads);
+
 /**
   * To use additional providers, you must build ORT with the extra providers enabled. Then call one of these
   * functions to enable them in the session:
@@ -254,6 +381,27 @@ ORT_API_STATUS(OrtSessionGetInputName, _In_ const OrtSession* sess, size_t index
 ORT_API_STATUS(OrtSessionGetOutputName, _In_ const OrtSession* sess, size_t index,
                _Inout_ OrtAllocator* allocator, _Out_ char** value);
 
+/**
+ * Get the statistics of the session arena matching 'info', e.g. the one created by OrtCreateCpuAllocatorInfo.
+ * Fails if the session has no arena for 'info'.
+ */
+ORT_API_STATUS(OrtSessionGetAllocatorStats, _In_ const OrtSession* sess, _In_ const OrtAllocatorInfo* info,
+               _Out_ OrtAllocatorStats* out);
+
+/**
+ * Get the metrics collected since the session was created or OrtSessionResetMetrics was last called, as a JSON
+ * object: the latency percentiles of the runs and of every op type and the mean and maximum latency of every node
+ * in microseconds, the memory pattern cache hits and the usage of every arena. Fails if the metrics weren't enabled by OrtEnableMetrics.
+ * \param value  is set to a null terminated string allocated using 'allocator'. The caller is responsible in freeing it.
+ */
+ORT_API_STATUS(OrtSessionGetMetrics, _In_ const OrtSession* sess, _Inout_ OrtAllocator* allocator,
+               _Out_ char** value);
+
+/**
+ * Clear the latencies and counters collected so far. The peak arena usage isn't reset.
+ */
+ORT_API_STATUS(OrtSessionResetMetrics, _Inout_ OrtSession* sess);
+
 /**
  * \return A pointer to the newly created object. The pointer should be freed by OrtReleaseRunOptions after use
  */
@@ -7,6 +7,7 @@
 #include <string>
 #include <stdexcept>
 #include <memory>
+#include <future>
 
 //TODO: encode error code in the message?
 #define ORT_THROW_ON_ERROR(expr)                                       \
@@ -66,6 +67,20 @@ struct default_delete<OrtSessionOptions> {
     OrtReleaseSessionOptions(ptr);
   }
 };
+
+template <>
+struct default_delete<OrtValue> {
+  void operator()(OrtValue* ptr) {
+    OrtReleaseValue(ptr);
+  }
+};
+
+template <>
+struct default_delete<OrtBatchingSession> {
+  void operator()(OrtBatchingSession* ptr) {
+    OrtReleaseBatchingSession(ptr);
+  }
+};
 }  // namespace std
 
 namespace onnxruntime {
@@ -83,13 +98,21 @@ class SessionOptionsWrapper {
   ORT_REDIRECT_SIMPLE_FUNCTION_CALL(EnableSequentialExecution)
   ORT_REDIRECT_SIMPLE_FUNCTION_CALL(DisableSequentialExecution)
   ORT_REDIRECT_SIMPLE_FUNCTION_CALL(DisableProfiling)
+  ORT_REDIRECT_SIMPLE_FUNCTION_CALL(EnableMetrics)
+  ORT_REDIRECT_SIMPLE_FUNCTION_CALL(DisableMetrics)
   ORT_REDIRECT_SIMPLE_FUNCTION_CALL(EnableMemPattern)
   ORT_REDIRECT_SIMPLE_FUNCTION_CALL(DisableMemPattern)
   ORT_REDIRECT_SIMPLE_FUNCTION_CALL(EnableCpuMemArena)
   ORT_REDIRECT_SIMPLE_FUNCTION_CALL(DisableCpuMemArena)
+  ORT_REDIRECT_SIMPLE_FUNCTION_CALL(EnableCpuMemArenaThreadCache)
+  ORT_REDIRECT_SIMPLE_FUNCTION_CALL(DisableCpuMemArenaThreadCache)
+  ORT_REDIRECT_SIMPLE_FUNCTION_CALL(DisableOptimizedModelCache)
   void EnableProfiling(_In_ const char* profile_file_prefix) {
     OrtEnableProfiling(value.get(), profile_file_prefix);
   }
+  void EnableOptimizedModelCache(_In_ const char* cache_path) {
+    OrtEnableOptimizedModelCache(value.get(), cache_path);
+  }
 
   void SetSessionLogId(const char* logid) {
     OrtSetSessionLogId(value.get(), logid);
@@ -100,6 +123,15 @@ class SessionOptionsWrapper {
   void SetSessionThreadPoolSize(int session_thread_pool_size) {
     OrtSetSessionThreadPoolSize(value.get(), session_thread_pool_size);
   }
+  void SetIntraOpNumThreads(int intra_op_num_threads) {
+    OrtSetIntraOpNumThreads(value.get(), intra_op_num_threads);
+  }
+  void SetIntraOpThreadAffinity(const size_t* processor_ids, size_t processor_id_count) {
+    OrtSetIntraOpThreadAffinity(value.get(), processor_ids, processor_id_count);
+  }
+  void SetBranchParallelNumThreads(int branch_parallel_num_threads) {
+    OrtSetBranchParallelNumThreads(value.get(), branch_parallel_num_threads);
+  }
 
   SessionOptionsWrapper clone() const {
     OrtSessionOptions* p = OrtCloneSessionOptions(value.get());
@@ -134,6 +166,44 @@ inline OrtValue* OrtCreateTensorWithDataAsOrtValue(_In_ const OrtAllocatorInfo*
   return ret;
 }
 
+inline OrtAllocatorStats GetAllocatorStats(_In_ const OrtSession* sess, _In_ const OrtAllocatorInfo* info) {
+  OrtAllocatorStats ret;
+  ORT_THROW_ON_ERROR(::OrtSessionGetAllocatorStats(sess, info, &ret));
+  return ret;
+}
+
+namespace detail {
+using RunAsyncPromise = std::promise<std::vector<std::unique_ptr<OrtValue>>>;
+
+inline void ORT_API_CALL RunAsyncCallback(void* user_data, OrtStatus* status, OrtValue** outputs, size_t num_outputs) {
+  std::unique_ptr<RunAsyncPromise> promise(static_cast<RunAsyncPromise*>(user_data));
+  if (status != nullptr) {
+    std::string ort_error_message = OrtGetErrorMessage(status);
+    OrtReleaseStatus(status);
+    promise->set_exception(std::make_exception_ptr(std::runtime_error(ort_error_message)));
+    return;
+  }
+  std::vector<std::unique_ptr<OrtValue>> values(num_outputs);
+  for (size_t i = 0; i != num_outputs; ++i) {
+    values[i].reset(outputs[i]);
+  }
+  promise->set_value(std::move(values));
+}
+}  // namespace detail
+
+// Run the session asynchronously, see OrtRunAsync. The future throws std::runtime_error if the run failed.
+inline std::future<std::vector<std::unique_ptr<OrtValue>>> RunAsync(
+    _Inout_ OrtSession* sess, _In_opt_ OrtRunOptions* run_options,
+    _In_ const char* const* input_names, _In_ const OrtValue* const* input, size_t input_len,
+    _In_ const char* const* output_names, size_t output_names_len) {
+  auto promise = std::make_unique<detail::RunAsyncPromise>();
+  auto future = promise->get_future();
+  ORT_THROW_ON_ERROR(::OrtRunAsync(sess, run_options, input_names, input, input_len, output_names, output_names_len,
+                                   detail::RunAsyncCallback, promise.get()));
+  promise.release();  // owned by the callback
+  return future;
+}
+
 inline std::vector<int64_t> GetTensorShape(const OrtTensorTypeAndShapeInfo* info) {
   size_t dims = OrtGetNumOfDimensions(info);
   std::vector<int64_t> ret(dims);
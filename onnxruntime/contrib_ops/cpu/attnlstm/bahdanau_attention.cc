@@ -3,6 +3,7 @@
 
 #include "bahdanau_attention.h"
 #include "core/providers/cpu/rnn/rnn_helpers.h"
+#include "core/mlas/inc/mlas.h"
 
 #include <stdexcept>
 #include <memory.h>
@@ -81,26 +82,8 @@ void BahdanauAttention<T>::PrepareMemory(
 
 template <typename T>
 static void SoftmaxInplace(const gsl::span<T>& alignments) {
-  T* x = alignments.data();
-  size_t len = alignments.size();
-
-  double sum = 0.0;
-
-  for (size_t i = 0; i < len; i++) {
-    T e = exp(x[i]);
-    sum += e;
-    x[i] = e;
-  }
-
-  if (sum == 0.0) {
-    for (size_t i = 0; i < len; i++) {
-      x[i] = static_cast<T>(1.0 / len);
-    }
-  } else {
-    for (size_t i = 0; i < len; i++) {
-      x[i] = static_cast<T>(x[i] / sum);
-    }
-  }
+  // offsets the row by its maximum before the exponentials, so large scores can't overflow
+  MlasComputeSoftmax(alignments.data(), alignments.data(), 1, alignments.size(), false, nullptr);
 }
 
 /**
@@ -142,16 +125,16 @@ void BahdanauAttention<T>::Compute(
     }
 
     SoftmaxInplace(gsl::span<T>{alignments, mem_steps});
-
-    // Calculate the context
-    auto outspan = output.subspan(b * memory_depth_);
-    auto values = values_.subspan(b * max_memory_steps_ * memory_depth_);
-    math::GemmEx<T, CPUMathUtil>(CblasNoTrans, CblasNoTrans,
-                                 1, memory_depth_, max_memory_steps_, T{1.0},
-                                 alignments, max_memory_steps_,
-                                 values.data(), memory_depth_, T{0.0},
-                                 outspan.data(), memory_depth_, &CPUMathUtil::Instance());
   }
+
+  // Calculate the context of every batch in a single batched GEMM:
+  // output[b] = aligns[b] * values[b], where steps past the memory sequence length have zero alignment
+  math::GemmBatched<T, CPUMathUtil>(CblasNoTrans, CblasNoTrans,
+                                    batch_size_ * max_memory_steps_, batch_size_,
+                                    batch_size_ * max_memory_steps_ * memory_depth_, batch_size_,
+                                    1, memory_depth_, max_memory_steps_, 1.0f,
+                                    aligns.data(), values_.data(), 0.0f,
+                                    output.data(), &CPUMathUtil::Instance());
 }
 
 template class BahdanauAttention<float>;
@@ -45,11 +45,7 @@ UniDirectionalAttnLstm<T>::UniDirectionalAttnLstm(AllocatorPtr allocator,
                                                   const ActivationFuncs::Entry& activation_func_g,
                                                   const ActivationFuncs::Entry& activation_func_h,
                                                   const float clip,
-#ifdef USE_EIGEN_THREADPOOL
-                                                  Eigen::NonBlockingThreadPool& ttp)
-#else
-                                                  TaskThreadPool& ttp)
-#endif
+                                                  concurrency::ThreadPool* ttp)
     : allocator_(allocator),
       logger_(logger),
       seq_length_(seq_length),
@@ -476,10 +472,7 @@ void UniDirectionalAttnLstm<T>::GateComputations(span_T_iter& out, span_T_iter&
 
 template <typename T>
 void UniDirectionalAttnLstm<T>::SetNumThreads() {
-  int threads = std::thread::hardware_concurrency() - 1;
-
-  if (threads < 1)
-    threads = 1;
+  int threads = ttp_ != nullptr ? ttp_->NumThreads() + 1 : 1;
 
   int hmt = threads;
   batch_parallel_ = false;
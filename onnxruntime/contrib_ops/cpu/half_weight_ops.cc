@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/cpu/math/gemm.h"
+#include "core/providers/cpu/math/matmul.h"
+#include "core/providers/cpu/nn/conv_impl.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// The float kernels accept a half precision weight: PrePack packs a constant one for MlasSgemmPackedBHalf
+// (or widens a Winograd filter), and any other half precision weight is widened to float at run time.
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    MatMulHalfWeight,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>())
+        .TypeConstraint("T1", DataTypeImpl::GetTensorType<MLFloat16>()),
+    MatMul<float>);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    GemmHalfWeight,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>())
+        .TypeConstraint("T1", DataTypeImpl::GetTensorType<MLFloat16>()),
+    Gemm<float, float, float, float>);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    ConvHalfWeight,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>())
+        .TypeConstraint("T1", DataTypeImpl::GetTensorType<MLFloat16>()),
+    Conv<float>);
+
+}  // namespace contrib
+}  // namespace onnxruntime
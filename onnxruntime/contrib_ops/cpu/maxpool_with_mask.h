@@ -9,6 +9,7 @@
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/tensor.h"
+#include "core/platform/threadpool.h"
 #include "core/providers/cpu/nn/pool_base.h"
 
 namespace onnxruntime {
@@ -38,6 +39,7 @@ class MaxpoolWithMask : public OpKernel, public PoolBase {
     const float* X_data = X->template Data<float>();
     const int32_t* M_data = M->template Data<int32_t>();
     float* Y_data = Y->template MutableData<float>();
+    concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
 
     // The main loop
     int64_t channels = x_shape[1];
@@ -54,27 +56,27 @@ class MaxpoolWithMask : public OpKernel, public PoolBase {
         int64_t y_step = pooled_height;
         const int64_t total_channels = x_shape[0] * channels;
         const int64_t total_mask_channels = m_shape[0] * m_shape[1];
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-        for (int64_t c = 0; c < total_channels; ++c) {
-          const float* x_d = X_data + c * x_step;
-          const int32_t* m_d = M_data + (c * x_step) % total_mask_channels;
-          float* y_d = Y_data + c * y_step;
-          for (int64_t ph = 0; ph < pooled_height; ++ph) {
-            int64_t hstart = ph * stride_h() - pads[0];
-            int64_t hend = std::min(hstart + kernel_shape[0], height);
-            hstart = std::max(hstart, static_cast<int64_t>(0));
-            float Yh = std::numeric_limits<float>::lowest();
-            for (int64_t h = hstart; h < hend; ++h) {
-              if (h >= 0 && m_d[h] == 0) break;  // if mask == 0, stop
-              if (x_d[h] > Yh) {
-                Yh = x_d[h];
+        auto pool_channels = [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (int64_t c = first; c < last; ++c) {
+            const float* x_d = X_data + c * x_step;
+            const int32_t* m_d = M_data + (c * x_step) % total_mask_channels;
+            float* y_d = Y_data + c * y_step;
+            for (int64_t ph = 0; ph < pooled_height; ++ph) {
+              int64_t hstart = ph * stride_h() - pads[0];
+              int64_t hend = std::min(hstart + kernel_shape[0], height);
+              hstart = std::max(hstart, static_cast<int64_t>(0));
+              float Yh = std::numeric_limits<float>::lowest();
+              for (int64_t h = hstart; h < hend; ++h) {
+                if (h >= 0 && m_d[h] == 0) break;  // if mask == 0, stop
+                if (x_d[h] > Yh) {
+                  Yh = x_d[h];
+                }
               }
+              y_d[ph] = Yh;
             }
-            y_d[ph] = Yh;
           }
-        }
+        };
+        concurrency::ThreadPool::TryParallelFor(thread_pool, 0, total_channels, 1, pool_channels);
 
         break;
       }
@@ -84,37 +86,37 @@ class MaxpoolWithMask : public OpKernel, public PoolBase {
         int64_t y_step = pooled_height * pooled_width;
         const int64_t total_channels = x_shape[0] * channels;
         const int64_t total_mask_channels = m_shape[0] * m_shape[1];
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-        for (int64_t c = 0; c < total_channels; ++c) {
-          const float* x_d = X_data + c * x_step;
-          const int32_t* m_d = M_data + (c * x_step) % total_mask_channels;
-          float* y_d = Y_data + c * y_step;
-
-          for (int64_t ph = 0; ph < pooled_height; ++ph) {
-            int64_t hstart = ph * stride_h() - pads[0];
-            int64_t hend = std::min(hstart + kernel_shape[0], height);
-            hstart = std::max(hstart, static_cast<int64_t>(0));
-            for (int64_t pw = 0; pw < pooled_width; ++pw) {
-              int64_t wstart = pw * stride_w() - pads[1];
-              int64_t wend = std::min(wstart + kernel_shape[1], width);
-              wstart = std::max(wstart, static_cast<int64_t>(0));
-              const int64_t pool_index = ph * pooled_width + pw;
-              float Yh = std::numeric_limits<float>::lowest();
-              for (int64_t h = hstart; h < hend; ++h) {
-                for (int64_t w = wstart; w < wend; ++w) {
-                  const int64_t input_index = h * width + w;
-                  if (input_index > 0 && m_d[input_index] == 0) break;  // if mask == 0, break
-                  if (x_d[input_index] > Yh) {
-                    Yh = x_d[input_index];
+        auto pool_channels = [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (int64_t c = first; c < last; ++c) {
+            const float* x_d = X_data + c * x_step;
+            const int32_t* m_d = M_data + (c * x_step) % total_mask_channels;
+            float* y_d = Y_data + c * y_step;
+
+            for (int64_t ph = 0; ph < pooled_height; ++ph) {
+              int64_t hstart = ph * stride_h() - pads[0];
+              int64_t hend = std::min(hstart + kernel_shape[0], height);
+              hstart = std::max(hstart, static_cast<int64_t>(0));
+              for (int64_t pw = 0; pw < pooled_width; ++pw) {
+                int64_t wstart = pw * stride_w() - pads[1];
+                int64_t wend = std::min(wstart + kernel_shape[1], width);
+                wstart = std::max(wstart, static_cast<int64_t>(0));
+                const int64_t pool_index = ph * pooled_width + pw;
+                float Yh = std::numeric_limits<float>::lowest();
+                for (int64_t h = hstart; h < hend; ++h) {
+                  for (int64_t w = wstart; w < wend; ++w) {
+                    const int64_t input_index = h * width + w;
+                    if (input_index > 0 && m_d[input_index] == 0) break;  // if mask == 0, break
+                    if (x_d[input_index] > Yh) {
+                      Yh = x_d[input_index];
+                    }
                   }
                 }
+                y_d[pool_index] = Yh;
               }
-              y_d[pool_index] = Yh;
             }
           }
-        }
+        };
+        concurrency::ThreadPool::TryParallelFor(thread_pool, 0, total_channels, 1, pool_channels);
         break;
       }
       case 3: {
@@ -122,45 +124,45 @@ class MaxpoolWithMask : public OpKernel, public PoolBase {
         int64_t y_step = pooled_height * pooled_width * pooled_depth;
         const int64_t total_channels = x_shape[0] * channels;
         const int64_t total_mask_channels = m_shape[0] * m_shape[1];
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-        for (int64_t c = 0; c < total_channels; ++c) {
-          const float* x_d = X_data + c * x_step;
-          const int32_t* m_d = M_data + (c * x_step) % total_mask_channels;
-          float* y_d = Y_data + c * y_step;
-
-          for (int64_t ph = 0; ph < pooled_height; ++ph) {
-            int64_t hstart = ph * stride_h() - pads[0];
-            int64_t hend = std::min(hstart + kernel_shape[0], height);
-            hstart = std::max(hstart, static_cast<int64_t>(0));
-            for (int64_t pw = 0; pw < pooled_width; ++pw) {
-              int64_t wstart = pw * stride_w() - pads[1];
-              int64_t wend = std::min(wstart + kernel_shape[1], width);
-              wstart = std::max(wstart, static_cast<int64_t>(0));
-              for (int64_t pd = 0; pd < pooled_depth; ++pd) {
-                int64_t dstart = pd * stride_d() - pads[2];
-                int64_t dend = std::min(dstart + kernel_shape[2], depth);
-                dstart = std::max(dstart, static_cast<int64_t>(0));
-                const int64_t pool_index =
-                    ph * pooled_width * pooled_depth + pw * pooled_depth + pd;
-                float Yh = std::numeric_limits<float>::lowest();
-                for (int64_t h = hstart; h < hend; ++h) {
-                  for (int64_t w = wstart; w < wend; ++w) {
-                    for (int64_t d = dstart; d < dend; ++d) {
-                      const int64_t input_index = h * width * depth + w * depth + d;
-                      if (input_index > 0 && m_d[input_index] == 0) break;  // if mask == 0, break
-                      if (x_d[input_index] > Yh) {
-                        Yh = x_d[input_index];
+        auto pool_channels = [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (int64_t c = first; c < last; ++c) {
+            const float* x_d = X_data + c * x_step;
+            const int32_t* m_d = M_data + (c * x_step) % total_mask_channels;
+            float* y_d = Y_data + c * y_step;
+
+            for (int64_t ph = 0; ph < pooled_height; ++ph) {
+              int64_t hstart = ph * stride_h() - pads[0];
+              int64_t hend = std::min(hstart + kernel_shape[0], height);
+              hstart = std::max(hstart, static_cast<int64_t>(0));
+              for (int64_t pw = 0; pw < pooled_width; ++pw) {
+                int64_t wstart = pw * stride_w() - pads[1];
+                int64_t wend = std::min(wstart + kernel_shape[1], width);
+                wstart = std::max(wstart, static_cast<int64_t>(0));
+                for (int64_t pd = 0; pd < pooled_depth; ++pd) {
+                  int64_t dstart = pd * stride_d() - pads[2];
+                  int64_t dend = std::min(dstart + kernel_shape[2], depth);
+                  dstart = std::max(dstart, static_cast<int64_t>(0));
+                  const int64_t pool_index =
+                      ph * pooled_width * pooled_depth + pw * pooled_depth + pd;
+                  float Yh = std::numeric_limits<float>::lowest();
+                  for (int64_t h = hstart; h < hend; ++h) {
+                    for (int64_t w = wstart; w < wend; ++w) {
+                      for (int64_t d = dstart; d < dend; ++d) {
+                        const int64_t input_index = h * width * depth + w * depth + d;
+                        if (input_index > 0 && m_d[input_index] == 0) break;  // if mask == 0, break
+                        if (x_d[input_index] > Yh) {
+                          Yh = x_d[input_index];
+                        }
                       }
                     }
                   }
+                  y_d[pool_index] = Yh;
                 }
-                y_d[pool_index] = Yh;
               }
             }
           }
-        }
+        };
+        concurrency::ThreadPool::TryParallelFor(thread_pool, 0, total_channels, 1, pool_channels);
         break;
       }
       default:
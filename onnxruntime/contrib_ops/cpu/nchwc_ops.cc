@@ -0,0 +1,198 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "nchwc_ops.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    ReorderInput,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    ReorderInput);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    ReorderOutput,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    ReorderOutput);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NchwcConv,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NchwcConv);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NchwcMaxPool,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NchwcPool);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NchwcAveragePool,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NchwcPool);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NchwcGlobalMaxPool,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NchwcPool);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NchwcGlobalAveragePool,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NchwcPool);
+
+static Status ValidateNchwcShape(const TensorShape& shape) {
+  ORT_RETURN_IF_NOT(shape.NumDimensions() == 4, "NCHWc tensors must have 4 dimensions: ", shape);
+  ORT_RETURN_IF_NOT(shape[1] % static_cast<int64_t>(MlasNchwcGetBlockSize()) == 0,
+                    "Channel count must be a multiple of the NCHWc block size: ", shape);
+  return Status::OK();
+}
+
+Status ReorderInput::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(0);
+  const TensorShape& X_shape = X->Shape();
+  ORT_RETURN_IF_ERROR(ValidateNchwcShape(X_shape));
+
+  Tensor* Y = context->Output(0, X_shape);
+  MlasReorderInput(X_shape.GetDims().data(), X->Data<float>(), Y->MutableData<float>());
+
+  return Status::OK();
+}
+
+Status ReorderOutput::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(0);
+  const TensorShape& X_shape = X->Shape();
+  ORT_RETURN_IF_ERROR(ValidateNchwcShape(X_shape));
+
+  Tensor* Y = context->Output(0, X_shape);
+  MlasReorderOutput(X_shape.GetDims().data(), X->Data<float>(), Y->MutableData<float>());
+
+  return Status::OK();
+}
+
+Status NchwcConv::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(0);
+  const Tensor* W = context->Input<Tensor>(1);
+  const Tensor* B = context->InputCount() >= 3 ? context->Input<Tensor>(2) : nullptr;
+  ORT_RETURN_IF_ERROR(ValidateInputShape(X, W));
+
+  const TensorShape& X_shape = X->Shape();
+  const TensorShape& W_shape = W->Shape();
+  ORT_RETURN_IF_NOT(X_shape.NumDimensions() == 4 && group_ == 1,
+                    "NchwcConv only supports 2D convolutions with a single group.");
+  ORT_RETURN_IF_NOT(W_shape[0] % static_cast<int64_t>(MlasNchwcGetBlockSize()) == 0,
+                    "Filter count must be a multiple of the NCHWc block size: ", W_shape);
+
+  std::vector<int64_t> kernel_shape;
+  ORT_RETURN_IF_ERROR(ComputeKernelShape(W_shape, kernel_shape));
+
+  std::vector<int64_t> pads(pads_);
+  if (pads.empty()) {
+    pads.resize(kernel_shape.size() * 2, 0);
+  }
+  std::vector<int64_t> dilations(dilations_);
+  if (dilations.empty()) {
+    dilations.resize(kernel_shape.size(), 1);
+  }
+  std::vector<int64_t> strides(strides_);
+  if (strides.empty()) {
+    strides.resize(kernel_shape.size(), 1);
+  }
+
+  std::vector<int64_t> Y_dims({X_shape[0], W_shape[0]});
+  TensorShape input_shape = X_shape.Slice(2);
+  ORT_RETURN_IF_ERROR(InferOutputShape(input_shape, kernel_shape, strides, dilations, &pads, &Y_dims));
+  Tensor* Y = context->Output(0, TensorShape(Y_dims));
+
+  MLAS_ACTIVATION Activation;
+  if (activation_.empty()) {
+    Activation.ActivationKind = MlasIdentityActivation;
+  } else if (activation_ == "Relu") {
+    Activation.ActivationKind = MlasReluActivation;
+  } else if (activation_ == "LeakyRelu") {
+    Activation.ActivationKind = MlasLeakyReluActivation;
+    Activation.alpha = alpha_;
+  } else if (activation_ == "Tanh") {
+    Activation.ActivationKind = MlasTanhActivation;
+  } else if (activation_ == "Sigmoid") {
+    Activation.ActivationKind = MlasLogisticActivation;
+  } else {
+    ORT_NOT_IMPLEMENTED("Not implemented fused activation: ", activation_);
+  }
+
+  MlasNchwcConv(X_shape.GetDims().data(),
+                kernel_shape.data(),
+                dilations.data(),
+                pads.data(),
+                strides.data(),
+                Y_dims.data(),
+                X->Data<float>(),
+                W->Data<float>(),
+                B != nullptr ? B->Data<float>() : nullptr,
+                Y->MutableData<float>(),
+                &Activation,
+                context->GetOperatorThreadPool());
+
+  return Status::OK();
+}
+
+Status NchwcPool::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(0);
+  const TensorShape& X_shape = X->Shape();
+  ORT_RETURN_IF_ERROR(ValidateNchwcShape(X_shape));
+
+  std::vector<int64_t> pads = pads_;
+  if (global_pooling_) {
+    pads.assign(4, 0);
+  } else {
+    ORT_RETURN_IF_NOT(kernel_shape_.size() == 2, "NCHWc pooling only supports 2D kernels.");
+  }
+
+  std::vector<int64_t> output_dims = PoolBase::SetOutputSize(X_shape, X_shape[1], &pads);
+  Tensor* Y = context->Output(0, TensorShape(output_dims));
+
+  MLAS_POOLING_KIND PoolingKind;
+  if (op_name_ == "MaxPool" || op_name_ == "GlobalMaxPool") {
+    PoolingKind = MlasMaximumPooling;
+  } else if (count_include_pad_) {
+    PoolingKind = MlasAveragePoolingIncludePad;
+  } else {
+    PoolingKind = MlasAveragePoolingExcludePad;
+  }
+
+  MlasNchwcPool(PoolingKind,
+                X_shape.GetDims().data(),
+                global_pooling_ ? nullptr : kernel_shape_.data(),
+                global_pooling_ ? nullptr : pads.data(),
+                global_pooling_ ? nullptr : strides_.data(),
+                output_dims.data(),
+                X->Data<float>(),
+                Y->MutableData<float>(),
+                context->GetOperatorThreadPool());
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
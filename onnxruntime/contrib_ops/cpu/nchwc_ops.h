@@ -0,0 +1,53 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/providers/cpu/nn/conv_base.h"
+#include "core/providers/cpu/nn/pool_base.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Kernels operating on channel blocked (NCHWc) tensors. An NCHWc tensor has the same shape as the NCHW tensor
+// it was reordered from, but its channels are stored in blocks of MlasNchwcGetBlockSize() channels. The graph
+// is rewritten to use these kernels by the NchwcTransformer.
+
+class ReorderInput : public OpKernel {
+ public:
+  ReorderInput(const OpKernelInfo& info) : OpKernel(info) {}
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+class ReorderOutput : public OpKernel {
+ public:
+  ReorderOutput(const OpKernelInfo& info) : OpKernel(info) {}
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+class NchwcConv : public OpKernel, public ConvBase {
+ public:
+  NchwcConv(const OpKernelInfo& info) : OpKernel(info), ConvBase(info) {
+    activation_ = info.GetAttrOrDefault<std::string>("activation", "");
+    alpha_ = info.GetAttrOrDefault("alpha", 0.01f);
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+// Implements the NchwcMaxPool, NchwcAveragePool, NchwcGlobalMaxPool and NchwcGlobalAveragePool operators. The
+// attributes are parsed as for the ONNX pooling operator that the kernel name is derived from.
+class NchwcPool : public OpKernel, public PoolBase {
+ public:
+  NchwcPool(const OpKernelInfo& info) : OpKernel(info), PoolBase(info, info.GetKernelDef().OpName().substr(5)) {}
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -22,10 +22,11 @@ namespace onnxruntime {
 
 #if defined(PLATFORM_X86)
 static inline void GetCPUID(int function_id, int data[4]) {  // NOLINT
+  // leaf 7 reports different features for each sub-leaf, so always query sub-leaf 0.
 #if defined(_MSC_VER)
-  __cpuid(reinterpret_cast<int*>(data), function_id);
+  __cpuidex(reinterpret_cast<int*>(data), function_id, 0);
 #elif defined(__GNUC__)
-  __cpuid(function_id, data[0], data[1], data[2], data[3]);
+  __cpuid_count(function_id, 0, data[0], data[1], data[2], data[3]);
 #endif
 }
 
@@ -54,14 +55,19 @@ CPUIDInfo::CPUIDInfo() noexcept {
       const int AVX_MASK = 0x6;
       const int AVX512_MASK = 0xE6;
       int value = XGETBV();
-      bool has_avx = (data[2] & (1 << 28)) && ((value & AVX_MASK) == AVX_MASK);
+      has_avx_ = (data[2] & (1 << 28)) && ((value & AVX_MASK) == AVX_MASK);
       bool has_avx512 = (value & AVX512_MASK) == AVX512_MASK;
-      has_f16c_ = has_avx && (data[2] & (1 << 29)) && (data[3] & (1 << 26));
+      has_fma_ = has_avx_ && (data[2] & (1 << 12));
+      has_f16c_ = has_avx_ && (data[2] & (1 << 29)) && (data[3] & (1 << 26));
 
       if (num_IDs >= 7) {
         GetCPUID(7, data);
-        has_avx2_ = has_avx && (data[1] & (1 << 5));
+        has_avx2_ = has_avx_ && (data[1] & (1 << 5));
+        has_bmi2_ = (data[1] & (1 << 8)) != 0;
         has_avx512f_ = has_avx512 && (data[1] & (1 << 16));
+        has_avx512bw_ = has_avx512f_ && (data[1] & (1 << 30));
+        has_avx512vl_ = has_avx512f_ && (static_cast<unsigned>(data[1]) & (1u << 31));
+        has_avx512vnni_ = has_avx512f_ && (data[2] & (1 << 11));
       }
     }
   }
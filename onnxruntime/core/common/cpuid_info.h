@@ -12,14 +12,26 @@ public:
     return cpuid_info;
   }
 
+  bool HasAVX() const { return has_avx_; }
   bool HasAVX2() const { return has_avx2_; }
+  bool HasFMA() const { return has_fma_; }
+  bool HasBMI2() const { return has_bmi2_; }
   bool HasAVX512f() const { return has_avx512f_; }
+  bool HasAVX512BW() const { return has_avx512bw_; }
+  bool HasAVX512VL() const { return has_avx512vl_; }
+  bool HasAVX512VNNI() const { return has_avx512vnni_; }
   bool HasF16C() const { return has_f16c_; }
 
 private:
   CPUIDInfo() noexcept;
+  bool has_avx_{false};
   bool has_avx2_{false};
+  bool has_fma_{false};
+  bool has_bmi2_{false};
   bool has_avx512f_{false};
+  bool has_avx512bw_{false};
+  bool has_avx512vl_{false};
+  bool has_avx512vnni_{false};
   bool has_f16c_{false};
 };
 
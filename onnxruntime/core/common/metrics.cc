@@ -0,0 +1,339 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <new>
+#include <unordered_map>
+
+namespace onnxruntime {
+namespace profiling {
+
+namespace {
+// latencies below 2^kMinLog2 ns all go into bucket 0
+constexpr int kMinLog2 = 8;
+
+int FloorLog2(uint64_t value) {
+  int log2 = 0;
+  for (int shift = 32; shift > 0; shift >>= 1) {
+    if ((value >> shift) != 0) {
+      value >>= shift;
+      log2 += shift;
+    }
+  }
+  return log2;
+}
+
+void WriteSummaryMembers(std::ostream& out, const LatencySummary& summary) {
+  out << "\"count\":" << summary.count
+      << ",\"total_us\":" << summary.total_ns / 1000.0
+      << ",\"mean_us\":" << summary.MeanNs() / 1000.0
+      << ",\"max_us\":" << summary.max_ns / 1000.0;
+}
+
+void WriteStatsMembers(std::ostream& out, const LatencyStats& stats) {
+  out << "\"count\":" << stats.count
+      << ",\"total_us\":" << stats.total_ns / 1000.0
+      << ",\"mean_us\":" << stats.MeanNs() / 1000.0
+      << ",\"p50_us\":" << stats.Percentile(50) / 1000.0
+      << ",\"p90_us\":" << stats.Percentile(90) / 1000.0
+      << ",\"p99_us\":" << stats.Percentile(99) / 1000.0
+      << ",\"max_us\":" << stats.max_ns / 1000.0;
+}
+}  // namespace
+
+int LatencyStats::BucketIndex(uint64_t duration_ns) {
+  if (duration_ns < (uint64_t{1} << kMinLog2)) {
+    return 0;
+  }
+  int log2 = FloorLog2(duration_ns);
+  int upper_half = static_cast<int>((duration_ns >> (log2 - 1)) & 1);
+  return std::min(1 + 2 * (log2 - kMinLog2) + upper_half, kNumBuckets - 1);
+}
+
+uint64_t LatencyStats::BucketUpperBound(int bucket) {
+  if (bucket == 0) {
+    return uint64_t{1} << kMinLog2;
+  }
+  int log2 = kMinLog2 + (bucket - 1) / 2;
+  uint64_t half = uint64_t{1} << (log2 - 1);
+  return (uint64_t{1} << log2) + ((bucket - 1) % 2 + 1) * half;
+}
+
+void LatencySummary::Merge(const LatencySummary& other) {
+  count += other.count;
+  total_ns += other.total_ns;
+  max_ns = std::max(max_ns, other.max_ns);
+}
+
+void LatencyStats::Merge(const LatencyStats& other) {
+  LatencySummary::Merge(other);
+  for (int i = 0; i < kNumBuckets; ++i) {
+    buckets[i] += other.buckets[i];
+  }
+}
+
+uint64_t LatencyStats::Percentile(double percentile) const {
+  if (count == 0) {
+    return 0;
+  }
+  percentile = std::min(std::max(percentile, 0.0), 100.0);
+  auto target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * count)));
+  uint64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += buckets[i];
+    if (seen >= target) {
+      return std::min(BucketUpperBound(i), max_ns);
+    }
+  }
+  // the buckets of a snapshot taken while recording may trail the count
+  return max_ns;
+}
+
+void LatencyCounter::Record(uint64_t duration_ns) noexcept {
+  count_.fetch_add(1, std::memory_order_relaxed);
+  total_ns_.fetch_add(duration_ns, std::memory_order_relaxed);
+  uint64_t max_ns = max_ns_.load(std::memory_order_relaxed);
+  while (duration_ns > max_ns &&
+         !max_ns_.compare_exchange_weak(max_ns, duration_ns, std::memory_order_relaxed)) {
+  }
+}
+
+void LatencyCounter::Reset() noexcept {
+  count_.store(0, std::memory_order_relaxed);
+  total_ns_.store(0, std::memory_order_relaxed);
+  max_ns_.store(0, std::memory_order_relaxed);
+}
+
+void LatencyCounter::AddTo(LatencySummary& summary) const {
+  summary.count += count_.load(std::memory_order_relaxed);
+  summary.total_ns += total_ns_.load(std::memory_order_relaxed);
+  summary.max_ns = std::max(summary.max_ns, max_ns_.load(std::memory_order_relaxed));
+}
+
+void LatencyHistogram::Record(uint64_t duration_ns) noexcept {
+  buckets_[LatencyStats::BucketIndex(duration_ns)].fetch_add(1, std::memory_order_relaxed);
+  counter_.Record(duration_ns);
+}
+
+void LatencyHistogram::Reset() noexcept {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  counter_.Reset();
+}
+
+void LatencyHistogram::AddTo(LatencyStats& stats) const {
+  counter_.AddTo(stats);
+  for (int i = 0; i < LatencyStats::kNumBuckets; ++i) {
+    stats.buckets[i] += buckets_[i].load(std::memory_order_relaxed);
+  }
+}
+
+struct Metrics::Shard {
+  std::unique_ptr<LatencyCounter[]> nodes;
+  std::unique_ptr<LatencyHistogram[]> op_types;
+  LatencyHistogram runs;
+};
+
+Metrics::Metrics(const std::vector<std::string>& node_names, const std::vector<std::string>& node_op_types) {
+  ORT_ENFORCE(node_names.size() == node_op_types.size(), "Expected a name and an op type for every node index.");
+  std::unordered_map<std::string, int> op_type_ids;
+  node_slots_.reserve(node_op_types.size());
+  for (size_t i = 0, end = node_op_types.size(); i < end; ++i) {
+    const auto& op_type = node_op_types[i];
+    if (op_type.empty()) {
+      node_slots_.push_back(-1);
+      continue;
+    }
+    node_slots_.push_back(static_cast<int>(node_indices_.size()));
+    node_indices_.push_back(i);
+    node_names_.push_back(node_names[i]);
+
+    auto result = op_type_ids.emplace(op_type, static_cast<int>(op_types_.size()));
+    if (result.second) {
+      op_types_.push_back(op_type);
+    }
+    node_op_type_ids_.push_back(result.first->second);
+  }
+
+  for (auto& shard : shards_) {
+    shard.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+Metrics::~Metrics() {
+  for (auto& shard : shards_) {
+    delete shard.load(std::memory_order_acquire);
+  }
+}
+
+Metrics::Shard* Metrics::ThreadShard() noexcept {
+  // threads are spread over the shards in the order in which they first record into any Metrics
+  static std::atomic<size_t> next_thread{0};
+  thread_local const size_t thread_shard = next_thread.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+
+  auto& slot = shards_[thread_shard];
+  Shard* shard = slot.load(std::memory_order_acquire);
+  if (shard != nullptr) {
+    return shard;
+  }
+
+  std::unique_ptr<Shard> created{new (std::nothrow) Shard()};
+  if (created == nullptr) {
+    return nullptr;
+  }
+  created->nodes.reset(new (std::nothrow) LatencyCounter[node_names_.size()]);
+  created->op_types.reset(new (std::nothrow) LatencyHistogram[op_types_.size()]);
+  if (created->nodes == nullptr || created->op_types == nullptr) {
+    return nullptr;
+  }
+
+  // another thread assigned the same shard may have won the race
+  if (slot.compare_exchange_strong(shard, created.get(), std::memory_order_acq_rel)) {
+    shard = created.release();
+  }
+  return shard;
+}
+
+template <typename TFunc>
+void Metrics::ForEachShard(TFunc func) const {
+  for (const auto& slot : shards_) {
+    Shard* shard = slot.load(std::memory_order_acquire);
+    if (shard != nullptr) {
+      func(*shard);
+    }
+  }
+}
+
+void Metrics::RecordNode(size_t node_index, uint64_t duration_ns) noexcept {
+  if (node_index >= node_slots_.size() || node_slots_[node_index] < 0) {
+    return;
+  }
+  auto slot = static_cast<size_t>(node_slots_[node_index]);
+  Shard* shard = ThreadShard();
+  if (shard != nullptr) {
+    shard->nodes[slot].Record(duration_ns);
+    shard->op_types[node_op_type_ids_[slot]].Record(duration_ns);
+  }
+}
+
+void Metrics::RecordRun(uint64_t duration_ns, bool succeeded) noexcept {
+  if (!succeeded) {
+    failed_runs_.fetch_add(1, std::memory_order_relaxed);
+  }
+  Shard* shard = ThreadShard();
+  if (shard != nullptr) {
+    shard->runs.Record(duration_ns);
+  }
+}
+
+void Metrics::Reset() noexcept {
+  size_t num_nodes = node_names_.size();
+  size_t num_op_types = op_types_.size();
+  ForEachShard([num_nodes, num_op_types](Shard& shard) {
+    for (size_t i = 0; i < num_nodes; ++i) {
+      shard.nodes[i].Reset();
+    }
+    for (size_t i = 0; i < num_op_types; ++i) {
+      shard.op_types[i].Reset();
+    }
+    shard.runs.Reset();
+  });
+  failed_runs_.store(0, std::memory_order_relaxed);
+}
+
+LatencySummary Metrics::NodeStats(size_t node_index) const {
+  LatencySummary summary;
+  if (node_index < node_slots_.size() && node_slots_[node_index] >= 0) {
+    auto slot = static_cast<size_t>(node_slots_[node_index]);
+    ForEachShard([&summary, slot](const Shard& shard) { shard.nodes[slot].AddTo(summary); });
+  }
+  return summary;
+}
+
+LatencyStats Metrics::OpTypeStats(const std::string& op_type) const {
+  LatencyStats stats;
+  auto it = std::find(op_types_.cbegin(), op_types_.cend(), op_type);
+  if (it != op_types_.cend()) {
+    auto id = static_cast<size_t>(it - op_types_.cbegin());
+    ForEachShard([&stats, id](const Shard& shard) { shard.op_types[id].AddTo(stats); });
+  }
+  return stats;
+}
+
+LatencyStats Metrics::RunStats() const {
+  LatencyStats stats;
+  ForEachShard([&stats](const Shard& shard) { shard.runs.AddTo(stats); });
+  return stats;
+}
+
+void Metrics::WriteJsonString(std::ostream& out, const std::string& value) {
+  out << '"';
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+              << std::dec << std::setfill(' ');
+        } else {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+}
+
+void Metrics::WriteJsonMembers(std::ostream& out) const {
+  out << "\"runs\":{";
+  WriteStatsMembers(out, RunStats());
+  out << ",\"failed\":" << FailedRuns() << "}";
+
+  out << ",\"op_types\":{";
+  bool first = true;
+  for (const auto& op_type : op_types_) {
+    LatencyStats stats = OpTypeStats(op_type);
+    if (stats.count == 0) {
+      continue;
+    }
+    out << (first ? "" : ",");
+    first = false;
+    WriteJsonString(out, op_type);
+    out << ":{";
+    WriteStatsMembers(out, stats);
+    out << "}";
+  }
+  out << "}";
+
+  // nodes that haven't run since the last reset are left out
+  out << ",\"nodes\":[";
+  first = true;
+  for (size_t slot = 0, end = node_names_.size(); slot < end; ++slot) {
+    LatencySummary summary;
+    ForEachShard([&summary, slot](const Shard& shard) { shard.nodes[slot].AddTo(summary); });
+    if (summary.count == 0) {
+      continue;
+    }
+    out << (first ? "{" : ",{") << "\"index\":" << node_indices_[slot] << ",\"name\":";
+    first = false;
+    WriteJsonString(out, node_names_[slot]);
+    out << ",\"op_type\":";
+    WriteJsonString(out, op_types_[node_op_type_ids_[slot]]);
+    out << ",";
+    WriteSummaryMembers(out, summary);
+    out << "}";
+  }
+  out << "]";
+}
+
+}  // namespace profiling
+}  // namespace onnxruntime
@@ -0,0 +1,168 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+
+namespace onnxruntime {
+
+namespace profiling {
+
+/**
+ * Count, sum and maximum of some latencies, without their distribution.
+ */
+struct LatencySummary {
+  uint64_t count = 0;
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+
+  void Merge(const LatencySummary& other);
+
+  double MeanNs() const { return count == 0 ? 0.0 : static_cast<double>(total_ns) / count; }
+};
+
+/**
+ * Snapshot of a LatencyHistogram, or of several merged ones.
+ */
+struct LatencyStats : LatencySummary {
+  static constexpr int kNumBuckets = 64;
+
+  std::array<uint64_t, kNumBuckets> buckets{};
+
+  void Merge(const LatencyStats& other);
+
+  /*
+  Upper bound of the bucket holding the given percentile (0 to 100) of the recorded latencies, capped at the
+  largest latency recorded. The relative error is at most 50%, 0 if nothing was recorded.
+  */
+  uint64_t Percentile(double percentile) const;
+
+  // the bucket of a latency, and the exclusive upper bound of the latencies in a bucket
+  static int BucketIndex(uint64_t duration_ns);
+  static uint64_t BucketUpperBound(int bucket);
+};
+
+/**
+ * Count, sum and maximum of latencies, recorded with relaxed atomic operations so any number of threads can
+ * record into it without locking. Takes 24 bytes.
+ */
+class LatencyCounter {
+ public:
+  LatencyCounter() noexcept { Reset(); }
+
+  void Record(uint64_t duration_ns) noexcept;
+
+  // Records made concurrently with Reset may be partially kept.
+  void Reset() noexcept;
+
+  // Add the current values to summary.
+  void AddTo(LatencySummary& summary) const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(LatencyCounter);
+
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> total_ns_;
+  std::atomic<uint64_t> max_ns_;
+};
+
+/**
+ * Histogram of latencies with two logarithmic buckets per power of two from 256ns up, recorded with
+ * relaxed atomic adds so any number of threads can record into it without locking. Takes about 540 bytes.
+ */
+class LatencyHistogram {
+ public:
+  LatencyHistogram() noexcept { Reset(); }
+
+  void Record(uint64_t duration_ns) noexcept;
+
+  // Records made concurrently with Reset may be partially kept.
+  void Reset() noexcept;
+
+  // Add the current counts to stats.
+  void AddTo(LatencyStats& stats) const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(LatencyHistogram);
+
+  LatencyCounter counter_;
+  std::atomic<uint64_t> buckets_[LatencyStats::kNumBuckets];
+};
+
+/**
+ * Always-on latency metrics of a session: the count, sum and maximum of every node's latencies, and a histogram
+ * per op type and of the whole runs.
+ *
+ * Unlike the Profiler, which records every event into a single locked list, recording costs two clock reads
+ * and a few relaxed atomic adds. The counters are split into a few shards, allocated on first use and merged
+ * when the metrics are read. Threads are assigned to the shards round-robin, so with up to kNumShards threads
+ * recording every thread has a shard of its own. Beyond that, threads sharing a shard contend on its atomics.
+ *
+ * A shard takes 24 bytes per node plus about 540 bytes per op type, so the metrics of a model with 5000 nodes of
+ * 50 op types take at most about 1.2MB.
+ */
+class Metrics {
+ public:
+  /*
+  node_names and node_op_types are indexed by node index. An empty op type marks an index without a node.
+  */
+  Metrics(const std::vector<std::string>& node_names, const std::vector<std::string>& node_op_types);
+  ~Metrics();
+
+  void RecordNode(size_t node_index, uint64_t duration_ns) noexcept;
+  void RecordRun(uint64_t duration_ns, bool succeeded) noexcept;
+
+  // Clear everything recorded so far.
+  void Reset() noexcept;
+
+  LatencySummary NodeStats(size_t node_index) const;
+  LatencyStats OpTypeStats(const std::string& op_type) const;
+  LatencyStats RunStats() const;
+  uint64_t FailedRuns() const { return failed_runs_.load(std::memory_order_relaxed); }
+
+  /*
+  Write the run, op type and node latencies as the members of a JSON object, without the enclosing braces
+  so the caller can add its own members. Latencies are in microseconds.
+  */
+  void WriteJsonMembers(std::ostream& out) const;
+
+  static uint64_t DurationNs(const TimePoint& start, const TimePoint& end) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  }
+
+  static void WriteJsonString(std::ostream& out, const std::string& value);
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Metrics);
+
+  struct Shard;
+  static constexpr size_t kNumShards = 8;
+
+  // the shard of the calling thread, nullptr if it couldn't be allocated
+  Shard* ThreadShard() noexcept;
+
+  template <typename TFunc>
+  void ForEachShard(TFunc func) const;
+
+  // the nodes are numbered densely, so the indices of removed nodes take no counters
+  std::vector<int> node_slots_;  // by node index, -1 for an index without a node
+  std::vector<size_t> node_indices_;  // by slot
+  std::vector<std::string> node_names_;  // by slot
+  std::vector<int> node_op_type_ids_;  // by slot
+  std::vector<std::string> op_types_;
+
+  std::atomic<Shard*> shards_[kNumShards];
+  std::atomic<uint64_t> failed_runs_{0};
+};
+
+}  // namespace profiling
+}  // namespace onnxruntime
@@ -10,6 +10,7 @@
 #include "core/platform/env.h"
 #include "core/framework/data_types.h"
 #include "core/framework/kernel_def_builder.h"
+#include "core/framework/mem_pattern_planner.h"
 #include "core/framework/mldata_type_utils.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/session_state.h"
@@ -149,6 +150,23 @@ class PlannerImpl {
   // they became free (more recently freed earlier in the list).
   std::list<FreeBufferInfo> freelist_;
 
+  // Only used for a plan partitioned into chains (see ComputeChains):
+  // step_chain_ : the chain of every step of the execution plan.
+  // consumer_chain_ : indexed by MLValueIndex, the chain of the nodes consuming the ml-value, or of the nodes
+  // consuming any ml-value reusing its buffer if the ml-value is the original buffer.
+  enum : int { kNoChain = -1,
+               kManyChains = -2 };
+  std::vector<int> step_chain_;
+  std::vector<int> consumer_chain_;
+
+  bool IsBranchParallel() const { return !plan_.chains.empty(); }
+
+  static int MergeChains(int chain1, int chain2) {
+    if (chain1 == kNoChain) return chain2;
+    if (chain2 == kNoChain || chain1 == chain2) return chain1;
+    return kManyChains;
+  }
+
   MLValueIndex Index(const MLValueName& name) {
     MLValueIndex result;
     auto status = mlvalue_name_idx_map_.GetIdx(name, result);
@@ -190,6 +208,9 @@ class PlannerImpl {
     auto& symplan = AllocPlan(reused_for);
     symplan.alloc_kind = AllocKind::kReuse;
     symplan.reused_buffer = original;
+
+    if (IsBranchParallel())
+      consumer_chain_[original] = MergeChains(consumer_chain_[original], consumer_chain_[reused_for]);
   }
 
   // Find if there exists some input tensor that we can use in-place for output_arg
@@ -224,7 +245,9 @@ class PlannerImpl {
           if (p_input_arg->Exists()) {
             auto input_arg_index = Index(p_input_arg->Name());
             auto original = Buffer(input_arg_index);
-            if (1 == UseCount(original)) {
+            // with concurrent chains the other uses of the buffer may not be done yet unless they are in
+            // the chain of this node
+            if (1 == UseCount(original) && !(IsBranchParallel() && consumer_chain_[original] == kManyChains)) {
               if (SameSize(*p_input_arg, *p_output_arg)) {
                 // we can reuse this input since it is its last use and permitted for in-place update
                 *reusable_input = input_arg_index;  // or original; both should be okay
@@ -292,14 +315,17 @@ class PlannerImpl {
     return SameSize(*p_shape1, arg1.Type(), *p_shape2, arg2.Type());
   }
 
-  // Find if freelist contains a buffer of the same size as output_arg
-  bool FindReusableTensor(const onnxruntime::NodeArg& output_arg, MLValueIndex* reusable_tensor) {
+  // Find if freelist contains a buffer of the same size as output_arg, for the output of the node at program_counter
+  bool FindReusableTensor(const onnxruntime::NodeArg& output_arg, size_t program_counter,
+                          MLValueIndex* reusable_tensor) {
     auto p_required_buffer_shape = context_.GetShape(output_arg);
     if (nullptr == p_required_buffer_shape) return false;
     auto required_buffer_type = output_arg.Type();
     auto& required_allocator_info = AllocPlan(output_arg.Name()).location;
 
     for (auto it = freelist_.begin(); it != freelist_.end(); ++it) {
+      // a buffer freed in another chain may still be in use when this node runs
+      if (IsBranchParallel() && step_chain_[it->deallocate_point] != step_chain_[program_counter]) continue;
       auto reusable = it->ml_value;
       auto p_node_arg = ml_value_info_.at(reusable).p_def_site;
       auto& available_allocator_info = AllocPlan(p_node_arg->Name()).location;
@@ -495,7 +521,7 @@ class PlannerImpl {
         } else if (FindReusableInput(*pnode, output_arg_num, &reused)) {
           // Reuse one of this node's input buffers as the output buffer (for in-place update)
           Reuse(reused, current);
-        } else if (!context_.EnableParallelExecution() && FindReusableTensor(*node_output, &reused)) {
+        } else if (!context_.EnableParallelExecution() && FindReusableTensor(*node_output, program_counter, &reused)) {
           // Reuse an available (dead) buffer for this output, this is only for sequential execution.
           Reuse(reused, current);
         } else {
@@ -510,7 +536,7 @@ class PlannerImpl {
           auto& sym = node_input->Name();
           auto original = Buffer(Index(sym));
           if (0 == --UseCount(original))
-            freelist_.push_front(FreeBufferInfo(original, program_counter));
+            FreeBuffer(original, program_counter);
         }
       }
 
@@ -519,7 +545,7 @@ class PlannerImpl {
           auto& sym = node_input->Name();
           auto original = Buffer(Index(sym));
           if (0 == --UseCount(original))
-            freelist_.push_front(FreeBufferInfo(original, program_counter));
+            FreeBuffer(original, program_counter);
         }
       }
 
@@ -529,12 +555,89 @@ class PlannerImpl {
           auto& sym = node_output->Name();
           auto original = Buffer(Index(sym));
           if (0 == --UseCount(original))
-            freelist_.push_front(FreeBufferInfo(original, program_counter));
+            FreeBuffer(original, program_counter);
         }
       }
     }
   }
 
+  // Record that the buffer original is free after the step program_counter. With concurrent chains a buffer
+  // used in more than one chain is kept until the end of the run, as the chains may complete in any order.
+  void FreeBuffer(MLValueIndex original, size_t program_counter) {
+    if (IsBranchParallel() && consumer_chain_[original] == kManyChains) return;
+    freelist_.push_front(FreeBufferInfo(original, program_counter));
+  }
+
+  // Partition the execution plan into chains (see SequentialExecutionPlan::ExecutionChain). A node continues the
+  // chain of its predecessor if that is its only predecessor and it is the only successor of that predecessor.
+  // Nothing is partitioned if that results in a single chain.
+  void ComputeChains() {
+    const auto& execution_plan = plan_.execution_plan;
+    std::vector<SequentialExecutionPlan::ExecutionChain> chains;
+    std::vector<int> node_chain(graph_viewer_.MaxNodeIndex(), kNoChain);
+    std::vector<int> step_chain(execution_plan.size());
+
+    for (size_t step = 0; step < execution_plan.size(); ++step) {
+      auto pnode = graph_viewer_.GetNode(execution_plan[step].node_index);
+
+      const onnxruntime::Node* predecessor = nullptr;
+      bool continues_chain = true;
+      for (auto it = pnode->InputEdgesBegin(), end = pnode->InputEdgesEnd(); it != end; ++it) {
+        if (predecessor != nullptr && &it->GetNode() != predecessor) continues_chain = false;
+        predecessor = &it->GetNode();
+      }
+
+      continues_chain = continues_chain && predecessor != nullptr;
+      if (continues_chain) {
+        for (auto it = predecessor->OutputEdgesBegin(), end = predecessor->OutputEdgesEnd(); it != end; ++it) {
+          if (&it->GetNode() != pnode) {
+            continues_chain = false;
+            break;
+          }
+        }
+      }
+
+      int chain;
+      if (continues_chain) {
+        chain = node_chain[predecessor->Index()];
+      } else {
+        chain = static_cast<int>(chains.size());
+        chains.emplace_back();
+        // the last node of every predecessor chain has an edge to this node, possibly several
+        for (auto it = pnode->InputEdgesBegin(), end = pnode->InputEdgesEnd(); it != end; ++it) {
+          auto& predecessor_chain = chains[node_chain[it->GetNode().Index()]];
+          if (predecessor_chain.successors.empty() ||
+              predecessor_chain.successors.back() != static_cast<size_t>(chain)) {
+            predecessor_chain.successors.push_back(chain);
+            ++chains[chain].dependency_count;
+          }
+        }
+      }
+
+      chains[chain].steps.push_back(step);
+      node_chain[pnode->Index()] = chain;
+      step_chain[step] = chain;
+    }
+
+    if (chains.size() < 2) return;
+
+    plan_.chains = std::move(chains);
+    step_chain_ = std::move(step_chain);
+
+    consumer_chain_.assign(plan_.allocation_plan.size(), kNoChain);
+    for (size_t step = 0; step < execution_plan.size(); ++step) {
+      auto pnode = graph_viewer_.GetNode(execution_plan[step].node_index);
+      auto add_consumer = [this, step](const onnxruntime::NodeArg* node_input) {
+        if (node_input->Exists()) {
+          auto index = Index(node_input->Name());
+          consumer_chain_[index] = MergeChains(consumer_chain_[index], step_chain_[step]);
+        }
+      };
+      for (auto node_input : pnode->InputDefs()) add_consumer(node_input);
+      for (auto node_input : pnode->ImplicitInputDefs()) add_consumer(node_input);
+    }
+  }
+
   // Convert information in a freelist (about which ml-value becomes free when) into
   // a deallocation plan in the format required in an ExecutionPlan
   void GenerateDeallocationPlan() {
@@ -565,6 +668,81 @@ class PlannerImpl {
       plan_.execution_plan[prev_dealloc_point].free_to_index = current - 1;
   }
 
+  // Get the size of the buffer the execution frame allocates for arg, if its shape is known statically.
+  bool GetStaticTensorSize(const onnxruntime::NodeArg& arg, size_t element_size, size_t* size) {
+    auto p_shape = context_.GetShape(arg);
+    if (nullptr == p_shape) return false;
+
+    size_t num_elements = 1;
+    for (const auto& dim : p_shape->dim()) {
+      if (!dim.has_dim_value() || dim.dim_value() < 0) return false;
+      if (!IAllocator::CalcMemSizeForArray(num_elements, static_cast<size_t>(dim.dim_value()), &num_elements))
+        return false;
+    }
+
+    return IAllocator::CalcMemSizeForArrayWithAlignment<64>(num_elements, element_size, size);
+  }
+
+  // Assign offsets in one buffer per location to all the tensors the execution frame allocates for intermediate
+  // values (see SequentialExecutionPlan::static_mem_patterns). A tensor is live from the step producing it to the
+  // step after which it is freed. Nothing is planned if the size of any of these tensors is not known statically.
+  void ComputeStaticMemoryPatterns() {
+    const auto& execution_plan = plan_.execution_plan;
+    if (execution_plan.empty()) return;
+
+    const size_t num_ml_values = plan_.allocation_plan.size();
+    std::vector<size_t> first_step(num_ml_values, 0);
+    std::vector<size_t> last_step(num_ml_values, execution_plan.size() - 1);
+    for (size_t step = 0; step < execution_plan.size(); ++step) {
+      auto pnode = graph_viewer_.GetNode(execution_plan[step].node_index);
+      for (auto node_output : pnode->OutputDefs()) {
+        if (node_output->Exists())
+          first_step[Index(node_output->Name())] = step;
+      }
+
+      for (int i = execution_plan[step].free_from_index; i <= execution_plan[step].free_to_index; ++i)
+        last_step[plan_.to_be_freed[i]] = step;
+    }
+
+    std::vector<OrtAllocatorInfo> locations;
+    std::vector<StaticMemPatternPlanner> planners;
+    for (MLValueIndex index = 0; static_cast<size_t>(index) < num_ml_values; ++index) {
+      const auto& alloc_plan = plan_.allocation_plan[index];
+      if (alloc_plan.alloc_kind != AllocKind::kAllocate || nullptr == alloc_plan.value_type ||
+          !alloc_plan.value_type->IsTensorType())
+        continue;
+
+      // string tensors need placement new, so they are never allocated from a memory pattern
+      auto element_type = static_cast<const TensorTypeBase*>(alloc_plan.value_type)->GetElementType();
+      if (element_type == DataTypeImpl::GetType<std::string>())
+        continue;
+
+      size_t size;
+      if (!GetStaticTensorSize(*ml_value_info_.at(index).p_def_site, element_type->Size(), &size))
+        return;
+
+      auto location = std::find(locations.begin(), locations.end(), alloc_plan.location);
+      if (location == locations.end()) {
+        locations.push_back(alloc_plan.location);
+        planners.emplace_back();
+        location = locations.end() - 1;
+      }
+
+      planners[location - locations.begin()].AddTensor(index, size, first_step[index], last_step[index]);
+    }
+
+    if (locations.empty()) return;
+
+    auto mem_patterns = std::make_shared<MemoryPatternGroup>();
+    for (size_t i = 0; i < locations.size(); ++i) {
+      mem_patterns->locations.push_back(locations[i]);
+      mem_patterns->patterns.push_back(planners[i].GenerateMemPattern());
+      plan_.static_mem_naive_sizes.push_back(planners[i].NaiveSize());
+    }
+
+    plan_.static_mem_patterns = std::move(mem_patterns);
+  }
+
   bool IsNonTensor(const onnxruntime::NodeArg& nodearg) {
     // TODO: unclear why we should go through a string-representation of type
     auto ptype = nodearg.Type();
@@ -586,6 +764,9 @@ Status PlannerImpl::CreatePlan() {
     plan_.execution_plan.emplace_back(n);
   }
 
+  if (context_.EnableBranchParallelExecution())
+    ComputeChains();
+
   // compute use counts for all ml-values
   ORT_RETURN_IF_ERROR(ComputeUseCounts());
 
@@ -595,6 +776,10 @@ Status PlannerImpl::CreatePlan() {
   // convert information in the freelist_ into a deallocation plan in required format
   GenerateDeallocationPlan();
 
+  // the lifetimes are only known ahead of time when the nodes run in the order of the execution plan
+  if (!context_.EnableParallelExecution() && !IsBranchParallel())
+    ComputeStaticMemoryPatterns();
+
   return Status::OK();
 }
 
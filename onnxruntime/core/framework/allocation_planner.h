@@ -23,16 +23,20 @@ class ISequentialPlannerContext {
  public:
   virtual const ONNX_NAMESPACE::TensorShapeProto* GetShape(const onnxruntime::NodeArg& arg) const = 0;
   virtual bool EnableParallelExecution() const { return false; }
+  // Partition the execution plan into chains (see SequentialExecutionPlan::chains) that may run concurrently.
+  virtual bool EnableBranchParallelExecution() const { return false; }
 };
 
 class SequentialPlannerContext : public ISequentialPlannerContext {
  public:
   SequentialPlannerContext()
-      : m_enable_parallel_execution(false) {
+      : m_enable_parallel_execution(false),
+        m_enable_branch_parallel_execution(false) {
   }
 
-  SequentialPlannerContext(bool p_enable_parallel_execution)
-      : m_enable_parallel_execution(p_enable_parallel_execution) {
+  SequentialPlannerContext(bool p_enable_parallel_execution, bool p_enable_branch_parallel_execution = false)
+      : m_enable_parallel_execution(p_enable_parallel_execution),
+        m_enable_branch_parallel_execution(p_enable_branch_parallel_execution) {
   }
 
   const ONNX_NAMESPACE::TensorShapeProto* GetShape(const onnxruntime::NodeArg& arg) const override {
@@ -43,8 +47,13 @@ class SequentialPlannerContext : public ISequentialPlannerContext {
     return m_enable_parallel_execution;
   }
 
+  bool EnableBranchParallelExecution() const override {
+    return m_enable_branch_parallel_execution;
+  }
+
  private:
   bool m_enable_parallel_execution;
+  bool m_enable_branch_parallel_execution;
 };
 
 class SequentialPlanner {
@@ -3,12 +3,57 @@
 
 #pragma once
 
+#include <sstream>
 #include <string>
 
 #include "core/common/common.h"
 #include "core/framework/allocator.h"
 
 namespace onnxruntime {
+// Runtime statistics collected by an allocator.
+struct AllocatorStats {
+  int64_t num_allocs;             // Number of allocations.
+  int64_t bytes_in_use;           // Number of bytes in use.
+  int64_t total_allocated_bytes;  // The total number of allocated bytes by the allocator.
+  int64_t max_bytes_in_use;       // The maximum bytes in use.
+  int64_t max_alloc_size;         // The max single allocation seen.
+                                  // The upper limit what the allocator can allocate, if such a limit
+                                  // is known. Certain allocator may return 0 to indicate the limit is
+                                  // unknown.
+  int64_t bytes_limit;
+  int64_t num_cache_hits;    // Allocations served from a thread local cache.
+  int64_t num_cache_misses;  // Cacheable allocations that had to go to the shared arena.
+  int64_t bytes_cached;      // Free bytes held by thread local caches. Not included in bytes_in_use.
+
+  AllocatorStats() { Clear(); }
+
+  void Clear() {
+    this->num_allocs = 0;
+    this->bytes_in_use = 0;
+    this->max_bytes_in_use = 0;
+    this->max_alloc_size = 0;
+    this->bytes_limit = 0;
+    this->total_allocated_bytes = 0;
+    this->num_cache_hits = 0;
+    this->num_cache_misses = 0;
+    this->bytes_cached = 0;
+  }
+
+  std::string DebugString() const {
+    std::ostringstream ss;
+    ss << "Limit:           " << this->bytes_limit << "\n"
+       << "InUse:          " << this->bytes_in_use << "\n"
+       << "TotalAllocated: " << this->total_allocated_bytes << "\n"
+       << "MaxInUse:       " << this->max_bytes_in_use << "\n"
+       << "NumAllocs:      " << this->num_allocs << "\n"
+       << "MaxAllocSize:   " << this->max_alloc_size << "\n"
+       << "CacheHits:      " << this->num_cache_hits << "\n"
+       << "CacheMisses:    " << this->num_cache_misses << "\n"
+       << "BytesCached:    " << this->bytes_cached << "\n";
+    return ss.str();
+  }
+};
+
 // The interface for arena which manage memory allocations
 // Arena will hold a pool of pre-allocate memories and manage their lifecycle.
 // Need an underline IResourceAllocator to allocate memories.
@@ -26,6 +71,8 @@ class IArenaAllocator : public IAllocator {
   void Free(void* p) override = 0;
   virtual size_t Used() const = 0;
   virtual size_t Max() const = 0;
+  // GetStats call need to be thread safe.
+  virtual void GetStats(AllocatorStats* stats) = 0;
   const OrtAllocatorInfo& Info() const override = 0;
   // allocate host pinned memory?
 };
@@ -64,6 +111,10 @@ class DummyArena : public IArenaAllocator {
     ORT_NOT_IMPLEMENTED(__FUNCTION__, " is not implemented");
   }
 
+  void GetStats(AllocatorStats* /*stats*/) override {
+    ORT_NOT_IMPLEMENTED(__FUNCTION__, " is not implemented");
+  }
+
   const OrtAllocatorInfo& Info() const override {
     return info_;
   }
@@ -3,6 +3,7 @@
 
 #include "core/framework/execution_frame.h"
 
+#include <algorithm>
 #include <sstream>
 
 #include "core/framework/mem_pattern_planner.h"
@@ -25,44 +26,150 @@ ExecutionFrame::ExecutionFrame(const std::unordered_map<std::string, MLValue>& f
       session_state_(session_state),
       mem_patterns_(nullptr),
       planner_(nullptr) {
-  Init(feeds, output_names, fetches, fetch_allocators);
+  auto& mlvalue_idx_map = session_state_.GetMLValueNameIdxMap();
+
+  std::vector<int> feed_mlvalue_idxs;
+  std::vector<MLValue> feed_values;
+  feed_mlvalue_idxs.reserve(feeds.size());
+  feed_values.reserve(feeds.size());
+  for (const auto& feed : feeds) {
+    int mlvalue_idx;
+    Status status = mlvalue_idx_map.GetIdx(feed.first, mlvalue_idx);
+    ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
+    feed_mlvalue_idxs.push_back(mlvalue_idx);
+    feed_values.push_back(feed.second);
+  }
+
+  std::vector<int> fetch_mlvalue_idxs;
+  if (!fetches.empty()) {
+    // should've already verified this much before when Run() starts
+    ORT_ENFORCE(output_names.size() == fetches.size(),
+                "output_names vector size: " + std::to_string(output_names.size()) +
+                    " does not match that of fetches vector: " + std::to_string(fetches.size()));
+
+    fetch_mlvalue_idxs.reserve(output_names.size());
+    for (const auto& oname : output_names) {
+      int mlvalue_idx;
+      Status status = mlvalue_idx_map.GetIdx(oname, mlvalue_idx);
+      ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
+      fetch_mlvalue_idxs.push_back(mlvalue_idx);
+    }
+  }
+
+  Init(feed_mlvalue_idxs, feed_values, fetch_mlvalue_idxs, fetches, fetch_allocators);
+  InitMemPatterns(feed_mlvalue_idxs, feed_values);
+}
+
+ExecutionFrame::ExecutionFrame(const std::vector<int>& feed_mlvalue_idxs,
+                               const std::vector<MLValue>& feeds,
+                               const std::vector<int>& fetch_mlvalue_idxs,
+                               const std::vector<MLValue>& fetches,
+                               const SessionState& session_state)
+    : node_index_info_(session_state.GetNodeIndexInfo()),
+      session_state_(session_state),
+      mem_patterns_(nullptr),
+      planner_(nullptr) {
+  Init(feed_mlvalue_idxs, feeds, fetch_mlvalue_idxs, fetches, {});
+  InitMemPatterns(feed_mlvalue_idxs, feeds);
+}
 
+void ExecutionFrame::InitMemPatterns(const std::vector<int>& feed_mlvalue_idxs, const std::vector<MLValue>& feeds) {
   // If the session enable memory pattern optimization
   // and we have execution plan generated, try to setup
   // memory pattern optimization.
-  if (session_state.GetEnableMemoryPattern() &&
-      session_state.GetExecutionPlan()) {
+  // A memory pattern planned statically for the whole graph doesn't depend on the input shapes,
+  // so it is used directly. Otherwise look up the patterns traced in previous runs.
+  // The chains of a branch parallel plan allocate in a different order on every run, so a pattern traced in one
+  // run could overlap tensors that are live at the same time in another. No patterns are used for such a plan.
+  if (session_state_.GetExecutionPlan() && !session_state_.GetExecutionPlan()->chains.empty())
+    return;
+
+  if (session_state_.GetEnableMemoryPattern() &&
+      session_state_.GetExecutionPlan() &&
+      session_state_.GetExecutionPlan()->static_mem_patterns) {
+    mem_patterns_ = session_state_.GetExecutionPlan()->static_mem_patterns;
+    AllocateMemPatternBuffers();
+  } else if (session_state_.GetEnableMemoryPattern() &&
+             session_state_.GetExecutionPlan()) {
     std::vector<TensorShape> input_shapes;
     bool all_tensors = true;
     for (const auto& feed : feeds) {
-      if (!(feed.second.IsTensor())) {
+      if (!(feed.IsTensor())) {
         all_tensors = false;
         break;
       }
-      auto& tensor = feed.second.Get<Tensor>();
+      auto& tensor = feed.Get<Tensor>();
       input_shapes.push_back(tensor.Shape());
     }
     // if there is some traditional ml value type in inputs
     // disable the memory pattern optimization.
     if (all_tensors) {
-      mem_patterns_ = session_state.GetMemoryPatternGroup(input_shapes);
+      mem_patterns_ = session_state_.GetMemoryPatternGroup(input_shapes);
       // if no existing patterns, generate one in this executionframe
       if (!mem_patterns_) {
-        planner_ = std::make_unique<MLValuePatternPlanner>(*session_state.GetExecutionPlan());
-      } else {
-        // pre-allocate the big chunk requested in memory pattern.
-        // all the internal kernel's input/output tensors will be allocated on these buffer.
-        for (size_t i = 0; i < mem_patterns_->locations.size(); i++) {
-          ORT_ENFORCE(buffers_.find(mem_patterns_->locations[i]) == buffers_.end());
-          AllocatorPtr alloc = GetAllocator(mem_patterns_->locations[i]);
-          void* buffer = mem_patterns_->patterns[i].PeakSize() > 0 ? alloc->Alloc(mem_patterns_->patterns[i].PeakSize()) : nullptr;
-          buffers_[mem_patterns_->locations[i]] = BufferUniquePtr(buffer, alloc);
+        planner_ = std::make_unique<MLValuePatternPlanner>(*session_state_.GetExecutionPlan());
+        if (session_state_.HasMemoryPatternDimBuckets()) {
+          InitTracedDimBuckets(feed_mlvalue_idxs, feeds);
         }
+      } else {
+        AllocateMemPatternBuffers();
       }
     }
   }
 }
 
+void ExecutionFrame::InitTracedDimBuckets(const std::vector<int>& feed_mlvalue_idxs,
+                                          const std::vector<MLValue>& feeds) {
+  // only the symbolic dims vary between runs. rounding up a fixed dim that happens to be in the key, such as a
+  // channel count, would only waste memory.
+  const auto& mlvalue_idx_map = session_state_.GetMLValueNameIdxMap();
+  for (const auto* input : session_state_.GetGraphViewer()->GetInputs()) {
+    const auto* shape_proto = input->Shape();
+    int mlvalue_idx;
+    if (shape_proto == nullptr || !mlvalue_idx_map.GetIdx(input->Name(), mlvalue_idx).IsOK()) {
+      continue;
+    }
+    auto it = std::find(feed_mlvalue_idxs.cbegin(), feed_mlvalue_idxs.cend(), mlvalue_idx);
+    if (it == feed_mlvalue_idxs.cend()) {
+      continue;
+    }
+    const auto& dims = feeds[it - feed_mlvalue_idxs.cbegin()].Get<Tensor>().Shape().GetDims();
+    if (static_cast<int>(dims.size()) != shape_proto->dim_size()) {
+      continue;
+    }
+    for (size_t i = 0; i < dims.size(); ++i) {
+      int64_t bucket_dim = session_state_.BucketMemoryPatternDim(dims[i]);
+      if (!shape_proto->dim(static_cast<int>(i)).has_dim_value() && bucket_dim != dims[i]) {
+        auto& traced = traced_dim_buckets_[dims[i]];
+        traced = std::max(traced, bucket_dim);
+      }
+    }
+  }
+}
+
+void ExecutionFrame::Reset(const std::vector<int>& feed_mlvalue_idxs,
+                           const std::vector<MLValue>& feeds,
+                           const std::vector<int>& fetch_mlvalue_idxs,
+                           const std::vector<MLValue>& fetches) {
+  ORT_ENFORCE(planner_ == nullptr, "A frame that traces a memory pattern can't be reused");
+
+  std::fill(all_values_.begin(), all_values_.end(), MLValue());
+  output_indices_.clear();
+  custom_allocators_.clear();
+  Init(feed_mlvalue_idxs, feeds, fetch_mlvalue_idxs, fetches, {});
+}
+
+void ExecutionFrame::AllocateMemPatternBuffers() {
+  // pre-allocate the big chunk requested in memory pattern.
+  // all the internal kernel's input/output tensors will be allocated on these buffer.
+  for (size_t i = 0; i < mem_patterns_->locations.size(); i++) {
+    ORT_ENFORCE(buffers_.find(mem_patterns_->locations[i]) == buffers_.end());
+    AllocatorPtr alloc = GetAllocator(mem_patterns_->locations[i]);
+    void* buffer = mem_patterns_->patterns[i].PeakSize() > 0 ? alloc->Alloc(mem_patterns_->patterns[i].PeakSize()) : nullptr;
+    buffers_[mem_patterns_->locations[i]] = BufferUniquePtr(buffer, alloc);
+  }
+}
+
 ExecutionFrame::~ExecutionFrame() = default;
 
 Status ExecutionFrame::AllocateMLValueTensorSelfOwnBuffer(int mlvalue_index,
@@ -116,17 +223,19 @@ Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(int mlvalue_inde
       // if block not found, fall back to default behavior
       if (block) {
         auto it = buffers_.find(location);
-        // if the block is not correct, log message then fall back to default behavior
-        if (it != buffers_.end() && block->size_ == size) {
+        // if the block is not correct, log message then fall back to default behavior.
+        // the block may be larger than needed when the pattern was generated for other shapes in the same bucket.
+        if (it != buffers_.end() && block->size_ >= size) {
           void* buffer = it->second.get();
           auto status = AllocateTensorWithPreAllocateBufferHelper(
               p_mlvalue, static_cast<void*>(static_cast<char*>(buffer) + block->offset_),
               element_type, location, shape);
           return status;
         }
-        if (block->size_ != size) {
-          LOGS_DEFAULT(WARNING) << "For mlvalue with index: " << mlvalue_index << ", block in memory pattern size is: "
-                                << block->size_ << " but the actually size is: " << size << ", fall back to default allocation behavior";
+        if (block->size_ < size) {
+          // expected for a tensor whose size isn't proportional to the bucketed input dims
+          VLOGS_DEFAULT(1) << "For mlvalue with index: " << mlvalue_index << ", block in memory pattern size is: "
+                           << block->size_ << " but the actually size is: " << size << ", fall back to default allocation behavior";
         } else if (it == buffers_.end()) {
           LOGS_DEFAULT(WARNING) << "For mlvalue with index: " << mlvalue_index << ", block not found in target loation. "
                                                                                   " fall back to default allocation behavior";
@@ -149,8 +258,23 @@ Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(int mlvalue_inde
   // trace the memory allocation.
   // don't trace the memory allocation on string tensors, as it need
   // placement new, we don't support it in memory pattern optimization.
-  if (element_type != DataTypeImpl::GetType<std::string>())
-    TraceAllocate(mlvalue_index, size);
+  if (element_type != DataTypeImpl::GetType<std::string>()) {
+    size_t traced_size = size;
+    if (planner_ && !traced_dim_buckets_.empty()) {
+      std::vector<int64_t> dims = shape.GetDims();
+      for (auto& dim : dims) {
+        auto it = traced_dim_buckets_.find(dim);
+        if (it != traced_dim_buckets_.end()) {
+          dim = it->second;
+        }
+      }
+      if (!IAllocator::CalcMemSizeForArrayWithAlignment<64>(TensorShape(dims).Size(), element_type->Size(),
+                                                            &traced_size)) {
+        traced_size = size;
+      }
+    }
+    TraceAllocate(mlvalue_index, traced_size);
+  }
 
   return Status::OK();
 }
@@ -290,8 +414,9 @@ Status ExecutionFrame::AllocateAsPerAllocationPlan(int mlvalue_index,
   return Status::OK();
 }
 
-void ExecutionFrame::Init(const std::unordered_map<std::string, MLValue>& feeds,
-                          const std::vector<std::string>& output_names,
+void ExecutionFrame::Init(const std::vector<int>& feed_mlvalue_idxs,
+                          const std::vector<MLValue>& feeds,
+                          const std::vector<int>& fetch_mlvalue_idxs,
                           const std::vector<MLValue>& fetches,
                           const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators) {
   auto& mlvalue_idx_map = session_state_.GetMLValueNameIdxMap();
@@ -301,27 +426,21 @@ void ExecutionFrame::Init(const std::unordered_map<std::string, MLValue>& feeds,
 
   // 2. Handle non-empty output vector
   if (!fetches.empty()) {
-    // should've already verified this much before when Run() starts
-    ORT_ENFORCE(output_names.size() == fetches.size(),
-                "output_names vector size: " + std::to_string(output_names.size()) +
+    ORT_ENFORCE(fetch_mlvalue_idxs.size() == fetches.size(),
+                "fetch index vector size: " + std::to_string(fetch_mlvalue_idxs.size()) +
                     " does not match that of fetches vector: " + std::to_string(fetches.size()));
 
     // setup output_indices_, we don't want to generate mem plan on output tensors.
-    output_indices_.reserve(output_names.size());
-    auto idx = 0;
-    for (const auto& oname : output_names) {
-      int mlvalue_idx;
-      Status status = mlvalue_idx_map.GetIdx(oname, mlvalue_idx);
-      ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
-      all_values_[mlvalue_idx] = fetches.at(idx);
+    output_indices_.reserve(fetch_mlvalue_idxs.size());
+    for (size_t idx = 0, end = fetch_mlvalue_idxs.size(); idx < end; ++idx) {
+      int mlvalue_idx = fetch_mlvalue_idxs[idx];
+      all_values_[mlvalue_idx] = fetches[idx];
       output_indices_.push_back(mlvalue_idx);
 
       auto custom_alloc_entry = fetch_allocators.find(idx);
       if (custom_alloc_entry != fetch_allocators.cend()) {
         custom_allocators_[mlvalue_idx] = custom_alloc_entry->second;
       }
-
-      ++idx;
     }
   }
 
@@ -338,12 +457,9 @@ void ExecutionFrame::Init(const std::unordered_map<std::string, MLValue>& feeds,
   }
 
   // 4. handle feed in values. these can override initializer values so must be last
-  for (const auto& feed : feeds) {
-    int mlvalue_idx;
-    Status status = mlvalue_idx_map.GetIdx(feed.first, mlvalue_idx);
-    ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
+  for (size_t idx = 0, end = feed_mlvalue_idxs.size(); idx < end; ++idx) {
     // we are sharing the underline tensor/object for MLValue
-    all_values_[mlvalue_idx] = feed.second;
+    all_values_[feed_mlvalue_idxs[idx]] = feeds[idx];
   }
 }
 
@@ -45,8 +45,22 @@ class ExecutionFrame {
                  const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
                  const SessionState& session_state);
 
+  // Create a frame from feeds and fetches that were already resolved to their MLValue indices.
+  ExecutionFrame(const std::vector<int>& feed_mlvalue_idxs,
+                 const std::vector<MLValue>& feeds,
+                 const std::vector<int>& fetch_mlvalue_idxs,
+                 const std::vector<MLValue>& fetches,
+                 const SessionState& session_state);
+
   ~ExecutionFrame();
 
+  // Prepare the frame for another run with new feeds and fetches. The memory pattern buffers are kept, so the
+  // feeds must have the shapes of the run the frame was created for. Not valid for a frame that traces a pattern.
+  void Reset(const std::vector<int>& feed_mlvalue_idxs,
+             const std::vector<MLValue>& feeds,
+             const std::vector<int>& fetch_mlvalue_idxs,
+             const std::vector<MLValue>& fetches);
+
   // TODO: These two AllocateMLValue... methods are in the API purely for unit test usage.
   // Fix the unit tests so they set an execution plan that results in these methods being called by
   // GetOrCreateNodeOutputMLValue instead
@@ -103,11 +117,21 @@ class ExecutionFrame {
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ExecutionFrame);
 
-  void Init(const std::unordered_map<std::string, MLValue>& feeds,
-            const std::vector<std::string>& output_names,
+  void Init(const std::vector<int>& feed_mlvalue_idxs,
+            const std::vector<MLValue>& feeds,
+            const std::vector<int>& fetch_mlvalue_idxs,
             const std::vector<MLValue>& fetches,
             const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators);
 
+  // Use the memory pattern for the shapes of the feeds, or trace one if none is cached yet.
+  void InitMemPatterns(const std::vector<int>& feed_mlvalue_idxs, const std::vector<MLValue>& feeds);
+
+  // Fill traced_dim_buckets_ from the symbolic dims of the graph inputs.
+  void InitTracedDimBuckets(const std::vector<int>& feed_mlvalue_idxs, const std::vector<MLValue>& feeds);
+
+  // Allocate one buffer per location of mem_patterns_.
+  void AllocateMemPatternBuffers();
+
   common::Status AllocateAsPerAllocationPlan(int mlvalue_index,
                                              const MLValueAllocationParameters& parameters);
 
@@ -148,12 +172,17 @@ class ExecutionFrame {
   // If we already have cached memory pattern on these input shapes
   // Use this mem pattern that create a big chunk for all the internal
   // kernel's input/output tensors.
-  const MemoryPatternGroup* mem_patterns_;
+  std::shared_ptr<const MemoryPatternGroup> mem_patterns_;
 
   // If no cached memory pattern, and we enable the memory pattern optimization
   // use this planner_ to trace the memory allocation in current executor.
   std::unique_ptr<MLValuePatternPlanner> planner_;
 
+  // When tracing a pattern for bucketed input dims: the value of each symbolic input dim of this run, mapped to the
+  // upper end of its bucket. Tensor dims equal to such a value are traced at the bucket size, so the pattern fits
+  // the other shapes in the bucket.
+  std::unordered_map<int64_t, int64_t> traced_dim_buckets_;
+
   // Record the ml value indices for output values. we won't include those
   // values' allocation in memory pattern, as they can't be shared.
   std::vector<int> output_indices_;
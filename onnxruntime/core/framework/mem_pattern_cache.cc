@@ -0,0 +1,122 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/mem_pattern_cache.h"
+
+#include <limits>
+
+namespace onnxruntime {
+
+size_t MemoryPatternCache::KeyHash::operator()(const Key& key) const {
+  size_t hash = key.size();
+  for (auto value : key) {
+    hash ^= std::hash<int64_t>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  }
+  return hash;
+}
+
+namespace {
+// threads are spread over the hit counters in the order in which they first look up a pattern
+size_t ThreadHitCounter(size_t num_counters) {
+  static std::atomic<size_t> next_thread{0};
+  thread_local const size_t thread_counter = next_thread.fetch_add(1, std::memory_order_relaxed);
+  return thread_counter % num_counters;
+}
+}  // namespace
+
+MemoryPatternCache::MemoryPatternCache() : entries_(std::make_shared<const EntryMap>()) {}
+
+std::shared_ptr<const MemoryPatternCache::EntryMap> MemoryPatternCache::Snapshot() const {
+  std::lock_guard<OrtMutex> lock(snapshot_mutex_);
+  return entries_;
+}
+
+void MemoryPatternCache::SetSnapshot(std::shared_ptr<const EntryMap> entries) {
+  std::lock_guard<OrtMutex> lock(snapshot_mutex_);
+  entries_.swap(entries);
+  // the previous snapshot is released after unlocking, in case this was its last reference
+}
+
+void MemoryPatternCache::Configure(size_t max_entries, int64_t dim_bucket_size) {
+  ORT_ENFORCE(dim_bucket_size >= 0, "dim_bucket_size must be non-negative. Got ", dim_bucket_size);
+  max_entries_ = max_entries;
+  dim_bucket_size_ = dim_bucket_size;
+  SetSnapshot(std::make_shared<const EntryMap>());
+}
+
+MemoryPatternCache::Key MemoryPatternCache::MakeKey(const std::vector<TensorShape>& input_shapes) const {
+  Key key;
+  for (const auto& shape : input_shapes) {
+    const auto& dims = shape.GetDims();
+    // include the rank so shapes with the same dims in different inputs can't produce the same key
+    key.push_back(static_cast<int64_t>(dims.size()));
+    for (auto dim : dims) {
+      key.push_back(BucketDim(dim));
+    }
+  }
+  return key;
+}
+
+std::shared_ptr<const MemoryPatternGroup> MemoryPatternCache::Find(const std::vector<TensorShape>& input_shapes) const {
+  auto key = MakeKey(input_shapes);
+  auto entries = Snapshot();
+
+  auto it = entries->find(key);
+  if (it == entries->end()) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  hits_[ThreadHitCounter(kNumHitCounters)].count.fetch_add(1, std::memory_order_relaxed);
+  // only write when there was an insertion since the last lookup of the entry, so a hot entry stays read only
+  auto& last_used = it->second->last_used;
+  auto now = clock_.load(std::memory_order_relaxed);
+  if (last_used.load(std::memory_order_relaxed) != now) {
+    last_used.store(now, std::memory_order_relaxed);
+  }
+  return it->second->patterns;
+}
+
+void MemoryPatternCache::Insert(const std::vector<TensorShape>& input_shapes,
+                                std::unique_ptr<MemoryPatternGroup> mem_patterns) {
+  auto key = MakeKey(input_shapes);
+
+  std::lock_guard<OrtMutex> lock(write_mutex_);
+  auto entries = Snapshot();
+  if (entries->find(key) != entries->end()) {
+    return;
+  }
+
+  auto new_entries = std::make_shared<EntryMap>(*entries);
+  if (max_entries_ > 0 && new_entries->size() >= max_entries_) {
+    auto lru = new_entries->end();
+    uint64_t lru_time = std::numeric_limits<uint64_t>::max();
+    for (auto it = new_entries->begin(); it != new_entries->end(); ++it) {
+      auto last_used = it->second->last_used.load(std::memory_order_relaxed);
+      if (last_used < lru_time) {
+        lru = it;
+        lru_time = last_used;
+      }
+    }
+    // frames still using the evicted pattern keep it alive through their shared_ptr
+    new_entries->erase(lru);
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // lookups from now on stamp their entries as more recent than the new one
+  auto now = clock_.fetch_add(1, std::memory_order_relaxed);
+  new_entries->emplace(std::move(key), std::make_shared<const Entry>(std::move(mem_patterns), now));
+  SetSnapshot(std::move(new_entries));
+}
+
+MemoryPatternCacheStats MemoryPatternCache::GetStats() const {
+  MemoryPatternCacheStats stats;
+  for (const auto& hits : hits_) {
+    stats.hits += hits.count.load(std::memory_order_relaxed);
+  }
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  stats.evictions = evictions_.load(std::memory_order_relaxed);
+  stats.num_entries = Snapshot()->size();
+  return stats;
+}
+}  // namespace onnxruntime
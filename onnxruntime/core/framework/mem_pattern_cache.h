@@ -0,0 +1,119 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/framework/mem_pattern.h"
+#include "core/framework/tensor_shape.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+struct MemoryPatternCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  size_t num_entries = 0;
+};
+
+/**
+Bounded cache of the memory patterns generated for a set of input shapes.
+
+The key is the full shape signature (rank and dims of every input), so different shapes never share an entry.
+Optionally dims are rounded up to a multiple of dim_bucket_size so a single pattern serves a range of shapes.
+A pattern traced for bucketed shapes records the sizes the tensors would have for the largest shapes in the bucket
+(see ExecutionFrame), so it serves the whole range. A tensor that still doesn't fit in its block, e.g. one whose dim
+is a product of input dims, falls back to the allocator.
+
+Lookups search an immutable snapshot of the entries, which insertions replace (copy on write). A lookup locks
+snapshot_mutex_ only to copy the shared_ptr to the current snapshot, then searches it without the lock. This is
+what std::atomic_load of a shared_ptr would do as well, with a lock from a pool shared by the whole process.
+
+Once the cache is full, the least recently used entry is evicted, with the recency tracked approximately so hits
+don't write to memory shared by all the threads: a lookup stamps its entry with the number of insertions so far,
+and only writes when the stamp changes. Entries found between the same two insertions are equally recent.
+*/
+class MemoryPatternCache {
+ public:
+  static constexpr size_t kDefaultMaxEntries = 32;
+
+  MemoryPatternCache();
+
+  /**
+  Set the maximum number of cached patterns (0 for unbounded) and the dim bucket size (0 or 1 to use the exact
+  dims). Clears the cache. Not thread safe, call before the session is run.
+  */
+  void Configure(size_t max_entries, int64_t dim_bucket_size);
+
+  // Returns nullptr if no pattern was cached for the input shapes.
+  std::shared_ptr<const MemoryPatternGroup> Find(const std::vector<TensorShape>& input_shapes) const;
+
+  // Add the pattern generated for the input shapes. The first pattern inserted for a key is kept.
+  void Insert(const std::vector<TensorShape>& input_shapes, std::unique_ptr<MemoryPatternGroup> mem_patterns);
+
+  MemoryPatternCacheStats GetStats() const;
+
+  int64_t DimBucketSize() const { return dim_bucket_size_; }
+
+  // Round a dim up to the bucket it is looked up with.
+  int64_t BucketDim(int64_t dim) const {
+    return dim_bucket_size_ > 1 && dim > 0 ? ((dim + dim_bucket_size_ - 1) / dim_bucket_size_) * dim_bucket_size_
+                                           : dim;
+  }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(MemoryPatternCache);
+
+  using Key = std::vector<int64_t>;
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    explicit Entry(std::unique_ptr<MemoryPatternGroup> patterns0, uint64_t last_used0)
+        : patterns(std::move(patterns0)), last_used(last_used0) {}
+
+    const std::shared_ptr<const MemoryPatternGroup> patterns;
+    // value of clock_ at the last lookup, used to pick the entry to evict.
+    mutable std::atomic<uint64_t> last_used;
+  };
+
+  using EntryMap = std::unordered_map<Key, std::shared_ptr<const Entry>, KeyHash>;
+
+  // hits are counted in a few counters on separate cache lines, spread over the threads, so threads hitting the
+  // cache concurrently rarely write the same cache line
+  struct HitCounter {
+    std::atomic<uint64_t> count{0};
+    char padding[64 - sizeof(std::atomic<uint64_t>)];
+  };
+  static constexpr size_t kNumHitCounters = 8;
+
+  Key MakeKey(const std::vector<TensorShape>& input_shapes) const;
+
+  std::shared_ptr<const EntryMap> Snapshot() const;
+  void SetSnapshot(std::shared_ptr<const EntryMap> entries);
+
+  size_t max_entries_ = kDefaultMaxEntries;
+  int64_t dim_bucket_size_ = 0;
+
+  // current entries, replaced under write_mutex_.
+  std::shared_ptr<const EntryMap> entries_;  // GUARDED_BY(snapshot_mutex_)
+  mutable OrtMutex snapshot_mutex_;
+  OrtMutex write_mutex_;
+
+  // number of insertions, only written by Insert
+  std::atomic<uint64_t> clock_{0};
+  mutable HitCounter hits_[kNumHitCounters];
+  // a miss is followed by generating a pattern, which costs far more than counting it here
+  mutable std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+};
+}  // namespace onnxruntime
@@ -18,6 +18,7 @@ limitations under the License.
 #pragma once
 #include "core/framework/mem_pattern.h"
 #include "core/framework/allocation_planner.h"
+#include <algorithm>
 #include <list>
 
 namespace onnxruntime {
@@ -94,4 +95,87 @@ class MemPatternPlanner {
   size_t buffer_size{0};
 };
 
+// StaticMemPatternPlanner assigns offsets to tensors whose sizes and lifetimes are all known before execution,
+// so the pattern can be generated when the session is initialized instead of by tracing a first run.
+// Tensors are placed from the largest to the smallest. Each one goes into the smallest gap left between the
+// already placed tensors whose lifetimes intersect its own, or after the last of them if no gap is large enough.
+class StaticMemPatternPlanner {
+ public:
+  StaticMemPatternPlanner() = default;
+
+  // The tensor is live from the start of execution step first_step to the end of execution step last_step.
+  void AddTensor(int ml_value_idx, size_t size, size_t first_step, size_t last_step) {
+    tensors_.push_back({ml_value_idx, size, first_step, last_step});
+    naive_size_ += size;
+  }
+
+  // Sum of the tensor sizes, i.e. the buffer size needed without any sharing.
+  size_t NaiveSize() const {
+    return naive_size_;
+  }
+
+  MemoryPattern GenerateMemPattern() const {
+    std::vector<const TensorInfo*> order;
+    order.reserve(tensors_.size());
+    for (auto& tensor : tensors_) {
+      order.push_back(&tensor);
+    }
+
+    std::stable_sort(order.begin(), order.end(), [](const TensorInfo* a, const TensorInfo* b) {
+      return a->size > b->size || (a->size == b->size && a->first_step < b->first_step);
+    });
+
+    MemoryPattern pattern;
+    std::vector<std::pair<const TensorInfo*, MemoryBlock>> placed;
+    std::vector<MemoryBlock> live;
+    for (const TensorInfo* tensor : order) {
+      // blocks of the placed tensors that are live at the same time as this one, sorted by offset
+      live.clear();
+      for (auto& entry : placed) {
+        if (entry.first->first_step <= tensor->last_step && tensor->first_step <= entry.first->last_step) {
+          live.push_back(entry.second);
+        }
+      }
+      std::sort(live.begin(), live.end(),
+                [](const MemoryBlock& a, const MemoryBlock& b) { return a.offset_ < b.offset_; });
+
+      size_t current = 0;
+      size_t best_offset = 0;
+      size_t waste_bytes = std::numeric_limits<size_t>::max();
+      for (auto& block : live) {
+        if (block.offset_ >= current) {
+          auto gap = block.offset_ - current;
+          if (gap >= tensor->size && (gap - tensor->size) < waste_bytes) {
+            waste_bytes = gap - tensor->size;
+            best_offset = current;
+          }
+        }
+        current = std::max(current, block.offset_ + block.size_);
+      }
+
+      if (waste_bytes == std::numeric_limits<size_t>::max()) {
+        best_offset = current;
+      }
+
+      MemoryBlock block(best_offset, tensor->size);
+      placed.emplace_back(tensor, block);
+      pattern.patterns_[tensor->index] = block;
+      pattern.peak_size_ = std::max(pattern.peak_size_, best_offset + tensor->size);
+    }
+
+    return pattern;
+  }
+
+ private:
+  struct TensorInfo {
+    int index;
+    size_t size;
+    size_t first_step;
+    size_t last_step;
+  };
+
+  std::vector<TensorInfo> tensors_;
+  size_t naive_size_{0};
+};
+
 }  // namespace onnxruntime
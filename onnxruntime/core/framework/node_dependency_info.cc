@@ -0,0 +1,35 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/node_dependency_info.h"
+
+#include "core/graph/graph_viewer.h"
+
+namespace onnxruntime {
+
+NodeDependencyInfo::NodeDependencyInfo(const GraphViewer& graph_viewer)
+    : root_nodes_{graph_viewer.GetRootNodes()} {
+  const auto max_node_index = static_cast<size_t>(graph_viewer.MaxNodeIndex());
+
+  dependency_counts_.resize(max_node_index, 0);
+  successor_offsets_.resize(max_node_index + 1, 0);
+
+  for (const auto& node : graph_viewer.Nodes()) {
+    dependency_counts_[node.Index()] = static_cast<int>(node.GetInputEdgesCount());
+    successor_offsets_[node.Index() + 1] = node.GetOutputEdgesCount();
+  }
+
+  // convert the per node successor counts into offsets
+  for (size_t i = 1; i < successor_offsets_.size(); ++i) {
+    successor_offsets_[i] += successor_offsets_[i - 1];
+  }
+
+  successors_.resize(successor_offsets_.back());
+  for (const auto& node : graph_viewer.Nodes()) {
+    auto cur = successor_offsets_[node.Index()];
+    for (auto it = node.OutputEdgesBegin(), end = node.OutputEdgesEnd(); it != end; ++it) {
+      successors_[cur++] = it->GetNode().Index();
+    }
+  }
+}
+}  // namespace onnxruntime
@@ -0,0 +1,56 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <vector>
+
+#include "gsl/span"
+
+#include "core/common/common.h"
+#include "core/graph/basic_types.h"
+
+namespace onnxruntime {
+class GraphViewer;
+
+// Static dependency graph of the nodes in a GraphViewer.
+// It is computed once per session so the ParallelExecutor only needs to copy the dependency counts on each run.
+class NodeDependencyInfo final {
+ public:
+  explicit NodeDependencyInfo(const GraphViewer& graph_viewer);
+
+  // Number of input edges of the given Node, i.e. how many times a predecessor must complete before it can run.
+  // Returns 0 if the Node with the given node_index did not exist when the NodeDependencyInfo was created.
+  int GetDependencyCount(onnxruntime::NodeIndex node_index) const {
+    ORT_ENFORCE(node_index < dependency_counts_.size());
+    return dependency_counts_[node_index];
+  }
+
+  // Nodes consuming an output of the given Node. A successor is listed once per edge so that decrementing its
+  // dependency count once per entry balances GetDependencyCount.
+  gsl::span<const onnxruntime::NodeIndex> GetSuccessors(onnxruntime::NodeIndex node_index) const {
+    ORT_ENFORCE(node_index + 1 < successor_offsets_.size());
+    auto begin = successor_offsets_[node_index];
+    auto end = successor_offsets_[node_index + 1];
+    return gsl::make_span(successors_.data() + begin, end - begin);
+  }
+
+  // Nodes without input edges. These are ready to run at the start of every execution.
+  const std::vector<onnxruntime::NodeIndex>& GetRootNodes() const { return root_nodes_; }
+
+  // Size of the per node state required to track the dependency counts of a run.
+  size_t MaxNodeIndex() const { return dependency_counts_.size(); }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(NodeDependencyInfo);
+
+  // Indexed by Node::Index().
+  std::vector<int> dependency_counts_;
+
+  // The successors of the Node with index i are successors_[successor_offsets_[i], successor_offsets_[i + 1]).
+  std::vector<size_t> successor_offsets_;
+  std::vector<onnxruntime::NodeIndex> successors_;
+
+  std::vector<onnxruntime::NodeIndex> root_nodes_;
+};
+}  // namespace onnxruntime
@@ -122,6 +122,10 @@ const SessionState& OpKernelContext::GetSessionState() const {
   return execution_frame_->GetSessionState();
 }
 
+concurrency::ThreadPool* OpKernelContext::GetOperatorThreadPool() const {
+  return GetSessionState().GetIntraOpThreadPool();
+}
+
 const MLValue* OpKernelContext::GetInputMLValue(int index) const {
   if (index < 0 || index >= InputCount())
     return nullptr;
@@ -9,24 +9,23 @@
 #include <vector>
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
-
-#ifndef USE_EIGEN_THREADPOOL
-#include "core/common/task_thread_pool.h"
-#endif
+#include "core/common/metrics.h"
+#include "core/platform/threadpool.h"
 
 #include "core/framework/allocation_planner.h"
 #include "core/framework/execution_frame.h"
 #include "core/framework/session_state.h"
 #include "core/framework/op_kernel_context_internal.h"
+#include "core/framework/utils.h"
 
 namespace onnxruntime {
 
 ParallelExecutor::ParallelExecutor(const SessionState& session_state, const bool& terminate_flag)
-    : out_standings_(0), terminate_flag_{terminate_flag} {
-  auto graph_viewer = session_state.GetGraphViewer();
-  node_refs_.resize(graph_viewer->MaxNodeIndex());
-  for (auto& node : graph_viewer->Nodes()) {
-    node_refs_[node.Index()] = node.GetInputEdgesCount();
+    : dependency_info_(&session_state.GetNodeDependencyInfo()), terminate_flag_{terminate_flag} {
+  const auto max_node_index = dependency_info_->MaxNodeIndex();
+  node_refs_ = std::make_unique<std::atomic<int>[]>(max_node_index);
+  for (size_t i = 0; i < max_node_index; ++i) {
+    node_refs_[i].store(dependency_info_->GetDependencyCount(i), std::memory_order_relaxed);
   }
 }
 
@@ -43,20 +42,32 @@ Status ParallelExecutor::Execute(const SessionState& session_state,
   }
 
   root_frame_ = std::make_unique<ExecutionFrame>(feeds, output_names, fetches, fetch_allocators, session_state);
-  //std::cout << "start nodes:" << std::endl;
-  for (auto node_index : session_state.GetGraphViewer()->GetRootNodes()) {
+
+  {
+    std::lock_guard<OrtMutex> lock(complete_mutex_);
+    done_ = false;
+  }
+
+  // hold a reference while the root nodes are enqueued so a fast root node can't complete the run early.
+  out_standings_.fetch_add(1, std::memory_order_relaxed);
+  for (auto node_index : dependency_info_->GetRootNodes()) {
     auto p_op_kernel = session_state.GetKernel(node_index);
     if (!p_op_kernel)
       continue;
 
-    //std::cout << "\t" << p_op_kernel->Node().Name() << std::endl;
     EnqueueNode(node_index, session_state, logger);
   }
+  FinishNodeRun();
 
   // Wait for finish.
   {
     std::unique_lock<OrtMutex> lock(complete_mutex_);
-    while (out_standings_ > 0) complete_cv_.wait(lock);
+    complete_cv_.wait(lock, [this]() { return done_; });
+  }
+
+  {
+    std::lock_guard<OrtMutex> lock(error_mutex_);
+    ORT_RETURN_IF_ERROR(error_status_);
   }
 
   VLOGS(logger, 1) << "Fetching output.";
@@ -83,7 +94,12 @@ Status ParallelExecutor::Execute(const SessionState& session_state,
   }
 
   if (f_profiler_enabled) {
-    session_state.Profiler().EndTimeAndRecordEvent(profiling::SESSION_EVENT, "ParallelExecutor::Execute", tp);
+    auto mem_pattern_stats = session_state.GetMemoryPatternCacheStats();
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::SESSION_EVENT, "ParallelExecutor::Execute", tp,
+                                                   {{"mem_pattern_cache_hits", std::to_string(mem_pattern_stats.hits)},
+                                                    {"mem_pattern_cache_misses", std::to_string(mem_pattern_stats.misses)},
+                                                    {"mem_pattern_cache_evictions",
+                                                     std::to_string(mem_pattern_stats.evictions)}});
   }
   return Status::OK();
 }
@@ -93,10 +109,14 @@ void ParallelExecutor::RunNodeAsync(size_t p_node_index,
                                     const logging::Logger& logger) {
   try {
     RunNodeAsyncInternal(p_node_index, session_state, logger);
+  } catch (const std::exception& ex) {
+    SetError(ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, ex.what()));
   } catch (...) {
-    FinishNodeRun();
-    throw;
+    SetError(ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, "Unknown exception running node."));
   }
+
+  // must be last as Execute may return once the final outstanding node has finished.
+  FinishNodeRun();
 }
 
 void ParallelExecutor::RunNodeAsyncInternal(size_t p_node_index,
@@ -178,10 +198,20 @@ void ParallelExecutor::RunNodeAsyncInternal(size_t p_node_index,
     // call compute on the kernel
     VLOGS(logger, 1) << "Computing kernel: " << p_op_kernel->Node().Name();
 
+    profiling::Metrics* metrics = session_state.GetMetrics();
+    TimePoint compute_begin_time;
+    if (metrics != nullptr) {
+      compute_begin_time = std::chrono::high_resolution_clock::now();
+    }
+
     // Execute the kernel.
     auto status = p_op_kernel->Compute(&op_kernel_context);
     if (!status.IsOK()) {
-      ORT_THROW("Compute failed for node: ", graph_viewer->GetNode(node_index)->Name());
+      ORT_THROW("Compute failed for node: ", graph_viewer->GetNode(node_index)->Name(), ". ", status.ErrorMessage());
+    }
+    if (metrics != nullptr) {
+      metrics->RecordNode(node_index,
+                          profiling::Metrics::DurationNs(compute_begin_time, std::chrono::high_resolution_clock::now()));
     }
     if (f_profiler_enabled) {
       session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
@@ -223,50 +253,28 @@ void ParallelExecutor::RunNodeAsyncInternal(size_t p_node_index,
     keep_running = false;
 
     // Checking which output nodes ready for running.
-    {
-      auto begin = p_op_kernel->Node().OutputEdgesBegin();
-      auto end = p_op_kernel->Node().OutputEdgesEnd();
-
-      std::lock_guard<OrtMutex> lock(ref_mutex_);
-      for (auto it = begin; it != end; it++) {
-        auto idx = (*it).GetNode().Index();
-        if ((--node_refs_[idx]) == 0) {
-          if (!keep_running) {
-            node_index = idx;
-            keep_running = true;
-          } else {
-            EnqueueNode(idx, session_state, logger);
-          }
+    // The first ready successor keeps running on this thread to avoid a context switch, the others are handed to
+    // the thread pool. When called from a pool thread Schedule pushes to that thread's own queue, from which idle
+    // threads steal.
+    for (auto idx : dependency_info_->GetSuccessors(node_index)) {
+      if (node_refs_[idx].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        if (!keep_running) {
+          node_index = idx;
+          keep_running = true;
+        } else {
+          EnqueueNode(idx, session_state, logger);
         }
-
-        // std::cout << "handle output, current name: " << p_op_kernel->Node().Name() << ", current index: "
-        // << p_node_index << ", output name: " << (*it)->GetNode().Name() << ", output index: "
-        // << (*it)->GetNode().Index() << ", after -- output ref: " << node_refs_[idx] << std::endl;
       }
     }
   }
-
-  FinishNodeRun();
 }
 
 void ParallelExecutor::EnqueueNode(size_t p_node_index, const SessionState& session_state, const logging::Logger& logger) {
-  {
-    std::unique_lock<OrtMutex> lock(complete_mutex_);
-    out_standings_++;
-  }
+  out_standings_.fetch_add(1, std::memory_order_relaxed);
 
-#ifdef USE_EIGEN_THREADPOOL
   session_state.GetThreadPool()->Schedule([this, p_node_index, &session_state, &logger]() {
-    try {
-      ParallelExecutor::RunNodeAsync(p_node_index, std::cref(session_state), std::cref(logger));
-    } catch (...) {
-      // catch node processing failure exceptions here to prevent app crash.
-    }
+    ParallelExecutor::RunNodeAsync(p_node_index, std::cref(session_state), std::cref(logger));
   });
-#else
-  std::packaged_task<void()> task{std::bind(&ParallelExecutor::RunNodeAsync, this, p_node_index, std::cref(session_state), std::cref(logger))};
-  session_state.GetThreadPool()->RunTask(std::move(task));
-#endif
 }
 
 Status ParallelExecutor::FetchOutput(const MLValueNameIdxMap& name_idx_map,
@@ -291,7 +299,7 @@ Status ParallelExecutor::FetchOutput(const MLValueNameIdxMap& name_idx_map,
     ORT_RETURN_IF_ERROR(name_idx_map.GetIdx(oname, mlvalue_index));
     const MLValue& output_mlvalue = frame.GetMLValue(mlvalue_index);
     VLOGS(logger, 1) << "Copying fetched MLValue to output vector";
-    fetches[idx++] = output_mlvalue;
+    ORT_RETURN_IF_ERROR(utils::FetchOutputValue(output_mlvalue, fetches[idx++]));
   }
 
   VLOGS(logger, 1) << "Done with execution.";
@@ -3,8 +3,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <vector>
-#include <condition_variable>
 #include "core/common/common.h"
 #include "core/common/status.h"
 #include "core/common/logging/logging.h"
@@ -46,24 +47,34 @@ class ParallelExecutor : public IExecutor {
                      const logging::Logger& logger);
 
   void FinishNodeRun() {
-    bool finished = false;
-    {
-      //Because we have a mutex here, it's not possible another thread is doing the test("while (out_standings_ > 0)"
+    if (out_standings_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      // only the last node to finish takes the lock. Execute waits for done_ under the lock, so it can't return
+      // and destroy this executor before notify_all is done.
       std::lock_guard<OrtMutex> lock(complete_mutex_);
-      finished = --out_standings_ == 0;
-    }
-    if (finished) {
-      //std::cout << "all out standing nodes are completed." << std::endl;
+      done_ = true;
       complete_cv_.notify_all();
     }
   }
 
+  void SetError(const Status& status) {
+    std::lock_guard<OrtMutex> lock(error_mutex_);
+    if (error_status_.IsOK()) {
+      error_status_ = status;
+    }
+  }
+
   std::unique_ptr<ExecutionFrame> root_frame_;
-  std::vector<size_t> node_refs_;
-  OrtMutex ref_mutex_;
-  int out_standings_;  //protected by complete_mutex_
+  const NodeDependencyInfo* dependency_info_ = nullptr;
+  // remaining number of predecessors for each node in the current run, indexed by node index.
+  std::unique_ptr<std::atomic<int>[]> node_refs_;
+  std::atomic<int> out_standings_{0};
   OrtMutex complete_mutex_;
   OrtCondVar complete_cv_;
+  bool done_ = false;  // protected by complete_mutex_
+
+  // first failure of the current run. nodes downstream of a failed node are not run.
+  OrtMutex error_mutex_;
+  Status error_status_;  //protected by error_mutex_
 
   const bool& terminate_flag_;
 };
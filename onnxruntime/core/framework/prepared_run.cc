@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/prepared_run.h"
+
+#include "core/framework/session_state.h"
+
+namespace onnxruntime {
+
+PreparedRun::PreparedRun(const SessionState& session_state,
+                         const RunOptions& run_options,
+                         const std::vector<std::string>& input_names,
+                         const std::vector<MLDataType>& input_types,
+                         const std::vector<std::string>& output_names,
+                         std::unique_ptr<logging::Logger> owned_logger,
+                         const logging::Logger& logger)
+    : session_state_(session_state),
+      run_options_(run_options),
+      input_names_(input_names),
+      input_types_(input_types),
+      output_names_(output_names),
+      owned_logger_(std::move(owned_logger)),
+      logger_(&logger) {
+  auto& mlvalue_idx_map = session_state_.GetMLValueNameIdxMap();
+
+  feed_mlvalue_idxs_.reserve(input_names_.size());
+  for (const auto& name : input_names_) {
+    int mlvalue_idx;
+    Status status = mlvalue_idx_map.GetIdx(name, mlvalue_idx);
+    ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
+    feed_mlvalue_idxs_.push_back(mlvalue_idx);
+  }
+
+  fetch_mlvalue_idxs_.reserve(output_names_.size());
+  for (const auto& name : output_names_) {
+    int mlvalue_idx;
+    Status status = mlvalue_idx_map.GetIdx(name, mlvalue_idx);
+    ORT_ENFORCE(status.IsOK(), status.ErrorMessage());
+    fetch_mlvalue_idxs_.push_back(mlvalue_idx);
+  }
+}
+
+bool PreparedRun::CanReuseFrame(const std::vector<MLValue>& feeds) const {
+  if (!frame_ || frame_->HasPlan() || frame_input_shapes_.size() != feeds.size()) {
+    return false;
+  }
+
+  for (size_t i = 0, end = feeds.size(); i < end; ++i) {
+    if (!feeds[i].IsTensor() || feeds[i].Get<Tensor>().Shape() != frame_input_shapes_[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+common::Status PreparedRun::PrepareFrame(const std::vector<MLValue>& feeds, const std::vector<MLValue>& fetches) {
+  if (CanReuseFrame(feeds)) {
+    frame_->Reset(feed_mlvalue_idxs_, feeds, fetch_mlvalue_idxs_, fetches);
+    return Status::OK();
+  }
+
+  ReleaseFrame();
+  frame_ = std::make_unique<ExecutionFrame>(feed_mlvalue_idxs_, feeds, fetch_mlvalue_idxs_, fetches, session_state_);
+
+  frame_input_shapes_.reserve(feeds.size());
+  for (const auto& feed : feeds) {
+    if (!feed.IsTensor()) {
+      frame_input_shapes_.clear();
+      break;
+    }
+    frame_input_shapes_.push_back(feed.Get<Tensor>().Shape());
+  }
+
+  const auto& exec_plan_vec = session_state_.GetExecutionPlan()->execution_plan;
+  kernel_contexts_.reserve(exec_plan_vec.size());
+  for (const auto& node_exec_plan : exec_plan_vec) {
+    auto p_op_kernel = session_state_.GetKernel(node_exec_plan.node_index);
+
+    // if a kernel has been added in the session state, it better be NON-null.
+    if (p_op_kernel == nullptr) {
+      ReleaseFrame();
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Got nullptr from GetKernel for node: ",
+                             session_state_.GetGraphViewer()->GetNode(node_exec_plan.node_index)->Name());
+    }
+
+    kernel_contexts_.push_back(std::make_unique<OpKernelContextInternal>(
+        *frame_, *p_op_kernel, *logger_, p_op_kernel->Node().ImplicitInputDefs(), run_options_.terminate));
+  }
+
+  return Status::OK();
+}
+
+void PreparedRun::ReleaseFrame() {
+  // the kernel contexts refer to the frame
+  kernel_contexts_.clear();
+  frame_input_shapes_.clear();
+  frame_.reset();
+}
+
+}  // namespace onnxruntime
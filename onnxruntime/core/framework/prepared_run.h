@@ -0,0 +1,87 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/logging/logging.h"
+#include "core/common/status.h"
+#include "core/framework/data_types.h"
+#include "core/framework/execution_frame.h"
+#include "core/framework/ml_value.h"
+#include "core/framework/op_kernel_context_internal.h"
+#include "core/framework/run_options.h"
+
+namespace onnxruntime {
+class SessionState;
+
+/**
+A run of a session for a fixed set of input and output names, created by InferenceSession::PrepareRun.
+
+The names are resolved to MLValue indices once. The SequentialExecutor keeps the ExecutionFrame and the
+kernel contexts of the prepared run across runs as long as the input shapes don't change, so a run of a
+small model doesn't pay for the name lookups, the frame construction and the memory pattern lookup again.
+
+A prepared run is not thread-safe. Use one per thread. The RunOptions it was created with must outlive it.
+*/
+class PreparedRun {
+ public:
+  // The names must be valid input and output names of the session_state's graph. input_types holds the
+  // expected type of each input, which is the element type for a tensor.
+  PreparedRun(const SessionState& session_state,
+              const RunOptions& run_options,
+              const std::vector<std::string>& input_names,
+              const std::vector<MLDataType>& input_types,
+              const std::vector<std::string>& output_names,
+              std::unique_ptr<logging::Logger> owned_logger,
+              const logging::Logger& logger);
+
+  const std::vector<std::string>& InputNames() const noexcept { return input_names_; }
+  const std::vector<std::string>& OutputNames() const noexcept { return output_names_; }
+
+  const std::vector<MLDataType>& InputTypes() const noexcept { return input_types_; }
+
+  const RunOptions& GetRunOptions() const noexcept { return run_options_; }
+  const logging::Logger& Logger() const noexcept { return *logger_; }
+
+  /**
+  Get the frame for a run with feeds and fetches, reusing the frame of the previous run if the feeds have the
+  same shapes. The kernel contexts are rebuilt along with the frame.
+  */
+  common::Status PrepareFrame(const std::vector<MLValue>& feeds, const std::vector<MLValue>& fetches);
+
+  ExecutionFrame& Frame() { return *frame_; }
+
+  // The context of the i-th node of the execution plan.
+  OpKernelContextInternal& KernelContext(size_t i) { return *kernel_contexts_[i]; }
+
+  const std::vector<int>& FetchMLValueIdxs() const noexcept { return fetch_mlvalue_idxs_; }
+
+  // Drop the frame so the next run creates a new one, e.g. after the frame traced a memory pattern.
+  void ReleaseFrame();
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(PreparedRun);
+
+  bool CanReuseFrame(const std::vector<MLValue>& feeds) const;
+
+  const SessionState& session_state_;
+  const RunOptions& run_options_;
+  const std::vector<std::string> input_names_;
+  const std::vector<MLDataType> input_types_;
+  const std::vector<std::string> output_names_;
+  std::vector<int> feed_mlvalue_idxs_;
+  std::vector<int> fetch_mlvalue_idxs_;
+  std::unique_ptr<logging::Logger> owned_logger_;
+  const logging::Logger* logger_;
+
+  std::unique_ptr<ExecutionFrame> frame_;
+  // the feed shapes the frame was created for. empty if a feed isn't a tensor, in which case the frame isn't reused.
+  std::vector<TensorShape> frame_input_shapes_;
+  std::vector<std::unique_ptr<OpKernelContextInternal>> kernel_contexts_;
+};
+}  // namespace onnxruntime
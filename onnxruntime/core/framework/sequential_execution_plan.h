@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "core/graph/basic_types.h"
 #include "core/framework/alloc_kind.h"
 #include "core/framework/data_types.h"
@@ -17,6 +19,8 @@ using MLValueIndex = int;
 using MLValueName = std::string;
 
 class SessionState;
+struct MemoryPatternGroup;
+
 // SequentialExecutionPlan: This is the data that is produced by a static
 // planner for a sequential execution, to be used by a SequentialExecutor.
 struct SequentialExecutionPlan {
@@ -66,6 +70,33 @@ struct SequentialExecutionPlan {
 
   // to_be_freed: vector elements represent indices of ml-values to be freed (as described above)
   std::vector<MLValueIndex> to_be_freed;
+
+  // Static memory plan: offsets of all the kAllocate tensors within one buffer per location, computed from
+  // the lifetimes implied by execution_plan and to_be_freed. It is only set for a sequential plan in which the
+  // shapes of all these tensors are known statically, and replaces the memory patterns traced at runtime.
+  std::shared_ptr<const MemoryPatternGroup> static_mem_patterns;
+
+  // For each location of static_mem_patterns, the sum of the tensor sizes, i.e. the memory needed without sharing.
+  std::vector<size_t> static_mem_naive_sizes;
+
+  // ExecutionChain: a sequence of nodes in which every node only consumes outputs of the previous node and is
+  // its only consumer, so only the first node depends on other chains and only the last node has consumers in
+  // other chains.
+  struct ExecutionChain {
+    // indices into execution_plan, in execution order
+    std::vector<size_t> steps;
+
+    // number of chains that must complete before this chain can start
+    int dependency_count{0};
+
+    // chains consuming an output of the last node of this chain
+    std::vector<size_t> successors;
+  };
+
+  // Chains partitioning execution_plan so that chains that don't depend on each other can run concurrently.
+  // It is only set for a plan created for branch parallel execution with at least two chains. The allocation
+  // plan and to_be_freed then only share or free a buffer once nothing in another chain can still use it.
+  std::vector<ExecutionChain> chains;
 };
 
 // Output details of an execution plan:
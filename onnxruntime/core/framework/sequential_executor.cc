@@ -3,15 +3,23 @@
 
 #include "core/framework/sequential_executor.h"
 
+#include <algorithm>
 #include <chrono>
+#include <functional>
+#include <memory>
 #include <thread>
 #include <vector>
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
+#include "core/common/metrics.h"
+#include "core/platform/ort_mutex.h"
+#include "core/platform/threadpool.h"
 #include "core/framework/allocation_planner.h"
 #include "core/framework/execution_frame.h"
 #include "core/framework/session_state.h"
 #include "core/framework/op_kernel_context_internal.h"
+#include "core/framework/prepared_run.h"
+#include "core/framework/utils.h"
 
 namespace onnxruntime {
 
@@ -26,6 +34,15 @@ static Status ReleaseNodeMLValues(ExecutionFrame& frame,
                                   const SequentialExecutionPlan::NodeExecutionPlan& node_exec_plan,
                                   const logging::Logger& logger);
 
+static Status ExecuteKernel(const SessionState& session_state,
+                            const OpKernel& op_kernel,
+                            OpKernelContextInternal& op_kernel_context,
+                            const logging::Logger& logger);
+
+static Status ExecuteSteps(const SessionState& session_state,
+                           const SequentialExecutionPlan& seq_exec_plan,
+                           const std::function<Status(size_t)>& execute_step);
+
 Status SequentialExecutor::Execute(const SessionState& session_state,
                                    const NameMLValMap& feeds,
                                    const std::vector<std::string>& output_names,
@@ -34,8 +51,6 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
                                    const logging::Logger& logger) {
   bool f_profiler_enabled = session_state.Profiler().FEnabled();
   TimePoint tp;
-  TimePoint sync_time_begin;
-  TimePoint kernel_begin_time;
 
   if (f_profiler_enabled) {
     tp = session_state.Profiler().StartTime();
@@ -51,12 +66,13 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
   // uncomment the line below to dump execution plan
   //std::cout << std::make_pair(p_seq_exec_plan, &session_state) << "\n";
 
-  for (const auto& node_exec_plan : exec_plan_vec) {
+  auto execute_step = [&](size_t step) -> Status {
     if (terminate_flag_) {
       LOGS(logger, WARNING) << "Exiting due to terminate flag being set to true.";
       return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
     }
 
+    const auto& node_exec_plan = exec_plan_vec[step];
     auto node_index = node_exec_plan.node_index;
     auto p_op_kernel = session_state.GetKernel(node_index);
 
@@ -70,110 +86,99 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
     OpKernelContextInternal op_kernel_context(frame, *p_op_kernel, logger, p_op_kernel->Node().ImplicitInputDefs(),
                                               terminate_flag_);
     // TODO: log kernel outputs?
-    if (f_profiler_enabled) {
-      sync_time_begin = session_state.Profiler().StartTime();
-    }
-
-    // sync before compute
-    int queue_id = p_op_kernel->KernelDef().ExecQueueId();
-    for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.InputFence(input_index);
-      if (fence) {
-        auto execution_provider_type = p_op_kernel->Node().GetExecutionProviderType();
-        if (OrtMemTypeCPUInput == p_op_kernel->KernelDef().InputMemoryType(input_index)) {
-          execution_provider_type = kCpuExecutionProvider;
-        }
-        fence->BeforeUsingAsInput(execution_provider_type, queue_id);
-      }
-    }
+    ORT_RETURN_IF_ERROR(ExecuteKernel(session_state, *p_op_kernel, op_kernel_context, logger));
 
-    for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
-      if (fence) {
-        auto execution_provider_type = p_op_kernel->Node().GetExecutionProviderType();
-        if (OrtMemTypeCPUInput == p_op_kernel->KernelDef().InputMemoryType(input_index)) {
-          execution_provider_type = kCpuExecutionProvider;
-        }
-        fence->BeforeUsingAsInput(execution_provider_type, queue_id);
+    // free ml-values corresponding to this node
+    VLOGS(logger, 1) << "Releasing node ML values after computing kernel: " << p_op_kernel->Node().Name();
+    return ReleaseNodeMLValues(frame, seq_exec_plan, node_exec_plan, logger);
+  };
+
+  ORT_RETURN_IF_ERROR(ExecuteSteps(session_state, seq_exec_plan, execute_step));
+
+  VLOGS(logger, 1) << "Fetching output.";
+  ORT_RETURN_IF_ERROR(FetchOutput(session_state.GetMLValueNameIdxMap(), frame, output_names, fetches, logger));
+
+  if (frame.HasPlan()) {
+    std::vector<TensorShape> input_shapes;
+    bool all_tensors = true;
+    for (const auto& feed : feeds) {
+      if (!(feed.second.IsTensor())) {
+        all_tensors = false;
+        break;
       }
+      auto& tensor = feed.second.Get<Tensor>();
+      input_shapes.push_back(tensor.Shape());
     }
 
-    for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
-      Fence_t fence = op_kernel_context.OutputFence(output_index);
-      if (fence) {
-        fence->BeforeUsingAsOutput(p_op_kernel->Node().GetExecutionProviderType(), queue_id);
-      }
+    if (all_tensors) {
+      auto mem_patterns = std::make_unique<MemoryPatternGroup>();
+      ORT_RETURN_IF_ERROR(frame.GeneratePatterns(mem_patterns.get()));
+      ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(input_shapes, std::move(mem_patterns)));
     }
+  }
 
-    if (f_profiler_enabled) {
-      session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
-                                                     p_op_kernel->Node().Name() + "_fence_before",
-                                                     sync_time_begin,
-                                                     {{"op_name", p_op_kernel->KernelDef().OpName()}});
+  if (f_profiler_enabled) {
+    auto mem_pattern_stats = session_state.GetMemoryPatternCacheStats();
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::SESSION_EVENT, "SequentialExecutor::Execute", tp,
+                                                   {{"mem_pattern_cache_hits", std::to_string(mem_pattern_stats.hits)},
+                                                    {"mem_pattern_cache_misses", std::to_string(mem_pattern_stats.misses)},
+                                                    {"mem_pattern_cache_evictions",
+                                                     std::to_string(mem_pattern_stats.evictions)}});
+  }
 
-      // call compute on the kernel
-      VLOGS(logger, 1) << "Computing kernel: " << p_op_kernel->Node().Name();
+  return Status::OK();
+}
 
-      kernel_begin_time = session_state.Profiler().StartTime();
-    }
-    ORT_RETURN_IF_ERROR(p_op_kernel->Compute(&op_kernel_context));
+Status SequentialExecutor::Execute(const SessionState& session_state,
+                                   PreparedRun& prepared_run,
+                                   const std::vector<MLValue>& feeds,
+                                   std::vector<MLValue>& fetches) {
+  bool f_profiler_enabled = session_state.Profiler().FEnabled();
+  TimePoint tp;
 
-    if (f_profiler_enabled) {
-      session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
-                                                     p_op_kernel->Node().Name() + "_kernel_time",
-                                                     kernel_begin_time,
-                                                     {{"op_name", p_op_kernel->KernelDef().OpName()}});
+  if (f_profiler_enabled) {
+    tp = session_state.Profiler().StartTime();
+  }
 
-      sync_time_begin = session_state.Profiler().StartTime();
-    }
+  const logging::Logger& logger = prepared_run.Logger();
+  ORT_RETURN_IF_ERROR(prepared_run.PrepareFrame(feeds, fetches));
+  ExecutionFrame& frame = prepared_run.Frame();
 
-    // sync after compute for outputs
-    for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.InputFence(input_index);
-      if (fence) {
-        fence->AfterUsedAsInput(queue_id);
-      }
-    }
+  const SequentialExecutionPlan& seq_exec_plan = *session_state.GetExecutionPlan();
+  const auto& exec_plan_vec = seq_exec_plan.execution_plan;
 
-    for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
-      Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
-      if (fence) {
-        fence->AfterUsedAsInput(queue_id);
-      }
+  auto execute_step = [&](size_t step) -> Status {
+    if (terminate_flag_) {
+      LOGS(logger, WARNING) << "Exiting due to terminate flag being set to true.";
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
     }
 
-    for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
-      Fence_t fence = op_kernel_context.OutputFence(output_index);
-      if (fence) {
-        fence->AfterUsedAsOutput(queue_id);
-      }
-    }
+    OpKernelContextInternal& op_kernel_context = prepared_run.KernelContext(step);
+    ORT_RETURN_IF_ERROR(ExecuteKernel(session_state, *session_state.GetKernel(exec_plan_vec[step].node_index),
+                                      op_kernel_context, logger));
+    return ReleaseNodeMLValues(frame, seq_exec_plan, exec_plan_vec[step], logger);
+  };
 
-    if (f_profiler_enabled) {
-      session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
-                                                     p_op_kernel->Node().Name() + "_fence_after",
-                                                     sync_time_begin,
-                                                     {{"op_name", p_op_kernel->KernelDef().OpName()}});
-    }
+  ORT_RETURN_IF_ERROR(ExecuteSteps(session_state, seq_exec_plan, execute_step));
 
-    // free ml-values corresponding to this node
-    VLOGS(logger, 1) << "Releasing node ML values after computing kernel: " << p_op_kernel->Node().Name();
-    ORT_RETURN_IF_ERROR(ReleaseNodeMLValues(frame, seq_exec_plan, node_exec_plan, logger));
+  const auto& fetch_mlvalue_idxs = prepared_run.FetchMLValueIdxs();
+  if (fetches.empty()) {
+    fetches.resize(fetch_mlvalue_idxs.size());
+  }
+  for (size_t i = 0, end = fetch_mlvalue_idxs.size(); i < end; ++i) {
+    ORT_RETURN_IF_ERROR(utils::FetchOutputValue(frame.GetMLValue(fetch_mlvalue_idxs[i]), fetches[i]));
   }
-
-  VLOGS(logger, 1) << "Fetching output.";
-  ORT_RETURN_IF_ERROR(FetchOutput(session_state.GetMLValueNameIdxMap(), frame, output_names, fetches, logger));
 
   if (frame.HasPlan()) {
+    // the frame traced the memory pattern for these shapes. cache it and let the next run use it in a new frame.
     std::vector<TensorShape> input_shapes;
     bool all_tensors = true;
     for (const auto& feed : feeds) {
-      if (!(feed.second.IsTensor())) {
+      if (!feed.IsTensor()) {
         all_tensors = false;
         break;
       }
-      auto& tensor = feed.second.Get<Tensor>();
-      input_shapes.push_back(tensor.Shape());
+      input_shapes.push_back(feed.Get<Tensor>().Shape());
     }
 
     if (all_tensors) {
@@ -181,10 +186,252 @@ Status SequentialExecutor::Execute(const SessionState& session_state,
       ORT_RETURN_IF_ERROR(frame.GeneratePatterns(mem_patterns.get()));
       ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(input_shapes, std::move(mem_patterns)));
     }
+    prepared_run.ReleaseFrame();
+  }
+
+  if (f_profiler_enabled) {
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::SESSION_EVENT, "SequentialExecutor::ExecutePrepared", tp);
+  }
+
+  return Status::OK();
+}
+
+namespace {
+// Runs the chains of a branch parallel execution plan. A chain is ready once all the chains it depends on have
+// completed. The thread calling Run and the helper tasks on the session's thread pool take ready chains until all
+// of them have completed or one has failed. A helper task may start after the run is over, so the state is
+// reference counted and the step function and the plan are only touched by a thread that took a chain.
+class ChainScheduler {
+ public:
+  ChainScheduler(const SequentialExecutionPlan& seq_exec_plan, const std::function<Status(size_t)>& execute_step)
+      : chains_(seq_exec_plan.chains),
+        execute_step_(&execute_step),
+        num_chains_(seq_exec_plan.chains.size()),
+        dependency_counts_(num_chains_) {
+    for (size_t i = 0; i < num_chains_; ++i) {
+      dependency_counts_[i] = chains_[i].dependency_count;
+      if (dependency_counts_[i] == 0) {
+        ready_chains_.push_back(i);
+      }
+    }
+  }
+
+  // Take and run ready chains until there is nothing left to run.
+  void RunChains() {
+    std::unique_lock<OrtMutex> lock(mutex_);
+    for (;;) {
+      cv_.wait(lock, [this]() { return Done() || !ready_chains_.empty(); });
+      if (Done()) {
+        break;
+      }
+
+      size_t chain = ready_chains_.back();
+      ready_chains_.pop_back();
+      ++running_chains_;
+      lock.unlock();
+
+      Status status = RunChain(chain);
+
+      lock.lock();
+      --running_chains_;
+      if (!status.IsOK()) {
+        if (status_.IsOK()) {
+          status_ = status;
+        }
+        failed_ = true;
+      } else {
+        ++completed_chains_;
+        size_t num_ready = 0;
+        for (auto successor : chains_[chain].successors) {
+          if (--dependency_counts_[successor] == 0) {
+            ready_chains_.push_back(successor);
+            ++num_ready;
+          }
+        }
+
+        // this thread continues with one of the chains that became ready
+        if (!Done()) {
+          for (size_t i = 1; i < num_ready; ++i) {
+            cv_.notify_one();
+          }
+          continue;
+        }
+      }
+
+      // the thread calling Run waits for the chains running on other threads once it is done
+      cv_.notify_all();
+    }
+  }
+
+  // Wait for the chains still running on other threads and return the status of the run.
+  Status Wait() {
+    std::unique_lock<OrtMutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return running_chains_ == 0; });
+    return status_;
+  }
+
+ private:
+  bool Done() const { return failed_ || completed_chains_ == num_chains_; }
+
+  Status RunChain(size_t chain) {
+    try {
+      for (auto step : chains_[chain].steps) {
+        ORT_RETURN_IF_ERROR((*execute_step_)(step));
+      }
+    } catch (const std::exception& ex) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, ex.what());
+    } catch (...) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, "Unknown exception running chain.");
+    }
+
+    return Status::OK();
+  }
+
+  const std::vector<SequentialExecutionPlan::ExecutionChain>& chains_;
+  const std::function<Status(size_t)>* execute_step_;
+  const size_t num_chains_;
+
+  OrtMutex mutex_;
+  OrtCondVar cv_;
+  // the following are protected by mutex_
+  std::vector<int> dependency_counts_;
+  std::vector<size_t> ready_chains_;
+  size_t running_chains_ = 0;
+  size_t completed_chains_ = 0;
+  bool failed_ = false;
+  Status status_;
+};
+}  // namespace
+
+// Run execute_step for every step of the execution plan. The chains of a branch parallel plan run concurrently on
+// the calling thread and at most one helper task per thread of the session's thread pool.
+static Status ExecuteSteps(const SessionState& session_state,
+                           const SequentialExecutionPlan& seq_exec_plan,
+                           const std::function<Status(size_t)>& execute_step) {
+  concurrency::ThreadPool* thread_pool = session_state.GetThreadPool();
+  if (seq_exec_plan.chains.empty() || thread_pool == nullptr) {
+    for (size_t step = 0, end = seq_exec_plan.execution_plan.size(); step < end; ++step) {
+      ORT_RETURN_IF_ERROR(execute_step(step));
+    }
+
+    return Status::OK();
+  }
+
+  auto scheduler = std::make_shared<ChainScheduler>(seq_exec_plan, execute_step);
+  const size_t num_helpers = std::min(static_cast<size_t>(thread_pool->NumThreads()),
+                                      seq_exec_plan.chains.size() - 1);
+  for (size_t i = 0; i < num_helpers; ++i) {
+    thread_pool->Schedule([scheduler]() { scheduler->RunChains(); });
+  }
+
+  scheduler->RunChains();
+  return scheduler->Wait();
+}
+
+static Status ExecuteKernel(const SessionState& session_state,
+                            const OpKernel& op_kernel,
+                            OpKernelContextInternal& op_kernel_context,
+                            const logging::Logger& logger) {
+  bool f_profiler_enabled = session_state.Profiler().FEnabled();
+  TimePoint sync_time_begin;
+  TimePoint kernel_begin_time;
+
+  if (f_profiler_enabled) {
+    sync_time_begin = session_state.Profiler().StartTime();
+  }
+
+  // sync before compute
+  int queue_id = op_kernel.KernelDef().ExecQueueId();
+  for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.InputFence(input_index);
+    if (fence) {
+      auto execution_provider_type = op_kernel.Node().GetExecutionProviderType();
+      if (OrtMemTypeCPUInput == op_kernel.KernelDef().InputMemoryType(input_index)) {
+        execution_provider_type = kCpuExecutionProvider;
+      }
+      fence->BeforeUsingAsInput(execution_provider_type, queue_id);
+    }
+  }
+
+  for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
+    if (fence) {
+      auto execution_provider_type = op_kernel.Node().GetExecutionProviderType();
+      if (OrtMemTypeCPUInput == op_kernel.KernelDef().InputMemoryType(input_index)) {
+        execution_provider_type = kCpuExecutionProvider;
+      }
+      fence->BeforeUsingAsInput(execution_provider_type, queue_id);
+    }
+  }
+
+  for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
+    Fence_t fence = op_kernel_context.OutputFence(output_index);
+    if (fence) {
+      fence->BeforeUsingAsOutput(op_kernel.Node().GetExecutionProviderType(), queue_id);
+    }
+  }
+
+  if (f_profiler_enabled) {
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
+                                                   op_kernel.Node().Name() + "_fence_before",
+                                                   sync_time_begin,
+                                                   {{"op_name", op_kernel.KernelDef().OpName()}});
+
+    // call compute on the kernel
+    VLOGS(logger, 1) << "Computing kernel: " << op_kernel.Node().Name();
+
+    kernel_begin_time = session_state.Profiler().StartTime();
+  }
+
+  profiling::Metrics* metrics = session_state.GetMetrics();
+  TimePoint compute_begin_time;
+  if (metrics != nullptr) {
+    compute_begin_time = std::chrono::high_resolution_clock::now();
+  }
+
+  ORT_RETURN_IF_ERROR(op_kernel.Compute(&op_kernel_context));
+
+  if (metrics != nullptr) {
+    metrics->RecordNode(op_kernel.Node().Index(),
+                        profiling::Metrics::DurationNs(compute_begin_time, std::chrono::high_resolution_clock::now()));
+  }
+
+  if (f_profiler_enabled) {
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
+                                                   op_kernel.Node().Name() + "_kernel_time",
+                                                   kernel_begin_time,
+                                                   {{"op_name", op_kernel.KernelDef().OpName()}});
+
+    sync_time_begin = session_state.Profiler().StartTime();
+  }
+
+  // sync after compute for outputs
+  for (int input_index = 0; input_index < op_kernel_context.InputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.InputFence(input_index);
+    if (fence) {
+      fence->AfterUsedAsInput(queue_id);
+    }
+  }
+
+  for (int input_index = 0; input_index < op_kernel_context.ImplicitInputCount(); ++input_index) {
+    Fence_t fence = op_kernel_context.ImplicitInputFence(input_index);
+    if (fence) {
+      fence->AfterUsedAsInput(queue_id);
+    }
+  }
+
+  for (int output_index = 0; output_index < op_kernel_context.OutputCount(); ++output_index) {
+    Fence_t fence = op_kernel_context.OutputFence(output_index);
+    if (fence) {
+      fence->AfterUsedAsOutput(queue_id);
+    }
   }
 
   if (f_profiler_enabled) {
-    session_state.Profiler().EndTimeAndRecordEvent(profiling::SESSION_EVENT, "SequentialExecutor::Execute", tp);
+    session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
+                                                   op_kernel.Node().Name() + "_fence_after",
+                                                   sync_time_begin,
+                                                   {{"op_name", op_kernel.KernelDef().OpName()}});
   }
 
   return Status::OK();
@@ -212,7 +459,7 @@ static Status FetchOutput(const MLValueNameIdxMap& name_idx_map,
     ORT_RETURN_IF_ERROR(name_idx_map.GetIdx(oname, mlvalue_index));
     const MLValue& output_mlvalue = frame.GetMLValue(mlvalue_index);
     VLOGS(logger, 1) << "Copying fetched MLValue to output vector";
-    fetches[idx++] = output_mlvalue;
+    ORT_RETURN_IF_ERROR(utils::FetchOutputValue(output_mlvalue, fetches[idx++]));
   }
 
   VLOGS(logger, 1) << "Done with execution.";
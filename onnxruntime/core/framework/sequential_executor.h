@@ -14,6 +14,8 @@
 #include "core/graph/graph_viewer.h"
 
 namespace onnxruntime {
+class PreparedRun;
+
 class SequentialExecutor : public IExecutor {
  public:
   SequentialExecutor(const bool& terminate_flag = false) : terminate_flag_{terminate_flag} {}
@@ -25,6 +27,16 @@ class SequentialExecutor : public IExecutor {
                          const std::unordered_map<size_t, CustomAllocator> fetch_allocators,
                          const logging::Logger& logger) override;
 
+  /**
+  Run with the frame and the kernel contexts of prepared_run, which are reused across runs with the same input
+  shapes. feeds and fetches are in the order of the input and output names of prepared_run.
+  The session must have a single execution provider, as no copies across devices are made.
+  */
+  common::Status Execute(const SessionState& session_state,
+                         PreparedRun& prepared_run,
+                         const std::vector<MLValue>& feeds,
+                         std::vector<MLValue>& fetches);
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SequentialExecutor);
   const bool& terminate_flag_;
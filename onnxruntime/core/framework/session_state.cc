@@ -71,36 +71,23 @@ void SessionState::SetProfiler(profiling::Profiler& profiler) {
   return *profiler_;
 }
 
-static int64_t CalculateMemoryPatternsKey(const std::vector<TensorShape>& shapes) {
-  int64_t key = 0;
-  for (auto& shape : shapes) {
-    for (auto dim : shape.GetDims())
-      key ^= dim;
-  }
-  return key;
-}
-
-const MemoryPatternGroup* SessionState::GetMemoryPatternGroup(const std::vector<TensorShape>& input_shapes) const {
-  std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
-  int64_t key = CalculateMemoryPatternsKey(input_shapes);
-  auto it = mem_patterns_.find(key);
-  if (it == mem_patterns_.end())
-    return nullptr;
-
-  return it->second.get();
+std::shared_ptr<const MemoryPatternGroup> SessionState::GetMemoryPatternGroup(
+    const std::vector<TensorShape>& input_shapes) const {
+  return mem_patterns_.Find(input_shapes);
 }
 
 Status SessionState::UpdateMemoryPatternGroupCache(const std::vector<TensorShape>& input_shape,
                                                    std::unique_ptr<MemoryPatternGroup> mem_patterns) const {
-  int64_t key = CalculateMemoryPatternsKey(input_shape);
+  mem_patterns_.Insert(input_shape, std::move(mem_patterns));
+  return Status::OK();
+}
 
-  std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
-  auto it = mem_patterns_.find(key);
-  if (it == mem_patterns_.end()) {
-    mem_patterns_[key] = std::move(mem_patterns);
-  }
+void SessionState::SetMemoryPatternCacheOptions(size_t max_entries, int64_t dim_bucket_size) {
+  mem_patterns_.Configure(max_entries, dim_bucket_size);
+}
 
-  return Status::OK();
+MemoryPatternCacheStats SessionState::GetMemoryPatternCacheStats() const {
+  return mem_patterns_.GetStats();
 }
 
 void SessionState::SetEnableMemoryPattern(bool flag) {
@@ -228,4 +215,20 @@ const NodeIndexInfo& SessionState::GetNodeIndexInfo() const {
   return *node_index_info_;
 }
 
+void SessionState::CalculateNodeDependencyInfo() {
+  ORT_ENFORCE(graph_viewer_);
+  node_dependency_info_ = std::make_unique<NodeDependencyInfo>(*graph_viewer_);
+
+  for (auto& node_to_map_pair : subgraph_session_states_) {
+    for (auto& attr_name_to_subgraph : node_to_map_pair.second) {
+      attr_name_to_subgraph.second->CalculateNodeDependencyInfo();
+    }
+  }
+}
+
+const NodeDependencyInfo& SessionState::GetNodeDependencyInfo() const {
+  ORT_ENFORCE(node_dependency_info_, "CalculateNodeDependencyInfo must be called prior to GetNodeDependencyInfo.");
+  return *node_dependency_info_;
+}
+
 }  // namespace onnxruntime
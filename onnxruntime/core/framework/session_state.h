@@ -8,6 +8,7 @@
 #include <vector>
 #include "gsl/gsl_util"
 
+#include "core/platform/env.h"
 #include "core/platform/ort_mutex.h"
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
@@ -16,16 +17,14 @@
 #include "core/framework/execution_providers.h"
 #include "core/framework/kernel_registry_manager.h"
 #include "core/framework/mem_pattern.h"
+#include "core/framework/mem_pattern_cache.h"
 #include "core/framework/ml_value.h"
 #include "core/framework/mlvalue_name_idx_map.h"
+#include "core/framework/node_dependency_info.h"
 #include "core/framework/node_index_info.h"
 #include "core/graph/graph_viewer.h"
 #include "core/framework/fuse_nodes_funcs.h"
 
-#ifdef USE_EIGEN_THREADPOOL
-#include <unsupported/Eigen/CXX11/ThreadPool>
-#endif
-
 namespace onnxruntime {
 
 class ExecutionProviders;
@@ -34,10 +33,12 @@ class OpKernel;
 class NodeIndexInfo;
 struct SequentialExecutionPlan;
 struct MemoryPatternGroup;
-
-#ifndef USE_EIGEN_THREADPOOL
-class TaskThreadPool;
-#endif
+namespace concurrency {
+class ThreadPool;
+}
+namespace profiling {
+class Metrics;
+}
 
 // SessionState should be modified by the inference session class only.
 // It is supposed to be passed by const-ref only to all the executors.
@@ -102,10 +103,15 @@ class SessionState {
   */
   profiling::Profiler& Profiler() const;
 
+  /// Latency metrics recorded for the nodes of this graph, nullptr if they are disabled.
+  profiling::Metrics* GetMetrics() const { return metrics_; }
+  void SetMetrics(profiling::Metrics* metrics) { metrics_ = metrics; }
+
   /**
-  Get cached memory pattern based on input shapes
+  Get cached memory pattern based on input shapes.
+  The returned pattern stays valid while the caller holds it, even if it is evicted from the cache.
   */
-  const MemoryPatternGroup* GetMemoryPatternGroup(const std::vector<TensorShape>& input_shapes) const;
+  std::shared_ptr<const MemoryPatternGroup> GetMemoryPatternGroup(const std::vector<TensorShape>& input_shapes) const;
 
   /**
   Set generated memory pattern with a given input shapes. 
@@ -114,6 +120,23 @@ class SessionState {
   Status UpdateMemoryPatternGroupCache(const std::vector<TensorShape>& input_shape,
                                        std::unique_ptr<MemoryPatternGroup> mem_patterns) const;
 
+  /**
+  Set the maximum number of cached memory patterns (0 for unbounded) and the size of the buckets input dims are
+  rounded up to when looking up a pattern (0 to use the exact dims). Clears the cache.
+  */
+  void SetMemoryPatternCacheOptions(size_t max_entries, int64_t dim_bucket_size);
+
+  /**
+  Get the hit/miss/eviction counters of the memory pattern cache.
+  */
+  MemoryPatternCacheStats GetMemoryPatternCacheStats() const;
+
+  /**
+  Round an input dim up to the bucket the memory pattern cache looks it up with.
+  */
+  int64_t BucketMemoryPatternDim(int64_t dim) const { return mem_patterns_.BucketDim(dim); }
+  bool HasMemoryPatternDimBuckets() const { return mem_patterns_.DimBucketSize() > 1; }
+
   /**
   Set enable memory pattern flag
   */
@@ -157,13 +180,13 @@ class SessionState {
 
   SessionState* GetMutableSubgraphSessionState(onnxruntime::NodeIndex index, const std::string& attribute_name);
 
-#ifdef USE_EIGEN_THREADPOOL
-  Eigen::NonBlockingThreadPool* GetThreadPool() const { return thread_pool_; }
-  void SetThreadPool(Eigen::NonBlockingThreadPool* p_pool) { thread_pool_ = p_pool; }
-#else
-  TaskThreadPool* GetThreadPool() const { return thread_pool_; }
-  void SetThreadPool(TaskThreadPool* p_pool) { thread_pool_ = p_pool; }
-#endif
+  /// Thread pool used by the parallel executor to run independent nodes concurrently.
+  concurrency::ThreadPool* GetThreadPool() const { return thread_pool_; }
+  void SetThreadPool(concurrency::ThreadPool* p_pool) { thread_pool_ = p_pool; }
+
+  /// Thread pool used by kernels to parallelize the computation of a single node.
+  concurrency::ThreadPool* GetIntraOpThreadPool() const { return intra_op_thread_pool_; }
+  void SetIntraOpThreadPool(concurrency::ThreadPool* p_pool) { intra_op_thread_pool_ = p_pool; }
 
   bool ExportDll() const { return export_fused_dll_; }
   void SetExportDllFlag(bool flag) { export_fused_dll_ = flag; }
@@ -173,9 +196,16 @@ class SessionState {
 
   std::map<OrtAllocatorInfo, BufferUniquePtr>& GetMutableWeightsBuffers() { return weights_buffers_; }
 
+  // memory mapped external data files that initialized tensors may point into
+  std::vector<Env::MappedMemoryPtr>& GetMutableMappedFiles() { return mapped_files_; }
+
   void CalculateNodeIndexInfo();
   const NodeIndexInfo& GetNodeIndexInfo() const;
 
+  /// Compute the static node dependency graph used by the ParallelExecutor.
+  void CalculateNodeDependencyInfo();
+  const NodeDependencyInfo& GetNodeDependencyInfo() const;
+
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SessionState);
 
@@ -187,6 +217,9 @@ class SessionState {
   const ExecutionProviders& execution_providers_;  // owned by InferenceSession
   MLValueNameIdxMap mlvalue_name_idx_map_;
 
+  // declared before initialized_tensors_ so the mappings outlive the tensors referring to them
+  std::vector<Env::MappedMemoryPtr> mapped_files_;
+
   // initialized tensorset
   std::unordered_map<int, MLValue> initialized_tensors_;  // key is mlvalue_index
   std::map<OrtAllocatorInfo, BufferUniquePtr> weights_buffers_;
@@ -194,13 +227,12 @@ class SessionState {
 
   const logging::Logger* logger_;
   profiling::Profiler* profiler_;
+  profiling::Metrics* metrics_ = nullptr;  // owned by InferenceSession
 
   // switch for enable memory pattern optimization or not.
   bool enable_mem_pattern_ = true;
-  // lock for the mem_patterns_
-  mutable OrtMutex mem_patterns_lock_;
   // cache for the generated mem_patterns. key is calculated based on input shapes.
-  mutable std::map<int64_t, std::unique_ptr<MemoryPatternGroup>> mem_patterns_;
+  mutable MemoryPatternCache mem_patterns_;
 
   NameNodeInfoMapType input_names_to_nodeinfo_mapping_;
   NameNodeInfoMapType output_names_to_nodeinfo_mapping_;
@@ -211,15 +243,13 @@ class SessionState {
       std::unordered_map<onnxruntime::NodeIndex, std::unordered_map<std::string, std::unique_ptr<SessionState>>>;
   SubgraphSessionStateMap subgraph_session_states_;
 
-#ifdef USE_EIGEN_THREADPOOL
-  Eigen::NonBlockingThreadPool* thread_pool_ = nullptr;
-#else
-  TaskThreadPool* thread_pool_ = nullptr;
-#endif
+  concurrency::ThreadPool* thread_pool_ = nullptr;           // owned by InferenceSession
+  concurrency::ThreadPool* intra_op_thread_pool_ = nullptr;  // owned by InferenceSession
 
   bool export_fused_dll_ = false;
   FuncManager fused_funcs_mgr_;
 
   std::unique_ptr<NodeIndexInfo> node_index_info_;
+  std::unique_ptr<NodeDependencyInfo> node_dependency_info_;
 };
 }  // namespace onnxruntime
@@ -3,14 +3,18 @@
 
 #include "core/framework/session_state_initializer.h"
 
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <limits>
+#include <unordered_map>
 
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
 
 #include "core/graph/graph_viewer.h"
 #include "core/framework/graph_partitioner.h"
+#include "core/framework/mem_pattern.h"
 #include "core/framework/ml_value.h"
 #include "core/framework/ml_value_patterns_planner.h"
 #include "core/framework/mlvalue_name_idx_map.h"
@@ -19,6 +23,7 @@
 #include "core/framework/tensorutils.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/framework/utils.h"
+#include "core/platform/env.h"
 
 namespace onnxruntime {
 
@@ -28,12 +33,28 @@ static common::Status SaveMLValueNameIndexMapping(const onnxruntime::Graph& grap
 
 using SaveTensorFunc = std::function<void(int idx, const onnxruntime::MLValue&)>;
 
-static common::Status SaveInitializedTensors(const onnxruntime::Graph& graph,
+// Maps the files holding the external data of initializers into memory, each file once.
+// The mappings are kept in the SessionState so they live as long as the tensors pointing into them.
+class ExternalDataLoader {
+ public:
+  ExternalDataLoader(const std::string& model_dir, std::vector<Env::MappedMemoryPtr>& mapped_files)
+      : model_dir_{model_dir}, mapped_files_{mapped_files} {}
+
+  common::Status GetData(const ONNX_NAMESPACE::TensorProto& tensor_proto, void*& data, size_t& length);
+
+ private:
+  const std::string& model_dir_;
+  std::vector<Env::MappedMemoryPtr>& mapped_files_;
+  std::unordered_map<std::string, std::pair<char*, size_t>> files_;  // path -> mapped address and length
+};
+
+static common::Status SaveInitializedTensors(onnxruntime::Graph& graph,
                                              bool enable_memory_pattern,
                                              const SequentialExecutionPlan& execution_plan,
                                              const ExecutionProviders& exec_providers,
                                              const MLValueNameIdxMap& mlvalue_name_idx_map,
                                              std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
+                                             ExternalDataLoader& external_data_loader,
                                              const SaveTensorFunc& save_tensor_func,
                                              const logging::Logger& logger);
 
@@ -50,16 +71,19 @@ static common::Status SaveInputOutputNamesToNodeMapping(const onnxruntime::Graph
 SessionStateInitializer::SessionStateInitializer(onnxruntime::Graph& graph,
                                                  SessionState& session_state,
                                                  const ExecutionProviders& providers,
-                                                 KernelRegistryManager& kernel_registry_manager)
+                                                 KernelRegistryManager& kernel_registry_manager,
+                                                 const std::string& model_dir)
     : graph_{graph},
       session_state_{session_state},
       execution_providers_{providers},
       kernel_registry_manager_{kernel_registry_manager},
-      logger_{session_state.Logger()} {
+      logger_{session_state.Logger()},
+      model_dir_{model_dir} {
 }
 
 common::Status SessionStateInitializer::CreatePlan(const std::vector<NodeArg*>& outer_scope_node_args,
-                                                   bool enable_sequential_execution) {
+                                                   bool enable_sequential_execution,
+                                                   bool enable_branch_parallel_execution) {
   session_state_.SetGraphViewer(std::make_unique<onnxruntime::GraphViewer>(graph_));
 
   auto& mlvalue_name_idx_map = session_state_.GetMLValueNameIdxMap();
@@ -81,9 +105,25 @@ common::Status SessionStateInitializer::CreatePlan(const std::vector<NodeArg*>&
   if (enable_sequential_execution) {
     // CreatePlan will create a new SequentialExecutionPlan instance that we will
     // save into the session state.
+    SequentialPlannerContext context(false /* enable parallel execution */, enable_branch_parallel_execution);
     ORT_RETURN_IF_ERROR(
         SequentialPlanner::CreatePlan(viewer, valid_outer_scope_node_args, execution_providers_,
-                                      kernel_registry_manager_, mlvalue_name_idx_map, exec_plan));
+                                      kernel_registry_manager_, mlvalue_name_idx_map, context, exec_plan));
+
+    if (!exec_plan->chains.empty()) {
+      LOGS(logger_, INFO) << "Partitioned the execution plan into " << exec_plan->chains.size()
+                          << " chains for branch parallel execution. Memory patterns are not used.";
+    } else if (exec_plan->static_mem_patterns) {
+      const auto& mem_patterns = *exec_plan->static_mem_patterns;
+      for (size_t i = 0; i < mem_patterns.locations.size(); ++i) {
+        LOGS(logger_, INFO) << "Static memory plan for " << mem_patterns.locations[i].ToString()
+                            << ": planned peak " << mem_patterns.patterns[i].PeakSize() << " bytes, naive sum "
+                            << exec_plan->static_mem_naive_sizes[i] << " bytes.";
+      }
+    } else {
+      LOGS(logger_, INFO) << "No static memory plan as the intermediate tensor sizes are not all known statically. "
+                             "Memory patterns will be traced at runtime if enabled.";
+    }
 
     session_state_.SetExecutionPlan(std::move(exec_plan));
   } else {
@@ -112,9 +152,11 @@ common::Status SessionStateInitializer::InitializeAndSave(bool enable_memory_pat
     session_state_.AddInitializedTensor(idx, value);
   };
 
+  ExternalDataLoader external_data_loader(model_dir_, session_state_.GetMutableMappedFiles());
+
   ORT_RETURN_IF_ERROR(SaveInitializedTensors(graph_, enable_memory_pattern, exec_plan, execution_providers_,
                                              mlvalue_name_idx_map, session_state_.GetMutableWeightsBuffers(),
-                                             add_initialized_tensor, logger_));
+                                             external_data_loader, add_initialized_tensor, logger_));
 
   graph_.CleanAllInitializedTensors();  // remove weights from the graph now to save memory
 
@@ -179,16 +221,131 @@ common::Status SaveMLValueNameIndexMapping(const onnxruntime::Graph& graph,
   return Status::OK();
 }
 
+common::Status ExternalDataLoader::GetData(const ONNX_NAMESPACE::TensorProto& tensor_proto,
+                                           void*& data, size_t& length) {
+  std::string location;
+  size_t offset;
+  ORT_RETURN_IF_ERROR(utils::GetExternalDataInfo(tensor_proto, location, offset, length));
+
+  std::string path;
+  ORT_RETURN_IF_ERROR(utils::GetExternalDataPath(model_dir_, location, path));
+  auto it = files_.find(path);
+  if (it == files_.end()) {
+    Env::MappedMemoryPtr mapped_file;
+    size_t file_length;
+    ORT_RETURN_IF_ERROR(Env::Default().MapFileIntoMemory(path, mapped_file, file_length));
+    it = files_.emplace(path, std::make_pair(mapped_file.get(), file_length)).first;
+    mapped_files_.push_back(std::move(mapped_file));
+  }
+
+  const size_t file_length = it->second.second;
+  if (offset > file_length || length > file_length - offset) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "External data of tensor ", tensor_proto.name(),
+                           " at offset ", offset, " with length ", length, " is out of the bounds of ", path,
+                           " (", file_length, " bytes)");
+  }
+
+  data = it->second.first + offset;
+  return Status::OK();
+}
+
+static bool IsLittleEndianOrder() noexcept {
+  static int n = 1;
+  return (*reinterpret_cast<char*>(&n) == 1);
+}
+
+static bool IsCpuLocation(const OrtAllocatorInfo& alloc_info) {
+  return strcmp(alloc_info.name, CPU) == 0 || alloc_info.mem_type == OrtMemTypeCPUOutput;
+}
+
+static common::Status CopyTensorToProvider(const IExecutionProvider& provider, const Tensor& src, Tensor& dst) {
+  Status copy_status = provider.CopyTensor(src, dst);
+  if (!copy_status.IsOK()) {
+    if (copy_status.ErrorMessage().empty()) {
+      // The windows execution provider does not return any error message today for CopyTensor since it is
+      // not implemented yet. That's the reason we're adding our own error message so that we can debug better.
+      return Status(copy_status.Category(),
+                    copy_status.Code(),
+                    "Failed to copy tensor to execution provider: " + provider.Type());
+    }
+    return copy_status;
+  }
+  return Status::OK();
+}
+
+// Mapped external data is used in place when it is for a CPU tensor and suitably aligned for the kernels.
+// Otherwise it is copied to a tensor allocated from the allocator of the planned location.
+constexpr size_t kExternalDataAlignment = 64;
+
+static common::Status DeserializeExternalTensorProto(const ONNX_NAMESPACE::TensorProto& tensor_proto,
+                                                     const OrtAllocatorInfo& alloc_info,
+                                                     const ExecutionProviders& exec_providers,
+                                                     ExternalDataLoader& external_data_loader,
+                                                     MLValue& mlvalue) {
+  if (!IsLittleEndianOrder()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED,
+                           "External data is stored in little-endian order, which this platform does not use.");
+  }
+
+  void* data;
+  size_t length;
+  ORT_RETURN_IF_ERROR(external_data_loader.GetData(tensor_proto, data, length));
+
+  const bool is_cpu = IsCpuLocation(alloc_info);
+  std::unique_ptr<Tensor> p_mapped_tensor;
+  ORT_RETURN_IF_ERROR(utils::GetTensorFromExternalData(
+      tensor_proto, data, length,
+      is_cpu ? alloc_info : exec_providers.Get(kCpuExecutionProvider)->GetAllocator(0, OrtMemTypeDefault)->Info(),
+      &p_mapped_tensor));
+
+  std::unique_ptr<Tensor> p_tensor;
+  if (is_cpu && reinterpret_cast<uintptr_t>(data) % kExternalDataAlignment == 0) {
+    p_tensor = std::move(p_mapped_tensor);
+  } else {
+    auto alloc_ptr = utils::GetAllocator(exec_providers, alloc_info);
+    if (!alloc_ptr) {
+      return Status(common::ONNXRUNTIME, common::FAIL, "Failed to get allocator for alloc_info: " + alloc_info.ToString());
+    }
+
+    p_tensor = std::make_unique<Tensor>(p_mapped_tensor->DataType(),
+                                        p_mapped_tensor->Shape(),
+                                        static_cast<void*>(alloc_ptr->Alloc(length)),
+                                        alloc_info,
+                                        alloc_ptr);
+    if (is_cpu) {
+      if (length > 0) {
+        memcpy(p_tensor->MutableDataRaw(), data, length);
+      }
+    } else {
+      const IExecutionProvider* provider = exec_providers.Get(alloc_info);
+      ORT_ENFORCE(provider != nullptr);
+      ORT_RETURN_IF_ERROR(CopyTensorToProvider(*provider, *p_mapped_tensor, *p_tensor));
+    }
+  }
+
+  mlvalue.Init(p_tensor.release(),
+               DataTypeImpl::GetType<Tensor>(),
+               DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+  return Status::OK();
+}
+
 common::Status DeserializeTensorProto(const ONNX_NAMESPACE::TensorProto& tensor_proto,
                                       const OrtAllocatorInfo& alloc_info,
                                       const ExecutionProviders& exec_providers,
+                                      ExternalDataLoader& external_data_loader,
                                       MLValue& mlvalue, void* preallocated, size_t preallocated_size) {
+  if (utils::HasExternalData(tensor_proto)) {
+    // external tensors are never planned into the weights buffer
+    ORT_ENFORCE(preallocated == nullptr);
+    return DeserializeExternalTensorProto(tensor_proto, alloc_info, exec_providers, external_data_loader, mlvalue);
+  }
+
   auto alloc_ptr = utils::GetAllocator(exec_providers, alloc_info);
   if (!alloc_ptr) {
     return Status(common::ONNXRUNTIME, common::FAIL, "Failed to get allocator for alloc_info: " + alloc_info.ToString());
   }
 
-  if (strcmp(alloc_info.name, CPU) == 0 || alloc_info.mem_type == OrtMemTypeCPUOutput) {
+  if (IsCpuLocation(alloc_info)) {
     // deserialize directly to CPU tensor
     return utils::TensorProtoToMLValue(tensor_proto, alloc_ptr, preallocated, preallocated_size, mlvalue);
   }
@@ -209,17 +366,7 @@ common::Status DeserializeTensorProto(const ONNX_NAMESPACE::TensorProto& tensor_
       alloc_info,
       preallocated ? nullptr : alloc_ptr);  // no deleter for preallocated
 
-  Status copy_status = provider->CopyTensor(*p_deserialize_tensor, *p_tensor);
-  if (!copy_status.IsOK()) {
-    if (copy_status.ErrorMessage().empty()) {
-      // The windows execution provider does not return any error message today for CopyTensor since it is
-      // not implemented yet. That's the reason we're adding our own error message so that we can debug better.
-      return Status(copy_status.Category(),
-                    copy_status.Code(),
-                    "Failed to copy tensor to execution provider: " + provider->Type());
-    }
-    return copy_status;
-  }
+  ORT_RETURN_IF_ERROR(CopyTensorToProvider(*provider, *p_deserialize_tensor, *p_tensor));
   mlvalue.Init(p_tensor.release(),
                DataTypeImpl::GetType<Tensor>(),
                DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
@@ -228,6 +375,8 @@ common::Status DeserializeTensorProto(const ONNX_NAMESPACE::TensorProto& tensor_
 }
 
 static common::Status PlanTensor(MLValuePatternPlanner& planner, const MLValueNameIdxMap& mlvalue_name_idx_map, const std::string& name, const ONNX_NAMESPACE::TensorProto& tensor_proto) {
+  // external data is memory mapped or allocated separately, so it takes no space in the weights buffer
+  if (utils::HasExternalData(tensor_proto)) return Status::OK();
   int mlvalue_index;
   ORT_RETURN_IF_ERROR(mlvalue_name_idx_map.GetIdx(name, mlvalue_index));
   size_t len;
@@ -237,11 +386,12 @@ static common::Status PlanTensor(MLValuePatternPlanner& planner, const MLValueNa
   return planner.TraceAllocation(mlvalue_index, len);
 }
 
-common::Status SaveInitializedTensorsWithMemPattern(const Graph& graph,
+common::Status SaveInitializedTensorsWithMemPattern(Graph& graph,
                                                     const SequentialExecutionPlan& execution_plan,
                                                     const ExecutionProviders& exec_providers,
                                                     const MLValueNameIdxMap& mlvalue_name_idx_map,
                                                     std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
+                                                    ExternalDataLoader& external_data_loader,
                                                     const SaveTensorFunc& save_tensor_func,
                                                     const logging::Logger& logger) {
   LOGS(logger, INFO) << "Saving initialized tensors.";
@@ -282,6 +432,20 @@ common::Status SaveInitializedTensorsWithMemPattern(const Graph& graph,
     const ONNX_NAMESPACE::TensorProto& tensor_proto = *(entry.second);
 
     auto& location = execution_plan.allocation_plan[mlvalue_index].location;
+    MLValue mlvalue;
+    Status st;
+    if (utils::HasExternalData(tensor_proto)) {
+      // not planned, so there may be no weights buffer for its location
+      st = DeserializeTensorProto(tensor_proto, location, exec_providers, external_data_loader, mlvalue, nullptr, 0);
+      if (!st.IsOK()) {
+        return Status(st.Category(), st.Code(), "Deserialize tensor " + name + " failed." + st.ErrorMessage());
+      }
+
+      save_tensor_func(mlvalue_index, mlvalue);
+      VLOGS(logger, 1) << "Added external weight with name : " << name << " with index: " << mlvalue_index;
+      continue;
+    }
+
     auto it = weights_buffers.find(location);
     if (it == weights_buffers.end())
       return Status(common::ONNXRUNTIME, common::FAIL, "Weight buffer not found");
@@ -290,7 +454,6 @@ common::Status SaveInitializedTensorsWithMemPattern(const Graph& graph,
     if (pattern == nullptr)
       return Status(common::ONNXRUNTIME, common::FAIL, "mem pattern not found");
     auto block = pattern->GetBlock(mlvalue_index);
-    MLValue mlvalue;
     // if block is not found, means this mlvalue is not traced
     // fall back to allocate separate buffer.
 
@@ -298,11 +461,10 @@ common::Status SaveInitializedTensorsWithMemPattern(const Graph& graph,
     if (it->second == nullptr) {
       block = nullptr;
     }
-    Status st;
     if (!block) {
-      st = DeserializeTensorProto(tensor_proto, location, exec_providers, mlvalue, nullptr, 0);
+      st = DeserializeTensorProto(tensor_proto, location, exec_providers, external_data_loader, mlvalue, nullptr, 0);
     } else {
-      st = DeserializeTensorProto(tensor_proto, location, exec_providers, mlvalue,
+      st = DeserializeTensorProto(tensor_proto, location, exec_providers, external_data_loader, mlvalue,
                                   (uint8_t*)it->second.get() + block->offset_, block->size_);
     }
     if (!st.IsOK()) {
@@ -312,6 +474,8 @@ common::Status SaveInitializedTensorsWithMemPattern(const Graph& graph,
     }
 
     save_tensor_func(mlvalue_index, mlvalue);
+    // the data now lives in the tensor, so don't hold on to the protobuf copy until the graph is cleaned
+    graph.ReleaseInitializedTensorData(name);
 
     VLOGS(logger, 1) << "Added weight with name : " << name << " with index: " << mlvalue_index;
   }
@@ -320,10 +484,11 @@ common::Status SaveInitializedTensorsWithMemPattern(const Graph& graph,
   return common::Status::OK();
 }
 
-common::Status SaveInitializedTensorsWithSeperateBuffer(const onnxruntime::Graph& graph,
+common::Status SaveInitializedTensorsWithSeperateBuffer(onnxruntime::Graph& graph,
                                                         const SequentialExecutionPlan& execution_plan,
                                                         const ExecutionProviders& exec_providers,
                                                         const MLValueNameIdxMap& mlvalue_name_idx_map,
+                                                        ExternalDataLoader& external_data_loader,
                                                         const SaveTensorFunc& save_tensor_func,
                                                         const logging::Logger& logger) {
   LOGS(logger, INFO) << "Saving initialized tensors.";
@@ -338,8 +503,10 @@ common::Status SaveInitializedTensorsWithSeperateBuffer(const onnxruntime::Graph
     VLOGS(logger, 1) << "About to add weight with name: " << name << " and index: " << mlvalue_index;
     auto& location = execution_plan.allocation_plan[mlvalue_index].location;
     MLValue mlvalue;
-    ORT_RETURN_IF_ERROR(DeserializeTensorProto(*(entry.second), location, exec_providers, mlvalue, nullptr, 0));
+    ORT_RETURN_IF_ERROR(DeserializeTensorProto(*(entry.second), location, exec_providers, external_data_loader,
+                                               mlvalue, nullptr, 0));
     save_tensor_func(mlvalue_index, mlvalue);
+    graph.ReleaseInitializedTensorData(name);
     VLOGS(logger, 1) << "Added weight with name : " << name << " with index: " << mlvalue_index;
   }
 
@@ -347,12 +514,13 @@ common::Status SaveInitializedTensorsWithSeperateBuffer(const onnxruntime::Graph
   return common::Status::OK();
 }
 
-common::Status SaveInitializedTensors(const onnxruntime::Graph& graph,
+common::Status SaveInitializedTensors(onnxruntime::Graph& graph,
                                       bool enable_memory_pattern,
                                       const SequentialExecutionPlan& execution_plan,
                                       const ExecutionProviders& exec_providers,
                                       const MLValueNameIdxMap& mlvalue_name_idx_map,
                                       std::map<OrtAllocatorInfo, BufferUniquePtr>& weights_buffers,
+                                      ExternalDataLoader& external_data_loader,
                                       const SaveTensorFunc& save_tensor_func,
                                       const logging::Logger& logger) {
   // if we enable the memory pattern and already have the execution plan
@@ -360,10 +528,12 @@ common::Status SaveInitializedTensors(const onnxruntime::Graph& graph,
   // the weights.
   if (enable_memory_pattern) {
     return SaveInitializedTensorsWithMemPattern(graph, execution_plan, exec_providers,
-                                                mlvalue_name_idx_map, weights_buffers, save_tensor_func, logger);
+                                                mlvalue_name_idx_map, weights_buffers, external_data_loader,
+                                                save_tensor_func, logger);
   }
   return SaveInitializedTensorsWithSeperateBuffer(graph, execution_plan, exec_providers,
-                                                  mlvalue_name_idx_map, save_tensor_func, logger);
+                                                  mlvalue_name_idx_map, external_data_loader, save_tensor_func,
+                                                  logger);
 }
 
 static common::Status CreateOpKernelInternal(const onnxruntime::Node& node,
@@ -400,6 +570,36 @@ static common::Status CreateOpKernel(const onnxruntime::Node& node,
   return status;
 }
 
+// Give the kernel the chance to prepack the constant initializers it consumes.
+// N.B. A feed can override an initializer at run time, so a kernel must check that the input it is given is still
+// the tensor it prepacked.
+static common::Status PrePackInitializedTensors(const onnxruntime::Node& node,
+                                                const SessionState& session_state,
+                                                OpKernel& op_kernel,
+                                                const logging::Logger& logger) {
+  const auto& initializers = session_state.GetInitializedTensors();
+
+  int input_idx = 0;
+  for (const auto* input_def : node.InputDefs()) {
+    int mlvalue_idx;
+    if (input_def->Exists() &&
+        session_state.GetMLValueNameIdxMap().GetIdx(input_def->Name(), mlvalue_idx).IsOK()) {
+      auto iter = initializers.find(mlvalue_idx);
+      if (iter != initializers.end() && iter->second.IsTensor()) {
+        bool is_packed = false;
+        ORT_RETURN_IF_ERROR(op_kernel.PrePack(iter->second.Get<Tensor>(), input_idx, is_packed));
+        if (is_packed) {
+          VLOGS(logger, 1) << "Prepacked input " << input_idx << " of node " << node.Name();
+        }
+      }
+    }
+
+    ++input_idx;
+  }
+
+  return Status::OK();
+}
+
 common::Status SaveKernels(const ExecutionProviders& execution_providers,
                            SessionState& session_state,
                            const KernelRegistryManager& custom_registry_manager,
@@ -410,6 +610,7 @@ common::Status SaveKernels(const ExecutionProviders& execution_providers,
     // construct and save the kernels
     std::unique_ptr<OpKernel> op_kernel;
     ORT_RETURN_IF_ERROR(CreateOpKernel(node, execution_providers, session_state, custom_registry_manager, op_kernel, logger));
+    ORT_RETURN_IF_ERROR(PrePackInitializedTensors(node, session_state, *op_kernel, logger));
     session_state.AddKernel(node.Index(), std::move(op_kernel));
   }
 
@@ -3,6 +3,7 @@
 
 #pragma once
 #include <map>
+#include <string>
 
 #include "core/framework/allocator.h"
 #include "core/framework/tensor.h"
@@ -25,13 +26,18 @@ class SessionStateInitializer {
   SessionStateInitializer(onnxruntime::Graph& graph,
                           SessionState& session_state,
                           const ExecutionProviders& providers,
-                          KernelRegistryManager& kernel_registry_manager);
+                          KernelRegistryManager& kernel_registry_manager,
+                          const std::string& model_dir = {});
 
   // First perform any transformations and create the execution plan
+  // enable_branch_parallel_execution partitions a sequential plan into chains that may run concurrently.
   common::Status CreatePlan(const std::vector<NodeArg*>& outer_scope_node_args,
-                            bool enable_sequential_execution);
+                            bool enable_sequential_execution,
+                            bool enable_branch_parallel_execution = false);
 
   // initialize tensors, and save. save kernels and input/output node mappings
+  // initializers stored as external data are memory mapped. the protobuf copy of each initializer's data is
+  // released as soon as it has been saved.
   // @param enable_memory_pattern
   common::Status InitializeAndSave(bool enable_memory_pattern,
                                    const std::vector<NodeArg*>* implicit_inputs = nullptr);
@@ -43,5 +49,8 @@ class SessionStateInitializer {
   const ExecutionProviders& execution_providers_;
   KernelRegistryManager& kernel_registry_manager_;
   const logging::Logger& logger_;
+
+  // directory that external data locations of initializers are relative to
+  const std::string model_dir_;
 };
 }  // namespace onnxruntime
@@ -3,6 +3,7 @@
 
 #include "core/framework/tensorprotoutils.h"
 
+#include <cstdlib>
 #include <memory>
 #include "core/graph/onnx_protobuf.h"
 #include "core/common/logging/logging.h"
@@ -248,5 +249,141 @@ TensorProto::DataType GetTensorProtoType(const Tensor& tensor) {
   return dtype;
 }
 
+bool HasExternalData(const TensorProto& tensor_proto) {
+  return tensor_proto.has_data_location() &&
+         tensor_proto.data_location() == TensorProto_DataLocation_EXTERNAL;
+}
+
+#define CASE_TYPE(X, Y)                                                \
+  case ONNX_NAMESPACE::TensorProto_DataType::TensorProto_DataType_##X: \
+    return DataTypeImpl::GetType<Y>();
+
+static MLDataType GetNumericElementType(int data_type) {
+  switch (data_type) {
+    CASE_TYPE(FLOAT, float);
+    CASE_TYPE(DOUBLE, double);
+    CASE_TYPE(BOOL, bool);
+    CASE_TYPE(INT8, int8_t);
+    CASE_TYPE(INT16, int16_t);
+    CASE_TYPE(INT32, int32_t);
+    CASE_TYPE(INT64, int64_t);
+    CASE_TYPE(UINT8, uint8_t);
+    CASE_TYPE(UINT16, uint16_t);
+    CASE_TYPE(UINT32, uint32_t);
+    CASE_TYPE(UINT64, uint64_t);
+    CASE_TYPE(FLOAT16, MLFloat16);
+    CASE_TYPE(BFLOAT16, BFloat16);
+    default:
+      return nullptr;
+  }
+}
+
+static Status GetExternalDataSize(const TensorProto& tensor_proto, MLDataType& element_type, size_t& size) {
+  element_type = GetNumericElementType(tensor_proto.data_type());
+  if (element_type == nullptr) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "External data is not supported for tensor ",
+                           tensor_proto.name(), " with type ", tensor_proto.data_type());
+  }
+
+  TensorShape tensor_shape{GetTensorShapeFromTensorProto(tensor_proto)};
+  int64_t tensor_size = tensor_shape.Size();
+  if (tensor_size < 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid shape ", tensor_shape);
+  }
+
+  if (!IAllocator::CalcMemSizeForArray(static_cast<size_t>(tensor_size), element_type->Size(), &size)) {
+    return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "size overflow");
+  }
+
+  return Status::OK();
+}
+
+Status GetExternalDataInfo(const TensorProto& tensor_proto, std::string& location, size_t& offset, size_t& length) {
+  MLDataType element_type;
+  size_t expected_length;
+  ORT_RETURN_IF_ERROR(GetExternalDataSize(tensor_proto, element_type, expected_length));
+
+  location.clear();
+  offset = 0;
+  length = expected_length;
+
+  for (const auto& entry : tensor_proto.external_data()) {
+    if (entry.key() == "location") {
+      location = entry.value();
+    } else if (entry.key() == "offset" || entry.key() == "length") {
+      char* end = nullptr;
+      const auto value = std::strtoull(entry.value().c_str(), &end, 10);
+      if (entry.value().empty() || *end != '\0') {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid external data ", entry.key(), " '",
+                               entry.value(), "' for tensor ", tensor_proto.name());
+      }
+      (entry.key() == "offset" ? offset : length) = static_cast<size_t>(value);
+    }
+    // 'checksum' and unknown keys are ignored
+  }
+
+  if (location.empty()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Missing external data location for tensor ",
+                           tensor_proto.name());
+  }
+
+  if (length != expected_length) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "External data length of tensor ", tensor_proto.name(),
+                           " is ", length, " but its shape requires ", expected_length, " bytes");
+  }
+
+  return Status::OK();
+}
+
+Status GetExternalDataPath(const std::string& model_dir, const std::string& location, std::string& path) {
+  if (model_dir.empty()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "External data location '", location,
+                           "' can't be resolved as the model was not loaded from a file");
+  }
+
+  // reject absolute paths, including Windows drive letters and UNC paths, and any '..' component
+  const bool is_absolute = location.empty() || location[0] == '/' || location[0] == '\\' ||
+                           (location.size() >= 2 && location[1] == ':');
+  bool has_parent_component = false;
+  std::string::size_type start = 0;
+  while (start <= location.size()) {
+    auto end = location.find_first_of("/\\", start);
+    if (end == std::string::npos) {
+      end = location.size();
+    }
+    if (location.compare(start, end - start, "..") == 0) {
+      has_parent_component = true;
+      break;
+    }
+    start = end + 1;
+  }
+
+  if (is_absolute || has_parent_component) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "External data location '", location,
+                           "' must be a relative path inside the directory of the model");
+  }
+
+  path = model_dir + "/" + location;
+  return Status::OK();
+}
+
+Status GetTensorFromExternalData(const TensorProto& tensor_proto, void* data, size_t data_length,
+                                 const OrtAllocatorInfo& info, std::unique_ptr<Tensor>* p_tensor) {
+  MLDataType element_type;
+  size_t expected_length;
+  ORT_RETURN_IF_ERROR(GetExternalDataSize(tensor_proto, element_type, expected_length));
+
+  if (data_length != expected_length) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "External data of tensor ", tensor_proto.name(),
+                           " has ", data_length, " bytes but its shape requires ", expected_length);
+  }
+
+  *p_tensor = std::make_unique<Tensor>(element_type,
+                                       TensorShape(GetTensorShapeFromTensorProto(tensor_proto)),
+                                       data,
+                                       info);  // no deleter, the caller owns the data
+  return Status::OK();
+}
+
 }  // namespace utils
 }  // namespace onnxruntime
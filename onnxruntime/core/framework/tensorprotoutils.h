@@ -25,5 +25,24 @@ std::vector<int64_t> GetTensorShapeFromTensorShapeProto(const ONNX_NAMESPACE::Te
 common::Status TensorProtoToMLValue(const ONNX_NAMESPACE::TensorProto& input, AllocatorPtr allocator, void* preallocated,
                                     size_t preallocated_size, MLValue& value);
 ONNX_NAMESPACE::TensorProto::DataType GetTensorProtoType(const Tensor& tensor);
+
+// True if the data of the tensor is stored in a separate file (ONNX external data) instead of the model.
+bool HasExternalData(const ONNX_NAMESPACE::TensorProto& tensor_proto);
+
+// Read the 'location', 'offset' and 'length' entries of an external data tensor.
+// 'length' is validated against the shape and element type of the tensor and defaults to the expected size.
+common::Status GetExternalDataInfo(const ONNX_NAMESPACE::TensorProto& tensor_proto, std::string& location,
+                                   size_t& offset, size_t& length);
+
+// Resolve an external data 'location' against the directory of the model file. The location must be a relative
+// path that stays inside that directory, so a model can't make the session read any other file on the host.
+// Fails if model_dir is empty, i.e. the model was not loaded from a file.
+common::Status GetExternalDataPath(const std::string& model_dir, const std::string& location, std::string& path);
+
+// Create a tensor that points to 'data' without owning it. The caller must keep 'data' alive for the
+// lifetime of the tensor. String tensors are not supported.
+common::Status GetTensorFromExternalData(const ONNX_NAMESPACE::TensorProto& tensor_proto, void* data,
+                                         size_t data_length, const OrtAllocatorInfo& info,
+                                         std::unique_ptr<Tensor>* p_tensor);
 }  // namespace utils
 }  // namespace onnxruntime
@@ -0,0 +1,251 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/thread_caching_arena.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include "core/framework/bfc_arena.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+namespace {
+// Stored at the start of every block, kHeaderSize bytes before the pointer returned to the caller.
+struct BlockHeader {
+  // Bin of the block, or kUncachedBin if the block must go back to the shared arena when freed.
+  int bin;
+};
+
+constexpr int kUncachedBin = -1;
+
+std::atomic<uint64_t> next_arena_id{0};
+}  // namespace
+
+struct ThreadCachingArena::ThreadCache {
+  std::array<std::vector<void*>, kNumCachedBins> free_lists;
+
+  // only updated by the owning thread. atomic so GetStats can read them from other threads.
+  std::atomic<int64_t> num_hits{0};
+  std::atomic<int64_t> num_misses{0};
+  std::atomic<int64_t> bytes_cached{0};
+};
+
+struct ThreadCachingArena::SharedState {
+  SharedState(std::unique_ptr<IDeviceAllocator> resource_allocator, size_t total_memory)
+      : arena(std::move(resource_allocator), total_memory), id(next_arena_id++) {}
+
+  // Give the blocks of a cache back to the arena and delete the cache. Called by the thread owning the cache.
+  void ReleaseCache(ThreadCache* cache) {
+    for (auto& free_list : cache->free_lists) {
+      for (void* block : free_list) {
+        arena.Free(block);
+      }
+    }
+
+    std::lock_guard<OrtMutex> lock(caches_mutex);
+    released_hits += cache->num_hits.load(std::memory_order_relaxed);
+    released_misses += cache->num_misses.load(std::memory_order_relaxed);
+    for (auto it = caches.begin(); it != caches.end(); ++it) {
+      if (it->get() == cache) {
+        caches.erase(it);
+        break;
+      }
+    }
+  }
+
+  BFCArena arena;
+  const uint64_t id;
+
+  mutable OrtMutex caches_mutex;
+  std::vector<std::unique_ptr<ThreadCache>> caches;  // GUARDED_BY(caches_mutex)
+
+  // counters of the caches of threads that exited. GUARDED_BY(caches_mutex)
+  int64_t released_hits = 0;
+  int64_t released_misses = 0;
+};
+
+// Caches of the current thread, one per arena it used.
+struct ThreadCachingArena::ThreadCacheRegistry {
+  struct Entry {
+    uint64_t arena_id;
+    std::weak_ptr<SharedState> shared;
+    ThreadCache* cache;
+  };
+
+  ~ThreadCacheRegistry() {
+    for (auto& entry : entries) {
+      auto shared = entry.shared.lock();
+      if (shared) {
+        shared->ReleaseCache(entry.cache);
+      }
+    }
+  }
+
+  std::vector<Entry> entries;
+};
+
+static size_t BinSize(int bin) {
+  return ThreadCachingArena::kMinCachedSize << bin;
+}
+
+// Returns kNumCachedBins if the block is too large to be cached.
+static int BinForSize(size_t block_size) {
+  int bin = 0;
+  while (bin < ThreadCachingArena::kNumCachedBins && BinSize(bin) < block_size) {
+    ++bin;
+  }
+  return bin;
+}
+
+static void* ToUserPtr(void* block, int bin) {
+  static_cast<BlockHeader*>(block)->bin = bin;
+  return static_cast<char*>(block) + ThreadCachingArena::kHeaderSize;
+}
+
+static void* ToBlock(void* p) {
+  return static_cast<char*>(p) - ThreadCachingArena::kHeaderSize;
+}
+
+ThreadCachingArena::ThreadCachingArena(std::unique_ptr<IDeviceAllocator> resource_allocator, size_t total_memory)
+    : shared_(std::make_shared<SharedState>(std::move(resource_allocator), total_memory)) {
+  static_assert(sizeof(BlockHeader) <= kHeaderSize, "BlockHeader doesn't fit in kHeaderSize");
+}
+
+ThreadCachingArena::~ThreadCachingArena() = default;
+
+ThreadCachingArena::ThreadCache& ThreadCachingArena::GetThreadCache() {
+  static thread_local ThreadCacheRegistry registry;
+
+  for (const auto& entry : registry.entries) {
+    if (entry.arena_id == shared_->id) {
+      return *entry.cache;
+    }
+  }
+
+  // first use of this arena by the current thread. drop the entries of destroyed arenas first.
+  auto& entries = registry.entries;
+  entries.erase(std::remove_if(entries.begin(), entries.end(),
+                               [](const ThreadCacheRegistry::Entry& entry) { return entry.shared.expired(); }),
+                entries.end());
+
+  auto cache = std::make_unique<ThreadCache>();
+  ThreadCache* p_cache = cache.get();
+  {
+    std::lock_guard<OrtMutex> lock(shared_->caches_mutex);
+    shared_->caches.push_back(std::move(cache));
+  }
+
+  entries.push_back({shared_->id, shared_, p_cache});
+  return *p_cache;
+}
+
+void* ThreadCachingArena::Alloc(size_t size) {
+  if (size == 0)
+    return nullptr;
+
+  const size_t block_size = size + kHeaderSize;
+  const int bin = BinForSize(block_size);
+  if (bin == kNumCachedBins) {
+    void* block = shared_->arena.Alloc(block_size);
+    return block == nullptr ? nullptr : ToUserPtr(block, kUncachedBin);
+  }
+
+  ThreadCache& cache = GetThreadCache();
+  auto& free_list = cache.free_lists[bin];
+  if (!free_list.empty()) {
+    void* block = free_list.back();
+    free_list.pop_back();
+    cache.num_hits.store(cache.num_hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    cache.bytes_cached.store(cache.bytes_cached.load(std::memory_order_relaxed) - BinSize(bin),
+                             std::memory_order_relaxed);
+    return ToUserPtr(block, bin);
+  }
+
+  cache.num_misses.store(cache.num_misses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  void* block = shared_->arena.Alloc(BinSize(bin));
+  return block == nullptr ? nullptr : ToUserPtr(block, bin);
+}
+
+void ThreadCachingArena::Free(void* p) {
+  if (p == nullptr)
+    return;
+
+  void* block = ToBlock(p);
+  const int bin = static_cast<BlockHeader*>(block)->bin;
+  if (bin == kUncachedBin) {
+    shared_->arena.Free(block);
+    return;
+  }
+
+  ORT_ENFORCE(bin >= 0 && bin < kNumCachedBins, "Invalid block header. Was the pointer allocated by this arena?");
+
+  ThreadCache& cache = GetThreadCache();
+  auto& free_list = cache.free_lists[bin];
+  free_list.push_back(block);
+  int64_t bytes_cached = cache.bytes_cached.load(std::memory_order_relaxed) + BinSize(bin);
+
+  // rebalance: give half of an oversized free list back to the shared arena so other threads can use it.
+  if (free_list.size() * BinSize(bin) > kMaxCachedBytesPerBin) {
+    const size_t num_to_release = free_list.size() / 2;
+    for (size_t i = 0; i < num_to_release; ++i) {
+      shared_->arena.Free(free_list[i]);
+    }
+    free_list.erase(free_list.begin(), free_list.begin() + num_to_release);
+    bytes_cached -= static_cast<int64_t>(num_to_release * BinSize(bin));
+  }
+
+  cache.bytes_cached.store(bytes_cached, std::memory_order_relaxed);
+}
+
+void* ThreadCachingArena::Reserve(size_t size) {
+  if (size == 0)
+    return nullptr;
+
+  void* block = shared_->arena.Reserve(size + kHeaderSize);
+  return block == nullptr ? nullptr : ToUserPtr(block, kUncachedBin);
+}
+
+size_t ThreadCachingArena::Used() const {
+  int64_t bytes_cached = 0;
+  {
+    std::lock_guard<OrtMutex> lock(shared_->caches_mutex);
+    for (const auto& cache : shared_->caches) {
+      bytes_cached += cache->bytes_cached.load(std::memory_order_relaxed);
+    }
+  }
+  return shared_->arena.Used() - static_cast<size_t>(bytes_cached);
+}
+
+size_t ThreadCachingArena::Max() const {
+  return shared_->arena.Max();
+}
+
+const OrtAllocatorInfo& ThreadCachingArena::Info() const {
+  return shared_->arena.Info();
+}
+
+FencePtr ThreadCachingArena::CreateFence(const SessionState* session_state) {
+  return shared_->arena.CreateFence(session_state);
+}
+
+void ThreadCachingArena::GetStats(AllocatorStats* stats) {
+  shared_->arena.GetStats(stats);
+
+  std::lock_guard<OrtMutex> lock(shared_->caches_mutex);
+  stats->num_cache_hits = shared_->released_hits;
+  stats->num_cache_misses = shared_->released_misses;
+  for (const auto& cache : shared_->caches) {
+    stats->num_cache_hits += cache->num_hits.load(std::memory_order_relaxed);
+    stats->num_cache_misses += cache->num_misses.load(std::memory_order_relaxed);
+    stats->bytes_cached += cache->bytes_cached.load(std::memory_order_relaxed);
+  }
+
+  // the shared arena counts cached blocks as in use and doesn't see the allocations served by the caches.
+  stats->bytes_in_use -= stats->bytes_cached;
+  stats->num_allocs += stats->num_cache_hits;
+}
+}  // namespace onnxruntime
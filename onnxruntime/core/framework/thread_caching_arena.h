@@ -0,0 +1,65 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+
+#include "core/common/common.h"
+#include "core/framework/arena.h"
+
+namespace onnxruntime {
+
+// An arena that keeps per-thread free lists of small blocks in front of a shared BFCArena.
+//
+// Allocations of up to kMaxCachedSize bytes (including a block header) are rounded up to a power of two and
+// served from a free list owned by the calling thread, so the BFCArena lock is only taken when that list is
+// empty. A freed block goes to the free list of the thread freeing it. When a free list grows beyond
+// kMaxCachedBytesPerBin, half of it is given back to the shared arena, and a thread's whole cache is given back
+// when the thread exits. Larger allocations and Reserve calls go directly to the shared arena.
+//
+// The block header is written by the host, so this arena can only be used with host accessible memory.
+class ThreadCachingArena : public IArenaAllocator {
+ public:
+  ThreadCachingArena(std::unique_ptr<IDeviceAllocator> resource_allocator, size_t total_memory);
+
+  ~ThreadCachingArena() override;
+
+  void* Alloc(size_t size) override;
+
+  void Free(void* p) override;
+
+  void* Reserve(size_t size) override;
+
+  // Bytes in use by the callers, excluding the bytes held by the thread local caches.
+  size_t Used() const override;
+
+  size_t Max() const override;
+
+  const OrtAllocatorInfo& Info() const override;
+
+  FencePtr CreateFence(const SessionState* session_state) override;
+
+  void GetStats(AllocatorStats* stats) override;
+
+  // Size of the header in front of each block. It keeps the 64 byte alignment of the shared arena.
+  static constexpr size_t kHeaderSize = 64;
+  static constexpr size_t kMinCachedSize = 256;
+  static constexpr int kNumCachedBins = 9;
+  static constexpr size_t kMaxCachedSize = kMinCachedSize << (kNumCachedBins - 1);
+  static constexpr size_t kMaxCachedBytesPerBin = 256 * 1024;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ThreadCachingArena);
+
+  struct ThreadCache;
+  struct SharedState;
+  struct ThreadCacheRegistry;
+
+  ThreadCache& GetThreadCache();
+
+  // Shared with the registries of the threads holding a cache, so a thread exiting after the arena was destroyed
+  // doesn't touch freed memory, and one exiting while the arena is being destroyed can still give its cache back.
+  std::shared_ptr<SharedState> shared_;
+};
+}  // namespace onnxruntime
@@ -3,6 +3,8 @@
 
 #include "core/framework/utils.h"
 
+#include <cstring>
+
 #include "core/graph/graph_viewer.h"
 
 #include "core/framework/execution_frame.h"
@@ -322,6 +324,34 @@ common::Status CopyOutputsAcrossDevices(const SessionState& session_state,
   return Status::OK();
 }
 
+common::Status FetchOutputValue(const MLValue& output_mlvalue, MLValue& fetch) {
+  if (!fetch.IsAllocated() || !fetch.IsTensor() || !output_mlvalue.IsTensor()) {
+    fetch = output_mlvalue;
+    return Status::OK();
+  }
+
+  const Tensor& output_tensor = output_mlvalue.Get<Tensor>();
+  Tensor* p_fetch_tensor = fetch.GetMutable<Tensor>();
+  if (p_fetch_tensor == &output_tensor) {
+    return Status::OK();
+  }
+
+  if (p_fetch_tensor->DataType() == output_tensor.DataType() &&
+      p_fetch_tensor->DataType() != DataTypeImpl::GetType<std::string>() &&
+      p_fetch_tensor->Shape() == output_tensor.Shape() &&
+      strcmp(p_fetch_tensor->Location().name, CPU) == 0 &&
+      strcmp(output_tensor.Location().name, CPU) == 0) {
+    if (p_fetch_tensor->DataRaw() != output_tensor.DataRaw()) {
+      memcpy(p_fetch_tensor->MutableDataRaw(), output_tensor.DataRaw(),
+             output_tensor.Shape().Size() * output_tensor.DataType()->Size());
+    }
+    return Status::OK();
+  }
+
+  fetch = output_mlvalue;
+  return Status::OK();
+}
+
 common::Status ExecuteGraph(const SessionState& session_state,
                             const NameMLValMap& feeds,
                             const std::vector<std::string>& output_names,
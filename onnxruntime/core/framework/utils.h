@@ -57,6 +57,11 @@ common::Status CopyOutputsAcrossDevices(const SessionState& session_state,
                                         std::vector<MLValue>& fetches,
                                         std::vector<MLValue>& user_fetches);
 
+// Moves an output of the execution frame into the fetches of Run. A preallocated fetch the kernel wrote
+// into is left as is, and a preallocated CPU tensor is filled in place when the output was produced elsewhere
+// (e.g. a graph input or initializer that is also a graph output), so bound output buffers always receive the result.
+common::Status FetchOutputValue(const MLValue& output_mlvalue, MLValue& fetch);
+
 common::Status ExecuteGraph(const SessionState& session_state,
                             const NameMLValMap& feeds,
                             const std::vector<std::string>& output_names,
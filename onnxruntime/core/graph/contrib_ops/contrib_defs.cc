@@ -336,6 +336,136 @@ activation.)DOC")
         ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, false, true);
       });
 
+  ONNX_CONTRIB_OPERATOR_SCHEMA(ReorderInput)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. Reorders a NCHW tensor to the channel blocked (NCHWc) format.)DOC")
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::propagateShapeAndTypeFromFirstInput);
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(ReorderOutput)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. Reorders a channel blocked (NCHWc) tensor to the NCHW format.)DOC")
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::propagateShapeAndTypeFromFirstInput);
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(NchwcConv)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. The schema is the same as FusedConv, except that the output and the
+filter are in the channel blocked (NCHWc) format. The input is in the NCHWc format if its channel count is
+a multiple of the block size, else it is in the NCHW format.)DOC")
+      .Attr("auto_pad", "", AttributeProto::STRING, std::string("NOTSET"))
+      .Attr("kernel_shape", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("dilations", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("strides", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("pads", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("group", "", AttributeProto::INT, static_cast<int64_t>(1))
+      .Attr("activation", "", AttributeProto::STRING, OPTIONAL)
+      .Attr("alpha", "", AttributeProto::FLOAT, OPTIONAL)
+      .Input(0, "X", "", "T")
+      .Input(1, "W", "", "T")
+      .Input(2, "B", "", "T", OpSchema::Optional)
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, false, true);
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(NchwcMaxPool)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. MaxPool for channel blocked (NCHWc) tensors.)DOC")
+      .Attr("auto_pad", "", AttributeProto::STRING, std::string("NOTSET"))
+      .Attr("kernel_shape", "", AttributeProto::INTS)
+      .Attr("pads", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("strides", "", AttributeProto::INTS, OPTIONAL)
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, false, true);
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(NchwcAveragePool)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. AveragePool for channel blocked (NCHWc) tensors.)DOC")
+      .Attr("auto_pad", "", AttributeProto::STRING, std::string("NOTSET"))
+      .Attr("kernel_shape", "", AttributeProto::INTS)
+      .Attr("pads", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("strides", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("count_include_pad", "", AttributeProto::INT, static_cast<int64_t>(0))
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, false, true);
+      });
+
+  auto NchwcGlobalPoolShapeInference = [](ONNX_NAMESPACE::InferenceContext& ctx) {
+    ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 0, 0);
+    if (!hasNInputShapes(ctx, 1)) {
+      return;
+    }
+    auto& input_shape = ctx.getInputType(0)->tensor_type().shape();
+    if (input_shape.dim_size() < 2) {
+      return;
+    }
+    auto* output_shape = ctx.getOutputType(0)->mutable_tensor_type()->mutable_shape();
+    *output_shape->add_dim() = input_shape.dim(0);
+    *output_shape->add_dim() = input_shape.dim(1);
+    for (int i = 2; i < input_shape.dim_size(); ++i) {
+      output_shape->add_dim()->set_dim_value(1);
+    }
+  };
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(NchwcGlobalMaxPool)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. GlobalMaxPool for channel blocked (NCHWc) tensors.)DOC")
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction(NchwcGlobalPoolShapeInference);
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(NchwcGlobalAveragePool)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. GlobalAveragePool for channel blocked (NCHWc) tensors.)DOC")
+      .Input(0, "X", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors")
+      .TypeAndShapeInferenceFunction(NchwcGlobalPoolShapeInference);
+
+  auto GemmTypeAndShapeInference = [](ONNX_NAMESPACE::InferenceContext& ctx) {
+    propagateElemTypeFromInputToOutput(ctx, 0, 0);
+    if (hasNInputShapes(ctx, 2)) {
+      auto transAAttr = ctx.getAttribute("transA");
+      bool transA =
+          transAAttr ? static_cast<int>(transAAttr->i()) != 0 : false;
+      auto transBAttr = ctx.getAttribute("transB");
+      bool transB =
+          transBAttr ? static_cast<int>(transBAttr->i()) != 0 : false;
+      auto& first_input_shape = getInputShape(ctx, 0);
+      auto& second_input_shape = getInputShape(ctx, 1);
+      if (first_input_shape.dim_size() != 2)
+        fail_shape_inference("First input does not have rank 2");
+      if (second_input_shape.dim_size() != 2)
+        fail_shape_inference("Second input does not have rank 2");
+      updateOutputShape(
+          ctx,
+          0,
+          {first_input_shape.dim(transA ? 1 : 0),
+           second_input_shape.dim(transB ? 0 : 1)});
+    }
+  };
+
   ONNX_CONTRIB_OPERATOR_SCHEMA(FusedGemm)
       .SetDomain(kMSDomain)
       .SinceVersion(1)
@@ -403,27 +533,59 @@ activation and leaky_relu_alpha.)DOC")
           "",
           AttributeProto::FLOAT,
           OPTIONAL)
+      .TypeAndShapeInferenceFunction(GemmTypeAndShapeInference);
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(MatMulHalfWeight)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. The schema is the same as MatMul, except that the constant weight B is
+stored in half precision while A and Y are float. The product is computed in single precision.)DOC")
+      .Input(0, "A", "", "T")
+      .Input(1, "B", "", "T1")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input A and output types to float tensors")
+      .TypeConstraint("T1", {"tensor(float16)"}, "Constrain input B to half precision tensors")
       .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
         propagateElemTypeFromInputToOutput(ctx, 0, 0);
-        if (hasNInputShapes(ctx, 2)) {
-          auto transAAttr = ctx.getAttribute("transA");
-          bool transA =
-              transAAttr ? static_cast<int>(transAAttr->i()) != 0 : false;
-          auto transBAttr = ctx.getAttribute("transB");
-          bool transB =
-              transBAttr ? static_cast<int>(transBAttr->i()) != 0 : false;
-          auto& first_input_shape = getInputShape(ctx, 0);
-          auto& second_input_shape = getInputShape(ctx, 1);
-          if (first_input_shape.dim_size() != 2)
-            fail_shape_inference("First input does not have rank 2");
-          if (second_input_shape.dim_size() != 2)
-            fail_shape_inference("Second input does not have rank 2");
-          updateOutputShape(
-              ctx,
-              0,
-              {first_input_shape.dim(transA ? 1 : 0),
-               second_input_shape.dim(transB ? 0 : 1)});
-        }
+        matmulShapeInference(ctx, 0, 1);
+      });
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(GemmHalfWeight)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. The schema is the same as Gemm, except that the constant weight B is
+stored in half precision while A, C and Y are float. The product is computed in single precision.)DOC")
+      .Attr("transA", "", AttributeProto::INT, static_cast<int64_t>(0))
+      .Attr("transB", "", AttributeProto::INT, static_cast<int64_t>(0))
+      .Attr("alpha", "", AttributeProto::FLOAT, 1.0f)
+      .Attr("beta", "", AttributeProto::FLOAT, 1.0f)
+      .Input(0, "A", "", "T")
+      .Input(1, "B", "", "T1")
+      .Input(2, "C", "", "T")
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input A, C and output types to float tensors")
+      .TypeConstraint("T1", {"tensor(float16)"}, "Constrain input B to half precision tensors")
+      .TypeAndShapeInferenceFunction(GemmTypeAndShapeInference);
+
+  ONNX_CONTRIB_OPERATOR_SCHEMA(ConvHalfWeight)
+      .SetDomain(kMSDomain)
+      .SinceVersion(1)
+      .SetDoc(R"DOC(For internal use. The schema is the same as Conv, except that the constant filter W is
+stored in half precision while X, B and Y are float. The convolution is computed in single precision.)DOC")
+      .Attr("auto_pad", "", AttributeProto::STRING, std::string("NOTSET"))
+      .Attr("kernel_shape", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("dilations", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("strides", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("pads", "", AttributeProto::INTS, OPTIONAL)
+      .Attr("group", "", AttributeProto::INT, static_cast<int64_t>(1))
+      .Input(0, "X", "", "T")
+      .Input(1, "W", "", "T1")
+      .Input(2, "B", "", "T", OpSchema::Optional)
+      .Output(0, "Y", "", "T")
+      .TypeConstraint("T", {"tensor(float)"}, "Constrain input X, B and output types to float tensors")
+      .TypeConstraint("T1", {"tensor(float16)"}, "Constrain input W to half precision tensors")
+      .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+        ONNX_NAMESPACE::convPoolTypeAndShapeInference(ctx, false, true);
       });
 
   ONNX_CONTRIB_OPERATOR_SCHEMA(ExpandDims)
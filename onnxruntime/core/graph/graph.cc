@@ -1922,6 +1922,16 @@ bool Graph::GetInitializedTensor(const std::string& tensor_name, const TensorPro
   return true;
 }
 
+void Graph::ReleaseInitializedTensorData(const std::string& tensor_name) {
+  auto iter = name_to_initial_tensor_.find(tensor_name);
+  if (name_to_initial_tensor_.end() != iter) {
+    // the TensorProto instances are owned by graph_proto_
+    auto* tensor = const_cast<TensorProto*>(iter->second);
+    // swap with an empty string, as clearing a string does not free its memory
+    std::string().swap(*tensor->mutable_raw_data());
+  }
+}
+
 void Graph::CleanAllInitializedTensors() noexcept {
   name_to_initial_tensor_.clear();
   removed_initializer_indexes_.clear();
@@ -43,6 +43,21 @@ typedef enum { CblasNonUnit=131, CblasUnit=132 } CBLAS_DIAG;
 typedef enum { CblasLeft=141, CblasRight=142} CBLAS_SIDE;
 #endif
 
+//
+// Forward declare the thread pool implementation class.
+//
+// N.B. Avoid including onnxruntime headers here to keep the dependencies for
+// standalone MLAS test executables smaller.
+//
+
+namespace onnxruntime {
+    namespace concurrency {
+        class ThreadPool;
+    };
+};
+
+using MLAS_THREADPOOL = onnxruntime::concurrency::ThreadPool;
+
 //
 // Activiation routines.
 //
@@ -91,7 +106,208 @@ MlasSgemm(
     size_t ldb,
     float beta,
     float* C,
-    size_t ldc
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+//
+// Single precision matrix/matrix multiply routine for a batch of operations
+// with the same shape. Each operation of the batch is described by the
+// addresses and leading dimensions of its matrices, which allows batches with
+// arbitrary (including broadcast) strides between the operations.
+//
+
+struct MLAS_SGEMM_DATA_PARAMS {
+    const float* A;
+    size_t lda;
+    const float* B;
+    size_t ldb;
+    float* C;
+    size_t ldc;
+};
+
+void
+MLASCALL
+MlasSgemmBatch(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const MLAS_SGEMM_DATA_PARAMS* Data,
+    float beta,
+    size_t BatchCount,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+//
+// Single precision matrix/matrix multiply routines for a matrix B that has
+// been packed ahead of time, such as a constant weight. The packed buffer must
+// be aligned to at least 64 bytes.
+//
+
+size_t
+MLASCALL
+MlasSgemmPackBSize(
+    size_t N,
+    size_t K
+    );
+
+void
+MLASCALL
+MlasSgemmPackB(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb,
+    void* PackedB
+    );
+
+void
+MLASCALL
+MlasSgemmPackedB(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+//
+// Single precision matrix/matrix multiply routines for a matrix B that is
+// stored in half precision. Matrix B is packed ahead of time in the layout of
+// MlasSgemmPackB, but keeps half precision elements, which are converted to
+// single precision a panel at a time while multiplying.
+//
+
+size_t
+MLASCALL
+MlasSgemmPackBHalfSize(
+    size_t N,
+    size_t K
+    );
+
+void
+MLASCALL
+MlasSgemmPackBHalf(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const unsigned short* B,
+    size_t ldb,
+    void* PackedB
+    );
+
+void
+MLASCALL
+MlasSgemmPackedBHalf(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+//
+// Quantized integer matrix/matrix multiply routines.
+//
+// The routines compute C = (A - offa) * (B - offb), where A is an unsigned
+// 8-bit matrix and B is an unsigned or signed 8-bit matrix, all stored in row
+// major order. The 32-bit integer result is either stored directly or passed
+// through a requantization stage that produces an unsigned 8-bit matrix.
+//
+
+struct MLAS_QGEMM_REQUANTIZE {
+    const int32_t* Bias;
+    int32_t Multiplier;
+    int32_t RightShift;
+    uint8_t ZeroPoint;
+};
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const uint8_t* B,
+    size_t ldb,
+    uint8_t offb,
+    int32_t* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const int8_t* B,
+    size_t ldb,
+    int8_t offb,
+    int32_t* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const uint8_t* B,
+    size_t ldb,
+    uint8_t offb,
+    const MLAS_QGEMM_REQUANTIZE* Requantize,
+    uint8_t* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const int8_t* B,
+    size_t ldb,
+    int8_t offb,
+    const MLAS_QGEMM_REQUANTIZE* Requantize,
+    uint8_t* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
     );
 
 //
@@ -102,6 +318,9 @@ enum MLAS_CONV_ALGORITHM {
     MlasConvAlgorithmGemmDirect,
     MlasConvAlgorithmExpandThenGemm,
     MlasConvAlgorithmExpandThenGemmSegmented,
+    MlasConvAlgorithmWinograd,
+    MlasConvAlgorithmDepthwise,
+    MlasConvAlgorithmTranspose,
 };
 
 struct MLAS_CONV_PARAMETERS {
@@ -129,6 +348,23 @@ struct MLAS_CONV_PARAMETERS {
         struct {
             size_t ThreadStrideN;
         } ExpandThenGemmSegmented;
+        struct {
+            const float* TransformedFilter;
+            size_t TileCountW;
+            size_t TileCount;
+            size_t TileBlockSize;
+            size_t ThreadCount;
+        } Winograd;
+        struct {
+            size_t ThreadCount;
+            size_t ThreadBufferSize;
+        } Depthwise;
+        struct {
+            size_t BlockRows;
+            size_t BlockCount;
+            size_t TileColumns;
+            size_t ThreadCount;
+        } ConvTranspose;
     } u;
 };
 
@@ -147,8 +383,10 @@ MlasConvPrepare(
     const int64_t* StrideShape,
     const int64_t* OutputShape,
     size_t FilterCount,
+    const float* TransformedFilter,
     const MLAS_ACTIVATION* Activation,
-    size_t* WorkingBufferSize
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
     );
 
 void
@@ -159,17 +397,86 @@ MlasConv(
     const float* Filter,
     const float* Bias,
     float* WorkingBuffer,
-    float* Output
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+bool
+MLASCALL
+MlasConvWinogradIsSupported(
+    size_t InputChannels,
+    size_t FilterCount
+    );
+
+size_t
+MLASCALL
+MlasConvWinogradGetFilterSize(
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount
+    );
+
+void
+MLASCALL
+MlasConvWinogradTransformFilter(
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount,
+    const float* Filter,
+    float* TransformedFilter
+    );
+
+//
+// Transposed convolution routines.
+//
+// The filter tensor is in IOHW format: the input channels of all groups
+// followed by the output channels per group and the kernel dimensions.
+//
+
+void
+MLASCALL
+MlasConvTransposePrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    size_t Dimensions,
+    size_t BatchCount,
+    size_t GroupCount,
+    size_t InputChannels,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    size_t FilterCount,
+    const MLAS_ACTIVATION* Activation,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+void
+MLASCALL
+MlasConvTranspose(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
     );
 
 //
 // Pooling routines.
 //
+// Sum pooling adds the elements of each pooling window without dividing by
+// the window size. Padding elements contribute zero.
+//
 
 enum MLAS_POOLING_KIND {
     MlasMaximumPooling,
     MlasAveragePoolingExcludePad,
     MlasAveragePoolingIncludePad,
+    MlasSumPooling,
 };
 
 void
@@ -183,7 +490,86 @@ MlasPool(
     const int64_t* StrideShape,
     const int64_t* OutputShape,
     const float* Input,
-    float* Output
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+//
+// Channel blocked (NCHWc) convolution and pooling routines.
+//
+// An NCHWc tensor stores the channels of an NCHW tensor in groups of
+// MlasNchwcGetBlockSize() channels, with the channels of a group interleaved
+// for each spatial element. The number of channels of an NCHWc tensor must be
+// a multiple of the block size.
+//
+
+size_t
+MLASCALL
+MlasNchwcGetBlockSize(
+    void
+    );
+
+void
+MLASCALL
+MlasNchwcConv(
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    const MLAS_ACTIVATION* Activation,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+void
+MLASCALL
+MlasNchwcPool(
+    MLAS_POOLING_KIND PoolingKind,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+void
+MLASCALL
+MlasReorderInput(
+    const int64_t* InputShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasReorderOutput(
+    const int64_t* OutputShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasReorderFilterOIHWBiBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    );
+
+void
+MLASCALL
+MlasReorderFilterOIHWBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
     );
 
 //
@@ -206,11 +592,52 @@ MlasComputeTanh(
     size_t N
     );
 
+void
+MLASCALL
+MlasComputeExp(
+    const float* Input,
+    float* Output,
+    size_t N
+    );
+
+void
+MLASCALL
+MlasComputeLog(
+    const float* Input,
+    float* Output,
+    size_t N
+    );
+
+void
+MLASCALL
+MlasComputeErf(
+    const float* Input,
+    float* Output,
+    size_t N
+    );
+
+float
+MLASCALL
+MlasReduceMaximum(
+    const float* Input,
+    size_t N
+    );
+
+void
+MLASCALL
+MlasComputeSoftmax(
+    const float* Input,
+    float* Output,
+    size_t N,
+    size_t D,
+    bool LogSoftmax,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 //
 // Half-precision floating-point routines.
 //
 
-extern "C"
 void
 MLASCALL
 MlasConvertHalfToFloatBuffer(
@@ -218,3 +645,60 @@ MlasConvertHalfToFloatBuffer(
     float* Destination,
     size_t Count
     );
+
+//
+// Platform and kernel selection routines.
+//
+// The library selects a kernel variant for each entry point from the highest
+// instruction set level that the processor supports. The level can be capped
+// to compare the variants on a single machine, either with the MLAS_ISA_LEVEL
+// environment variable (set to the name of a level) or by calling
+// MlasSetMaximumIsaLevel.
+//
+// N.B. The NCHWc block size depends on the selected kernels, so the level must
+// not be changed while other threads are using the library or while buffers
+// reordered for the previous level are still in use.
+//
+
+enum MLAS_ISA_LEVEL {
+    MlasIsaLevelGeneric,
+    MlasIsaLevelAvx,
+    MlasIsaLevelAvx2,
+    MlasIsaLevelAvx512F,
+    MlasIsaLevelAvx512Vnni,
+};
+
+struct MLAS_KERNEL_SELECTION {
+    const char* EntryPoint;
+    const char* Variant;
+};
+
+MLAS_ISA_LEVEL
+MLASCALL
+MlasGetIsaLevel(
+    void
+    );
+
+MLAS_ISA_LEVEL
+MLASCALL
+MlasGetSupportedIsaLevel(
+    void
+    );
+
+MLAS_ISA_LEVEL
+MLASCALL
+MlasSetMaximumIsaLevel(
+    MLAS_ISA_LEVEL MaximumIsaLevel
+    );
+
+const char*
+MLASCALL
+MlasGetIsaLevelName(
+    MLAS_ISA_LEVEL IsaLevel
+    );
+
+size_t
+MLASCALL
+MlasGetKernelSelection(
+    const MLAS_KERNEL_SELECTION** KernelSelection
+    );
@@ -0,0 +1,688 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    compute.cpp
+
+Abstract:
+
+    This module implements routines to compute the exponential, natural
+    logarithm and error functions and to compute the softmax of the rows of
+    a matrix.
+
+    The implementation below instantiates the kernel templates for the
+    portable 128-bit vector intrinsics while the instruction set specific
+    modules instantiate the templates for newer instruction sets (such as
+    AVX2 and AVX512F).
+
+--*/
+
+#include "compute_kernel.h"
+
+//
+// Define the portable compute kernel traits using the 128-bit vector
+// intrinsics.
+//
+
+struct MLAS_COMPUTE_KERNEL_TRAITS_DEFAULT {
+
+    typedef MLAS_FLOAT32X4 VectorType;
+
+#if defined(MLAS_NEON_INTRINSICS)
+    typedef uint32x4_t MaskType;
+#elif defined(MLAS_SSE2_INTRINSICS)
+    typedef __m128 MaskType;
+#endif
+
+    static constexpr size_t VectorLength = 4;
+
+    static VectorType Load(const float* Buffer)
+    {
+        return MlasLoadFloat32x4(Buffer);
+    }
+
+    static void Store(float* Buffer, VectorType Vector)
+    {
+        MlasStoreFloat32x4(Buffer, Vector);
+    }
+
+    static VectorType Broadcast(float Value)
+    {
+        return MlasBroadcastFloat32x4(Value);
+    }
+
+    static VectorType Add(VectorType Vector1, VectorType Vector2)
+    {
+        return MlasAddFloat32x4(Vector1, Vector2);
+    }
+
+    static VectorType Subtract(VectorType Vector1, VectorType Vector2)
+    {
+        return MlasSubtractFloat32x4(Vector1, Vector2);
+    }
+
+    static VectorType Multiply(VectorType Vector1, VectorType Vector2)
+    {
+        return MlasMultiplyFloat32x4(Vector1, Vector2);
+    }
+
+    static VectorType MultiplyAdd(VectorType Vector1, VectorType Vector2, VectorType Vector3)
+    {
+        return MlasMultiplyAddFloat32x4(Vector1, Vector2, Vector3);
+    }
+
+    static VectorType Divide(VectorType Vector1, VectorType Vector2)
+    {
+        return MlasDivideFloat32x4(Vector1, Vector2);
+    }
+
+    static VectorType Maximum(VectorType Vector1, VectorType Vector2)
+    {
+        return MlasMaximumFloat32x4(Vector1, Vector2);
+    }
+
+    static VectorType Minimum(VectorType Vector1, VectorType Vector2)
+    {
+        return MlasMinimumFloat32x4(Vector1, Vector2);
+    }
+
+    static MaskType CompareLess(VectorType Vector1, VectorType Vector2)
+    {
+#if defined(MLAS_NEON_INTRINSICS)
+        return vcltq_f32(Vector1, Vector2);
+#elif defined(MLAS_SSE2_INTRINSICS)
+        return _mm_cmplt_ps(Vector1, Vector2);
+#endif
+    }
+
+    static MaskType CompareEqual(VectorType Vector1, VectorType Vector2)
+    {
+#if defined(MLAS_NEON_INTRINSICS)
+        return vceqq_f32(Vector1, Vector2);
+#elif defined(MLAS_SSE2_INTRINSICS)
+        return _mm_cmpeq_ps(Vector1, Vector2);
+#endif
+    }
+
+    static VectorType Select(MaskType Mask, VectorType TrueVector, VectorType FalseVector)
+    {
+#if defined(MLAS_NEON_INTRINSICS)
+        return vbslq_f32(Mask, TrueVector, FalseVector);
+#elif defined(MLAS_SSE2_INTRINSICS)
+        return _mm_or_ps(_mm_and_ps(Mask, TrueVector), _mm_andnot_ps(Mask, FalseVector));
+#endif
+    }
+
+    static VectorType ScaleByPowerOf2(VectorType Vector, VectorType Exponent)
+    {
+        //
+        // Split the integral exponent into two halves so that each power of
+        // two has a normal representation.
+        //
+
+#if defined(MLAS_NEON_INTRINSICS)
+        int32x4_t e = vcvtq_s32_f32(Exponent);
+        int32x4_t e1 = vshrq_n_s32(e, 1);
+        int32x4_t e2 = vsubq_s32(e, e1);
+        int32x4_t Bias = vdupq_n_s32(127);
+        Vector = vmulq_f32(Vector, vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(e1, Bias), 23)));
+        return vmulq_f32(Vector, vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(e2, Bias), 23)));
+#elif defined(MLAS_SSE2_INTRINSICS)
+        __m128i e = _mm_cvtps_epi32(Exponent);
+        __m128i e1 = _mm_srai_epi32(e, 1);
+        __m128i e2 = _mm_sub_epi32(e, e1);
+        __m128i Bias = _mm_set1_epi32(127);
+        Vector = _mm_mul_ps(Vector, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(e1, Bias), 23)));
+        return _mm_mul_ps(Vector, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(e2, Bias), 23)));
+#endif
+    }
+
+    static VectorType ExtractExponent(VectorType Vector, VectorType& Mantissa)
+    {
+        //
+        // Split a positive normal value into a mantissa in [0.5, 1) and the
+        // corresponding exponent.
+        //
+
+#if defined(MLAS_NEON_INTRINSICS)
+        uint32x4_t Bits = vreinterpretq_u32_f32(Vector);
+        Mantissa = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(Bits, vdupq_n_u32(0x807FFFFF)), vdupq_n_u32(0x3F000000)));
+        int32x4_t e = vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(Bits, 23)), vdupq_n_s32(126));
+        return vcvtq_f32_s32(e);
+#elif defined(MLAS_SSE2_INTRINSICS)
+        __m128i Bits = _mm_castps_si128(Vector);
+        Mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(Bits, _mm_set1_epi32(0x807FFFFF)), _mm_set1_epi32(0x3F000000)));
+        __m128i e = _mm_sub_epi32(_mm_srli_epi32(Bits, 23), _mm_set1_epi32(126));
+        return _mm_cvtepi32_ps(e);
+#endif
+    }
+
+    static float ReduceMaximum(VectorType Vector)
+    {
+#if defined(MLAS_NEON64_INTRINSICS)
+        return vmaxvq_f32(Vector);
+#elif defined(MLAS_NEON32_INTRINSICS)
+        float32x2_t VectorLow = vpmax_f32(vget_low_f32(Vector), vget_high_f32(Vector));
+        return vget_lane_f32(vpmax_f32(VectorLow, VectorLow), 0);
+#elif defined(MLAS_SSE2_INTRINSICS)
+        Vector = _mm_max_ps(Vector, _mm_shuffle_ps(Vector, Vector, _MM_SHUFFLE(1, 0, 3, 2)));
+        Vector = _mm_max_ps(Vector, _mm_shuffle_ps(Vector, Vector, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(Vector);
+#endif
+    }
+
+    static float ReduceAdd(VectorType Vector)
+    {
+#if defined(MLAS_NEON64_INTRINSICS)
+        return vaddvq_f32(Vector);
+#elif defined(MLAS_NEON32_INTRINSICS)
+        float32x2_t VectorLow = vpadd_f32(vget_low_f32(Vector), vget_high_f32(Vector));
+        return vget_lane_f32(vpadd_f32(VectorLow, VectorLow), 0);
+#elif defined(MLAS_SSE2_INTRINSICS)
+        Vector = _mm_add_ps(Vector, _mm_shuffle_ps(Vector, Vector, _MM_SHUFFLE(1, 0, 3, 2)));
+        Vector = _mm_add_ps(Vector, _mm_shuffle_ps(Vector, Vector, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(Vector);
+#endif
+    }
+};
+
+//
+// Define the target number of elements per thread for the softmax operation.
+//
+
+#define MLAS_SOFTMAX_ELEMENTS_PER_THREAD (16 * 1024)
+
+//
+// Define the parameters to execute segments of a softmax operation on worker
+// threads.
+//
+
+struct MLAS_SOFTMAX_WORK_BLOCK {
+    int32_t ThreadCountN;
+    bool LogSoftmax;
+    const float* Input;
+    float* Output;
+    size_t N;
+    size_t D;
+};
+
+void
+MLASCALL
+MlasExpKernel(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the generic kernel for the exponential function.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasComputeUnaryKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_DEFAULT,
+        MlasComputeExpVector<MLAS_COMPUTE_KERNEL_TRAITS_DEFAULT>>(Input, Output, N);
+}
+
+void
+MLASCALL
+MlasLogKernel(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the generic kernel for the natural logarithm
+    function.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasComputeUnaryKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_DEFAULT,
+        MlasComputeLogVector<MLAS_COMPUTE_KERNEL_TRAITS_DEFAULT>>(Input, Output, N);
+}
+
+void
+MLASCALL
+MlasErfKernel(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the generic kernel for the error function.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasComputeUnaryKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_DEFAULT,
+        MlasComputeErfVector<MLAS_COMPUTE_KERNEL_TRAITS_DEFAULT>>(Input, Output, N);
+}
+
+float
+MLASCALL
+MlasReduceMaximumKernel(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the generic kernel to find the maximum value of
+    a buffer.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    Returns the maximum value.
+
+--*/
+{
+    return MlasReduceMaximumKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_DEFAULT>(Input, N);
+}
+
+float
+MLASCALL
+MlasComputeSumExpKernel(
+    const float* Input,
+    float* Output,
+    size_t N,
+    float NegativeMaximum
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the generic kernel to compute the exponentials
+    of a buffer offset by the negative maximum and the sum of the
+    exponentials.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Optionally supplies the output buffer to receive the
+        exponentials.
+
+    N - Supplies the number of elements to process.
+
+    NegativeMaximum - Supplies the value to add to each element before
+        computing the exponential.
+
+Return Value:
+
+    Returns the sum of the exponentials.
+
+--*/
+{
+    return MlasComputeSumExpKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_DEFAULT>(Input,
+        Output, N, NegativeMaximum);
+}
+
+void
+MLASCALL
+MlasComputeExp(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential function.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasPlatform.ExpKernelRoutine(Input, Output, N);
+}
+
+void
+MLASCALL
+MlasComputeLog(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the natural logarithm function.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasPlatform.LogKernelRoutine(Input, Output, N);
+}
+
+void
+MLASCALL
+MlasComputeErf(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the error function.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasPlatform.ErfKernelRoutine(Input, Output, N);
+}
+
+float
+MLASCALL
+MlasReduceMaximum(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine finds the maximum value of a buffer.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    Returns the maximum value, or negative infinity if the buffer is empty.
+
+--*/
+{
+    return MlasPlatform.ReduceMaximumKernelRoutine(Input, N);
+}
+
+void
+MlasComputeSoftmaxThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    softmax or log softmax operation.
+
+    Each row is processed in two passes: the first pass finds the maximum
+    value and the second pass computes the exponentials offset by the
+    maximum and their sum. A final pass over the row then either scales the
+    exponentials by the reciprocal of the sum or subtracts the logarithm of
+    the sum from the offset input.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_SOFTMAX_WORK_BLOCK* WorkBlock = (MLAS_SOFTMAX_WORK_BLOCK*)Context;
+
+    //
+    // Partition the operation along the N dimension.
+    //
+
+    const size_t N = WorkBlock->N;
+    const size_t D = WorkBlock->D;
+
+    const size_t CountPerThread = N / WorkBlock->ThreadCountN;
+    const size_t CountExtra = N % WorkBlock->ThreadCountN;
+
+    size_t n;
+    size_t CountN;
+
+    if (uint32_t(Index) < CountExtra) {
+        n = (CountPerThread + 1) * Index;
+        CountN = CountPerThread + 1;
+    } else {
+        n = CountPerThread * Index + CountExtra;
+        CountN = CountPerThread;
+    }
+
+    const float* Input = WorkBlock->Input + n * D;
+    float* Output = WorkBlock->Output + n * D;
+
+    while (CountN > 0) {
+
+        const float Maximum = MlasPlatform.ReduceMaximumKernelRoutine(Input, D);
+        const float NegativeMaximum = -Maximum;
+
+        if (WorkBlock->LogSoftmax) {
+
+            //
+            // Compute the sum of the exponentials without storing them and
+            // write the log softmax as the input offset by the maximum and
+            // the logarithm of the sum.
+            //
+
+            const float Accumulation = MlasPlatform.ComputeSumExpKernelRoutine(Input,
+                nullptr, D, NegativeMaximum);
+
+            const float Offset = NegativeMaximum - std::log(Accumulation);
+            const MLAS_FLOAT32X4 OffsetBroadcast = MlasBroadcastFloat32x4(Offset);
+
+            size_t d = 0;
+
+            for (; d + 4 <= D; d += 4) {
+                MlasStoreFloat32x4(&Output[d], MlasAddFloat32x4(MlasLoadFloat32x4(&Input[d]), OffsetBroadcast));
+            }
+
+            for (; d < D; d++) {
+                Output[d] = Input[d] + Offset;
+            }
+
+        } else {
+
+            //
+            // Store the exponentials to the output and then scale them by
+            // the reciprocal of the sum.
+            //
+
+            const float Accumulation = MlasPlatform.ComputeSumExpKernelRoutine(Input,
+                Output, D, NegativeMaximum);
+
+            const float Scale = 1.0f / Accumulation;
+            const MLAS_FLOAT32X4 ScaleBroadcast = MlasBroadcastFloat32x4(Scale);
+
+            size_t d = 0;
+
+            for (; d + 4 <= D; d += 4) {
+                MlasStoreFloat32x4(&Output[d], MlasMultiplyFloat32x4(MlasLoadFloat32x4(&Output[d]), ScaleBroadcast));
+            }
+
+            for (; d < D; d++) {
+                Output[d] *= Scale;
+            }
+        }
+
+        Input += D;
+        Output += D;
+        CountN--;
+    }
+}
+
+void
+MLASCALL
+MlasComputeSoftmax(
+    const float* Input,
+    float* Output,
+    size_t N,
+    size_t D,
+    bool LogSoftmax,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the softmax or log softmax function of each row of
+    a matrix.
+
+Arguments:
+
+    Input - Supplies the input matrix.
+
+    Output - Supplies the output matrix.
+
+    N - Supplies the number of rows to process.
+
+    D - Supplies the number of columns per row to process.
+
+    LogSoftmax - Supplies true if this is a log softmax operation, else false
+        if this is a softmax operation.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_SOFTMAX_WORK_BLOCK WorkBlock;
+
+    //
+    // Capture the softmax parameters to the work block.
+    //
+
+    WorkBlock.LogSoftmax = LogSoftmax;
+    WorkBlock.Input = Input;
+    WorkBlock.Output = Output;
+    WorkBlock.N = N;
+    WorkBlock.D = D;
+
+    //
+    // Compute the number of target threads given the complexity of the
+    // operation. Small requests should run using the single threaded path.
+    //
+
+    const double Complexity = double(N) * double(D);
+
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_SOFTMAX_ELEMENTS_PER_THREAD * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SOFTMAX_ELEMENTS_PER_THREAD)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (size_t(TargetThreadCount) >= N) {
+        TargetThreadCount = int32_t(N);
+    }
+
+    if (TargetThreadCount == 0) {
+        return;
+    }
+
+    WorkBlock.ThreadCountN = TargetThreadCount;
+
+    MlasExecuteThreaded(MlasComputeSoftmaxThreaded, &WorkBlock, TargetThreadCount, ThreadPool);
+}
@@ -0,0 +1,514 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    compute_kernel.h
+
+Abstract:
+
+    This module contains the elementwise transcendental function and row
+    reduction kernel templates that are instantiated for each instruction set
+    extension.
+
+    The exponential and logarithm use the polynomial approximations from the
+    Cephes library and the error function uses the rational approximation
+    from Eigen.
+
+    The instruction set is described by a traits type that supplies the
+    vector type, the comparison mask type, the number of floats per vector and
+    the vector operations.
+
+--*/
+
+#pragma once
+
+#include "mlasi.h"
+
+//
+// Define the constants for the exponential function.
+//
+
+struct MLAS_EXP_CONSTANTS {
+    static constexpr float LowerRange = -103.9720840454f;
+    static constexpr float UpperRange = 88.7762626647950f;
+    static constexpr float Log2Reciprocal = 1.44269504088896341f;
+    static constexpr float RoundingBias = 12582912.0f;
+    static constexpr float Log2High = -6.93359375e-1f;
+    static constexpr float Log2Low = 2.12194440e-4f;
+    static constexpr float poly_0 = 1.9875691500e-4f;
+    static constexpr float poly_1 = 1.3981999507e-3f;
+    static constexpr float poly_2 = 8.3334519073e-3f;
+    static constexpr float poly_3 = 4.1665795894e-2f;
+    static constexpr float poly_4 = 1.6666665459e-1f;
+    static constexpr float poly_5 = 5.0000001201e-1f;
+};
+
+//
+// Define the constants for the natural logarithm function.
+//
+
+struct MLAS_LOG_CONSTANTS {
+    static constexpr float MinimumNormal = 1.17549435e-38f;
+    static constexpr float SquareRootHalf = 0.707106781186547524f;
+    static constexpr float Log2High = 6.93359375e-1f;
+    static constexpr float Log2Low = -2.12194440e-4f;
+    static constexpr float poly_0 = 7.0376836292e-2f;
+    static constexpr float poly_1 = -1.1514610310e-1f;
+    static constexpr float poly_2 = 1.1676998740e-1f;
+    static constexpr float poly_3 = -1.2420140846e-1f;
+    static constexpr float poly_4 = 1.4249322787e-1f;
+    static constexpr float poly_5 = -1.6668057665e-1f;
+    static constexpr float poly_6 = 2.0000714765e-1f;
+    static constexpr float poly_7 = -2.4999993993e-1f;
+    static constexpr float poly_8 = 3.3333331174e-1f;
+};
+
+//
+// Define the constants for the error function.
+//
+
+struct MLAS_ERF_CONSTANTS {
+    static constexpr float LowerRange = -4.0f;
+    static constexpr float UpperRange = 4.0f;
+    static constexpr float alpha_1 = -2.72614225801306e-10f;
+    static constexpr float alpha_3 = 2.77068142495902e-08f;
+    static constexpr float alpha_5 = -2.10102402082508e-06f;
+    static constexpr float alpha_7 = -5.69250639462346e-05f;
+    static constexpr float alpha_9 = -7.34990630326855e-04f;
+    static constexpr float alpha_11 = -2.95459980854025e-03f;
+    static constexpr float alpha_13 = -1.60960333262415e-02f;
+    static constexpr float beta_0 = -1.42647390514189e-02f;
+    static constexpr float beta_2 = -7.37332916720468e-03f;
+    static constexpr float beta_4 = -1.68282697438203e-03f;
+    static constexpr float beta_6 = -2.13374055278905e-04f;
+    static constexpr float beta_8 = -1.45660718464996e-05f;
+};
+
+template<typename KernelTraits>
+MLAS_FORCEINLINE
+typename KernelTraits::VectorType
+MlasComputeExpVector(
+    typename KernelTraits::VectorType Value
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential function for a vector.
+
+    The input is split as n * ln(2) + r with |r| <= ln(2)/2, a polynomial
+    approximates exp(r) and the result is scaled by 2^n.
+
+Arguments:
+
+    Value - Supplies the input vector.
+
+Return Value:
+
+    Returns the exponential of each element of the input vector.
+
+--*/
+{
+    typedef KernelTraits T;
+    typedef MLAS_EXP_CONSTANTS C;
+
+    Value = T::Maximum(T::Broadcast(C::LowerRange), Value);
+    Value = T::Minimum(T::Broadcast(C::UpperRange), Value);
+
+    //
+    // Round Value / ln(2) to the nearest integer by adding and removing a bias
+    // that pushes the fractional bits out of the mantissa.
+    //
+
+    typename T::VectorType Exponent = T::MultiplyAdd(Value, T::Broadcast(C::Log2Reciprocal),
+        T::Broadcast(C::RoundingBias));
+    Exponent = T::Subtract(Exponent, T::Broadcast(C::RoundingBias));
+
+    typename T::VectorType r;
+    r = T::MultiplyAdd(Exponent, T::Broadcast(C::Log2High), Value);
+    r = T::MultiplyAdd(Exponent, T::Broadcast(C::Log2Low), r);
+
+    typename T::VectorType p;
+    p = T::MultiplyAdd(T::Broadcast(C::poly_0), r, T::Broadcast(C::poly_1));
+    p = T::MultiplyAdd(p, r, T::Broadcast(C::poly_2));
+    p = T::MultiplyAdd(p, r, T::Broadcast(C::poly_3));
+    p = T::MultiplyAdd(p, r, T::Broadcast(C::poly_4));
+    p = T::MultiplyAdd(p, r, T::Broadcast(C::poly_5));
+    p = T::MultiplyAdd(p, T::Multiply(r, r), T::Add(r, T::Broadcast(1.0f)));
+
+    return T::ScaleByPowerOf2(p, Exponent);
+}
+
+template<typename KernelTraits>
+MLAS_FORCEINLINE
+typename KernelTraits::VectorType
+MlasComputeLogVector(
+    typename KernelTraits::VectorType Value
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the natural logarithm function for a vector.
+
+    The input is split as m * 2^e with sqrt(0.5) <= m < sqrt(2), a polynomial
+    approximates log(m) and e * ln(2) is added back.
+
+Arguments:
+
+    Value - Supplies the input vector.
+
+Return Value:
+
+    Returns the natural logarithm of each element of the input vector.
+
+--*/
+{
+    typedef KernelTraits T;
+    typedef MLAS_LOG_CONSTANTS C;
+
+    typename T::VectorType x = T::Maximum(T::Broadcast(C::MinimumNormal), Value);
+
+    typename T::VectorType m;
+    typename T::VectorType e = T::ExtractExponent(x, m);
+
+    //
+    // Adjust the mantissa from [0.5, 1) to [sqrt(0.5), sqrt(2)) and subtract
+    // one so that the polynomial is evaluated around zero.
+    //
+
+    typename T::MaskType Mask = T::CompareLess(m, T::Broadcast(C::SquareRootHalf));
+
+    e = T::Subtract(e, T::Select(Mask, T::Broadcast(1.0f), T::Broadcast(0.0f)));
+    m = T::Add(T::Subtract(m, T::Broadcast(1.0f)), T::Select(Mask, m, T::Broadcast(0.0f)));
+
+    typename T::VectorType z = T::Multiply(m, m);
+
+    typename T::VectorType p;
+    p = T::MultiplyAdd(T::Broadcast(C::poly_0), m, T::Broadcast(C::poly_1));
+    p = T::MultiplyAdd(p, m, T::Broadcast(C::poly_2));
+    p = T::MultiplyAdd(p, m, T::Broadcast(C::poly_3));
+    p = T::MultiplyAdd(p, m, T::Broadcast(C::poly_4));
+    p = T::MultiplyAdd(p, m, T::Broadcast(C::poly_5));
+    p = T::MultiplyAdd(p, m, T::Broadcast(C::poly_6));
+    p = T::MultiplyAdd(p, m, T::Broadcast(C::poly_7));
+    p = T::MultiplyAdd(p, m, T::Broadcast(C::poly_8));
+    p = T::Multiply(T::Multiply(p, m), z);
+
+    p = T::MultiplyAdd(e, T::Broadcast(C::Log2Low), p);
+    p = T::MultiplyAdd(z, T::Broadcast(-0.5f), p);
+
+    typename T::VectorType Result = T::MultiplyAdd(e, T::Broadcast(C::Log2High), T::Add(m, p));
+
+    //
+    // Handle the special cases: a NaN or negative input produces NaN, zero
+    // produces negative infinity and infinity produces infinity.
+    //
+
+    const float Infinity = std::numeric_limits<float>::infinity();
+
+    Result = T::Select(T::CompareEqual(Value, T::Broadcast(Infinity)), Value, Result);
+    Result = T::Select(T::CompareEqual(Value, T::Broadcast(0.0f)), T::Broadcast(-Infinity), Result);
+    Result = T::Select(T::CompareLess(Value, T::Broadcast(0.0f)),
+        T::Broadcast(std::numeric_limits<float>::quiet_NaN()), Result);
+    Result = T::Select(T::CompareEqual(Value, Value), Result, Value);
+
+    return Result;
+}
+
+template<typename KernelTraits>
+MLAS_FORCEINLINE
+typename KernelTraits::VectorType
+MlasComputeErfVector(
+    typename KernelTraits::VectorType Value
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the error function for a vector.
+
+Arguments:
+
+    Value - Supplies the input vector.
+
+Return Value:
+
+    Returns the error function of each element of the input vector.
+
+--*/
+{
+    typedef KernelTraits T;
+    typedef MLAS_ERF_CONSTANTS C;
+
+    Value = T::Maximum(T::Broadcast(C::LowerRange), Value);
+    Value = T::Minimum(T::Broadcast(C::UpperRange), Value);
+
+    typename T::VectorType ValueSquared = T::Multiply(Value, Value);
+
+    typename T::VectorType p;
+    p = T::MultiplyAdd(ValueSquared, T::Broadcast(C::alpha_1), T::Broadcast(C::alpha_3));
+    p = T::MultiplyAdd(p, ValueSquared, T::Broadcast(C::alpha_5));
+    p = T::MultiplyAdd(p, ValueSquared, T::Broadcast(C::alpha_7));
+    p = T::MultiplyAdd(p, ValueSquared, T::Broadcast(C::alpha_9));
+    p = T::MultiplyAdd(p, ValueSquared, T::Broadcast(C::alpha_11));
+    p = T::MultiplyAdd(p, ValueSquared, T::Broadcast(C::alpha_13));
+    p = T::Multiply(p, Value);
+
+    typename T::VectorType q;
+    q = T::MultiplyAdd(ValueSquared, T::Broadcast(C::beta_8), T::Broadcast(C::beta_6));
+    q = T::MultiplyAdd(q, ValueSquared, T::Broadcast(C::beta_4));
+    q = T::MultiplyAdd(q, ValueSquared, T::Broadcast(C::beta_2));
+    q = T::MultiplyAdd(q, ValueSquared, T::Broadcast(C::beta_0));
+
+    return T::Divide(p, q);
+}
+
+template<typename KernelTraits, typename KernelTraits::VectorType (*ComputeVector)(typename KernelTraits::VectorType)>
+void
+MlasComputeUnaryKernelTemplate(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine applies an elementwise vector function to a buffer.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    constexpr size_t VectorLength = KernelTraits::VectorLength;
+
+    while (N >= VectorLength) {
+
+        KernelTraits::Store(Output, ComputeVector(KernelTraits::Load(Input)));
+
+        Input += VectorLength;
+        Output += VectorLength;
+        N -= VectorLength;
+    }
+
+    //
+    // Process the remaining elements through a temporary vector so that the
+    // results match the vector path.
+    //
+
+    if (N > 0) {
+
+        float Buffer[VectorLength];
+
+        for (size_t n = 0; n < VectorLength; n++) {
+            Buffer[n] = (n < N) ? Input[n] : 0.0f;
+        }
+
+        KernelTraits::Store(Buffer, ComputeVector(KernelTraits::Load(Buffer)));
+
+        for (size_t n = 0; n < N; n++) {
+            Output[n] = Buffer[n];
+        }
+    }
+}
+
+template<typename KernelTraits>
+float
+MlasReduceMaximumKernelTemplate(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the maximum value of a buffer.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    N - Supplies the number of elements to process.
+
+Return Value:
+
+    Returns the maximum value, or negative infinity if the buffer is empty.
+
+--*/
+{
+    typedef typename KernelTraits::VectorType VectorType;
+
+    constexpr size_t VectorLength = KernelTraits::VectorLength;
+
+    float Maximum = -std::numeric_limits<float>::infinity();
+
+    if (N >= VectorLength) {
+
+        //
+        // Use independent accumulators to hide the latency of the maximum
+        // operation.
+        //
+
+        VectorType Maximum0 = KernelTraits::Load(Input);
+        VectorType Maximum1 = Maximum0;
+        VectorType Maximum2 = Maximum0;
+        VectorType Maximum3 = Maximum0;
+
+        while (N >= VectorLength * 4) {
+
+            Maximum0 = KernelTraits::Maximum(Maximum0, KernelTraits::Load(Input));
+            Maximum1 = KernelTraits::Maximum(Maximum1, KernelTraits::Load(Input + VectorLength));
+            Maximum2 = KernelTraits::Maximum(Maximum2, KernelTraits::Load(Input + VectorLength * 2));
+            Maximum3 = KernelTraits::Maximum(Maximum3, KernelTraits::Load(Input + VectorLength * 3));
+
+            Input += VectorLength * 4;
+            N -= VectorLength * 4;
+        }
+
+        while (N >= VectorLength) {
+
+            Maximum0 = KernelTraits::Maximum(Maximum0, KernelTraits::Load(Input));
+
+            Input += VectorLength;
+            N -= VectorLength;
+        }
+
+        Maximum0 = KernelTraits::Maximum(Maximum0, Maximum1);
+        Maximum2 = KernelTraits::Maximum(Maximum2, Maximum3);
+        Maximum0 = KernelTraits::Maximum(Maximum0, Maximum2);
+
+        Maximum = KernelTraits::ReduceMaximum(Maximum0);
+    }
+
+    while (N > 0) {
+
+        Maximum = (std::max)(Maximum, *Input);
+
+        Input += 1;
+        N -= 1;
+    }
+
+    return Maximum;
+}
+
+template<typename KernelTraits>
+float
+MlasComputeSumExpKernelTemplate(
+    const float* Input,
+    float* Output,
+    size_t N,
+    float NegativeMaximum
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the exponential of each element of a buffer offset
+    by the negative maximum and returns the sum of the exponentials.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    Output - Optionally supplies the output buffer to receive the
+        exponentials.
+
+    N - Supplies the number of elements to process.
+
+    NegativeMaximum - Supplies the value to add to each element before
+        computing the exponential.
+
+Return Value:
+
+    Returns the sum of the exponentials.
+
+--*/
+{
+    typedef typename KernelTraits::VectorType VectorType;
+
+    constexpr size_t VectorLength = KernelTraits::VectorLength;
+
+    const VectorType NegativeMaximumBroadcast = KernelTraits::Broadcast(NegativeMaximum);
+
+    VectorType Accumulator0 = KernelTraits::Broadcast(0.0f);
+    VectorType Accumulator1 = Accumulator0;
+
+    while (N >= VectorLength * 2) {
+
+        VectorType Vector0 = KernelTraits::Add(KernelTraits::Load(Input), NegativeMaximumBroadcast);
+        VectorType Vector1 = KernelTraits::Add(KernelTraits::Load(Input + VectorLength), NegativeMaximumBroadcast);
+
+        Vector0 = MlasComputeExpVector<KernelTraits>(Vector0);
+        Vector1 = MlasComputeExpVector<KernelTraits>(Vector1);
+
+        Accumulator0 = KernelTraits::Add(Accumulator0, Vector0);
+        Accumulator1 = KernelTraits::Add(Accumulator1, Vector1);
+
+        if (Output != nullptr) {
+            KernelTraits::Store(Output, Vector0);
+            KernelTraits::Store(Output + VectorLength, Vector1);
+            Output += VectorLength * 2;
+        }
+
+        Input += VectorLength * 2;
+        N -= VectorLength * 2;
+    }
+
+    if (N >= VectorLength) {
+
+        VectorType Vector0 = KernelTraits::Add(KernelTraits::Load(Input), NegativeMaximumBroadcast);
+
+        Vector0 = MlasComputeExpVector<KernelTraits>(Vector0);
+
+        Accumulator0 = KernelTraits::Add(Accumulator0, Vector0);
+
+        if (Output != nullptr) {
+            KernelTraits::Store(Output, Vector0);
+            Output += VectorLength;
+        }
+
+        Input += VectorLength;
+        N -= VectorLength;
+    }
+
+    float Sum = KernelTraits::ReduceAdd(KernelTraits::Add(Accumulator0, Accumulator1));
+
+    if (N > 0) {
+
+        float Buffer[VectorLength];
+
+        for (size_t n = 0; n < VectorLength; n++) {
+            Buffer[n] = (n < N) ? Input[n] : 0.0f;
+        }
+
+        VectorType Vector0 = KernelTraits::Add(KernelTraits::Load(Buffer), NegativeMaximumBroadcast);
+
+        KernelTraits::Store(Buffer, MlasComputeExpVector<KernelTraits>(Vector0));
+
+        for (size_t n = 0; n < N; n++) {
+
+            Sum += Buffer[n];
+
+            if (Output != nullptr) {
+                Output[n] = Buffer[n];
+            }
+        }
+    }
+
+    return Sum;
+}
@@ -0,0 +1,269 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    compute_kernel_avx2.cpp
+
+Abstract:
+
+    This module implements the exponential, natural logarithm, error function
+    and softmax reduction kernels for AVX2/FMA3.
+
+--*/
+
+#include "compute_kernel.h"
+
+struct MLAS_COMPUTE_KERNEL_TRAITS_AVX2 {
+
+    typedef __m256 VectorType;
+
+    typedef __m256 MaskType;
+
+    static constexpr size_t VectorLength = 8;
+
+    static VectorType Load(const float* Buffer)
+    {
+        return _mm256_loadu_ps(Buffer);
+    }
+
+    static void Store(float* Buffer, VectorType Vector)
+    {
+        _mm256_storeu_ps(Buffer, Vector);
+    }
+
+    static VectorType Broadcast(float Value)
+    {
+        return _mm256_set1_ps(Value);
+    }
+
+    static VectorType Add(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm256_add_ps(Vector1, Vector2);
+    }
+
+    static VectorType Subtract(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm256_sub_ps(Vector1, Vector2);
+    }
+
+    static VectorType Multiply(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm256_mul_ps(Vector1, Vector2);
+    }
+
+    static VectorType MultiplyAdd(VectorType Vector1, VectorType Vector2, VectorType Vector3)
+    {
+        return _mm256_fmadd_ps(Vector1, Vector2, Vector3);
+    }
+
+    static VectorType Divide(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm256_div_ps(Vector1, Vector2);
+    }
+
+    static VectorType Maximum(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm256_max_ps(Vector1, Vector2);
+    }
+
+    static VectorType Minimum(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm256_min_ps(Vector1, Vector2);
+    }
+
+    static MaskType CompareLess(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm256_cmp_ps(Vector1, Vector2, _CMP_LT_OQ);
+    }
+
+    static MaskType CompareEqual(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm256_cmp_ps(Vector1, Vector2, _CMP_EQ_OQ);
+    }
+
+    static VectorType Select(MaskType Mask, VectorType TrueVector, VectorType FalseVector)
+    {
+        return _mm256_blendv_ps(FalseVector, TrueVector, Mask);
+    }
+
+    static VectorType ScaleByPowerOf2(VectorType Vector, VectorType Exponent)
+    {
+        //
+        // Split the integral exponent into two halves so that each power of
+        // two has a normal representation.
+        //
+
+        __m256i e = _mm256_cvtps_epi32(Exponent);
+        __m256i e1 = _mm256_srai_epi32(e, 1);
+        __m256i e2 = _mm256_sub_epi32(e, e1);
+        __m256i Bias = _mm256_set1_epi32(127);
+        Vector = _mm256_mul_ps(Vector, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(e1, Bias), 23)));
+        return _mm256_mul_ps(Vector, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(e2, Bias), 23)));
+    }
+
+    static VectorType ExtractExponent(VectorType Vector, VectorType& Mantissa)
+    {
+        __m256i Bits = _mm256_castps_si256(Vector);
+        Mantissa = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(Bits, _mm256_set1_epi32(0x807FFFFF)), _mm256_set1_epi32(0x3F000000)));
+        __m256i e = _mm256_sub_epi32(_mm256_srli_epi32(Bits, 23), _mm256_set1_epi32(126));
+        return _mm256_cvtepi32_ps(e);
+    }
+
+    static float ReduceMaximum(VectorType Vector)
+    {
+        __m128 Reduction = _mm_max_ps(_mm256_castps256_ps128(Vector), _mm256_extractf128_ps(Vector, 1));
+        Reduction = _mm_max_ps(Reduction, _mm_shuffle_ps(Reduction, Reduction, _MM_SHUFFLE(1, 0, 3, 2)));
+        Reduction = _mm_max_ps(Reduction, _mm_shuffle_ps(Reduction, Reduction, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(Reduction);
+    }
+
+    static float ReduceAdd(VectorType Vector)
+    {
+        __m128 Reduction = _mm_add_ps(_mm256_castps256_ps128(Vector), _mm256_extractf128_ps(Vector, 1));
+        Reduction = _mm_add_ps(Reduction, _mm_shuffle_ps(Reduction, Reduction, _MM_SHUFFLE(1, 0, 3, 2)));
+        Reduction = _mm_add_ps(Reduction, _mm_shuffle_ps(Reduction, Reduction, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(Reduction);
+    }
+};
+
+void
+MLASCALL
+MlasExpKernelAvx2(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the kernel for the exponential function using
+    AVX2.
+
+Arguments:
+
+    See MLAS_COMPUTE_UNARY_KERNEL_ROUTINE.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasComputeUnaryKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_AVX2,
+        MlasComputeExpVector<MLAS_COMPUTE_KERNEL_TRAITS_AVX2>>(Input, Output, N);
+}
+
+void
+MLASCALL
+MlasLogKernelAvx2(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the kernel for the natural logarithm function
+    using AVX2.
+
+Arguments:
+
+    See MLAS_COMPUTE_UNARY_KERNEL_ROUTINE.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasComputeUnaryKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_AVX2,
+        MlasComputeLogVector<MLAS_COMPUTE_KERNEL_TRAITS_AVX2>>(Input, Output, N);
+}
+
+void
+MLASCALL
+MlasErfKernelAvx2(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the kernel for the error function using AVX2.
+
+Arguments:
+
+    See MLAS_COMPUTE_UNARY_KERNEL_ROUTINE.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasComputeUnaryKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_AVX2,
+        MlasComputeErfVector<MLAS_COMPUTE_KERNEL_TRAITS_AVX2>>(Input, Output, N);
+}
+
+float
+MLASCALL
+MlasReduceMaximumKernelAvx2(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the kernel to find the maximum value of a buffer
+    using AVX2.
+
+Arguments:
+
+    See MLAS_REDUCE_MAXIMUM_KERNEL_ROUTINE.
+
+Return Value:
+
+    Returns the maximum value.
+
+--*/
+{
+    return MlasReduceMaximumKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_AVX2>(Input, N);
+}
+
+float
+MLASCALL
+MlasComputeSumExpKernelAvx2(
+    const float* Input,
+    float* Output,
+    size_t N,
+    float NegativeMaximum
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the kernel to compute the exponentials of a
+    buffer offset by the negative maximum and the sum of the exponentials
+    using AVX2.
+
+Arguments:
+
+    See MLAS_COMPUTE_SUMEXP_KERNEL_ROUTINE.
+
+Return Value:
+
+    Returns the sum of the exponentials.
+
+--*/
+{
+    return MlasComputeSumExpKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_AVX2>(Input, Output, N, NegativeMaximum);
+}
@@ -0,0 +1,261 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    compute_kernel_avx512f.cpp
+
+Abstract:
+
+    This module implements the exponential, natural logarithm, error function
+    and softmax reduction kernels for AVX512F.
+
+--*/
+
+#include "compute_kernel.h"
+
+struct MLAS_COMPUTE_KERNEL_TRAITS_AVX512F {
+
+    typedef __m512 VectorType;
+
+    typedef __mmask16 MaskType;
+
+    static constexpr size_t VectorLength = 16;
+
+    static VectorType Load(const float* Buffer)
+    {
+        return _mm512_loadu_ps(Buffer);
+    }
+
+    static void Store(float* Buffer, VectorType Vector)
+    {
+        _mm512_storeu_ps(Buffer, Vector);
+    }
+
+    static VectorType Broadcast(float Value)
+    {
+        return _mm512_set1_ps(Value);
+    }
+
+    static VectorType Add(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm512_add_ps(Vector1, Vector2);
+    }
+
+    static VectorType Subtract(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm512_sub_ps(Vector1, Vector2);
+    }
+
+    static VectorType Multiply(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm512_mul_ps(Vector1, Vector2);
+    }
+
+    static VectorType MultiplyAdd(VectorType Vector1, VectorType Vector2, VectorType Vector3)
+    {
+        return _mm512_fmadd_ps(Vector1, Vector2, Vector3);
+    }
+
+    static VectorType Divide(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm512_div_ps(Vector1, Vector2);
+    }
+
+    static VectorType Maximum(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm512_max_ps(Vector1, Vector2);
+    }
+
+    static VectorType Minimum(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm512_min_ps(Vector1, Vector2);
+    }
+
+    static MaskType CompareLess(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm512_cmp_ps_mask(Vector1, Vector2, _CMP_LT_OQ);
+    }
+
+    static MaskType CompareEqual(VectorType Vector1, VectorType Vector2)
+    {
+        return _mm512_cmp_ps_mask(Vector1, Vector2, _CMP_EQ_OQ);
+    }
+
+    static VectorType Select(MaskType Mask, VectorType TrueVector, VectorType FalseVector)
+    {
+        return _mm512_mask_blend_ps(Mask, FalseVector, TrueVector);
+    }
+
+    static VectorType ScaleByPowerOf2(VectorType Vector, VectorType Exponent)
+    {
+        return _mm512_scalef_ps(Vector, Exponent);
+    }
+
+    static VectorType ExtractExponent(VectorType Vector, VectorType& Mantissa)
+    {
+        Mantissa = _mm512_getmant_ps(Vector, _MM_MANT_NORM_p5_1, _MM_MANT_SIGN_src);
+        return _mm512_add_ps(_mm512_getexp_ps(Vector), _mm512_set1_ps(1.0f));
+    }
+
+    static float ReduceMaximum(VectorType Vector)
+    {
+        __m256 Reduction256 = _mm256_max_ps(_mm512_castps512_ps256(Vector),
+            _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(Vector), 1)));
+        __m128 Reduction = _mm_max_ps(_mm256_castps256_ps128(Reduction256), _mm256_extractf128_ps(Reduction256, 1));
+        Reduction = _mm_max_ps(Reduction, _mm_shuffle_ps(Reduction, Reduction, _MM_SHUFFLE(1, 0, 3, 2)));
+        Reduction = _mm_max_ps(Reduction, _mm_shuffle_ps(Reduction, Reduction, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(Reduction);
+    }
+
+    static float ReduceAdd(VectorType Vector)
+    {
+        __m256 Reduction256 = _mm256_add_ps(_mm512_castps512_ps256(Vector),
+            _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(Vector), 1)));
+        __m128 Reduction = _mm_add_ps(_mm256_castps256_ps128(Reduction256), _mm256_extractf128_ps(Reduction256, 1));
+        Reduction = _mm_add_ps(Reduction, _mm_shuffle_ps(Reduction, Reduction, _MM_SHUFFLE(1, 0, 3, 2)));
+        Reduction = _mm_add_ps(Reduction, _mm_shuffle_ps(Reduction, Reduction, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(Reduction);
+    }
+};
+
+void
+MLASCALL
+MlasExpKernelAvx512F(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the kernel for the exponential function using
+    AVX512F.
+
+Arguments:
+
+    See MLAS_COMPUTE_UNARY_KERNEL_ROUTINE.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasComputeUnaryKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_AVX512F,
+        MlasComputeExpVector<MLAS_COMPUTE_KERNEL_TRAITS_AVX512F>>(Input, Output, N);
+}
+
+void
+MLASCALL
+MlasLogKernelAvx512F(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the kernel for the natural logarithm function
+    using AVX512F.
+
+Arguments:
+
+    See MLAS_COMPUTE_UNARY_KERNEL_ROUTINE.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasComputeUnaryKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_AVX512F,
+        MlasComputeLogVector<MLAS_COMPUTE_KERNEL_TRAITS_AVX512F>>(Input, Output, N);
+}
+
+void
+MLASCALL
+MlasErfKernelAvx512F(
+    const float* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the kernel for the error function using AVX512F.
+
+Arguments:
+
+    See MLAS_COMPUTE_UNARY_KERNEL_ROUTINE.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasComputeUnaryKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_AVX512F,
+        MlasComputeErfVector<MLAS_COMPUTE_KERNEL_TRAITS_AVX512F>>(Input, Output, N);
+}
+
+float
+MLASCALL
+MlasReduceMaximumKernelAvx512F(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the kernel to find the maximum value of a buffer
+    using AVX512F.
+
+Arguments:
+
+    See MLAS_REDUCE_MAXIMUM_KERNEL_ROUTINE.
+
+Return Value:
+
+    Returns the maximum value.
+
+--*/
+{
+    return MlasReduceMaximumKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_AVX512F>(Input, N);
+}
+
+float
+MLASCALL
+MlasComputeSumExpKernelAvx512F(
+    const float* Input,
+    float* Output,
+    size_t N,
+    float NegativeMaximum
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the kernel to compute the exponentials of a
+    buffer offset by the negative maximum and the sum of the exponentials
+    using AVX512F.
+
+Arguments:
+
+    See MLAS_COMPUTE_SUMEXP_KERNEL_ROUTINE.
+
+Return Value:
+
+    Returns the sum of the exponentials.
+
+--*/
+{
+    return MlasComputeSumExpKernelTemplate<MLAS_COMPUTE_KERNEL_TRAITS_AVX512F>(Input, Output, N, NegativeMaximum);
+}
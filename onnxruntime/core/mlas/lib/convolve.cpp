@@ -744,7 +744,8 @@ MlasConvTryMultithread(
     const float* Filter,
     const float* Bias,
     float* WorkingBuffer,
-    float* Output
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
     )
 /*++
 
@@ -769,6 +770,9 @@ Arguments:
 
     Output - Supplies the output tensor.
 
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
 Return Value:
 
     Returns true if the operation was completed across multiple threads, else
@@ -776,9 +780,6 @@ Return Value:
 
 --*/
 {
-
-#if defined(MLAS_HAS_THREADING_SUPPORT)
-
     MLAS_CONV_WORK_BLOCK WorkBlock;
 
     const size_t OutputSize = Parameters->OutputSize;
@@ -820,27 +821,9 @@ Return Value:
         Index++;
     }
 
-    MlasExecuteThreaded(MlasConvOperationThreaded, &WorkBlock, Index);
+    MlasExecuteThreaded(MlasConvOperationThreaded, &WorkBlock, Index, ThreadPool);
 
     return true;
-
-#else
-
-    //
-    // No threading implementation is available.
-    //
-
-    MLAS_UNREFERENCED_PARAMETER(Parameters);
-    MLAS_UNREFERENCED_PARAMETER(Input);
-    MLAS_UNREFERENCED_PARAMETER(Filter);
-    MLAS_UNREFERENCED_PARAMETER(Bias);
-    MLAS_UNREFERENCED_PARAMETER(WorkingBuffer);
-    MLAS_UNREFERENCED_PARAMETER(Output);
-
-    return false;
-
-#endif
-
 }
 
 void
@@ -851,7 +834,8 @@ MlasConv(
     const float* Filter,
     const float* Bias,
     float* WorkingBuffer,
-    float* Output
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
     )
 /*++
 
@@ -875,6 +859,9 @@ Arguments:
 
     Output - Supplies the output tensor.
 
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
 Return Value:
 
     None.
@@ -894,7 +881,20 @@ Return Value:
 
     const MLAS_CONV_ALGORITHM Algorithm = Parameters->Algorithm;
 
-#if defined(MLAS_HAS_THREADING_SUPPORT)
+    //
+    // The Winograd and depthwise algorithms schedule their own work across
+    // multiple threads.
+    //
+
+    if (Algorithm == MlasConvAlgorithmWinograd) {
+        MlasConvWinograd(Parameters, Input, Filter, Bias, WorkingBuffer, Output, ThreadPool);
+        return;
+    }
+
+    if (Algorithm == MlasConvAlgorithmDepthwise) {
+        MlasConvDepthwise(Parameters, Input, Filter, Bias, WorkingBuffer, Output, ThreadPool);
+        return;
+    }
 
     //
     // Schedule batches of GEMMs across multiple threads.
@@ -904,7 +904,7 @@ Return Value:
 
         const size_t BatchGroupCount = BatchCount * GroupCount;
 
-        int32_t TargetThreadCount = MlasPlatform.GetMaximumThreadCount();
+        int32_t TargetThreadCount = MlasGetMaximumThreadCount(ThreadPool);
 
         if (size_t(TargetThreadCount) >= BatchGroupCount) {
             TargetThreadCount = int32_t(BatchGroupCount);
@@ -920,13 +920,11 @@ Return Value:
         WorkBlock.Output = Output;
         WorkBlock.TargetThreadCount = TargetThreadCount;
 
-        MlasExecuteThreaded(MlasConvGemmDirectThreaded, &WorkBlock, TargetThreadCount);
+        MlasExecuteThreaded(MlasConvGemmDirectThreaded, &WorkBlock, TargetThreadCount, ThreadPool);
 
         return;
     }
 
-#endif
-
     //
     // Iterate over each batch and group.
     //
@@ -952,7 +950,7 @@ Return Value:
 
                     MlasSgemm(CblasNoTrans, Parameters->u.GemmDirect.TransB, FilterCount,
                         OutputSize, K, 1.0f, filter, K, Input, Parameters->u.GemmDirect.ldb, 0.0f,
-                        Output, OutputSize);
+                        Output, OutputSize, ThreadPool);
 
                     //
                     // Apply the activation with optional bias.
@@ -978,7 +976,7 @@ Return Value:
                     }
 
                     MlasSgemm(CblasNoTrans, CblasNoTrans, FilterCount, OutputSize, K, 1.0f, filter,
-                        K, WorkingBuffer, OutputSize, 0.0f, Output, OutputSize);
+                        K, WorkingBuffer, OutputSize, 0.0f, Output, OutputSize, ThreadPool);
 
                     //
                     // Apply the activation with optional bias.
@@ -998,13 +996,34 @@ Return Value:
                     //
 
                     if (!MlasConvTryMultithread(Parameters, Input, filter, bias, WorkingBuffer,
-                        Output)) {
+                        Output, ThreadPool)) {
                         MlasConvOperation(Parameters, Input, filter, bias, WorkingBuffer,
                             Output, 0, OutputSize);
                     }
 
                     break;
                 }
+
+                case MlasConvAlgorithmWinograd:
+                case MlasConvAlgorithmDepthwise:
+                {
+                    //
+                    // Handled above before iterating over the batches and
+                    // groups.
+                    //
+
+                    break;
+                }
+
+                case MlasConvAlgorithmTranspose:
+                {
+                    //
+                    // Only prepared by MlasConvTransposePrepare for use with
+                    // MlasConvTranspose.
+                    //
+
+                    break;
+                }
             }
 
             //
@@ -1037,8 +1056,10 @@ MlasConvPrepare(
     const int64_t* StrideShape,
     const int64_t* OutputShape,
     size_t FilterCount,
+    const float* TransformedFilter,
     const MLAS_ACTIVATION* Activation,
-    size_t* WorkingBufferSize
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
     )
 /*++
 
@@ -1076,12 +1097,21 @@ Arguments:
 
     FilterCount - Supplies the number of rows of the filter matrix per group.
 
+    TransformedFilter - Optionally supplies the filter tensor transformed by
+        MlasConvWinogradTransformFilter. If the Winograd algorithm is selected,
+        this avoids transforming the filter for each call to MlasConv. This
+        parameter is ignored for the other algorithms.
+
     Activation - Supplies the parameters for the activation to apply to the
         convolution output.
 
     WorkingBufferSize - Receives the number of elements to allocate for the
         working buffer for intermediate results.
 
+    ThreadPool - Supplies the thread pool object that will be used to execute
+        the convolution, else nullptr if the platform threading implementation
+        will be used.
+
 Return Value:
 
     None.
@@ -1179,6 +1209,26 @@ Return Value:
         }
     }
 
+    //
+    // Detect a depthwise convolution.
+    //
+
+    if (MlasConvDepthwisePrepare(Parameters, WorkingBufferSize, ThreadPool)) {
+        return;
+    }
+
+    //
+    // Detect a 3x3 convolution that can use the Winograd algorithm.
+    //
+
+    if (Dimensions == 2 && AllStridesAreOne && AllDilationsAreOne &&
+        Parameters->KernelShape[0] == 3 && Parameters->KernelShape[1] == 3) {
+
+        if (MlasConvWinogradPrepare(Parameters, TransformedFilter, WorkingBufferSize, ThreadPool)) {
+            return;
+        }
+    }
+
     if (FilterCount > OutputSize) {
 
         //
@@ -1210,7 +1260,7 @@ Return Value:
             TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
         }
 
-        int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+        int32_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
 
         if (TargetThreadCount >= MaximumThreadCount) {
             TargetThreadCount = MaximumThreadCount;
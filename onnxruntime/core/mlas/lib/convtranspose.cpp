@@ -0,0 +1,579 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    convtranspose.cpp
+
+Abstract:
+
+    This module implements the transposed convolution operation.
+
+    A transposed convolution multiplies the transposed filter matrix against
+    the input image to produce a column matrix with one row per output
+    channel and kernel element, then accumulates the column matrix into the
+    output image (col2im).
+
+    Instead of expanding the full column matrix for an image, the input image
+    is divided into blocks of input rows and each block is processed as tiles
+    of input pixels. The GEMM for a tile is immediately followed by the col2im
+    accumulation of the tile, so the column matrix stays in the cache.
+
+    Blocks are sized so that the output rows written by two blocks that are
+    separated by another block do not overlap. Even blocks and then odd
+    blocks are executed across threads, so no two threads accumulate to the
+    same output element at the same time.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the target number of working buffer elements per thread. This is
+// used to size the tiles of input pixels.
+//
+
+#define MLAS_CONV_TRANSPOSE_WORKING_BUFFER_SIZE_PER_THREAD (64 * 1024)
+
+//
+// Define the minimum number of input pixels per tile, which is the N
+// dimension of the GEMM.
+//
+
+#define MLAS_CONV_TRANSPOSE_MINIMUM_TILE_COLUMNS 16
+
+//
+// Define the parameters to execute segments of a transposed convolution on
+// worker threads.
+//
+
+struct MLAS_CONV_TRANSPOSE_WORK_BLOCK {
+    const MLAS_CONV_PARAMETERS* Parameters;
+    const float* Input;
+    const float* Filter;
+    const float* Bias;
+    float* WorkingBuffer;
+    float* Output;
+    size_t BlockParity;
+};
+
+void
+MlasConvTransposeCol2Im(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* ColumnBuffer,
+    float* Output,
+    size_t PixelStart,
+    size_t PixelCount
+    )
+/*++
+
+Routine Description:
+
+    This routine accumulates a tile of the column matrix into the output
+    image.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    ColumnBuffer - Supplies the tile of the column matrix, with one row per
+        output channel and kernel element and one column per input pixel.
+
+    Output - Supplies the output image for the current batch and group.
+
+    PixelStart - Supplies the index of the first input pixel of the tile.
+
+    PixelCount - Supplies the number of input pixels of the tile.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t InputWidth = Parameters->InputShape[1];
+    const size_t KernelHeight = Parameters->KernelShape[0];
+    const size_t KernelWidth = Parameters->KernelShape[1];
+    const size_t DilationHeight = Parameters->DilationShape[0];
+    const size_t DilationWidth = Parameters->DilationShape[1];
+    const size_t PaddingLeftY = Parameters->Padding[0];
+    const size_t PaddingLeftX = Parameters->Padding[1];
+    const size_t StrideHeight = Parameters->StrideShape[0];
+    const size_t StrideWidth = Parameters->StrideShape[1];
+    const size_t OutputHeight = Parameters->OutputShape[0];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+    const size_t OutputSize = Parameters->OutputSize;
+    const size_t FilterCount = Parameters->FilterCount;
+
+    const size_t ihStart = PixelStart / InputWidth;
+    const size_t iwStart = PixelStart % InputWidth;
+
+    for (size_t f = 0; f < FilterCount; f++) {
+
+        for (size_t kh = 0; kh < KernelHeight; kh++) {
+
+            for (size_t kw = 0; kw < KernelWidth; kw++) {
+
+                size_t ih = ihStart;
+                size_t iw = iwStart;
+
+                //
+                // The unsigned arithmetic wraps the output coordinates in the
+                // leading padding to large values, so a single comparison
+                // detects elements outside of the output image.
+                //
+
+                size_t oh = ih * StrideHeight + kh * DilationHeight - PaddingLeftY;
+                float* output = Output + oh * OutputWidth;
+
+                for (size_t n = 0; n < PixelCount; n++) {
+
+                    const size_t ow = iw * StrideWidth + kw * DilationWidth - PaddingLeftX;
+
+                    if (oh < OutputHeight && ow < OutputWidth) {
+                        output[ow] += ColumnBuffer[n];
+                    }
+
+                    if (++iw == InputWidth) {
+                        iw = 0;
+                        ih++;
+                        oh += StrideHeight;
+                        output += StrideHeight * OutputWidth;
+                    }
+                }
+
+                ColumnBuffer += PixelCount;
+            }
+        }
+
+        Output += OutputSize;
+    }
+}
+
+void
+MlasConvTransposeThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    transposed convolution operation.
+
+    Each work item is a block of input rows of one batch and group with the
+    parity selected by the work block.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_CONV_TRANSPOSE_WORK_BLOCK* WorkBlock = (MLAS_CONV_TRANSPOSE_WORK_BLOCK*)Context;
+
+    const MLAS_CONV_PARAMETERS* Parameters = WorkBlock->Parameters;
+
+    const size_t GroupCount = Parameters->GroupCount;
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t InputHeight = Parameters->InputShape[0];
+    const size_t InputWidth = Parameters->InputShape[1];
+    const size_t InputSize = Parameters->InputSize;
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t OutputSize = Parameters->OutputSize;
+    const size_t K = Parameters->K;
+
+    const size_t BlockRows = Parameters->u.ConvTranspose.BlockRows;
+    const size_t BlockCount = Parameters->u.ConvTranspose.BlockCount;
+    const size_t TileColumns = Parameters->u.ConvTranspose.TileColumns;
+    const size_t ThreadCount = Parameters->u.ConvTranspose.ThreadCount;
+
+    //
+    // Compute the range of work items to use for this thread. Only the blocks
+    // with the current parity are executed.
+    //
+
+    const size_t ParityBlockCount = (BlockCount + 1 - WorkBlock->BlockParity) / 2;
+    const size_t WorkItemCount = Parameters->BatchCount * GroupCount * ParityBlockCount;
+
+    const size_t WorkItemCountPerThread = WorkItemCount / ThreadCount;
+    const size_t WorkItemCountExtra = WorkItemCount % ThreadCount;
+
+    size_t WorkItemStart;
+    size_t WorkItemEnd;
+
+    if (uint32_t(Index) < WorkItemCountExtra) {
+        WorkItemStart = (WorkItemCountPerThread + 1) * Index;
+        WorkItemEnd = WorkItemStart + WorkItemCountPerThread + 1;
+    } else {
+        WorkItemStart = WorkItemCountPerThread * Index + WorkItemCountExtra;
+        WorkItemEnd = WorkItemStart + WorkItemCountPerThread;
+    }
+
+    float* ColumnBuffer = WorkBlock->WorkingBuffer + Index * K * TileColumns;
+
+    for (size_t WorkItem = WorkItemStart; WorkItem < WorkItemEnd; WorkItem++) {
+
+        const size_t bg = WorkItem / ParityBlockCount;
+        const size_t group = bg % GroupCount;
+        const size_t block = (WorkItem % ParityBlockCount) * 2 + WorkBlock->BlockParity;
+
+        const size_t ihStart = block * BlockRows;
+        const size_t ihEnd = (std::min)(ihStart + BlockRows, InputHeight);
+
+        const float* input = WorkBlock->Input + bg * InputChannels * InputSize;
+        const float* filter = WorkBlock->Filter + group * InputChannels * K;
+        float* output = WorkBlock->Output + bg * FilterCount * OutputSize;
+
+        //
+        // Process the input pixels of the block in tiles.
+        //
+
+        const size_t PixelEnd = ihEnd * InputWidth;
+        size_t PixelCount;
+
+        for (size_t PixelStart = ihStart * InputWidth; PixelStart < PixelEnd; PixelStart += PixelCount) {
+
+            PixelCount = (std::min)(PixelEnd - PixelStart, TileColumns);
+
+            MlasSgemmOperation(CblasTrans, CblasNoTrans, K, PixelCount, InputChannels, 1.0f,
+                filter, K, input + PixelStart, InputSize, 0.0f, ColumnBuffer, PixelCount);
+
+            MlasConvTransposeCol2Im(Parameters, ColumnBuffer, output, PixelStart, PixelCount);
+        }
+    }
+}
+
+void
+MlasConvTransposeActivationThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to apply the activation with
+    optional bias to a batch and group of the output of a transposed
+    convolution operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_CONV_TRANSPOSE_WORK_BLOCK* WorkBlock = (MLAS_CONV_TRANSPOSE_WORK_BLOCK*)Context;
+
+    const MLAS_CONV_PARAMETERS* Parameters = WorkBlock->Parameters;
+
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t OutputSize = Parameters->OutputSize;
+
+    const float* bias = WorkBlock->Bias;
+
+    if (bias != nullptr) {
+        bias += (size_t(Index) % Parameters->GroupCount) * FilterCount;
+    }
+
+    float* output = WorkBlock->Output + size_t(Index) * FilterCount * OutputSize;
+
+    MlasActivation(Parameters->Activation, output, bias, FilterCount, output,
+        OutputSize, OutputSize);
+}
+
+void
+MLASCALL
+MlasConvTransposePrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    size_t Dimensions,
+    size_t BatchCount,
+    size_t GroupCount,
+    size_t InputChannels,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    size_t FilterCount,
+    const MLAS_ACTIVATION* Activation,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine prepares for a transposed convolution operation by computing
+    required parameters including the required working buffer size for
+    intermediate results.
+
+Arguments:
+
+    Parameters - Supplies the structure that stores the provided and computed
+        parameters for the transposed convolution operation.
+
+    Dimensions - Supplies the number of dimensions (must be 2).
+
+    BatchCount - Supplies the number of batches to the processed.
+
+    GroupCount - Supplies the number of channel groups.
+
+    InputChannels - Supplies the number of input channels per group.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    KernelShape - Supplies the shape of the kernel transform.
+
+    DilationShape - Supplies the shape of the dilation.
+
+    Padding - Supplies the number of padding elements removed from the edges
+        of the output tensor.
+
+    StrideShape - Supplies the shape of the stride.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+    FilterCount - Supplies the number of output channels per group.
+
+    Activation - Supplies the parameters for the activation to apply to the
+        transposed convolution output.
+
+    WorkingBufferSize - Receives the number of elements to allocate for the
+        working buffer for intermediate results.
+
+    ThreadPool - Supplies the thread pool object that will be used to execute
+        the transposed convolution, else nullptr if the platform threading
+        implementation will be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    //
+    // Save the transposed convolution parameters.
+    //
+
+    Parameters->Activation = Activation;
+    Parameters->Dimensions = Dimensions;
+    Parameters->BatchCount = BatchCount;
+    Parameters->GroupCount = GroupCount;
+    Parameters->InputChannels = InputChannels;
+    Parameters->FilterCount = FilterCount;
+
+    size_t InputSize = 1;
+    size_t OutputSize = 1;
+    size_t K = FilterCount;
+
+    for (size_t dim = 0; dim < Dimensions; dim++) {
+
+        Parameters->InputShape[dim] = size_t(InputShape[dim]);
+        Parameters->OutputShape[dim] = size_t(OutputShape[dim]);
+        Parameters->KernelShape[dim] = size_t(KernelShape[dim]);
+        Parameters->DilationShape[dim] = size_t(DilationShape[dim]);
+        Parameters->Padding[dim] = size_t(Padding[dim]);
+        Parameters->Padding[dim + Dimensions] = size_t(Padding[dim + Dimensions]);
+        Parameters->StrideShape[dim] = size_t(StrideShape[dim]);
+
+        InputSize *= Parameters->InputShape[dim];
+        OutputSize *= Parameters->OutputShape[dim];
+        K *= Parameters->KernelShape[dim];
+    }
+
+    Parameters->InputSize = InputSize;
+    Parameters->OutputSize = OutputSize;
+    Parameters->K = K;
+
+    Parameters->Algorithm = MlasConvAlgorithmTranspose;
+
+    //
+    // Compute the number of target threads given the complexity of the
+    // operation. Small requests should run using the single threaded path.
+    //
+
+    const size_t BatchGroupCount = BatchCount * GroupCount;
+
+    double Complexity = double(BatchGroupCount) * double(InputSize) * double(K) *
+        double(InputChannels);
+
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    //
+    // Compute the minimum number of input rows per block so that the output
+    // rows written by blocks i and i + 2 do not overlap. The output rows
+    // written by a block of R input rows starting at row r span from
+    // r * stride - padding to (r + R - 1) * stride + (kernel - 1) * dilation -
+    // padding.
+    //
+
+    const size_t InputHeight = Parameters->InputShape[0];
+    const size_t StrideHeight = Parameters->StrideShape[0];
+    const size_t KernelExtent = (Parameters->KernelShape[0] - 1) * Parameters->DilationShape[0];
+
+    size_t MinimumBlockRows = (KernelExtent + StrideHeight - 1) / StrideHeight;
+
+    if (MinimumBlockRows == 0) {
+        MinimumBlockRows = 1;
+    }
+
+    //
+    // Split the images into enough blocks so that each parity has a work item
+    // for every thread.
+    //
+
+    size_t BlocksPerImage = 1;
+
+    if (size_t(TargetThreadCount) > BatchGroupCount) {
+        BlocksPerImage = 2 * ((size_t(TargetThreadCount) + BatchGroupCount - 1) / BatchGroupCount);
+    }
+
+    size_t BlockRows = (InputHeight + BlocksPerImage - 1) / BlocksPerImage;
+
+    if (BlockRows < MinimumBlockRows) {
+        BlockRows = MinimumBlockRows;
+    }
+
+    const size_t BlockCount = (InputHeight + BlockRows - 1) / BlockRows;
+
+    if (size_t(TargetThreadCount) > BatchGroupCount * ((BlockCount + 1) / 2)) {
+        TargetThreadCount = int32_t(BatchGroupCount * ((BlockCount + 1) / 2));
+    }
+
+    //
+    // Compute the number of input pixels per tile so that the column buffer
+    // for a tile fits in the target working buffer size.
+    //
+
+    size_t TileColumns = MLAS_CONV_TRANSPOSE_WORKING_BUFFER_SIZE_PER_THREAD / K;
+
+    if (TileColumns < MLAS_CONV_TRANSPOSE_MINIMUM_TILE_COLUMNS) {
+        TileColumns = MLAS_CONV_TRANSPOSE_MINIMUM_TILE_COLUMNS;
+    }
+
+    if (TileColumns > BlockRows * Parameters->InputShape[1]) {
+        TileColumns = BlockRows * Parameters->InputShape[1];
+    }
+
+    Parameters->u.ConvTranspose.BlockRows = BlockRows;
+    Parameters->u.ConvTranspose.BlockCount = BlockCount;
+    Parameters->u.ConvTranspose.TileColumns = TileColumns;
+    Parameters->u.ConvTranspose.ThreadCount = size_t(TargetThreadCount);
+
+    *WorkingBufferSize = size_t(TargetThreadCount) * K * TileColumns;
+}
+
+void
+MLASCALL
+MlasConvTranspose(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the transposed convolution operation.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the transposed
+        convolution parameters.
+
+    Input - Supplies the input tensor.
+
+    Filter - Supplies the filter tensor in IOHW format.
+
+    Bias - Optionally supplies the bias vector.
+
+    WorkingBuffer - Supplies a working buffer sized to the number of elements
+        returned by MlasConvTransposePrepare.
+
+    Output - Supplies the output tensor.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BatchGroupCount = Parameters->BatchCount * Parameters->GroupCount;
+
+    //
+    // The column matrix is accumulated into the output, so clear the output.
+    //
+
+    std::fill_n(Output, BatchGroupCount * Parameters->FilterCount * Parameters->OutputSize, 0.0f);
+
+    MLAS_CONV_TRANSPOSE_WORK_BLOCK WorkBlock;
+
+    WorkBlock.Parameters = Parameters;
+    WorkBlock.Input = Input;
+    WorkBlock.Filter = Filter;
+    WorkBlock.Bias = Bias;
+    WorkBlock.WorkingBuffer = WorkingBuffer;
+    WorkBlock.Output = Output;
+
+    const int32_t ThreadCount = int32_t(Parameters->u.ConvTranspose.ThreadCount);
+
+    //
+    // Execute the even blocks and then the odd blocks.
+    //
+
+    WorkBlock.BlockParity = 0;
+
+    MlasExecuteThreaded(MlasConvTransposeThreaded, &WorkBlock, ThreadCount, ThreadPool);
+
+    if (Parameters->u.ConvTranspose.BlockCount > 1) {
+
+        WorkBlock.BlockParity = 1;
+
+        MlasExecuteThreaded(MlasConvTransposeThreaded, &WorkBlock, ThreadCount, ThreadPool);
+    }
+
+    //
+    // Apply the activation with optional bias.
+    //
+
+    MlasExecuteThreaded(MlasConvTransposeActivationThreaded, &WorkBlock,
+        int32_t(BatchGroupCount), ThreadPool);
+}
@@ -0,0 +1,132 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    cvtfp16.cpp
+
+Abstract:
+
+    This module implements routines to convert between FP16 and FP32 formats.
+
+    The generic kernel below uses the same bit manipulation as the SSE2
+    assembly kernel: the exponent and mantissa are shifted into place and the
+    exponent rebiased, infinities and NaNs receive a second exponent
+    adjustment and denormals are normalized by subtracting a magic constant.
+
+--*/
+
+#include "mlasi.h"
+
+MLAS_FORCEINLINE
+float
+MlasBitsToFloat(
+    uint32_t Bits
+    )
+{
+    float Value;
+    memcpy(&Value, &Bits, sizeof(float));
+    return Value;
+}
+
+MLAS_FORCEINLINE
+uint32_t
+MlasFloatToBits(
+    float Value
+    )
+{
+    uint32_t Bits;
+    memcpy(&Bits, &Value, sizeof(float));
+    return Bits;
+}
+
+void
+MLASCALL
+MlasConvertHalfToFloatKernel(
+    const unsigned short* Source,
+    float* Destination,
+    size_t Count
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the generic kernel to convert a buffer of
+    half-precision floats to single-precision floats.
+
+Arguments:
+
+    Source - Supplies the address of the source buffer of half-precision
+        floats.
+
+    Destination - Supplies the address of the destination buffer of
+        single-precision floats.
+
+    Count - Supplies the number of elements to convert.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const uint32_t AdjustExponent = 0x38000000;
+    const uint32_t MagicDenormal = 0x38800000;
+
+    while (Count > 0) {
+
+        const uint32_t Half = *Source++;
+        const uint32_t Sign = (Half & 0x8000) << 16;
+        const uint32_t ExponentMantissa = Half & 0x7FFF;
+
+        uint32_t Bits;
+
+        if (ExponentMantissa >= 0x7C00) {
+            Bits = (ExponentMantissa << 13) + AdjustExponent + AdjustExponent;
+        } else if (ExponentMantissa < 0x0400) {
+            Bits = MlasFloatToBits(MlasBitsToFloat((ExponentMantissa << 13) + MagicDenormal) -
+                MlasBitsToFloat(MagicDenormal));
+        } else {
+            Bits = (ExponentMantissa << 13) + AdjustExponent;
+        }
+
+        *Destination++ = MlasBitsToFloat(Bits | Sign);
+        Count--;
+    }
+}
+
+void
+MLASCALL
+MlasConvertHalfToFloatBuffer(
+    const unsigned short* Source,
+    float* Destination,
+    size_t Count
+    )
+/*++
+
+Routine Description:
+
+    This routine converts the source buffer of half-precision floats to the
+    destination buffer of single-precision floats.
+
+Arguments:
+
+    Source - Supplies the address of the source buffer of half-precision
+        floats.
+
+    Destination - Supplies the address of the destination buffer of
+        single-precision floats.
+
+    Count - Supplies the number of elements to convert.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasPlatform.ConvertHalfToFloatKernelRoutine(Source, Destination, Count);
+}
@@ -0,0 +1,87 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    cvtfp16_kernel_f16c.cpp
+
+Abstract:
+
+    This module implements the kernel to convert half-precision floats to
+    single-precision floats for processors with the F16C extension.
+
+--*/
+
+#include "mlasi.h"
+
+void
+MLASCALL
+MlasConvertHalfToFloatKernelF16C(
+    const unsigned short* Source,
+    float* Destination,
+    size_t Count
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the F16C kernel to convert a buffer of
+    half-precision floats to single-precision floats.
+
+Arguments:
+
+    Source - Supplies the address of the source buffer of half-precision
+        floats.
+
+    Destination - Supplies the address of the destination buffer of
+        single-precision floats.
+
+    Count - Supplies the number of elements to convert.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    while (Count >= 16) {
+
+        __m128i Half0 = _mm_loadu_si128((const __m128i*)&Source[0]);
+        __m128i Half1 = _mm_loadu_si128((const __m128i*)&Source[8]);
+
+        _mm256_storeu_ps(&Destination[0], _mm256_cvtph_ps(Half0));
+        _mm256_storeu_ps(&Destination[8], _mm256_cvtph_ps(Half1));
+
+        Source += 16;
+        Destination += 16;
+        Count -= 16;
+    }
+
+    if (Count >= 8) {
+
+        _mm256_storeu_ps(Destination, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)Source)));
+
+        Source += 8;
+        Destination += 8;
+        Count -= 8;
+    }
+
+    //
+    // Convert the remaining elements through a zero padded vector.
+    //
+
+    if (Count > 0) {
+
+        MLAS_DECLSPEC_ALIGN(unsigned short HalfBuffer[8], 16) = { 0 };
+        MLAS_DECLSPEC_ALIGN(float FloatBuffer[8], 32);
+
+        memcpy(HalfBuffer, Source, Count * sizeof(unsigned short));
+
+        _mm256_store_ps(FloatBuffer, _mm256_cvtph_ps(_mm_load_si128((const __m128i*)HalfBuffer)));
+
+        memcpy(Destination, FloatBuffer, Count * sizeof(float));
+    }
+}
@@ -0,0 +1,542 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    dwconv.cpp
+
+Abstract:
+
+    This module implements the depthwise convolution operation, where each
+    group has a single input channel and a single filter.
+
+    The general convolution path computes each group as a GEMM with a single
+    row, which does not amortize the cost of the GEMM setup. Instead, each
+    output row is computed directly by vectorizing across the output columns.
+
+    Each input row used by an output row is copied to a working buffer that is
+    split into one phase per stride step. Phase p stores the padded input row
+    elements p, p + stride, p + 2 * stride, and so on, so the input elements
+    for a kernel column are contiguous for consecutive output columns for any
+    stride and the padding is handled by the copy.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the parameters to execute segments of a depthwise convolution on
+// worker threads.
+//
+
+struct MLAS_CONV_DEPTHWISE_WORK_BLOCK {
+    const MLAS_CONV_PARAMETERS* Parameters;
+    const float* Input;
+    const float* Filter;
+    const float* Bias;
+    float* WorkingBuffer;
+    float* Output;
+};
+
+inline
+size_t
+MlasConvDepthwiseGetPhaseWidth(
+    size_t KernelSize,
+    size_t Stride,
+    size_t OutputWidth
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the number of elements in each phase of an input row
+    copied to the working buffer.
+
+Arguments:
+
+    KernelSize - Supplies the width of the kernel.
+
+    Stride - Supplies the stride of the convolution.
+
+    OutputWidth - Supplies the width of the output image.
+
+Return Value:
+
+    Returns the number of elements per phase.
+
+--*/
+{
+    return OutputWidth + (KernelSize - 1) / Stride;
+}
+
+void
+MlasConvDepthwiseCopyInputRow(
+    const float* Input,
+    size_t InputWidth,
+    size_t PaddingLeft,
+    size_t Stride,
+    size_t PhaseWidth,
+    float* PhaseBuffer
+    )
+/*++
+
+Routine Description:
+
+    This routine copies an input row to the working buffer, splitting the row
+    into one phase per stride step and zero filling the padding.
+
+Arguments:
+
+    Input - Supplies the input row, else nullptr if the row is in the padding.
+
+    InputWidth - Supplies the width of the input row.
+
+    PaddingLeft - Supplies the number of padding elements before the input row.
+
+    Stride - Supplies the stride of the convolution.
+
+    PhaseWidth - Supplies the number of elements in each phase.
+
+    PhaseBuffer - Supplies the buffer to receive the phases.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (Input == nullptr) {
+        std::fill_n(PhaseBuffer, Stride * PhaseWidth, 0.0f);
+        return;
+    }
+
+    if (Stride == 1) {
+
+        //
+        // The single phase is the padded input row.
+        //
+
+        const size_t PaddingRight = PhaseWidth - (std::min)(PhaseWidth, PaddingLeft + InputWidth);
+        const size_t CopyCount = PhaseWidth - (std::min)(PhaseWidth, PaddingLeft) - PaddingRight;
+
+        std::fill_n(PhaseBuffer, PhaseWidth - CopyCount - PaddingRight, 0.0f);
+        std::copy_n(Input, CopyCount, PhaseBuffer + PhaseWidth - CopyCount - PaddingRight);
+        std::fill_n(PhaseBuffer + PhaseWidth - PaddingRight, PaddingRight, 0.0f);
+
+        return;
+    }
+
+    for (size_t phase = 0; phase < Stride; phase++) {
+
+        //
+        // The unsigned arithmetic wraps the columns in the leading padding to
+        // large values, so a single comparison detects elements outside of
+        // the input row.
+        //
+
+        size_t iw = phase - PaddingLeft;
+
+        for (size_t j = 0; j < PhaseWidth; j++) {
+            *PhaseBuffer++ = (iw < InputWidth) ? Input[iw] : 0.0f;
+            iw += Stride;
+        }
+    }
+}
+
+template<size_t KernelSize>
+void
+MlasConvDepthwiseRows(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    float* PhaseBuffer,
+    float* Output,
+    size_t OutputRowStart,
+    size_t OutputRowCount
+    )
+/*++
+
+Routine Description:
+
+    This routine computes a range of output rows of one channel of a depthwise
+    convolution.
+
+    The input rows used by the output rows are first copied to the working
+    buffer, so that every kernel row and column reads from a zero padded
+    buffer and the accumulators for a vector of output columns stay in
+    registers for the whole kernel.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input image of the channel.
+
+    Filter - Supplies the kernel of the channel.
+
+    PhaseBuffer - Supplies the working buffer for the phases of the input
+        rows.
+
+    Output - Supplies the output image of the channel.
+
+    OutputRowStart - Supplies the index of the first output row to compute.
+
+    OutputRowCount - Supplies the number of output rows to compute.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t InputHeight = Parameters->InputShape[0];
+    const size_t InputWidth = Parameters->InputShape[1];
+    const size_t PaddingLeftY = Parameters->Padding[0];
+    const size_t PaddingLeftX = Parameters->Padding[1];
+    const size_t Stride = Parameters->StrideShape[0];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+
+    const size_t PhaseWidth = MlasConvDepthwiseGetPhaseWidth(KernelSize, Stride, OutputWidth);
+    const size_t PhaseRowSize = Stride * PhaseWidth;
+
+    //
+    // Copy the padded input rows used by this range of output rows. The
+    // unsigned arithmetic wraps the rows above the image to large values.
+    //
+
+    const size_t RowCount = (OutputRowCount - 1) * Stride + KernelSize;
+
+    for (size_t r = 0; r < RowCount; r++) {
+
+        const size_t ih = OutputRowStart * Stride + r - PaddingLeftY;
+
+        MlasConvDepthwiseCopyInputRow((ih < InputHeight) ? Input + ih * InputWidth : nullptr,
+            InputWidth, PaddingLeftX, Stride, PhaseWidth, PhaseBuffer + r * PhaseRowSize);
+    }
+
+    MLAS_FLOAT32X4 FilterVector[KernelSize * KernelSize];
+
+    for (size_t k = 0; k < KernelSize * KernelSize; k++) {
+        FilterVector[k] = MlasBroadcastFloat32x4(Filter[k]);
+    }
+
+    //
+    // Compute the offset of the input elements for each kernel column. The
+    // input element for output column ow and kernel column kw is stored in
+    // phase (kw % Stride) at index (ow + kw / Stride).
+    //
+
+    size_t ColumnOffset[KernelSize];
+
+    for (size_t kw = 0; kw < KernelSize; kw++) {
+        ColumnOffset[kw] = (kw % Stride) * PhaseWidth + kw / Stride;
+    }
+
+    float* output = Output + OutputRowStart * OutputWidth;
+
+    for (size_t oh = 0; oh < OutputRowCount; oh++) {
+
+        const float* input = PhaseBuffer + oh * Stride * PhaseRowSize;
+
+        size_t ow = 0;
+
+        for (; ow + 4 <= OutputWidth; ow += 4) {
+
+            MLAS_FLOAT32X4 Accumulator = MlasZeroFloat32x4();
+
+            for (size_t kh = 0; kh < KernelSize; kh++) {
+
+                const float* row = input + kh * PhaseRowSize + ow;
+
+                for (size_t kw = 0; kw < KernelSize; kw++) {
+                    Accumulator = MlasMultiplyAddFloat32x4(FilterVector[kh * KernelSize + kw],
+                        MlasLoadFloat32x4(row + ColumnOffset[kw]), Accumulator);
+                }
+            }
+
+            MlasStoreFloat32x4(output + ow, Accumulator);
+        }
+
+        for (; ow < OutputWidth; ow++) {
+
+            float Accumulator = 0.0f;
+
+            for (size_t kh = 0; kh < KernelSize; kh++) {
+
+                const float* row = input + kh * PhaseRowSize + ow;
+
+                for (size_t kw = 0; kw < KernelSize; kw++) {
+                    Accumulator += Filter[kh * KernelSize + kw] * row[ColumnOffset[kw]];
+                }
+            }
+
+            output[ow] = Accumulator;
+        }
+
+        output += OutputWidth;
+    }
+}
+
+void
+MlasConvDepthwiseThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    depthwise convolution operation.
+
+    The output rows of all channels of all batches are partitioned evenly
+    across the threads.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_CONV_DEPTHWISE_WORK_BLOCK* WorkBlock = (MLAS_CONV_DEPTHWISE_WORK_BLOCK*)Context;
+
+    const MLAS_CONV_PARAMETERS* Parameters = WorkBlock->Parameters;
+
+    const size_t GroupCount = Parameters->GroupCount;
+    const size_t InputSize = Parameters->InputSize;
+    const size_t OutputHeight = Parameters->OutputShape[0];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+    const size_t OutputSize = Parameters->OutputSize;
+    const size_t KernelSize = Parameters->KernelShape[0];
+
+    //
+    // Compute the range of output rows to use for this thread.
+    //
+
+    const size_t TotalRowCount = Parameters->BatchCount * GroupCount * OutputHeight;
+    const size_t ThreadCount = Parameters->u.Depthwise.ThreadCount;
+
+    const size_t RowCountPerThread = TotalRowCount / ThreadCount;
+    const size_t RowCountExtra = TotalRowCount % ThreadCount;
+
+    size_t RowStart;
+    size_t RowEnd;
+
+    if (uint32_t(Index) < RowCountExtra) {
+        RowStart = (RowCountPerThread + 1) * Index;
+        RowEnd = RowStart + RowCountPerThread + 1;
+    } else {
+        RowStart = RowCountPerThread * Index + RowCountExtra;
+        RowEnd = RowStart + RowCountPerThread;
+    }
+
+    float* PhaseBuffer = WorkBlock->WorkingBuffer + Index * Parameters->u.Depthwise.ThreadBufferSize;
+
+    //
+    // Iterate over the channels that intersect the range of output rows.
+    //
+
+    while (RowStart < RowEnd) {
+
+        const size_t bg = RowStart / OutputHeight;
+        const size_t group = bg % GroupCount;
+
+        const size_t OutputRowStart = RowStart % OutputHeight;
+        const size_t OutputRowCount = (std::min)(OutputHeight - OutputRowStart, RowEnd - RowStart);
+
+        const float* input = WorkBlock->Input + bg * InputSize;
+        const float* filter = WorkBlock->Filter + group * KernelSize * KernelSize;
+        float* output = WorkBlock->Output + bg * OutputSize;
+
+        if (KernelSize == 3) {
+            MlasConvDepthwiseRows<3>(Parameters, input, filter, PhaseBuffer, output,
+                OutputRowStart, OutputRowCount);
+        } else {
+            MlasConvDepthwiseRows<5>(Parameters, input, filter, PhaseBuffer, output,
+                OutputRowStart, OutputRowCount);
+        }
+
+        //
+        // Apply the activation with optional bias.
+        //
+
+        const float* bias = WorkBlock->Bias;
+
+        if (bias != nullptr) {
+            bias += group;
+        }
+
+        float* OutputRows = output + OutputRowStart * OutputWidth;
+
+        MlasActivation(Parameters->Activation, OutputRows, bias, 1, OutputRows,
+            OutputRowCount * OutputWidth, OutputRowCount * OutputWidth);
+
+        RowStart += OutputRowCount;
+    }
+}
+
+bool
+MlasConvDepthwisePrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine determines whether the depthwise algorithm can be used for a
+    convolution and if so, computes the parameters for the algorithm.
+
+    The depthwise algorithm supports two dimensional convolutions with a
+    single input channel and filter per group, a 3x3 or 5x5 kernel, unit
+    dilations and the same stride of one or two in both dimensions.
+
+Arguments:
+
+    Parameters - Supplies the structure that stores the provided and computed
+        parameters for the convolution operation.
+
+    WorkingBufferSize - Receives the number of elements to allocate for the
+        working buffer for intermediate results.
+
+    ThreadPool - Supplies the thread pool object that will be used to execute
+        the convolution, else nullptr if the platform threading implementation
+        will be used.
+
+Return Value:
+
+    Returns true if the depthwise algorithm was selected, else false.
+
+--*/
+{
+    if (Parameters->Dimensions != 2 || Parameters->InputChannels != 1 ||
+        Parameters->FilterCount != 1) {
+        return false;
+    }
+
+    const size_t KernelSize = Parameters->KernelShape[0];
+    const size_t Stride = Parameters->StrideShape[0];
+
+    if ((KernelSize != 3 && KernelSize != 5) || Parameters->KernelShape[1] != KernelSize) {
+        return false;
+    }
+
+    if ((Stride != 1 && Stride != 2) || Parameters->StrideShape[1] != Stride) {
+        return false;
+    }
+
+    if (Parameters->DilationShape[0] != 1 || Parameters->DilationShape[1] != 1) {
+        return false;
+    }
+
+    //
+    // Compute the number of target threads given the complexity of the
+    // convolution operation. Small requests should run using the single
+    // threaded path.
+    //
+
+    const size_t TotalRowCount = Parameters->BatchCount * Parameters->GroupCount *
+        Parameters->OutputShape[0];
+
+    double Complexity = double(TotalRowCount) * double(Parameters->OutputShape[1]) *
+        double(KernelSize * KernelSize);
+
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (size_t(TargetThreadCount) >= TotalRowCount) {
+        TargetThreadCount = int32_t(TotalRowCount);
+    }
+
+    //
+    // Each thread copies the input rows for at most every output row of a
+    // channel to its working buffer.
+    //
+
+    const size_t ThreadBufferSize = ((Parameters->OutputShape[0] - 1) * Stride + KernelSize) *
+        Stride * MlasConvDepthwiseGetPhaseWidth(KernelSize, Stride, Parameters->OutputShape[1]);
+
+    Parameters->Algorithm = MlasConvAlgorithmDepthwise;
+    Parameters->u.Depthwise.ThreadCount = size_t(TargetThreadCount);
+    Parameters->u.Depthwise.ThreadBufferSize = ThreadBufferSize;
+
+    *WorkingBufferSize = size_t(TargetThreadCount) * ThreadBufferSize;
+
+    return true;
+}
+
+void
+MlasConvDepthwise(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the depthwise convolution operation.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input tensor.
+
+    Filter - Supplies the filter tensor.
+
+    Bias - Optionally supplies the bias vector.
+
+    WorkingBuffer - Supplies a working buffer sized to the number of elements
+        returned by MlasConvPrepare.
+
+    Output - Supplies the output tensor.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_CONV_DEPTHWISE_WORK_BLOCK WorkBlock;
+
+    WorkBlock.Parameters = Parameters;
+    WorkBlock.Input = Input;
+    WorkBlock.Filter = Filter;
+    WorkBlock.Bias = Bias;
+    WorkBlock.WorkingBuffer = WorkingBuffer;
+    WorkBlock.Output = Output;
+
+    MlasExecuteThreaded(MlasConvDepthwiseThreaded, &WorkBlock,
+        int32_t(Parameters->u.Depthwise.ThreadCount), ThreadPool);
+}
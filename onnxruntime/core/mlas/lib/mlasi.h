@@ -22,6 +22,7 @@ Abstract:
 #include <memory.h>
 #include <algorithm>
 #include <limits>
+#include <cmath>
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -49,6 +50,16 @@ Abstract:
 #define MLAS_DECLSPEC_ALIGN(variable, alignment) variable __attribute__ ((aligned(alignment)))
 #endif
 
+//
+// Macro to force inline expansion of a function.
+//
+
+#if defined(_MSC_VER)
+#define MLAS_FORCEINLINE __forceinline
+#else
+#define MLAS_FORCEINLINE __attribute__ ((always_inline)) inline
+#endif
+
 //
 // Macro to suppress unreferenced parameter warnings.
 //
@@ -82,10 +93,8 @@ Abstract:
 #if defined(_OPENMP)
 #include <omp.h>
 #define MLAS_USE_OPENMP
-#define MLAS_HAS_THREADING_SUPPORT
 #elif defined(_WIN32)
 #define MLAS_USE_WIN32_THREADPOOL
-#define MLAS_HAS_THREADING_SUPPORT
 #endif
 
 //
@@ -101,6 +110,16 @@ Abstract:
 #define MLAS_SGEMM_STRIDEN                          128
 #define MLAS_SGEMM_STRIDEK                          128
 
+//
+// Define the stride to step through slices of a matrix B that has been packed
+// ahead of time by MlasSgemmPackB.
+//
+// The packed buffer is not staged through the processor cache by a local copy,
+// so a larger K stride reduces the number of passes over matrix C.
+//
+
+#define MLAS_SGEMM_PACKED_STRIDEK                   256
+
 //
 // Define the alignment for segmenting a SGEMM operation across multiple
 // threads.
@@ -112,6 +131,35 @@ Abstract:
 
 #define MLAS_SGEMM_STRIDEN_THREAD_ALIGN             16
 
+//
+// Define the default strides to step through slices of the input matrices for
+// the quantized integer matrix/matrix multiply operation (QGEMM).
+//
+// N.B. The count of K values must be a multiple of MLAS_QGEMM_PACKED_K_ALIGN
+// so that every kernel can consume the packed buffers in whole groups.
+//
+
+#define MLAS_QGEMM_STRIDEM                          64
+#define MLAS_QGEMM_STRIDEN                          128
+#define MLAS_QGEMM_STRIDEK                          256
+#define MLAS_QGEMM_PACKED_K_ALIGN                   4
+
+//
+// Define the number of columns of matrix B that are packed together. All of
+// the QGEMM kernels consume 16 columns per iteration.
+//
+
+#define MLAS_QGEMM_STRIDEN_THREAD_ALIGN             16
+
+//
+// Define the maximum number of channels in a block of a channel blocked
+// (NCHWc) tensor and the number of filter blocks that a NCHWc convolution
+// kernel computes together.
+//
+
+#define MLAS_NCHWC_MAXIMUM_BLOCK_SIZE               16
+#define MLAS_NCHWC_FILTER_SET_SIZE                  4
+
 //
 // Define the prototypes of the platform optimized routines.
 //
@@ -176,6 +224,134 @@ void
 
 typedef MLAS_TANH_KERNEL_ROUTINE* PMLAS_TANH_KERNEL_ROUTINE;
 
+typedef
+void
+(MLASCALL MLAS_COMPUTE_UNARY_KERNEL_ROUTINE)(
+    const float* Input,
+    float* Output,
+    size_t N
+    );
+
+typedef MLAS_COMPUTE_UNARY_KERNEL_ROUTINE* PMLAS_COMPUTE_UNARY_KERNEL_ROUTINE;
+
+typedef
+void
+(MLASCALL MLAS_CONVERT_HALF_TO_FLOAT_KERNEL_ROUTINE)(
+    const unsigned short* Source,
+    float* Destination,
+    size_t Count
+    );
+
+typedef MLAS_CONVERT_HALF_TO_FLOAT_KERNEL_ROUTINE* PMLAS_CONVERT_HALF_TO_FLOAT_KERNEL_ROUTINE;
+
+typedef
+float
+(MLASCALL MLAS_REDUCE_MAXIMUM_KERNEL_ROUTINE)(
+    const float* Input,
+    size_t N
+    );
+
+typedef MLAS_REDUCE_MAXIMUM_KERNEL_ROUTINE* PMLAS_REDUCE_MAXIMUM_KERNEL_ROUTINE;
+
+typedef
+float
+(MLASCALL MLAS_COMPUTE_SUMEXP_KERNEL_ROUTINE)(
+    const float* Input,
+    float* Output,
+    size_t N,
+    float NegativeMaximum
+    );
+
+typedef MLAS_COMPUTE_SUMEXP_KERNEL_ROUTINE* PMLAS_COMPUTE_SUMEXP_KERNEL_ROUTINE;
+
+typedef
+void
+(MLASCALL MLAS_QGEMM_COPY_PACKB_ROUTINE)(
+    uint8_t* D,
+    const uint8_t* B,
+    size_t ldb,
+    size_t CountN,
+    size_t CountK,
+    int32_t* ColumnSumVector
+    );
+
+typedef MLAS_QGEMM_COPY_PACKB_ROUTINE* PMLAS_QGEMM_COPY_PACKB_ROUTINE;
+
+typedef
+size_t
+(MLASCALL MLAS_QGEMM_KERNEL_ROUTINE)(
+    const uint8_t* A,
+    const uint8_t* B,
+    int32_t* C,
+    size_t PackedCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    const int32_t* RowSumVector,
+    const int32_t* ColumnSumVector,
+    bool ZeroMode
+    );
+
+typedef MLAS_QGEMM_KERNEL_ROUTINE* PMLAS_QGEMM_KERNEL_ROUTINE;
+
+//
+// Define the parameters of a NCHWc convolution operation. The spatial shapes
+// are two dimensional.
+//
+
+struct MLAS_NCHWC_CONV_WORK_BLOCK {
+    const float* Input;
+    const float* Filter;
+    const float* Bias;
+    float* Output;
+    const MLAS_ACTIVATION* Activation;
+    size_t BatchCount;
+    size_t InputChannels;
+    size_t InputShape[2];
+    size_t InputSize;
+    size_t FilterCount;
+    size_t KernelShape[2];
+    size_t DilationShape[2];
+    size_t Padding[4];
+    size_t StrideShape[2];
+    size_t OutputShape[2];
+    size_t OutputSize;
+    bool InputIsNchw;
+    int32_t TargetThreadCount;
+};
+
+typedef
+void
+(MLASCALL MLAS_CONV_NCHWC_KERNEL_ROUTINE)(
+    const MLAS_NCHWC_CONV_WORK_BLOCK* WorkBlock,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    size_t FilterCount,
+    size_t OutputRow
+    );
+
+typedef MLAS_CONV_NCHWC_KERNEL_ROUTINE* PMLAS_CONV_NCHWC_KERNEL_ROUTINE;
+
+//
+// Describes a QGEMM kernel and the format of the packed matrix B that the
+// kernel consumes.
+//
+// The packing routine stores each element of matrix B as (B - PackedBOffset)
+// and the kernel treats the packed elements as unsigned or signed bytes as
+// appropriate for the instruction set. PackedK is the number of consecutive K
+// values of a column that the kernel consumes as a group.
+//
+
+struct MLAS_QGEMM_KERNEL {
+    PMLAS_QGEMM_COPY_PACKB_ROUTINE CopyPackBRoutine;
+    PMLAS_QGEMM_KERNEL_ROUTINE KernelRoutine;
+    size_t PackedK;
+    int32_t PackedBOffset;
+};
+
 extern "C" {
 
     MLAS_SGEMM_KERNEL_ROUTINE MlasSgemmKernelZero;
@@ -210,8 +386,52 @@ extern "C" {
     MLAS_TANH_KERNEL_ROUTINE MlasTanhKernelFma3;
 #endif
 
+#if defined(MLAS_TARGET_AMD64) && defined(_WIN32)
+    MLAS_CONVERT_HALF_TO_FLOAT_KERNEL_ROUTINE MlasConvertHalfToFloatKernelSse2;
+#endif
+
 }
 
+extern const MLAS_QGEMM_KERNEL MlasQgemmU8U8KernelDefault;
+extern const MLAS_QGEMM_KERNEL MlasQgemmU8S8KernelDefault;
+#if defined(MLAS_TARGET_AMD64)
+extern const MLAS_QGEMM_KERNEL MlasQgemmU8U8KernelAvx2;
+extern const MLAS_QGEMM_KERNEL MlasQgemmU8S8KernelAvx2;
+#if defined(MLAS_AVX512VNNI_SUPPORTED)
+extern const MLAS_QGEMM_KERNEL MlasQgemmU8U8KernelAvx512Vnni;
+extern const MLAS_QGEMM_KERNEL MlasQgemmU8S8KernelAvx512Vnni;
+#endif
+#endif
+
+MLAS_CONV_NCHWC_KERNEL_ROUTINE MlasConvNchwcKernel;
+#if defined(MLAS_TARGET_AMD64)
+MLAS_CONV_NCHWC_KERNEL_ROUTINE MlasConvNchwcKernelAvx2;
+MLAS_CONV_NCHWC_KERNEL_ROUTINE MlasConvNchwcKernelAvx512F;
+#endif
+
+MLAS_COMPUTE_UNARY_KERNEL_ROUTINE MlasExpKernel;
+MLAS_COMPUTE_UNARY_KERNEL_ROUTINE MlasLogKernel;
+MLAS_COMPUTE_UNARY_KERNEL_ROUTINE MlasErfKernel;
+MLAS_REDUCE_MAXIMUM_KERNEL_ROUTINE MlasReduceMaximumKernel;
+MLAS_COMPUTE_SUMEXP_KERNEL_ROUTINE MlasComputeSumExpKernel;
+#if defined(MLAS_TARGET_AMD64)
+MLAS_COMPUTE_UNARY_KERNEL_ROUTINE MlasExpKernelAvx2;
+MLAS_COMPUTE_UNARY_KERNEL_ROUTINE MlasLogKernelAvx2;
+MLAS_COMPUTE_UNARY_KERNEL_ROUTINE MlasErfKernelAvx2;
+MLAS_REDUCE_MAXIMUM_KERNEL_ROUTINE MlasReduceMaximumKernelAvx2;
+MLAS_COMPUTE_SUMEXP_KERNEL_ROUTINE MlasComputeSumExpKernelAvx2;
+MLAS_COMPUTE_UNARY_KERNEL_ROUTINE MlasExpKernelAvx512F;
+MLAS_COMPUTE_UNARY_KERNEL_ROUTINE MlasLogKernelAvx512F;
+MLAS_COMPUTE_UNARY_KERNEL_ROUTINE MlasErfKernelAvx512F;
+MLAS_REDUCE_MAXIMUM_KERNEL_ROUTINE MlasReduceMaximumKernelAvx512F;
+MLAS_COMPUTE_SUMEXP_KERNEL_ROUTINE MlasComputeSumExpKernelAvx512F;
+#endif
+
+MLAS_CONVERT_HALF_TO_FLOAT_KERNEL_ROUTINE MlasConvertHalfToFloatKernel;
+#if defined(MLAS_TARGET_AMD64)
+MLAS_CONVERT_HALF_TO_FLOAT_KERNEL_ROUTINE MlasConvertHalfToFloatKernelF16C;
+#endif
+
 //
 // Define the target number of per-thread multiplies before using another
 // thread to perform additional work.
@@ -231,6 +451,8 @@ extern "C" {
 #endif
 #endif
 
+#define MLAS_QGEMM_THREAD_COMPLEXITY                (MLAS_SGEMM_THREAD_COMPLEXITY * 2)
+
 //
 // Single-threaded single precision matrix/matrix multiply operation.
 //
@@ -252,14 +474,82 @@ MlasSgemmOperation(
     size_t ldc
     );
 
+//
+// Winograd convolution routines.
+//
+
+bool
+MlasConvWinogradPrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    const float* TransformedFilter,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+void
+MlasConvWinograd(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+//
+// Depthwise convolution routines.
+//
+
+bool
+MlasConvDepthwisePrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+void
+MlasConvDepthwise(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 //
 // Environment information class.
 //
 
+//
+// Define the maximum number of entries in the kernel selection report.
+//
+
+#define MLAS_MAXIMUM_KERNEL_SELECTION_COUNT     16
+
 struct MLAS_PLATFORM {
 
     MLAS_PLATFORM(void);
 
+    void
+    SelectKernels(
+        MLAS_ISA_LEVEL MaximumIsaLevel
+        );
+
+    void
+    AddKernelSelection(
+        const char* EntryPoint,
+        const char* Variant
+        );
+
+    MLAS_ISA_LEVEL SupportedIsaLevel;
+    MLAS_ISA_LEVEL IsaLevel;
+
+    MLAS_KERNEL_SELECTION KernelSelection[MLAS_MAXIMUM_KERNEL_SELECTION_COUNT];
+    size_t KernelSelectionCount;
+
 #if defined(MLAS_TARGET_AMD64_IX86)
     PMLAS_SGEMM_KERNEL_ROUTINE KernelZeroRoutine;
     PMLAS_SGEMM_KERNEL_ROUTINE KernelAddRoutine;
@@ -273,6 +563,20 @@ struct MLAS_PLATFORM {
     PMLAS_TANH_KERNEL_ROUTINE TanhKernelRoutine;
 #endif
 
+    const MLAS_QGEMM_KERNEL* QgemmU8U8Kernel;
+    const MLAS_QGEMM_KERNEL* QgemmU8S8Kernel;
+
+    PMLAS_CONV_NCHWC_KERNEL_ROUTINE ConvNchwcKernelRoutine;
+    size_t NchwcBlockSize;
+
+    PMLAS_COMPUTE_UNARY_KERNEL_ROUTINE ExpKernelRoutine;
+    PMLAS_COMPUTE_UNARY_KERNEL_ROUTINE LogKernelRoutine;
+    PMLAS_COMPUTE_UNARY_KERNEL_ROUTINE ErfKernelRoutine;
+    PMLAS_REDUCE_MAXIMUM_KERNEL_ROUTINE ReduceMaximumKernelRoutine;
+    PMLAS_COMPUTE_SUMEXP_KERNEL_ROUTINE ComputeSumExpKernelRoutine;
+
+    PMLAS_CONVERT_HALF_TO_FLOAT_KERNEL_ROUTINE ConvertHalfToFloatKernelRoutine;
+
 #if defined(MLAS_USE_WIN32_THREADPOOL)
     int32_t MaximumThreadCount;
 #endif
@@ -311,7 +615,13 @@ void
 MlasExecuteThreaded(
     PMLAS_THREADED_ROUTINE ThreadedRoutine,
     void* Context,
-    int32_t Iterations
+    int32_t Iterations,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+int32_t
+MlasGetMaximumThreadCount(
+    MLAS_THREADPOOL* ThreadPool
     );
 
 //
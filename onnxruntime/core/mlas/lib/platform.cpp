@@ -16,6 +16,7 @@ Abstract:
 --*/
 
 #include "mlasi.h"
+#include <string.h>
 
 //
 // Stores the platform information.
@@ -23,6 +24,19 @@ Abstract:
 
 MLAS_PLATFORM MlasPlatform;
 
+//
+// Stores the names of the instruction set levels, as accepted by the
+// MLAS_ISA_LEVEL environment variable.
+//
+
+static const char* const MlasIsaLevelNames[] = {
+    "generic",
+    "avx",
+    "avx2",
+    "avx512f",
+    "avx512vnni",
+};
+
 MLAS_PLATFORM::MLAS_PLATFORM(
     void
     )
@@ -42,21 +56,10 @@ Return Value:
 
 --*/
 {
+    this->SupportedIsaLevel = MlasIsaLevelGeneric;
 
 #if defined(MLAS_TARGET_AMD64_IX86)
 
-    //
-    // Default to the baseline SSE2 support.
-    //
-
-    this->KernelZeroRoutine = MlasSgemmKernelZeroSse;
-    this->KernelAddRoutine = MlasSgemmKernelAddSse;
-#if defined(MLAS_TARGET_AMD64)
-    this->TransposePackB16x4Routine = MlasSgemmTransposePackB16x4Sse;
-    this->LogisticKernelRoutine = MlasLogisticKernel;
-    this->TanhKernelRoutine = MlasTanhKernel;
-#endif
-
     //
     // Check if the processor supports the AVX and OSXSAVE features.
     //
@@ -82,16 +85,12 @@ Return Value:
 
         if ((xcr0 & 0x6) == 0x6) {
 
-#if defined(MLAS_TARGET_IX86)
-
-            this->KernelZeroRoutine = MlasSgemmKernelZeroAvx;
-            this->KernelAddRoutine = MlasSgemmKernelAddAvx;
+            this->SupportedIsaLevel = MlasIsaLevelAvx;
 
-#else
+#if defined(MLAS_TARGET_AMD64)
 
             //
-            // Check if the processor supports AVX512F (and the operating
-            // system supports saving AVX512F state) or AVX2/FMA3 features.
+            // Check if the processor supports the AVX2/FMA3 features.
             //
 
             unsigned Cpuid7[4];
@@ -103,26 +102,31 @@ Return Value:
 
             if (((Cpuid1[2] & 0x1000) != 0) && ((Cpuid7[1] & 0x20) != 0)) {
 
+                this->SupportedIsaLevel = MlasIsaLevelAvx2;
+
+                //
+                // Check if the processor supports AVX512F and the operating
+                // system supports saving AVX512F state.
+                //
+
                 if (((Cpuid7[1] & 0x10000) != 0) && ((xcr0 & 0xE0) == 0xE0)) {
-                    this->KernelZeroRoutine = MlasSgemmKernelZeroAvx512F;
-                    this->KernelAddRoutine = MlasSgemmKernelAddAvx512F;
-                } else {
-                    this->KernelZeroRoutine = MlasSgemmKernelZeroFma3;
-                    this->KernelAddRoutine = MlasSgemmKernelAddFma3;
-                }
 
-                this->LogisticKernelRoutine = MlasLogisticKernelFma3;
-                this->TanhKernelRoutine = MlasTanhKernelFma3;
+                    this->SupportedIsaLevel = MlasIsaLevelAvx512F;
 
-            } else {
+#if defined(MLAS_AVX512VNNI_SUPPORTED)
 
-                this->KernelZeroRoutine = MlasSgemmKernelZeroAvx;
-                this->KernelAddRoutine = MlasSgemmKernelAddAvx;
-            }
+                    //
+                    // Check if the processor also supports the AVX512BW,
+                    // AVX512VL and AVX512_VNNI features.
+                    //
 
-            this->KernelM1Routine = MlasSgemmKernelM1Avx;
-            this->KernelM1TransposeBRoutine = MlasSgemmKernelM1TransposeBAvx;
-            this->TransposePackB16x4Routine = MlasSgemmTransposePackB16x4Avx;
+                    if (((Cpuid7[1] & 0xC0000000) == 0xC0000000) && ((Cpuid7[2] & 0x800) != 0)) {
+                        this->SupportedIsaLevel = MlasIsaLevelAvx512Vnni;
+                    }
+
+#endif
+                }
+            }
 
 #endif
 
@@ -131,6 +135,32 @@ Return Value:
 
 #endif
 
+    //
+    // Allow the instruction set level to be capped from the environment so
+    // that the kernel variants can be compared on a single machine. Unknown
+    // names are ignored.
+    //
+
+    MLAS_ISA_LEVEL MaximumIsaLevel = this->SupportedIsaLevel;
+
+#if defined(_WIN32)
+    char IsaLevelOverride[32];
+    DWORD IsaLevelOverrideLength =
+        GetEnvironmentVariableA("MLAS_ISA_LEVEL", IsaLevelOverride, sizeof(IsaLevelOverride));
+    if (IsaLevelOverrideLength > 0 && IsaLevelOverrideLength < sizeof(IsaLevelOverride)) {
+#else
+    const char* IsaLevelOverride = getenv("MLAS_ISA_LEVEL");
+    if (IsaLevelOverride != nullptr) {
+#endif
+        for (size_t i = 0; i < sizeof(MlasIsaLevelNames) / sizeof(MlasIsaLevelNames[0]); i++) {
+            if (strcmp(IsaLevelOverride, MlasIsaLevelNames[i]) == 0) {
+                MaximumIsaLevel = MLAS_ISA_LEVEL(i);
+            }
+        }
+    }
+
+    SelectKernels(MaximumIsaLevel);
+
 #if defined(MLAS_USE_WIN32_THREADPOOL)
 
     //
@@ -150,3 +180,359 @@ Return Value:
 #endif
 
 }
+
+void
+MLAS_PLATFORM::SelectKernels(
+    MLAS_ISA_LEVEL MaximumIsaLevel
+    )
+/*++
+
+Routine Description:
+
+    This routine selects the kernel routines for the highest instruction set
+    level that is supported by the processor and does not exceed the supplied
+    maximum level.
+
+Arguments:
+
+    MaximumIsaLevel - Supplies the maximum instruction set level to use.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_ISA_LEVEL Level = std::min(MaximumIsaLevel, this->SupportedIsaLevel);
+
+    this->IsaLevel = Level;
+
+    const char* SgemmVariant = "Default";
+    const char* SgemmM1Variant = "Default";
+    const char* SgemmTransposePackBVariant = "Default";
+    const char* QgemmVariant = "Default";
+    const char* ConvNchwcVariant = "Default";
+    const char* LogisticTanhVariant = "Default";
+    const char* ComputeVariant = "Default";
+    const char* ConvertHalfToFloatVariant = "Default";
+
+    //
+    // Default to the portable QGEMM kernels.
+    //
+
+    this->QgemmU8U8Kernel = &MlasQgemmU8U8KernelDefault;
+    this->QgemmU8S8Kernel = &MlasQgemmU8S8KernelDefault;
+
+    //
+    // Default to the portable NCHWc convolution kernel, which uses the 128-bit
+    // vector intrinsics for two vectors per channel block.
+    //
+
+    this->ConvNchwcKernelRoutine = MlasConvNchwcKernel;
+    this->NchwcBlockSize = 8;
+
+    //
+    // Default to the portable elementwise transcendental and softmax kernels.
+    //
+
+    this->ExpKernelRoutine = MlasExpKernel;
+    this->LogKernelRoutine = MlasLogKernel;
+    this->ErfKernelRoutine = MlasErfKernel;
+    this->ReduceMaximumKernelRoutine = MlasReduceMaximumKernel;
+    this->ComputeSumExpKernelRoutine = MlasComputeSumExpKernel;
+
+    //
+    // Default to the portable half to single precision conversion kernel.
+    //
+
+    this->ConvertHalfToFloatKernelRoutine = MlasConvertHalfToFloatKernel;
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+
+    //
+    // Default to the baseline SSE2 support.
+    //
+
+    this->KernelZeroRoutine = MlasSgemmKernelZeroSse;
+    this->KernelAddRoutine = MlasSgemmKernelAddSse;
+    SgemmVariant = "Sse";
+#if defined(MLAS_TARGET_AMD64)
+    this->KernelM1Routine = nullptr;
+    this->KernelM1TransposeBRoutine = nullptr;
+    this->TransposePackB16x4Routine = MlasSgemmTransposePackB16x4Sse;
+    SgemmTransposePackBVariant = "Sse";
+    this->LogisticKernelRoutine = MlasLogisticKernel;
+    this->TanhKernelRoutine = MlasTanhKernel;
+#endif
+#if defined(MLAS_TARGET_AMD64) && defined(_WIN32)
+    this->ConvertHalfToFloatKernelRoutine = MlasConvertHalfToFloatKernelSse2;
+    ConvertHalfToFloatVariant = "Sse2";
+#endif
+
+    if (Level >= MlasIsaLevelAvx) {
+
+        this->KernelZeroRoutine = MlasSgemmKernelZeroAvx;
+        this->KernelAddRoutine = MlasSgemmKernelAddAvx;
+        SgemmVariant = "Avx";
+
+#if defined(MLAS_TARGET_AMD64)
+        this->KernelM1Routine = MlasSgemmKernelM1Avx;
+        this->KernelM1TransposeBRoutine = MlasSgemmKernelM1TransposeBAvx;
+        SgemmM1Variant = "Avx";
+        this->TransposePackB16x4Routine = MlasSgemmTransposePackB16x4Avx;
+        SgemmTransposePackBVariant = "Avx";
+#endif
+    }
+
+#if defined(MLAS_TARGET_AMD64)
+
+    if (Level >= MlasIsaLevelAvx2) {
+
+        this->KernelZeroRoutine = MlasSgemmKernelZeroFma3;
+        this->KernelAddRoutine = MlasSgemmKernelAddFma3;
+        SgemmVariant = "Fma3";
+
+        this->LogisticKernelRoutine = MlasLogisticKernelFma3;
+        this->TanhKernelRoutine = MlasTanhKernelFma3;
+        LogisticTanhVariant = "Fma3";
+
+        this->QgemmU8U8Kernel = &MlasQgemmU8U8KernelAvx2;
+        this->QgemmU8S8Kernel = &MlasQgemmU8S8KernelAvx2;
+        QgemmVariant = "Avx2";
+
+        this->ConvNchwcKernelRoutine = MlasConvNchwcKernelAvx2;
+        ConvNchwcVariant = "Avx2";
+
+        this->ExpKernelRoutine = MlasExpKernelAvx2;
+        this->LogKernelRoutine = MlasLogKernelAvx2;
+        this->ErfKernelRoutine = MlasErfKernelAvx2;
+        this->ReduceMaximumKernelRoutine = MlasReduceMaximumKernelAvx2;
+        this->ComputeSumExpKernelRoutine = MlasComputeSumExpKernelAvx2;
+        ComputeVariant = "Avx2";
+
+        //
+        // Every processor with AVX2 also implements the F16C extension.
+        //
+
+        this->ConvertHalfToFloatKernelRoutine = MlasConvertHalfToFloatKernelF16C;
+        ConvertHalfToFloatVariant = "F16C";
+    }
+
+    if (Level >= MlasIsaLevelAvx512F) {
+
+        this->KernelZeroRoutine = MlasSgemmKernelZeroAvx512F;
+        this->KernelAddRoutine = MlasSgemmKernelAddAvx512F;
+        SgemmVariant = "Avx512F";
+
+        this->ConvNchwcKernelRoutine = MlasConvNchwcKernelAvx512F;
+        this->NchwcBlockSize = 16;
+        ConvNchwcVariant = "Avx512F";
+
+        this->ExpKernelRoutine = MlasExpKernelAvx512F;
+        this->LogKernelRoutine = MlasLogKernelAvx512F;
+        this->ErfKernelRoutine = MlasErfKernelAvx512F;
+        this->ReduceMaximumKernelRoutine = MlasReduceMaximumKernelAvx512F;
+        this->ComputeSumExpKernelRoutine = MlasComputeSumExpKernelAvx512F;
+        ComputeVariant = "Avx512F";
+    }
+
+#if defined(MLAS_AVX512VNNI_SUPPORTED)
+
+    if (Level >= MlasIsaLevelAvx512Vnni) {
+
+        this->QgemmU8U8Kernel = &MlasQgemmU8U8KernelAvx512Vnni;
+        this->QgemmU8S8Kernel = &MlasQgemmU8S8KernelAvx512Vnni;
+        QgemmVariant = "Avx512Vnni";
+    }
+
+#endif
+
+#endif
+
+#endif
+
+    //
+    // Record the kernel variant selected for each entry point.
+    //
+
+    this->KernelSelectionCount = 0;
+
+    AddKernelSelection("Sgemm", SgemmVariant);
+    AddKernelSelection("SgemmM1", SgemmM1Variant);
+    AddKernelSelection("SgemmTransposePackB", SgemmTransposePackBVariant);
+    AddKernelSelection("Qgemm", QgemmVariant);
+    AddKernelSelection("ConvNchwc", ConvNchwcVariant);
+    AddKernelSelection("Logistic", LogisticTanhVariant);
+    AddKernelSelection("Tanh", LogisticTanhVariant);
+    AddKernelSelection("Exp", ComputeVariant);
+    AddKernelSelection("Log", ComputeVariant);
+    AddKernelSelection("Erf", ComputeVariant);
+    AddKernelSelection("Softmax", ComputeVariant);
+    AddKernelSelection("ConvertHalfToFloat", ConvertHalfToFloatVariant);
+}
+
+void
+MLAS_PLATFORM::AddKernelSelection(
+    const char* EntryPoint,
+    const char* Variant
+    )
+/*++
+
+Routine Description:
+
+    This routine appends an entry to the kernel selection report.
+
+Arguments:
+
+    EntryPoint - Supplies the name of the library entry point.
+
+    Variant - Supplies the name of the kernel variant used by the entry point.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (this->KernelSelectionCount < MLAS_MAXIMUM_KERNEL_SELECTION_COUNT) {
+        this->KernelSelection[this->KernelSelectionCount].EntryPoint = EntryPoint;
+        this->KernelSelection[this->KernelSelectionCount].Variant = Variant;
+        this->KernelSelectionCount++;
+    }
+}
+
+MLAS_ISA_LEVEL
+MLASCALL
+MlasGetIsaLevel(
+    void
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the instruction set level of the selected kernels.
+
+Arguments:
+
+    None.
+
+Return Value:
+
+    Returns the instruction set level.
+
+--*/
+{
+    return MlasPlatform.IsaLevel;
+}
+
+MLAS_ISA_LEVEL
+MLASCALL
+MlasGetSupportedIsaLevel(
+    void
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the highest instruction set level that is supported by
+    both the processor and this build of the library.
+
+Arguments:
+
+    None.
+
+Return Value:
+
+    Returns the instruction set level.
+
+--*/
+{
+    return MlasPlatform.SupportedIsaLevel;
+}
+
+MLAS_ISA_LEVEL
+MLASCALL
+MlasSetMaximumIsaLevel(
+    MLAS_ISA_LEVEL MaximumIsaLevel
+    )
+/*++
+
+Routine Description:
+
+    This routine reselects the kernel routines so that they do not use an
+    instruction set above the supplied level.
+
+    N.B. This routine is not thread safe with respect to the other library
+    routines.
+
+Arguments:
+
+    MaximumIsaLevel - Supplies the maximum instruction set level to use. The
+        supported instruction set level is used if this is higher.
+
+Return Value:
+
+    Returns the instruction set level of the selected kernels.
+
+--*/
+{
+    MlasPlatform.SelectKernels(MaximumIsaLevel);
+
+    return MlasPlatform.IsaLevel;
+}
+
+const char*
+MLASCALL
+MlasGetIsaLevelName(
+    MLAS_ISA_LEVEL IsaLevel
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the name of an instruction set level.
+
+Arguments:
+
+    IsaLevel - Supplies the instruction set level.
+
+Return Value:
+
+    Returns the name of the level, or nullptr if the level is not valid.
+
+--*/
+{
+    if (size_t(IsaLevel) >= sizeof(MlasIsaLevelNames) / sizeof(MlasIsaLevelNames[0])) {
+        return nullptr;
+    }
+
+    return MlasIsaLevelNames[IsaLevel];
+}
+
+size_t
+MLASCALL
+MlasGetKernelSelection(
+    const MLAS_KERNEL_SELECTION** KernelSelection
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the kernel variant that is used by each library entry
+    point with dispatched kernels.
+
+Arguments:
+
+    KernelSelection - Receives the address of the array of kernel selection
+        entries. The array remains valid until the kernels are reselected.
+
+Return Value:
+
+    Returns the number of entries in the array.
+
+--*/
+{
+    *KernelSelection = MlasPlatform.KernelSelection;
+
+    return MlasPlatform.KernelSelectionCount;
+}
@@ -269,6 +269,23 @@ struct MLAS_AVERAGE_POOLING
     };
 };
 
+//
+// Abstraction for sum pooling, which is average pooling without the division
+// by the number of elements.
+//
+
+struct MLAS_SUM_POOLING : MLAS_AVERAGE_POOLING
+{
+    static float AveragePool(float Reduction, float Size)
+    {
+        MLAS_UNREFERENCED_PARAMETER(Size);
+
+        return Reduction;
+    }
+
+    typedef MLAS_MAXIMUM_POOLING::DividerVectorContext DividerVectorContext;
+};
+
 template<typename PoolingType>
 void
 MlasPool1DKernel(
@@ -1066,11 +1083,36 @@ Return Value:
         size_t InputSizeRemaining = InputSize;
 
         //
-        // Iterate over the input buffer a vector at a time.
+        // Iterate over the input buffer four vectors at a time using
+        // independent accumulators to hide the latency of the reduction.
         //
 
         MLAS_FLOAT32X4 Reduction = PoolingType::InitialVector();
 
+        if (InputSizeRemaining >= 16) {
+
+            MLAS_FLOAT32X4 Reduction1 = PoolingType::InitialVector();
+            MLAS_FLOAT32X4 Reduction2 = PoolingType::InitialVector();
+            MLAS_FLOAT32X4 Reduction3 = PoolingType::InitialVector();
+
+            do {
+                Reduction = PoolingType::Reduce(Reduction, MlasLoadFloat32x4(Input));
+                Reduction1 = PoolingType::Reduce(Reduction1, MlasLoadFloat32x4(Input + 4));
+                Reduction2 = PoolingType::Reduce(Reduction2, MlasLoadFloat32x4(Input + 8));
+                Reduction3 = PoolingType::Reduce(Reduction3, MlasLoadFloat32x4(Input + 12));
+                Input += 16;
+                InputSizeRemaining -= 16;
+            } while (InputSizeRemaining >= 16);
+
+            Reduction = PoolingType::Reduce(Reduction, Reduction1);
+            Reduction2 = PoolingType::Reduce(Reduction2, Reduction3);
+            Reduction = PoolingType::Reduce(Reduction, Reduction2);
+        }
+
+        //
+        // Iterate over the remaining input buffer a vector at a time.
+        //
+
         while (InputSizeRemaining >= 4) {
             Reduction = PoolingType::Reduce(Reduction, MlasLoadFloat32x4(Input));
             Input += 4;
@@ -1146,6 +1188,11 @@ static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolGenericKernels[][3] =
         MlasPool2DKernel<MLAS_AVERAGE_POOLING>,
         MlasPool3DKernel<MLAS_AVERAGE_POOLING>,
     },
+    {
+        MlasPool1DKernel<MLAS_SUM_POOLING>,
+        MlasPool2DKernel<MLAS_SUM_POOLING>,
+        MlasPool3DKernel<MLAS_SUM_POOLING>,
+    },
 };
 
 static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolGlobalKernels[] =
@@ -1153,6 +1200,7 @@ static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolGlobalKernels[] =
     MlasPoolGlobalKernel<MLAS_MAXIMUM_POOLING>,
     MlasPoolGlobalKernel<MLAS_AVERAGE_POOLING>,
     MlasPoolGlobalKernel<MLAS_AVERAGE_POOLING>,
+    MlasPoolGlobalKernel<MLAS_SUM_POOLING>,
 };
 
 static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolVectorKernels[][2] =
@@ -1169,8 +1217,80 @@ static const PMLAS_POOL_KERNEL_ROUTINE MlasPoolVectorKernels[][2] =
         MlasPool2DVectorKernel<MLAS_AVERAGE_POOLING>,
         MlasPool3DVectorKernel<MLAS_AVERAGE_POOLING>,
     },
+    {
+        MlasPool2DVectorKernel<MLAS_SUM_POOLING>,
+        MlasPool3DVectorKernel<MLAS_SUM_POOLING>,
+    },
+};
+
+//
+// Define the parameters to execute the selected pooling kernel routine across
+// multiple threads, slicing the channel dimension.
+//
+
+struct MLAS_POOL_THREADED_WORK_BLOCK {
+    const MLAS_WORK_BLOCK* WorkBlock;
+    PMLAS_POOL_KERNEL_ROUTINE PoolKernelRoutine;
+    size_t TotalChannelCount;
+    size_t InputSize;
+    size_t OutputSize;
+    const float* Input;
+    float* Output;
+    int32_t TargetThreadCount;
 };
 
+void
+MlasPoolThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    pooling operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_POOL_THREADED_WORK_BLOCK* ThreadedBlock = (MLAS_POOL_THREADED_WORK_BLOCK*)Context;
+
+    //
+    // Compute the range of channels to use for this thread.
+    //
+
+    const size_t TotalChannelCount = ThreadedBlock->TotalChannelCount;
+    const size_t TargetThreadCount = size_t(ThreadedBlock->TargetThreadCount);
+
+    const size_t ChannelCountPerThread = TotalChannelCount / TargetThreadCount;
+    const size_t ChannelCountExtra = TotalChannelCount % TargetThreadCount;
+
+    size_t ChannelStart;
+    size_t ChannelCount;
+
+    if (size_t(Index) < ChannelCountExtra) {
+        ChannelStart = (ChannelCountPerThread + 1) * Index;
+        ChannelCount = ChannelCountPerThread + 1;
+    } else {
+        ChannelStart = ChannelCountPerThread * Index + ChannelCountExtra;
+        ChannelCount = ChannelCountPerThread;
+    }
+
+    ThreadedBlock->PoolKernelRoutine(ThreadedBlock->WorkBlock, ChannelCount,
+        ThreadedBlock->Input + ChannelStart * ThreadedBlock->InputSize,
+        ThreadedBlock->Output + ChannelStart * ThreadedBlock->OutputSize);
+}
+
 void
 MLASCALL
 MlasPool(
@@ -1182,7 +1302,8 @@ MlasPool(
     const int64_t* StrideShape,
     const int64_t* OutputShape,
     const float* Input,
-    float* Output
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
     )
 /*++
 
@@ -1211,6 +1332,9 @@ Arguments:
 
     Output - Supplies the output tensor.
 
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
 Return Value:
 
     None.
@@ -1316,20 +1440,32 @@ Return Value:
     }
 
     //
-    // Execute the pooling kernel routine.
+    // Execute the pooling kernel routine, slicing the channels across multiple
+    // threads.
     //
 
-#if defined(MLAS_USE_OPENMP)
+    int32_t TargetThreadCount = MlasGetMaximumThreadCount(ThreadPool);
 
-    #pragma omp parallel for
-    for (int64_t c = 0; c < int64_t(TotalChannelCount); c++) {
-        PoolKernelRoutine(&WorkBlock, 1, Input + c * InputSize, Output + c * OutputSize);
+    if (size_t(TargetThreadCount) >= TotalChannelCount) {
+        TargetThreadCount = int32_t(TotalChannelCount);
     }
 
-#else
+    if (TargetThreadCount <= 1) {
+        PoolKernelRoutine(&WorkBlock, TotalChannelCount, Input, Output);
+        return;
+    }
 
-    PoolKernelRoutine(&WorkBlock, TotalChannelCount, Input, Output);
+    MLAS_POOL_THREADED_WORK_BLOCK ThreadedBlock;
 
-#endif
+    ThreadedBlock.WorkBlock = &WorkBlock;
+    ThreadedBlock.PoolKernelRoutine = PoolKernelRoutine;
+    ThreadedBlock.TotalChannelCount = TotalChannelCount;
+    ThreadedBlock.InputSize = InputSize;
+    ThreadedBlock.OutputSize = OutputSize;
+    ThreadedBlock.Input = Input;
+    ThreadedBlock.Output = Output;
+    ThreadedBlock.TargetThreadCount = TargetThreadCount;
+
+    MlasExecuteThreaded(MlasPoolThreaded, &ThreadedBlock, TargetThreadCount, ThreadPool);
 
 }
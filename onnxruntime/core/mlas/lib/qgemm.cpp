@@ -0,0 +1,1056 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    qgemm.cpp
+
+Abstract:
+
+    This module implements the quantized integer matrix/matrix multiply
+    operation (QGEMM).
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the parameters to execute segments of a QGEMM operation on worker
+// threads.
+//
+
+struct MLAS_QGEMM_WORK_BLOCK {
+    const MLAS_QGEMM_KERNEL* Kernel;
+    size_t K;
+    size_t lda;
+    size_t ldb;
+    size_t ldc;
+    int32_t offa;
+    int32_t offb;
+    const MLAS_QGEMM_REQUANTIZE* Requantize;
+    struct SEGMENT {
+        size_t M;
+        size_t N;
+        const uint8_t* A;
+        const uint8_t* B;
+        void* C;
+        const int32_t* Bias;
+    } Segments[MLAS_MAXIMUM_THREAD_COUNT];
+};
+
+template<typename BType>
+void
+MLASCALL
+MlasQgemmCopyPackBDefault(
+    uint8_t* D,
+    const uint8_t* B,
+    size_t ldb,
+    size_t CountN,
+    size_t CountK,
+    int32_t* ColumnSumVector
+    )
+/*++
+
+Routine Description:
+
+    This routine copies elements from the source matrix to the destination
+    packed buffer in the format consumed by the portable QGEMM kernel.
+
+    Columns of 16 elements from the source matrix are unrolled to be physically
+    contiguous for better locality inside the QGEMM kernels. Any remaining
+    columns and K values are padded with zeroes.
+
+Arguments:
+
+    D - Supplies the address of the destination packed buffer.
+
+    B - Supplies the address of the source matrix.
+
+    ldb - Supplies the number of elements per row of the source matrix.
+
+    CountN - Supplies the number of columns of the source matrix to copy.
+
+    CountK - Supplies the number of rows of the source matrix to copy.
+
+    ColumnSumVector - Supplies the address of the buffer that receives the sum
+        of each column of the source matrix, padded to a multiple of 16
+        columns.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedCountK =
+        (CountK + MLAS_QGEMM_PACKED_K_ALIGN - 1) & ~(MLAS_QGEMM_PACKED_K_ALIGN - 1);
+
+    for (size_t n = 0; n < CountN; n += 16) {
+
+        const size_t CountColumns = std::min(CountN - n, size_t(16));
+        int32_t ColumnSums[16] = { 0 };
+
+        for (size_t k = 0; k < AlignedCountK; k++) {
+
+            for (size_t c = 0; c < 16; c++) {
+
+                uint8_t Value = 0;
+
+                if (k < CountK && c < CountColumns) {
+                    Value = B[k * ldb + n + c];
+                    ColumnSums[c] += BType(Value);
+                }
+
+                *D++ = Value;
+            }
+        }
+
+        for (size_t c = 0; c < 16; c++) {
+            ColumnSumVector[n + c] = ColumnSums[c];
+        }
+    }
+}
+
+template<typename BType>
+size_t
+MLASCALL
+MlasQgemmKernelDefault(
+    const uint8_t* A,
+    const uint8_t* B,
+    int32_t* C,
+    size_t PackedCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    const int32_t* RowSumVector,
+    const int32_t* ColumnSumVector,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine is an inner kernel to compute matrix multiplication for a
+    set of rows. The portable kernel processes a single row of matrix A.
+
+Arguments:
+
+    A - Supplies the address of matrix A. The matrix data has been packed
+        using MlasQgemmCopyPackA.
+
+    B - Supplies the address of matrix B. The matrix data has been packed
+        using the kernel's copy routine.
+
+    C - Supplies the address of matrix C.
+
+    PackedCountK - Supplies the number of packed K groups to process.
+
+    CountM - Supplies the maximum number of rows that can be processed for
+        matrix A and matrix C. The actual number of rows handled for this
+        invocation depends on the kernel implementation.
+
+    CountN - Supplies the number of columns from matrix B and matrix C to
+        iterate over.
+
+    lda - Supplies the first dimension of matrix A.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    RowSumVector - Supplies the values to add to each row of matrix C.
+
+    ColumnSumVector - Supplies the values to add to each column of matrix C.
+
+    ZeroMode - Supplies true if the output matrix must be zero initialized,
+        else false if the output matrix is accumulated into.
+
+Return Value:
+
+    Returns the number of rows handled.
+
+--*/
+{
+    MLAS_UNREFERENCED_PARAMETER(CountM);
+    MLAS_UNREFERENCED_PARAMETER(lda);
+    MLAS_UNREFERENCED_PARAMETER(ldc);
+
+    while (CountN > 0) {
+
+        int32_t Accumulators[16];
+
+        for (size_t c = 0; c < 16; c++) {
+            Accumulators[c] = RowSumVector[0] + ColumnSumVector[c];
+        }
+
+        for (size_t k = 0; k < PackedCountK; k++) {
+
+            const int32_t ValueA = A[k];
+
+            for (size_t c = 0; c < 16; c++) {
+                Accumulators[c] += ValueA * int32_t(BType(B[c]));
+            }
+
+            B += 16;
+        }
+
+        const size_t CountColumns = std::min(CountN, size_t(16));
+
+        for (size_t c = 0; c < CountColumns; c++) {
+            C[c] = ZeroMode ? Accumulators[c] : C[c] + Accumulators[c];
+        }
+
+        C += CountColumns;
+        ColumnSumVector += 16;
+        CountN -= CountColumns;
+    }
+
+    return 1;
+}
+
+const MLAS_QGEMM_KERNEL MlasQgemmU8U8KernelDefault = {
+    MlasQgemmCopyPackBDefault<uint8_t>,
+    MlasQgemmKernelDefault<uint8_t>,
+    1,
+    0,
+};
+
+const MLAS_QGEMM_KERNEL MlasQgemmU8S8KernelDefault = {
+    MlasQgemmCopyPackBDefault<int8_t>,
+    MlasQgemmKernelDefault<int8_t>,
+    1,
+    0,
+};
+
+void
+MlasQgemmCopyPackA(
+    uint8_t* D,
+    const uint8_t* A,
+    size_t lda,
+    size_t CountM,
+    size_t CountK,
+    int32_t* RowSumVector
+    )
+/*++
+
+Routine Description:
+
+    This routine copies elements from the source matrix to the destination
+    packed buffer. Each row is padded with zeroes to a multiple of
+    MLAS_QGEMM_PACKED_K_ALIGN elements so that the kernels can consume K
+    values in groups without reading past the end of the row.
+
+Arguments:
+
+    D - Supplies the address of the destination packed buffer.
+
+    A - Supplies the address of the source matrix.
+
+    lda - Supplies the number of elements per row of the source matrix.
+
+    CountM - Supplies the number of rows of the source matrix to copy.
+
+    CountK - Supplies the number of columns of the source matrix to copy.
+
+    RowSumVector - Supplies the address of the buffer that receives the sum
+        of each row of the source matrix.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedCountK =
+        (CountK + MLAS_QGEMM_PACKED_K_ALIGN - 1) & ~(MLAS_QGEMM_PACKED_K_ALIGN - 1);
+
+    while (CountM-- > 0) {
+
+        int32_t RowSum = 0;
+
+        for (size_t k = 0; k < CountK; k++) {
+            D[k] = A[k];
+            RowSum += A[k];
+        }
+
+        for (size_t k = CountK; k < AlignedCountK; k++) {
+            D[k] = 0;
+        }
+
+        *RowSumVector++ = RowSum;
+
+        A += lda;
+        D += AlignedCountK;
+    }
+}
+
+inline
+int32_t
+MlasQgemmRequantizeValue(
+    int32_t Value,
+    int32_t Multiplier,
+    int32_t RightShift
+    )
+/*++
+
+Routine Description:
+
+    This routine scales the supplied value by the fixed point multiplier and
+    the power of two shift, rounding to the nearest integer with ties away
+    from zero.
+
+    The rounding matches gemmlowp's OutputStageQuantizeDownInt32ByFixedPoint:
+    a saturating rounding doubling high multiply followed by a rounding right
+    shift. A negative RightShift scales the value up before the multiply.
+
+Arguments:
+
+    Value - Supplies the value to scale.
+
+    Multiplier - Supplies the Q31 fixed point multiplier.
+
+    RightShift - Supplies the number of bits to shift the result right.
+
+Return Value:
+
+    Returns the scaled value.
+
+--*/
+{
+    int64_t ScaledValue = Value;
+
+    if (RightShift < 0) {
+        ScaledValue = std::min(std::max(ScaledValue * (int64_t(1) << std::min(-RightShift, 31)),
+            int64_t(std::numeric_limits<int32_t>::min())), int64_t(std::numeric_limits<int32_t>::max()));
+        RightShift = 0;
+    }
+
+    //
+    // Compute the saturating rounding doubling high multiply.
+    //
+
+    int64_t HighValue;
+
+    if (ScaledValue == std::numeric_limits<int32_t>::min() && Multiplier == std::numeric_limits<int32_t>::min()) {
+        HighValue = std::numeric_limits<int32_t>::max();
+    } else {
+        int64_t Product = ScaledValue * Multiplier;
+        int64_t Nudge = (Product >= 0) ? (int64_t(1) << 30) : (1 - (int64_t(1) << 30));
+        HighValue = (Product + Nudge) / (int64_t(1) << 31);
+    }
+
+    //
+    // Compute the rounding divide by the power of two.
+    //
+
+    RightShift = std::min(RightShift, int32_t(62));
+
+    int64_t Mask = (int64_t(1) << RightShift) - 1;
+    int64_t Remainder = HighValue & Mask;
+    int64_t Threshold = (Mask >> 1) + ((HighValue < 0) ? 1 : 0);
+
+    return int32_t((HighValue >> RightShift) + ((Remainder > Threshold) ? 1 : 0));
+}
+
+void
+MlasQgemmRequantize(
+    const int32_t* Input,
+    size_t ldi,
+    uint8_t* Output,
+    size_t ldo,
+    size_t CountM,
+    size_t CountN,
+    const int32_t* Bias,
+    const MLAS_QGEMM_REQUANTIZE* Requantize
+    )
+/*++
+
+Routine Description:
+
+    This routine adds the optional bias to each row of the 32-bit integer
+    input matrix, requantizes the values and stores the result saturated to
+    unsigned 8-bit integers.
+
+Arguments:
+
+    Input - Supplies the address of the input matrix.
+
+    ldi - Supplies the first dimension of the input matrix.
+
+    Output - Supplies the address of the output matrix.
+
+    ldo - Supplies the first dimension of the output matrix.
+
+    CountM - Supplies the number of rows to process.
+
+    CountN - Supplies the number of columns to process.
+
+    Bias - Supplies the address of the bias for each row, else nullptr.
+
+    Requantize - Supplies the requantization parameters.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const int32_t Multiplier = Requantize->Multiplier;
+    const int32_t RightShift = Requantize->RightShift;
+    const int32_t ZeroPoint = Requantize->ZeroPoint;
+
+    for (size_t m = 0; m < CountM; m++) {
+
+        const int32_t RowBias = (Bias != nullptr) ? Bias[m] : 0;
+
+        for (size_t n = 0; n < CountN; n++) {
+
+            int32_t Value = MlasQgemmRequantizeValue(Input[n] + RowBias, Multiplier, RightShift) + ZeroPoint;
+
+            Output[n] = uint8_t(std::min(std::max(Value, int32_t(0)), int32_t(255)));
+        }
+
+        Input += ldi;
+        Output += ldo;
+    }
+}
+
+void
+MlasQgemmMultiplyPanel(
+    const MLAS_QGEMM_KERNEL* Kernel,
+    uint8_t* PanelA,
+    const uint8_t* PanelB,
+    const uint8_t* A,
+    size_t lda,
+    int32_t offb,
+    int32_t* C,
+    size_t ldc,
+    size_t CountM,
+    size_t CountN,
+    size_t CountK,
+    const int32_t* ColumnSumVector,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine multiplies a slice of matrix A by a packed panel of matrix
+    B, processing MLAS_QGEMM_STRIDEM rows of matrix A at a time.
+
+Arguments:
+
+    Kernel - Supplies the QGEMM kernel that packed matrix B.
+
+    PanelA - Supplies the address of the local buffer used to pack matrix A.
+
+    PanelB - Supplies the address of the packed panel of matrix B.
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    offb - Supplies the zero point offset of matrix B.
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    CountM - Supplies the number of rows of matrix A and matrix C.
+
+    CountN - Supplies the number of columns of the panel and matrix C.
+
+    CountK - Supplies the number of columns of matrix A and rows of the panel.
+
+    ColumnSumVector - Supplies the values to add to each column of matrix C.
+
+    ZeroMode - Supplies true if the output matrix must be zero initialized,
+        else false if the output matrix is accumulated into.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_DECLSPEC_ALIGN(int32_t RowSumVector[MLAS_QGEMM_STRIDEM], 64);
+
+    const size_t AlignedCountK =
+        (CountK + MLAS_QGEMM_PACKED_K_ALIGN - 1) & ~(MLAS_QGEMM_PACKED_K_ALIGN - 1);
+    const size_t PackedCountK = AlignedCountK / Kernel->PackedK;
+    const int32_t RowScale = Kernel->PackedBOffset - offb;
+
+    for (size_t RowsPacked, m = 0; m < CountM; m += RowsPacked) {
+
+        RowsPacked = std::min(CountM - m, size_t(MLAS_QGEMM_STRIDEM));
+
+        //
+        // Copy a slice of matrix A to the local packed buffer.
+        //
+
+        MlasQgemmCopyPackA(PanelA, A + m * lda, lda, RowsPacked, CountK, RowSumVector);
+
+        for (size_t mm = 0; mm < RowsPacked; mm++) {
+            RowSumVector[mm] *= RowScale;
+        }
+
+        //
+        // Step through the rows of the local packed buffer.
+        //
+
+        const uint8_t* a = PanelA;
+        int32_t* c = C + m * ldc;
+        const int32_t* RowSums = RowSumVector;
+        size_t RowsRemaining = RowsPacked;
+
+        while (RowsRemaining > 0) {
+
+            size_t RowsHandled = Kernel->KernelRoutine(a, PanelB, c, PackedCountK,
+                RowsRemaining, CountN, AlignedCountK, ldc, RowSums, ColumnSumVector,
+                ZeroMode);
+
+            a += AlignedCountK * RowsHandled;
+            c += ldc * RowsHandled;
+            RowSums += RowsHandled;
+            RowsRemaining -= RowsHandled;
+        }
+    }
+}
+
+void
+MlasQgemmOperation(
+    const MLAS_QGEMM_WORK_BLOCK* WorkBlock,
+    const MLAS_QGEMM_WORK_BLOCK::SEGMENT* Segment
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the quantized integer matrix/matrix multiply
+    operation (QGEMM) for a single segment of the output matrix.
+
+Arguments:
+
+    WorkBlock - Supplies the parameters common to all segments of the
+        operation.
+
+    Segment - Supplies the segment of the operation to compute.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_DECLSPEC_ALIGN(uint8_t PanelA[MLAS_QGEMM_STRIDEM * MLAS_QGEMM_STRIDEK], 64);
+    MLAS_DECLSPEC_ALIGN(uint8_t PanelB[MLAS_QGEMM_STRIDEN * MLAS_QGEMM_STRIDEK], 64);
+    MLAS_DECLSPEC_ALIGN(int32_t ColumnSumVector[MLAS_QGEMM_STRIDEN], 64);
+
+    const MLAS_QGEMM_KERNEL* Kernel = WorkBlock->Kernel;
+    const MLAS_QGEMM_REQUANTIZE* Requantize = WorkBlock->Requantize;
+
+    const size_t M = Segment->M;
+    const size_t N = Segment->N;
+    const size_t K = WorkBlock->K;
+    const size_t lda = WorkBlock->lda;
+    const size_t ldb = WorkBlock->ldb;
+    const size_t ldc = WorkBlock->ldc;
+    const int32_t offa = WorkBlock->offa;
+    const int32_t offb = WorkBlock->offb;
+
+    //
+    // Step through each slice of matrix B along the N dimension.
+    //
+
+    for (size_t CountN, n = 0; n < N; n += CountN) {
+
+        CountN = std::min(N - n, size_t(MLAS_QGEMM_STRIDEN));
+
+        const size_t AlignedCountN = (CountN + 15) & ~size_t(15);
+
+        //
+        // Step through each slice of matrix B along the K dimension. The loop
+        // executes once for an empty K dimension so that the output is
+        // initialized.
+        //
+        // Each panel of matrix B is packed once and multiplied by all rows of
+        // matrix A. The 32-bit integer output accumulates directly in matrix
+        // C. The 8-bit output is produced one slice of rows at a time through
+        // a local accumulator, so the panel is packed once if the K dimension
+        // fits in a single slice and is otherwise packed again for each slice
+        // of rows.
+        //
+
+        const size_t StrideM = (Requantize != nullptr) ? MLAS_QGEMM_STRIDEM : M;
+
+        for (size_t CountM, m = 0; m < M; m += CountM) {
+
+            MLAS_DECLSPEC_ALIGN(int32_t Accumulators[MLAS_QGEMM_STRIDEM * MLAS_QGEMM_STRIDEN], 64);
+
+            CountM = std::min(M - m, StrideM);
+
+            int32_t* c;
+            size_t ldcc;
+
+            if (Requantize != nullptr) {
+                c = Accumulators;
+                ldcc = MLAS_QGEMM_STRIDEN;
+            } else {
+                c = (int32_t*)Segment->C + m * ldc + n;
+                ldcc = ldc;
+            }
+
+            size_t CountK;
+            size_t k = 0;
+
+            do {
+
+                CountK = std::min(K - k, size_t(MLAS_QGEMM_STRIDEK));
+
+                //
+                // Copy a panel of matrix B to the local packed buffer and fold
+                // the zero point offsets into the column sums.
+                //
+
+                if (m == 0 || K > MLAS_QGEMM_STRIDEK) {
+
+                    Kernel->CopyPackBRoutine(PanelB, Segment->B + k * ldb + n, ldb, CountN, CountK, ColumnSumVector);
+
+                    const int32_t ColumnOffset = int32_t(CountK) * offa * offb;
+
+                    for (size_t nn = 0; nn < AlignedCountN; nn++) {
+                        ColumnSumVector[nn] = ColumnOffset - offa * ColumnSumVector[nn];
+                    }
+                }
+
+                MlasQgemmMultiplyPanel(Kernel, PanelA, PanelB, Segment->A + m * lda + k, lda, offb,
+                    c, ldcc, CountM, CountN, CountK, ColumnSumVector, k == 0);
+
+                k += CountK;
+
+            } while (k < K);
+
+            //
+            // Apply the requantization stage while the accumulators are still
+            // in the cache.
+            //
+
+            if (Requantize != nullptr) {
+
+                const int32_t* Bias = (Segment->Bias != nullptr) ? Segment->Bias + m : nullptr;
+
+                MlasQgemmRequantize(Accumulators, MLAS_QGEMM_STRIDEN, (uint8_t*)Segment->C + m * ldc + n,
+                    ldc, CountM, CountN, Bias, Requantize);
+            }
+        }
+    }
+}
+
+void
+MlasQgemmOperationThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    QGEMM operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_QGEMM_WORK_BLOCK* WorkBlock = (MLAS_QGEMM_WORK_BLOCK*)Context;
+
+    MlasQgemmOperation(WorkBlock, &WorkBlock->Segments[Index]);
+}
+
+void
+MlasQgemmSchedule(
+    MLAS_QGEMM_WORK_BLOCK* WorkBlock,
+    size_t M,
+    size_t N,
+    const uint8_t* A,
+    const uint8_t* B,
+    void* C,
+    size_t ElementSizeC,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine segments a QGEMM operation across multiple threads based on
+    the complexity of the operation and executes the segments.
+
+Arguments:
+
+    WorkBlock - Supplies the common fields of the work block.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    A - Supplies the address of matrix A.
+
+    B - Supplies the address of matrix B.
+
+    C - Supplies the address of matrix C.
+
+    ElementSizeC - Supplies the size in bytes of an element of matrix C.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t K = WorkBlock->K;
+    const int32_t* Bias = (WorkBlock->Requantize != nullptr) ? WorkBlock->Requantize->Bias : nullptr;
+
+    //
+    // Compute the number of target threads given the complexity of the QGEMM
+    // operation. Small requests should run using the single threaded path.
+    //
+
+    int32_t TargetThreadCount;
+
+    double Complexity = double(M) * double(N) * double(K);
+
+    if (Complexity < double(MLAS_QGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_QGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (TargetThreadCount == 1) {
+
+        MLAS_QGEMM_WORK_BLOCK::SEGMENT* Segment = &WorkBlock->Segments[0];
+
+        Segment->M = M;
+        Segment->N = N;
+        Segment->A = A;
+        Segment->B = B;
+        Segment->C = C;
+        Segment->Bias = Bias;
+
+        MlasQgemmOperation(WorkBlock, Segment);
+        return;
+    }
+
+    //
+    // Segment the operation across multiple threads.
+    //
+
+    int32_t Index = 0;
+
+    if (N > M) {
+
+        size_t StrideN = N / TargetThreadCount;
+
+        if ((StrideN * TargetThreadCount) != N) {
+            StrideN++;
+        }
+
+        StrideN =
+            (StrideN + MLAS_QGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_QGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+        for (size_t CountN, n = 0; n < N; n += CountN) {
+
+            CountN = std::min(N - n, StrideN);
+
+            WorkBlock->Segments[Index].M = M;
+            WorkBlock->Segments[Index].N = CountN;
+            WorkBlock->Segments[Index].A = A;
+            WorkBlock->Segments[Index].B = B + n;
+            WorkBlock->Segments[Index].C = (uint8_t*)C + n * ElementSizeC;
+            WorkBlock->Segments[Index].Bias = Bias;
+
+            Index++;
+        }
+
+    } else {
+
+        size_t StrideM = M / TargetThreadCount;
+
+        if ((StrideM * TargetThreadCount) != M) {
+            StrideM++;
+        }
+
+        for (size_t CountM, m = 0; m < M; m += CountM) {
+
+            CountM = std::min(M - m, StrideM);
+
+            WorkBlock->Segments[Index].M = CountM;
+            WorkBlock->Segments[Index].N = N;
+            WorkBlock->Segments[Index].A = A + m * WorkBlock->lda;
+            WorkBlock->Segments[Index].B = B;
+            WorkBlock->Segments[Index].C = (uint8_t*)C + m * WorkBlock->ldc * ElementSizeC;
+            WorkBlock->Segments[Index].Bias = (Bias != nullptr) ? Bias + m : nullptr;
+
+            Index++;
+        }
+    }
+
+    MlasExecuteThreaded(MlasQgemmOperationThreaded, WorkBlock, Index, ThreadPool);
+}
+
+void
+MlasQgemmInternal(
+    bool BIsSigned,
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    int32_t offa,
+    const uint8_t* B,
+    size_t ldb,
+    int32_t offb,
+    const MLAS_QGEMM_REQUANTIZE* Requantize,
+    void* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the common entry point for the QGEMM variants.
+
+Arguments:
+
+    BIsSigned - Supplies true if matrix B contains signed 8-bit elements.
+
+    Requantize - Supplies the requantization parameters if matrix C contains
+        unsigned 8-bit elements, else nullptr if matrix C contains 32-bit
+        integer elements.
+
+    See MlasQgemm for the remaining arguments.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (M == 0 || N == 0) {
+        return;
+    }
+
+    MLAS_QGEMM_WORK_BLOCK WorkBlock;
+
+    WorkBlock.Kernel = BIsSigned ? MlasPlatform.QgemmU8S8Kernel : MlasPlatform.QgemmU8U8Kernel;
+    WorkBlock.K = K;
+    WorkBlock.lda = lda;
+    WorkBlock.ldb = ldb;
+    WorkBlock.ldc = ldc;
+    WorkBlock.offa = offa;
+    WorkBlock.offb = offb;
+    WorkBlock.Requantize = Requantize;
+
+    size_t ElementSizeC = (Requantize != nullptr) ? sizeof(uint8_t) : sizeof(int32_t);
+
+    MlasQgemmSchedule(&WorkBlock, M, N, A, B, C, ElementSizeC, ThreadPool);
+}
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const uint8_t* B,
+    size_t ldb,
+    uint8_t offb,
+    int32_t* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the quantized integer matrix/matrix multiply
+    operation (QGEMM) for unsigned matrix A and unsigned matrix B, producing
+    a 32-bit integer matrix C.
+
+Arguments:
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    offa - Supplies the zero point offset of matrix A.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    offb - Supplies the zero point offset of matrix B.
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasQgemmInternal(false, M, N, K, A, lda, offa, B, ldb, offb, nullptr, C, ldc, ThreadPool);
+}
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const int8_t* B,
+    size_t ldb,
+    int8_t offb,
+    int32_t* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the quantized integer matrix/matrix multiply
+    operation (QGEMM) for unsigned matrix A and signed matrix B, producing a
+    32-bit integer matrix C.
+
+Arguments:
+
+    See the unsigned matrix B variant.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasQgemmInternal(true, M, N, K, A, lda, offa, (const uint8_t*)B, ldb, offb, nullptr, C, ldc, ThreadPool);
+}
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const uint8_t* B,
+    size_t ldb,
+    uint8_t offb,
+    const MLAS_QGEMM_REQUANTIZE* Requantize,
+    uint8_t* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the quantized integer matrix/matrix multiply
+    operation (QGEMM) for unsigned matrix A and unsigned matrix B, producing
+    an unsigned 8-bit matrix C.
+
+    The 32-bit integer result has the optional bias added to each row, is
+    scaled by the fixed point multiplier and shift, and is offset by the zero
+    point of matrix C before being saturated to 8 bits.
+
+Arguments:
+
+    Requantize - Supplies the requantization parameters.
+
+    See the 32-bit integer matrix C variant for the remaining arguments.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasQgemmInternal(false, M, N, K, A, lda, offa, B, ldb, offb, Requantize, C, ldc, ThreadPool);
+}
+
+void
+MLASCALL
+MlasQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const int8_t* B,
+    size_t ldb,
+    int8_t offb,
+    const MLAS_QGEMM_REQUANTIZE* Requantize,
+    uint8_t* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the quantized integer matrix/matrix multiply
+    operation (QGEMM) for unsigned matrix A and signed matrix B, producing an
+    unsigned 8-bit matrix C.
+
+Arguments:
+
+    See the unsigned matrix B variant.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasQgemmInternal(true, M, N, K, A, lda, offa, (const uint8_t*)B, ldb, offb, Requantize, C, ldc, ThreadPool);
+}
@@ -0,0 +1,538 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    qgemm_kernel_avx2.cpp
+
+Abstract:
+
+    This module implements the QGEMM kernels for AVX2.
+
+    The kernels widen the 8-bit elements to 16 bits and use vpmaddwd to
+    multiply and accumulate pairs of K values into 32-bit integers. Unlike
+    vpmaddubsw, the intermediate result cannot saturate, so the result is
+    exact for both unsigned and signed elements of matrix B.
+
+--*/
+
+#include "mlasi.h"
+
+#include <type_traits>
+
+template<typename BType>
+inline
+__m256i
+MlasQgemmPairSumsAvx2(
+    __m256i Packed
+    )
+/*++
+
+Routine Description:
+
+    This routine sums the pairs of K values for each of the 16 columns of a
+    packed row of matrix B.
+
+Arguments:
+
+    Packed - Supplies the packed row.
+
+Return Value:
+
+    Returns the 16-bit sums of each column.
+
+--*/
+{
+    const __m256i Ones = _mm256_set1_epi8(1);
+
+    if (std::is_signed<BType>::value) {
+        return _mm256_maddubs_epi16(Ones, Packed);
+    } else {
+        return _mm256_maddubs_epi16(Packed, Ones);
+    }
+}
+
+template<typename BType>
+void
+MlasQgemmCopyPackBPanelAvx2(
+    uint8_t* D,
+    const uint8_t* B,
+    size_t ldb,
+    size_t CountK,
+    int32_t* ColumnSumVector
+    )
+/*++
+
+Routine Description:
+
+    This routine copies a panel of 16 columns from the source matrix to the
+    destination packed buffer.
+
+Arguments:
+
+    D - Supplies the address of the destination packed buffer.
+
+    B - Supplies the address of the source matrix.
+
+    ldb - Supplies the number of elements per row of the source matrix.
+
+    CountK - Supplies the number of rows of the source matrix to copy.
+
+    ColumnSumVector - Supplies the address of the buffer that receives the sum
+        of each of the 16 columns.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedCountK =
+        (CountK + MLAS_QGEMM_PACKED_K_ALIGN - 1) & ~(MLAS_QGEMM_PACKED_K_ALIGN - 1);
+
+    __m256i ColumnSums0 = _mm256_setzero_si256();
+    __m256i ColumnSums1 = _mm256_setzero_si256();
+
+    for (size_t k = 0; k < AlignedCountK; k += 2) {
+
+        __m128i Row0 = _mm_setzero_si128();
+        __m128i Row1 = _mm_setzero_si128();
+
+        if (k < CountK) {
+            Row0 = _mm_loadu_si128((const __m128i*)B);
+            if (k + 1 < CountK) {
+                Row1 = _mm_loadu_si128((const __m128i*)(B + ldb));
+            }
+        }
+
+        //
+        // Interleave the two rows so that each column stores a pair of K
+        // values.
+        //
+
+        __m256i Packed = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_unpacklo_epi8(Row0, Row1)),
+            _mm_unpackhi_epi8(Row0, Row1), 1);
+
+        _mm256_storeu_si256((__m256i*)D, Packed);
+
+        __m256i PairSums = MlasQgemmPairSumsAvx2<BType>(Packed);
+
+        ColumnSums0 = _mm256_add_epi32(ColumnSums0, _mm256_cvtepi16_epi32(_mm256_castsi256_si128(PairSums)));
+        ColumnSums1 = _mm256_add_epi32(ColumnSums1, _mm256_cvtepi16_epi32(_mm256_extracti128_si256(PairSums, 1)));
+
+        B += ldb * 2;
+        D += 32;
+    }
+
+    _mm256_storeu_si256((__m256i*)ColumnSumVector, ColumnSums0);
+    _mm256_storeu_si256((__m256i*)(ColumnSumVector + 8), ColumnSums1);
+}
+
+template<typename BType>
+void
+MLASCALL
+MlasQgemmCopyPackBAvx2(
+    uint8_t* D,
+    const uint8_t* B,
+    size_t ldb,
+    size_t CountN,
+    size_t CountK,
+    int32_t* ColumnSumVector
+    )
+/*++
+
+Routine Description:
+
+    This routine copies elements from the source matrix to the destination
+    packed buffer.
+
+    Columns of 16 elements from the source matrix are unrolled to be physically
+    contiguous for better locality inside the QGEMM kernels. Pairs of K values
+    for a column are stored next to each other so that the kernel can widen
+    them to the 16-bit operands of vpmaddwd. Any remaining columns and K values
+    are padded with zeroes.
+
+Arguments:
+
+    D - Supplies the address of the destination packed buffer.
+
+    B - Supplies the address of the source matrix.
+
+    ldb - Supplies the number of elements per row of the source matrix.
+
+    CountN - Supplies the number of columns of the source matrix to copy.
+
+    CountK - Supplies the number of rows of the source matrix to copy.
+
+    ColumnSumVector - Supplies the address of the buffer that receives the sum
+        of each column of the source matrix, padded to a multiple of 16
+        columns.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedCountK =
+        (CountK + MLAS_QGEMM_PACKED_K_ALIGN - 1) & ~(MLAS_QGEMM_PACKED_K_ALIGN - 1);
+
+    while (CountN >= 16) {
+
+        MlasQgemmCopyPackBPanelAvx2<BType>(D, B, ldb, CountK, ColumnSumVector);
+
+        D += 16 * AlignedCountK;
+        B += 16;
+        ColumnSumVector += 16;
+        CountN -= 16;
+    }
+
+    //
+    // Copy the remaining columns to a zero padded buffer and pack that as a
+    // full panel.
+    //
+
+    if (CountN > 0) {
+
+        MLAS_DECLSPEC_ALIGN(uint8_t PaddedB[MLAS_QGEMM_STRIDEK * 16], 16);
+
+        for (size_t k = 0; k < CountK; k++) {
+            memset(PaddedB + k * 16, 0, 16);
+            memcpy(PaddedB + k * 16, B + k * ldb, CountN);
+        }
+
+        MlasQgemmCopyPackBPanelAvx2<BType>(D, PaddedB, 16, CountK, ColumnSumVector);
+    }
+}
+
+template<typename BType>
+inline
+__m256i
+MlasQgemmLoadPackedBAvx2(
+    const uint8_t* B
+    );
+
+template<>
+inline
+__m256i
+MlasQgemmLoadPackedBAvx2<uint8_t>(
+    const uint8_t* B
+    )
+{
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)B));
+}
+
+template<>
+inline
+__m256i
+MlasQgemmLoadPackedBAvx2<int8_t>(
+    const uint8_t* B
+    )
+{
+    return _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)B));
+}
+
+inline
+void
+MlasQgemmComputeRowAvx2(
+    __m256i& Accumulator0,
+    __m256i& Accumulator1,
+    const uint8_t* A,
+    __m256i BElements0,
+    __m256i BElements1
+    )
+/*++
+
+Routine Description:
+
+    This routine multiplies a pair of K values from a row of matrix A with a
+    packed row of matrix B and accumulates the result.
+
+Arguments:
+
+    Accumulator0 - Supplies the accumulator for the first 8 columns.
+
+    Accumulator1 - Supplies the accumulator for the second 8 columns.
+
+    A - Supplies the address of the pair of K values of matrix A.
+
+    BElements0 - Supplies the widened elements for the first 8 columns.
+
+    BElements1 - Supplies the widened elements for the second 8 columns.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    __m256i APair = _mm256_set1_epi32(int32_t(uint32_t(A[0]) | (uint32_t(A[1]) << 16)));
+
+    Accumulator0 = _mm256_add_epi32(Accumulator0, _mm256_madd_epi16(APair, BElements0));
+    Accumulator1 = _mm256_add_epi32(Accumulator1, _mm256_madd_epi16(APair, BElements1));
+}
+
+inline
+void
+MlasQgemmStoreRowAvx2(
+    __m256i Accumulator0,
+    __m256i Accumulator1,
+    int32_t* C,
+    size_t CountColumns,
+    int32_t RowSum,
+    __m256i ColumnSums0,
+    __m256i ColumnSums1,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine adds the row and column sums to the accumulators and stores
+    the result to a row of matrix C.
+
+Arguments:
+
+    Accumulator0 - Supplies the accumulator for the first 8 columns.
+
+    Accumulator1 - Supplies the accumulator for the second 8 columns.
+
+    C - Supplies the address of the row of matrix C.
+
+    CountColumns - Supplies the number of columns to store.
+
+    RowSum - Supplies the value to add to each column of the row.
+
+    ColumnSums0 - Supplies the values to add to the first 8 columns.
+
+    ColumnSums1 - Supplies the values to add to the second 8 columns.
+
+    ZeroMode - Supplies true if the output matrix must be zero initialized,
+        else false if the output matrix is accumulated into.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    __m256i RowSums = _mm256_set1_epi32(RowSum);
+    __m256i Result0 = _mm256_add_epi32(Accumulator0, _mm256_add_epi32(ColumnSums0, RowSums));
+    __m256i Result1 = _mm256_add_epi32(Accumulator1, _mm256_add_epi32(ColumnSums1, RowSums));
+
+    if (CountColumns == 16) {
+
+        if (!ZeroMode) {
+            Result0 = _mm256_add_epi32(Result0, _mm256_loadu_si256((const __m256i*)C));
+            Result1 = _mm256_add_epi32(Result1, _mm256_loadu_si256((const __m256i*)(C + 8)));
+        }
+
+        _mm256_storeu_si256((__m256i*)C, Result0);
+        _mm256_storeu_si256((__m256i*)(C + 8), Result1);
+
+    } else {
+
+        MLAS_DECLSPEC_ALIGN(int32_t Results[16], 32);
+
+        _mm256_store_si256((__m256i*)Results, Result0);
+        _mm256_store_si256((__m256i*)(Results + 8), Result1);
+
+        for (size_t n = 0; n < CountColumns; n++) {
+            C[n] = ZeroMode ? Results[n] : C[n] + Results[n];
+        }
+    }
+}
+
+template<size_t RowCount, typename BType>
+void
+MlasQgemmKernelAvx2Rows(
+    const uint8_t* A,
+    const uint8_t* B,
+    int32_t* C,
+    size_t PackedCountK,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    const int32_t* RowSumVector,
+    const int32_t* ColumnSumVector,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine computes matrix multiplication for the specified number of
+    rows of matrix A.
+
+    The accumulators are declared for the maximum number of rows and are
+    conditionally used based on RowCount so that they are kept in registers.
+
+Arguments:
+
+    See MlasQgemmKernelAvx2.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    static_assert(RowCount <= 4, "unsupported row count");
+
+    while (CountN > 0) {
+
+        __m256i Accumulator00 = _mm256_setzero_si256();
+        __m256i Accumulator01 = _mm256_setzero_si256();
+        __m256i Accumulator10 = _mm256_setzero_si256();
+        __m256i Accumulator11 = _mm256_setzero_si256();
+        __m256i Accumulator20 = _mm256_setzero_si256();
+        __m256i Accumulator21 = _mm256_setzero_si256();
+        __m256i Accumulator30 = _mm256_setzero_si256();
+        __m256i Accumulator31 = _mm256_setzero_si256();
+
+        const uint8_t* a = A;
+        const uint8_t* b = B;
+
+        for (size_t k = 0; k < PackedCountK; k++) {
+
+            __m256i BElements0 = MlasQgemmLoadPackedBAvx2<BType>(b);
+            __m256i BElements1 = MlasQgemmLoadPackedBAvx2<BType>(b + 16);
+
+            MlasQgemmComputeRowAvx2(Accumulator00, Accumulator01, a, BElements0, BElements1);
+            if (RowCount > 1) {
+                MlasQgemmComputeRowAvx2(Accumulator10, Accumulator11, a + lda, BElements0, BElements1);
+            }
+            if (RowCount > 2) {
+                MlasQgemmComputeRowAvx2(Accumulator20, Accumulator21, a + 2 * lda, BElements0, BElements1);
+            }
+            if (RowCount > 3) {
+                MlasQgemmComputeRowAvx2(Accumulator30, Accumulator31, a + 3 * lda, BElements0, BElements1);
+            }
+
+            a += 2;
+            b += 32;
+        }
+
+        //
+        // Add the row and column sums and store the result to matrix C.
+        //
+
+        __m256i ColumnSums0 = _mm256_loadu_si256((const __m256i*)ColumnSumVector);
+        __m256i ColumnSums1 = _mm256_loadu_si256((const __m256i*)(ColumnSumVector + 8));
+
+        const size_t CountColumns = std::min(CountN, size_t(16));
+
+        MlasQgemmStoreRowAvx2(Accumulator00, Accumulator01, C, CountColumns,
+            RowSumVector[0], ColumnSums0, ColumnSums1, ZeroMode);
+        if (RowCount > 1) {
+            MlasQgemmStoreRowAvx2(Accumulator10, Accumulator11, C + ldc, CountColumns,
+                RowSumVector[1], ColumnSums0, ColumnSums1, ZeroMode);
+        }
+        if (RowCount > 2) {
+            MlasQgemmStoreRowAvx2(Accumulator20, Accumulator21, C + 2 * ldc, CountColumns,
+                RowSumVector[2], ColumnSums0, ColumnSums1, ZeroMode);
+        }
+        if (RowCount > 3) {
+            MlasQgemmStoreRowAvx2(Accumulator30, Accumulator31, C + 3 * ldc, CountColumns,
+                RowSumVector[3], ColumnSums0, ColumnSums1, ZeroMode);
+        }
+
+        B += 16 * 2 * PackedCountK;
+        C += CountColumns;
+        ColumnSumVector += 16;
+        CountN -= CountColumns;
+    }
+}
+
+template<typename BType>
+size_t
+MLASCALL
+MlasQgemmKernelAvx2(
+    const uint8_t* A,
+    const uint8_t* B,
+    int32_t* C,
+    size_t PackedCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    const int32_t* RowSumVector,
+    const int32_t* ColumnSumVector,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine is an inner kernel to compute matrix multiplication for a
+    set of rows. The kernel processes up to four rows of matrix A.
+
+Arguments:
+
+    A - Supplies the address of matrix A. The matrix data has been packed
+        using MlasQgemmCopyPackA.
+
+    B - Supplies the address of matrix B. The matrix data has been packed
+        using MlasQgemmCopyPackBAvx2.
+
+    C - Supplies the address of matrix C.
+
+    PackedCountK - Supplies the number of pairs of K values to process.
+
+    CountM - Supplies the maximum number of rows that can be processed for
+        matrix A and matrix C. The actual number of rows handled for this
+        invocation depends on the kernel implementation.
+
+    CountN - Supplies the number of columns from matrix B and matrix C to
+        iterate over.
+
+    lda - Supplies the first dimension of matrix A.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    RowSumVector - Supplies the values to add to each row of matrix C.
+
+    ColumnSumVector - Supplies the values to add to each column of matrix C.
+
+    ZeroMode - Supplies true if the output matrix must be zero initialized,
+        else false if the output matrix is accumulated into.
+
+Return Value:
+
+    Returns the number of rows handled.
+
+--*/
+{
+    size_t RowsHandled;
+
+    if (CountM >= 4) {
+        MlasQgemmKernelAvx2Rows<4, BType>(A, B, C, PackedCountK, CountN, lda, ldc, RowSumVector, ColumnSumVector, ZeroMode);
+        RowsHandled = 4;
+    } else if (CountM >= 2) {
+        MlasQgemmKernelAvx2Rows<2, BType>(A, B, C, PackedCountK, CountN, lda, ldc, RowSumVector, ColumnSumVector, ZeroMode);
+        RowsHandled = 2;
+    } else {
+        MlasQgemmKernelAvx2Rows<1, BType>(A, B, C, PackedCountK, CountN, lda, ldc, RowSumVector, ColumnSumVector, ZeroMode);
+        RowsHandled = 1;
+    }
+
+    return RowsHandled;
+}
+
+const MLAS_QGEMM_KERNEL MlasQgemmU8U8KernelAvx2 = {
+    MlasQgemmCopyPackBAvx2<uint8_t>,
+    MlasQgemmKernelAvx2<uint8_t>,
+    2,
+    0,
+};
+
+const MLAS_QGEMM_KERNEL MlasQgemmU8S8KernelAvx2 = {
+    MlasQgemmCopyPackBAvx2<int8_t>,
+    MlasQgemmKernelAvx2<int8_t>,
+    2,
+    0,
+};
@@ -0,0 +1,546 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    qgemm_kernel_avx512vnni.cpp
+
+Abstract:
+
+    This module implements the QGEMM kernels for AVX512_VNNI.
+
+    The kernels use the 256-bit form of vpdpbusd to multiply unsigned bytes
+    of matrix A with signed bytes of matrix B and accumulate groups of four K
+    values into 32-bit integers without intermediate saturation.
+
+    Unsigned elements of matrix B are packed with their high bit flipped to
+    bias them into the signed range. The bias is removed using the row sums
+    of matrix A (see MLAS_QGEMM_KERNEL::PackedBOffset).
+
+--*/
+
+#include "mlasi.h"
+
+#include <type_traits>
+
+template<typename BType>
+inline
+__m256i
+MlasQgemmQuadSumsAvx512Vnni(
+    __m256i Packed
+    )
+/*++
+
+Routine Description:
+
+    This routine sums the groups of four K values for each of the 8 columns
+    of a half of a packed row of matrix B.
+
+Arguments:
+
+    Packed - Supplies the packed elements before any high bit flipping.
+
+Return Value:
+
+    Returns the 32-bit sums of each column.
+
+--*/
+{
+    const __m256i OnesByte = _mm256_set1_epi8(1);
+    const __m256i OnesWord = _mm256_set1_epi16(1);
+
+    __m256i PairSums;
+
+    if (std::is_signed<BType>::value) {
+        PairSums = _mm256_maddubs_epi16(OnesByte, Packed);
+    } else {
+        PairSums = _mm256_maddubs_epi16(Packed, OnesByte);
+    }
+
+    return _mm256_madd_epi16(PairSums, OnesWord);
+}
+
+template<typename BType>
+void
+MlasQgemmCopyPackBPanelAvx512Vnni(
+    uint8_t* D,
+    const uint8_t* B,
+    size_t ldb,
+    size_t CountK,
+    int32_t* ColumnSumVector
+    )
+/*++
+
+Routine Description:
+
+    This routine copies a panel of 16 columns from the source matrix to the
+    destination packed buffer.
+
+Arguments:
+
+    D - Supplies the address of the destination packed buffer.
+
+    B - Supplies the address of the source matrix.
+
+    ldb - Supplies the number of elements per row of the source matrix.
+
+    CountK - Supplies the number of rows of the source matrix to copy.
+
+    ColumnSumVector - Supplies the address of the buffer that receives the sum
+        of each of the 16 columns.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedCountK =
+        (CountK + MLAS_QGEMM_PACKED_K_ALIGN - 1) & ~(MLAS_QGEMM_PACKED_K_ALIGN - 1);
+
+    const __m256i BitFlip = _mm256_set1_epi8(std::is_signed<BType>::value ? 0 : -128);
+
+    __m256i ColumnSums0 = _mm256_setzero_si256();
+    __m256i ColumnSums1 = _mm256_setzero_si256();
+
+    for (size_t k = 0; k < AlignedCountK; k += 4) {
+
+        __m128i Rows[4];
+
+        for (size_t kk = 0; kk < 4; kk++) {
+            Rows[kk] = (k + kk < CountK) ?
+                _mm_loadu_si128((const __m128i*)(B + kk * ldb)) : _mm_setzero_si128();
+        }
+
+        //
+        // Interleave the four rows so that each column stores a group of four
+        // K values.
+        //
+
+        __m128i Pairs01Low = _mm_unpacklo_epi8(Rows[0], Rows[1]);
+        __m128i Pairs01High = _mm_unpackhi_epi8(Rows[0], Rows[1]);
+        __m128i Pairs23Low = _mm_unpacklo_epi8(Rows[2], Rows[3]);
+        __m128i Pairs23High = _mm_unpackhi_epi8(Rows[2], Rows[3]);
+
+        __m256i Packed0 = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_unpacklo_epi16(Pairs01Low, Pairs23Low)),
+            _mm_unpackhi_epi16(Pairs01Low, Pairs23Low), 1);
+        __m256i Packed1 = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_unpacklo_epi16(Pairs01High, Pairs23High)),
+            _mm_unpackhi_epi16(Pairs01High, Pairs23High), 1);
+
+        ColumnSums0 = _mm256_add_epi32(ColumnSums0, MlasQgemmQuadSumsAvx512Vnni<BType>(Packed0));
+        ColumnSums1 = _mm256_add_epi32(ColumnSums1, MlasQgemmQuadSumsAvx512Vnni<BType>(Packed1));
+
+        _mm256_storeu_si256((__m256i*)D, _mm256_xor_si256(Packed0, BitFlip));
+        _mm256_storeu_si256((__m256i*)(D + 32), _mm256_xor_si256(Packed1, BitFlip));
+
+        B += ldb * 4;
+        D += 64;
+    }
+
+    _mm256_storeu_si256((__m256i*)ColumnSumVector, ColumnSums0);
+    _mm256_storeu_si256((__m256i*)(ColumnSumVector + 8), ColumnSums1);
+}
+
+template<typename BType>
+void
+MLASCALL
+MlasQgemmCopyPackBAvx512Vnni(
+    uint8_t* D,
+    const uint8_t* B,
+    size_t ldb,
+    size_t CountN,
+    size_t CountK,
+    int32_t* ColumnSumVector
+    )
+/*++
+
+Routine Description:
+
+    This routine copies elements from the source matrix to the destination
+    packed buffer.
+
+    Columns of 16 elements from the source matrix are unrolled to be physically
+    contiguous for better locality inside the QGEMM kernels. Groups of four K
+    values for a column are stored next to each other to form the operands of
+    vpdpbusd. Any remaining columns and K values are padded with zeroes.
+
+    Unsigned elements are stored with the high bit flipped, which subtracts
+    128 from each element when the kernel reads it as a signed byte.
+
+Arguments:
+
+    D - Supplies the address of the destination packed buffer.
+
+    B - Supplies the address of the source matrix.
+
+    ldb - Supplies the number of elements per row of the source matrix.
+
+    CountN - Supplies the number of columns of the source matrix to copy.
+
+    CountK - Supplies the number of rows of the source matrix to copy.
+
+    ColumnSumVector - Supplies the address of the buffer that receives the sum
+        of each column of the source matrix, padded to a multiple of 16
+        columns.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedCountK =
+        (CountK + MLAS_QGEMM_PACKED_K_ALIGN - 1) & ~(MLAS_QGEMM_PACKED_K_ALIGN - 1);
+
+    while (CountN >= 16) {
+
+        MlasQgemmCopyPackBPanelAvx512Vnni<BType>(D, B, ldb, CountK, ColumnSumVector);
+
+        D += 16 * AlignedCountK;
+        B += 16;
+        ColumnSumVector += 16;
+        CountN -= 16;
+    }
+
+    //
+    // Copy the remaining columns to a zero padded buffer and pack that as a
+    // full panel.
+    //
+
+    if (CountN > 0) {
+
+        MLAS_DECLSPEC_ALIGN(uint8_t PaddedB[MLAS_QGEMM_STRIDEK * 16], 16);
+
+        for (size_t k = 0; k < CountK; k++) {
+            memset(PaddedB + k * 16, 0, 16);
+            memcpy(PaddedB + k * 16, B + k * ldb, CountN);
+        }
+
+        MlasQgemmCopyPackBPanelAvx512Vnni<BType>(D, PaddedB, 16, CountK, ColumnSumVector);
+    }
+}
+
+inline
+void
+MlasQgemmComputeRowAvx512Vnni(
+    __m256i& Accumulator0,
+    __m256i& Accumulator1,
+    const uint8_t* A,
+    __m256i BElements0,
+    __m256i BElements1
+    )
+/*++
+
+Routine Description:
+
+    This routine multiplies a group of four K values from a row of matrix A
+    with a packed row of matrix B and accumulates the result.
+
+Arguments:
+
+    Accumulator0 - Supplies the accumulator for the first 8 columns.
+
+    Accumulator1 - Supplies the accumulator for the second 8 columns.
+
+    A - Supplies the address of the group of four K values of matrix A.
+
+    BElements0 - Supplies the packed elements for the first 8 columns.
+
+    BElements1 - Supplies the packed elements for the second 8 columns.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    int32_t AQuad;
+    memcpy(&AQuad, A, sizeof(int32_t));
+    __m256i AElements = _mm256_set1_epi32(AQuad);
+
+    Accumulator0 = _mm256_dpbusd_epi32(Accumulator0, AElements, BElements0);
+    Accumulator1 = _mm256_dpbusd_epi32(Accumulator1, AElements, BElements1);
+}
+
+inline
+void
+MlasQgemmStoreRowAvx512Vnni(
+    __m256i Accumulator0,
+    __m256i Accumulator1,
+    int32_t* C,
+    size_t CountColumns,
+    int32_t RowSum,
+    __m256i ColumnSums0,
+    __m256i ColumnSums1,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine adds the row and column sums to the accumulators and stores
+    the result to a row of matrix C.
+
+Arguments:
+
+    Accumulator0 - Supplies the accumulator for the first 8 columns.
+
+    Accumulator1 - Supplies the accumulator for the second 8 columns.
+
+    C - Supplies the address of the row of matrix C.
+
+    CountColumns - Supplies the number of columns to store.
+
+    RowSum - Supplies the value to add to each column of the row.
+
+    ColumnSums0 - Supplies the values to add to the first 8 columns.
+
+    ColumnSums1 - Supplies the values to add to the second 8 columns.
+
+    ZeroMode - Supplies true if the output matrix must be zero initialized,
+        else false if the output matrix is accumulated into.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    __m256i RowSums = _mm256_set1_epi32(RowSum);
+    __m256i Result0 = _mm256_add_epi32(Accumulator0, _mm256_add_epi32(ColumnSums0, RowSums));
+    __m256i Result1 = _mm256_add_epi32(Accumulator1, _mm256_add_epi32(ColumnSums1, RowSums));
+
+    if (CountColumns == 16) {
+
+        if (!ZeroMode) {
+            Result0 = _mm256_add_epi32(Result0, _mm256_loadu_si256((const __m256i*)C));
+            Result1 = _mm256_add_epi32(Result1, _mm256_loadu_si256((const __m256i*)(C + 8)));
+        }
+
+        _mm256_storeu_si256((__m256i*)C, Result0);
+        _mm256_storeu_si256((__m256i*)(C + 8), Result1);
+
+    } else {
+
+        MLAS_DECLSPEC_ALIGN(int32_t Results[16], 32);
+
+        _mm256_store_si256((__m256i*)Results, Result0);
+        _mm256_store_si256((__m256i*)(Results + 8), Result1);
+
+        for (size_t n = 0; n < CountColumns; n++) {
+            C[n] = ZeroMode ? Results[n] : C[n] + Results[n];
+        }
+    }
+}
+
+template<size_t RowCount>
+void
+MlasQgemmKernelAvx512VnniRows(
+    const uint8_t* A,
+    const uint8_t* B,
+    int32_t* C,
+    size_t PackedCountK,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    const int32_t* RowSumVector,
+    const int32_t* ColumnSumVector,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine computes matrix multiplication for the specified number of
+    rows of matrix A.
+
+    The accumulators are declared for the maximum number of rows and are
+    conditionally used based on RowCount so that they are kept in registers.
+
+Arguments:
+
+    See MlasQgemmKernelAvx512Vnni.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    static_assert(RowCount <= 6, "unsupported row count");
+
+    while (CountN > 0) {
+
+        __m256i Accumulator00 = _mm256_setzero_si256();
+        __m256i Accumulator01 = _mm256_setzero_si256();
+        __m256i Accumulator10 = _mm256_setzero_si256();
+        __m256i Accumulator11 = _mm256_setzero_si256();
+        __m256i Accumulator20 = _mm256_setzero_si256();
+        __m256i Accumulator21 = _mm256_setzero_si256();
+        __m256i Accumulator30 = _mm256_setzero_si256();
+        __m256i Accumulator31 = _mm256_setzero_si256();
+        __m256i Accumulator40 = _mm256_setzero_si256();
+        __m256i Accumulator41 = _mm256_setzero_si256();
+        __m256i Accumulator50 = _mm256_setzero_si256();
+        __m256i Accumulator51 = _mm256_setzero_si256();
+
+        const uint8_t* a = A;
+        const uint8_t* b = B;
+
+        for (size_t k = 0; k < PackedCountK; k++) {
+
+            __m256i BElements0 = _mm256_loadu_si256((const __m256i*)b);
+            __m256i BElements1 = _mm256_loadu_si256((const __m256i*)(b + 32));
+
+            MlasQgemmComputeRowAvx512Vnni(Accumulator00, Accumulator01, a, BElements0, BElements1);
+            if (RowCount > 1) {
+                MlasQgemmComputeRowAvx512Vnni(Accumulator10, Accumulator11, a + lda, BElements0, BElements1);
+            }
+            if (RowCount > 2) {
+                MlasQgemmComputeRowAvx512Vnni(Accumulator20, Accumulator21, a + 2 * lda, BElements0, BElements1);
+            }
+            if (RowCount > 3) {
+                MlasQgemmComputeRowAvx512Vnni(Accumulator30, Accumulator31, a + 3 * lda, BElements0, BElements1);
+            }
+            if (RowCount > 4) {
+                MlasQgemmComputeRowAvx512Vnni(Accumulator40, Accumulator41, a + 4 * lda, BElements0, BElements1);
+            }
+            if (RowCount > 5) {
+                MlasQgemmComputeRowAvx512Vnni(Accumulator50, Accumulator51, a + 5 * lda, BElements0, BElements1);
+            }
+
+            a += 4;
+            b += 64;
+        }
+
+        //
+        // Add the row and column sums and store the result to matrix C.
+        //
+
+        __m256i ColumnSums0 = _mm256_loadu_si256((const __m256i*)ColumnSumVector);
+        __m256i ColumnSums1 = _mm256_loadu_si256((const __m256i*)(ColumnSumVector + 8));
+
+        const size_t CountColumns = std::min(CountN, size_t(16));
+
+        MlasQgemmStoreRowAvx512Vnni(Accumulator00, Accumulator01, C, CountColumns,
+            RowSumVector[0], ColumnSums0, ColumnSums1, ZeroMode);
+        if (RowCount > 1) {
+            MlasQgemmStoreRowAvx512Vnni(Accumulator10, Accumulator11, C + ldc, CountColumns,
+                RowSumVector[1], ColumnSums0, ColumnSums1, ZeroMode);
+        }
+        if (RowCount > 2) {
+            MlasQgemmStoreRowAvx512Vnni(Accumulator20, Accumulator21, C + 2 * ldc, CountColumns,
+                RowSumVector[2], ColumnSums0, ColumnSums1, ZeroMode);
+        }
+        if (RowCount > 3) {
+            MlasQgemmStoreRowAvx512Vnni(Accumulator30, Accumulator31, C + 3 * ldc, CountColumns,
+                RowSumVector[3], ColumnSums0, ColumnSums1, ZeroMode);
+        }
+        if (RowCount > 4) {
+            MlasQgemmStoreRowAvx512Vnni(Accumulator40, Accumulator41, C + 4 * ldc, CountColumns,
+                RowSumVector[4], ColumnSums0, ColumnSums1, ZeroMode);
+        }
+        if (RowCount > 5) {
+            MlasQgemmStoreRowAvx512Vnni(Accumulator50, Accumulator51, C + 5 * ldc, CountColumns,
+                RowSumVector[5], ColumnSums0, ColumnSums1, ZeroMode);
+        }
+
+        B += 16 * 4 * PackedCountK;
+        C += CountColumns;
+        ColumnSumVector += 16;
+        CountN -= CountColumns;
+    }
+}
+
+size_t
+MLASCALL
+MlasQgemmKernelAvx512Vnni(
+    const uint8_t* A,
+    const uint8_t* B,
+    int32_t* C,
+    size_t PackedCountK,
+    size_t CountM,
+    size_t CountN,
+    size_t lda,
+    size_t ldc,
+    const int32_t* RowSumVector,
+    const int32_t* ColumnSumVector,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine is an inner kernel to compute matrix multiplication for a
+    set of rows. The kernel processes up to six rows of matrix A.
+
+Arguments:
+
+    A - Supplies the address of matrix A. The matrix data has been packed
+        using MlasQgemmCopyPackA.
+
+    B - Supplies the address of matrix B. The matrix data has been packed
+        using MlasQgemmCopyPackBAvx512Vnni.
+
+    C - Supplies the address of matrix C.
+
+    PackedCountK - Supplies the number of groups of four K values to process.
+
+    CountM - Supplies the maximum number of rows that can be processed for
+        matrix A and matrix C. The actual number of rows handled for this
+        invocation depends on the kernel implementation.
+
+    CountN - Supplies the number of columns from matrix B and matrix C to
+        iterate over.
+
+    lda - Supplies the first dimension of matrix A.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    RowSumVector - Supplies the values to add to each row of matrix C.
+
+    ColumnSumVector - Supplies the values to add to each column of matrix C.
+
+    ZeroMode - Supplies true if the output matrix must be zero initialized,
+        else false if the output matrix is accumulated into.
+
+Return Value:
+
+    Returns the number of rows handled.
+
+--*/
+{
+    size_t RowsHandled;
+
+    if (CountM >= 6) {
+        MlasQgemmKernelAvx512VnniRows<6>(A, B, C, PackedCountK, CountN, lda, ldc, RowSumVector, ColumnSumVector, ZeroMode);
+        RowsHandled = 6;
+    } else if (CountM >= 2) {
+        MlasQgemmKernelAvx512VnniRows<2>(A, B, C, PackedCountK, CountN, lda, ldc, RowSumVector, ColumnSumVector, ZeroMode);
+        RowsHandled = 2;
+    } else {
+        MlasQgemmKernelAvx512VnniRows<1>(A, B, C, PackedCountK, CountN, lda, ldc, RowSumVector, ColumnSumVector, ZeroMode);
+        RowsHandled = 1;
+    }
+
+    return RowsHandled;
+}
+
+const MLAS_QGEMM_KERNEL MlasQgemmU8U8KernelAvx512Vnni = {
+    MlasQgemmCopyPackBAvx512Vnni<uint8_t>,
+    MlasQgemmKernelAvx512Vnni,
+    4,
+    128,
+};
+
+const MLAS_QGEMM_KERNEL MlasQgemmU8S8KernelAvx512Vnni = {
+    MlasQgemmCopyPackBAvx512Vnni<int8_t>,
+    MlasQgemmKernelAvx512Vnni,
+    4,
+    0,
+};
@@ -40,15 +40,43 @@ struct MLAS_SGEMM_WORK_BLOCK {
     size_t ldc;
     float alpha;
     float beta;
+    const float* PackedB;
+    const unsigned short* PackedHalfB;
     struct SEGMENT {
         size_t M;
         size_t N;
         const float* A;
         const float* B;
         float* C;
+        size_t PackedStartN;
     } Segments[MLAS_MAXIMUM_THREAD_COUNT];
 };
 
+//
+// Define the parameters to execute a batch of SGEMM operations on worker
+// threads.
+//
+// The batch is divided into BatchCount * PartitionCount work items, where each
+// operation is partitioned along N (or M) by StrideN (or StrideM). The work
+// items are distributed evenly across ThreadCount iterations.
+//
+
+struct MLAS_SGEMM_BATCH_WORK_BLOCK {
+    CBLAS_TRANSPOSE TransA;
+    CBLAS_TRANSPOSE TransB;
+    size_t M;
+    size_t N;
+    size_t K;
+    float alpha;
+    float beta;
+    const MLAS_SGEMM_DATA_PARAMS* Data;
+    size_t PartitionCount;
+    size_t StrideM;
+    size_t StrideN;
+    size_t WorkItemCount;
+    int32_t ThreadCount;
+};
+
 #if defined(MLAS_TARGET_AMD64_IX86)
 
 //
@@ -772,6 +800,164 @@ Return Value:
     }
 }
 
+void
+MlasSgemmMultiplyPanel(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t CountN,
+    size_t CountK,
+    float alpha,
+    const float* A,
+    size_t lda,
+    size_t k,
+    const float* PanelB,
+    float* C,
+    size_t ldc,
+    bool ZeroMode
+    )
+/*++
+
+Routine Description:
+
+    This routine multiplies all rows of matrix A by a packed panel of matrix
+    B and accumulates the result into matrix C.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    CountN - Supplies the number of columns of the panel and matrix C.
+
+    CountK - Supplies the number of rows of the panel.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    k - Supplies the index of the first row of the panel within matrix B.
+
+    PanelB - Supplies the address of the packed panel of matrix B.
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ZeroMode - Supplies true if the output matrix must be zero initialized,
+        else false if the output matrix is accumulated into.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    //
+    // N.B. The K stride is only expanded beyond MLAS_SGEMM_STRIDEK for a
+    // transposed matrix A when matrix B has been packed ahead of time.
+    //
+
+    float PanelA[MLAS_SGEMM_TRANSA_ROWS * MLAS_SGEMM_PACKED_STRIDEK];
+
+    //
+    // Select the kernel routine to use for this panel.
+    //
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+    PMLAS_SGEMM_KERNEL_ROUTINE SgemmKernelRoutine =
+        ZeroMode ? MlasPlatform.KernelZeroRoutine : MlasPlatform.KernelAddRoutine;
+#endif
+
+    //
+    // Step through each slice of matrix A along the M dimension.
+    //
+
+    float* c = C;
+
+    size_t RowsRemaining = M;
+    size_t RowsHandled;
+
+    if (TransA == CblasNoTrans) {
+
+        const float* a = A + k;
+
+        //
+        // Step through the rows of matrix A.
+        //
+
+        do {
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+            RowsHandled = SgemmKernelRoutine(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+#else
+            if (ZeroMode) {
+                RowsHandled = MlasSgemmKernelZero(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+            } else {
+                RowsHandled = MlasSgemmKernelAdd(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
+            }
+#endif
+
+            c += ldc * RowsHandled;
+            a += lda * RowsHandled;
+
+            RowsRemaining -= RowsHandled;
+
+        } while (RowsRemaining > 0);
+
+    } else {
+
+        const float* a = A + k * lda;
+
+        do {
+
+            //
+            // Transpose elements from matrix A into a local buffer.
+            //
+
+            size_t RowsTransposed = RowsRemaining;
+
+            if (RowsTransposed > MLAS_SGEMM_TRANSA_ROWS) {
+                RowsTransposed = MLAS_SGEMM_TRANSA_ROWS;
+            }
+
+            RowsRemaining -= RowsTransposed;
+
+            MlasSgemmTransposeA(PanelA, a, lda, RowsTransposed, CountK);
+
+            a += RowsTransposed;
+
+            //
+            // Step through the rows of the local buffer.
+            //
+
+            const float* pa = PanelA;
+
+            do {
+
+#if defined(MLAS_TARGET_AMD64_IX86)
+                RowsHandled = SgemmKernelRoutine(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+#else
+                if (ZeroMode) {
+                    RowsHandled = MlasSgemmKernelZero(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+                } else {
+                    RowsHandled = MlasSgemmKernelAdd(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
+                }
+#endif
+
+                c += ldc * RowsHandled;
+                pa += CountK * RowsHandled;
+
+                RowsTransposed -= RowsHandled;
+
+            } while (RowsTransposed > 0);
+
+        } while (RowsRemaining > 0);
+    }
+}
+
 void
 MlasSgemmOperation(
     CBLAS_TRANSPOSE TransA,
@@ -830,7 +1016,6 @@ Return Value:
 
 --*/
 {
-    float PanelA[MLAS_SGEMM_TRANSA_ROWS * MLAS_SGEMM_STRIDEK];
     MLAS_DECLSPEC_ALIGN(float PanelB[MLAS_SGEMM_STRIDEN * MLAS_SGEMM_STRIDEK], 16 * sizeof(float));
 
     //
@@ -931,153 +1116,133 @@ Return Value:
                 MlasSgemmTransposePackB(PanelB, B + k + n * ldb, ldb, CountN, CountK);
             }
 
-            //
-            // Select the kernel routine to use for this panel.
-            //
-
-            bool UseKernelZeroRoutine = (k == 0 && beta == 0.0f);
-
-#if defined(MLAS_TARGET_AMD64_IX86)
-            PMLAS_SGEMM_KERNEL_ROUTINE SgemmKernelRoutine =
-                UseKernelZeroRoutine ? MlasPlatform.KernelZeroRoutine : MlasPlatform.KernelAddRoutine;
-#endif
-
-            //
-            // Step through each slice of matrix A along the M dimension.
-            //
-
-            float* c = C + n;
-
-            size_t RowsRemaining = M;
-            size_t RowsHandled;
-
-            if (TransA == CblasNoTrans) {
+            MlasSgemmMultiplyPanel(TransA, M, CountN, CountK, alpha, A, lda, k, PanelB,
+                C + n, ldc, k == 0 && beta == 0.0f);
+        }
+    }
+}
 
-                const float* a = A + k;
+void
+MlasSgemmPackedOperation(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const float* PackedB,
+    size_t PackedStartN,
+    size_t PackedCountN,
+    float beta,
+    float* C,
+    size_t ldc
+    )
+/*++
 
-                //
-                // Step through the rows of matrix A.
-                //
+Routine Description:
 
-                do {
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) for a matrix B that has been packed by MlasSgemmPackB.
 
-#if defined(MLAS_TARGET_AMD64_IX86)
-                    RowsHandled = SgemmKernelRoutine(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-#else
-                    if (UseKernelZeroRoutine) {
-                        RowsHandled = MlasSgemmKernelZero(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-                    } else {
-                        RowsHandled = MlasSgemmKernelAdd(a, PanelB, c, CountK, RowsRemaining, CountN, lda, ldc, alpha);
-                    }
-#endif
+Arguments:
 
-                    c += ldc * RowsHandled;
-                    a += lda * RowsHandled;
+    TransA - Supplies the transpose operation for matrix A.
 
-                    RowsRemaining -= RowsHandled;
+    M - Supplies the number of rows of matrix A and matrix C.
 
-                } while (RowsRemaining > 0);
+    N - Supplies the number of columns of matrix B and matrix C.
 
-            } else {
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
 
-                const float* a = A + k * lda;
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
 
-                do {
+    A - Supplies the address of matrix A.
 
-                    //
-                    // Transpose elements from matrix A into a local buffer.
-                    //
+    lda - Supplies the first dimension of matrix A.
 
-                    size_t RowsTransposed = RowsRemaining;
+    PackedB - Supplies the address of the packed matrix B.
 
-                    if (RowsTransposed > MLAS_SGEMM_TRANSA_ROWS) {
-                        RowsTransposed = MLAS_SGEMM_TRANSA_ROWS;
-                    }
+    PackedStartN - Supplies the index of the first column of the packed matrix
+        B to multiply. The index must be a multiple of 16.
 
-                    RowsRemaining -= RowsTransposed;
+    PackedCountN - Supplies the number of columns of the packed matrix B,
+        padded to a multiple of 16.
 
-                    MlasSgemmTransposeA(PanelA, a, lda, RowsTransposed, CountK);
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
 
-                    a += RowsTransposed;
+    C - Supplies the address of matrix C.
 
-                    //
-                    // Step through the rows of the local buffer.
-                    //
+    ldc - Supplies the first dimension of matrix C.
 
-                    const float* pa = PanelA;
+Return Value:
 
-                    do {
+    None.
 
-#if defined(MLAS_TARGET_AMD64_IX86)
-                        RowsHandled = SgemmKernelRoutine(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-#else
-                        if (UseKernelZeroRoutine) {
-                            RowsHandled = MlasSgemmKernelZero(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-                        } else {
-                            RowsHandled = MlasSgemmKernelAdd(pa, PanelB, c, CountK, RowsTransposed, CountN, CountK, ldc, alpha);
-                        }
-#endif
+--*/
+{
+    //
+    // Step through each slice of matrix B along the N dimension.
+    //
 
-                        c += ldc * RowsHandled;
-                        pa += CountK * RowsHandled;
+    size_t CountN;
+    size_t CountK;
 
-                        RowsTransposed -= RowsHandled;
+    for (size_t n = 0; n < N; n += CountN) {
 
-                    } while (RowsTransposed > 0);
+        CountN = MLAS_SGEMM_STRIDEN;
 
-                } while (RowsRemaining > 0);
-            }
+        if (CountN > (N - n)) {
+            CountN = N - n;
         }
-    }
-}
-
-void
-MlasSgemmOperationThreaded(
-    void* Context,
-    int32_t Index
-    )
-/*++
 
-Routine Description:
+        //
+        // Multiply the output matrix by beta as needed.
+        //
 
-    This routine is invoked from a worker thread to execute a segment of a
-    SGEMM operation.
+        if (beta != 0.0f && beta != 1.0f) {
+            MlasSgemmMultiplyBeta(C + n, M, CountN, ldc, beta);
+        }
 
-Arguments:
+        //
+        // Step through each slice of matrix B along the K dimension. Each
+        // slice of the packed buffer stores the panels for all columns, so the
+        // panel for this slice of columns is at a fixed offset.
+        //
 
-    Context - Supplies the pointer to the context for the threaded operation.
+        const float* PackedSliceB = PackedB;
 
-    Index - Supplies the current index of the threaded operation.
+        for (size_t k = 0; k < K; k += CountK) {
 
-Return Value:
+            CountK = MLAS_SGEMM_PACKED_STRIDEK;
 
-    None.
+            if (CountK > (K - k)) {
+                CountK = K - k;
+            }
 
---*/
-{
-    MLAS_SGEMM_WORK_BLOCK* WorkBlock = (MLAS_SGEMM_WORK_BLOCK*)Context;
+            const float* PanelB = PackedSliceB + (PackedStartN + n) * CountK;
 
-    MLAS_SGEMM_WORK_BLOCK::SEGMENT* Segment = &WorkBlock->Segments[Index];
+            MlasSgemmMultiplyPanel(TransA, M, CountN, CountK, alpha, A, lda, k, PanelB,
+                C + n, ldc, k == 0 && beta == 0.0f);
 
-    MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, Segment->M,
-        Segment->N, WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
-        Segment->B, WorkBlock->ldb, WorkBlock->beta, Segment->C,
-        WorkBlock->ldc);
+            PackedSliceB += PackedCountN * CountK;
+        }
+    }
 }
 
-inline
-bool
-MlasSgemmTryMultithread(
+void
+MlasSgemmPackedHalfOperation(
     CBLAS_TRANSPOSE TransA,
-    CBLAS_TRANSPOSE TransB,
     size_t M,
     size_t N,
     size_t K,
     float alpha,
     const float* A,
     size_t lda,
-    const float* B,
-    size_t ldb,
+    const unsigned short* PackedB,
+    size_t PackedStartN,
+    size_t PackedCountN,
     float beta,
     float* C,
     size_t ldc
@@ -1086,15 +1251,14 @@ MlasSgemmTryMultithread(
 
 Routine Description:
 
-    This routine attempts to launch a single precision matrix/matrix multiply
-    operation (SGEMM) across multiple threads.
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) for a half precision matrix B that has been packed by
+    MlasSgemmPackBHalf.
 
 Arguments:
 
     TransA - Supplies the transpose operation for matrix A.
 
-    TransB - Supplies the transpose operation for matrix B.
-
     M - Supplies the number of rows of matrix A and matrix C.
 
     N - Supplies the number of columns of matrix B and matrix C.
@@ -1108,9 +1272,13 @@ Arguments:
 
     lda - Supplies the first dimension of matrix A.
 
-    B - Supplies the address of matrix B.
+    PackedB - Supplies the address of the packed matrix B.
 
-    ldb - Supplies the first dimension of matrix B.
+    PackedStartN - Supplies the index of the first column of the packed matrix
+        B to multiply. The index must be a multiple of 16.
+
+    PackedCountN - Supplies the number of columns of the packed matrix B,
+        padded to a multiple of 16.
 
     beta - Supplies the scaler beta multiplier (see SGEMM definition).
 
@@ -1120,35 +1288,260 @@ Arguments:
 
 Return Value:
 
-    Returns true if the operation was completed across multiple threads, else
-    false if the operation should fall back to a single thread.
+    None.
 
 --*/
 {
-
-#if defined(MLAS_HAS_THREADING_SUPPORT)
-
-    MLAS_SGEMM_WORK_BLOCK WorkBlock;
-    int32_t TargetThreadCount;
+    MLAS_DECLSPEC_ALIGN(float PanelB[MLAS_SGEMM_STRIDEN * MLAS_SGEMM_STRIDEK], 16 * sizeof(float));
 
     //
-    // Compute the number of target threads given the complexity of the SGEMM
-    // operation. Small requests should run using the single threaded path.
+    // Step through each slice of matrix B along the N dimension.
     //
 
-    double Complexity = double(M) * double(N) * double(K);
+    size_t CountN;
+    size_t CountK;
 
-    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
-        TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
-    } else {
-        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
-    }
+    for (size_t n = 0; n < N; n += CountN) {
 
-    int32_t MaximumThreadCount = MlasPlatform.GetMaximumThreadCount();
+        CountN = MLAS_SGEMM_STRIDEN;
 
-    if (TargetThreadCount >= MaximumThreadCount) {
-        TargetThreadCount = MaximumThreadCount;
-    }
+        if (CountN > (N - n)) {
+            CountN = N - n;
+        }
+
+        const size_t AlignedCountN = (CountN + 15) & ~size_t(15);
+
+        //
+        // Multiply the output matrix by beta as needed.
+        //
+
+        if (beta != 0.0f && beta != 1.0f) {
+            MlasSgemmMultiplyBeta(C + n, M, CountN, ldc, beta);
+        }
+
+        //
+        // Step through each slice of matrix B along the K dimension. The
+        // packed slices are MLAS_SGEMM_PACKED_STRIDEK rows deep, so convert
+        // each slice to single precision in blocks of MLAS_SGEMM_STRIDEK rows
+        // to bound the size of the local panel.
+        //
+
+        const unsigned short* PackedSliceB = PackedB;
+
+        for (size_t k = 0; k < K; k += CountK) {
+
+            CountK = MLAS_SGEMM_PACKED_STRIDEK;
+
+            if (CountK > (K - k)) {
+                CountK = K - k;
+            }
+
+            const unsigned short* SliceB = PackedSliceB + (PackedStartN + n) * CountK;
+
+            size_t CountBlockK;
+
+            for (size_t kk = 0; kk < CountK; kk += CountBlockK) {
+
+                CountBlockK = MLAS_SGEMM_STRIDEK;
+
+                if (CountBlockK > (CountK - kk)) {
+                    CountBlockK = CountK - kk;
+                }
+
+                //
+                // Each panel of 16 columns stores its rows contiguously, so
+                // convert the rows of this block one panel at a time.
+                //
+
+                for (size_t p = 0; p < AlignedCountN; p += 16) {
+                    MlasConvertHalfToFloatBuffer(SliceB + p * CountK + kk * 16,
+                        PanelB + p * CountBlockK, 16 * CountBlockK);
+                }
+
+                MlasSgemmMultiplyPanel(TransA, M, CountN, CountBlockK, alpha, A, lda,
+                    k + kk, PanelB, C + n, ldc, k + kk == 0 && beta == 0.0f);
+            }
+
+            PackedSliceB += PackedCountN * CountK;
+        }
+    }
+}
+
+void
+MlasSgemmOperationThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    SGEMM operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_SGEMM_WORK_BLOCK* WorkBlock = (MLAS_SGEMM_WORK_BLOCK*)Context;
+
+    MLAS_SGEMM_WORK_BLOCK::SEGMENT* Segment = &WorkBlock->Segments[Index];
+
+    if (WorkBlock->PackedB != nullptr) {
+        MlasSgemmPackedOperation(WorkBlock->TransA, Segment->M, Segment->N,
+            WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
+            WorkBlock->PackedB, Segment->PackedStartN, WorkBlock->ldb,
+            WorkBlock->beta, Segment->C, WorkBlock->ldc);
+        return;
+    }
+
+    if (WorkBlock->PackedHalfB != nullptr) {
+        MlasSgemmPackedHalfOperation(WorkBlock->TransA, Segment->M, Segment->N,
+            WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
+            WorkBlock->PackedHalfB, Segment->PackedStartN, WorkBlock->ldb,
+            WorkBlock->beta, Segment->C, WorkBlock->ldc);
+        return;
+    }
+
+    MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, Segment->M,
+        Segment->N, WorkBlock->K, WorkBlock->alpha, Segment->A, WorkBlock->lda,
+        Segment->B, WorkBlock->ldb, WorkBlock->beta, Segment->C,
+        WorkBlock->ldc);
+}
+
+inline
+int32_t
+MlasSgemmGetTargetThreadCount(
+    double Complexity,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the number of threads to use for a single precision
+    matrix/matrix multiply operation (SGEMM) of the supplied complexity.
+
+Arguments:
+
+    Complexity - Supplies the total number of multiply/add operations.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    Returns the number of target threads.
+
+--*/
+{
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    return TargetThreadCount;
+}
+
+inline
+bool
+MlasSgemmTryMultithread(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const float* B,
+    size_t ldb,
+    const float* PackedB,
+    const unsigned short* PackedHalfB,
+    float beta,
+    float* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine attempts to launch a single precision matrix/matrix multiply
+    operation (SGEMM) across multiple threads.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B. If matrix B has been
+        packed, supplies the number of columns of the packed matrix B.
+
+    PackedB - Supplies the address of the packed matrix B, else nullptr if
+        matrix B is supplied by B and ldb.
+
+    PackedHalfB - Supplies the address of the half precision packed matrix B,
+        else nullptr if matrix B is not packed in half precision.
+
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    Returns true if the operation was completed across multiple threads, else
+    false if the operation should fall back to a single thread.
+
+--*/
+{
+    MLAS_SGEMM_WORK_BLOCK WorkBlock;
+
+    //
+    // Compute the number of target threads given the complexity of the SGEMM
+    // operation. Small requests should run using the single threaded path.
+    //
+
+    int32_t TargetThreadCount = MlasSgemmGetTargetThreadCount(
+        double(M) * double(N) * double(K), ThreadPool);
 
     if (TargetThreadCount == 1) {
         return false;
@@ -1166,6 +1559,8 @@ Return Value:
     WorkBlock.ldc = ldc;
     WorkBlock.alpha = alpha;
     WorkBlock.beta = beta;
+    WorkBlock.PackedB = PackedB;
+    WorkBlock.PackedHalfB = PackedHalfB;
 
     //
     // Segment the operation across multiple threads.
@@ -1199,6 +1594,7 @@ Return Value:
             WorkBlock.Segments[Index].A = A;
             WorkBlock.Segments[Index].B = B + n * pldb;
             WorkBlock.Segments[Index].C = C + n;
+            WorkBlock.Segments[Index].PackedStartN = n;
 
             Index++;
         }
@@ -1226,39 +1622,15 @@ Return Value:
             WorkBlock.Segments[Index].A = A + m * plda;
             WorkBlock.Segments[Index].B = B;
             WorkBlock.Segments[Index].C = C + m * ldc;
+            WorkBlock.Segments[Index].PackedStartN = 0;
 
             Index++;
         }
     }
 
-    MlasExecuteThreaded(MlasSgemmOperationThreaded, &WorkBlock, Index);
+    MlasExecuteThreaded(MlasSgemmOperationThreaded, &WorkBlock, Index, ThreadPool);
 
     return true;
-
-#else
-
-    //
-    // No threading implementation is available.
-    //
-
-    MLAS_UNREFERENCED_PARAMETER(TransA);
-    MLAS_UNREFERENCED_PARAMETER(TransB);
-    MLAS_UNREFERENCED_PARAMETER(M);
-    MLAS_UNREFERENCED_PARAMETER(N);
-    MLAS_UNREFERENCED_PARAMETER(K);
-    MLAS_UNREFERENCED_PARAMETER(alpha);
-    MLAS_UNREFERENCED_PARAMETER(A);
-    MLAS_UNREFERENCED_PARAMETER(lda);
-    MLAS_UNREFERENCED_PARAMETER(B);
-    MLAS_UNREFERENCED_PARAMETER(ldb);
-    MLAS_UNREFERENCED_PARAMETER(beta);
-    MLAS_UNREFERENCED_PARAMETER(C);
-    MLAS_UNREFERENCED_PARAMETER(ldc);
-
-    return false;
-
-#endif
-
 }
 
 void
@@ -1276,7 +1648,8 @@ MlasSgemm(
     size_t ldb,
     float beta,
     float* C,
-    size_t ldc
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
     )
 /*++
 
@@ -1314,6 +1687,9 @@ Arguments:
 
     ldc - Supplies the first dimension of matrix C.
 
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
 Return Value:
 
     None.
@@ -1325,7 +1701,543 @@ Return Value:
     // single thread based on the GEMM parameters and system configuration.
     //
 
-    if (!MlasSgemmTryMultithread(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc)) {
+    if (!MlasSgemmTryMultithread(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, nullptr, nullptr, beta, C, ldc,
+        ThreadPool)) {
         MlasSgemmOperation(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
     }
 }
+
+void
+MlasSgemmBatchOperationThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a range of the
+    work items of a batched SGEMM operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_SGEMM_BATCH_WORK_BLOCK* WorkBlock = (MLAS_SGEMM_BATCH_WORK_BLOCK*)Context;
+
+    const size_t ThreadCount = size_t(WorkBlock->ThreadCount);
+    const size_t WorkItemStart = (WorkBlock->WorkItemCount * size_t(Index)) / ThreadCount;
+    const size_t WorkItemEnd = (WorkBlock->WorkItemCount * (size_t(Index) + 1)) / ThreadCount;
+
+    for (size_t WorkItem = WorkItemStart; WorkItem < WorkItemEnd; WorkItem++) {
+
+        const MLAS_SGEMM_DATA_PARAMS* Data = &WorkBlock->Data[WorkItem / WorkBlock->PartitionCount];
+        const size_t Partition = WorkItem % WorkBlock->PartitionCount;
+
+        //
+        // Compute the slice of matrix C that is produced by this partition.
+        //
+
+        const size_t m = Partition * WorkBlock->StrideM;
+        const size_t n = Partition * WorkBlock->StrideN;
+
+        if (m >= WorkBlock->M || n >= WorkBlock->N) {
+            continue;
+        }
+
+        const size_t CountM = std::min(WorkBlock->M - m, (WorkBlock->StrideM != 0) ? WorkBlock->StrideM : WorkBlock->M);
+        const size_t CountN = std::min(WorkBlock->N - n, (WorkBlock->StrideN != 0) ? WorkBlock->StrideN : WorkBlock->N);
+
+        const size_t plda = (WorkBlock->TransA == CblasNoTrans) ? Data->lda : 1;
+        const size_t pldb = (WorkBlock->TransB == CblasNoTrans) ? 1 : Data->ldb;
+
+        MlasSgemmOperation(WorkBlock->TransA, WorkBlock->TransB, CountM, CountN,
+            WorkBlock->K, WorkBlock->alpha, Data->A + m * plda, Data->lda,
+            Data->B + n * pldb, Data->ldb, WorkBlock->beta,
+            Data->C + m * Data->ldc + n, Data->ldc);
+    }
+}
+
+void
+MLASCALL
+MlasSgemmBatch(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const MLAS_SGEMM_DATA_PARAMS* Data,
+    float beta,
+    size_t BatchCount,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements a batch of single precision matrix/matrix multiply
+    operations (SGEMM) that share the same shape and scalar multipliers.
+
+    The batch is executed using a single threaded dispatch, so that a batch of
+    small operations is not bound by the overhead of dispatching each
+    operation separately.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for each matrix A.
+
+    TransB - Supplies the transpose operation for each matrix B.
+
+    M - Supplies the number of rows of each matrix A and matrix C.
+
+    N - Supplies the number of columns of each matrix B and matrix C.
+
+    K - Supplies the number of columns of each matrix A and the number of rows
+        of each matrix B.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    Data - Supplies the array of matrix addresses and leading dimensions for
+        each operation of the batch. The matrix C of each operation must not
+        overlap the matrix C of any other operation.
+
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
+
+    BatchCount - Supplies the number of operations in the batch.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_SGEMM_BATCH_WORK_BLOCK WorkBlock;
+
+    if (BatchCount == 0) {
+        return;
+    }
+
+    //
+    // Compute the number of target threads given the complexity of the entire
+    // batch.
+    //
+
+    int32_t TargetThreadCount = MlasSgemmGetTargetThreadCount(
+        double(M) * double(N) * double(K) * double(BatchCount), ThreadPool);
+
+    //
+    // Partition each operation if there are fewer operations in the batch
+    // than target threads. Partition along the larger of the M and N
+    // dimensions using the same alignment as a single SGEMM operation.
+    //
+
+    size_t PartitionCount = (size_t(TargetThreadCount) + BatchCount - 1) / BatchCount;
+
+    WorkBlock.StrideM = 0;
+    WorkBlock.StrideN = 0;
+
+    if (PartitionCount > 1) {
+
+        if (N > M) {
+
+            size_t StrideN = (N + PartitionCount - 1) / PartitionCount;
+
+            StrideN =
+                (StrideN + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+            PartitionCount = (N + StrideN - 1) / StrideN;
+            WorkBlock.StrideN = StrideN;
+
+        } else {
+
+            size_t StrideM = (M + PartitionCount - 1) / PartitionCount;
+
+            PartitionCount = (M + StrideM - 1) / StrideM;
+            WorkBlock.StrideM = StrideM;
+        }
+    }
+
+    WorkBlock.TransA = TransA;
+    WorkBlock.TransB = TransB;
+    WorkBlock.M = M;
+    WorkBlock.N = N;
+    WorkBlock.K = K;
+    WorkBlock.alpha = alpha;
+    WorkBlock.beta = beta;
+    WorkBlock.Data = Data;
+    WorkBlock.PartitionCount = PartitionCount;
+    WorkBlock.WorkItemCount = BatchCount * PartitionCount;
+
+    if (size_t(TargetThreadCount) > WorkBlock.WorkItemCount) {
+        TargetThreadCount = int32_t(WorkBlock.WorkItemCount);
+    }
+
+    WorkBlock.ThreadCount = TargetThreadCount;
+
+    MlasExecuteThreaded(MlasSgemmBatchOperationThreaded, &WorkBlock, TargetThreadCount, ThreadPool);
+}
+
+size_t
+MLASCALL
+MlasSgemmPackBSize(
+    size_t N,
+    size_t K
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the number of bytes required to pack matrix B with
+    MlasSgemmPackB.
+
+Arguments:
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+Return Value:
+
+    Returns the size in bytes of the packed buffer.
+
+--*/
+{
+    const size_t AlignedN =
+        (N + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+    return AlignedN * K * sizeof(float);
+}
+
+void
+MLASCALL
+MlasSgemmPackB(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const float* B,
+    size_t ldb,
+    void* PackedB
+    )
+/*++
+
+Routine Description:
+
+    This routine packs matrix B into the format consumed by the SGEMM kernels
+    so that MlasSgemmPackedB can skip copying matrix B on every call.
+
+    The packed buffer stores slices of MLAS_SGEMM_PACKED_STRIDEK rows. Each
+    slice holds the panels of 16 columns for all columns of matrix B, so any
+    range of columns starting at a multiple of 16 is contiguous.
+
+Arguments:
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    PackedB - Supplies the address of the packed buffer. The buffer must be
+        at least MlasSgemmPackBSize bytes and aligned to 64 bytes.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedN =
+        (N + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+    float* D = (float*)PackedB;
+
+    for (size_t CountK, k = 0; k < K; k += CountK) {
+
+        CountK = MLAS_SGEMM_PACKED_STRIDEK;
+
+        if (CountK > (K - k)) {
+            CountK = K - k;
+        }
+
+        if (TransB == CblasNoTrans) {
+            MlasSgemmCopyPackB(D, B + k * ldb, ldb, N, CountK);
+        } else {
+            MlasSgemmTransposePackB(D, B + k, ldb, N, CountK);
+        }
+
+        D += AlignedN * CountK;
+    }
+}
+
+void
+MLASCALL
+MlasSgemmPackedB(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) for a matrix B that has been packed by MlasSgemmPackB.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    PackedB - Supplies the address of the packed matrix B.
+
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedN =
+        (N + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+    //
+    // Try to run the operation across multiple threads or fall back to a
+    // single thread based on the GEMM parameters and system configuration.
+    //
+
+    if (!MlasSgemmTryMultithread(TransA, CblasNoTrans, M, N, K, alpha, A, lda, (const float*)PackedB,
+        AlignedN, (const float*)PackedB, nullptr, beta, C, ldc, ThreadPool)) {
+        MlasSgemmPackedOperation(TransA, M, N, K, alpha, A, lda, (const float*)PackedB, 0,
+            AlignedN, beta, C, ldc);
+    }
+}
+
+size_t
+MLASCALL
+MlasSgemmPackBHalfSize(
+    size_t N,
+    size_t K
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the number of bytes required to pack a half
+    precision matrix B with MlasSgemmPackBHalf.
+
+Arguments:
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+Return Value:
+
+    Returns the size in bytes of the packed buffer.
+
+--*/
+{
+    const size_t AlignedN =
+        (N + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+    return AlignedN * K * sizeof(unsigned short);
+}
+
+void
+MLASCALL
+MlasSgemmPackBHalf(
+    CBLAS_TRANSPOSE TransB,
+    size_t N,
+    size_t K,
+    const unsigned short* B,
+    size_t ldb,
+    void* PackedB
+    )
+/*++
+
+Routine Description:
+
+    This routine packs a half precision matrix B into the layout produced by
+    MlasSgemmPackB, keeping the elements in half precision, so that
+    MlasSgemmPackedBHalf can stream half of the bytes of a single precision
+    packed matrix.
+
+    Packing is a one time operation for constant weights, so the elements are
+    simply gathered into place.
+
+Arguments:
+
+    TransB - Supplies the transpose operation for matrix B.
+
+    N - Supplies the number of columns of matrix B.
+
+    K - Supplies the number of rows of matrix B.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    PackedB - Supplies the address of the packed buffer. The buffer must be
+        at least MlasSgemmPackBHalfSize bytes and aligned to 64 bytes.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedN =
+        (N + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+    unsigned short* D = (unsigned short*)PackedB;
+
+    for (size_t CountK, k = 0; k < K; k += CountK) {
+
+        CountK = MLAS_SGEMM_PACKED_STRIDEK;
+
+        if (CountK > (K - k)) {
+            CountK = K - k;
+        }
+
+        //
+        // Store the rows of each panel of 16 columns contiguously. Columns
+        // beyond N are zero padded.
+        //
+
+        for (size_t n = 0; n < AlignedN; n += 16) {
+
+            for (size_t y = 0; y < CountK; y++) {
+
+                for (size_t x = 0; x < 16; x++) {
+
+                    unsigned short Value = 0;
+
+                    if (n + x < N) {
+                        Value = (TransB == CblasNoTrans) ? B[(k + y) * ldb + n + x] :
+                            B[(n + x) * ldb + k + y];
+                    }
+
+                    *D++ = Value;
+                }
+            }
+        }
+    }
+}
+
+void
+MLASCALL
+MlasSgemmPackedBHalf(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    float beta,
+    float* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision matrix/matrix multiply
+    operation (SGEMM) for a half precision matrix B that has been packed by
+    MlasSgemmPackBHalf.
+
+Arguments:
+
+    TransA - Supplies the transpose operation for matrix A.
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    K - Supplies the number of columns of matrix A and the number of rows of
+        matrix B.
+
+    alpha - Supplies the scaler alpha multiplier (see SGEMM definition).
+
+    A - Supplies the address of matrix A.
+
+    lda - Supplies the first dimension of matrix A.
+
+    PackedB - Supplies the address of the packed matrix B.
+
+    beta - Supplies the scaler beta multiplier (see SGEMM definition).
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t AlignedN =
+        (N + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+    //
+    // Try to run the operation across multiple threads or fall back to a
+    // single thread based on the GEMM parameters and system configuration.
+    //
+
+    if (!MlasSgemmTryMultithread(TransA, CblasNoTrans, M, N, K, alpha, A, lda, (const float*)PackedB,
+        AlignedN, nullptr, (const unsigned short*)PackedB, beta, C, ldc, ThreadPool)) {
+        MlasSgemmPackedHalfOperation(TransA, M, N, K, alpha, A, lda,
+            (const unsigned short*)PackedB, 0, AlignedN, beta, C, ldc);
+    }
+}
@@ -0,0 +1,829 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    snchwc.cpp
+
+Abstract:
+
+    This module implements the single precision operations using the channel
+    blocked (NCHWc) tensor format.
+
+    A NCHWc tensor stores the channels in blocks sized to the width of the
+    vector registers, so the convolution and pooling kernels operate directly
+    on the tensor without expanding the input into a working buffer.
+
+--*/
+
+#include "snchwc_kernel.h"
+
+//
+// Define the portable NCHWc convolution kernel using the 128-bit vector
+// intrinsics.
+//
+
+struct MLAS_NCHWC_KERNEL_TRAITS_DEFAULT {
+
+    typedef MLAS_FLOAT32X4 VectorType;
+
+    static constexpr size_t VectorLength = 4;
+
+    static VectorType Zero(void)
+    {
+        return MlasZeroFloat32x4();
+    }
+
+    static VectorType Load(const float* Buffer)
+    {
+        return MlasLoadFloat32x4(Buffer);
+    }
+
+    static void Store(float* Buffer, VectorType Vector)
+    {
+        MlasStoreFloat32x4(Buffer, Vector);
+    }
+
+    static VectorType Broadcast(float Value)
+    {
+        return MlasBroadcastFloat32x4(Value);
+    }
+
+    static VectorType MultiplyAdd(VectorType Vector1, VectorType Vector2, VectorType Vector3)
+    {
+        return MlasMultiplyAddFloat32x4(Vector1, Vector2, Vector3);
+    }
+};
+
+void
+MLASCALL
+MlasConvNchwcKernel(
+    const MLAS_NCHWC_CONV_WORK_BLOCK* WorkBlock,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    size_t FilterCount,
+    size_t OutputRow
+    )
+/*++
+
+Routine Description:
+
+    This routine computes one output row of a NCHWc convolution using the
+    portable vector intrinsics.
+
+Arguments:
+
+    See MLAS_CONV_NCHWC_KERNEL_ROUTINE.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasConvNchwcKernelTemplate<MLAS_NCHWC_KERNEL_TRAITS_DEFAULT, 8>(WorkBlock,
+        Input, Filter, Bias, Output, FilterCount, OutputRow);
+}
+
+//
+// Define the parameters to execute segments of a NCHWc pooling operation on
+// worker threads.
+//
+
+struct MLAS_NCHWC_POOL_WORK_BLOCK {
+    MLAS_POOLING_KIND PoolingKind;
+    const float* Input;
+    float* Output;
+    size_t TotalChannelBlockCount;
+    size_t InputShape[2];
+    size_t InputSize;
+    size_t KernelShape[2];
+    size_t Padding[4];
+    size_t StrideShape[2];
+    size_t OutputShape[2];
+    size_t OutputSize;
+    int32_t TargetThreadCount;
+};
+
+void
+MlasNchwcPartitionWork(
+    int32_t Index,
+    int32_t TargetThreadCount,
+    size_t TotalWork,
+    size_t* WorkIndex,
+    size_t* WorkRemaining
+    )
+/*++
+
+Routine Description:
+
+    This routine partitions a range of work items across the threads of a
+    threaded operation.
+
+Arguments:
+
+    Index - Supplies the current index of the threaded operation.
+
+    TargetThreadCount - Supplies the number of threads of the operation.
+
+    TotalWork - Supplies the total number of work items.
+
+    WorkIndex - Receives the index of the first work item for this thread.
+
+    WorkRemaining - Receives the number of work items for this thread.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t WorkPerThread = TotalWork / size_t(TargetThreadCount);
+    const size_t WorkPerThreadExtra = TotalWork % size_t(TargetThreadCount);
+
+    if (size_t(Index) < WorkPerThreadExtra) {
+        *WorkIndex = (WorkPerThread + 1) * Index;
+        *WorkRemaining = WorkPerThread + 1;
+    } else {
+        *WorkIndex = WorkPerThread * Index + WorkPerThreadExtra;
+        *WorkRemaining = WorkPerThread;
+    }
+}
+
+size_t
+MLASCALL
+MlasNchwcGetBlockSize(
+    void
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the number of channels in a block of a NCHWc tensor
+    for this platform.
+
+Arguments:
+
+    None.
+
+Return Value:
+
+    Returns the block size.
+
+--*/
+{
+    return MlasPlatform.NchwcBlockSize;
+}
+
+void
+MlasNchwcConvThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    NCHWc convolution operation.
+
+    The work is divided into output rows for each batch and each set of
+    filter blocks. Consecutive rows of a thread share the same filter set.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_NCHWC_CONV_WORK_BLOCK* WorkBlock = (MLAS_NCHWC_CONV_WORK_BLOCK*)Context;
+
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+    const PMLAS_CONV_NCHWC_KERNEL_ROUTINE ConvNchwcKernelRoutine = MlasPlatform.ConvNchwcKernelRoutine;
+
+    const size_t InputChannels = WorkBlock->InputChannels;
+    const size_t InputSize = WorkBlock->InputSize;
+    const size_t FilterCount = WorkBlock->FilterCount;
+    const size_t KernelSize = WorkBlock->KernelShape[0] * WorkBlock->KernelShape[1];
+    const size_t OutputHeight = WorkBlock->OutputShape[0];
+    const size_t OutputWidth = WorkBlock->OutputShape[1];
+    const size_t OutputSize = WorkBlock->OutputSize;
+
+    const size_t FilterBlockCount = FilterCount / BlockSize;
+    const size_t FilterSetCount = (FilterBlockCount + MLAS_NCHWC_FILTER_SET_SIZE - 1) / MLAS_NCHWC_FILTER_SET_SIZE;
+
+    const MLAS_ACTIVATION* Activation = WorkBlock->Activation;
+    const bool ApplyActivation = (Activation->ActivationKind != MlasIdentityActivation);
+
+    size_t WorkIndex;
+    size_t WorkRemaining;
+
+    MlasNchwcPartitionWork(Index, WorkBlock->TargetThreadCount,
+        WorkBlock->BatchCount * FilterSetCount * OutputHeight, &WorkIndex, &WorkRemaining);
+
+    size_t ph = WorkIndex % OutputHeight;
+    size_t FilterSet = (WorkIndex / OutputHeight) % FilterSetCount;
+    size_t BatchIndex = WorkIndex / OutputHeight / FilterSetCount;
+
+    while (WorkRemaining > 0) {
+
+        const size_t FilterBlockStart = FilterSet * MLAS_NCHWC_FILTER_SET_SIZE;
+        const size_t FilterBlockSetCount = std::min(FilterBlockCount - FilterBlockStart, size_t(MLAS_NCHWC_FILTER_SET_SIZE));
+
+        const float* input = WorkBlock->Input + BatchIndex * InputChannels * InputSize;
+        const float* filter = WorkBlock->Filter + FilterBlockStart * BlockSize * InputChannels * KernelSize;
+        const float* bias = (WorkBlock->Bias != nullptr) ? WorkBlock->Bias + FilterBlockStart * BlockSize : nullptr;
+        float* output = WorkBlock->Output + (BatchIndex * FilterCount + FilterBlockStart * BlockSize) * OutputSize;
+
+        //
+        // Compute the rows of this filter set that are assigned to this
+        // thread.
+        //
+
+        size_t RowCount = std::min(OutputHeight - ph, WorkRemaining);
+
+        for (size_t row = ph; row < ph + RowCount; row++) {
+
+            ConvNchwcKernelRoutine(WorkBlock, input, filter, bias, output, FilterBlockSetCount, row);
+
+            //
+            // Apply the activation to the output row while it is still in
+            // the cache.
+            //
+
+            if (ApplyActivation) {
+
+                const size_t RowElements = OutputWidth * BlockSize;
+                float* OutputRow = output + row * RowElements;
+
+                MlasActivation(Activation, OutputRow, nullptr, FilterBlockSetCount,
+                    OutputRow, RowElements, OutputSize * BlockSize);
+            }
+        }
+
+        WorkRemaining -= RowCount;
+        ph = 0;
+
+        if (++FilterSet == FilterSetCount) {
+            FilterSet = 0;
+            BatchIndex++;
+        }
+    }
+}
+
+void
+MLASCALL
+MlasNchwcConv(
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    const MLAS_ACTIVATION* Activation,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the NCHWc convolution operation for two
+    dimensional images.
+
+    The input is in NCHWc format if the number of input channels is a
+    multiple of the block size, else the input is in NCHW format. The output
+    is always in NCHWc format and the number of output channels must be a
+    multiple of the block size.
+
+Arguments:
+
+    InputShape - Supplies the shape of the input tensor (N, C, H, W).
+
+    KernelShape - Supplies the shape of the kernel.
+
+    DilationShape - Supplies the shape of the dilation.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        tensor.
+
+    StrideShape - Supplies the shape of the stride.
+
+    OutputShape - Supplies the shape of the output tensor (N, M, H, W).
+
+    Input - Supplies the input tensor.
+
+    Filter - Supplies the filter tensor, reordered by MlasReorderFilterOIHWBo
+        for NCHW input or by MlasReorderFilterOIHWBiBo for NCHWc input.
+
+    Bias - Optionally supplies the bias vector.
+
+    Output - Supplies the output tensor.
+
+    Activation - Supplies the parameters for the activation to apply to the
+        output.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_NCHWC_CONV_WORK_BLOCK WorkBlock;
+
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    WorkBlock.Input = Input;
+    WorkBlock.Filter = Filter;
+    WorkBlock.Bias = Bias;
+    WorkBlock.Output = Output;
+    WorkBlock.Activation = Activation;
+
+    WorkBlock.BatchCount = size_t(InputShape[0]);
+    WorkBlock.InputChannels = size_t(InputShape[1]);
+    WorkBlock.FilterCount = size_t(OutputShape[1]);
+    WorkBlock.InputIsNchw = (WorkBlock.InputChannels % BlockSize) != 0;
+
+    for (size_t dim = 0; dim < 2; dim++) {
+        WorkBlock.InputShape[dim] = size_t(InputShape[dim + 2]);
+        WorkBlock.OutputShape[dim] = size_t(OutputShape[dim + 2]);
+        WorkBlock.KernelShape[dim] = size_t(KernelShape[dim]);
+        WorkBlock.DilationShape[dim] = size_t(DilationShape[dim]);
+        WorkBlock.Padding[dim] = size_t(Padding[dim]);
+        WorkBlock.Padding[dim + 2] = size_t(Padding[dim + 2]);
+        WorkBlock.StrideShape[dim] = size_t(StrideShape[dim]);
+    }
+
+    WorkBlock.InputSize = WorkBlock.InputShape[0] * WorkBlock.InputShape[1];
+    WorkBlock.OutputSize = WorkBlock.OutputShape[0] * WorkBlock.OutputShape[1];
+
+    //
+    // Compute the number of threads from the complexity of the operation.
+    //
+
+    const size_t FilterBlockCount = WorkBlock.FilterCount / BlockSize;
+    const size_t FilterSetCount = (FilterBlockCount + MLAS_NCHWC_FILTER_SET_SIZE - 1) / MLAS_NCHWC_FILTER_SET_SIZE;
+    const size_t TotalWork = WorkBlock.BatchCount * FilterSetCount * WorkBlock.OutputShape[0];
+
+    const double Complexity = double(WorkBlock.BatchCount) * double(WorkBlock.FilterCount) *
+        double(WorkBlock.OutputSize) * double(WorkBlock.InputChannels) *
+        double(WorkBlock.KernelShape[0] * WorkBlock.KernelShape[1]);
+
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (size_t(TargetThreadCount) >= TotalWork) {
+        TargetThreadCount = int32_t(TotalWork);
+    }
+
+    if (TargetThreadCount == 0) {
+        return;
+    }
+
+    WorkBlock.TargetThreadCount = TargetThreadCount;
+
+    MlasExecuteThreaded(MlasNchwcConvThreaded, &WorkBlock, TargetThreadCount, ThreadPool);
+}
+
+void
+MlasNchwcPoolThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    NCHWc pooling operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_NCHWC_POOL_WORK_BLOCK* WorkBlock = (MLAS_NCHWC_POOL_WORK_BLOCK*)Context;
+
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const MLAS_POOLING_KIND PoolingKind = WorkBlock->PoolingKind;
+
+    const size_t InputHeight = WorkBlock->InputShape[0];
+    const size_t InputWidth = WorkBlock->InputShape[1];
+    const size_t InputSize = WorkBlock->InputSize;
+    const size_t KernelHeight = WorkBlock->KernelShape[0];
+    const size_t KernelWidth = WorkBlock->KernelShape[1];
+    const size_t PaddingLeftY = WorkBlock->Padding[0];
+    const size_t PaddingLeftX = WorkBlock->Padding[1];
+    const size_t StrideHeight = WorkBlock->StrideShape[0];
+    const size_t StrideWidth = WorkBlock->StrideShape[1];
+    const size_t OutputHeight = WorkBlock->OutputShape[0];
+    const size_t OutputWidth = WorkBlock->OutputShape[1];
+    const size_t OutputSize = WorkBlock->OutputSize;
+
+    const MLAS_FLOAT32X4 KernelSizeBroadcast = MlasBroadcastFloat32x4(float(unsigned(KernelHeight * KernelWidth)));
+
+    size_t WorkIndex;
+    size_t WorkRemaining;
+
+    MlasNchwcPartitionWork(Index, WorkBlock->TargetThreadCount,
+        WorkBlock->TotalChannelBlockCount * OutputHeight, &WorkIndex, &WorkRemaining);
+
+    while (WorkRemaining-- > 0) {
+
+        const size_t ChannelBlock = WorkIndex / OutputHeight;
+        const size_t ph = WorkIndex % OutputHeight;
+
+        const float* input = WorkBlock->Input + ChannelBlock * InputSize * BlockSize;
+        float* output = WorkBlock->Output + (ChannelBlock * OutputSize + ph * OutputWidth) * BlockSize;
+
+        //
+        // Compute the range of input rows for this output row, clipped to
+        // the bounds of the input image.
+        //
+
+        const int64_t ihStart64 = int64_t(ph * StrideHeight) - int64_t(PaddingLeftY);
+        const size_t ihStart = size_t(std::max(ihStart64, int64_t(0)));
+        const size_t ihEnd = size_t(std::min(ihStart64 + int64_t(KernelHeight), int64_t(InputHeight)));
+
+        for (size_t pw = 0; pw < OutputWidth; pw++) {
+
+            const int64_t iwStart64 = int64_t(pw * StrideWidth) - int64_t(PaddingLeftX);
+            const size_t iwStart = size_t(std::max(iwStart64, int64_t(0)));
+            const size_t iwEnd = size_t(std::min(iwStart64 + int64_t(KernelWidth), int64_t(InputWidth)));
+
+            const size_t ValidCount = (ihEnd - ihStart) * (iwEnd - iwStart);
+
+            for (size_t v = 0; v < BlockSize; v += 4) {
+
+                MLAS_FLOAT32X4 Reduction = (PoolingKind == MlasMaximumPooling) ?
+                    MlasBroadcastFloat32x4(std::numeric_limits<float>::lowest()) :
+                    MlasZeroFloat32x4();
+
+                for (size_t ih = ihStart; ih < ihEnd; ih++) {
+
+                    const float* row = input + ih * InputWidth * BlockSize + v;
+
+                    for (size_t iw = iwStart; iw < iwEnd; iw++) {
+
+                        MLAS_FLOAT32X4 InputValue = MlasLoadFloat32x4(row + iw * BlockSize);
+
+                        if (PoolingKind == MlasMaximumPooling) {
+                            Reduction = MlasMaximumFloat32x4(Reduction, InputValue);
+                        } else {
+                            Reduction = MlasAddFloat32x4(Reduction, InputValue);
+                        }
+                    }
+                }
+
+                if (PoolingKind == MlasAveragePoolingExcludePad) {
+                    Reduction = MlasDivideFloat32x4(Reduction, MlasBroadcastFloat32x4(float(unsigned(ValidCount))));
+                } else if (PoolingKind == MlasAveragePoolingIncludePad) {
+                    Reduction = MlasDivideFloat32x4(Reduction, KernelSizeBroadcast);
+                }
+
+                MlasStoreFloat32x4(output + v, Reduction);
+            }
+
+            output += BlockSize;
+        }
+
+        WorkIndex++;
+    }
+}
+
+void
+MLASCALL
+MlasNchwcPool(
+    MLAS_POOLING_KIND PoolingKind,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    const float* Input,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the NCHWc pooling operation for two dimensional
+    images.
+
+Arguments:
+
+    PoolingKind - Supplies the kind of pooling operation to perform.
+
+    InputShape - Supplies the shape of the input tensor (N, C, H, W).
+
+    KernelShape - Supplies the shape of the kernel, else nullptr to perform a
+        global pooling operation.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        tensor. Ignored for global pooling.
+
+    StrideShape - Supplies the shape of the stride. Ignored for global
+        pooling.
+
+    OutputShape - Supplies the shape of the output tensor (N, C, H, W).
+
+    Input - Supplies the input tensor.
+
+    Output - Supplies the output tensor.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_NCHWC_POOL_WORK_BLOCK WorkBlock;
+
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    WorkBlock.PoolingKind = PoolingKind;
+    WorkBlock.Input = Input;
+    WorkBlock.Output = Output;
+    WorkBlock.TotalChannelBlockCount = size_t(InputShape[0]) * size_t(InputShape[1]) / BlockSize;
+
+    for (size_t dim = 0; dim < 2; dim++) {
+
+        WorkBlock.InputShape[dim] = size_t(InputShape[dim + 2]);
+        WorkBlock.OutputShape[dim] = size_t(OutputShape[dim + 2]);
+
+        if (KernelShape != nullptr) {
+            WorkBlock.KernelShape[dim] = size_t(KernelShape[dim]);
+            WorkBlock.Padding[dim] = size_t(Padding[dim]);
+            WorkBlock.Padding[dim + 2] = size_t(Padding[dim + 2]);
+            WorkBlock.StrideShape[dim] = size_t(StrideShape[dim]);
+        } else {
+            WorkBlock.KernelShape[dim] = WorkBlock.InputShape[dim];
+            WorkBlock.Padding[dim] = 0;
+            WorkBlock.Padding[dim + 2] = 0;
+            WorkBlock.StrideShape[dim] = 1;
+        }
+    }
+
+    WorkBlock.InputSize = WorkBlock.InputShape[0] * WorkBlock.InputShape[1];
+    WorkBlock.OutputSize = WorkBlock.OutputShape[0] * WorkBlock.OutputShape[1];
+
+    //
+    // Use one thread per channel block row up to the maximum thread count.
+    //
+
+    const size_t TotalWork = WorkBlock.TotalChannelBlockCount * WorkBlock.OutputShape[0];
+
+    int32_t TargetThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (size_t(TargetThreadCount) >= TotalWork) {
+        TargetThreadCount = int32_t(TotalWork);
+    }
+
+    if (TargetThreadCount == 0) {
+        return;
+    }
+
+    WorkBlock.TargetThreadCount = TargetThreadCount;
+
+    MlasExecuteThreaded(MlasNchwcPoolThreaded, &WorkBlock, TargetThreadCount, ThreadPool);
+}
+
+void
+MLASCALL
+MlasReorderInput(
+    const int64_t* InputShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders an input tensor from NCHW format to NCHWc format.
+
+Arguments:
+
+    InputShape - Supplies the shape of the input tensor (N, C, H, W). The
+        number of channels must be a multiple of the block size.
+
+    S - Supplies the address of the source tensor.
+
+    D - Supplies the address of the destination tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t TotalChannelBlockCount = size_t(InputShape[0]) * size_t(InputShape[1]) / BlockSize;
+    const size_t InputSize = size_t(InputShape[2]) * size_t(InputShape[3]);
+
+    for (size_t cb = 0; cb < TotalChannelBlockCount; cb++) {
+
+        for (size_t i = 0; i < InputSize; i++) {
+
+            const float* s = S + i;
+
+            for (size_t bc = 0; bc < BlockSize; bc++) {
+                *D++ = *s;
+                s += InputSize;
+            }
+        }
+
+        S += BlockSize * InputSize;
+    }
+}
+
+void
+MLASCALL
+MlasReorderOutput(
+    const int64_t* OutputShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders an output tensor from NCHWc format to NCHW format.
+
+Arguments:
+
+    OutputShape - Supplies the shape of the output tensor (N, C, H, W). The
+        number of channels must be a multiple of the block size.
+
+    S - Supplies the address of the source tensor.
+
+    D - Supplies the address of the destination tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t TotalChannelBlockCount = size_t(OutputShape[0]) * size_t(OutputShape[1]) / BlockSize;
+    const size_t OutputSize = size_t(OutputShape[2]) * size_t(OutputShape[3]);
+
+    for (size_t cb = 0; cb < TotalChannelBlockCount; cb++) {
+
+        for (size_t bc = 0; bc < BlockSize; bc++) {
+
+            const float* s = S + bc;
+
+            for (size_t i = 0; i < OutputSize; i++) {
+                *D++ = *s;
+                s += BlockSize;
+            }
+        }
+
+        S += BlockSize * OutputSize;
+    }
+}
+
+void
+MLASCALL
+MlasReorderFilterOIHWBiBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders a filter tensor from OIHW format to the OIHWBiBo
+    format used by the NCHWc convolution kernels for NCHWc input.
+
+Arguments:
+
+    FilterShape - Supplies the shape of the filter tensor (O, I, H, W). The
+        number of output and input channels must be multiples of the block
+        size.
+
+    S - Supplies the address of the source tensor.
+
+    D - Supplies the address of the destination tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t OutputChannels = size_t(FilterShape[0]);
+    const size_t InputChannels = size_t(FilterShape[1]);
+    const size_t KernelSize = size_t(FilterShape[2]) * size_t(FilterShape[3]);
+
+    for (size_t o = 0; o < OutputChannels; o += BlockSize) {
+
+        for (size_t i = 0; i < InputChannels; i += BlockSize) {
+
+            for (size_t k = 0; k < KernelSize; k++) {
+
+                for (size_t bi = 0; bi < BlockSize; bi++) {
+
+                    for (size_t bo = 0; bo < BlockSize; bo++) {
+                        *D++ = S[((o + bo) * InputChannels + (i + bi)) * KernelSize + k];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+MLASCALL
+MlasReorderFilterOIHWBo(
+    const int64_t* FilterShape,
+    const float* S,
+    float* D
+    )
+/*++
+
+Routine Description:
+
+    This routine reorders a filter tensor from OIHW format to the OIHWBo
+    format used by the NCHWc convolution kernels for NCHW input.
+
+Arguments:
+
+    FilterShape - Supplies the shape of the filter tensor (O, I, H, W). The
+        number of output channels must be a multiple of the block size.
+
+    S - Supplies the address of the source tensor.
+
+    D - Supplies the address of the destination tensor.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockSize = MlasPlatform.NchwcBlockSize;
+
+    const size_t OutputChannels = size_t(FilterShape[0]);
+    const size_t InputChannels = size_t(FilterShape[1]);
+    const size_t KernelSize = size_t(FilterShape[2]) * size_t(FilterShape[3]);
+
+    for (size_t o = 0; o < OutputChannels; o += BlockSize) {
+
+        for (size_t i = 0; i < InputChannels; i++) {
+
+            for (size_t k = 0; k < KernelSize; k++) {
+
+                for (size_t bo = 0; bo < BlockSize; bo++) {
+                    *D++ = S[((o + bo) * InputChannels + i) * KernelSize + k];
+                }
+            }
+        }
+    }
+}
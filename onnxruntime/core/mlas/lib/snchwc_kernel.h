@@ -0,0 +1,251 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    snchwc_kernel.h
+
+Abstract:
+
+    This module contains the NCHWc convolution kernel template that is
+    instantiated for each instruction set extension.
+
+    The kernel computes one output row for a set of filter blocks. Each
+    element of an input channel block is broadcast and multiplied against the
+    corresponding row of each filter block, so the accumulators for an output
+    element stay in vector registers for the whole reduction.
+
+    The instruction set is described by a traits type that supplies the
+    vector type, the number of floats per vector and the vector operations.
+
+--*/
+
+#pragma once
+
+#include "mlasi.h"
+
+template<typename KernelTraits, size_t BlockSize, size_t FilterCount, bool InputIsNchw>
+void
+MlasConvNchwcKernelRow(
+    const MLAS_NCHWC_CONV_WORK_BLOCK* WorkBlock,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    size_t OutputRow
+    )
+/*++
+
+Routine Description:
+
+    This routine computes one output row of a NCHWc convolution for the
+    specified number of filter blocks.
+
+Arguments:
+
+    WorkBlock - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input image for the current batch, in NCHWc format
+        or in NCHW format if WorkBlock->InputIsNchw is true.
+
+    Filter - Supplies the first filter block of the filter set.
+
+    Bias - Optionally supplies the bias values of the first filter block.
+
+    Output - Supplies the output image of the first filter block.
+
+    OutputRow - Supplies the index of the output row to compute.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    typedef typename KernelTraits::VectorType VectorType;
+
+    constexpr size_t VectorCount = BlockSize / KernelTraits::VectorLength;
+
+    static_assert(VectorCount * KernelTraits::VectorLength == BlockSize,
+        "block size must be a multiple of the vector length");
+
+    const size_t InputChannels = WorkBlock->InputChannels;
+    const size_t InputHeight = WorkBlock->InputShape[0];
+    const size_t InputWidth = WorkBlock->InputShape[1];
+    const size_t InputSize = WorkBlock->InputSize;
+    const size_t KernelHeight = WorkBlock->KernelShape[0];
+    const size_t KernelWidth = WorkBlock->KernelShape[1];
+    const size_t DilationHeight = WorkBlock->DilationShape[0];
+    const size_t DilationWidth = WorkBlock->DilationShape[1];
+    const size_t PaddingLeftY = WorkBlock->Padding[0];
+    const size_t PaddingLeftX = WorkBlock->Padding[1];
+    const size_t StrideHeight = WorkBlock->StrideShape[0];
+    const size_t StrideWidth = WorkBlock->StrideShape[1];
+    const size_t OutputWidth = WorkBlock->OutputShape[1];
+    const size_t OutputSize = WorkBlock->OutputSize;
+
+    //
+    // The filters are stored as OIHWBo for NCHW input and OIHWBiBo for NCHWc
+    // input. Compute the number of elements between filter blocks and
+    // between the elements of a kernel.
+    //
+
+    const size_t KernelSize = KernelHeight * KernelWidth;
+    const size_t FilterBlockStride = InputChannels * KernelSize * BlockSize;
+    const size_t FilterKernelStride = InputIsNchw ? BlockSize : BlockSize * BlockSize;
+    const size_t InputBlockCount = InputIsNchw ? InputChannels : InputChannels / BlockSize;
+
+    float* output = Output + OutputRow * OutputWidth * BlockSize;
+
+    for (size_t ow = 0; ow < OutputWidth; ow++) {
+
+        VectorType Accumulators[FilterCount][VectorCount];
+
+        for (size_t f = 0; f < FilterCount; f++) {
+            for (size_t v = 0; v < VectorCount; v++) {
+                Accumulators[f][v] = (Bias != nullptr) ?
+                    KernelTraits::Load(Bias + f * BlockSize + v * KernelTraits::VectorLength) :
+                    KernelTraits::Zero();
+            }
+        }
+
+        for (size_t kh = 0; kh < KernelHeight; kh++) {
+
+            //
+            // Skip kernel rows that fall in the padding. The unsigned
+            // arithmetic wraps the rows above the image to large values.
+            //
+
+            const size_t ih = OutputRow * StrideHeight + kh * DilationHeight - PaddingLeftY;
+
+            if (ih >= InputHeight) {
+                continue;
+            }
+
+            for (size_t kw = 0; kw < KernelWidth; kw++) {
+
+                const size_t iw = ow * StrideWidth + kw * DilationWidth - PaddingLeftX;
+
+                if (iw >= InputWidth) {
+                    continue;
+                }
+
+                const size_t InputOffset = ih * InputWidth + iw;
+
+                const float* input;
+                size_t InputStride;
+
+                if (InputIsNchw) {
+                    input = Input + InputOffset;
+                    InputStride = InputSize;
+                } else {
+                    input = Input + InputOffset * BlockSize;
+                    InputStride = InputSize * BlockSize;
+                }
+
+                const float* filter = Filter + (kh * KernelWidth + kw) * FilterKernelStride;
+
+                for (size_t ib = 0; ib < InputBlockCount; ib++) {
+
+                    const size_t ElementCount = InputIsNchw ? 1 : BlockSize;
+
+                    for (size_t i = 0; i < ElementCount; i++) {
+
+                        VectorType InputElement = KernelTraits::Broadcast(input[i]);
+
+                        const float* row = filter + i * BlockSize;
+
+                        for (size_t f = 0; f < FilterCount; f++) {
+                            for (size_t v = 0; v < VectorCount; v++) {
+                                VectorType FilterElements = KernelTraits::Load(row +
+                                    f * FilterBlockStride + v * KernelTraits::VectorLength);
+                                Accumulators[f][v] = KernelTraits::MultiplyAdd(InputElement,
+                                    FilterElements, Accumulators[f][v]);
+                            }
+                        }
+                    }
+
+                    input += InputStride;
+                    filter += KernelSize * FilterKernelStride;
+                }
+            }
+        }
+
+        for (size_t f = 0; f < FilterCount; f++) {
+            for (size_t v = 0; v < VectorCount; v++) {
+                KernelTraits::Store(output + f * OutputSize * BlockSize +
+                    v * KernelTraits::VectorLength, Accumulators[f][v]);
+            }
+        }
+
+        output += BlockSize;
+    }
+}
+
+template<typename KernelTraits, size_t BlockSize>
+void
+MlasConvNchwcKernelTemplate(
+    const MLAS_NCHWC_CONV_WORK_BLOCK* WorkBlock,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    size_t FilterCount,
+    size_t OutputRow
+    )
+/*++
+
+Routine Description:
+
+    This routine dispatches to the kernel instantiation for the specified
+    number of filter blocks and input format.
+
+Arguments:
+
+    See MLAS_CONV_NCHWC_KERNEL_ROUTINE.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (WorkBlock->InputIsNchw) {
+
+        switch (FilterCount) {
+            case 1:
+                MlasConvNchwcKernelRow<KernelTraits, BlockSize, 1, true>(WorkBlock, Input, Filter, Bias, Output, OutputRow);
+                break;
+            case 2:
+                MlasConvNchwcKernelRow<KernelTraits, BlockSize, 2, true>(WorkBlock, Input, Filter, Bias, Output, OutputRow);
+                break;
+            case 3:
+                MlasConvNchwcKernelRow<KernelTraits, BlockSize, 3, true>(WorkBlock, Input, Filter, Bias, Output, OutputRow);
+                break;
+            default:
+                MlasConvNchwcKernelRow<KernelTraits, BlockSize, 4, true>(WorkBlock, Input, Filter, Bias, Output, OutputRow);
+                break;
+        }
+
+    } else {
+
+        switch (FilterCount) {
+            case 1:
+                MlasConvNchwcKernelRow<KernelTraits, BlockSize, 1, false>(WorkBlock, Input, Filter, Bias, Output, OutputRow);
+                break;
+            case 2:
+                MlasConvNchwcKernelRow<KernelTraits, BlockSize, 2, false>(WorkBlock, Input, Filter, Bias, Output, OutputRow);
+                break;
+            case 3:
+                MlasConvNchwcKernelRow<KernelTraits, BlockSize, 3, false>(WorkBlock, Input, Filter, Bias, Output, OutputRow);
+                break;
+            default:
+                MlasConvNchwcKernelRow<KernelTraits, BlockSize, 4, false>(WorkBlock, Input, Filter, Bias, Output, OutputRow);
+                break;
+        }
+    }
+}
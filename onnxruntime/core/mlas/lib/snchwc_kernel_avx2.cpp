@@ -0,0 +1,81 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    snchwc_kernel_avx2.cpp
+
+Abstract:
+
+    This module implements the NCHWc convolution kernel for AVX2/FMA3 using a
+    block size of 8 channels.
+
+--*/
+
+#include "snchwc_kernel.h"
+
+struct MLAS_NCHWC_KERNEL_TRAITS_AVX2 {
+
+    typedef __m256 VectorType;
+
+    static constexpr size_t VectorLength = 8;
+
+    static VectorType Zero(void)
+    {
+        return _mm256_setzero_ps();
+    }
+
+    static VectorType Load(const float* Buffer)
+    {
+        return _mm256_loadu_ps(Buffer);
+    }
+
+    static void Store(float* Buffer, VectorType Vector)
+    {
+        _mm256_storeu_ps(Buffer, Vector);
+    }
+
+    static VectorType Broadcast(float Value)
+    {
+        return _mm256_set1_ps(Value);
+    }
+
+    static VectorType MultiplyAdd(VectorType Vector1, VectorType Vector2, VectorType Vector3)
+    {
+        return _mm256_fmadd_ps(Vector1, Vector2, Vector3);
+    }
+};
+
+void
+MLASCALL
+MlasConvNchwcKernelAvx2(
+    const MLAS_NCHWC_CONV_WORK_BLOCK* WorkBlock,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    size_t FilterCount,
+    size_t OutputRow
+    )
+/*++
+
+Routine Description:
+
+    This routine computes one output row of a NCHWc convolution using AVX2.
+
+Arguments:
+
+    See MLAS_CONV_NCHWC_KERNEL_ROUTINE.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasConvNchwcKernelTemplate<MLAS_NCHWC_KERNEL_TRAITS_AVX2, 8>(WorkBlock,
+        Input, Filter, Bias, Output, FilterCount, OutputRow);
+}
@@ -16,6 +16,8 @@ Abstract:
 
 #include "mlasi.h"
 
+#include "core/platform/threadpool.h"
+
 #if defined(MLAS_USE_WIN32_THREADPOOL)
 
 //
@@ -69,12 +71,77 @@ Return Value:
 
 #endif
 
+int32_t
+MlasGetMaximumThreadCount(
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the maximum number of threads that can be used to
+    execute a threaded operation.
+
+Arguments:
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    Returns the maximum number of threads.
+
+--*/
+{
+    if (ThreadPool != nullptr) {
+
+        //
+        // The thread calling into the pool also executes iterations, so count
+        // it in addition to the worker threads.
+        //
+
+        int32_t MaximumThreadCount = int32_t(ThreadPool->NumThreads()) + 1;
+
+        if (MaximumThreadCount > MLAS_MAXIMUM_THREAD_COUNT) {
+            MaximumThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+        }
+
+        return MaximumThreadCount;
+    }
+
+    return MlasPlatform.GetMaximumThreadCount();
+}
+
 void
 MlasExecuteThreaded(
     MLAS_THREADED_ROUTINE ThreadedRoutine,
     void* Context,
-    int32_t Iterations
+    int32_t Iterations,
+    MLAS_THREADPOOL* ThreadPool
     )
+/*++
+
+Routine Description:
+
+    This routine executes the supplied routine for the specified number of
+    iterations, potentially across multiple threads.
+
+Arguments:
+
+    ThreadedRoutine - Supplies the routine to execute for each iteration.
+
+    Context - Supplies the context to pass to the routine.
+
+    Iterations - Supplies the number of iterations to execute.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    None.
+
+--*/
 {
     //
     // Execute the routine directly if only one iteration is specified.
@@ -85,6 +152,23 @@ MlasExecuteThreaded(
         return;
     }
 
+    //
+    // Schedule the threaded iterations using the supplied thread pool. Each
+    // iteration is expected to be a roughly equal share of the operation, so
+    // hand out single iterations.
+    //
+
+    if (ThreadPool != nullptr) {
+
+        ThreadPool->ParallelFor(0, Iterations, 1, [&](std::ptrdiff_t First, std::ptrdiff_t Last) {
+            for (std::ptrdiff_t tid = First; tid < Last; tid++) {
+                ThreadedRoutine(Context, int32_t(tid));
+            }
+        });
+
+        return;
+    }
+
 #if defined(MLAS_USE_WIN32_THREADPOOL)
 
     //
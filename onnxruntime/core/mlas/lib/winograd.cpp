@@ -0,0 +1,883 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    winograd.cpp
+
+Abstract:
+
+    This module implements the Winograd F(4x4,3x3) algorithm for two
+    dimensional convolutions with a 3x3 kernel and unit strides and
+    dilations.
+
+    The output image is divided into 4x4 tiles that are each computed from a
+    6x6 tile of the input image. The input tiles and the filters are
+    transformed to a 6x6 domain where the convolution becomes an element wise
+    product. The element wise products are summed over the input channels, so
+    each of the 36 elements of the transformed domain is a matrix multiply of
+    the transformed filters against a block of transformed input tiles. The
+    results are transformed back to 4x4 output tiles.
+
+    This reduces the number of multiplies by a factor of four versus the
+    direct algorithm at the cost of a small loss of precision.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the number of elements in the transformed domain.
+//
+
+#define MLAS_WINOGRAD_TILE_ELEMENTS                 36
+
+//
+// Define the minimum number of input channels and filters per group before
+// the Winograd algorithm is used. Smaller convolutions do not perform enough
+// work per transformed element to amortize the transforms.
+//
+
+#define MLAS_WINOGRAD_MINIMUM_CHANNELS              32
+
+//
+// Define the target number of working buffer elements per thread. This is
+// used to size the blocks of tiles that are transformed together.
+//
+
+#define MLAS_WINOGRAD_WORKING_BUFFER_SIZE_PER_THREAD (256 * 1024)
+
+//
+// Define the minimum number of tiles that are transformed together, which is
+// the N dimension of the matrix multiplies.
+//
+
+#define MLAS_WINOGRAD_MINIMUM_TILE_BLOCK            16
+
+//
+// Define the parameters to execute segments of a Winograd convolution on
+// worker threads.
+//
+
+struct MLAS_WINOGRAD_WORK_BLOCK {
+    const MLAS_CONV_PARAMETERS* Parameters;
+    const float* Input;
+    const float* TransformedFilter;
+    const float* Bias;
+    float* WorkingBuffer;
+    float* Output;
+};
+
+size_t
+MlasConvWinogradGetTileBlockBufferSize(
+    size_t InputChannels,
+    size_t FilterCount,
+    size_t TileBlockSize
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the number of working buffer elements used by a
+    thread to process a block of tiles.
+
+    The buffer holds the transformed input tiles, the transformed output tiles
+    and the inverse transformed 4x4 output tiles.
+
+Arguments:
+
+    InputChannels - Supplies the number of input channels per group.
+
+    FilterCount - Supplies the number of filters per group.
+
+    TileBlockSize - Supplies the number of tiles in a block.
+
+Return Value:
+
+    Returns the number of working buffer elements.
+
+--*/
+{
+    return (MLAS_WINOGRAD_TILE_ELEMENTS * (InputChannels + FilterCount) +
+        16 * FilterCount) * TileBlockSize;
+}
+
+bool
+MLASCALL
+MlasConvWinogradIsSupported(
+    size_t InputChannels,
+    size_t FilterCount
+    )
+/*++
+
+Routine Description:
+
+    This routine determines whether the Winograd algorithm may be selected for
+    a two dimensional convolution with a 3x3 kernel and unit strides and
+    dilations, given its channel counts. The algorithm is also not selected
+    for outputs smaller than a tile, which depends on the input shape.
+
+    A depthwise convolution has a single input channel and filter per group,
+    so it is never supported here and uses the depthwise algorithm instead.
+
+    The filter of a convolution that isn't supported should not be
+    transformed by MlasConvWinogradTransformFilter, as it would never be used.
+
+Arguments:
+
+    InputChannels - Supplies the number of input channels per group.
+
+    FilterCount - Supplies the number of filters per group.
+
+Return Value:
+
+    Returns true if the Winograd algorithm may be selected, else false.
+
+--*/
+{
+    return InputChannels >= MLAS_WINOGRAD_MINIMUM_CHANNELS &&
+        FilterCount >= MLAS_WINOGRAD_MINIMUM_CHANNELS;
+}
+
+size_t
+MLASCALL
+MlasConvWinogradGetFilterSize(
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the number of elements required to store the filter
+    tensor transformed by MlasConvWinogradTransformFilter.
+
+Arguments:
+
+    GroupCount - Supplies the number of channel groups.
+
+    InputChannels - Supplies the number of input channels per group.
+
+    FilterCount - Supplies the number of filters per group.
+
+Return Value:
+
+    Returns the number of elements of the transformed filter.
+
+--*/
+{
+    return GroupCount * MLAS_WINOGRAD_TILE_ELEMENTS * FilterCount * InputChannels;
+}
+
+void
+MLASCALL
+MlasConvWinogradTransformFilter(
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount,
+    const float* Filter,
+    float* TransformedFilter
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms a 3x3 filter tensor to the Winograd domain by
+    computing G * g * G^T for each filter and input channel.
+
+    The transformed filter is stored as [group][element][filter][channel], so
+    that each of the 36 elements of a group is a row major matrix suitable
+    for the A operand of a matrix multiply.
+
+Arguments:
+
+    GroupCount - Supplies the number of channel groups.
+
+    InputChannels - Supplies the number of input channels per group.
+
+    FilterCount - Supplies the number of filters per group.
+
+    Filter - Supplies the filter tensor in OIHW format.
+
+    TransformedFilter - Supplies the buffer to receive the transformed filter,
+        sized to the number of elements returned by
+        MlasConvWinogradGetFilterSize.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t ElementStride = FilterCount * InputChannels;
+
+    for (size_t group = 0; group < GroupCount; group++) {
+
+        for (size_t f = 0; f < FilterCount; f++) {
+
+            for (size_t c = 0; c < InputChannels; c++) {
+
+                const float* g = Filter + ((group * FilterCount + f) * InputChannels + c) * 9;
+
+                //
+                // Compute G * g, where each column of the 3x3 kernel is
+                // expanded to six rows.
+                //
+
+                float t[6][3];
+
+                for (size_t k = 0; k < 3; k++) {
+
+                    const float g0 = g[0 * 3 + k];
+                    const float g1 = g[1 * 3 + k];
+                    const float g2 = g[2 * 3 + k];
+
+                    t[0][k] = g0 / 4.0f;
+                    t[1][k] = -(g0 + g1 + g2) / 6.0f;
+                    t[2][k] = -(g0 - g1 + g2) / 6.0f;
+                    t[3][k] = g0 / 24.0f + g1 / 12.0f + g2 / 6.0f;
+                    t[4][k] = g0 / 24.0f - g1 / 12.0f + g2 / 6.0f;
+                    t[5][k] = g2;
+                }
+
+                //
+                // Compute (G * g) * G^T, where each row is expanded to six
+                // columns.
+                //
+
+                float* u = TransformedFilter + f * InputChannels + c;
+
+                for (size_t r = 0; r < 6; r++) {
+
+                    const float t0 = t[r][0];
+                    const float t1 = t[r][1];
+                    const float t2 = t[r][2];
+
+                    u[(r * 6 + 0) * ElementStride] = t0 / 4.0f;
+                    u[(r * 6 + 1) * ElementStride] = -(t0 + t1 + t2) / 6.0f;
+                    u[(r * 6 + 2) * ElementStride] = -(t0 - t1 + t2) / 6.0f;
+                    u[(r * 6 + 3) * ElementStride] = t0 / 24.0f + t1 / 12.0f + t2 / 6.0f;
+                    u[(r * 6 + 4) * ElementStride] = t0 / 24.0f - t1 / 12.0f + t2 / 6.0f;
+                    u[(r * 6 + 5) * ElementStride] = t2;
+                }
+            }
+        }
+
+        TransformedFilter += MLAS_WINOGRAD_TILE_ELEMENTS * ElementStride;
+    }
+}
+
+void
+MlasConvWinogradTransformInput(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    float* TransformedInput,
+    size_t TileStart,
+    size_t TileCount,
+    size_t TileBlockSize
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms a block of 6x6 input tiles to the Winograd domain
+    by computing B^T * d * B for each tile and input channel.
+
+    The transformed input is stored as [element][channel][tile], so that each
+    of the 36 elements is a row major matrix suitable for the B operand of a
+    matrix multiply.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input image for the current batch and group.
+
+    TransformedInput - Supplies the buffer to receive the transformed tiles.
+
+    TileStart - Supplies the index of the first tile to transform.
+
+    TileCount - Supplies the number of tiles to transform.
+
+    TileBlockSize - Supplies the number of elements between rows of the
+        transformed input.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t InputHeight = Parameters->InputShape[0];
+    const size_t InputWidth = Parameters->InputShape[1];
+    const size_t InputSize = Parameters->InputSize;
+    const size_t PaddingLeftY = Parameters->Padding[0];
+    const size_t PaddingLeftX = Parameters->Padding[1];
+    const size_t TileCountW = Parameters->u.Winograd.TileCountW;
+
+    const size_t ElementStride = InputChannels * TileBlockSize;
+
+    for (size_t c = 0; c < InputChannels; c++) {
+
+        for (size_t t = 0; t < TileCount; t++) {
+
+            const size_t TileIndex = TileStart + t;
+            const size_t th = TileIndex / TileCountW;
+            const size_t tw = TileIndex % TileCountW;
+
+            //
+            // Load the 6x6 input tile. The unsigned arithmetic wraps the
+            // coordinates in the leading padding to large values, so a single
+            // comparison detects elements outside of the input image.
+            //
+
+            float d[6][6];
+
+            const size_t ih0 = th * 4 - PaddingLeftY;
+            const size_t iw0 = tw * 4 - PaddingLeftX;
+
+            for (size_t r = 0; r < 6; r++) {
+
+                const size_t ih = ih0 + r;
+
+                for (size_t s = 0; s < 6; s++) {
+
+                    const size_t iw = iw0 + s;
+
+                    d[r][s] = (ih < InputHeight && iw < InputWidth) ? Input[ih * InputWidth + iw] : 0.0f;
+                }
+            }
+
+            //
+            // Compute B^T * d for each column of the tile.
+            //
+
+            float b[6][6];
+
+            for (size_t s = 0; s < 6; s++) {
+
+                const float d0 = d[0][s];
+                const float d1 = d[1][s];
+                const float d2 = d[2][s];
+                const float d3 = d[3][s];
+                const float d4 = d[4][s];
+                const float d5 = d[5][s];
+
+                b[0][s] = 4.0f * d0 - 5.0f * d2 + d4;
+                b[1][s] = -4.0f * (d1 + d2) + d3 + d4;
+                b[2][s] = 4.0f * (d1 - d2) - d3 + d4;
+                b[3][s] = 2.0f * (d3 - d1) - d2 + d4;
+                b[4][s] = 2.0f * (d1 - d3) - d2 + d4;
+                b[5][s] = 4.0f * d1 - 5.0f * d3 + d5;
+            }
+
+            //
+            // Compute (B^T * d) * B for each row of the tile.
+            //
+
+            float* v = TransformedInput + c * TileBlockSize + t;
+
+            for (size_t r = 0; r < 6; r++) {
+
+                const float b0 = b[r][0];
+                const float b1 = b[r][1];
+                const float b2 = b[r][2];
+                const float b3 = b[r][3];
+                const float b4 = b[r][4];
+                const float b5 = b[r][5];
+
+                v[(r * 6 + 0) * ElementStride] = 4.0f * b0 - 5.0f * b2 + b4;
+                v[(r * 6 + 1) * ElementStride] = -4.0f * (b1 + b2) + b3 + b4;
+                v[(r * 6 + 2) * ElementStride] = 4.0f * (b1 - b2) - b3 + b4;
+                v[(r * 6 + 3) * ElementStride] = 2.0f * (b3 - b1) - b2 + b4;
+                v[(r * 6 + 4) * ElementStride] = 2.0f * (b1 - b3) - b2 + b4;
+                v[(r * 6 + 5) * ElementStride] = 4.0f * b1 - 5.0f * b3 + b5;
+            }
+        }
+
+        Input += InputSize;
+    }
+}
+
+void
+MlasConvWinogradTransformOutput(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* TransformedOutput,
+    float* OutputTiles,
+    size_t TileCount,
+    size_t TileBlockSize
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms a block of 6x6 tiles from the Winograd domain to
+    4x4 output tiles by computing A^T * m * A for each tile and filter.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    TransformedOutput - Supplies the transformed output stored as
+        [element][filter][tile].
+
+    OutputTiles - Supplies the buffer to receive the output tiles stored as
+        [filter][tile][4x4].
+
+    TileCount - Supplies the number of tiles to transform.
+
+    TileBlockSize - Supplies the number of elements between rows of the
+        transformed output.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t FilterCount = Parameters->FilterCount;
+
+    const size_t ElementStride = FilterCount * TileBlockSize;
+
+    for (size_t f = 0; f < FilterCount; f++) {
+
+        for (size_t t = 0; t < TileCount; t++) {
+
+            const float* m = TransformedOutput + f * TileBlockSize + t;
+
+            //
+            // Compute A^T * m for each column of the tile.
+            //
+
+            float a[4][6];
+
+            for (size_t s = 0; s < 6; s++) {
+
+                const float m0 = m[(0 * 6 + s) * ElementStride];
+                const float m1 = m[(1 * 6 + s) * ElementStride];
+                const float m2 = m[(2 * 6 + s) * ElementStride];
+                const float m3 = m[(3 * 6 + s) * ElementStride];
+                const float m4 = m[(4 * 6 + s) * ElementStride];
+                const float m5 = m[(5 * 6 + s) * ElementStride];
+
+                a[0][s] = m0 + m1 + m2 + m3 + m4;
+                a[1][s] = (m1 - m2) + 2.0f * (m3 - m4);
+                a[2][s] = (m1 + m2) + 4.0f * (m3 + m4);
+                a[3][s] = (m1 - m2) + 8.0f * (m3 - m4) + m5;
+            }
+
+            //
+            // Compute (A^T * m) * A for each row of the tile.
+            //
+
+            float* o = OutputTiles + (f * TileBlockSize + t) * 16;
+
+            for (size_t r = 0; r < 4; r++) {
+
+                const float a0 = a[r][0];
+                const float a1 = a[r][1];
+                const float a2 = a[r][2];
+                const float a3 = a[r][3];
+                const float a4 = a[r][4];
+                const float a5 = a[r][5];
+
+                o[r * 4 + 0] = a0 + a1 + a2 + a3 + a4;
+                o[r * 4 + 1] = (a1 - a2) + 2.0f * (a3 - a4);
+                o[r * 4 + 2] = (a1 + a2) + 4.0f * (a3 + a4);
+                o[r * 4 + 3] = (a1 - a2) + 8.0f * (a3 - a4) + a5;
+            }
+        }
+    }
+}
+
+void
+MlasConvWinogradStoreOutput(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* OutputTiles,
+    float* Output,
+    size_t TileStart,
+    size_t TileCount,
+    size_t TileBlockSize
+    )
+/*++
+
+Routine Description:
+
+    This routine copies a block of 4x4 output tiles to the output image,
+    clipping the tiles that extend past the edges of the output image.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    OutputTiles - Supplies the output tiles stored as [filter][tile][4x4].
+
+    Output - Supplies the output image for the current batch and group.
+
+    TileStart - Supplies the index of the first tile to store.
+
+    TileCount - Supplies the number of tiles to store.
+
+    TileBlockSize - Supplies the number of tiles between filters of the
+        output tiles.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t OutputHeight = Parameters->OutputShape[0];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+    const size_t OutputSize = Parameters->OutputSize;
+    const size_t TileCountW = Parameters->u.Winograd.TileCountW;
+
+    for (size_t f = 0; f < FilterCount; f++) {
+
+        for (size_t t = 0; t < TileCount; t++) {
+
+            const size_t TileIndex = TileStart + t;
+            const size_t oh0 = (TileIndex / TileCountW) * 4;
+            const size_t ow0 = (TileIndex % TileCountW) * 4;
+
+            const size_t RowCount = (std::min)(OutputHeight - oh0, size_t(4));
+            const size_t ColumnCount = (std::min)(OutputWidth - ow0, size_t(4));
+
+            const float* o = OutputTiles + (f * TileBlockSize + t) * 16;
+            float* output = Output + oh0 * OutputWidth + ow0;
+
+            for (size_t r = 0; r < RowCount; r++) {
+                for (size_t s = 0; s < ColumnCount; s++) {
+                    output[s] = o[r * 4 + s];
+                }
+                output += OutputWidth;
+            }
+        }
+
+        Output += OutputSize;
+    }
+}
+
+void
+MlasConvWinogradThreaded(
+    void* Context,
+    int32_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    Winograd convolution operation.
+
+    The work is partitioned into blocks of tiles for each batch and group.
+    Each block of tiles is transformed to the Winograd domain, multiplied
+    against the transformed filters and transformed back to the output.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_WINOGRAD_WORK_BLOCK* WorkBlock = (MLAS_WINOGRAD_WORK_BLOCK*)Context;
+
+    const MLAS_CONV_PARAMETERS* Parameters = WorkBlock->Parameters;
+
+    const size_t GroupCount = Parameters->GroupCount;
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t TileCount = Parameters->u.Winograd.TileCount;
+    const size_t TileBlockSize = Parameters->u.Winograd.TileBlockSize;
+    const size_t TileBlockCount = (TileCount + TileBlockSize - 1) / TileBlockSize;
+
+    //
+    // Compute the range of work items to use for this thread.
+    //
+
+    const size_t WorkItemCount = Parameters->BatchCount * GroupCount * TileBlockCount;
+    const size_t ThreadCount = Parameters->u.Winograd.ThreadCount;
+
+    const size_t WorkItemCountPerThread = WorkItemCount / ThreadCount;
+    const size_t WorkItemCountExtra = WorkItemCount % ThreadCount;
+
+    size_t WorkItemStart;
+    size_t WorkItemEnd;
+
+    if (uint32_t(Index) < WorkItemCountExtra) {
+        WorkItemStart = (WorkItemCountPerThread + 1) * Index;
+        WorkItemEnd = WorkItemStart + WorkItemCountPerThread + 1;
+    } else {
+        WorkItemStart = WorkItemCountPerThread * Index + WorkItemCountExtra;
+        WorkItemEnd = WorkItemStart + WorkItemCountPerThread;
+    }
+
+    //
+    // Partition the working buffer for this thread.
+    //
+
+    float* TransformedInput = WorkBlock->WorkingBuffer + Index *
+        MlasConvWinogradGetTileBlockBufferSize(InputChannels, FilterCount, TileBlockSize);
+    float* TransformedOutput = TransformedInput + MLAS_WINOGRAD_TILE_ELEMENTS * InputChannels * TileBlockSize;
+    float* OutputTiles = TransformedOutput + MLAS_WINOGRAD_TILE_ELEMENTS * FilterCount * TileBlockSize;
+
+    const size_t InputGroupSize = InputChannels * Parameters->InputSize;
+    const size_t OutputGroupSize = FilterCount * Parameters->OutputSize;
+    const size_t FilterGroupSize = MLAS_WINOGRAD_TILE_ELEMENTS * FilterCount * InputChannels;
+
+    for (size_t WorkItem = WorkItemStart; WorkItem < WorkItemEnd; WorkItem++) {
+
+        const size_t bg = WorkItem / TileBlockCount;
+        const size_t group = bg % GroupCount;
+
+        const size_t TileStart = (WorkItem % TileBlockCount) * TileBlockSize;
+        const size_t TileCountThisIteration = (std::min)(TileCount - TileStart, TileBlockSize);
+
+        const float* filter = WorkBlock->TransformedFilter + group * FilterGroupSize;
+        const float* bias = WorkBlock->Bias;
+
+        if (bias != nullptr) {
+            bias += group * FilterCount;
+        }
+
+        MlasConvWinogradTransformInput(Parameters, WorkBlock->Input + bg * InputGroupSize,
+            TransformedInput, TileStart, TileCountThisIteration, TileBlockSize);
+
+        //
+        // Multiply the transformed filters against the transformed input for
+        // each element of the transformed domain.
+        //
+
+        for (size_t e = 0; e < MLAS_WINOGRAD_TILE_ELEMENTS; e++) {
+
+            MlasSgemmOperation(CblasNoTrans, CblasNoTrans, FilterCount,
+                TileCountThisIteration, InputChannels, 1.0f,
+                filter + e * FilterCount * InputChannels, InputChannels,
+                TransformedInput + e * InputChannels * TileBlockSize, TileBlockSize, 0.0f,
+                TransformedOutput + e * FilterCount * TileBlockSize, TileBlockSize);
+        }
+
+        MlasConvWinogradTransformOutput(Parameters, TransformedOutput, OutputTiles,
+            TileCountThisIteration, TileBlockSize);
+
+        //
+        // Apply the activation with optional bias to the output tiles before
+        // storing to the output image.
+        //
+
+        MlasActivation(Parameters->Activation, OutputTiles, bias, FilterCount,
+            OutputTiles, TileCountThisIteration * 16, TileBlockSize * 16);
+
+        MlasConvWinogradStoreOutput(Parameters, OutputTiles,
+            WorkBlock->Output + bg * OutputGroupSize, TileStart, TileCountThisIteration,
+            TileBlockSize);
+    }
+}
+
+bool
+MlasConvWinogradPrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    const float* TransformedFilter,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine determines whether the Winograd algorithm should be used
+    for a two dimensional convolution with a 3x3 kernel and unit strides and
+    dilations and if so, computes the parameters for the algorithm.
+
+Arguments:
+
+    Parameters - Supplies the structure that stores the provided and computed
+        parameters for the convolution operation.
+
+    TransformedFilter - Optionally supplies the filter tensor transformed by
+        MlasConvWinogradTransformFilter, else nullptr if the filter should be
+        transformed by each call to MlasConv.
+
+    WorkingBufferSize - Receives the number of elements to allocate for the
+        working buffer for intermediate results.
+
+    ThreadPool - Supplies the thread pool object that will be used to execute
+        the convolution, else nullptr if the platform threading implementation
+        will be used.
+
+Return Value:
+
+    Returns true if the Winograd algorithm was selected, else false.
+
+--*/
+{
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t OutputHeight = Parameters->OutputShape[0];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+
+    if (!MlasConvWinogradIsSupported(InputChannels, FilterCount) ||
+        OutputHeight < 4 || OutputWidth < 4) {
+        return false;
+    }
+
+    const size_t TileCountW = (OutputWidth + 3) / 4;
+    const size_t TileCount = ((OutputHeight + 3) / 4) * TileCountW;
+
+    //
+    // Compute the number of tiles that are transformed together so that the
+    // working buffer for a thread fits in the target size.
+    //
+
+    size_t TileBlockSize = MLAS_WINOGRAD_WORKING_BUFFER_SIZE_PER_THREAD /
+        MlasConvWinogradGetTileBlockBufferSize(InputChannels, FilterCount, 1);
+
+    if (TileBlockSize < MLAS_WINOGRAD_MINIMUM_TILE_BLOCK) {
+        TileBlockSize = MLAS_WINOGRAD_MINIMUM_TILE_BLOCK;
+    }
+
+    if (TileBlockSize > TileCount) {
+        TileBlockSize = TileCount;
+    }
+
+    const size_t TileBlockCount = (TileCount + TileBlockSize - 1) / TileBlockSize;
+
+    //
+    // Compute the number of target threads given the complexity of the
+    // matrix multiplies. Small requests should run using the single threaded
+    // path.
+    //
+
+    const size_t BatchGroupCount = Parameters->BatchCount * Parameters->GroupCount;
+
+    double Complexity = double(BatchGroupCount) * double(TileCount) *
+        double(MLAS_WINOGRAD_TILE_ELEMENTS) * double(FilterCount) * double(InputChannels);
+
+    int32_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+        TargetThreadCount = int32_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+    }
+
+    int32_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (size_t(TargetThreadCount) >= BatchGroupCount * TileBlockCount) {
+        TargetThreadCount = int32_t(BatchGroupCount * TileBlockCount);
+    }
+
+    Parameters->Algorithm = MlasConvAlgorithmWinograd;
+    Parameters->u.Winograd.TransformedFilter = TransformedFilter;
+    Parameters->u.Winograd.TileCountW = TileCountW;
+    Parameters->u.Winograd.TileCount = TileCount;
+    Parameters->u.Winograd.TileBlockSize = TileBlockSize;
+    Parameters->u.Winograd.ThreadCount = size_t(TargetThreadCount);
+
+    //
+    // The working buffer stores the transformed filter if not supplied by the
+    // caller followed by the per thread buffers.
+    //
+
+    *WorkingBufferSize = size_t(TargetThreadCount) *
+        MlasConvWinogradGetTileBlockBufferSize(InputChannels, FilterCount, TileBlockSize);
+
+    if (TransformedFilter == nullptr) {
+        *WorkingBufferSize += MlasConvWinogradGetFilterSize(Parameters->GroupCount,
+            InputChannels, FilterCount);
+    }
+
+    return true;
+}
+
+void
+MlasConvWinograd(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the convolution operation using the Winograd
+    algorithm.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input tensor.
+
+    Filter - Supplies the filter tensor.
+
+    Bias - Optionally supplies the bias vector.
+
+    WorkingBuffer - Supplies a working buffer sized to the number of elements
+        returned by MlasConvPrepare.
+
+    Output - Supplies the output tensor.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        platform threading implementation should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const float* TransformedFilter = Parameters->u.Winograd.TransformedFilter;
+
+    //
+    // Transform the filter to the start of the working buffer if the caller
+    // did not supply a transformed filter.
+    //
+
+    if (TransformedFilter == nullptr) {
+
+        MlasConvWinogradTransformFilter(Parameters->GroupCount, Parameters->InputChannels,
+            Parameters->FilterCount, Filter, WorkingBuffer);
+
+        TransformedFilter = WorkingBuffer;
+
+        WorkingBuffer += MlasConvWinogradGetFilterSize(Parameters->GroupCount,
+            Parameters->InputChannels, Parameters->FilterCount);
+    }
+
+    MLAS_WINOGRAD_WORK_BLOCK WorkBlock;
+
+    WorkBlock.Parameters = Parameters;
+    WorkBlock.Input = Input;
+    WorkBlock.TransformedFilter = TransformedFilter;
+    WorkBlock.Bias = Bias;
+    WorkBlock.WorkingBuffer = WorkingBuffer;
+    WorkBlock.Output = Output;
+
+    MlasExecuteThreaded(MlasConvWinogradThreaded, &WorkBlock,
+        int32_t(Parameters->u.Winograd.ThreadCount), ThreadPool);
+}
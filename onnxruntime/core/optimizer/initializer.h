@@ -14,8 +14,15 @@ namespace onnxruntime {
 
 class Initializer final {
  public:
+  // The data of an external initializer is only mapped when the session state is initialized, after the graph
+  // is optimized, so the optimizers can't read it and leave such initializers alone.
+  static bool HasExternalData(const ONNX_NAMESPACE::TensorProto* tensor_proto) {
+    return tensor_proto->has_data_location() &&
+           tensor_proto->data_location() == ONNX_NAMESPACE::TensorProto_DataLocation_EXTERNAL;
+  }
+
   static bool IsSupportedDataType(const ONNX_NAMESPACE::TensorProto* tensor_proto) {
-    return !(tensor_proto == nullptr ||
+    return !(tensor_proto == nullptr || HasExternalData(tensor_proto) ||
              (tensor_proto->data_type() != ONNX_NAMESPACE::TensorProto_DataType_FLOAT &&
               tensor_proto->data_type() != ONNX_NAMESPACE::TensorProto_DataType_DOUBLE));
   }
@@ -45,6 +52,8 @@ class Initializer final {
   }
 
   Initializer(const ONNX_NAMESPACE::TensorProto* tensor_proto) : size_(0) {
+    ORT_ENFORCE(!HasExternalData(tensor_proto), "The data of external initializer ", tensor_proto->name(),
+                " can't be read while optimizing the graph");
     data_type_ = tensor_proto->data_type();
     if (tensor_proto->has_name()) {
       name_ = tensor_proto->name();
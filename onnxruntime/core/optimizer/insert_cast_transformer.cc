@@ -76,6 +76,55 @@ static bool IsSingleInputNodeFloat16Node(const onnxruntime::Node& node) {
   return false;
 }
 
+// Returns the com.microsoft op that computes the node in float while reading its float16 weight (input 1)
+// directly, or an empty string if the node has no float16 constant weight or no such op.
+static std::string GetHalfWeightOpType(const onnxruntime::Graph& graph, const onnxruntime::Node& node) {
+  const auto& domain = node.Domain();
+  if ((domain != kOnnxDomain && domain != kOnnxDomainAlias) || node.InputDefs().size() < 2) {
+    return "";
+  }
+
+  std::string op_type;
+  if (node.OpType() == "MatMul") {
+    op_type = "MatMulHalfWeight";
+  } else if (node.OpType() == "Gemm" && node.InputDefs().size() == 3 &&
+             node.Op() != nullptr && node.Op()->SinceVersion() >= 7) {
+    // Gemm before opset 7 has the legacy broadcast attribute, which GemmHalfWeight doesn't accept
+    op_type = "GemmHalfWeight";
+  } else if (node.OpType() == "Conv") {
+    op_type = "ConvHalfWeight";
+  } else {
+    return "";
+  }
+
+  const TensorProto* weight = nullptr;
+  if (!graph.GetInitializedTensor(node.InputDefs()[1]->Name(), weight) ||
+      weight->data_type() != TensorProto_DataType_FLOAT16) {
+    return "";
+  }
+
+  return op_type;
+}
+
+static void ReplaceWithHalfWeightNode(onnxruntime::Graph& graph, onnxruntime::Node& node, const std::string& op_type) {
+  auto& half_weight_node = graph.AddNode(graph.GenerateNodeName(node.Name()),
+                                         op_type,
+                                         node.Description(),
+                                         node.MutableInputDefs(),
+                                         node.MutableOutputDefs(),
+                                         &node.GetAttributes(),
+                                         kMSDomain);
+  half_weight_node.SetExecutionProviderType(kCpuExecutionProvider);
+
+  // Graph::Resolve rebuilds the edges of the new node, so drop the ones that refer to the old node.
+  auto output_edges = node.GetRelationships().output_edges;
+  for (auto& output_edge : output_edges) {
+    graph.RemoveEdge(node.Index(), output_edge.GetNode().Index(), output_edge.GetSrcArgIndex(),
+                     output_edge.GetDstArgIndex());
+  }
+  graph.RemoveNode(node.Index());
+}
+
 Status ForceSingleNodeCPUFloat16ToFloat32(onnxruntime::Graph& graph) {
   // if graph only contain 1 compute node, don't force to float32
   if (graph.NumberOfNodes() <= 1) {
@@ -162,11 +211,21 @@ Status InsertCastTransformer::ApplyImpl(onnxruntime::Graph& graph, bool& modifie
     if (!node)
       return Status(ONNXRUNTIME, INVALID_ARGUMENT);
 
+    // A MatMul, Gemm or Conv with a float16 constant weight runs as its HalfWeight variant, which keeps the
+    // weight in float16 and converts it inside MLAS, so only the other inputs are cast.
+    const std::string half_weight_op_type =
+        node->GetExecutionProviderType().empty() ? GetHalfWeightOpType(graph, *node) : "";
+
     auto& inputs = node->MutableInputDefs();
     std::map<const onnxruntime::NodeArg*, onnxruntime::NodeArg*> replacement_defs;
     bool casted = false;
-    for (auto input : inputs) {
+    for (size_t input_index = 0; input_index < inputs.size(); ++input_index) {
+      auto input = inputs[input_index];
       if (NeedInsertCast(node, input)) {
+        casted = true;
+        if (input_index == 1 && !half_weight_op_type.empty()) {
+          continue;
+        }
         auto src_arg = input;
         if (input_def_updates.count(src_arg)) {
           replacement_defs[src_arg] = input_def_updates[src_arg];
@@ -183,7 +242,6 @@ Status InsertCastTransformer::ApplyImpl(onnxruntime::Graph& graph, bool& modifie
           replacement_defs[src_arg] = dst_arg;
           input_def_updates[src_arg] = dst_arg;
         }
-        casted = true;
       }
     }
 
@@ -218,6 +276,10 @@ Status InsertCastTransformer::ApplyImpl(onnxruntime::Graph& graph, bool& modifie
     modified = modified || casted;
 
     ORT_RETURN_IF_ERROR(Recurse(*node, modified, graph_level));
+
+    if (casted && !half_weight_op_type.empty()) {
+      ReplaceWithHalfWeightNode(graph, *node, half_weight_op_type);
+    }
   }
 
   auto status = Status::OK();
@@ -0,0 +1,398 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include "core/graph/graph_utils.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/optimizer/initializer.h"
+#include "core/optimizer/nchwc_transformer.h"
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+class NchwcTransformerImpl {
+ public:
+  explicit NchwcTransformerImpl(Graph& graph) noexcept : graph_(graph) {}
+
+  void Transform(Node& node);
+  void Finalize(bool& modified);
+
+ private:
+  NodeArg* LookupNchwcArgument(NodeArg* nchw_arg) const;
+  NodeArg* CreateNchwcArgument(NodeArg& nchw_arg);
+  NodeArg* ReorderInput(NodeArg& nchw_arg);
+  void RemoveInputEdge(Node& node, int input_index);
+
+  void TransformConv(Node& node);
+  void TransformPool(Node& node);
+  void TransformElementwise(Node& node);
+
+  Graph& graph_;
+
+  // Maps an argument whose producer has been replaced by a NCHWc node to the NCHWc argument that now holds its
+  // value. The argument is reordered back to NCHW format if anything else still consumes it.
+  std::unordered_map<NodeArg*, NodeArg*> nchwc_args_;
+
+  // Maps an argument that is still produced in NCHW format to its reordered NCHWc copy.
+  std::unordered_map<NodeArg*, NodeArg*> reordered_args_;
+
+  // Maps a filter initializer to its reordered NCHWc copy.
+  std::unordered_map<NodeArg*, NodeArg*> reordered_filters_;
+
+  std::unordered_set<NodeIndex> removed_nodes_;
+};
+
+NodeArg* NchwcTransformerImpl::LookupNchwcArgument(NodeArg* nchw_arg) const {
+  auto it = nchwc_args_.find(nchw_arg);
+  if (it != nchwc_args_.end()) {
+    return it->second;
+  }
+  it = reordered_args_.find(nchw_arg);
+  if (it != reordered_args_.end()) {
+    return it->second;
+  }
+  return nullptr;
+}
+
+NodeArg* NchwcTransformerImpl::CreateNchwcArgument(NodeArg& nchw_arg) {
+  // The NCHWc tensor has the same shape as the NCHW tensor, only the order of the elements differs.
+  return &graph_.GetOrCreateNodeArg(graph_.GenerateNodeArgName(nchw_arg.Name() + "_nchwc"), nchw_arg.TypeAsProto());
+}
+
+NodeArg* NchwcTransformerImpl::ReorderInput(NodeArg& nchw_arg) {
+  auto it = reordered_args_.find(&nchw_arg);
+  if (it != reordered_args_.end()) {
+    return it->second;
+  }
+
+  NodeArg* nchwc_arg = CreateNchwcArgument(nchw_arg);
+  Node& reorder_node = graph_.AddNode(graph_.GenerateNodeName("ReorderInput"),
+                                      "ReorderInput",
+                                      "Reorder " + nchw_arg.Name() + " to NCHWc",
+                                      {&nchw_arg},
+                                      {nchwc_arg},
+                                      nullptr,
+                                      kMSDomain);
+  reorder_node.SetExecutionProviderType(kCpuExecutionProvider);
+
+  reordered_args_[&nchw_arg] = nchwc_arg;
+  return nchwc_arg;
+}
+
+void NchwcTransformerImpl::RemoveInputEdge(Node& node, int input_index) {
+  for (auto it = node.InputEdgesBegin(); it != node.InputEdgesEnd(); ++it) {
+    if (it->GetDstArgIndex() == input_index) {
+      graph_.RemoveEdge(it->GetNode().Index(), node.Index(), it->GetSrcArgIndex(), input_index);
+      return;
+    }
+  }
+}
+
+void NchwcTransformerImpl::TransformConv(Node& node) {
+  auto& input_defs = node.MutableInputDefs();
+  auto& output_defs = node.MutableOutputDefs();
+
+  // The filter must be constant so that it can be reordered once here. The bias must also be constant as the
+  // NCHWc node is only connected to its inputs when the graph is resolved again.
+  const TensorProto* conv_W_tensor_proto = nullptr;
+  if (!graph_.GetInitializedTensor(input_defs[1]->Name(), conv_W_tensor_proto) ||
+      Initializer::HasExternalData(conv_W_tensor_proto) ||
+      conv_W_tensor_proto->data_type() != TensorProto_DataType_FLOAT ||
+      conv_W_tensor_proto->dims_size() != 4) {
+    return;
+  }
+
+  const TensorProto* conv_B_tensor_proto = nullptr;
+  if (input_defs.size() >= 3 && input_defs[2]->Exists() &&
+      !graph_.GetInitializedTensor(input_defs[2]->Name(), conv_B_tensor_proto)) {
+    return;
+  }
+
+  const auto* group_attr = utils::GetNodeAttribute(node, "group");
+  if (group_attr != nullptr && group_attr->i() != 1) {
+    return;
+  }
+
+  const int64_t block_size = static_cast<int64_t>(MlasNchwcGetBlockSize());
+  const int64_t output_channels = conv_W_tensor_proto->dims(0);
+  const int64_t input_channels = conv_W_tensor_proto->dims(1);
+
+  if (output_channels % block_size != 0) {
+    return;
+  }
+
+  // Use the input directly if it is already in NCHWc format. Otherwise, reorder the input if the number of
+  // channels is a multiple of the block size, else the kernel consumes the NCHW input directly. This is
+  // typical for the first convolution of an image model that has three input channels.
+  NodeArg* nchwc_input = LookupNchwcArgument(input_defs[0]);
+  bool filter_is_OIHWBo = false;
+
+  if (nchwc_input == nullptr) {
+    if (input_channels % block_size == 0) {
+      nchwc_input = ReorderInput(*input_defs[0]);
+    } else {
+      nchwc_input = input_defs[0];
+      filter_is_OIHWBo = true;
+    }
+  }
+
+  NodeArg* nchwc_filter;
+  auto filter_it = reordered_filters_.find(input_defs[1]);
+
+  if (filter_it != reordered_filters_.end()) {
+    nchwc_filter = filter_it->second;
+  } else {
+    Initializer conv_W(conv_W_tensor_proto);
+    std::vector<float> reordered_filter(static_cast<size_t>(conv_W.size()));
+
+    if (filter_is_OIHWBo) {
+      MlasReorderFilterOIHWBo(conv_W.dims().data(), conv_W.data<float>(), reordered_filter.data());
+    } else {
+      MlasReorderFilterOIHWBiBo(conv_W.dims().data(), conv_W.data<float>(), reordered_filter.data());
+    }
+
+    TensorProto nchwc_conv_W_tensor_proto;
+    nchwc_conv_W_tensor_proto.set_data_type(TensorProto_DataType_FLOAT);
+    nchwc_conv_W_tensor_proto.set_name(graph_.GenerateNodeArgName(input_defs[1]->Name() + "_nchwc"));
+    nchwc_conv_W_tensor_proto.set_raw_data(reordered_filter.data(), reordered_filter.size() * sizeof(float));
+    for (auto d : conv_W.dims()) {
+      nchwc_conv_W_tensor_proto.add_dims(d);
+    }
+
+    graph_.AddInitializedTensor(nchwc_conv_W_tensor_proto);
+
+    nchwc_filter = &graph_.GetOrCreateNodeArg(nchwc_conv_W_tensor_proto.name(), input_defs[1]->TypeAsProto());
+    reordered_filters_[input_defs[1]] = nchwc_filter;
+  }
+
+  std::vector<NodeArg*> nchwc_input_defs{nchwc_input, nchwc_filter};
+  if (conv_B_tensor_proto != nullptr) {
+    nchwc_input_defs.push_back(input_defs[2]);
+  }
+
+  // Fuse a following Relu into the convolution. The MLAS kernel applies the activation to each output row while
+  // it is still in the cache.
+  NodeArg* nchw_output = output_defs[0];
+  bool fuse_relu = false;
+
+  if (utils::GetNodeAttribute(node, "activation") == nullptr &&
+      node.GetOutputEdgesCount() == 1 &&
+      !graph_.IsNodeOutputsInGraphOutputs(node)) {
+    Node& next_node = *graph_.GetNode((*node.OutputNodesBegin()).Index());
+    if (utils::IsSupportedOptypeVersionAndDomain(next_node, "Relu", 6) &&
+        next_node.GetExecutionProviderType() == node.GetExecutionProviderType()) {
+      nchw_output = next_node.MutableOutputDefs()[0];
+      fuse_relu = true;
+      removed_nodes_.insert(next_node.Index());
+    }
+  }
+
+  NodeArg* nchwc_output = CreateNchwcArgument(*nchw_output);
+
+  Node& nchwc_node = graph_.AddNode(graph_.GenerateNodeName(node.Name() + "_nchwc"),
+                                    "NchwcConv",
+                                    "NCHWc " + node.Name(),
+                                    nchwc_input_defs,
+                                    {nchwc_output},
+                                    &node.GetAttributes(),
+                                    kMSDomain);
+  nchwc_node.SetExecutionProviderType(node.GetExecutionProviderType());
+
+  if (fuse_relu) {
+    nchwc_node.AddAttribute("activation", "Relu");
+  }
+
+  nchwc_args_[nchw_output] = nchwc_output;
+  removed_nodes_.insert(node.Index());
+}
+
+void NchwcTransformerImpl::TransformPool(Node& node) {
+  auto& input_defs = node.MutableInputDefs();
+  auto& output_defs = node.MutableOutputDefs();
+
+  // Pooling is only done in NCHWc format if the producer of the input has already been transformed.
+  NodeArg* nchwc_input = LookupNchwcArgument(input_defs[0]);
+  if (nchwc_input == nullptr) {
+    return;
+  }
+
+  // The NCHWc kernel does not produce the optional indices output of MaxPool.
+  if (output_defs.size() > 1 && output_defs[1]->Exists()) {
+    return;
+  }
+
+  const auto* kernel_shape_attr = utils::GetNodeAttribute(node, "kernel_shape");
+  if (kernel_shape_attr != nullptr && kernel_shape_attr->ints_size() != 2) {
+    return;
+  }
+
+  NodeAttributes nchwc_attributes;
+  for (const auto& attr : node.GetAttributes()) {
+    if (attr.first == "auto_pad" || attr.first == "kernel_shape" || attr.first == "pads" ||
+        attr.first == "strides" || attr.first == "count_include_pad") {
+      nchwc_attributes.insert(attr);
+    }
+  }
+
+  NodeArg* nchwc_output = CreateNchwcArgument(*output_defs[0]);
+
+  Node& nchwc_node = graph_.AddNode(graph_.GenerateNodeName(node.Name() + "_nchwc"),
+                                    "Nchwc" + node.OpType(),
+                                    "NCHWc " + node.Name(),
+                                    {nchwc_input},
+                                    {nchwc_output},
+                                    &nchwc_attributes,
+                                    kMSDomain);
+  nchwc_node.SetExecutionProviderType(node.GetExecutionProviderType());
+
+  nchwc_args_[output_defs[0]] = nchwc_output;
+  removed_nodes_.insert(node.Index());
+}
+
+void NchwcTransformerImpl::TransformElementwise(Node& node) {
+  auto& input_defs = node.MutableInputDefs();
+  auto& output_defs = node.MutableOutputDefs();
+
+  std::vector<NodeArg*> nchwc_inputs;
+  for (auto* input_def : input_defs) {
+    NodeArg* nchwc_input = LookupNchwcArgument(input_def);
+    if (nchwc_input == nullptr) {
+      return;
+    }
+    nchwc_inputs.push_back(nchwc_input);
+  }
+
+  // The elements of the inputs are only in the same order if the shapes are identical, so broadcasting is not
+  // supported.
+  if (input_defs.size() > 1) {
+    const auto* shape0 = input_defs[0]->Shape();
+    for (size_t i = 1; i < input_defs.size(); i++) {
+      const auto* shape = input_defs[i]->Shape();
+      if (shape0 == nullptr || shape == nullptr || shape0->dim_size() != shape->dim_size()) {
+        return;
+      }
+      for (int d = 0; d < shape0->dim_size(); d++) {
+        const auto& dim0 = shape0->dim(d);
+        const auto& dim = shape->dim(d);
+        if (!dim0.has_dim_value() || !dim.has_dim_value() || dim0.dim_value() != dim.dim_value()) {
+          return;
+        }
+      }
+    }
+  }
+
+  // The node operates on the NCHWc tensors in place of the NCHW tensors.
+  for (size_t i = 0; i < input_defs.size(); i++) {
+    RemoveInputEdge(node, static_cast<int>(i));
+    input_defs[i] = nchwc_inputs[i];
+  }
+
+  NodeArg* nchwc_output = CreateNchwcArgument(*output_defs[0]);
+  nchwc_args_[output_defs[0]] = nchwc_output;
+  output_defs[0] = nchwc_output;
+}
+
+void NchwcTransformerImpl::Transform(Node& node) {
+  if (removed_nodes_.count(node.Index()) != 0 ||
+      (!node.GetExecutionProviderType().empty() && node.GetExecutionProviderType() != kCpuExecutionProvider)) {
+    return;
+  }
+
+  if (utils::IsSupportedOptypeVersionAndDomain(node, "Conv", 1) ||
+      utils::IsSupportedOptypeVersionAndDomain(node, "FusedConv", 1, kMSDomain)) {
+    TransformConv(node);
+  } else if (utils::IsSupportedOptypeVersionAndDomain(node, "MaxPool", 1) ||
+             utils::IsSupportedOptypeVersionAndDomain(node, "MaxPool", 8) ||
+             utils::IsSupportedOptypeVersionAndDomain(node, "AveragePool", 1) ||
+             utils::IsSupportedOptypeVersionAndDomain(node, "AveragePool", 7) ||
+             utils::IsSupportedOptypeVersionAndDomain(node, "GlobalMaxPool", 1) ||
+             utils::IsSupportedOptypeVersionAndDomain(node, "GlobalAveragePool", 1)) {
+    TransformPool(node);
+  } else if (utils::IsSupportedOptypeVersionAndDomain(node, "Relu", 6) ||
+             utils::IsSupportedOptypeVersionAndDomain(node, "Add", 7)) {
+    TransformElementwise(node);
+  }
+}
+
+void NchwcTransformerImpl::Finalize(bool& modified) {
+  if (removed_nodes_.empty()) {
+    return;
+  }
+
+  for (auto index : removed_nodes_) {
+    Node* node = graph_.GetNode(index);
+
+    Node::EdgeSet output_edges;
+    for (auto it = node->OutputEdgesBegin(); it != node->OutputEdgesEnd(); ++it) {
+      output_edges.insert(*it);
+    }
+    for (auto& output_edge : output_edges) {
+      graph_.RemoveEdge(index, output_edge.GetNode().Index(), output_edge.GetSrcArgIndex(),
+                        output_edge.GetDstArgIndex());
+    }
+  }
+
+  for (auto index : removed_nodes_) {
+    graph_.RemoveNode(index);
+  }
+
+  // Reorder the arguments that are still consumed in NCHW format, either by a node that was not transformed or
+  // as an output of the graph.
+  std::vector<NodeArg*> nchw_args;
+  auto add_nchw_arg = [this, &nchw_args](const NodeArg* arg) {
+    auto it = nchwc_args_.find(const_cast<NodeArg*>(arg));
+    if (it != nchwc_args_.end() &&
+        std::find(nchw_args.begin(), nchw_args.end(), it->first) == nchw_args.end()) {
+      nchw_args.push_back(it->first);
+    }
+  };
+
+  for (const auto& node : graph_.Nodes()) {
+    for (const auto* input_def : node.InputDefs()) {
+      add_nchw_arg(input_def);
+    }
+    for (const auto* input_def : node.ImplicitInputDefs()) {
+      add_nchw_arg(input_def);
+    }
+  }
+  for (const auto* output : graph_.GetOutputs()) {
+    add_nchw_arg(output);
+  }
+
+  for (auto* nchw_arg : nchw_args) {
+    Node& reorder_node = graph_.AddNode(graph_.GenerateNodeName("ReorderOutput"),
+                                        "ReorderOutput",
+                                        "Reorder " + nchw_arg->Name() + " from NCHWc",
+                                        {nchwc_args_[nchw_arg]},
+                                        {nchw_arg},
+                                        nullptr,
+                                        kMSDomain);
+    reorder_node.SetExecutionProviderType(kCpuExecutionProvider);
+  }
+
+  modified = true;
+}
+
+}  // namespace
+
+Status NchwcTransformer::ApplyImpl(Graph& graph, bool& modified, int graph_level) const {
+  NchwcTransformerImpl impl(graph);
+  GraphViewer graph_viewer(graph);
+
+  for (auto index : graph_viewer.GetNodesInTopologicalOrder()) {
+    auto* node = graph.GetNode(index);
+    ORT_RETURN_IF_ERROR(Recurse(*node, modified, graph_level));
+    impl.Transform(*node);
+  }
+
+  impl.Finalize(modified);
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@Class NchwcTransformer
+
+Rewrites 2D convolutions with constant weights to use the channel blocked (NCHWc) format of MLAS. The layout is
+propagated through pooling, Relu and Add nodes so that the tensors are only reordered at the boundaries of a
+region of NCHWc nodes.
+*/
+class NchwcTransformer : public onnxruntime::GraphTransformer {
+ public:
+  NchwcTransformer() noexcept : onnxruntime::GraphTransformer("NchwcTransformer", "Transforms to the NCHWc layout") {}
+
+ private:
+  Status ApplyImpl(onnxruntime::Graph& graph, bool& modified, int graph_level) const override;
+};
+
+}  // namespace onnxruntime
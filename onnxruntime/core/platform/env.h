@@ -109,6 +109,31 @@ class Env {
   virtual common::Status FileOpenWr(const std::string& path, /*out*/ int& fd) const = 0;
   //Mainly for use with protobuf library
   virtual common::Status FileClose(int fd) const = 0;
+
+  using MappedMemoryPtr = std::unique_ptr<char[], std::function<void(char*)>>;
+
+  // \brief Map the whole content of a file into memory.
+  //
+  // "path" is UTF-8 encoded. The mapping is private: pages are only read from the file on first access and
+  // writes through the returned pointer are never carried back to the file.
+  // On success, "mapped_memory" owns the mapping (it is unmapped when destroyed) and
+  // "file_length" holds its size. An empty file yields a null pointer and a length of 0.
+  virtual common::Status MapFileIntoMemory(const std::string& path, /*out*/ MappedMemoryPtr& mapped_memory,
+                                           /*out*/ size_t& file_length) const = 0;
+
+  // \brief Get the size and the time of the last modification of a file without opening it.
+  //
+  // "path" is UTF-8 encoded. The unit and epoch of "modification_time" depend on the platform, so it's only
+  // meaningful to compare it with another value returned by this function.
+  virtual common::Status GetFileInfo(const std::string& path, /*out*/ uint64_t& file_length,
+                                     /*out*/ uint64_t& modification_time) const = 0;
+
+  // \brief Rename a file, atomically replacing "new_path" if it exists.
+  //
+  // The paths are UTF-8 encoded and should be in the same directory (file system). Readers of "new_path" see
+  // either the old or the new file, never a missing or partially written one.
+  virtual common::Status ReplaceFile(const std::string& old_path, const std::string& new_path) const = 0;
+
   //This functions is always successful. It can't fail.
   virtual PIDType GetSelfPid() const = 0;
 
@@ -170,6 +195,8 @@ struct ThreadOptions {
   size_t stack_size = 0;  // 0: use system default value
   /// Guard area size to use near thread stacks to use (in bytes)
   size_t guard_size = 0;  // 0: use system default value
+  /// Logical processor to pin the thread to.
+  int affinity = -1;  // -1: no affinity
 };
 
 }  // namespace onnxruntime
@@ -17,8 +17,11 @@ limitations under the License.
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <dlfcn.h>
+#include <pthread.h>
+#include <sched.h>
 #include <string.h>
 #include <thread>
 #include <vector>
@@ -86,8 +89,23 @@ class PosixEnv : public Env {
     }
   }
 
-  Thread* StartThread(const ThreadOptions& /*thread_options*/, const std::string& /*name*/,
+  Thread* StartThread(const ThreadOptions& thread_options, const std::string& /*name*/,
                       std::function<void()> fn) const override {
+#if defined(__linux__)
+    if (thread_options.affinity >= 0 && thread_options.affinity < CPU_SETSIZE) {
+      int cpu = thread_options.affinity;
+      return new StdThread([cpu, fn]() {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu, &cpuset);
+        // affinity is a hint, so ignore failures (e.g. the processor is not in the process cpuset)
+        pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+        fn();
+      });
+    }
+#else
+    ORT_UNUSED_PARAMETER(thread_options);
+#endif
     return new StdThread(fn);
   }
 
@@ -119,6 +137,68 @@ class PosixEnv : public Env {
     return Status::OK();
   }
 
+  common::Status MapFileIntoMemory(const std::string& path, /*out*/ MappedMemoryPtr& mapped_memory,
+                                   /*out*/ size_t& file_length) const override {
+    mapped_memory = MappedMemoryPtr(nullptr, [](char*) {});
+    file_length = 0;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (0 > fd) {
+      return common::Status(common::SYSTEM, errno, "Failed to open " + path);
+    }
+
+    struct stat st;
+    if (0 != fstat(fd, &st)) {
+      int err = errno;
+      close(fd);
+      return common::Status(common::SYSTEM, err, "Failed to stat " + path);
+    }
+
+    const size_t length = static_cast<size_t>(st.st_size);
+    if (length == 0) {
+      close(fd);
+      return Status::OK();
+    }
+
+    // MAP_PRIVATE makes the mapping copy-on-write, so a kernel that writes into its input
+    // gets its own page instead of a fault or a modified file.
+    void* addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    int err = errno;
+    close(fd);  // the mapping holds its own reference to the file
+    if (addr == MAP_FAILED) {
+      return common::Status(common::SYSTEM, err, "Failed to map " + path);
+    }
+
+    mapped_memory = MappedMemoryPtr(static_cast<char*>(addr), [length](char* p) { munmap(p, length); });
+    file_length = length;
+    return Status::OK();
+  }
+
+  common::Status GetFileInfo(const std::string& path, /*out*/ uint64_t& file_length,
+                             /*out*/ uint64_t& modification_time) const override {
+    struct stat st;
+    if (0 != stat(path.c_str(), &st)) {
+      return common::Status(common::SYSTEM, errno, "Failed to stat " + path);
+    }
+
+    file_length = static_cast<uint64_t>(st.st_size);
+#ifdef __APPLE__
+    const auto& mtime = st.st_mtimespec;
+#else
+    const auto& mtime = st.st_mtim;
+#endif
+    modification_time = static_cast<uint64_t>(mtime.tv_sec) * 1000000000 + static_cast<uint64_t>(mtime.tv_nsec);
+    return Status::OK();
+  }
+
+  common::Status ReplaceFile(const std::string& old_path, const std::string& new_path) const override {
+    // rename replaces new_path atomically
+    if (0 != rename(old_path.c_str(), new_path.c_str())) {
+      return common::Status(common::SYSTEM, errno, "Failed to rename " + old_path + " to " + new_path);
+    }
+    return Status::OK();
+  }
+
   common::Status LoadDynamicLibrary(const std::string& library_filename, void** handle) const override {
     char* error_str = dlerror();  // clear any old error_str
     *handle = dlopen(library_filename.c_str(), RTLD_NOW | RTLD_LOCAL);
@@ -0,0 +1,199 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/platform/threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+#include "core/platform/env.h"
+#include "core/platform/ort_mutex.h"
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+#include <unsupported/Eigen/CXX11/ThreadPool>
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace onnxruntime {
+namespace concurrency {
+
+namespace {
+
+#if EIGEN_VERSION_AT_LEAST(3, 3, 90)
+template <typename Environment>
+using EigenThreadPoolTempl = Eigen::ThreadPoolTempl<Environment>;
+#else
+template <typename Environment>
+using EigenThreadPoolTempl = Eigen::NonBlockingThreadPoolTempl<Environment>;
+#endif
+
+// Adapter exposing an onnxruntime Env as the Environment type expected by Eigen's thread pool.
+// Eigen copies the environment into the pool and calls CreateThread once per worker, in order.
+class EigenEnvironment {
+ public:
+  using EnvThread = Thread;
+  using Task = Env::Task;
+
+  EigenEnvironment(const Env& env, const std::string& name, const std::vector<size_t>& affinity)
+      : env_(&env), name_(name), affinity_(affinity) {}
+
+  EnvThread* CreateThread(std::function<void()> f) {
+    ThreadOptions thread_options;
+    if (!affinity_.empty()) {
+      thread_options.affinity = static_cast<int>(affinity_[next_thread_index_ % affinity_.size()]);
+    }
+    ++next_thread_index_;
+    return env_->StartThread(thread_options, name_, std::move(f));
+  }
+
+  Task CreateTask(std::function<void()> f) {
+    return env_->CreateTask(std::move(f));
+  }
+
+  void ExecuteTask(const Task& t) {
+    env_->ExecuteTask(t);
+  }
+
+ private:
+  const Env* env_;
+  std::string name_;
+  std::vector<size_t> affinity_;
+  size_t next_thread_index_ = 0;
+};
+
+// State shared between the caller of ParallelFor and the tasks it schedules. Tasks may start running
+// after the caller has returned (all blocks were already claimed), so the state is reference counted
+// and the user function is only touched by a thread that successfully claimed a block.
+struct ParallelForState {
+  ParallelForState(std::ptrdiff_t begin0, std::ptrdiff_t end0, std::ptrdiff_t block_size0,
+                   std::ptrdiff_t num_blocks0,
+                   const std::function<void(std::ptrdiff_t, std::ptrdiff_t)>& fn0)
+      : begin(begin0),
+        end(end0),
+        block_size(block_size0),
+        num_blocks(num_blocks0),
+        fn(&fn0),
+        next_block(0),
+        pending_blocks(num_blocks0) {}
+
+  // Claim and run blocks until none are left.
+  void RunBlocks() {
+    for (;;) {
+      std::ptrdiff_t block = next_block.fetch_add(1, std::memory_order_relaxed);
+      if (block >= num_blocks) {
+        break;
+      }
+
+      std::ptrdiff_t first = begin + block * block_size;
+      std::ptrdiff_t last = std::min(end, first + block_size);
+
+      try {
+        (*fn)(first, last);
+      } catch (...) {
+        std::lock_guard<OrtMutex> lock(mutex);
+        if (!exception) {
+          exception = std::current_exception();
+        }
+      }
+
+      if (pending_blocks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<OrtMutex> lock(mutex);
+        done.notify_all();
+      }
+    }
+  }
+
+  void Wait() {
+    if (pending_blocks.load(std::memory_order_acquire) != 0) {
+      std::unique_lock<OrtMutex> lock(mutex);
+      while (pending_blocks.load(std::memory_order_acquire) != 0) {
+        done.wait(lock);
+      }
+    }
+  }
+
+  const std::ptrdiff_t begin;
+  const std::ptrdiff_t end;
+  const std::ptrdiff_t block_size;
+  const std::ptrdiff_t num_blocks;
+  const std::function<void(std::ptrdiff_t, std::ptrdiff_t)>* fn;
+
+  std::atomic<std::ptrdiff_t> next_block;
+  std::atomic<std::ptrdiff_t> pending_blocks;
+
+  OrtMutex mutex;
+  OrtCondVar done;
+  std::exception_ptr exception;  // GUARDED_BY(mutex)
+};
+
+}  // namespace
+
+class ThreadPool::Impl : public EigenThreadPoolTempl<EigenEnvironment> {
+ public:
+  Impl(const std::string& name, const ThreadPoolOptions& options, const Env& env)
+      : EigenThreadPoolTempl<EigenEnvironment>(options.num_threads, EigenEnvironment(env, name, options.affinity)) {}
+};
+
+ThreadPool::ThreadPool(const std::string& name, const ThreadPoolOptions& options, const Env* env) {
+  ORT_ENFORCE(options.num_threads >= 1, "A thread pool needs at least one worker thread.");
+  impl_ = std::make_unique<Impl>(name, options, env != nullptr ? *env : Env::Default());
+}
+
+ThreadPool::~ThreadPool() = default;
+
+void ThreadPool::Schedule(std::function<void()> fn) {
+  impl_->Schedule(std::move(fn));
+}
+
+void ThreadPool::ParallelFor(std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t grain,
+                             const std::function<void(std::ptrdiff_t first, std::ptrdiff_t last)>& fn) {
+  const std::ptrdiff_t total = end - begin;
+  if (total <= 0) {
+    return;
+  }
+
+  grain = std::max<std::ptrdiff_t>(grain, 1);
+
+  // The caller participates in the work, so split the range over the workers plus the calling thread.
+  // Oversubscribe the blocks so that threads finishing early can pick up the remaining work.
+  const std::ptrdiff_t degree_of_parallelism = static_cast<std::ptrdiff_t>(NumThreads()) + 1;
+  const std::ptrdiff_t max_blocks = degree_of_parallelism * 4;
+
+  std::ptrdiff_t block_size = std::max(grain, (total + max_blocks - 1) / max_blocks);
+  std::ptrdiff_t num_blocks = (total + block_size - 1) / block_size;
+
+  if (num_blocks == 1) {
+    fn(begin, end);
+    return;
+  }
+
+  auto state = std::make_shared<ParallelForState>(begin, end, block_size, num_blocks, fn);
+
+  const std::ptrdiff_t num_tasks = std::min(num_blocks - 1, degree_of_parallelism - 1);
+  for (std::ptrdiff_t i = 0; i < num_tasks; i++) {
+    impl_->Schedule([state]() { state->RunBlocks(); });
+  }
+
+  state->RunBlocks();
+  state->Wait();
+
+  if (state->exception) {
+    std::rethrow_exception(state->exception);
+  }
+}
+
+int ThreadPool::NumThreads() const {
+  return impl_->NumThreads();
+}
+
+int ThreadPool::CurrentThreadId() const {
+  return impl_->CurrentThreadId();
+}
+
+}  // namespace concurrency
+}  // namespace onnxruntime
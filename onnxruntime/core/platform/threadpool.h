@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+
+namespace onnxruntime {
+
+class Env;
+
+namespace concurrency {
+
+/**
+ * Options used to construct a ThreadPool.
+ */
+struct ThreadPoolOptions {
+  // Number of worker threads owned by the pool. The thread calling ParallelFor also participates
+  // in the work, so the effective degree of parallelism is num_threads + 1.
+  int num_threads = 0;
+
+  // Logical processors to pin the worker threads to. Worker i is pinned to affinity[i % affinity.size()].
+  // Leave empty to let the operating system schedule the workers.
+  std::vector<size_t> affinity;
+};
+
+/**
+ * Work-stealing thread pool shared by the kernels of a session.
+ *
+ * Every worker owns a double ended run queue. Work submitted from a worker goes to the front of its own
+ * queue and idle workers steal from the back of the other queues, so there is no global queue lock on
+ * the scheduling path. The implementation is Eigen's NonBlockingThreadPool parameterized on the
+ * onnxruntime Env so that worker creation goes through the platform abstraction.
+ */
+class ThreadPool {
+ public:
+  ThreadPool(const std::string& name, const ThreadPoolOptions& options, const Env* env = nullptr);
+  ~ThreadPool();
+
+  /**
+   * Schedule fn() for execution in the pool. No ordering or completion guarantees are given.
+   */
+  void Schedule(std::function<void()> fn);
+
+  /**
+   * Execute fn(first, last) over sub-ranges that partition [begin, end) and wait for all of them to
+   * complete. Each sub-range contains at least grain iterations (except possibly the last one).
+   * The calling thread executes sub-ranges as well, so it is safe to call ParallelFor from inside a
+   * task running on this pool. Exceptions thrown by fn are rethrown in the calling thread.
+   */
+  void ParallelFor(std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t grain,
+                   const std::function<void(std::ptrdiff_t first, std::ptrdiff_t last)>& fn);
+
+  /**
+   * Same as ParallelFor, but runs fn(begin, end) inline on the calling thread if tp is nullptr.
+   */
+  static void TryParallelFor(ThreadPool* tp, std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t grain,
+                             const std::function<void(std::ptrdiff_t first, std::ptrdiff_t last)>& fn) {
+    if (tp == nullptr) {
+      if (begin < end) {
+        fn(begin, end);
+      }
+      return;
+    }
+    tp->ParallelFor(begin, end, grain, fn);
+  }
+
+  /**
+   * Number of worker threads owned by the pool.
+   */
+  int NumThreads() const;
+
+  /**
+   * Index of the calling thread in the pool in the range [0, NumThreads()), or -1 if the calling
+   * thread is not a worker of this pool.
+   */
+  int CurrentThreadId() const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ThreadPool);
+
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace concurrency
+}  // namespace onnxruntime
@@ -45,8 +45,16 @@ class WindowsEnv : public Env {
  public:
   void SleepForMicroseconds(int64_t micros) const override { Sleep(static_cast<DWORD>(micros) / 1000); }
 
-  Thread* StartThread(const ThreadOptions&, const std::string&,
+  Thread* StartThread(const ThreadOptions& thread_options, const std::string&,
                       std::function<void()> fn) const override {
+    if (thread_options.affinity >= 0 && thread_options.affinity < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+      DWORD_PTR mask = static_cast<DWORD_PTR>(1) << thread_options.affinity;
+      return new StdThread([mask, fn]() {
+        // affinity is a hint, so ignore failures
+        SetThreadAffinityMask(GetCurrentThread(), mask);
+        fn();
+      });
+    }
     return new StdThread(fn);
   }
 
@@ -134,6 +142,98 @@ class WindowsEnv : public Env {
     return Status::OK();
   }
 
+  common::Status MapFileIntoMemory(const std::string& path, /*out*/ MappedMemoryPtr& mapped_memory,
+                                   /*out*/ size_t& file_length) const override {
+    mapped_memory = MappedMemoryPtr(nullptr, [](char*) {});
+    file_length = 0;
+
+    // the path is UTF-8 encoded
+    const int wide_length = ::MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    if (wide_length <= 0) {
+      return common::Status(common::SYSTEM, static_cast<int>(::GetLastError()), "Invalid path " + path);
+    }
+    std::wstring wide_path(wide_length, L'\0');
+    ::MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide_path[0], wide_length);
+
+    HANDLE file = ::CreateFileW(wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_READONLY, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      return common::Status(common::SYSTEM, static_cast<int>(::GetLastError()), "Failed to open " + path);
+    }
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size)) {
+      const auto err = ::GetLastError();
+      ::CloseHandle(file);
+      return common::Status(common::SYSTEM, static_cast<int>(err), "Failed to get the size of " + path);
+    }
+
+    if (size.QuadPart == 0) {
+      ::CloseHandle(file);
+      return Status::OK();
+    }
+
+    // PAGE_WRITECOPY/FILE_MAP_COPY make the view copy-on-write, so writes never reach the file.
+    HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    const auto mapping_err = ::GetLastError();
+    ::CloseHandle(file);
+    if (mapping == nullptr) {
+      return common::Status(common::SYSTEM, static_cast<int>(mapping_err), "Failed to map " + path);
+    }
+
+    void* addr = ::MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    const auto view_err = ::GetLastError();
+    ::CloseHandle(mapping);  // the view keeps the mapping alive
+    if (addr == nullptr) {
+      return common::Status(common::SYSTEM, static_cast<int>(view_err), "Failed to map a view of " + path);
+    }
+
+    mapped_memory = MappedMemoryPtr(static_cast<char*>(addr), [](char* p) { ::UnmapViewOfFile(p); });
+    file_length = static_cast<size_t>(size.QuadPart);
+    return Status::OK();
+  }
+
+  common::Status GetFileInfo(const std::string& path, /*out*/ uint64_t& file_length,
+                             /*out*/ uint64_t& modification_time) const override {
+    // the path is UTF-8 encoded
+    const int wide_length = ::MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    if (wide_length <= 0) {
+      return common::Status(common::SYSTEM, static_cast<int>(::GetLastError()), "Invalid path " + path);
+    }
+    std::wstring wide_path(wide_length, L'\0');
+    ::MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide_path[0], wide_length);
+
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!::GetFileAttributesExW(wide_path.c_str(), GetFileExInfoStandard, &attributes)) {
+      return common::Status(common::SYSTEM, static_cast<int>(::GetLastError()), "Failed to stat " + path);
+    }
+
+    file_length = (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+    modification_time = (static_cast<uint64_t>(attributes.ftLastWriteTime.dwHighDateTime) << 32) |
+                        attributes.ftLastWriteTime.dwLowDateTime;
+    return Status::OK();
+  }
+
+  common::Status ReplaceFile(const std::string& old_path, const std::string& new_path) const override {
+    // the paths are UTF-8 encoded
+    auto to_wide = [](const std::string& path) {
+      const int wide_length = ::MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+      std::wstring wide_path(wide_length > 0 ? wide_length : 0, L'\0');
+      if (wide_length > 0) {
+        ::MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide_path[0], wide_length);
+      }
+      return wide_path;
+    };
+
+    // unlike rename, MoveFileEx replaces an existing file, and does so atomically on the same volume
+    if (!::MoveFileExW(to_wide(old_path).c_str(), to_wide(new_path).c_str(),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+      return common::Status(common::SYSTEM, static_cast<int>(::GetLastError()),
+                            "Failed to rename " + old_path + " to " + new_path);
+    }
+    return Status::OK();
+  }
+
   virtual Status LoadDynamicLibrary(const std::string& library_filename, void** handle) const override {
     *handle = ::LoadLibraryA(library_filename.c_str());
     if (!handle)
@@ -3,6 +3,7 @@
 
 #include "core/providers/cpu/activation/activations.h"
 #include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 
@@ -30,12 +31,23 @@ REGISTER_UNARY_ELEMENTWISE_KERNEL(Softsign, 1);
 REGISTER_UNARY_ELEMENTWISE_KERNEL(Tanh, 6);
 REGISTER_UNARY_ELEMENTWISE_KERNEL(ThresholdedRelu, 1);
 
+// Minimum number of elements computed by a single task when an activation is split across the intra-op
+// thread pool. Smaller tensors are computed on the calling thread as dispatching costs more than it saves.
+static constexpr std::ptrdiff_t kActivationParallelGrain = 16 * 1024;
+
 template <>
 Status Sigmoid<float>::Compute(OpKernelContext* context) const {
   const Tensor* X = context->Input<Tensor>(0);
   const auto& x_shape = X->Shape();
   Tensor* Y = context->Output(0, x_shape);
-  MlasComputeLogistic(X->template Data<float>(), Y->template MutableData<float>(), x_shape.Size());
+  const float* x_data = X->template Data<float>();
+  float* y_data = Y->template MutableData<float>();
+  concurrency::ThreadPool::TryParallelFor(context->GetOperatorThreadPool(), 0, x_shape.Size(),
+                                          kActivationParallelGrain,
+                                          [x_data, y_data](std::ptrdiff_t first, std::ptrdiff_t last) {
+                                            MlasComputeLogistic(x_data + first, y_data + first,
+                                                                static_cast<size_t>(last - first));
+                                          });
   return Status::OK();
 }
 
@@ -44,7 +56,14 @@ Status Tanh<float>::Compute(OpKernelContext* context) const {
   const Tensor* X = context->Input<Tensor>(0);
   const auto& x_shape = X->Shape();
   Tensor* Y = context->Output(0, x_shape);
-  MlasComputeTanh(X->template Data<float>(), Y->template MutableData<float>(), x_shape.Size());
+  const float* x_data = X->template Data<float>();
+  float* y_data = Y->template MutableData<float>();
+  concurrency::ThreadPool::TryParallelFor(context->GetOperatorThreadPool(), 0, x_shape.Size(),
+                                          kActivationParallelGrain,
+                                          [x_data, y_data](std::ptrdiff_t first, std::ptrdiff_t last) {
+                                            MlasComputeTanh(x_data + first, y_data + first,
+                                                            static_cast<size_t>(last - first));
+                                          });
   return Status::OK();
 }
 
@@ -12,9 +12,10 @@ namespace onnxruntime {
 // Information needed to construct CPU execution providers.
 struct CPUExecutionProviderInfo {
   bool create_arena{true};
+  bool create_arena_thread_cache{false};
 
-  explicit CPUExecutionProviderInfo(bool use_arena)
-      : create_arena(use_arena) {}
+  explicit CPUExecutionProviderInfo(bool use_arena, bool use_arena_thread_cache = false)
+      : create_arena(use_arena), create_arena_thread_cache(use_arena_thread_cache) {}
   CPUExecutionProviderInfo() = default;
 };
 
@@ -32,6 +33,7 @@ class CPUExecutionProvider : public IExecutionProvider {
         std::shared_ptr<IArenaAllocator>(
             std::make_unique<DummyArena>(device_info.factory(0))));
 #else
+    device_info.use_thread_cache = info.create_arena_thread_cache;
     if (info.create_arena)
       InsertAllocator(CreateAllocator(device_info));
     else
@@ -5,9 +5,11 @@
 
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/mlas/inc/mlas.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 #include "gemm_helper.h"
+#include "gemm_prepack.h"
 
 namespace onnxruntime {
 
@@ -29,6 +31,24 @@ class Gemm : public OpKernel {
     ORT_ENFORCE(info.GetAttr<float>("beta", &beta_).IsOK());
   }
 
+  Status PrePack(const Tensor& tensor, int input_idx, bool& is_packed) override {
+    is_packed = false;
+
+    // pack a constant W once so the float GEMM doesn't repack it on every run
+    if (input_idx == 1 && std::is_same<T_X, float>::value && std::is_same<T_W, float>::value &&
+        std::is_same<T_Y, float>::value) {
+      auto alloc = Info().GetAllocator(0, OrtMemTypeDefault);
+      const bool trans_b = trans_B_ != CblasNoTrans;
+      // a half precision W (GemmHalfWeight) stays half precision in the packed buffer
+      packed_b_half_ = tensor.DataType() == DataTypeImpl::GetType<MLFloat16>();
+      is_packed = packed_b_half_ ? GemmPackBHalf(alloc, tensor, trans_b, packed_b_)
+                                 : GemmPackBFloat(alloc, tensor, trans_b, packed_b_);
+      packed_b_source_ = is_packed ? tensor.DataRaw() : nullptr;
+    }
+
+    return Status::OK();
+  }
+
   Status Compute(OpKernelContext* context) const override {
     const auto X = context->Input<Tensor>(0);
     const auto W = context->Input<Tensor>(1);
@@ -95,18 +115,52 @@ class Gemm : public OpKernel {
     }
 
     // W * x
-    math::Gemm<T_X, CPUMathUtil>(
-        trans_A_,
-        trans_B_,
-        M,
-        N,
-        K,
-        alpha_,
-        X->template Data<T_X>(),
-        W->template Data<T_W>(),
-        beta_,
-        y_data,
-        &CPUMathUtil::Instance());
+    if (packed_b_ && W->DataRaw() == packed_b_source_) {
+      auto packed_b_gemm = packed_b_half_ ? MlasSgemmPackedBHalf : MlasSgemmPackedB;
+      packed_b_gemm(
+          trans_A_,
+          static_cast<size_t>(M),
+          static_cast<size_t>(N),
+          static_cast<size_t>(K),
+          alpha_,
+          reinterpret_cast<const float*>(X->template Data<T_X>()),
+          static_cast<size_t>(trans_A_ == CblasNoTrans ? K : M),
+          packed_b_.get(),
+          beta_,
+          reinterpret_cast<float*>(y_data),
+          static_cast<size_t>(N),
+          context->GetOperatorThreadPool());
+    } else {
+      const T_W* w_data;
+      BufferUniquePtr w_float_buffer;
+      if (W->DataType() == DataTypeImpl::GetType<MLFloat16>()) {
+        // a half precision W that couldn't be packed is widened to float for this run
+        AllocatorPtr alloc;
+        ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+        const auto w_size = static_cast<size_t>(W->Shape().Size());
+        auto* w_float_data = static_cast<float*>(alloc->Alloc(sizeof(float) * w_size));
+        w_float_buffer = BufferUniquePtr(w_float_data, BufferDeleter(alloc));
+        MlasConvertHalfToFloatBuffer(reinterpret_cast<const unsigned short*>(W->template Data<MLFloat16>()),
+                                     w_float_data,
+                                     w_size);
+        w_data = reinterpret_cast<const T_W*>(w_float_data);
+      } else {
+        w_data = W->template Data<T_W>();
+      }
+
+      math::Gemm<T_X, CPUMathUtil>(
+          trans_A_,
+          trans_B_,
+          M,
+          N,
+          K,
+          alpha_,
+          X->template Data<T_X>(),
+          w_data,
+          beta_,
+          y_data,
+          &CPUMathUtil::Instance());
+    }
 
     FuseActivation<T_Y>(activation_, y_data, M * N, leaky_relu_alpha_);
 
@@ -118,6 +172,11 @@ class Gemm : public OpKernel {
   CBLAS_TRANSPOSE trans_B_;
   float alpha_;
   float beta_;
+  // W packed by PrePack, if it's a constant initializer, and the initializer data it was packed from
+  BufferUniquePtr packed_b_;
+  const void* packed_b_source_ = nullptr;
+  // true if W is a half precision weight and packed_b_ holds it in half precision
+  bool packed_b_half_ = false;
 
 protected:
   // For fused gemm + activation
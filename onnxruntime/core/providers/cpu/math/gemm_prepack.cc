@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/cpu/math/gemm_prepack.h"
+
+#include "core/mlas/inc/mlas.h"
+
+namespace onnxruntime {
+
+bool GemmPackBFloat(const AllocatorPtr& alloc,
+                    const Tensor& tensor_b,
+                    bool trans_b,
+                    BufferUniquePtr& packed_b) {
+  const auto& b_shape = tensor_b.Shape();
+  if (tensor_b.DataType() != DataTypeImpl::GetType<float>() || b_shape.NumDimensions() != 2) {
+    return false;
+  }
+
+  const size_t K = static_cast<size_t>(trans_b ? b_shape[1] : b_shape[0]);
+  const size_t N = static_cast<size_t>(trans_b ? b_shape[0] : b_shape[1]);
+
+  const size_t packed_b_size = MlasSgemmPackBSize(N, K);
+  if (packed_b_size == 0) {
+    return false;
+  }
+
+  // the CPU allocator returns 64 byte aligned buffers as required by MLAS
+  void* packed_b_data = alloc->Alloc(packed_b_size);
+  packed_b = BufferUniquePtr(packed_b_data, BufferDeleter(alloc));
+
+  MlasSgemmPackB(trans_b ? CblasTrans : CblasNoTrans,
+                 N,
+                 K,
+                 tensor_b.Data<float>(),
+                 static_cast<size_t>(b_shape[1]),
+                 packed_b_data);
+  return true;
+}
+
+bool GemmPackBHalf(const AllocatorPtr& alloc,
+                   const Tensor& tensor_b,
+                   bool trans_b,
+                   BufferUniquePtr& packed_b) {
+  const auto& b_shape = tensor_b.Shape();
+  if (tensor_b.DataType() != DataTypeImpl::GetType<MLFloat16>() || b_shape.NumDimensions() != 2) {
+    return false;
+  }
+
+  const size_t K = static_cast<size_t>(trans_b ? b_shape[1] : b_shape[0]);
+  const size_t N = static_cast<size_t>(trans_b ? b_shape[0] : b_shape[1]);
+
+  const size_t packed_b_size = MlasSgemmPackBHalfSize(N, K);
+  if (packed_b_size == 0) {
+    return false;
+  }
+
+  void* packed_b_data = alloc->Alloc(packed_b_size);
+  packed_b = BufferUniquePtr(packed_b_data, BufferDeleter(alloc));
+
+  MlasSgemmPackBHalf(trans_b ? CblasTrans : CblasNoTrans,
+                     N,
+                     K,
+                     reinterpret_cast<const unsigned short*>(tensor_b.Data<MLFloat16>()),
+                     static_cast<size_t>(b_shape[1]),
+                     packed_b_data);
+  return true;
+}
+
+}  // namespace onnxruntime
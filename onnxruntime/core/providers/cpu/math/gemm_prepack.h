@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/framework/allocator.h"
+#include "core/framework/tensor.h"
+
+namespace onnxruntime {
+/**
+Pack the constant B input of a float GEMM into the layout consumed by MlasSgemmPackedB.
+@param alloc Allocator for the packed buffer.
+@param tensor_b The B matrix, which must be a 2-D float tensor to be packed.
+@param trans_b True if B is transposed, i.e. stored as N x K.
+@param packed_b Receives the packed buffer.
+@returns True if B was packed, false if the tensor cannot be packed.
+*/
+bool GemmPackBFloat(const AllocatorPtr& alloc,
+                    const Tensor& tensor_b,
+                    bool trans_b,
+                    BufferUniquePtr& packed_b);
+
+/**
+Pack the constant half precision B input of a float GEMM into the layout consumed by MlasSgemmPackedBHalf.
+The packed buffer keeps B in half precision; MLAS converts it to float as it copies each panel.
+@param alloc Allocator for the packed buffer.
+@param tensor_b The B matrix, which must be a 2-D MLFloat16 tensor to be packed.
+@param trans_b True if B is transposed, i.e. stored as N x K.
+@param packed_b Receives the packed buffer.
+@returns True if B was packed, false if the tensor cannot be packed.
+*/
+bool GemmPackBHalf(const AllocatorPtr& alloc,
+                   const Tensor& tensor_b,
+                   bool trans_b,
+                   BufferUniquePtr& packed_b);
+}  // namespace onnxruntime
@@ -2,8 +2,9 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/math/hardmax.h"
-#include "core/util/math_cpuonly.h"
-#include "core/util/math.h"
+#include "core/mlas/inc/mlas.h"
+
+#include <algorithm>
 
 namespace onnxruntime {
 
@@ -13,32 +14,19 @@ Status Hardmax<float>::Compute(OpKernelContext* ctx) const {
   const TensorShape& input_shape = X->Shape();
   const float* Xdata = X->template Data<float>();
 
-  size_t tmpN = input_shape.SizeToDimension(axis_);
-  size_t tmpD = input_shape.SizeFromDimension(axis_);
-
-  // Math::RowwiseMax expects int N and D.
-  if (tmpN * tmpD > INT32_MAX || tmpN > INT32_MAX || tmpD > INT32_MAX) {
-    std::ostringstream ss;
-    ss << "Hardmax inputs N, D and N * D must be < " << INT32_MAX << ". N=" << tmpN << ", D=" << tmpD;
-    std::string msg = ss.str();
-
-    return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, msg);
-  }
-
-  const int N = gsl::narrow_cast<int>(tmpN);
-  const int D = gsl::narrow_cast<int>(tmpD);
-
-  std::vector<float> rowmax_(N);
-  float* rowmax_data = rowmax_.data();
-  math::RowwiseMax<float, CPUMathUtil>(N, D, Xdata, rowmax_data, nullptr);
+  const size_t N = input_shape.SizeToDimension(axis_);
+  const size_t D = input_shape.SizeFromDimension(axis_);
 
   Tensor* Y = ctx->Output(0, input_shape);
   float* Ydata = Y->template MutableData<float>();
-  math::Set<float, CPUMathUtil>(input_shape.Size(), 0.f, Ydata, &CPUMathUtil::Instance());
-
-  for (int i = 0; i < N; ++i) {
-    for (int j = 0; j < D; ++j) {
-      if (Xdata[i * D + j] == rowmax_data[i]) {
+  std::fill_n(Ydata, N * D, 0.f);
+
+  // find the row maximum with the vectorized MLAS reduction, then mark its first occurrence
+  for (size_t i = 0; i < N; ++i) {
+    const float* x = Xdata + i * D;
+    const float rowmax = MlasReduceMaximum(x, D);
+    for (size_t j = 0; j < D; ++j) {
+      if (x[j] == rowmax) {
         Ydata[i * D + j] = 1;
         break;
       }
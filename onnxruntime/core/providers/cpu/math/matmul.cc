@@ -3,8 +3,10 @@
 
 #include "core/providers/cpu/math/matmul.h"
 
+#include "core/mlas/inc/mlas.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
+#include "gemm_prepack.h"
 #include "matmul_helper.h"
 
 namespace onnxruntime {
@@ -16,6 +18,21 @@ ONNX_CPU_OPERATOR_VERSIONED_KERNEL(
   KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
   MatMul<float>);
 
+template <>
+Status MatMul<float>::PrePack(const Tensor& tensor, int input_idx, bool& is_packed) {
+  is_packed = false;
+
+  if (input_idx == 1) {
+    auto alloc = Info().GetAllocator(0, OrtMemTypeDefault);
+    packed_b_half_ = tensor.DataType() == DataTypeImpl::GetType<MLFloat16>();
+    is_packed = packed_b_half_ ? GemmPackBHalf(alloc, tensor, false, packed_b_)
+                               : GemmPackBFloat(alloc, tensor, false, packed_b_);
+    packed_b_source_ = is_packed ? tensor.DataRaw() : nullptr;
+  }
+
+  return Status::OK();
+}
+
 template <>
 Status MatMul<float>::Compute(OpKernelContext* ctx) const {
   const Tensor* left_X = ctx->Input<Tensor>(0);
@@ -26,21 +43,72 @@ Status MatMul<float>::Compute(OpKernelContext* ctx) const {
 
   Tensor* Y = ctx->Output(0, helper.OutputShape());
 
-  // TODO: replace it with GemmBatch for performance, it's OK for now as GemmBatch unrolls as well
-  for (int i = 0; i < helper.OutputOffsets().size(); i++) {
-    math::Gemm<float, CPUMathUtil>(
-        CblasNoTrans,
+  const size_t M = static_cast<size_t>(helper.M());
+  const size_t N = static_cast<size_t>(helper.N());
+  const size_t K = static_cast<size_t>(helper.K());
+
+  if (packed_b_ && right_X->DataRaw() == packed_b_source_) {
+    // B is a 2-D matrix, so the helper has flattened the batches of A into the rows of a single GEMM
+    ORT_ENFORCE(helper.OutputOffsets().size() == 1);
+    auto packed_b_gemm = packed_b_half_ ? MlasSgemmPackedBHalf : MlasSgemmPackedB;
+    packed_b_gemm(
         CblasNoTrans,
-        static_cast<int>(helper.M()),
-        static_cast<int>(helper.N()),
-        static_cast<int>(helper.K()),
+        M,
+        N,
+        K,
         /* alpha */ 1.0f,
-        left_X->template Data<float>() + helper.LeftOffsets()[i],
-        right_X->template Data<float>() + helper.RightOffsets()[i],
+        left_X->template Data<float>(),
+        K,
+        packed_b_.get(),
         /* beta */ 0.0f,
-        Y->template MutableData<float>() + helper.OutputOffsets()[i],
-        &CPUMathUtil::Instance());
+        Y->template MutableData<float>(),
+        N,
+        ctx->GetOperatorThreadPool());
+    return Status::OK();
+  }
+
+  // run all of the (possibly broadcast) batches in a single MLAS dispatch
+  const float* a_data = left_X->template Data<float>();
+  const float* b_data;
+  BufferUniquePtr b_float_buffer;
+  if (right_X->DataType() == DataTypeImpl::GetType<MLFloat16>()) {
+    // a half precision B that couldn't be packed is widened to float for this run
+    AllocatorPtr alloc;
+    ORT_RETURN_IF_ERROR(ctx->GetTempSpaceAllocator(&alloc));
+    const auto b_size = static_cast<size_t>(right_X->Shape().Size());
+    auto* b_float_data = static_cast<float*>(alloc->Alloc(sizeof(float) * b_size));
+    b_float_buffer = BufferUniquePtr(b_float_data, BufferDeleter(alloc));
+    MlasConvertHalfToFloatBuffer(reinterpret_cast<const unsigned short*>(right_X->template Data<MLFloat16>()),
+                                 b_float_data,
+                                 b_size);
+    b_data = b_float_data;
+  } else {
+    b_data = right_X->template Data<float>();
   }
+  float* y_data = Y->template MutableData<float>();
+
+  const size_t batch_count = helper.OutputOffsets().size();
+  std::vector<MLAS_SGEMM_DATA_PARAMS> data(batch_count);
+  for (size_t i = 0; i < batch_count; i++) {
+    data[i].A = a_data + helper.LeftOffsets()[i];
+    data[i].lda = K;
+    data[i].B = b_data + helper.RightOffsets()[i];
+    data[i].ldb = N;
+    data[i].C = y_data + helper.OutputOffsets()[i];
+    data[i].ldc = N;
+  }
+
+  MlasSgemmBatch(
+      CblasNoTrans,
+      CblasNoTrans,
+      M,
+      N,
+      K,
+      /* alpha */ 1.0f,
+      data.data(),
+      /* beta */ 0.0f,
+      batch_count,
+      ctx->GetOperatorThreadPool());
 
   return Status::OK();
 }
@@ -15,7 +15,22 @@ class MatMul final : public OpKernel {
       : OpKernel(info) {
   }
 
+  Status PrePack(const Tensor& tensor, int input_idx, bool& is_packed) override;
+
   Status Compute(OpKernelContext* context) const override;
+
+ private:
+  // B packed by PrePack, if it's a 2-D constant initializer, and the initializer data it was packed from
+  BufferUniquePtr packed_b_;
+  const void* packed_b_source_ = nullptr;
+  // true if B is a half precision weight (MatMulHalfWeight) and packed_b_ holds it in half precision
+  bool packed_b_half_ = false;
 };
 
+template <>
+Status MatMul<float>::PrePack(const Tensor& tensor, int input_idx, bool& is_packed);
+
+template <>
+Status MatMul<float>::Compute(OpKernelContext* ctx) const;
+
 }  // namespace onnxruntime
@@ -2,10 +2,93 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/nn/conv_impl.h"
+
+#include <algorithm>
+
 #include "core/util/math_cpuonly.h"
 
 namespace onnxruntime {
 
+template <>
+Status Conv<float>::PrePack(const Tensor& tensor, int input_idx, bool& is_packed) {
+  is_packed = false;
+
+  const bool half_filter = tensor.DataType() == DataTypeImpl::GetType<MLFloat16>();
+  if (input_idx != 1 || (tensor.DataType() != DataTypeImpl::GetType<float>() && !half_filter)) {
+    return Status::OK();
+  }
+
+  // MlasConvPrepare only selects the Winograd algorithm for 3x3 kernels with unit strides and dilations, so
+  // skip transforming filters that can never use it.
+  const auto& w_shape = tensor.Shape();
+  auto all_ones = [](const std::vector<int64_t>& values) {
+    return std::all_of(values.begin(), values.end(), [](int64_t v) { return v == 1; });
+  };
+  if (w_shape.NumDimensions() != 4 || w_shape[2] != 3 || w_shape[3] != 3 ||
+      !all_ones(strides_) || !all_ones(dilations_) || group_ <= 0 || w_shape[0] % group_ != 0) {
+    return Status::OK();
+  }
+
+  const auto group_count = static_cast<size_t>(group_);
+  const auto input_channels = static_cast<size_t>(w_shape[1]);
+  const auto filter_count = static_cast<size_t>(w_shape[0] / group_);
+
+  // MlasConvPrepare also rejects too few channels (which includes every depthwise convolution) and outputs
+  // smaller than a Winograd tile. The output size is only checked here if the input shape is known.
+  if (!MlasConvWinogradIsSupported(input_channels, filter_count)) {
+    return Status::OK();
+  }
+  const auto* x_shape = Node().InputDefs()[0]->Shape();
+  if (x_shape != nullptr && x_shape->dim_size() == 4) {
+    for (int i = 0; i < 2; ++i) {
+      const auto& input_dim = x_shape->dim(2 + i);
+      if (!input_dim.has_dim_value()) {
+        continue;
+      }
+      int64_t output_dim = input_dim.dim_value() - 2;
+      if (auto_pad_ == AutoPadType::SAME_UPPER || auto_pad_ == AutoPadType::SAME_LOWER) {
+        output_dim = input_dim.dim_value();
+      } else if (auto_pad_ == AutoPadType::NOTSET && pads_.size() == 4) {
+        output_dim += pads_[i] + pads_[i + 2];
+      }
+      if (output_dim < 4) {
+        return Status::OK();
+      }
+    }
+  }
+
+  auto alloc = Info().GetAllocator(0, OrtMemTypeDefault);
+  void* transformed_w_data =
+      alloc->Alloc(sizeof(float) * MlasConvWinogradGetFilterSize(group_count, input_channels, filter_count));
+  transformed_w_ = BufferUniquePtr(transformed_w_data, BufferDeleter(alloc));
+
+  // a half precision filter (ConvHalfWeight) is widened to float before it's transformed
+  const float* filter_data;
+  BufferUniquePtr filter_float_buffer;
+  if (half_filter) {
+    const auto filter_size = static_cast<size_t>(w_shape.Size());
+    auto* filter_float_data = static_cast<float*>(alloc->Alloc(sizeof(float) * filter_size));
+    filter_float_buffer = BufferUniquePtr(filter_float_data, BufferDeleter(alloc));
+    MlasConvertHalfToFloatBuffer(reinterpret_cast<const unsigned short*>(tensor.Data<MLFloat16>()),
+                                 filter_float_data,
+                                 filter_size);
+    filter_data = filter_float_data;
+  } else {
+    filter_data = tensor.Data<float>();
+  }
+
+  MlasConvWinogradTransformFilter(group_count,
+                                  input_channels,
+                                  filter_count,
+                                  filter_data,
+                                  static_cast<float*>(transformed_w_data));
+
+  transformed_w_source_ = tensor.DataRaw();
+  is_packed = true;
+
+  return Status::OK();
+}
+
 template <>
 Status Conv<float>::Compute(OpKernelContext* context) const {
   size_t num_inputs = OpKernel::Node().InputDefs().size();
@@ -46,6 +129,22 @@ Status Conv<float>::Compute(OpKernelContext* context) const {
   const float* Xdata = X->template Data<float>();
   float* Ydata = Y->template MutableData<float>();
 
+  // MLAS reads the filter as the A operand of its GEMMs, which isn't packed, so a half precision filter
+  // (ConvHalfWeight) is widened into a float scratch buffer for this run.
+  const float* Wdata;
+  BufferUniquePtr w_float_buffer;
+  if (W->DataType() == DataTypeImpl::GetType<MLFloat16>()) {
+    const auto w_size = static_cast<size_t>(W->Shape().Size());
+    auto* w_float_data = static_cast<float*>(alloc->Alloc(sizeof(float) * w_size));
+    w_float_buffer = BufferUniquePtr(w_float_data, BufferDeleter(alloc));
+    MlasConvertHalfToFloatBuffer(reinterpret_cast<const unsigned short*>(W->template Data<MLFloat16>()),
+                                 w_float_data,
+                                 w_size);
+    Wdata = w_float_data;
+  } else {
+    Wdata = W->template Data<float>();
+  }
+
   const size_t kernel_rank = kernel_shape.size();
 
   if (kernel_rank == 2 || kernel_rank == 3) {
@@ -79,18 +178,21 @@ Status Conv<float>::Compute(OpKernelContext* context) const {
                     strides.data(),
                     output_shape.GetDims().data(),
                     static_cast<size_t>(M / group_),
+                    W->DataRaw() == transformed_w_source_ ? static_cast<const float*>(transformed_w_.get()) : nullptr,
                     &Activation,
-                    &WorkingBufferSize);
+                    &WorkingBufferSize,
+                    context->GetOperatorThreadPool());
 
     auto working_data = WorkingBufferSize > 0 ? alloc->Alloc(sizeof(float) * WorkingBufferSize) : nullptr;
     BufferUniquePtr working_buffer(working_data, BufferDeleter(alloc));
 
     MlasConv(&Parameters,
              Xdata,
-             W->template Data<float>(),
+             Wdata,
              B != nullptr ? B->template Data<float>() : nullptr,
              static_cast<float*>(working_buffer.get()),
-             Ydata);
+             Ydata,
+             context->GetOperatorThreadPool());
   } else {
     const int64_t input_image_size = input_shape.Size();
     const int64_t output_image_size = output_shape.Size();
@@ -132,7 +234,7 @@ Status Conv<float>::Compute(OpKernelContext* context) const {
             output_image_size,
             kernel_dim,
             1,
-            W->template Data<float>() + group_id * W_offset,
+            Wdata + group_id * W_offset,
             col_buffer_data,
             0,
             Ydata + group_id * Y_offset,
@@ -27,7 +27,18 @@ class Conv : public OpKernel, public ConvBase {
   Conv(const OpKernelInfo& info) : OpKernel(info), ConvBase(info) {
   }
 
+  Status PrePack(const Tensor& tensor, int input_idx, bool& is_packed) override;
+
   Status Compute(OpKernelContext* context) const override;
+
+ protected:
+  // W transformed by PrePack for the Winograd algorithm, if it's a constant 3x3 filter, and the initializer
+  // data it was transformed from
+  BufferUniquePtr transformed_w_;
+  const void* transformed_w_source_ = nullptr;
 };
 
+template <>
+Status Conv<float>::PrePack(const Tensor& tensor, int input_idx, bool& is_packed);
+
 }  // namespace onnxruntime
@@ -9,7 +9,7 @@
 #include "core/providers/cpu/nn/conv_integer.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
-#include "core/util/gemmlowp_common_wrapper.h"
+#include "core/mlas/inc/mlas.h"
 
 namespace onnxruntime {
 namespace contrib {
@@ -17,12 +17,12 @@ Status ConvInteger::Compute(OpKernelContext* context) const {
   size_t num_inputs = OpKernel::Node().InputDefs().size();
   const Tensor* X = context->Input<Tensor>(0);
   const Tensor* W = context->Input<Tensor>(1);
-  int32_t input_offset = 0, filter_offset = 0;
+  uint8_t input_offset = 0, filter_offset = 0;
   if (num_inputs >= 3) {
     const Tensor* X_Zero_Point = context->Input<Tensor>(2);
     if (X_Zero_Point->Shape().NumDimensions() == 0 ||
         (X_Zero_Point->Shape().NumDimensions() == 1 && X_Zero_Point->Shape().GetDims().size() == 1)) {
-      input_offset = static_cast<int32_t>(*(X_Zero_Point->Data<uint8_t>()));
+      input_offset = *(X_Zero_Point->Data<uint8_t>());
     } else {
       //TODO: Add support for per-channel quantization.
       return Status(common::ONNXRUNTIME, common::FAIL, "Non per-tensor quantization is not supported now.");
@@ -32,7 +32,7 @@ Status ConvInteger::Compute(OpKernelContext* context) const {
     const Tensor* W_Zero_Point = context->Input<Tensor>(3);
     if (W_Zero_Point->Shape().NumDimensions() == 0 ||
         (W_Zero_Point->Shape().NumDimensions() == 1 && W_Zero_Point->Shape().GetDims().size() == 1)) {
-      filter_offset = static_cast<int32_t>(*(W_Zero_Point->Data<uint8_t>()));
+      filter_offset = *(W_Zero_Point->Data<uint8_t>());
     } else {
       //TODO: Add support for per-channel quantization.
       return Status(common::ONNXRUNTIME, common::FAIL, "Non per-tensor quantization is not supported now.");
@@ -110,23 +110,18 @@ Status ConvInteger::Compute(OpKernelContext* context) const {
 		  input_offset);
 
       const uint8_t* filter_data_as_uint8 = W->template Data<uint8_t>() + group_id * W_offset;
-      static const gemmlowp::MapOrder ResultOrder = gemmlowp::MapOrder::RowMajor;
-      static const gemmlowp::MapOrder LhsOrder = gemmlowp::MapOrder::RowMajor;
-      static const gemmlowp::MapOrder RhsOrder = gemmlowp::MapOrder::RowMajor;
-      gemmlowp::MatrixMap<const std::uint8_t, LhsOrder> lhs(
-          filter_data_as_uint8, static_cast<int>(M / group_), static_cast<int>(kernel_dim));
-      gemmlowp::MatrixMap<const std::uint8_t, RhsOrder> rhs(
-          col_buffer_data, static_cast<int>(kernel_dim), static_cast<int>(output_image_size));
-      gemmlowp::MatrixMap<std::int32_t, ResultOrder> result(
-          Ydata + group_id * Y_offset, static_cast<int>(M / group_), static_cast<int>(output_image_size));
-      const std::tuple<> empty_pipeline = {};
-
-      gemmlowp::GemmContext gemm_context;
-      // TODO: worker thread pool needs to be handled.
-      gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::int32_t,
-                                       gemmlowp::DefaultL8R8BitDepthParams>(
-          &gemm_context, lhs, rhs, &result, -filter_offset, -input_offset,
-          empty_pipeline);
+      MlasQgemm(static_cast<size_t>(M / group_),
+                static_cast<size_t>(output_image_size),
+                static_cast<size_t>(kernel_dim),
+                filter_data_as_uint8,
+                static_cast<size_t>(kernel_dim),
+                filter_offset,
+                col_buffer_data,
+                static_cast<size_t>(output_image_size),
+                input_offset,
+                Ydata + group_id * Y_offset,
+                static_cast<size_t>(output_image_size),
+                context->GetOperatorThreadPool());
     }
 
     Xdata += X_offset * group_;
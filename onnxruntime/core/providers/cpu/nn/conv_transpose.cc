@@ -16,8 +16,7 @@
 /* Modifications Copyright (c) Microsoft. */
 
 #include "core/providers/cpu/nn/conv_transpose.h"
-#include "core/util/math.h"
-#include "core/util/math_cpuonly.h"
+#include "core/mlas/inc/mlas.h"
 
 namespace onnxruntime {
 
@@ -212,75 +211,64 @@ void ConvTransposeBase::ComputePadsAndOutputShape(
   output_shape->insert(output_shape->begin(), {N, output_channel, output_height, output_width});
 }
 
-template <typename T>
-Status ConvTranspose<T>::Compute(OpKernelContext* context) const {
+template <>
+Status ConvTranspose<float>::Compute(OpKernelContext* context) const {
   size_t num_inputs = OpKernel::Node().InputDefs().size();
   Prepare p;
   ORT_RETURN_IF_ERROR(PrepareForCompute(context, num_inputs == 3, p));
 
-  const int64_t input_image_size = p.H * p.W;
-  const int64_t X_offset = p.num_input_channels / group_ * input_image_size;
-  const int64_t Y_offset = p.Y->Shape().Size() / p.Y->Shape()[0] / group_;
-  const int64_t W_offset = p.F->Shape().Size() / group_;
-  const int64_t kernel_dim = p.num_output_channels / group_ * p.kernel_shape[0] * p.kernel_shape[1];
-  const int64_t output_image_size = p.Y->Shape()[2] * p.Y->Shape()[3];
+  MLAS_ACTIVATION Activation;
+  if (activation_.empty()) {
+    Activation.ActivationKind = MlasIdentityActivation;
+  } else if (activation_ == "Relu") {
+    Activation.ActivationKind = MlasReluActivation;
+  } else if (activation_ == "LeakyRelu") {
+    Activation.ActivationKind = MlasLeakyReluActivation;
+    Activation.alpha = alpha_;
+  } else if (activation_ == "Tanh") {
+    Activation.ActivationKind = MlasTanhActivation;
+  } else if (activation_ == "Sigmoid") {
+    Activation.ActivationKind = MlasLogisticActivation;
+  } else {
+    ORT_NOT_IMPLEMENTED("Not implemented fused activation: ", activation_);
+  }
+
+  const int64_t input_shape[] = {p.H, p.W};
+  const TensorShape output_shape = p.Y->Shape().Slice(2);
+
+  // MlasConvTranspose fuses the col2im into the GEMM output stage one tile of input pixels at a time, so only a
+  // per-thread column buffer is needed instead of one for the full image.
+  MLAS_CONV_PARAMETERS Parameters;
+  size_t WorkingBufferSize;
+  MlasConvTransposePrepare(&Parameters,
+                           p.kernel_shape.size(),
+                           static_cast<size_t>(p.N),
+                           static_cast<size_t>(group_),
+                           static_cast<size_t>(p.num_input_channels / group_),
+                           input_shape,
+                           p.kernel_shape.data(),
+                           p.dilations.data(),
+                           p.pads.data(),
+                           p.strides.data(),
+                           output_shape.GetDims().data(),
+                           static_cast<size_t>(p.num_output_channels / group_),
+                           &Activation,
+                           &WorkingBufferSize,
+                           context->GetOperatorThreadPool());
 
   AllocatorPtr alloc;
   ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
 
-  auto col_data = alloc->Alloc(sizeof(T) * kernel_dim * p.H * p.W);
-  BufferUniquePtr col_buffer(col_data, BufferDeleter(alloc));
-  T* col_buffer_data = static_cast<T*>(col_buffer.get());
-
-  const T* Xdata = p.X->template Data<T>();
-  const T* filter_data = p.F->template Data<T>();
-  T* Ydata = p.Y->template MutableData<T>();
-
-  for (auto image_id = 0; image_id < p.N; ++image_id) {
-    for (int group_id = 0; group_id < group_; ++group_id) {
-      // Weight term
-      math::Gemm<T, CPUMathUtil>(
-          CblasTrans,
-          CblasNoTrans,
-          kernel_dim,
-          input_image_size,
-          p.num_input_channels / group_,
-          1,
-          filter_data + group_id * W_offset,
-          Xdata + group_id * X_offset,
-          0,
-          col_buffer_data,
-          &CPUMathUtil::Instance());
-
-      // Col2im
-      math::Col2im<T, CPUMathUtil, StorageOrder::NCHW>(
-          col_buffer_data,
-          p.num_output_channels / group_,
-          p.Y->Shape()[2],
-          p.Y->Shape()[3],
-          p.kernel_shape[0],
-          p.kernel_shape[1],
-          p.dilations[0],
-          p.dilations[1],
-          p.pads[0],
-          p.pads[1],
-          p.pads[2],
-          p.pads[3],
-          p.strides[0],
-          p.strides[1],
-          Ydata + group_id * Y_offset,
-          &CPUMathUtil::Instance());
-    }
+  auto working_data = WorkingBufferSize > 0 ? alloc->Alloc(sizeof(float) * WorkingBufferSize) : nullptr;
+  BufferUniquePtr working_buffer(working_data, BufferDeleter(alloc));
 
-    if (p.B != nullptr) {
-      auto Ymatrix = EigenMatrixMap<T>(Ydata, output_image_size, p.num_output_channels);
-      auto Bvec = ConstEigenVectorMap<T>(p.B->template Data<T>(), p.num_output_channels);
-      Ymatrix.rowwise() += Bvec.transpose();
-    }
-
-    Xdata += X_offset * group_;
-    Ydata += Y_offset * group_;
-  }
+  MlasConvTranspose(&Parameters,
+                    p.X->template Data<float>(),
+                    p.F->template Data<float>(),
+                    p.B != nullptr ? p.B->template Data<float>() : nullptr,
+                    static_cast<float*>(working_buffer.get()),
+                    p.Y->template MutableData<float>(),
+                    context->GetOperatorThreadPool());
 
   return Status::OK();
 }
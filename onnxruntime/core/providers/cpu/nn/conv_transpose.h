@@ -69,4 +69,7 @@ class ConvTranspose : public OpKernel, public ConvTransposeBase {
   Status Compute(OpKernelContext* context) const override;
 };
 
+template <>
+Status ConvTranspose<float>::Compute(OpKernelContext* context) const;
+
 }  // namespace onnxruntime
@@ -3,171 +3,19 @@
 
 #include "core/providers/cpu/nn/pool.h"
 #include <cmath>
+#include "core/platform/threadpool.h"
+#include "core/util/math_cpuonly.h"
 using namespace ::onnxruntime::common;
 
 namespace onnxruntime {
 
-template <typename T, typename PoolType>
-Status Pool<T, PoolType>::Compute(OpKernelContext* context) const {
+Status PoolBase::Compute(OpKernelContext* context, MLAS_POOLING_KIND kind) const {
   const Tensor* X = context->Input<Tensor>(0);
-  const TensorShape& x_shape = X->Shape();
-
-  ORT_RETURN_IF_NOT(x_shape.NumDimensions() >= 3, "Input dimension cannot be less than 3.");
-
-  std::vector<int64_t> pads = pads_;
-  std::vector<int64_t> kernel_shape = kernel_shape_;
-
-  if (global_pooling_) {
-    const auto& input_dims = x_shape.GetDims();
-    kernel_shape.assign(input_dims.begin() + 2, input_dims.end());
-    pads.assign(kernel_shape.size(), 0);
-  }
-
-  std::vector<int64_t> output_dims = PoolBase::SetOutputSize(x_shape, x_shape[1], &pads);
-  Tensor* Y = context->Output(0, TensorShape(output_dims));
-
-  const float* X_data = X->template Data<float>();
-  float* Y_data = Y->template MutableData<float>();
-
-  // The main loop
-  int64_t channels = x_shape[1];
-  int64_t height = x_shape[2];
-  int64_t width = kernel_shape.size() > 1 ? x_shape[3] : 1;
-  int64_t depth = kernel_shape.size() > 2 ? x_shape[4] : 1;
-  int64_t pooled_height = output_dims[2];
-  int64_t pooled_width = kernel_shape.size() > 1 ? output_dims[3] : 1;
-  int64_t pooled_depth = kernel_shape.size() > 2 ? output_dims[4] : 1;
-
-  switch (kernel_shape.size()) {
-    case 1: {
-      int64_t x_step = height;
-      int64_t y_step = pooled_height;
-      const int64_t total_channels = x_shape[0] * channels;
-
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-      for (int64_t c = 0; c < total_channels; ++c) {
-        const float* x_d = X_data + c * x_step;
-        float* y_d = Y_data + c * y_step;
-
-        for (int64_t ph = 0; ph < pooled_height; ++ph) {
-          int64_t hstart = ph * stride_h() - pads[0];
-          int64_t hend = std::min(hstart + kernel_shape[0], height);
-          hstart = std::max(hstart, static_cast<int64_t>(0));
-          T Yh = PoolType::Initialize();
-          for (int64_t h = hstart; h < hend; ++h) {
-            PoolType::Process(x_d[h], Yh, pool_context_);
-          }
-          if (count_include_pad_) {
-            PoolType::Finalize(kernel_shape[0], Yh, pool_context_);
-          } else {
-            PoolType::Finalize(hend - hstart, Yh, pool_context_);
-          }
-          y_d[ph] = Yh;
-        }
-      }
-
-      break;
-    }
-
-    case 2: {
-      int64_t x_step = height * width;
-      int64_t y_step = pooled_height * pooled_width;
-      const int64_t total_channels = x_shape[0] * channels;
-
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-      for (int64_t c = 0; c < total_channels; ++c) {
-        const float* x_d = X_data + c * x_step;
-        float* y_d = Y_data + c * y_step;
-
-        for (int64_t ph = 0; ph < pooled_height; ++ph) {
-          int64_t hstart = ph * stride_h() - pads[0];
-          int64_t hend = std::min(hstart + kernel_shape[0], height);
-          hstart = std::max(hstart, static_cast<int64_t>(0));
-          for (int64_t pw = 0; pw < pooled_width; ++pw) {
-            int64_t wstart = pw * stride_w() - pads[1];
-            int64_t wend = std::min(wstart + kernel_shape[1], width);
-            wstart = std::max(wstart, static_cast<int64_t>(0));
-            const int64_t pool_index = ph * pooled_width + pw;
-            T Yh = PoolType::Initialize();
-            for (int64_t h = hstart; h < hend; ++h) {
-              for (int64_t w = wstart; w < wend; ++w) {
-                const int64_t input_index = h * width + w;
-                PoolType::Process(x_d[input_index], Yh, pool_context_);
-              }
-            }
-            if (count_include_pad_) {
-              PoolType::Finalize(kernel_shape[0] * kernel_shape[1], Yh, pool_context_);
-            } else {
-              PoolType::Finalize((hend - hstart) * (wend - wstart), Yh, pool_context_);
-            }
-            y_d[pool_index] = Yh;
-          }
-        }
-      }
-
-      break;
-    }
-    case 3: {
-      int64_t x_step = height * width * depth;
-      int64_t y_step = pooled_height * pooled_width * pooled_depth;
-      const int64_t total_channels = x_shape[0] * channels;
-
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-      for (int64_t c = 0; c < total_channels; ++c) {
-        const float* x_d = X_data + c * x_step;
-        float* y_d = Y_data + c * y_step;
-
-        for (int64_t ph = 0; ph < pooled_height; ++ph) {
-          int64_t hstart = ph * stride_h() - pads[0];
-          int64_t hend = std::min(hstart + kernel_shape[0], height);
-          hstart = std::max(hstart, static_cast<int64_t>(0));
-          for (int64_t pw = 0; pw < pooled_width; ++pw) {
-            int64_t wstart = pw * stride_w() - pads[1];
-            int64_t wend = std::min(wstart + kernel_shape[1], width);
-            wstart = std::max(wstart, static_cast<int64_t>(0));
-            for (int64_t pd = 0; pd < pooled_depth; ++pd) {
-              int64_t dstart = pd * stride_d() - pads[2];
-              int64_t dend = std::min(dstart + kernel_shape[2], depth);
-              dstart = std::max(dstart, static_cast<int64_t>(0));
-              const int64_t pool_index =
-                  ph * pooled_width * pooled_depth + pw * pooled_depth + pd;
-              T Yh = PoolType::Initialize();
-              for (int64_t h = hstart; h < hend; ++h) {
-                for (int64_t w = wstart; w < wend; ++w) {
-                  for (int64_t d = dstart; d < dend; ++d) {
-                    const int64_t input_index = h * width * depth + w * depth + d;
-                    PoolType::Process(x_d[input_index], Yh, pool_context_);
-                  }
-                }
-              }
-              if (count_include_pad_) {
-                PoolType::Finalize(kernel_shape[0] * kernel_shape[1] * kernel_shape[2], Yh, pool_context_);
-              } else {
-                PoolType::Finalize(
-                    (hend - hstart) * (wend - wstart) * (dend - dstart), Yh, pool_context_);
-              }
-              y_d[pool_index] = Yh;
-            }
-          }
-        }
-      }
-
-      break;
-    }
-    default:
-      return Status(ONNXRUNTIME, INVALID_ARGUMENT, "Unsupported pooling size : ");
-  }
-
-  return Status::OK();
+  Tensor* Y = nullptr;
+  return Compute(context, kind, X->template Data<float>(), &Y);
 }
 
-Status PoolBase::Compute(OpKernelContext* context, MLAS_POOLING_KIND kind) const {
+Status PoolBase::Compute(OpKernelContext* context, MLAS_POOLING_KIND kind, const float* input, Tensor** output) const {
   const Tensor* X = context->Input<Tensor>(0);
   const TensorShape& x_shape = X->Shape();
 
@@ -193,9 +41,11 @@ Status PoolBase::Compute(OpKernelContext* context, MLAS_POOLING_KIND kind) const
            global_pooling_ ? nullptr : pads.data(),
            global_pooling_ ? nullptr : strides_.data(),
            output_dims.data(),
-           X->template Data<float>(),
-           Y->template MutableData<float>());
+           input,
+           Y->template MutableData<float>(),
+           context->GetOperatorThreadPool());
 
+  *output = Y;
   return Status::OK();
 }
 
@@ -209,6 +59,41 @@ Status Pool<float, AveragePool>::Compute(OpKernelContext* context) const {
   return PoolBase::Compute(context, count_include_pad_ ? MlasAveragePoolingIncludePad : MlasAveragePoolingExcludePad);
 }
 
+template <>
+Status Pool<float, LpPool>::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(0);
+  const int64_t p = pool_context_.p();
+  const int64_t size = X->Shape().Size();
+
+  // LpPool is the p-th root of a sum pool over |x|^p, so raise the input to the p-th power into a
+  // scratch buffer, let MLAS do the windowed reduction and take the root of the (smaller) output.
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+  auto powered = IAllocator::MakeUniquePtr<float>(alloc, static_cast<size_t>(size));
+
+  ConstEigenVectorArrayMap<float> x_vec(X->template Data<float>(), size);
+  EigenVectorArrayMap<float> powered_vec(powered.get(), size);
+  if (p == 1) {
+    powered_vec = x_vec.abs();
+  } else if (p == 2) {
+    powered_vec = x_vec.square();
+  } else {
+    powered_vec = x_vec.abs().pow(static_cast<float>(p));
+  }
+
+  Tensor* Y = nullptr;
+  ORT_RETURN_IF_ERROR(PoolBase::Compute(context, MlasSumPooling, powered.get(), &Y));
+
+  EigenVectorArrayMap<float> y_vec(Y->template MutableData<float>(), Y->Shape().Size());
+  if (p == 2) {
+    y_vec = y_vec.sqrt();
+  } else if (p != 1) {
+    y_vec = y_vec.pow(1.0f / static_cast<float>(p));
+  }
+
+  return Status::OK();
+}
+
 template <>
 Status Pool<float, MaxPool<8 /*VERSION*/>>::Compute(OpKernelContext* context) const {
   // Use MLAS pooling if the index output tensor is not used.
@@ -231,6 +116,7 @@ Status Pool<float, MaxPool<8 /*VERSION*/>>::Compute(OpKernelContext* context) co
   const float* X_data = X->template Data<float>();
   float* Y_data = Y->template MutableData<float>();
   int64_t* I_data = I != nullptr ? I->template MutableData<int64_t>() : nullptr;
+  concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
 
   // The main loop
   int64_t channels = x_shape[1];
@@ -247,29 +133,29 @@ Status Pool<float, MaxPool<8 /*VERSION*/>>::Compute(OpKernelContext* context) co
       int64_t y_step = pooled_height;
       const int64_t total_channels = x_shape[0] * channels;
 
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-      for (int64_t c = 0; c < total_channels; ++c) {
-        const float* x_d = X_data + c * x_step;
-        float* y_d = Y_data + c * y_step;
-        int64_t* i_d = I_data ? I_data + c * y_step : nullptr;
-        for (int64_t ph = 0; ph < pooled_height; ++ph) {
-          int64_t hstart = ph * stride_h() - pads[0];
-          int64_t hend = std::min(hstart + kernel_shape[0], height);
-          hstart = std::max(hstart, static_cast<int64_t>(0));
-          float Yh = std::numeric_limits<float>::lowest();
-          int64_t h_index = -1;
-          for (int64_t h = hstart; h < hend; ++h) {
-            if (x_d[h] > Yh) {
-              Yh = x_d[h];
-              h_index = h;
+      auto pool_channels = [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (int64_t c = first; c < last; ++c) {
+          const float* x_d = X_data + c * x_step;
+          float* y_d = Y_data + c * y_step;
+          int64_t* i_d = I_data ? I_data + c * y_step : nullptr;
+          for (int64_t ph = 0; ph < pooled_height; ++ph) {
+            int64_t hstart = ph * stride_h() - pads[0];
+            int64_t hend = std::min(hstart + kernel_shape[0], height);
+            hstart = std::max(hstart, static_cast<int64_t>(0));
+            float Yh = std::numeric_limits<float>::lowest();
+            int64_t h_index = -1;
+            for (int64_t h = hstart; h < hend; ++h) {
+              if (x_d[h] > Yh) {
+                Yh = x_d[h];
+                h_index = h;
+              }
             }
+            y_d[ph] = Yh;
+            if (i_d != nullptr) i_d[ph] = c * x_step + h_index;
           }
-          y_d[ph] = Yh;
-          if (i_d != nullptr) i_d[ph] = c * x_step + h_index;
         }
-      }
+      };
+      concurrency::ThreadPool::TryParallelFor(thread_pool, 0, total_channels, 1, pool_channels);
 
       break;
     }
@@ -279,43 +165,43 @@ Status Pool<float, MaxPool<8 /*VERSION*/>>::Compute(OpKernelContext* context) co
       int64_t y_step = pooled_height * pooled_width;
       const int64_t total_channels = x_shape[0] * channels;
 
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-      for (int64_t c = 0; c < total_channels; ++c) {
-        const float* x_d = X_data + c * x_step;
-        float* y_d = Y_data + c * y_step;
-        int64_t* i_d = I_data ? I_data + c * y_step : nullptr;
-
-        for (int64_t ph = 0; ph < pooled_height; ++ph) {
-          int64_t hstart = ph * stride_h() - pads[0];
-          int64_t hend = std::min(hstart + kernel_shape[0], height);
-          hstart = std::max(hstart, static_cast<int64_t>(0));
-          for (int64_t pw = 0; pw < pooled_width; ++pw) {
-            int64_t wstart = pw * stride_w() - pads[1];
-            int64_t wend = std::min(wstart + kernel_shape[1], width);
-            wstart = std::max(wstart, static_cast<int64_t>(0));
-            const int64_t pool_index = ph * pooled_width + pw;
-            float Yh = std::numeric_limits<float>::lowest();
-            int64_t h_index = -1;
-            int64_t w_index = -1;
-            for (int64_t h = hstart; h < hend; ++h) {
-              for (int64_t w = wstart; w < wend; ++w) {
-                const int64_t input_index = h * width + w;
-                if (x_d[input_index] > Yh) {
-                  Yh = x_d[input_index];
-                  h_index = h;
-                  w_index = w;
+      auto pool_channels = [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (int64_t c = first; c < last; ++c) {
+          const float* x_d = X_data + c * x_step;
+          float* y_d = Y_data + c * y_step;
+          int64_t* i_d = I_data ? I_data + c * y_step : nullptr;
+
+          for (int64_t ph = 0; ph < pooled_height; ++ph) {
+            int64_t hstart = ph * stride_h() - pads[0];
+            int64_t hend = std::min(hstart + kernel_shape[0], height);
+            hstart = std::max(hstart, static_cast<int64_t>(0));
+            for (int64_t pw = 0; pw < pooled_width; ++pw) {
+              int64_t wstart = pw * stride_w() - pads[1];
+              int64_t wend = std::min(wstart + kernel_shape[1], width);
+              wstart = std::max(wstart, static_cast<int64_t>(0));
+              const int64_t pool_index = ph * pooled_width + pw;
+              float Yh = std::numeric_limits<float>::lowest();
+              int64_t h_index = -1;
+              int64_t w_index = -1;
+              for (int64_t h = hstart; h < hend; ++h) {
+                for (int64_t w = wstart; w < wend; ++w) {
+                  const int64_t input_index = h * width + w;
+                  if (x_d[input_index] > Yh) {
+                    Yh = x_d[input_index];
+                    h_index = h;
+                    w_index = w;
+                  }
                 }
               }
+              y_d[pool_index] = Yh;
+              if (i_d != nullptr)
+                i_d[pool_index] = storage_order_ == 0 ? c * x_step + h_index * width + w_index
+                                                      : c * x_step + h_index + w_index * height;
             }
-            y_d[pool_index] = Yh;
-            if (i_d != nullptr)
-              i_d[pool_index] = storage_order_ == 0 ? c * x_step + h_index * width + w_index
-                                                    : c * x_step + h_index + w_index * height;
           }
         }
-      }
+      };
+      concurrency::ThreadPool::TryParallelFor(thread_pool, 0, total_channels, 1, pool_channels);
       break;
     }
     case 3: {
@@ -323,53 +209,53 @@ Status Pool<float, MaxPool<8 /*VERSION*/>>::Compute(OpKernelContext* context) co
       int64_t y_step = pooled_height * pooled_width * pooled_depth;
       const int64_t total_channels = x_shape[0] * channels;
 
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-      for (int64_t c = 0; c < total_channels; ++c) {
-        const float* x_d = X_data + c * x_step;
-        float* y_d = Y_data + c * y_step;
-        int64_t* i_d = I_data ? I_data + c * y_step : nullptr;
-
-        for (int64_t ph = 0; ph < pooled_height; ++ph) {
-          int64_t hstart = ph * stride_h() - pads[0];
-          int64_t hend = std::min(hstart + kernel_shape[0], height);
-          hstart = std::max(hstart, static_cast<int64_t>(0));
-          for (int64_t pw = 0; pw < pooled_width; ++pw) {
-            int64_t wstart = pw * stride_w() - pads[1];
-            int64_t wend = std::min(wstart + kernel_shape[1], width);
-            wstart = std::max(wstart, static_cast<int64_t>(0));
-            for (int64_t pd = 0; pd < pooled_depth; ++pd) {
-              int64_t dstart = pd * stride_d() - pads[2];
-              int64_t dend = std::min(dstart + kernel_shape[2], depth);
-              dstart = std::max(dstart, static_cast<int64_t>(0));
-              const int64_t pool_index =
-                  ph * pooled_width * pooled_depth + pw * pooled_depth + pd;
-              float Yh = std::numeric_limits<float>::lowest();
-              int64_t h_index = -1;
-              int64_t w_index = -1;
-              int64_t d_index = -1;
-              for (int64_t h = hstart; h < hend; ++h) {
-                for (int64_t w = wstart; w < wend; ++w) {
-                  for (int64_t d = dstart; d < dend; ++d) {
-                    const int64_t input_index = h * width * depth + w * depth + d;
-                    if (x_d[input_index] > Yh) {
-                      Yh = x_d[input_index];
-                      h_index = h;
-                      w_index = w;
-                      d_index = d;
+      auto pool_channels = [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (int64_t c = first; c < last; ++c) {
+          const float* x_d = X_data + c * x_step;
+          float* y_d = Y_data + c * y_step;
+          int64_t* i_d = I_data ? I_data + c * y_step : nullptr;
+
+          for (int64_t ph = 0; ph < pooled_height; ++ph) {
+            int64_t hstart = ph * stride_h() - pads[0];
+            int64_t hend = std::min(hstart + kernel_shape[0], height);
+            hstart = std::max(hstart, static_cast<int64_t>(0));
+            for (int64_t pw = 0; pw < pooled_width; ++pw) {
+              int64_t wstart = pw * stride_w() - pads[1];
+              int64_t wend = std::min(wstart + kernel_shape[1], width);
+              wstart = std::max(wstart, static_cast<int64_t>(0));
+              for (int64_t pd = 0; pd < pooled_depth; ++pd) {
+                int64_t dstart = pd * stride_d() - pads[2];
+                int64_t dend = std::min(dstart + kernel_shape[2], depth);
+                dstart = std::max(dstart, static_cast<int64_t>(0));
+                const int64_t pool_index =
+                    ph * pooled_width * pooled_depth + pw * pooled_depth + pd;
+                float Yh = std::numeric_limits<float>::lowest();
+                int64_t h_index = -1;
+                int64_t w_index = -1;
+                int64_t d_index = -1;
+                for (int64_t h = hstart; h < hend; ++h) {
+                  for (int64_t w = wstart; w < wend; ++w) {
+                    for (int64_t d = dstart; d < dend; ++d) {
+                      const int64_t input_index = h * width * depth + w * depth + d;
+                      if (x_d[input_index] > Yh) {
+                        Yh = x_d[input_index];
+                        h_index = h;
+                        w_index = w;
+                        d_index = d;
+                      }
                     }
                   }
                 }
+                y_d[pool_index] = Yh;
+                if (i_d != nullptr)
+                  i_d[pool_index] = storage_order_ == 0 ? c * x_step + h_index * width * depth + w_index * depth + d_index
+                                                        : c * x_step + h_index + w_index * height + d_index * height * width;
               }
-              y_d[pool_index] = Yh;
-              if (i_d != nullptr)
-                i_d[pool_index] = storage_order_ == 0 ? c * x_step + h_index * width * depth + w_index * depth + d_index
-                                                      : c * x_step + h_index + w_index * height + d_index * height * width;
             }
           }
         }
-      }
+      };
+      concurrency::ThreadPool::TryParallelFor(thread_pool, 0, total_channels, 1, pool_channels);
       break;
     }
     default:
@@ -29,6 +29,7 @@ class PoolProcessContext {
   void init(const OpKernelInfo& info) {
     ORT_ENFORCE(info.GetAttr<int64_t>("p", &p_).IsOK());
   }
+  int64_t p() const { return p_; }
 };
 
 class AveragePool {
@@ -99,8 +100,12 @@ class LpPool {
 
 class PoolBase {
  protected:
-  PoolBase(const OpKernelInfo& info) {
-    op_name_ = info.GetKernelDef().OpName();
+  PoolBase(const OpKernelInfo& info) : PoolBase(info, info.GetKernelDef().OpName()) {}
+
+  // op_name selects the ONNX pooling operator whose attributes are parsed. Kernels registered under a
+  // different name, such as the NCHWc pooling kernels, pass the name of the operator they implement.
+  PoolBase(const OpKernelInfo& info, const std::string& op_name) {
+    op_name_ = op_name;
     global_pooling_ = (op_name_ == "GlobalAveragePool" || op_name_ == "GlobalMaxPool" || op_name_ == "GlobalLpPool");
 
     if (!global_pooling_) {
@@ -219,6 +224,9 @@ class PoolBase {
 
   Status Compute(OpKernelContext* context, MLAS_POOLING_KIND kind) const;
 
+  // Same as above, but pools input instead of the data of input 0. input has the shape of input 0.
+  Status Compute(OpKernelContext* context, MLAS_POOLING_KIND kind, const float* input, Tensor** output) const;
+
  protected:
   std::string op_name_;
   bool global_pooling_{};
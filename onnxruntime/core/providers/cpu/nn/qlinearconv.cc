@@ -9,6 +9,7 @@
 #include "core/providers/cpu/nn/qlinearconv.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
+#include "core/mlas/inc/mlas.h"
 
 namespace onnxruntime {
 namespace contrib {
@@ -89,7 +90,12 @@ Status QLinearConv::Compute(OpKernelContext* context) const {
   const int64_t W_offset = W->Shape().Size() / group_;  
   const int64_t kernel_dim = C / group_ * kernel_size;
   const int64_t col_buffer_size = kernel_dim * output_image_size;
-  const int bias_offset = static_cast<int>(M / group_);
+  const int64_t bias_offset = M / group_;
+
+  MLAS_QGEMM_REQUANTIZE requantize;
+  requantize.Multiplier = integer_multiplier;
+  requantize.RightShift = right_shift;
+  requantize.ZeroPoint = result_offset_data;
 
   auto col_data = alloc->Alloc(sizeof(uint8_t) * col_buffer_size);
   BufferUniquePtr col_buffer(col_data, BufferDeleter(alloc));
@@ -119,31 +125,20 @@ Status QLinearConv::Compute(OpKernelContext* context) const {
           input_offset_data);
 
       const uint8_t* filter_data_as_uint8 = W->template Data<uint8_t>() + group_id * W_offset;
-      static const gemmlowp::MapOrder MatOrder = gemmlowp::MapOrder::RowMajor;
-      gemmlowp::MatrixMap<const std::uint8_t, MatOrder> lhs(
-          filter_data_as_uint8, static_cast<int>(M / group_), static_cast<int>(kernel_dim));
-      gemmlowp::MatrixMap<const std::uint8_t, MatOrder> rhs(
-          col_buffer_data, static_cast<int>(kernel_dim), static_cast<int>(output_image_size));
-      gemmlowp::MatrixMap<std::uint8_t, MatOrder> result(
-          Ydata + group_id * Y_offset, static_cast<int>(M / group_), static_cast<int>(output_image_size));
-
-      // TODO: worker thread pool needs to be handled.
-      gemmlowp::GemmContext gemm_context;
-      if (bias == nullptr) {
-        auto output_pipeline = MakeOutputPipelineWithOutBias(result_offset_data, 
-            integer_multiplier, right_shift);
-        gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::uint8_t,
-                                         gemmlowp::DefaultL8R8BitDepthParams>(
-            &gemm_context, lhs, rhs, &result, -filter_offset_data, -input_offset_data,
-            output_pipeline);        
-      } else {
-        auto output_pipeline = MakeOutputPipelineWithBias(bias->template Data<int32_t>() + group_id * bias_offset, 
-            static_cast<int>(M / group_), result_offset_data, integer_multiplier, right_shift);
-        gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::uint8_t,
-                                         gemmlowp::DefaultL8R8BitDepthParams>(
-            &gemm_context, lhs, rhs, &result, -filter_offset_data, -input_offset_data,
-            output_pipeline);
-      }      
+      requantize.Bias = bias == nullptr ? nullptr : bias->template Data<int32_t>() + group_id * bias_offset;
+      MlasQgemm(static_cast<size_t>(M / group_),
+                static_cast<size_t>(output_image_size),
+                static_cast<size_t>(kernel_dim),
+                filter_data_as_uint8,
+                static_cast<size_t>(kernel_dim),
+                filter_offset_data,
+                col_buffer_data,
+                static_cast<size_t>(output_image_size),
+                input_offset_data,
+                &requantize,
+                Ydata + group_id * Y_offset,
+                static_cast<size_t>(output_image_size),
+                context->GetOperatorThreadPool());
     }
 
     Xdata += X_offset * group_;
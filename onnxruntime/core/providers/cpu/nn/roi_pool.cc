@@ -3,6 +3,8 @@
 
 #include "core/providers/cpu/nn/roi_pool.h"
 #include <cmath>
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 ONNX_CPU_OPERATOR_KERNEL(
@@ -36,26 +38,40 @@ Status RoiPool<float>::Compute(OpKernelContext* context) const {
   float* Ydata = Y->template MutableData<float>();
 
   for (int n = 0; n < num_rois; n++) {
-    int roi_batch_id = static_cast<int>(rois[0]);
-    int roi_start_w = static_cast<int>(round(rois[1] * spatial_scale_));
-    int roi_start_h = static_cast<int>(round(rois[2] * spatial_scale_));
-    int roi_end_w = static_cast<int>(round(rois[3] * spatial_scale_));
-    int roi_end_h = static_cast<int>(round(rois[4] * spatial_scale_));
+    int roi_batch_id = static_cast<int>(rois[n * 5]);
     ORT_ENFORCE(roi_batch_id >= 0);
     ORT_ENFORCE(roi_batch_id < batch_size);
+  }
+
+  const int64_t batch_stride = X->Shape().SizeFromDimension(1);
+  const int64_t channel_stride = X->Shape().SizeFromDimension(2);
+  const int64_t pooled_size = Y->Shape().SizeFromDimension(2);
+
+  // Each (ROI, channel) pair produces an independent pooled_height_ x pooled_width_ plane.
+  auto pool_rois = [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+    for (std::ptrdiff_t nc = first; nc < last; ++nc) {
+      const int n = static_cast<int>(nc / channels);
+      const int c = static_cast<int>(nc % channels);
+      const float* roi = rois + n * 5;
 
-    // Force malformed ROIs to be 1x1
-    int roi_height = std::max(roi_end_h - roi_start_h + 1, 1);
-    int roi_width = std::max(roi_end_w - roi_start_w + 1, 1);
+      int roi_batch_id = static_cast<int>(roi[0]);
+      int roi_start_w = static_cast<int>(round(roi[1] * spatial_scale_));
+      int roi_start_h = static_cast<int>(round(roi[2] * spatial_scale_));
+      int roi_end_w = static_cast<int>(round(roi[3] * spatial_scale_));
+      int roi_end_h = static_cast<int>(round(roi[4] * spatial_scale_));
 
-    const float bin_size_h =
-        static_cast<float>(roi_height) / static_cast<float>(pooled_height_);
-    const float bin_size_w =
-        static_cast<float>(roi_width) / static_cast<float>(pooled_width_);
+      // Force malformed ROIs to be 1x1
+      int roi_height = std::max(roi_end_h - roi_start_h + 1, 1);
+      int roi_width = std::max(roi_end_w - roi_start_w + 1, 1);
 
-    const float* batch_data = Xdata + roi_batch_id * X->Shape().SizeFromDimension(1);
+      const float bin_size_h =
+          static_cast<float>(roi_height) / static_cast<float>(pooled_height_);
+      const float bin_size_w =
+          static_cast<float>(roi_width) / static_cast<float>(pooled_width_);
+
+      const float* channel_data = Xdata + roi_batch_id * batch_stride + c * channel_stride;
+      float* y_d = Ydata + nc * pooled_size;
 
-    for (int c = 0; c < channels; ++c) {
       for (int ph = 0; ph < pooled_height_; ++ph) {
         for (int pw = 0; pw < pooled_width_; ++pw) {
           // Compute pooling region for this output unit:
@@ -79,24 +95,24 @@ Status RoiPool<float>::Compute(OpKernelContext* context) const {
           const int pool_index = static_cast<int>(ph * pooled_width_ + pw);
 
           // Define an empty pooling region to be zero
-          bool is_empty = (hend <= hstart) || (wend <= wstart);
-          Ydata[pool_index] = is_empty ? 0 : std::numeric_limits<float>::lowest();
+          if ((hend <= hstart) || (wend <= wstart)) {
+            y_d[pool_index] = 0;
+            continue;
+          }
 
+          // Reduce each row of the bin with the vectorized MLAS kernel.
+          float maximum = std::numeric_limits<float>::lowest();
           for (int h = hstart; h < hend; ++h) {
-            for (int w = wstart; w < wend; ++w) {
-              const int index = h * width + w;
-              Ydata[pool_index] = std::max(batch_data[index], Ydata[pool_index]);
-            }
+            maximum = std::max(maximum, MlasReduceMaximum(channel_data + h * width + wstart,
+                                                          static_cast<size_t>(wend - wstart)));
           }
+          y_d[pool_index] = maximum;
         }
       }
-      // Increment all data pointers by one channel
-      batch_data += X->Shape().SizeFromDimension(2);
-      Ydata += Y->Shape().SizeFromDimension(2);
     }
-    // Increment ROI data pointer
-    rois += R->Shape().SizeFromDimension(1);
-  }
+  };
+  concurrency::ThreadPool::TryParallelFor(context->GetOperatorThreadPool(), 0,
+                                          static_cast<std::ptrdiff_t>(num_rois) * channels, 1, pool_rois);
 
   return Status::OK();
 }
@@ -12,7 +12,6 @@
 #include "core/providers/cpu/rnn/deep_cpu_gru.h"
 
 #include <algorithm>
-#include <future>
 #include <stdexcept>
 
 #include "core/common/logging/logging.h"
@@ -177,11 +176,7 @@ class UniDirectionalGru {
                     const ActivationFuncs::Entry& activation_func_f,
                     const ActivationFuncs::Entry& activation_func_g,
                     const float clip,
-#ifdef USE_EIGEN_THREADPOOL
-                    Eigen::NonBlockingThreadPool& ttp_);
-#else
-                    TaskThreadPool& ttp_);
-#endif
+                    concurrency::ThreadPool* ttp);
 
   void Compute(const gsl::span<const T>& inputs,
                const gsl::span<const int>& sequence_lengths,
@@ -197,11 +192,7 @@ class UniDirectionalGru {
   AllocatorPtr allocator_;
   const logging::Logger& logger_;
 
-#ifdef USE_EIGEN_THREADPOOL
-  Eigen::NonBlockingThreadPool& ttp_;
-#else
-  TaskThreadPool& ttp_;
-#endif
+  concurrency::ThreadPool* ttp_;
 
   int seq_length_;
   int batch_size_;
@@ -383,84 +374,57 @@ Status DeepCpuGruOp::ComputeImpl(OpKernelContext& context) const {
     gsl::span<T> hidden_output_2 = hidden_output.subspan(hidden_output_size_per_direction,
                                                          hidden_output_size_per_direction);
 
-#ifndef USE_MKLDNN
+    concurrency::ThreadPool* thread_pool = context.GetOperatorThreadPool();
 
-#ifdef USE_EIGEN_THREADPOOL
-    auto fn =
-#else
-    std::packaged_task<void()> task_fw{
-#endif
-        [&]() {
-#endif  // ! USE_MKLDNN
+    auto compute_directions = [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+      for (std::ptrdiff_t dir = first; dir < last; ++dir) {
+        if (dir == 0) {
           std::unique_ptr<detail::UniDirectionalGru<T>> fw = std::make_unique<detail::UniDirectionalGru<T>>(
               alloc, logger,
               seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, Direction::kForward,
               bias_1, initial_hidden_1,
               activation_funcs_.Entries()[0],
               activation_funcs_.Entries()[1],
-              clip_, ttp_);
+              clip_, thread_pool);
           fw->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1, output_1, hidden_output_1);
-#ifndef USE_MKLDNN
-
-#ifndef USE_EIGEN_THREADPOOL
+        } else {
+          std::unique_ptr<detail::UniDirectionalGru<T>> bw = std::make_unique<detail::UniDirectionalGru<T>>(
+              alloc, logger,
+              seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, Direction::kReverse,
+              bias_2, initial_hidden_2,
+              activation_funcs_.Entries()[2],
+              activation_funcs_.Entries()[3],
+              clip_, thread_pool);
+          bw->Compute(input, sequence_lens_span, num_directions_, input_weights_2, recurrent_weights_2, output_2, hidden_output_2);
         }
-  };
-  auto task_results_fw = task_fw.get_future();
-  ttp_.RunTask(std::move(task_fw));
-#else
-        };
-    OrtCondVar cv;
-    OrtMutex lock;
-    bool done = false;
-
-    ttp_.Schedule([&]() {
-      fn();
-      auto ul = std::unique_lock<OrtMutex>(lock);
-      done = true;
-      cv.notify_one();
-    });
-#endif  // USE_EIGEN_THREADPOOL
-
-#endif  // ! USE_MKLDNN
-
-  std::unique_ptr<detail::UniDirectionalGru<T>> bw = std::make_unique<detail::UniDirectionalGru<T>>(
-      alloc, logger,
-      seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, Direction::kReverse,
-      bias_2, initial_hidden_2,
-      activation_funcs_.Entries()[2],
-      activation_funcs_.Entries()[3],
-      clip_, ttp_);
-  bw->Compute(input, sequence_lens_span, num_directions_, input_weights_2, recurrent_weights_2, output_2, hidden_output_2);
+      }
+    };
 
 #ifndef USE_MKLDNN
-#ifdef USE_EIGEN_THREADPOOL
-  auto ul = std::unique_lock<OrtMutex>(lock);
-    if (!done) cv.wait(ul);
+    // run the forward and reverse directions concurrently
+    concurrency::ThreadPool::TryParallelFor(thread_pool, 0, 2, 1, compute_directions);
 #else
-    task_results_fw.get();
-#endif
-
+    compute_directions(0, 2);
 #endif  // ! USE_MKLDNN
-}  // namespace onnxruntime
-else {
-  std::unique_ptr<detail::UniDirectionalGru<T>> gru_p = std::make_unique<detail::UniDirectionalGru<T>>(
-      alloc, logger,
-      seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, direction_,
-      bias_1, initial_hidden_1,
-      activation_funcs_.Entries()[0],
-      activation_funcs_.Entries()[1],
-      clip_, ttp_);
-
-  gru_p->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1, output_1, hidden_output_1);
-}
+  } else {
+    std::unique_ptr<detail::UniDirectionalGru<T>> gru_p = std::make_unique<detail::UniDirectionalGru<T>>(
+        alloc, logger,
+        seq_length, batch_size, input_size, hidden_size_, linear_before_reset_, direction_,
+        bias_1, initial_hidden_1,
+        activation_funcs_.Entries()[0],
+        activation_funcs_.Entries()[1],
+        clip_, context.GetOperatorThreadPool());
+
+    gru_p->Compute(input, sequence_lens_span, num_directions_, input_weights_1, recurrent_weights_1, output_1, hidden_output_1);
+  }
 
-if (!output.empty())
-  DumpMatrix("Y", output.data(), seq_length* num_directions_* batch_size, hidden_size_);
+  if (!output.empty())
+    DumpMatrix("Y", output.data(), seq_length * num_directions_ * batch_size, hidden_size_);
 
-DumpMatrix("Y_h", hidden_output.data(), num_directions_* batch_size, hidden_size_);
+  DumpMatrix("Y_h", hidden_output.data(), num_directions_ * batch_size, hidden_size_);
 
-return Status::OK();
-}  // namespace onnxruntime
+  return Status::OK();
+}
 
 //
 // Implementation of internal helper code
@@ -480,11 +444,7 @@ UniDirectionalGru<T>::UniDirectionalGru(AllocatorPtr allocator,
                                         const ActivationFuncs::Entry& activation_func_f,
                                         const ActivationFuncs::Entry& activation_func_g,
                                         const float clip,
-#ifdef USE_EIGEN_THREADPOOL
-                                        Eigen::NonBlockingThreadPool& ttp)
-#else
-                                        TaskThreadPool& ttp)
-#endif
+                                        concurrency::ThreadPool* ttp)
     : allocator_(allocator),
       logger_(logger),
       ttp_(ttp),
@@ -1112,10 +1072,8 @@ void UniDirectionalGru<T>::AllocateBuffers() {
 
 template <typename T>
 void UniDirectionalGru<T>::SetNumThreads() {
-  int threads = std::thread::hardware_concurrency() - 1;
-
-  if (threads < 1)
-    threads = 1;
+  // the calling thread also executes tasks in ExecuteLambdaInParallel
+  int threads = ttp_ != nullptr ? ttp_->NumThreads() + 1 : 1;
 
   hidden_num_threads_ = threads;
   batch_parallel_ = false;
@@ -19,15 +19,10 @@
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
 #include "core/framework/allocator.h"
+#include "core/platform/threadpool.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 
-#ifdef USE_EIGEN_THREADPOOL
-#include <unsupported/Eigen/CXX11/ThreadPool>
-#else
-#include "core/common/task_thread_pool.h"
-#endif
-
 namespace onnxruntime {
 class Tensor;
 class OpKernelContext;
@@ -218,11 +213,7 @@ T* SafeRawPointer(typename gsl::span<T> span, size_t offset, size_t size) {
 
 template <typename TLambda>
 void ExecuteLambdaInParallel(const std::string& name, TLambda lambda, int max, int step,
-#ifdef USE_EIGEN_THREADPOOL
-                             Eigen::NonBlockingThreadPool& ttp,
-#else
-                             TaskThreadPool& ttp,
-#endif
+                             concurrency::ThreadPool* ttp,
                              const ::onnxruntime::logging::Logger& logger) {
   // #define NOTHREADS to execute the lambdas directly and in order if you need to do that to debug
 
@@ -235,40 +226,20 @@ void ExecuteLambdaInParallel(const std::string& name, TLambda lambda, int max, i
     std::bind(lambda, i)();
   }
 #else
+  const int total_tasks = max / (step > 0 ? step : 1) + (max % step > 0 ? 1 : 0);
 
-#ifdef USE_EIGEN_THREADPOOL
-  ORT_UNUSED_PARAMETER(name);
-  ORT_UNUSED_PARAMETER(logger);
-
-  std::atomic<int> done(0);
-  for (int i = 0; i < max; i += step) {
-    ttp.Schedule([lambda, i, &done]() {
-      lambda(i);
-      ++done;
-    });
-  }
-
-  int totalTasks = (int)max / (step > 0 ? step : 1) + (max % step > 0 ? 1 : 0);
-  while (done != totalTasks) {
-  }
-#else
-  std::vector<std::future<void> > task_results{};
-  task_results.reserve(static_cast<size_t>(std::ceil(max / step)));
-
-  for (int i = 0; i < max; i += step) {
-    std::packaged_task<void()> task{std::bind(lambda, i)};
-    task_results.emplace_back(task.get_future());
-    ttp.RunTask(std::move(task));
-  }
   try {
-    // wait for all and propagate any exceptions
-    for (auto& future : task_results)
-      future.get();
+    // the calling thread participates and waits for all the tasks. the first exception is propagated.
+    concurrency::ThreadPool::TryParallelFor(ttp, 0, total_tasks, 1,
+                                            [&lambda, step](std::ptrdiff_t first, std::ptrdiff_t last) {
+                                              for (std::ptrdiff_t task = first; task < last; ++task) {
+                                                lambda(static_cast<int>(task) * step);
+                                              }
+                                            });
   } catch (const std::exception& ex) {
     LOGS(logger, ERROR) << name << " - exception running tasks: " << ex.what();
     throw;
   }
-#endif  // else part of #ifdef USE_EIGEN_THREADPOOLs
 #endif  // else part of #ifdef NOTHREADS
 }
 
@@ -51,6 +51,14 @@ ORT_API(void, OrtDisableProfiling, _In_ OrtSessionOptions* options) {
   options->value.profile_file_prefix.clear();
 }
 
+// keep latency histograms of every op type and run and the mean and maximum latency of every node.
+ORT_API(void, OrtEnableMetrics, _In_ OrtSessionOptions* options) {
+  options->value.enable_metrics = true;
+}
+ORT_API(void, OrtDisableMetrics, _In_ OrtSessionOptions* options) {
+  options->value.enable_metrics = false;
+}
+
 // enable the memory pattern optimization.
 // The idea is if the input shapes are the same, we could trace the internal memory allocation
 // and generate a memory pattern for future request. So next time we could just do one allocation
@@ -73,6 +81,24 @@ ORT_API(void, OrtDisableCpuMemArena, _In_ OrtSessionOptions* options) {
   options->value.enable_cpu_mem_arena = false;
 }
 
+// put a per-thread cache of small blocks in front of the CPU memory arena.
+ORT_API(void, OrtEnableCpuMemArenaThreadCache, _In_ OrtSessionOptions* options) {
+  options->value.enable_cpu_mem_arena_thread_cache = true;
+}
+
+ORT_API(void, OrtDisableCpuMemArenaThreadCache, _In_ OrtSessionOptions* options) {
+  options->value.enable_cpu_mem_arena_thread_cache = false;
+}
+
+// cache the model after graph optimization and partitioning.
+ORT_API(void, OrtEnableOptimizedModelCache, _In_ OrtSessionOptions* options, _In_ const char* cache_path) {
+  options->value.optimized_model_cache_path = cache_path;
+}
+
+ORT_API(void, OrtDisableOptimizedModelCache, _In_ OrtSessionOptions* options) {
+  options->value.optimized_model_cache_path.clear();
+}
+
 ///< logger id to use for session output
 ORT_API(void, OrtSetSessionLogId, _In_ OrtSessionOptions* options, const char* logid) {
   options->value.session_logid = logid;
@@ -90,6 +116,28 @@ ORT_API(int, OrtSetSessionThreadPoolSize, _In_ OrtSessionOptions* options, int s
   return 0;
 }
 
+///How many threads are used to parallelize the execution within a node.
+ORT_API(int, OrtSetIntraOpNumThreads, _In_ OrtSessionOptions* options, int intra_op_num_threads) {
+  if (intra_op_num_threads < 0) return -1;
+  options->value.intra_op_num_threads = intra_op_num_threads;
+  return 0;
+}
+
+///Logical processors to pin the intra-op worker threads to.
+ORT_API(int, OrtSetIntraOpThreadAffinity, _In_ OrtSessionOptions* options,
+        _In_opt_ const size_t* processor_ids, size_t processor_id_count) {
+  if (processor_ids == nullptr && processor_id_count != 0) return -1;
+  options->value.intra_op_thread_affinity.assign(processor_ids, processor_ids + processor_id_count);
+  return 0;
+}
+
+///How many threads run independent branches of the graph concurrently.
+ORT_API(int, OrtSetBranchParallelNumThreads, _In_ OrtSessionOptions* options, int branch_parallel_num_threads) {
+  if (branch_parallel_num_threads < 0) return -1;
+  options->value.branch_parallel_num_threads = branch_parallel_num_threads;
+  return 0;
+}
+
 ORT_API(void, OrtAppendCustomOpLibPath, _In_ OrtSessionOptions* options, const char* lib_path) {
   options->custom_op_paths.emplace_back(lib_path);
 }
@@ -0,0 +1,297 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/batching_session.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/session/inference_session.h"
+
+namespace onnxruntime {
+namespace {
+// Owns the output of a batch for the slices that point into it. Used as the deleter of the slices,
+// so the batched output is released once the last request has released its outputs.
+class BatchOutputOwner : public IAllocator {
+ public:
+  explicit BatchOutputOwner(const MLValue& output) : output_(output) {}
+
+  void* Alloc(size_t /*size*/) override { ORT_THROW("BatchOutputOwner can't allocate."); }
+  void Free(void* /*p*/) override {}
+  const OrtAllocatorInfo& Info() const override { return output_.Get<Tensor>().Location(); }
+
+ private:
+  const MLValue output_;
+};
+
+bool IsCpuLocation(const OrtAllocatorInfo& alloc_info) {
+  return strcmp(alloc_info.name, CPU) == 0 || alloc_info.mem_type == OrtMemTypeCPUOutput;
+}
+
+bool HaveSameRowShape(const Tensor& a, const Tensor& b) {
+  const auto& a_dims = a.Shape().GetDims();
+  const auto& b_dims = b.Shape().GetDims();
+  return a.DataType() == b.DataType() &&
+         a_dims.size() == b_dims.size() &&
+         std::equal(a_dims.begin() + 1, a_dims.end(), b_dims.begin() + 1);
+}
+
+MLValue ToMLValue(std::unique_ptr<Tensor> tensor) {
+  return MLValue{tensor.release(),
+                 DataTypeImpl::GetType<Tensor>(),
+                 DataTypeImpl::GetType<Tensor>()->GetDeleteFunc()};
+}
+}  // namespace
+
+BatchingSession::BatchingSession(InferenceSession& session, const BatchingOptions& options)
+    : session_(session), options_(options), cpu_allocator_(std::make_shared<CPUAllocator>()) {
+  ORT_ENFORCE(options_.max_batch_size > 0, "max_batch_size must be positive");
+  ORT_ENFORCE(options_.batch_timeout_micros >= 0, "batch_timeout_micros must not be negative");
+  scheduler_ = std::thread(&BatchingSession::SchedulerLoop, this);
+}
+
+BatchingSession::~BatchingSession() {
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  cond_var_.notify_all();
+
+  // the scheduler runs the queued requests before it exits
+  scheduler_.join();
+}
+
+common::Status BatchingSession::Submit(const NameMLValMap& feeds, const std::vector<std::string>& output_names,
+                                       Callback callback) {
+  if (!callback) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "A callback is required");
+  }
+
+  auto request = std::make_unique<Request>();
+  request->feeds = feeds;
+  request->output_names = output_names;
+  request->callback = std::move(callback);
+  request->batchable = !feeds.empty();
+
+  for (const auto& feed : feeds) {
+    if (!feed.second.IsTensor()) {
+      request->batchable = false;
+      break;
+    }
+
+    const auto& tensor = feed.second.Get<Tensor>();
+    const auto& shape = tensor.Shape();
+    if (shape.NumDimensions() == 0 || !IsCpuLocation(tensor.Location()) ||
+        (request->rows != 0 && shape[0] != request->rows)) {
+      request->batchable = false;
+      break;
+    }
+
+    request->rows = shape[0];
+  }
+
+  if (request->rows <= 0 || request->rows > static_cast<int64_t>(options_.max_batch_size)) {
+    request->batchable = false;
+  }
+
+  if (!request->batchable) {
+    request->rows = 0;
+  }
+
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    if (shutdown_) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "The batching session is shutting down");
+    }
+
+    request->enqueue_time = std::chrono::steady_clock::now();
+    queued_rows_ += request->rows;
+    queue_.push_back(std::move(request));
+  }
+  cond_var_.notify_one();
+
+  return Status::OK();
+}
+
+void BatchingSession::SchedulerLoop() {
+  std::unique_lock<OrtMutex> lock(mutex_);
+  while (true) {
+    cond_var_.wait(lock, [this]() { return shutdown_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      break;  // shutting down and there is nothing left to run
+    }
+
+    auto batch = NextBatch(lock);
+    lock.unlock();
+    RunBatch(batch);
+    lock.lock();
+  }
+}
+
+std::vector<std::unique_ptr<BatchingSession::Request>> BatchingSession::NextBatch(std::unique_lock<OrtMutex>& lock) {
+  // wait for a full batch, or until the oldest request times out
+  const auto deadline = queue_.front()->enqueue_time + std::chrono::microseconds(options_.batch_timeout_micros);
+  while (!shutdown_ && queue_.front()->batchable &&
+         queued_rows_ < static_cast<int64_t>(options_.max_batch_size)) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      break;
+    }
+    cond_var_.wait_for(lock, deadline - now);
+  }
+
+  std::vector<std::unique_ptr<Request>> batch;
+  int64_t rows = queue_.front()->rows;
+  batch.push_back(std::move(queue_.front()));
+  queue_.pop_front();
+
+  const Request& first = *batch.front();
+  while (first.batchable && !queue_.empty()) {
+    const Request& next = *queue_.front();
+    if (!next.batchable || next.output_names != first.output_names || next.feeds.size() != first.feeds.size() ||
+        rows + next.rows > static_cast<int64_t>(options_.max_batch_size)) {
+      break;
+    }
+
+    bool compatible = true;
+    for (const auto& feed : first.feeds) {
+      auto entry = next.feeds.find(feed.first);
+      if (entry == next.feeds.end() || !HaveSameRowShape(feed.second.Get<Tensor>(), entry->second.Get<Tensor>())) {
+        compatible = false;
+        break;
+      }
+    }
+
+    // stop at the first incompatible request so requests run in the order they were submitted
+    if (!compatible) {
+      break;
+    }
+
+    rows += next.rows;
+    batch.push_back(std::move(queue_.front()));
+    queue_.pop_front();
+  }
+
+  for (const auto& request : batch) {
+    queued_rows_ -= request->rows;
+  }
+
+  return batch;
+}
+
+void BatchingSession::RunBatch(std::vector<std::unique_ptr<Request>>& batch) {
+  std::vector<std::vector<MLValue>> request_fetches(batch.size());
+
+  Status status;
+  try {
+    status = RunBatch(batch, request_fetches);
+  } catch (const std::exception& ex) {
+    status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+  }
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (!status.IsOK()) {
+      request_fetches[i].clear();
+    }
+    batch[i]->callback(status, request_fetches[i]);
+  }
+}
+
+common::Status BatchingSession::RunBatch(std::vector<std::unique_ptr<Request>>& batch,
+                                         std::vector<std::vector<MLValue>>& request_fetches) {
+  const Request& first = *batch.front();
+  if (batch.size() == 1) {
+    return session_.Run(run_options_, first.feeds, first.output_names, &request_fetches.front());
+  }
+
+  int64_t total_rows = 0;
+  for (const auto& request : batch) {
+    total_rows += request->rows;
+  }
+
+  // concatenate the feeds along dim 0
+  NameMLValMap feeds;
+  for (const auto& feed : first.feeds) {
+    const auto& first_tensor = feed.second.Get<Tensor>();
+    const auto element_type = first_tensor.DataType();
+    std::vector<int64_t> dims = first_tensor.Shape().GetDims();
+    dims[0] = total_rows;
+    TensorShape shape(dims);
+
+    void* buffer = cpu_allocator_->AllocArray(static_cast<size_t>(shape.Size()), element_type->Size());
+    if (buffer == nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to allocate the batched feed ", feed.first);
+    }
+    auto batched = std::make_unique<Tensor>(element_type, shape, buffer, cpu_allocator_->Info(), cpu_allocator_);
+
+    if (element_type == DataTypeImpl::GetType<std::string>()) {
+      auto* dst = batched->MutableData<std::string>();
+      for (const auto& request : batch) {
+        const auto& src = request->feeds.at(feed.first).Get<Tensor>();
+        dst = std::copy(src.Data<std::string>(), src.Data<std::string>() + src.Shape().Size(), dst);
+      }
+    } else {
+      auto* dst = static_cast<char*>(batched->MutableDataRaw());
+      for (const auto& request : batch) {
+        const auto& src = request->feeds.at(feed.first).Get<Tensor>();
+        const size_t bytes = static_cast<size_t>(src.Shape().Size()) * element_type->Size();
+        memcpy(dst, src.DataRaw(), bytes);
+        dst += bytes;
+      }
+    }
+
+    feeds.insert({feed.first, ToMLValue(std::move(batched))});
+  }
+
+  std::vector<MLValue> fetches;
+  ORT_RETURN_IF_ERROR(session_.Run(run_options_, feeds, first.output_names, &fetches));
+
+  for (auto& fetches_for_request : request_fetches) {
+    fetches_for_request.reserve(fetches.size());
+  }
+
+  // slice the outputs along dim 0
+  for (size_t i = 0; i < fetches.size(); ++i) {
+    const MLValue& fetch = fetches[i];
+    if (!fetch.IsTensor() || fetch.Get<Tensor>().Shape().NumDimensions() == 0 ||
+        fetch.Get<Tensor>().Shape()[0] != total_rows) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Output ", first.output_names[i],
+                             " can't be split into the batched requests as its dim 0 isn't the batch size ",
+                             total_rows);
+    }
+
+    const auto& output = fetch.Get<Tensor>();
+    const auto element_type = output.DataType();
+    const int64_t row_size = output.Shape().SizeFromDimension(1);
+    const bool is_string = element_type == DataTypeImpl::GetType<std::string>();
+    auto owner = is_string ? nullptr : std::make_shared<BatchOutputOwner>(fetch);
+
+    int64_t row = 0;
+    for (size_t r = 0; r < batch.size(); ++r) {
+      std::vector<int64_t> dims = output.Shape().GetDims();
+      dims[0] = batch[r]->rows;
+      TensorShape shape(dims);
+
+      std::unique_ptr<Tensor> slice;
+      if (is_string) {
+        // string elements can't be shared without the owner constructing them, so copy them
+        void* buffer = cpu_allocator_->AllocArray(static_cast<size_t>(shape.Size()), element_type->Size());
+        if (buffer == nullptr) {
+          return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to allocate output ", first.output_names[i]);
+        }
+        slice = std::make_unique<Tensor>(element_type, shape, buffer, cpu_allocator_->Info(), cpu_allocator_);
+        const auto* src = output.Data<std::string>() + row * row_size;
+        std::copy(src, src + shape.Size(), slice->MutableData<std::string>());
+      } else {
+        void* data = static_cast<char*>(const_cast<void*>(output.DataRaw())) + row * row_size * element_type->Size();
+        slice = std::make_unique<Tensor>(element_type, shape, data, output.Location(), owner);
+      }
+
+      request_fetches[r].push_back(ToMLValue(std::move(slice)));
+      row += batch[r]->rows;
+    }
+  }
+
+  return Status::OK();
+}
+}  // namespace onnxruntime
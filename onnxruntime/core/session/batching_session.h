@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/status.h"
+#include "core/framework/allocator.h"
+#include "core/framework/framework_common.h"
+#include "core/framework/ml_value.h"
+#include "core/framework/run_options.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+class InferenceSession;
+
+struct BatchingOptions {
+  // the maximum number of rows (the sum of dim 0 of the requests) that are run together.
+  size_t max_batch_size = 8;
+
+  // how long the oldest queued request waits for more requests before a partial batch is run.
+  int64_t batch_timeout_micros = 1000;
+};
+
+/**
+Batches requests to an initialized InferenceSession.
+
+Requests are queued by Submit. A scheduler thread concatenates the feeds of compatible requests along
+dim 0 until max_batch_size rows are queued or the oldest request has waited for batch_timeout_micros,
+runs the session once, and slices the outputs back to the requests along dim 0.
+
+Requests are compatible if they have the same feed names, element types and dims other than dim 0,
+and request the same outputs. Requests with a non-tensor, scalar or non-CPU feed, or with more than
+max_batch_size rows, are run on their own.
+Requests are run in the order they were submitted.
+
+The session must outlive the BatchingSession.
+*/
+class BatchingSession {
+ public:
+  /**
+  Called on the scheduler thread once the request has run. fetches are in the order of the
+  output_names passed to Submit and are empty if status is not OK.
+  The callback must not throw, and the scheduler doesn't run another batch until it returns.
+  */
+  using Callback = std::function<void(const common::Status& status, std::vector<MLValue>& fetches)>;
+
+  BatchingSession(InferenceSession& session, const BatchingOptions& options);
+  ~BatchingSession();
+
+  /**
+  Queue a request. The feeds are shared with the caller and must not be modified until the callback is called.
+  @returns OK if the request was queued, in which case the callback will be called exactly once.
+  */
+  common::Status Submit(const NameMLValMap& feeds, const std::vector<std::string>& output_names, Callback callback);
+
+  const BatchingOptions& Options() const noexcept { return options_; }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(BatchingSession);
+
+  struct Request {
+    NameMLValMap feeds;
+    std::vector<std::string> output_names;
+    Callback callback;
+    int64_t rows = 0;
+    bool batchable = true;
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
+  void SchedulerLoop();
+  std::vector<std::unique_ptr<Request>> NextBatch(std::unique_lock<OrtMutex>& lock);
+  void RunBatch(std::vector<std::unique_ptr<Request>>& batch);
+  common::Status RunBatch(std::vector<std::unique_ptr<Request>>& batch,
+                          std::vector<std::vector<MLValue>>& request_fetches);
+
+  InferenceSession& session_;
+  const BatchingOptions options_;
+  const RunOptions run_options_;
+  AllocatorPtr cpu_allocator_;
+
+  OrtMutex mutex_;
+  OrtCondVar cond_var_;
+  std::deque<std::unique_ptr<Request>> queue_;
+  int64_t queued_rows_ = 0;
+  bool shutdown_ = false;
+
+  std::thread scheduler_;
+};
+}  // namespace onnxruntime
@@ -12,13 +12,20 @@
 #include <sstream>
 #include <unordered_set>
 #include <list>
+#include <algorithm>
+#ifdef _WIN32
+#include <codecvt>
+#include <locale>
+#endif
 
 #include "core/common/logging/logging.h"
-#include "core/common/task_thread_pool.h"
+#include "core/common/metrics.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/graph_utils.h"
 #include "core/graph/model.h"
+#include "core/mlas/inc/mlas.h"
 #include "core/framework/allocatormgr.h"
+#include "core/framework/arena.h"
 #include "core/framework/customregistry.h"
 #include "core/framework/environment.h"
 #include "core/framework/execution_frame.h"
@@ -30,6 +37,7 @@
 #include "core/framework/mlvalue_name_idx_map.h"
 #include "core/framework/sequential_executor.h"
 #include "core/framework/parallel_executor.h"
+#include "core/framework/prepared_run.h"
 #include "core/framework/session_state.h"
 #include "core/framework/session_state_initializer.h"
 #include "core/framework/tensorprotoutils.h"
@@ -39,18 +47,61 @@
 #include "core/optimizer/graph_transformer_mgr.h"
 #include "core/optimizer/insert_cast_transformer.h"
 #include "core/optimizer/transformer_memcpy.h"
+#include "core/platform/env.h"
 #include "core/platform/notification.h"
+#include "core/platform/threadpool.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/session/CustomOpsLoader.h"
 #include "core/session/IOBinding.h"
-
-#ifdef USE_EIGEN_THREADPOOL
-#include <unsupported/Eigen/CXX11/ThreadPool>
-#endif
+#include "core/session/optimized_model_cache.h"
 
 using namespace ONNX_NAMESPACE;
 
 namespace onnxruntime {
+namespace {
+// the directory of the model file, which external data locations are relative to.
+// "." if the path has no directory component.
+std::string GetModelDirectory(const std::string& model_uri) {
+  const auto pos = model_uri.find_last_of("/\\");
+  if (pos == std::string::npos) {
+    return ".";
+  }
+  return pos == 0 ? model_uri.substr(0, 1) : model_uri.substr(0, pos);
+}
+
+const std::string& ToUtf8Path(const std::string& model_uri) {
+  return model_uri;
+}
+
+#ifdef _WIN32
+std::string ToUtf8Path(const std::wstring& model_uri) {
+  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+  return converter.to_bytes(model_uri);
+}
+#endif
+
+// The MLAS kernels are shared by the process. Sessions lay out their weights for the kernels selected when they
+// are initialized (e.g. the NCHWc block size), so the instruction set level may only change while no session exists.
+OrtMutex& MlasIsaLevelMutex() {
+  static OrtMutex mutex;
+  return mutex;
+}
+
+size_t num_live_sessions = 0;  // guarded by MlasIsaLevelMutex
+
+class LiveSessionCounter {
+ public:
+  LiveSessionCounter() {
+    std::lock_guard<OrtMutex> lock(MlasIsaLevelMutex());
+    ++num_live_sessions;
+  }
+
+  ~LiveSessionCounter() {
+    std::lock_guard<OrtMutex> lock(MlasIsaLevelMutex());
+    --num_live_sessions;
+  }
+};
+}  // namespace
 
 class InferenceSession::Impl {
  public:
@@ -65,22 +116,36 @@ class InferenceSession::Impl {
 
     InitLogger(logging_manager);
 
-    // currently the threadpool is used by the parallel executor only and hence
-    // there is no point creating it when only sequential execution is enabled.
+    // currently the threadpool is used by the parallel executor and the branch parallel sequential execution
+    // only and hence there is no point creating it when plain sequential execution is enabled.
     if (!session_options.enable_sequential_execution) {
-      int pool_size = session_options_.session_thread_pool_size == 0
-                          ? std::thread::hardware_concurrency() / 2
-                          : session_options_.session_thread_pool_size;
-
-#ifdef USE_EIGEN_THREADPOOL
-      thread_pool_ = std::make_unique<Eigen::NonBlockingThreadPool>(pool_size);
-#else
-      thread_pool_ = std::make_unique<TaskThreadPool>(pool_size);
-#endif
+      concurrency::ThreadPoolOptions pool_options;
+      pool_options.num_threads = SessionThreadPoolSize();
+      thread_pool_ = std::make_unique<concurrency::ThreadPool>("ort_inter_op", pool_options);
+    } else if (session_options.branch_parallel_num_threads > 1) {
+      // the thread calling Run runs chains as well
+      concurrency::ThreadPoolOptions pool_options;
+      pool_options.num_threads = session_options.branch_parallel_num_threads - 1;
+      thread_pool_ = std::make_unique<concurrency::ThreadPool>("ort_inter_branch", pool_options);
+    }
+
+    // the thread calling Run participates in the intra-op parallelism, so the pool only needs
+    // intra_op_num_threads - 1 workers and none at all if a single thread was requested.
+    int intra_op_num_threads = session_options_.intra_op_num_threads == 0
+                                   ? Env::Default().GetNumCpuCores()
+                                   : session_options_.intra_op_num_threads;
+    if (intra_op_num_threads > 1) {
+      concurrency::ThreadPoolOptions pool_options;
+      pool_options.num_threads = intra_op_num_threads - 1;
+      pool_options.affinity = session_options_.intra_op_thread_affinity;
+      intra_op_thread_pool_ = std::make_unique<concurrency::ThreadPool>("ort_intra_op", pool_options);
     }
 
     session_state_.SetThreadPool(thread_pool_.get());
+    session_state_.SetIntraOpThreadPool(intra_op_thread_pool_.get());
     session_state_.SetEnableMemoryPattern(session_options.enable_mem_pattern);
+    session_state_.SetMemoryPatternCacheOptions(session_options.mem_pattern_cache_size,
+                                                session_options.mem_pattern_dim_bucket_size);
     session_profiler_.Initialize(session_logger_);
     session_state_.SetProfiler(session_profiler_);
     if (session_options.enable_profiling) {
@@ -88,6 +153,12 @@ class InferenceSession::Impl {
     }
   }
 
+  ~Impl() {
+    // the pending RunAsync calls use the session state, so wait for them
+    std::unique_lock<OrtMutex> lock(async_run_mutex_);
+    async_runs_done_.wait(lock, [this]() { return num_pending_async_runs_ == 0; });
+  }
+
   common::Status RegisterExecutionProvider(std::unique_ptr<IExecutionProvider> p_exec_provider) {
     if (p_exec_provider == nullptr) {
       return Status(common::ONNXRUNTIME, common::FAIL, "Received nullptr for exec provider");
@@ -172,6 +243,8 @@ class InferenceSession::Impl {
   template <typename T>
   common::Status Load(const T& model_uri) {
     auto loader = [this, &model_uri](std::shared_ptr<onnxruntime::Model>& model) {
+      model_path_ = ToUtf8Path(model_uri);
+      model_dir_ = GetModelDirectory(model_path_);
       return onnxruntime::Model::Load(model_uri, model, HasLocalSchema() ? &custom_schema_registries_ : nullptr);
     };
 
@@ -259,6 +332,10 @@ class InferenceSession::Impl {
         auto subgraph_session_state = std::make_unique<SessionState>(execution_providers_);
         subgraph_session_state->SetProfiler(session_profiler_);
         subgraph_session_state->SetLogger(*session_logger_);
+        subgraph_session_state->SetThreadPool(thread_pool_.get());
+        subgraph_session_state->SetIntraOpThreadPool(intra_op_thread_pool_.get());
+        subgraph_session_state->SetMemoryPatternCacheOptions(session_options_.mem_pattern_cache_size,
+                                                             session_options_.mem_pattern_dim_bucket_size);
 
         // recurse
         ORT_RETURN_IF_ERROR(CreateSubgraphSessionState(*subgraph, *subgraph_session_state));
@@ -287,7 +364,7 @@ class InferenceSession::Impl {
 
         // setup everything required to execute the subgraph and save it in subgraph_session_state
         SessionStateInitializer initializer{subgraph, *subgraph_session_state,
-                                            execution_providers_, kernel_registry_manager_};
+                                            execution_providers_, kernel_registry_manager_, model_dir_};
 
         ORT_RETURN_IF_ERROR(initializer.CreatePlan(node.ImplicitInputDefs(),
                                                    session_options_.enable_sequential_execution));
@@ -326,11 +403,24 @@ class InferenceSession::Impl {
       // Register default CPUExecutionProvider if user didn't provide it through the Register() calls
       if (!execution_providers_.Get(onnxruntime::kCpuExecutionProvider)) {
         LOGS(*session_logger_, INFO) << "Adding default CPU execution provider.";
-        CPUExecutionProviderInfo epi{session_options_.enable_cpu_mem_arena};
+        CPUExecutionProviderInfo epi{session_options_.enable_cpu_mem_arena,
+                                     session_options_.enable_cpu_mem_arena_thread_cache};
         ORT_RETURN_IF_ERROR(execution_providers_.Add(onnxruntime::kCpuExecutionProvider,
                                                      std::make_unique<CPUExecutionProvider>(epi)));
       }
 
+      LogMlasKernelSelection();
+
+      // replace the loaded model with its optimized version if that is cached already
+      std::string cache_key;
+      bool loaded_from_cache = false;
+      if (!session_options_.optimized_model_cache_path.empty()) {
+        cache_key = ComputeOptimizedModelCacheKey();
+      }
+      if (!cache_key.empty()) {
+        ORT_RETURN_IF_ERROR(LoadOptimizedModelFromCache(cache_key, loaded_from_cache));
+      }
+
       onnxruntime::Graph& graph = model_->MainGraph();
 
       // Collect the kernel registries from execution provider instances;
@@ -346,27 +436,41 @@ class InferenceSession::Impl {
       insert_cast_transformer_.AddKernelRegistries(kernel_registry_manager_.GetAllKernelRegistries());
 
       SessionStateInitializer session_initializer{graph, session_state_, execution_providers_,
-                                                  kernel_registry_manager_};
+                                                  kernel_registry_manager_, model_dir_};
 
       // create SessionState for subgraphs as it's needed by the transformers
       ORT_RETURN_IF_ERROR(CreateSubgraphSessionState(graph, session_state_));
 
-      // apply any transformations to the main graph and any subgraphs
-      ORT_RETURN_IF_ERROR(TransformGraph(graph, graph_transformation_mgr_,
-                                         execution_providers_, kernel_registry_manager_,
-                                         insert_cast_transformer_,
-                                         session_state_));
+      // apply any transformations to the main graph and any subgraphs.
+      // a cached model was transformed and partitioned before it was saved.
+      if (!loaded_from_cache) {
+        ORT_RETURN_IF_ERROR(TransformGraph(graph, graph_transformation_mgr_,
+                                           execution_providers_, kernel_registry_manager_,
+                                           insert_cast_transformer_,
+                                           session_state_));
+      }
 
       // now that all the transforms are done, call Resolve on the main graph. this will recurse into the subgraphs.
       ORT_RETURN_IF_ERROR(graph.Resolve());
 
-      ORT_RETURN_IF_ERROR(session_initializer.CreatePlan({}, session_options_.enable_sequential_execution));
+      // save the optimized model before the initializers are moved out of the graph
+      if (!cache_key.empty() && !loaded_from_cache) {
+        SaveOptimizedModelToCache(cache_key);
+      }
+
+      ORT_RETURN_IF_ERROR(session_initializer.CreatePlan({}, session_options_.enable_sequential_execution,
+                                                         session_options_.branch_parallel_num_threads > 1));
       ORT_RETURN_IF_ERROR(session_initializer.InitializeAndSave(session_state_.GetEnableMemoryPattern()));
 
       // handle any subgraphs
       ORT_RETURN_IF_ERROR(InitializeSubgraphSessions(graph, session_state_));
 
       session_state_.CalculateNodeIndexInfo();
+      session_state_.CalculateNodeDependencyInfo();
+
+      if (session_options_.enable_metrics) {
+        CreateMetrics();
+      }
 
       is_inited_ = true;
 
@@ -587,12 +691,70 @@ class InferenceSession::Impl {
       ORT_CHECK_AND_SET_RETVAL(xp->OnRunEnd());
 
     --current_num_runs_;
+    if (metrics_) {
+      metrics_->RecordRun(profiling::Metrics::DurationNs(tp, session_profiler_.StartTime()), retval.IsOK());
+    }
     if (session_profiler_.FEnabled()) {
       session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "model_run", tp);
     }
     return retval;
   }
 
+  common::Status RunAsync(const RunOptions& run_options,
+                          const NameMLValMap& feeds,
+                          const std::vector<std::string>& output_names,
+                          InferenceSession::RunCallback callback) {
+    if (!callback) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "A callback is required");
+    }
+
+    concurrency::ThreadPool* pool;
+    {
+      std::lock_guard<OrtMutex> l(async_run_mutex_);
+      // a separate pool, as a run on the inter-op pool would block a worker the parallel executor waits for
+      if (!async_run_thread_pool_) {
+        concurrency::ThreadPoolOptions pool_options;
+        pool_options.num_threads = SessionThreadPoolSize();
+        async_run_thread_pool_ = std::make_unique<concurrency::ThreadPool>("ort_run_async", pool_options);
+      }
+      pool = async_run_thread_pool_.get();
+      ++num_pending_async_runs_;
+    }
+
+    pool->Schedule([this, &run_options, feeds, output_names, callback]() {
+      std::vector<MLValue> fetches;
+      Status status;
+      if (run_options.terminate) {
+        status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
+      } else {
+        status = Run(run_options, feeds, output_names, &fetches);
+      }
+
+      if (!status.IsOK()) {
+        fetches.clear();
+      }
+
+      try {
+        callback(status, fetches);
+      } catch (const std::exception& ex) {
+        LOGS(*session_logger_, ERROR) << "RunAsync callback threw an exception: " << ex.what();
+      }
+
+      std::lock_guard<OrtMutex> l(async_run_mutex_);
+      if (--num_pending_async_runs_ == 0) {
+        async_runs_done_.notify_all();
+      }
+    });
+
+    return Status::OK();
+  }
+
+  common::Status RunAsync(const NameMLValMap& feeds,
+                          const std::vector<std::string>& output_names,
+                          InferenceSession::RunCallback callback) {
+    return RunAsync(default_run_options_, feeds, output_names, std::move(callback));
+  }
+
   std::pair<common::Status, const ModelMetadata*> GetModelMetadata() const {
     {
       std::lock_guard<onnxruntime::OrtMutex> l(session_mutex_);
@@ -606,6 +768,23 @@ class InferenceSession::Impl {
     return std::make_pair(common::Status::OK(), &model_metadata_);
   }
 
+  common::Status GetAllocatorStats(const OrtAllocatorInfo& allocator_info, AllocatorStats* stats) const {
+    const IExecutionProvider* provider = execution_providers_.Get(allocator_info);
+    if (provider == nullptr) {
+      return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
+                    "No execution provider owns an allocator matching " + allocator_info.ToString());
+    }
+
+    auto arena = dynamic_cast<IArenaAllocator*>(provider->GetAllocator(allocator_info.id, allocator_info.mem_type).get());
+    if (arena == nullptr) {
+      return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
+                    "The allocator matching " + allocator_info.ToString() + " is not an arena.");
+    }
+
+    arena->GetStats(stats);
+    return Status::OK();
+  }
+
   std::pair<common::Status, const InputDefList*> GetModelInputs() const {
     {
       std::lock_guard<onnxruntime::OrtMutex> l(session_mutex_);
@@ -657,6 +836,136 @@ class InferenceSession::Impl {
     return Run(run_options, io_binding);
   }
 
+  common::Status PrepareRun(const RunOptions& run_options,
+                            const std::vector<std::string>& input_names,
+                            const std::vector<std::string>& output_names,
+                            std::unique_ptr<PreparedRun>* prepared_run) {
+    {
+      std::lock_guard<onnxruntime::OrtMutex> l(session_mutex_);
+      if (!is_inited_) {
+        LOGS(*session_logger_, ERROR) << "Session was not initialized";
+        return common::Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
+      }
+    }
+
+    std::unordered_set<std::string> seen_inputs;
+    std::vector<MLDataType> input_types;
+    input_types.reserve(input_names.size());
+    for (const auto& name : input_names) {
+      if (model_input_names_.find(name) == model_input_names_.end()) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid Feed Input Name: ", name);
+      }
+      if (!seen_inputs.insert(name).second) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Duplicated Feed Input Name: ", name);
+      }
+
+      MLDataType expected_type = nullptr;
+      for (auto& arg : input_def_list_) {
+        if (arg->Name() == name) {
+          expected_type = utils::GetMLDataType(*arg);
+          if (expected_type->IsTensorType()) {
+            expected_type = expected_type->AsTensorType()->GetElementType();
+          }
+          break;
+        }
+      }
+      input_types.push_back(expected_type);
+    }
+
+    for (const auto& required_input : required_model_input_names_) {
+      if (seen_inputs.find(required_input) == seen_inputs.end()) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Missing required input: ", required_input);
+      }
+    }
+
+    std::vector<MLValue> no_fetches;
+    ORT_RETURN_IF_ERROR(ValidateOutputs(output_names, &no_fetches));
+
+    std::unique_ptr<logging::Logger> owned_run_logger;
+    auto& run_logger = CreateLoggerForRun(run_options, owned_run_logger);
+    *prepared_run = std::make_unique<PreparedRun>(session_state_, run_options, input_names, input_types, output_names,
+                                                  std::move(owned_run_logger), run_logger);
+    return Status::OK();
+  }
+
+  common::Status Run(PreparedRun& prepared_run,
+                     const std::vector<MLValue>& feeds,
+                     std::vector<MLValue>* p_fetches) {
+    const auto& input_types = prepared_run.InputTypes();
+    if (feeds.size() != input_types.size()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Expected ", input_types.size(), " feeds but got ",
+                             feeds.size());
+    }
+    for (size_t i = 0, end = feeds.size(); i < end; ++i) {
+      if (input_types[i] != nullptr) {
+        const auto& feed = feeds[i];
+        ORT_RETURN_IF_ERROR(CheckTypes(feed.IsTensor() ? feed.Get<Tensor>().DataType() : feed.Type(),
+                                       input_types[i]));
+      }
+    }
+
+    if (!p_fetches) {
+      return common::Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "Output vector pointer is NULL");
+    }
+    if (!p_fetches->empty() && p_fetches->size() != prepared_run.OutputNames().size()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Output vector incorrectly sized: ",
+                             p_fetches->size(), ", expected ", prepared_run.OutputNames().size());
+    }
+
+    const RunOptions& run_options = prepared_run.GetRunOptions();
+
+    // device copies and the parallel executor take the regular path
+    if (!session_options_.enable_sequential_execution ||
+        session_state_.GetExecutionProviders().NumProviders() != 1) {
+      NameMLValMap feed_map;
+      for (size_t i = 0, end = feeds.size(); i < end; ++i) {
+        feed_map.emplace(prepared_run.InputNames()[i], feeds[i]);
+      }
+      return Run(run_options, feed_map, prepared_run.OutputNames(), p_fetches);
+    }
+
+    auto tp = session_profiler_.StartTime();
+    Status retval = Status::OK();
+
+    if (!run_options.run_tag.empty()) {
+      LOGS(prepared_run.Logger(), INFO) << "Running with tag: " << run_options.run_tag;
+    }
+
+    ++current_num_runs_;
+
+    try {
+      for (auto& xp : execution_providers_) {
+        ORT_CHECK_AND_SET_RETVAL(xp->OnRunStart());
+      }
+
+      if (retval.IsOK()) {
+        SequentialExecutor executor(run_options.terminate);
+        retval = executor.Execute(session_state_, prepared_run, feeds, *p_fetches);
+      }
+    } catch (const std::exception& e) {
+      retval = Status(common::ONNXRUNTIME, common::FAIL, e.what());
+    } catch (...) {
+      retval = Status(common::ONNXRUNTIME, common::RUNTIME_EXCEPTION, "Encountered unknown exception in Run()");
+    }
+
+    // a frame left behind by a failed run may hold partial results
+    if (!retval.IsOK()) {
+      prepared_run.ReleaseFrame();
+    }
+
+    for (auto& xp : execution_providers_)
+      ORT_CHECK_AND_SET_RETVAL(xp->OnRunEnd());
+
+    --current_num_runs_;
+    if (metrics_) {
+      metrics_->RecordRun(profiling::Metrics::DurationNs(tp, session_profiler_.StartTime()), retval.IsOK());
+    }
+    if (session_profiler_.FEnabled()) {
+      session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "model_run", tp);
+    }
+    return retval;
+  }
+
   void StartProfiling(const std::string& file_prefix) {
     std::ostringstream ss;
     ss << file_prefix << "_" << GetCurrentTimeString() << ".json";
@@ -675,6 +984,72 @@ class InferenceSession::Impl {
     return std::string();
   }
 
+  common::Status GetMetrics(std::string& metrics) const {
+    if (!metrics_) {
+      return common::Status(common::ONNXRUNTIME, common::FAIL,
+                            "Metrics are disabled or the session was not initialized.");
+    }
+
+    MemoryPatternCacheStats mem_pattern_stats = session_state_.GetMemoryPatternCacheStats();
+    {
+      std::lock_guard<onnxruntime::OrtMutex> l(metrics_mutex_);
+      mem_pattern_stats.hits -= mem_pattern_stats_at_reset_.hits;
+      mem_pattern_stats.misses -= mem_pattern_stats_at_reset_.misses;
+      mem_pattern_stats.evictions -= mem_pattern_stats_at_reset_.evictions;
+    }
+
+    std::ostringstream out;
+    out << "{";
+    metrics_->WriteJsonMembers(out);
+    out << ",\"mem_pattern_cache\":{\"hits\":" << mem_pattern_stats.hits
+        << ",\"misses\":" << mem_pattern_stats.misses
+        << ",\"evictions\":" << mem_pattern_stats.evictions
+        << ",\"entries\":" << mem_pattern_stats.num_entries << "}";
+
+    out << ",\"arenas\":[";
+    bool first = true;
+    for (const auto& xp : execution_providers_) {
+      for (const auto& allocator : xp->GetAllocatorMap()) {
+        auto* arena = dynamic_cast<IArenaAllocator*>(allocator.get());
+        if (arena == nullptr) {
+          continue;
+        }
+        AllocatorStats stats;
+        try {
+          arena->GetStats(&stats);
+        } catch (const NotImplementedException&) {
+          continue;  // DummyArena
+        }
+        out << (first ? "{" : ",{") << "\"provider\":";
+        first = false;
+        profiling::Metrics::WriteJsonString(out, xp->Type());
+        out << ",\"name\":";
+        profiling::Metrics::WriteJsonString(out, arena->Info().name);
+        out << ",\"mem_type\":" << arena->Info().mem_type
+            << ",\"bytes_in_use\":" << stats.bytes_in_use
+            << ",\"max_bytes_in_use\":" << stats.max_bytes_in_use
+            << ",\"total_allocated_bytes\":" << stats.total_allocated_bytes
+            << ",\"num_allocs\":" << stats.num_allocs << "}";
+      }
+    }
+    out << "]}";
+
+    metrics = out.str();
+    return Status::OK();
+  }
+
+  common::Status ResetMetrics() {
+    if (!metrics_) {
+      return common::Status(common::ONNXRUNTIME, common::FAIL,
+                            "Metrics are disabled or the session was not initialized.");
+    }
+
+    std::lock_guard<onnxruntime::OrtMutex> l(metrics_mutex_);
+    metrics_->Reset();
+    mem_pattern_stats_at_reset_ = session_state_.GetMemoryPatternCacheStats();
+    return Status::OK();
+  }
+
  private:
   bool HasLocalSchema() const {
     return !custom_schema_registries_.empty();
@@ -691,6 +1066,14 @@ class InferenceSession::Impl {
     VLOGS(*session_logger_, 1) << "Saving model metadata";
     const onnxruntime::Graph& graph = model.MainGraph();
 
+    // this is called again when the model is replaced by the optimized model from the cache
+    required_input_def_list_.clear();
+    required_model_input_names_.clear();
+    input_def_list_.clear();
+    model_input_names_.clear();
+    output_def_list_.clear();
+    model_output_names_.clear();
+
     // save model metadata
     model_metadata_.producer_name = model.ProducerName();
     model_metadata_.description = model.DocString();
@@ -730,6 +1113,113 @@ class InferenceSession::Impl {
     return common::Status::OK();
   }
 
+  // Log the instruction set level and the kernel variant of every MLAS entry point the session runs with.
+  void LogMlasKernelSelection() {
+    std::ostringstream report;
+    report << "MLAS instruction set level: " << MlasGetIsaLevelName(MlasGetIsaLevel())
+           << " (supported: " << MlasGetIsaLevelName(MlasGetSupportedIsaLevel()) << "). Kernels:";
+    const MLAS_KERNEL_SELECTION* selection;
+    size_t count = MlasGetKernelSelection(&selection);
+    for (size_t i = 0; i < count; i++) {
+      report << " " << selection[i].EntryPoint << "=" << selection[i].Variant;
+    }
+    LOGS(*session_logger_, INFO) << report.str();
+  }
+
+  // The cache key covers the model as loaded and everything in the session that changes how it is optimized.
+  // Returns an empty key, which disables the cache, if the model can't be identified without reading it.
+  std::string ComputeOptimizedModelCacheKey() {
+    if (model_path_.empty()) {
+      LOGS(*session_logger_, WARNING) << "The optimized model cache is only used for models loaded from a file.";
+      return std::string();
+    }
+
+    std::vector<std::string> config;
+
+    std::string providers = "providers";
+    for (const auto& provider : execution_providers_) {
+      providers += " " + provider->Type();
+    }
+    config.push_back(providers);
+
+    std::string transformers = "transformers";
+    for (const auto& name : graph_transformation_mgr_.GetTransformerNames()) {
+      transformers += " " + name;
+    }
+    config.push_back(transformers);
+
+    config.push_back("steps " + std::to_string(graph_transformation_mgr_.Steps()));
+    config.push_back("custom_registries " + std::to_string(custom_schema_registries_.size()));
+
+    // the layouts chosen by the NCHWc transformer depend on the MLAS kernels
+    config.push_back(std::string("mlas_isa_level ") + MlasGetIsaLevelName(MlasGetIsaLevel()));
+
+    std::string key;
+    auto status = optimized_model_cache::ComputeKey(model_path_, model_->MainGraph(), model_dir_, config, key);
+    if (!status.IsOK()) {
+      LOGS(*session_logger_, WARNING) << "Not using the optimized model cache: " << status.ErrorMessage();
+      return std::string();
+    }
+    return key;
+  }
+
+  common::Status LoadOptimizedModelFromCache(const std::string& cache_key, bool& loaded) {
+    const auto& cache_path = session_options_.optimized_model_cache_path;
+    std::shared_ptr<onnxruntime::Model> cached_model;
+    auto status = optimized_model_cache::Load(cache_path, cache_key,
+                                              HasLocalSchema() ? &custom_schema_registries_ : nullptr,
+                                              cached_model, loaded);
+    if (!status.IsOK()) {
+      // a broken cache is not fatal as it's rewritten once the model is optimized
+      LOGS(*session_logger_, WARNING) << "Ignoring the optimized model cache " << cache_path << ": "
+                                      << status.ErrorMessage();
+      loaded = false;
+    }
+
+    if (!loaded) {
+      LOGS(*session_logger_, INFO) << "No valid optimized model cache at " << cache_path
+                                   << ". The model will be optimized and saved to it.";
+      return Status::OK();
+    }
+
+    model_ = cached_model;
+
+    // the input and output definitions have to refer to the graph of the cached model.
+    // keep the metadata of the original model so the cache is transparent to the user.
+    auto model_metadata = model_metadata_;
+    ORT_RETURN_IF_ERROR(SaveModelMetadata(*model_));
+    model_metadata_ = std::move(model_metadata);
+
+    LOGS(*session_logger_, INFO) << "Loaded the optimized model from " << cache_path;
+    return Status::OK();
+  }
+
+  // Failing to write the cache only costs the next session the optimization time, so it isn't an error.
+  void SaveOptimizedModelToCache(const std::string& cache_key) {
+    const auto& cache_path = session_options_.optimized_model_cache_path;
+    std::string reason;
+    if (!optimized_model_cache::CanCache(model_->MainGraph(), reason)) {
+      LOGS(*session_logger_, WARNING) << "The optimized model can't be cached as " << reason;
+      return;
+    }
+
+    auto status = optimized_model_cache::Save(cache_path, cache_key, *model_);
+    if (!status.IsOK()) {
+      LOGS(*session_logger_, WARNING) << status.ErrorMessage();
+      return;
+    }
+
+    LOGS(*session_logger_, INFO) << "Saved the optimized model to " << cache_path;
+  }
+
+  // Number of worker threads in the inter-op and the RunAsync thread pools.
+  int SessionThreadPoolSize() const {
+    int pool_size = session_options_.session_thread_pool_size == 0
+                        ? static_cast<int>(std::thread::hardware_concurrency() / 2)
+                        : session_options_.session_thread_pool_size;
+    return std::max(pool_size, 1);
+  }
+
   // Create a Logger for a single execution if possible. Otherwise use the default logger.
   // If a new logger is created, it will also be stored in new_run_logger,
   // which must remain valid for the duration of the execution.
@@ -792,6 +1282,24 @@ class InferenceSession::Impl {
     session_state_.SetLogger(*session_logger_);
   }
 
+  // Create the metrics of the main graph. The nodes of a subgraph count towards the node containing it.
+  void CreateMetrics() {
+    const auto& graph_viewer = *session_state_.GetGraphViewer();
+    auto max_node_index = static_cast<size_t>(graph_viewer.MaxNodeIndex());
+    std::vector<std::string> node_names(max_node_index);
+    std::vector<std::string> node_op_types(max_node_index);
+    for (size_t i = 0; i < max_node_index; ++i) {
+      const Node* node = graph_viewer.GetNode(i);
+      if (node != nullptr) {
+        node_names[i] = node->Name();
+        node_op_types[i] = node->OpType();
+      }
+    }
+
+    metrics_ = std::make_unique<profiling::Metrics>(node_names, node_op_types);
+    session_state_.SetMetrics(metrics_.get());
+  }
+
   common::Status WaitForNotification(Notification* p_executor_done, int64_t timeout_in_ms) {
     if (timeout_in_ms > 0) {
       ORT_NOT_IMPLEMENTED(__FUNCTION__, "timeout_in_ms >0 is not supported");  // TODO
@@ -801,6 +1309,9 @@ class InferenceSession::Impl {
     return Status::OK();
   }
 
+  // declared first so the session is counted until everything using the MLAS kernels is destroyed
+  LiveSessionCounter live_session_counter_;
+
   CustomOpsLoader custom_ops_loader_;
 
   const SessionOptions session_options_;
@@ -819,6 +1330,12 @@ class InferenceSession::Impl {
   // Profiler for this session.
   profiling::Profiler session_profiler_;
 
+  // Latency metrics of the main graph. Only created if enabled in the SessionOptions.
+  std::unique_ptr<profiling::Metrics> metrics_;
+  // the memory pattern cache stats when the metrics were last reset
+  MemoryPatternCacheStats mem_pattern_stats_at_reset_;  // GUARDED_BY(metrics_mutex_)
+  mutable onnxruntime::OrtMutex metrics_mutex_;
+
   ExecutionProviders execution_providers_;
 
   KernelRegistryManager kernel_registry_manager_;
@@ -831,6 +1348,13 @@ class InferenceSession::Impl {
   // if they need.
   std::shared_ptr<onnxruntime::Model> model_;
 
+  // Path of the model file, UTF-8 encoded. Empty when the model was not loaded from a file.
+  std::string model_path_;
+
+  // Directory of the model file that external initializer data is loaded from.
+  // Empty when the model was not loaded from a file, in which case external data can't be used.
+  std::string model_dir_;
+
   // A set of executors that can run in parallel.
   std::vector<std::unique_ptr<IExecutor>> executors_;  // TODO do we need this vector?
 
@@ -852,13 +1376,20 @@ class InferenceSession::Impl {
   // statically allocated pointer, no need to manage its lifetime.
   //Env* env_;
 
-  // Threadpool for this session
-  //thread::ThreadPool thread_pool_; // not used for now; will add it later when implementing RunAsync
-#ifdef USE_EIGEN_THREADPOOL
-  std::unique_ptr<Eigen::NonBlockingThreadPool> thread_pool_;
-#else
-  std::unique_ptr<TaskThreadPool> thread_pool_;
-#endif
+  // Threadpool used by the parallel executor to run independent nodes concurrently.
+  std::unique_ptr<concurrency::ThreadPool> thread_pool_;
+
+  // Threadpool used by the kernels to parallelize the execution of a single node.
+  std::unique_ptr<concurrency::ThreadPool> intra_op_thread_pool_;
+
+  // Threadpool running the RunAsync calls. Created by the first RunAsync call.
+  std::unique_ptr<concurrency::ThreadPool> async_run_thread_pool_;  // GUARDED_BY(async_run_mutex_)
+  int num_pending_async_runs_ = 0;                                  // GUARDED_BY(async_run_mutex_)
+  OrtMutex async_run_mutex_;
+  OrtCondVar async_runs_done_;
+
+  // used by the RunAsync calls that don't pass RunOptions
+  const RunOptions default_run_options_;
 
   // Number of concurrently running executors
   std::atomic<int> current_num_runs_;
@@ -880,6 +1411,31 @@ InferenceSession::InferenceSession(const SessionOptions& session_options,
 
 InferenceSession::~InferenceSession() = default;
 
+common::Status InferenceSession::SetMlasIsaLevel(const std::string& isa_level_name) {
+  const char* name = nullptr;
+  int isa_level = MlasIsaLevelGeneric;
+  while ((name = MlasGetIsaLevelName(static_cast<MLAS_ISA_LEVEL>(isa_level))) != nullptr &&
+         isa_level_name != name) {
+    isa_level++;
+  }
+  if (name == nullptr) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Unknown MLAS instruction set level: ", isa_level_name);
+  }
+
+  std::lock_guard<OrtMutex> lock(MlasIsaLevelMutex());
+  auto new_isa_level = std::min(static_cast<MLAS_ISA_LEVEL>(isa_level), MlasGetSupportedIsaLevel());
+  if (new_isa_level == MlasGetIsaLevel()) {
+    return Status::OK();
+  }
+  if (num_live_sessions != 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Can't change the MLAS instruction set level from ",
+                           MlasGetIsaLevelName(MlasGetIsaLevel()), " to ", MlasGetIsaLevelName(new_isa_level),
+                           " while ", num_live_sessions, " session(s) exist.");
+  }
+  MlasSetMaximumIsaLevel(new_isa_level);
+  return Status::OK();
+}
+
 common::Status InferenceSession::Load(const std::string& model_uri) {
   return impl_->Load(model_uri);
 }
@@ -913,6 +1469,11 @@ std::pair<common::Status, const ModelMetadata*> InferenceSession::GetModelMetada
   return impl_->GetModelMetadata();
 }
 
+common::Status InferenceSession::GetAllocatorStats(const OrtAllocatorInfo& allocator_info,
+                                                   AllocatorStats* stats) const {
+  return impl_->GetAllocatorStats(allocator_info, stats);
+}
+
 std::pair<common::Status, const InputDefList*> InferenceSession::GetModelInputs() const {
   return impl_->GetModelInputs();
 }
@@ -937,6 +1498,14 @@ std::string InferenceSession::EndProfiling() {
   return impl_->EndProfiling();
 }
 
+common::Status InferenceSession::GetMetrics(std::string& metrics) const {
+  return impl_->GetMetrics(metrics);
+}
+
+common::Status InferenceSession::ResetMetrics() {
+  return impl_->ResetMetrics();
+}
+
 common::Status InferenceSession::RegisterExecutionProvider(std::unique_ptr<IExecutionProvider> p_exec_provider) {
   return impl_->RegisterExecutionProvider(std::move(p_exec_provider));
 }
@@ -961,6 +1530,19 @@ common::Status InferenceSession::NewIOBinding(std::unique_ptr<IOBinding>* io_bin
   return impl_->NewIOBinding(io_binding);
 }
 
+common::Status InferenceSession::RunAsync(const RunOptions& run_options,
+                                          const NameMLValMap& feeds,
+                                          const std::vector<std::string>& output_names,
+                                          RunCallback callback) {
+  return impl_->RunAsync(run_options, feeds, output_names, std::move(callback));
+}
+
+common::Status InferenceSession::RunAsync(const NameMLValMap& feeds,
+                                          const std::vector<std::string>& output_names,
+                                          RunCallback callback) {
+  return impl_->RunAsync(feeds, output_names, std::move(callback));
+}
+
 common::Status InferenceSession::Run(const RunOptions& run_options, IOBinding& io_binding) {
   return impl_->Run(run_options, io_binding);
 }
@@ -969,6 +1551,19 @@ common::Status InferenceSession::Run(IOBinding& io_binding) {
   return impl_->Run(io_binding);
 }
 
+common::Status InferenceSession::PrepareRun(const RunOptions& run_options,
+                                            const std::vector<std::string>& input_names,
+                                            const std::vector<std::string>& output_names,
+                                            std::unique_ptr<PreparedRun>* prepared_run) {
+  return impl_->PrepareRun(run_options, input_names, output_names, prepared_run);
+}
+
+common::Status InferenceSession::Run(PreparedRun& prepared_run,
+                                     const std::vector<MLValue>& feeds,
+                                     std::vector<MLValue>* p_fetches) {
+  return impl_->Run(prepared_run, feeds, p_fetches);
+}
+
 common::Status InferenceSession::LoadCustomOps(const std::vector<std::string>& dso_list) {
   return impl_->LoadCustomOps(dso_list);
 }
@@ -3,8 +3,10 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "core/common/common.h"
 #include "core/common/status.h"
@@ -23,6 +25,8 @@ class ModelProto;
 namespace onnxruntime {
 class IExecutionProvider;  // forward decl
 class IOBinding;
+class PreparedRun;
+struct AllocatorStats;
 
 class CustomRegistry;
 
@@ -40,17 +44,35 @@ struct SessionOptions {
   // enable profiling for this session.
   bool enable_profiling = false;
 
+  // keep latency histograms of every op type and run and the mean and maximum latency of every node, see
+  // InferenceSession::GetMetrics. Unlike profiling, which records every event, this is cheap enough to leave on in
+  // production.
+  bool enable_metrics = false;
+
   // enable the memory pattern optimization.
   // The idea is if the input shapes are the same, we could trace the internal memory allocation
   // and generate a memory pattern for future request. So next time we could just do one allocation
   // with a big chunk for all the internal memory allocation.
   bool enable_mem_pattern = true;
 
+  // maximum number of memory patterns cached for different input shapes. once it is reached the least recently
+  // used pattern is evicted. 0 means unbounded.
+  size_t mem_pattern_cache_size = 32;
+
+  // round the input dims up to a multiple of this value when looking up a memory pattern, so a pattern serves a
+  // range of shapes (e.g. variable batch or sequence lengths). 0 uses the exact dims.
+  int64_t mem_pattern_dim_bucket_size = 0;
+
   // enable the memory arena on CPU
   // Arena may pre-allocate memory for future usage.
   // set this option to false if you don't want it.
   bool enable_cpu_mem_arena = true;
 
+  // put a per-thread cache of small blocks in front of the CPU memory arena.
+  // reduces contention on the arena lock when several threads allocate concurrently.
+  // has no effect if enable_cpu_mem_arena is false.
+  bool enable_cpu_mem_arena_thread_cache = false;
+
   // the prefix of the profile file. The current time will be appended to the file name.
   std::string profile_file_prefix = "onnxruntime_profile_";
 
@@ -59,8 +81,31 @@ struct SessionOptions {
 
   unsigned max_num_graph_transformation_steps = 5;  // TODO choose a good default here?
 
-  // How many threads in the session thread pool.
+  // How many threads in the session thread pools, which run the independent nodes for the parallel executor
+  // and the RunAsync calls. 0 uses half the number of hardware threads.
   int session_thread_pool_size = 0;
+
+  // How many threads are used to parallelize the execution within a node, including the thread calling Run.
+  // 0 uses the number of cores on the machine. 1 runs every node on the calling thread only.
+  int intra_op_num_threads = 0;
+
+  // How many threads run independent branches of the graph concurrently when sequential execution is enabled,
+  // including the thread calling Run. If greater than 1, the execution plan of the main graph is partitioned into
+  // chains of nodes when the session is initialized, and chains that don't depend on each other run concurrently.
+  // Buffers are then only shared between values whose lifetimes can't overlap and memory patterns aren't used.
+  // 0 or 1 runs all the nodes on the calling thread.
+  int branch_parallel_num_threads = 0;
+
+  // Logical processors to pin the intra-op worker threads to. Worker i is pinned to
+  // intra_op_thread_affinity[i % size]. Leave empty to let the OS schedule the workers.
+  std::vector<size_t> intra_op_thread_affinity;
+
+  // Path of a file caching the model after graph optimization and partitioning.
+  // If the file holds the model optimized for the same model and configuration, Initialize loads it and
+  // skips those steps. Otherwise Initialize optimizes the model as usual and writes it to the file.
+  // The model is identified by the path, size and modification time of its file(s), so the cache is only used
+  // for models loaded from a file. Leave empty to disable the cache.
+  std::string optimized_model_cache_path;
 };
 
 /**
@@ -113,6 +158,15 @@ class InferenceSession {
 
   virtual ~InferenceSession();
 
+  /**
+    * Cap the instruction set used by the MLAS kernels of the whole process, e.g. to compare the kernel variants on
+    * one machine. The MLAS_ISA_LEVEL environment variable sets the initial level the same way.
+    * @param isa_level "generic", "avx", "avx2", "avx512f" or "avx512vnni". Levels above the one the CPU supports
+    * select that level.
+    * @return OK if success. Fails if this changes the level while any session exists.
+    */
+  static common::Status SetMlasIsaLevel(const std::string& isa_level);
+
   /**
     * Register an execution provider. If you've one to register, call this before invoking Initialize().
     * The order of invocation indicates the preference order as well. In other words call this method 
@@ -196,6 +250,34 @@ class InferenceSession {
                      const std::vector<std::string>& output_names,
                      std::vector<MLValue>* p_fetches);
 
+  /**
+    * Called once a run started by RunAsync completes.
+    * @param fetches output values in the order specified by output_names. Empty if status is not OK.
+    */
+  using RunCallback = std::function<void(const common::Status& status, std::vector<MLValue>& fetches)>;
+
+  /**
+    * Run a pre-loaded and pre-initialized model asynchronously on the session's thread pool.
+    * Returns once the run is queued. Unless an error is returned, the callback is invoked exactly once
+    * on a thread of the pool. The callback must not destroy the session, whose destructor waits for
+    * the pending runs.
+    * @param run_options must stay alive until the callback is invoked. Setting terminate stops the run,
+    *        including one that hasn't started yet.
+    * @param feeds named inputs. They're shared with the caller and must not be changed until the callback is invoked.
+    */
+  common::Status RunAsync(const RunOptions& run_options,
+                          const NameMLValMap& feeds,
+                          const std::vector<std::string>& output_names,
+                          RunCallback callback);
+
+  /**
+    * See RunAsync(const RunOptions& run_options, const NameMLValMap& feeds,
+    * const std::vector<std::string>& output_names, RunCallback callback) for details.
+    */
+  common::Status RunAsync(const NameMLValMap& feeds,
+                          const std::vector<std::string>& output_names,
+                          RunCallback callback);
+
   /**
   * Creates a new binding object for binding inputs and outputs.
   * @param provider_type specifies the location where the inputs need to be potentially copied. 
@@ -206,12 +288,40 @@ class InferenceSession {
   common::Status Run(const RunOptions& run_options, IOBinding& io_binding);
   common::Status Run(IOBinding& io_binding);
 
+  /**
+    * Prepare runs for a fixed set of input and output names. The names are resolved once, and the execution frame
+    * and the kernel contexts are kept across the runs of the prepared run while the input shapes don't change,
+    * which removes most of the per run overhead of small models. This applies to sequential execution with a
+    * single execution provider; otherwise Run(PreparedRun&, ...) takes the regular path.
+    * @param run_options used by every run of the prepared run and must outlive it. Setting terminate stops the
+    *        run in progress.
+    * @param prepared_run is not thread-safe. Use one per thread.
+    */
+  common::Status PrepareRun(const RunOptions& run_options,
+                            const std::vector<std::string>& input_names,
+                            const std::vector<std::string>& output_names,
+                            std::unique_ptr<PreparedRun>* prepared_run);
+
+  /**
+    * Run a prepared run.
+    * @param feeds inputs in the order of the input names of the prepared run.
+    * @param p_fetches outputs in the order of the output names of the prepared run. As with Run, they can
+    *        be preallocated.
+    */
+  common::Status Run(PreparedRun& prepared_run, const std::vector<MLValue>& feeds, std::vector<MLValue>* p_fetches);
+
   /**
     * @return pair.first = OK; FAIL otherwise. pair.second is non-NULL when pair.first = OK.
     * @note lifetime of the returned pointer is valid as long as the Session object is live.
     */
   std::pair<common::Status, const ModelMetadata*> GetModelMetadata() const;
 
+  /**
+    * Get the statistics of the arena allocator matching allocator_info.
+    * @return INVALID_ARGUMENT if no execution provider owns a matching allocator or if it is not an arena.
+    */
+  common::Status GetAllocatorStats(const OrtAllocatorInfo& allocator_info, AllocatorStats* stats) const;
+
   /**
     * Get all input definitions of the model. This does not include weights. Use this
     * to get the name/type/shapes of the inputs.
@@ -252,6 +362,20 @@ class InferenceSession {
     */
   std::string EndProfiling();
 
+  /**
+    * Get the metrics collected since the session was initialized or the metrics were last reset: the latency
+    * percentiles of the runs and of every op type, the mean and maximum latency of every node, the memory pattern
+    * cache hits and the arena usage.
+    * Requires SessionOptions::enable_metrics.
+    *@param metrics receives a JSON object. Latencies are in microseconds.
+    */
+  common::Status GetMetrics(std::string& metrics) const;
+
+  /**
+    * Clear the latencies and counters collected so far. The peak arena usage isn't reset.
+    */
+  common::Status ResetMetrics();
+
  protected:
   /**
     * Load an ONNX model.
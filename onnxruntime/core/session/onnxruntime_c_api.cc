@@ -14,12 +14,15 @@
 #include "core/common/status.h"
 #include "core/graph/graph.h"
 #include "core/framework/allocator.h"
+#include "core/framework/arena.h"
 #include "core/framework/tensor.h"
 #include "core/framework/ml_value.h"
 #include "core/framework/environment.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/framework/onnxruntime_typeinfo.h"
 #include "core/session/inference_session.h"
+#include "core/session/batching_session.h"
+#include "core/session/IOBinding.h"
 
 #include "abi_session_options_impl.h"
 
@@ -113,6 +116,12 @@ ORT_API_STATUS_IMPL(OrtCreateEnvWithCustomLogger, OrtLoggingFunction logging_fun
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtSetMlasIsaLevel, _In_ const char* isa_level) {
+  API_IMPL_BEGIN
+  return ToOrtStatus(::onnxruntime::InferenceSession::SetMlasIsaLevel(isa_level));
+  API_IMPL_END
+}
+
 ORT_API_STATUS_IMPL(OrtCreateEnv, OrtLoggingLevel default_warning_level,
                     _In_ const char* logid, _Out_ OrtEnv** out) {
   API_IMPL_BEGIN
@@ -454,6 +463,203 @@ ORT_API_STATUS_IMPL(OrtRun, _In_ OrtSession* sess,
   API_IMPL_END
 }
 
+// Adapts a C completion callback to the callback of InferenceSession::RunAsync and BatchingSession::Submit.
+static ::onnxruntime::InferenceSession::RunCallback WrapRunCallback(OrtRunCallback callback, void* user_data) {
+  return [callback, user_data](const Status& status, std::vector<MLValue>& fetches) {
+    if (!status.IsOK()) {
+      callback(user_data, ToOrtStatus(status), nullptr, 0);
+      return;
+    }
+    std::vector<OrtValue*> outputs(fetches.size());
+    for (size_t i = 0; i != fetches.size(); ++i) {
+      ::onnxruntime::MLValue& value = fetches[i];
+      if (value.Fence())
+        value.Fence()->BeforeUsingAsInput(onnxruntime::kCpuExecutionProvider, 0);
+      outputs[i] = reinterpret_cast<OrtValue*>(new MLValue(value));
+    }
+    callback(user_data, nullptr, outputs.data(), outputs.size());
+  };
+}
+
+ORT_API_STATUS_IMPL(OrtRunAsync, _Inout_ OrtSession* sess, _In_opt_ OrtRunOptions* run_options,
+                    _In_ const char* const* input_names, _In_ const OrtValue* const* input, size_t input_len,
+                    _In_ const char* const* output_names1, size_t output_names_len,
+                    _In_ OrtRunCallback callback, _In_opt_ void* user_data) {
+  API_IMPL_BEGIN
+  if (callback == nullptr) {
+    return OrtCreateStatus(ORT_INVALID_ARGUMENT, "callback cannot be null");
+  }
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+  ::onnxruntime::NameMLValMap in;
+  const int queue_id = 0;
+  for (size_t i = 0; i != input_len; ++i) {
+    auto kvp = in.insert(std::make_pair(std::string(input_names[i]),
+                                        *reinterpret_cast<const ::onnxruntime::MLValue*>(input[i])));
+    if (!kvp.second) {
+      return OrtCreateStatus(ORT_INVALID_ARGUMENT, "duplicated input name");
+    }
+    ::onnxruntime::MLValue& value = kvp.first->second;
+    if (value.Fence())
+      value.Fence()->BeforeUsingAsInput(onnxruntime::kCpuExecutionProvider, queue_id);
+  }
+  std::vector<std::string> output_names(output_names_len);
+  for (size_t i = 0; i != output_names_len; ++i) {
+    if (output_names1[i] == nullptr || output_names1[i][0] == '\0') {
+      return OrtCreateStatus(ORT_INVALID_ARGUMENT, "output name cannot be empty");
+    }
+    output_names[i] = output_names1[i];
+  }
+
+  Status status;
+  if (run_options == nullptr) {
+    status = session->RunAsync(in, output_names, WrapRunCallback(callback, user_data));
+  } else {
+    status = session->RunAsync(*run_options, in, output_names, WrapRunCallback(callback, user_data));
+  }
+  return ToOrtStatus(status);
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtCreateBatchingSession, _In_ OrtSession* sess, size_t max_batch_size,
+                    int64_t batch_timeout_micros, _Out_ OrtBatchingSession** out) {
+  API_IMPL_BEGIN
+  if (max_batch_size == 0) {
+    return OrtCreateStatus(ORT_INVALID_ARGUMENT, "max_batch_size must be positive");
+  }
+  if (batch_timeout_micros < 0) {
+    return OrtCreateStatus(ORT_INVALID_ARGUMENT, "batch_timeout_micros must not be negative");
+  }
+  ::onnxruntime::BatchingOptions options;
+  options.max_batch_size = max_batch_size;
+  options.batch_timeout_micros = batch_timeout_micros;
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+  *out = reinterpret_cast<OrtBatchingSession*>(new ::onnxruntime::BatchingSession(*session, options));
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtBatchingSessionSubmit, _Inout_ OrtBatchingSession* sess,
+                    _In_ const char* const* input_names, _In_ const OrtValue* const* input, size_t input_len,
+                    _In_ const char* const* output_names1, size_t output_names_len,
+                    _In_ OrtRunCallback callback, _In_opt_ void* user_data) {
+  API_IMPL_BEGIN
+  if (callback == nullptr) {
+    return OrtCreateStatus(ORT_INVALID_ARGUMENT, "callback cannot be null");
+  }
+  auto session = reinterpret_cast<::onnxruntime::BatchingSession*>(sess);
+  ::onnxruntime::NameMLValMap in;
+  for (size_t i = 0; i != input_len; ++i) {
+    auto kvp = in.insert(std::make_pair(std::string(input_names[i]),
+                                        *reinterpret_cast<const ::onnxruntime::MLValue*>(input[i])));
+    if (!kvp.second) {
+      return OrtCreateStatus(ORT_INVALID_ARGUMENT, "duplicated input name");
+    }
+  }
+  std::vector<std::string> output_names(output_names_len);
+  for (size_t i = 0; i != output_names_len; ++i) {
+    if (output_names1[i] == nullptr || output_names1[i][0] == '\0') {
+      return OrtCreateStatus(ORT_INVALID_ARGUMENT, "output name cannot be empty");
+    }
+    output_names[i] = output_names1[i];
+  }
+
+  return ToOrtStatus(session->Submit(in, output_names, WrapRunCallback(callback, user_data)));
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtCreateIoBinding, _In_ OrtSession* sess, _Out_ OrtIoBinding** out) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+  std::unique_ptr<::onnxruntime::IOBinding> binding;
+  auto status = session->NewIOBinding(&binding);
+  if (!status.IsOK())
+    return ToOrtStatus(status);
+  *out = reinterpret_cast<OrtIoBinding*>(binding.release());
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtBindInput, _Inout_ OrtIoBinding* binding, _In_ const char* name, _In_ const OrtValue* value) {
+  API_IMPL_BEGIN
+  if (name == nullptr || name[0] == '\0') {
+    return OrtCreateStatus(ORT_INVALID_ARGUMENT, "input name cannot be empty");
+  }
+  if (value == nullptr) {
+    return OrtCreateStatus(ORT_INVALID_ARGUMENT, "input value cannot be null");
+  }
+  auto io_binding = reinterpret_cast<::onnxruntime::IOBinding*>(binding);
+  return ToOrtStatus(io_binding->BindInput(name, *reinterpret_cast<const ::onnxruntime::MLValue*>(value)));
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtBindOutput, _Inout_ OrtIoBinding* binding, _In_ const char* name,
+                    _In_opt_ const OrtValue* value) {
+  API_IMPL_BEGIN
+  if (name == nullptr || name[0] == '\0') {
+    return OrtCreateStatus(ORT_INVALID_ARGUMENT, "output name cannot be empty");
+  }
+  auto io_binding = reinterpret_cast<::onnxruntime::IOBinding*>(binding);
+  Status status;
+  if (value == nullptr) {
+    status = io_binding->BindOutput(name, MLValue());
+  } else {
+    status = io_binding->BindOutput(name, *reinterpret_cast<const ::onnxruntime::MLValue*>(value));
+  }
+  return ToOrtStatus(status);
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtRunWithBinding, _Inout_ OrtSession* sess, _In_opt_ OrtRunOptions* run_options,
+                    _Inout_ OrtIoBinding* binding) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+  auto io_binding = reinterpret_cast<::onnxruntime::IOBinding*>(binding);
+  const int queue_id = 0;
+  for (const auto& input : io_binding->GetInputs()) {
+    const ::onnxruntime::MLValue& value = input.second;
+    if (value.Fence())
+      value.Fence()->BeforeUsingAsInput(onnxruntime::kCpuExecutionProvider, queue_id);
+  }
+  for (::onnxruntime::MLValue& value : io_binding->GetOutputs()) {
+    if (value.Fence())
+      value.Fence()->BeforeUsingAsOutput(onnxruntime::kCpuExecutionProvider, queue_id);
+  }
+  Status status;
+  if (run_options == nullptr) {
+    status = session->Run(*io_binding);
+  } else {
+    status = session->Run(*run_options, *io_binding);
+  }
+  if (!status.IsOK())
+    return ToOrtStatus(status);
+  for (::onnxruntime::MLValue& value : io_binding->GetOutputs()) {
+    if (value.Fence())
+      value.Fence()->BeforeUsingAsInput(onnxruntime::kCpuExecutionProvider, queue_id);
+  }
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtGetBoundOutputValues, _In_ OrtIoBinding* binding, _Out_ OrtValue** output,
+                    size_t output_len) {
+  API_IMPL_BEGIN
+  auto io_binding = reinterpret_cast<::onnxruntime::IOBinding*>(binding);
+  std::vector<MLValue>& outputs = io_binding->GetOutputs();
+  if (output_len != outputs.size()) {
+    return OrtCreateStatus(ORT_INVALID_ARGUMENT, "output_len doesn't match the number of bound outputs");
+  }
+  for (size_t i = 0; i != output_len; ++i) {
+    if (!outputs[i].IsAllocated()) {
+      return OrtCreateStatus(ORT_FAIL, "output is not computed, call OrtRunWithBinding first");
+    }
+  }
+  for (size_t i = 0; i != output_len; ++i) {
+    output[i] = reinterpret_cast<OrtValue*>(new MLValue(outputs[i]));
+  }
+  return nullptr;
+  API_IMPL_END
+}
+
 ORT_API_STATUS_IMPL(OrtGetTensorMutableData, _In_ OrtValue* value, _Out_ void** output) {
   TENSOR_READWRITE_API_BEGIN
   //TODO: test if it's a string tensor
@@ -630,8 +836,54 @@ ORT_API_STATUS_IMPL(OrtSessionGetOutputName, _In_ const OrtSession* sess, size_t
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtSessionGetAllocatorStats, _In_ const OrtSession* sess, _In_ const OrtAllocatorInfo* info,
+                    _Out_ OrtAllocatorStats* out) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<const ::onnxruntime::InferenceSession*>(sess);
+  onnxruntime::AllocatorStats stats;
+  auto status = session->GetAllocatorStats(*info, &stats);
+  if (!status.IsOK())
+    return ToOrtStatus(status);
+
+  out->num_allocs = stats.num_allocs;
+  out->bytes_in_use = stats.bytes_in_use;
+  out->max_bytes_in_use = stats.max_bytes_in_use;
+  out->total_allocated_bytes = stats.total_allocated_bytes;
+  out->bytes_limit = stats.bytes_limit;
+  out->num_cache_hits = stats.num_cache_hits;
+  out->num_cache_misses = stats.num_cache_misses;
+  out->bytes_cached = stats.bytes_cached;
+  out->fragmentation = stats.total_allocated_bytes > 0
+                           ? 1.0 - static_cast<double>(stats.bytes_in_use) / stats.total_allocated_bytes
+                           : 0.0;
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtSessionGetMetrics, _In_ const OrtSession* sess, _Inout_ OrtAllocator* allocator,
+                    _Out_ char** value) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<const ::onnxruntime::InferenceSession*>(sess);
+  std::string metrics;
+  auto status = session->GetMetrics(metrics);
+  if (!status.IsOK())
+    return ToOrtStatus(status);
+  *value = StrDup(metrics, allocator);
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtSessionResetMetrics, _Inout_ OrtSession* sess) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+  return ToOrtStatus(session->ResetMetrics());
+  API_IMPL_END
+}
+
 DEFINE_RELEASE_ORT_OBJECT_FUNCTION(Env, OrtEnv)
 DEFINE_RELEASE_ORT_OBJECT_FUNCTION(Value, MLValue)
 DEFINE_RELEASE_ORT_OBJECT_FUNCTION(RunOptions, OrtRunOptions)
 DEFINE_RELEASE_ORT_OBJECT_FUNCTION(Session, ::onnxruntime::InferenceSession)
+DEFINE_RELEASE_ORT_OBJECT_FUNCTION(BatchingSession, ::onnxruntime::BatchingSession)
+DEFINE_RELEASE_ORT_OBJECT_FUNCTION(IoBinding, ::onnxruntime::IOBinding)
 DEFINE_RELEASE_ORT_OBJECT_FUNCTION_FOR_ARRAY(Status, char)
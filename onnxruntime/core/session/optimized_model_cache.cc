@@ -0,0 +1,185 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/optimized_model_cache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <set>
+#include <sstream>
+
+#include "onnxruntime_config.h"
+#include "core/framework/tensorprotoutils.h"
+#include "core/graph/graph_viewer.h"
+#include "core/platform/env.h"
+
+using namespace ONNX_NAMESPACE;
+
+namespace onnxruntime {
+namespace optimized_model_cache {
+
+static const char* const kCacheKey = "onnxruntime.optimized_model_cache.key";
+static const char* const kNodeProviders = "onnxruntime.optimized_model_cache.node_providers";
+
+static Status WriteFileInfo(std::ostream& key, const std::string& path) {
+  uint64_t file_length;
+  uint64_t modification_time;
+  ORT_RETURN_IF_ERROR(Env::Default().GetFileInfo(path, file_length, modification_time));
+  key << " " << path << " " << file_length << " " << modification_time;
+  return Status::OK();
+}
+
+Status ComputeKey(const std::string& model_path, const Graph& graph, const std::string& model_dir,
+                  const std::vector<std::string>& config, std::string& key) {
+  std::set<std::string> external_data_paths;
+  for (const auto& initializer : graph.GetAllInitializedTensors()) {
+    if (utils::HasExternalData(*initializer.second)) {
+      std::string location;
+      size_t offset;
+      size_t length;
+      ORT_RETURN_IF_ERROR(utils::GetExternalDataInfo(*initializer.second, location, offset, length));
+      std::string path;
+      ORT_RETURN_IF_ERROR(utils::GetExternalDataPath(model_dir, location, path));
+      external_data_paths.insert(path);
+    }
+  }
+
+  std::ostringstream key_stream;
+  key_stream << "onnxruntime " << ORT_VERSION << ";model";
+  ORT_RETURN_IF_ERROR(WriteFileInfo(key_stream, model_path));
+  if (!external_data_paths.empty()) {
+    key_stream << ";external_data";
+    for (const auto& path : external_data_paths) {
+      ORT_RETURN_IF_ERROR(WriteFileInfo(key_stream, path));
+    }
+  }
+  for (const auto& entry : config) {
+    key_stream << ";" << entry;
+  }
+
+  key = key_stream.str();
+  return Status::OK();
+}
+
+bool CanCache(const Graph& graph, std::string& reason) {
+  for (const auto& node : graph.Nodes()) {
+    if (node.NodeType() == Node::Type::Fused) {
+      reason = "node " + node.Name() + " was fused by the " + node.GetExecutionProviderType() +
+               " execution provider";
+      return false;
+    }
+
+    for (const auto& attr : node.GetAttributes()) {
+      if (attr.second.has_g()) {
+        reason = "node " + node.Name() + " has a subgraph";
+        return false;
+      }
+    }
+
+    if (node.GetExecutionProviderType().empty()) {
+      reason = "node " + node.Name() + " has no execution provider assigned";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+common::Status Save(const std::string& path, const std::string& key, Model& model) {
+  ModelProto model_proto = model.ToProto();
+
+  // ToProto writes the nodes in topological order, which is the order the nodes are created in
+  // (and hence indexed by) when the cache is loaded.
+  GraphViewer viewer(model.MainGraph());
+  std::string node_providers;
+  for (auto node_index : viewer.GetNodesInTopologicalOrder()) {
+    if (!node_providers.empty()) {
+      node_providers += ",";
+    }
+    node_providers += viewer.GetNode(node_index)->GetExecutionProviderType();
+  }
+
+  auto* key_prop = model_proto.add_metadata_props();
+  key_prop->set_key(kCacheKey);
+  key_prop->set_value(key);
+  auto* providers_prop = model_proto.add_metadata_props();
+  providers_prop->set_key(kNodeProviders);
+  providers_prop->set_value(node_providers);
+
+  // every writer uses its own temporary file next to the cache, so sessions saving at the same time don't write
+  // into each other's file, and the rename stays on one file system
+  std::random_device random;
+  std::ostringstream tmp_path_stream;
+  tmp_path_stream << path << "." << Env::Default().GetSelfPid() << "." << std::hex << random() << random() << ".tmp";
+  const std::string tmp_path = tmp_path_stream.str();
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    const bool written = file && model_proto.SerializeToOstream(&file);
+    file.close();
+    if (!written || file.fail()) {
+      std::remove(tmp_path.c_str());
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to write the optimized model cache to ", tmp_path);
+    }
+  }
+
+  auto status = Env::Default().ReplaceFile(tmp_path, path);
+  if (!status.IsOK()) {
+    std::remove(tmp_path.c_str());
+  }
+  return status;
+}
+
+static std::vector<std::string> Split(const std::string& value, char separator) {
+  std::vector<std::string> result;
+  std::string::size_type start = 0;
+  while (true) {
+    auto end = value.find(separator, start);
+    result.push_back(value.substr(start, end - start));
+    if (end == std::string::npos) {
+      break;
+    }
+    start = end + 1;
+  }
+  return result;
+}
+
+common::Status Load(const std::string& path, const std::string& key,
+                    const IOnnxRuntimeOpSchemaRegistryList* local_registries,
+                    std::shared_ptr<Model>& model, bool& loaded) {
+  loaded = false;
+
+  if (!std::ifstream(path)) {
+    return Status::OK();  // no cache yet
+  }
+
+  std::shared_ptr<Model> cached_model;
+  ORT_RETURN_IF_ERROR(Model::Load(path, cached_model, local_registries));
+
+  const auto& metadata = cached_model->MetaData();
+  auto key_entry = metadata.find(kCacheKey);
+  auto providers_entry = metadata.find(kNodeProviders);
+  if (key_entry == metadata.end() || key_entry->second != key || providers_entry == metadata.end()) {
+    return Status::OK();  // stale
+  }
+
+  Graph& graph = cached_model->MainGraph();
+  const auto node_providers = Split(providers_entry->second, ',');
+  if (graph.NumberOfNodes() == 0 && node_providers.size() == 1 && node_providers[0].empty()) {
+    loaded = true;
+  } else if (static_cast<int>(node_providers.size()) != graph.NumberOfNodes() ||
+             graph.MaxNodeIndex() != graph.NumberOfNodes()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_GRAPH, "The optimized model cache ", path, " has ",
+                           graph.NumberOfNodes(), " nodes but ", node_providers.size(), " node providers");
+  } else {
+    for (int i = 0; i < graph.MaxNodeIndex(); ++i) {
+      graph.GetNode(i)->SetExecutionProviderType(node_providers[i]);
+    }
+    loaded = true;
+  }
+
+  model = cached_model;
+  return Status::OK();
+}
+}  // namespace optimized_model_cache
+}  // namespace onnxruntime
@@ -0,0 +1,60 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/common/status.h"
+#include "core/graph/model.h"
+
+namespace onnxruntime {
+/**
+Caches the main graph of a session after the graph transformers, the partitioning and the insertion of
+cast and copy nodes have run, so that a later session for the same model and configuration can load it
+and skip those steps.
+
+The cache is an ONNX model. The cache key and the execution provider assigned to each node are
+stored in its metadata_props. A cache that was written with a different key is stale and is ignored.
+*/
+namespace optimized_model_cache {
+
+/**
+Compute the cache key of a model loaded from a file.
+The model is identified by the path, size and modification time of its file and of the files holding its
+external data, so computing the key reads none of the weights.
+@param model_path Path of the model file.
+@param graph The main graph as loaded, before any transformation.
+@param model_dir Directory the external data locations are relative to.
+@param config Everything other than the model that affects the optimized graph, e.g. the execution providers
+and the graph transformers in the order they are applied.
+*/
+common::Status ComputeKey(const std::string& model_path, const Graph& graph, const std::string& model_dir,
+                          const std::vector<std::string>& config, std::string& key);
+
+/**
+Check whether an optimized graph can be restored from an ONNX model.
+Fused nodes created by execution providers and nodes with subgraphs can't be cached.
+@param[out] reason Why the graph can't be cached.
+*/
+bool CanCache(const Graph& graph, std::string& reason);
+
+/**
+Save the optimized model to 'path'. The model is written to a temporary file with a unique name in the same
+directory, which then atomically replaces 'path'. Sessions reading the cache meanwhile see either the previous
+file or the new one. Of several sessions saving at the same time, the last one to finish wins.
+*/
+common::Status Save(const std::string& path, const std::string& key, Model& model);
+
+/**
+Load the cached model at 'path' if it exists and was saved with 'key'.
+@param[out] model Set to the cached model with the execution providers assigned, if loaded is true.
+@param[out] loaded False if there is no cache or it is stale.
+*/
+common::Status Load(const std::string& path, const std::string& key,
+                    const IOnnxRuntimeOpSchemaRegistryList* local_registries,
+                    std::shared_ptr<Model>& model, bool& loaded);
+}  // namespace optimized_model_cache
+}  // namespace onnxruntime
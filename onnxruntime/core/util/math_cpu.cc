@@ -33,6 +33,7 @@
 #include <chrono>
 #include <random>
 #include <unordered_set>
+#include <vector>
 #include "core/platform/env.h"
 #include "core/common/logging/logging.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
@@ -108,7 +109,7 @@ void Gemm<float, CPUMathUtil>(
 #elif defined(USE_MLAS)
   int lda = (int)((TransA == CblasNoTrans) ? K : M);
   int ldb = (int)((TransB == CblasNoTrans) ? N : K);
-  MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, N);
+  MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, N, nullptr);
 #else
   auto C_mat = EigenMatrixMap<float>(C, N, M);
   if (beta == 0) {
@@ -179,7 +180,7 @@ void GemmEx<float, CPUMathUtil>(
     ORT_THROW("mkldnn_sgemm failed with status: ", status);
   }
 #elif defined(USE_MLAS)
-  MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+  MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, nullptr);
 #else
   using OuterStride = Eigen::OuterStride<Eigen::Dynamic>;
   using StridedMap = Eigen::Map<Eigen::MatrixXf, 0, OuterStride>;
@@ -447,10 +448,10 @@ void GemmBatched<float, CPUMathUtil>(
     const int M,
     const int N,
     const int K,
-    const float /*alpha*/,
+    const float alpha,
     const float* A,
     const float* B,
-    const float /*beta*/,
+    const float beta,
     float* C,
     CPUMathUtil* provider,
     Tensor*, /* scratch */
@@ -458,6 +459,22 @@ void GemmBatched<float, CPUMathUtil>(
   auto a_offset = A_size / A_batches;
   auto b_offset = B_size / B_batches;
   auto y_offset = M * N;
+#if defined(USE_MLAS) && !defined(USE_MKLDNN)
+  ORT_UNUSED_PARAMETER(provider);
+  // run the whole batch in a single MLAS dispatch. a single B is broadcast across the batches of A.
+  const size_t lda = static_cast<size_t>((TransA == CblasNoTrans) ? K : M);
+  const size_t ldb = static_cast<size_t>((TransB == CblasNoTrans) ? N : K);
+  std::vector<MLAS_SGEMM_DATA_PARAMS> data(A_batches);
+  for (int i = 0; i < A_batches; ++i) {
+    data[i].A = A + a_offset * i;
+    data[i].lda = lda;
+    data[i].B = B + b_offset * (i % B_batches);
+    data[i].ldb = ldb;
+    data[i].C = C + y_offset * i;
+    data[i].ldc = static_cast<size_t>(N);
+  }
+  MlasSgemmBatch(TransA, TransB, M, N, K, alpha, data.data(), beta, data.size(), nullptr);
+#else
   // loop over matrices in the batch
   for (int i = 0; i < A_batches; ++i) {
     math::Gemm<float, CPUMathUtil>(
@@ -466,13 +483,14 @@ void GemmBatched<float, CPUMathUtil>(
         M,
         N,
         K,
-        1,
+        alpha,
         A + a_offset * i,
-        B + b_offset * i,
-        0,
+        B + b_offset * (i % B_batches),
+        beta,
         C + y_offset * i,
         provider);
   }
+#endif
 }
 
   // MKL will be implmenet as an execution provider
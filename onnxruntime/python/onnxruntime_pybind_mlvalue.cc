@@ -75,7 +75,48 @@ bool PyObjectCheck_Array(PyObject* o) {
   return PyObject_HasAttrString(o, "__array_finalize__");
 }
 
+// Wraps the buffer of a numpy array as a tensor that doesn't own it, which avoids copying the input.
+// This requires a C contiguous, aligned array in the native byte order whose element type maps to a tensor type
+// of the same size. String arrays are always converted.
+static bool TryCreateTensorMLValueNoCopy(const AllocatorPtr& alloc, PyArrayObject* pyObject, MLValue* p_mlvalue) {
+  const int npy_type = PyArray_TYPE(pyObject);
+  if (npy_type == NPY_UNICODE || npy_type == NPY_STRING || npy_type == NPY_VOID || npy_type == NPY_OBJECT ||
+      !PyArray_ISCARRAY_RO(pyObject)) {
+    return false;
+  }
+
+  auto element_type = NumpyToOnnxRuntimeTensorType(npy_type);
+  if (element_type->Size() != static_cast<size_t>(PyArray_ITEMSIZE(pyObject))) {
+    return false;
+  }
+
+  int ndim = PyArray_NDIM(pyObject);
+  npy_intp* npy_dims = PyArray_DIMS(pyObject);
+  std::vector<int64_t> dims(ndim);
+  for (int i = 0; i < ndim; ++i) {
+    dims[i] = npy_dims[i];
+  }
+
+  std::unique_ptr<Tensor> p_tensor = std::make_unique<Tensor>(element_type,
+                                                              TensorShape(dims),
+                                                              PyArray_DATA(pyObject),
+                                                              alloc->Info());
+  p_mlvalue->Init(p_tensor.release(),
+                  DataTypeImpl::GetType<Tensor>(),
+                  DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+  return true;
+}
+
+bool TryCreateTensorMLValueNoCopy(const AllocatorPtr& alloc, py::object& value, MLValue* p_mlvalue) {
+  return PyArray_Check(value.ptr()) &&
+         TryCreateTensorMLValueNoCopy(alloc, reinterpret_cast<PyArrayObject*>(value.ptr()), p_mlvalue);
+}
+
 void CreateTensorMLValue(AllocatorPtr alloc, const std::string& name_input, PyArrayObject* pyObject, MLValue* p_mlvalue) {
+  if (TryCreateTensorMLValueNoCopy(alloc, pyObject, p_mlvalue)) {
+    return;
+  }
+
   PyArrayObject* darray = PyArray_GETCONTIGUOUS(pyObject);
   if (darray == NULL) {
     throw std::runtime_error(std::string("The object must be a contiguous array for input '") + name_input + std::string("'."));
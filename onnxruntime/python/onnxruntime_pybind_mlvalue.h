@@ -24,7 +24,13 @@ namespace py = pybind11;
 
 int OnnxRuntimeTensorToNumpyType(const DataTypeImpl* tensor_type);
 
+// Converts a Python object to an MLValue. A numpy array that is C contiguous, aligned and in the native byte order
+// is wrapped without copying its data, so the caller must keep value alive while the MLValue is in use.
 void CreateGenericMLValue(AllocatorPtr alloc, const std::string& name_input, py::object& value, MLValue* p_mlvalue);
 
+// Wraps the data of a numpy array in a tensor MLValue without copying it. Returns false, leaving p_mlvalue untouched,
+// if value isn't a C contiguous and aligned numpy array whose elements can be used as they are stored.
+bool TryCreateTensorMLValueNoCopy(const AllocatorPtr& alloc, py::object& value, MLValue* p_mlvalue);
+
 }  // namespace python
 }  // namespace onnxruntime
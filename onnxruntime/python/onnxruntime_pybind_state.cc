@@ -8,6 +8,8 @@
 #include <numpy/arrayobject.h>
 
 #include "core/graph/graph_viewer.h"
+#include "core/session/IOBinding.h"
+#include "core/mlas/inc/mlas.h"
 
 #if USE_CUDA
 #define BACKEND_PROC "GPU"
@@ -142,6 +144,20 @@ void AddTensorAsPyObj(onnxruntime::MLValue& val, vector<py::object>& pyobjs) {
 
   MLDataType dtype = rtensor.DataType();
   const int numpy_type = OnnxRuntimeTensorToNumpyType(dtype);
+
+  if (numpy_type != NPY_OBJECT && rtensor.OwnsBuffer()) {
+    // Borrow the buffer of a tensor allocated for this output instead of copying it. The array's base object is
+    // a capsule holding a reference to the MLValue, which keeps the buffer alive as long as the array.
+    py::capsule owner(new MLValue(val), [](void* p) { delete static_cast<MLValue*>(p); });
+    py::object obj = py::reinterpret_steal<py::object>(PyArray_SimpleNewFromData(
+        shape.NumDimensions(), npy_dims.data(), numpy_type, const_cast<void*>(rtensor.DataRaw(dtype))));
+    if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(obj.ptr()), owner.release().ptr()) != 0) {
+      throw py::error_already_set();
+    }
+    pyobjs.push_back(obj);
+    return;
+  }
+
   py::object obj = py::reinterpret_steal<py::object>(PyArray_SimpleNew(
       shape.NumDimensions(), npy_dims.data(), numpy_type));
 
@@ -161,6 +177,22 @@ void AddTensorAsPyObj(onnxruntime::MLValue& val, vector<py::object>& pyobjs) {
   pyobjs.push_back(obj);
 }
 
+// An IOBinding together with the numpy arrays bound to it. Bound arrays are used in place by the session,
+// so they are kept alive here until they are rebound or the binding is released.
+struct SessionIOBinding {
+  explicit SessionIOBinding(InferenceSession* sess) {
+    auto status = sess->NewIOBinding(&binding);
+    if (!status.IsOK()) {
+      throw std::runtime_error(status.ToString().c_str());
+    }
+  }
+
+  std::unique_ptr<IOBinding> binding;
+  std::unordered_map<std::string, py::object> input_arrays;
+  // preallocated output arrays by output name; None for outputs allocated by the session
+  std::unordered_map<std::string, py::object> output_arrays;
+};
+
 class SessionObjectInitializer {
  public:
   typedef const SessionOptions& Arg1;
@@ -222,6 +254,29 @@ void addGlobalMethods(py::module& m) {
   m.def(
       "get_device", []() -> std::string { return BACKEND_DEVICE; },
       "Return the device used to compute the prediction (CPU, MKL, ...)");
+  m.def(
+      "get_mlas_kernel_selection", []() -> std::map<std::string, std::string> {
+        std::map<std::string, std::string> report;
+        report["IsaLevel"] = MlasGetIsaLevelName(MlasGetIsaLevel());
+        report["SupportedIsaLevel"] = MlasGetIsaLevelName(MlasGetSupportedIsaLevel());
+        const MLAS_KERNEL_SELECTION* selection;
+        size_t count = MlasGetKernelSelection(&selection);
+        for (size_t i = 0; i < count; i++) {
+          report[selection[i].EntryPoint] = selection[i].Variant;
+        }
+        return report;
+      },
+      "Return the instruction set level used by the CPU kernels and the kernel variant of each MLAS entry point.");
+  m.def(
+      "set_mlas_isa_level", [](const std::string& isa_level) {
+        auto status = InferenceSession::SetMlasIsaLevel(isa_level);
+        if (!status.IsOK()) {
+          throw std::runtime_error(status.ToString().c_str());
+        }
+      },
+      R"pbdoc(Cap the instruction set used by the CPU kernels of the process: 'generic', 'avx', 'avx2', 'avx512f' or
+'avx512vnni'. Meant for comparing the kernel variants on one machine. Fails if this changes the level while any
+session exists.)pbdoc");
 }
 
 void addObjectMethods(py::module& m) {
@@ -234,11 +289,28 @@ void addObjectMethods(py::module& m) {
 The idea is if the input shapes are the same, we could trace the internal memory allocation
 and generate a memory pattern for future request. So next time we could just do one allocation
 with a big chunk for all the internal memory allocation. Default is true.)pbdoc")
+      .def_readwrite("mem_pattern_cache_size", &SessionOptions::mem_pattern_cache_size,
+                     R"pbdoc(Maximum number of memory patterns cached for different input shapes.
+The least recently used pattern is evicted once it is reached. 0 means unbounded. Default is 32.)pbdoc")
+      .def_readwrite("mem_pattern_dim_bucket_size", &SessionOptions::mem_pattern_dim_bucket_size,
+                     R"pbdoc(Round the input dims up to a multiple of this value when looking up a memory pattern,
+so a pattern serves a range of shapes. Default is 0 to use the exact dims.)pbdoc")
       .def_readwrite("enable_cpu_mem_arena", &SessionOptions::enable_cpu_mem_arena,
                      R"pbdoc(Enables the memory arena on CPU. Arena may pre-allocate memory for future usage.
 Set this option to false if you don't want it. Default is True.)pbdoc")
+      .def_readwrite("enable_cpu_mem_arena_thread_cache", &SessionOptions::enable_cpu_mem_arena_thread_cache,
+                     R"pbdoc(Puts a per-thread cache of small blocks in front of the CPU memory arena to reduce lock
+contention when several threads allocate concurrently. Default is False.)pbdoc")
+      .def_readwrite("optimized_model_cache_path", &SessionOptions::optimized_model_cache_path,
+                     R"pbdoc(Path of a file caching the model after graph optimization and partitioning.
+If it was written for the same model and configuration, initialization loads it and skips those steps.
+Otherwise the model is optimized and saved to it. Only models loaded from a file are cached.
+Empty disables the cache. Default is empty.)pbdoc")
       .def_readwrite("enable_profiling", &SessionOptions::enable_profiling,
                      R"pbdoc(Enable profiling for this session. Default is false.)pbdoc")
+      .def_readwrite("enable_metrics", &SessionOptions::enable_metrics,
+                     R"pbdoc(Keep latency histograms of every op type and run and the mean and maximum latency
+of every node, which are cheap enough to leave on in production. Default is false.)pbdoc")
       .def_readwrite("enable_sequential_execution", &SessionOptions::enable_sequential_execution,
                      R"pbdoc(Enables sequential execution, disables parallel execution. Default is true.)pbdoc")
       .def_readwrite("max_num_graph_transformation_steps", &SessionOptions::max_num_graph_transformation_steps,
@@ -249,7 +321,16 @@ Set this option to false if you don't want it. Default is True.)pbdoc")
                      R"pbdoc(Applies to session load, initialization, etc. Default is 0.)pbdoc")
       .def_readwrite("session_thread_pool_size", &SessionOptions::session_thread_pool_size,
                      R"pbdoc(How many threads in the session thread pool. Default is 0 to let onnxruntime choose.
-This parameter is unused unless *enable_sequential_execution* is false.)pbdoc");
+This parameter is unused unless *enable_sequential_execution* is false.)pbdoc")
+      .def_readwrite("intra_op_num_threads", &SessionOptions::intra_op_num_threads,
+                     R"pbdoc(How many threads are used to parallelize the execution within a node, including the
+calling thread. Default is 0 to use the number of cores. 1 disables the parallelism within nodes.)pbdoc")
+      .def_readwrite("intra_op_thread_affinity", &SessionOptions::intra_op_thread_affinity,
+                     R"pbdoc(Logical processors to pin the intra-op worker threads to. Default is empty.)pbdoc")
+      .def_readwrite("branch_parallel_num_threads", &SessionOptions::branch_parallel_num_threads,
+                     R"pbdoc(How many threads run independent branches of the graph concurrently, including the
+calling thread. Default is 0, which runs all the nodes on the calling thread.
+This parameter is unused unless *enable_sequential_execution* is true.)pbdoc");
 
   py::class_<RunOptions>(m, "RunOptions", R"pbdoc(Configuration information for a single Run.)pbdoc")
       .def(py::init())
@@ -326,6 +407,61 @@ including arg name, arg type (contains both type and shape).)pbdoc")
           },
           "node shape (assuming the node holds a tensor)");
 
+  py::class_<SessionIOBinding>(m, "SessionIOBinding", R"pbdoc(Binds numpy arrays to the inputs and outputs of a
+session so that runs read and write them in place.)pbdoc")
+      .def(py::init<InferenceSession*>(), py::keep_alive<1, 2>())
+      .def(
+          "bind_input", [](SessionIOBinding* io_binding, const std::string& name, py::object arr) {
+            MLValue ml_value;
+            CreateGenericMLValue(GetAllocator(), name, arr, &ml_value);
+            auto status = io_binding->binding->BindInput(name, ml_value);
+            if (!status.IsOK()) {
+              throw std::runtime_error(status.ToString().c_str());
+            }
+            io_binding->input_arrays[name] = arr;
+          },
+          R"pbdoc(Bind a numpy array to an input. A C contiguous array of a numeric type is used without a copy.)pbdoc")
+      .def(
+          "bind_output", [](SessionIOBinding* io_binding, const std::string& name, py::object arr) {
+            MLValue ml_value;
+            if (!arr.is_none()) {
+              // the session writes into the array, so binding a copy of it would silently lose the outputs
+              if (!PyArray_Check(arr.ptr()) || !PyArray_ISCARRAY(reinterpret_cast<PyArrayObject*>(arr.ptr())) ||
+                  !TryCreateTensorMLValueNoCopy(GetAllocator(), arr, &ml_value)) {
+                throw std::runtime_error("Output '" + name +
+                                         "' must be bound to a writeable C contiguous numpy array of a numeric type.");
+              }
+            }
+            auto status = io_binding->binding->BindOutput(name, ml_value);
+            if (!status.IsOK()) {
+              throw std::runtime_error(status.ToString().c_str());
+            }
+            io_binding->output_arrays[name] = arr;
+          },
+          R"pbdoc(Bind an output to a preallocated numpy array that the session writes in place, or to None to let
+the session allocate it on every run.)pbdoc")
+      .def(
+          "get_outputs", [](SessionIOBinding* io_binding) -> std::vector<py::object> {
+            const auto& names = io_binding->binding->GetOutputNames();
+            auto& outputs = io_binding->binding->GetOutputs();
+            std::vector<py::object> rfetch;
+            rfetch.reserve(outputs.size());
+            for (size_t i = 0; i < outputs.size(); ++i) {
+              const auto& arr = io_binding->output_arrays.at(names[i]);
+              if (!arr.is_none()) {
+                rfetch.push_back(arr);
+              } else if (!outputs[i].IsAllocated()) {
+                rfetch.push_back(py::none());
+              } else if (outputs[i].IsTensor()) {
+                AddTensorAsPyObj(outputs[i], rfetch);
+              } else {
+                AddNonTensorAsPyObj(outputs[i], rfetch);
+              }
+            }
+            return rfetch;
+          },
+          R"pbdoc(Return the outputs of the last run in the order they were bound.)pbdoc");
+
   py::class_<SessionObjectInitializer>(m, "SessionObjectInitializer");
   py::class_<InferenceSession>(m, "InferenceSession", R"pbdoc(This is the main class used to run a model.)pbdoc")
       .def(py::init<SessionObjectInitializer, SessionObjectInitializer>())
@@ -395,9 +531,44 @@ including arg name, arg type (contains both type and shape).)pbdoc")
         }
         return rfetch;
       })
+      .def("run_with_iobinding", [](InferenceSession* sess, SessionIOBinding& io_binding, RunOptions* run_options = nullptr) -> void {
+        // outputs the session allocates are released before each run, so their shapes may change between runs.
+        // the arrays returned for the previous run keep their own reference to the buffers.
+        for (const auto& output : io_binding.output_arrays) {
+          if (output.second.is_none()) {
+            io_binding.binding->BindOutput(output.first, MLValue());
+          }
+        }
+
+        common::Status status;
+        if (run_options != nullptr) {
+          status = sess->Run(*run_options, *io_binding.binding);
+        } else {
+          status = sess->Run(*io_binding.binding);
+        }
+
+        if (!status.IsOK()) {
+          auto mes = status.ToString();
+          throw std::runtime_error(std::string("Method run_with_iobinding failed due to: ") + std::string(mes.c_str()));
+        }
+      })
       .def("end_profiling", [](InferenceSession* sess) -> std::string {
         return sess->EndProfiling();
       })
+      .def("get_metrics", [](const InferenceSession* sess) -> std::string {
+        std::string metrics;
+        auto status = sess->GetMetrics(metrics);
+        if (!status.IsOK()) {
+          throw std::runtime_error(status.ToString().c_str());
+        }
+        return metrics;
+      })
+      .def("reset_metrics", [](InferenceSession* sess) {
+        auto status = sess->ResetMetrics();
+        if (!status.IsOK()) {
+          throw std::runtime_error(status.ToString().c_str());
+        }
+      })
       .def_property_readonly("inputs_meta", [](const InferenceSession* sess) -> const std::vector<const onnxruntime::NodeArg*>& {
         auto res = sess->GetModelInputs();
         if (!res.first.IsOK()) {
@@ -5,6 +5,7 @@
 
 import sys
 import os
+import json
 
 from onnxruntime.capi import _pybind_state as C
 
@@ -71,6 +72,26 @@ class InferenceSession:
             output_names = [output.name for output in self._outputs_meta]
         return self._sess.run(output_names, input_feed, run_options)
 
+    def io_binding(self):
+        "Return an :class:`onnxruntime.IOBinding` for this session."
+        return IOBinding(self)
+
+    def run_with_iobinding(self, iobinding, run_options=None):
+        """
+        Compute the predictions with the inputs and outputs bound to `iobinding`.
+
+        :param iobinding: the :class:`onnxruntime.IOBinding` returned by :meth:`io_binding`
+        :param run_options: See :class:`onnxruntime.RunOptions`.
+
+        ::
+
+            binding = sess.io_binding()
+            binding.bind_input(input_name, x)
+            binding.bind_output(output_name, y)
+            sess.run_with_iobinding(binding)
+        """
+        self._sess.run_with_iobinding(iobinding._iobinding, run_options)
+
     def end_profiling(self):
         """
         End profiling and return results in a file.
@@ -79,3 +100,64 @@ class InferenceSession:
         :meth:`onnxruntime.SessionOptions.enable_profiling`.
         """
         return self._sess.end_profiling()
+
+    def get_metrics(self):
+        """
+        Return the metrics collected since the session was created or
+        :meth:`reset_metrics` was last called, as a dictionary: the latency
+        percentiles of the runs and of every op type and the mean and maximum
+        latency of every node in microseconds, the memory pattern cache hits
+        and the usage of every arena.
+
+        Requires the option :meth:`onnxruntime.SessionOptions.enable_metrics`.
+        """
+        return json.loads(self._sess.get_metrics())
+
+    def reset_metrics(self):
+        """
+        Clear the latencies and counters collected so far.
+        The peak arena usage isn't reset.
+        """
+        self._sess.reset_metrics()
+
+
+class IOBinding:
+    """
+    Binds numpy arrays to the inputs and outputs of an :class:`onnxruntime.InferenceSession`.
+    The session reads the bound inputs and writes the preallocated outputs in place, so a binding
+    can be reused across runs by updating the contents of its arrays.
+    """
+    def __init__(self, session):
+        """
+        :param session: the :class:`onnxruntime.InferenceSession` the binding is run with
+        """
+        self._iobinding = C.SessionIOBinding(session._sess)
+
+    def bind_input(self, name, arr):
+        """
+        Bind an input to a numpy array.
+
+        A C contiguous array of a numeric type is used without a copy. The binding keeps a
+        reference to it, so changes to its contents are seen by the next run.
+
+        :param name: input name
+        :param arr: numpy array
+        """
+        self._iobinding.bind_input(name, arr)
+
+    def bind_output(self, name, arr=None):
+        """
+        Bind an output.
+
+        :param name: output name
+        :param arr: writeable C contiguous numpy array of the output's type and shape, which each run
+            writes in place, or None to let the session allocate the output on every run
+        """
+        self._iobinding.bind_output(name, arr)
+
+    def get_outputs(self):
+        """
+        Return the outputs of the last run as a list in the order they were bound.
+        Preallocated outputs are returned as the bound arrays.
+        """
+        return self._iobinding.get_outputs()
@@ -0,0 +1,131 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/metrics.h"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace profiling {
+namespace test {
+
+TEST(MetricsTest, BucketBounds) {
+  EXPECT_EQ(LatencyStats::BucketIndex(0), 0);
+  EXPECT_EQ(LatencyStats::BucketIndex(255), 0);
+  for (int bucket = 0; bucket < LatencyStats::kNumBuckets - 1; ++bucket) {
+    uint64_t upper_bound = LatencyStats::BucketUpperBound(bucket);
+    EXPECT_EQ(LatencyStats::BucketIndex(upper_bound - 1), bucket);
+    EXPECT_EQ(LatencyStats::BucketIndex(upper_bound), bucket + 1);
+  }
+  EXPECT_EQ(LatencyStats::BucketIndex(UINT64_MAX), LatencyStats::kNumBuckets - 1);
+}
+
+TEST(MetricsTest, Percentiles) {
+  LatencyHistogram histogram;
+  LatencyStats empty;
+  histogram.AddTo(empty);
+  EXPECT_EQ(empty.count, 0u);
+  EXPECT_EQ(empty.Percentile(50), 0u);
+
+  // 90 fast and 10 slow latencies
+  for (int i = 0; i < 90; ++i) {
+    histogram.Record(1000);
+  }
+  for (int i = 0; i < 10; ++i) {
+    histogram.Record(1000000);
+  }
+
+  LatencyStats stats;
+  histogram.AddTo(stats);
+  EXPECT_EQ(stats.count, 100u);
+  EXPECT_EQ(stats.total_ns, 90u * 1000 + 10u * 1000000);
+  EXPECT_EQ(stats.max_ns, 1000000u);
+
+  // a percentile is the upper bound of its bucket, so it may be up to 50% too high
+  EXPECT_GE(stats.Percentile(50), 1000u);
+  EXPECT_LE(stats.Percentile(50), 1500u);
+  EXPECT_LE(stats.Percentile(90), 1500u);
+  EXPECT_EQ(stats.Percentile(91), 1000000u);
+  EXPECT_EQ(stats.Percentile(100), 1000000u);
+
+  histogram.Reset();
+  LatencyStats reset;
+  histogram.AddTo(reset);
+  EXPECT_EQ(reset.count, 0u);
+  EXPECT_EQ(reset.max_ns, 0u);
+}
+
+TEST(MetricsTest, RecordFromManyThreads) {
+  // node index 1 has no node
+  Metrics metrics({"add_0", "", "add_2", "mul_3"}, {"Add", "", "Add", "Mul"});
+
+  constexpr int kNumThreads = 16;
+  constexpr int kNumRecords = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&metrics, t]() {
+      for (int i = 0; i < kNumRecords; ++i) {
+        metrics.RecordNode(0, 1000);
+        metrics.RecordNode(1, 1000);
+        metrics.RecordNode(2, 3000);
+        metrics.RecordNode(3, 2000);
+        metrics.RecordNode(4, 1000);  // out of range
+      }
+      metrics.RecordRun(10000, t % 2 == 0);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(metrics.NodeStats(0).count, uint64_t{kNumThreads * kNumRecords});
+  EXPECT_EQ(metrics.NodeStats(1).count, 0u);
+  EXPECT_EQ(metrics.NodeStats(2).max_ns, 3000u);
+  EXPECT_EQ(metrics.NodeStats(3).total_ns, uint64_t{kNumThreads * kNumRecords * 2000});
+  EXPECT_EQ(metrics.NodeStats(4).count, 0u);
+
+  LatencyStats add = metrics.OpTypeStats("Add");
+  EXPECT_EQ(add.count, uint64_t{2 * kNumThreads * kNumRecords});
+  EXPECT_EQ(add.max_ns, 3000u);
+  EXPECT_EQ(metrics.OpTypeStats("Conv").count, 0u);
+
+  EXPECT_EQ(metrics.RunStats().count, uint64_t{kNumThreads});
+  EXPECT_EQ(metrics.FailedRuns(), uint64_t{kNumThreads / 2});
+
+  metrics.Reset();
+  EXPECT_EQ(metrics.NodeStats(0).count, 0u);
+  EXPECT_EQ(metrics.OpTypeStats("Mul").count, 0u);
+  EXPECT_EQ(metrics.RunStats().count, 0u);
+  EXPECT_EQ(metrics.FailedRuns(), 0u);
+}
+
+TEST(MetricsTest, WriteJsonMembers) {
+  // node index 1 has no node
+  Metrics metrics({"a\"b", "", "c", "d"}, {"Add", "", "Mul", "Sub"});
+  metrics.RecordNode(0, 2000);
+  metrics.RecordNode(2, 1000);
+  metrics.RecordRun(5000, true);
+
+  std::ostringstream out;
+  metrics.WriteJsonMembers(out);
+  std::string json = out.str();
+  EXPECT_EQ(json.find("\"runs\":{\"count\":1,"), 0u) << json;
+  EXPECT_NE(json.find("\"op_types\":{\"Add\":{\"count\":1,"), std::string::npos) << json;
+  EXPECT_EQ(json.find("\"Sub\""), std::string::npos) << json;
+  EXPECT_NE(json.find("\"nodes\":[{\"index\":0,\"name\":\"a\\\"b\",\"op_type\":\"Add\",\"count\":1,"),
+            std::string::npos)
+      << json;
+  // nodes only have a count, sum and maximum, not percentiles
+  EXPECT_NE(json.find("\"max_us\":2},{\"index\":2,\"name\":\"c\",\"op_type\":\"Mul\",\"count\":1,"
+                      "\"total_us\":1,\"mean_us\":1,\"max_us\":1}]"),
+            std::string::npos)
+      << json;
+}
+
+}  // namespace test
+}  // namespace profiling
+}  // namespace onnxruntime
@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+#include "core/util/math.h"
+
+namespace onnxruntime {
+namespace test {
+
+static std::vector<MLFloat16> ToHalf(const std::vector<float>& values) {
+  std::vector<MLFloat16> half_values;
+  for (float value : values) {
+    half_values.push_back(MLFloat16(math::floatToHalf(value)));
+  }
+  return half_values;
+}
+
+static void RunMatMulHalfWeightTest(bool is_initializer) {
+  OpTester test("MatMulHalfWeight", 1, onnxruntime::kMSDomain);
+  test.AddInput<float>("A", {2, 3}, {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
+  test.AddInput<MLFloat16>("B", {3, 2}, ToHalf({1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f}), is_initializer);
+  test.AddOutput<float>("Y", {2, 2}, {22.0f, 28.0f, 49.0f, 64.0f});
+  test.Run();
+}
+
+TEST(HalfWeightOpTest, MatMulHalfWeight) {
+  RunMatMulHalfWeightTest(false);
+}
+
+TEST(HalfWeightOpTest, MatMulHalfWeightPacked) {
+  RunMatMulHalfWeightTest(true);
+}
+
+static void RunGemmHalfWeightTest(bool is_initializer) {
+  OpTester test("GemmHalfWeight", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("transA", (int64_t)0);
+  test.AddAttribute("transB", (int64_t)1);
+  test.AddAttribute("alpha", 1.0f);
+  test.AddAttribute("beta", 1.0f);
+  test.AddInput<float>("A", {2, 3}, {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
+  test.AddInput<MLFloat16>("B", {2, 3}, ToHalf({1.0f, 3.0f, 5.0f, 2.0f, 4.0f, 6.0f}), is_initializer);
+  test.AddInput<float>("C", {2}, {1.0f, 1.0f});
+  test.AddOutput<float>("Y", {2, 2}, {23.0f, 29.0f, 50.0f, 65.0f});
+  test.Run();
+}
+
+TEST(HalfWeightOpTest, GemmHalfWeight) {
+  RunGemmHalfWeightTest(false);
+}
+
+TEST(HalfWeightOpTest, GemmHalfWeightPacked) {
+  RunGemmHalfWeightTest(true);
+}
+
+TEST(HalfWeightOpTest, ConvHalfWeight) {
+  OpTester test("ConvHalfWeight", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("kernel_shape", std::vector<int64_t>{3, 3});
+  test.AddAttribute("pads", std::vector<int64_t>{1, 1, 1, 1});
+  test.AddInput<float>("X", {1, 1, 3, 3}, {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f});
+  test.AddInput<MLFloat16>("W", {1, 1, 3, 3}, ToHalf(std::vector<float>(9, 1.0f)), true);
+  test.AddInput<float>("B", {1}, {1.0f});
+  test.AddOutput<float>("Y", {1, 1, 3, 3}, {13.0f, 22.0f, 17.0f, 28.0f, 46.0f, 34.0f, 25.0f, 40.0f, 29.0f});
+  test.Run();
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -11,6 +12,7 @@
 #include "core/framework/op_kernel.h"
 #include "test/framework/model_builder_utils.h"
 #include "core/framework/allocation_planner.h"
+#include "core/framework/mem_pattern.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
 using namespace ONNX_NAMESPACE;
 
@@ -124,15 +126,19 @@ typedef std::unordered_map<const onnxruntime::NodeArg*, TensorShapeProto*> Shape
 
 class SequentialPlannerTestContext : public ISequentialPlannerContext {
  public:
-  SequentialPlannerTestContext(ShapeMap* shape_map) : shape_map_(shape_map) {}
+  SequentialPlannerTestContext(ShapeMap* shape_map, bool enable_branch_parallel_execution = false)
+      : shape_map_(shape_map), enable_branch_parallel_execution_(enable_branch_parallel_execution) {}
 
   virtual TensorShapeProto* GetShape(const onnxruntime::NodeArg& arg) const override {
     auto iter = shape_map_->find(&arg);
     return (shape_map_->end() != iter) ? iter->second : nullptr;
   }
 
+  bool EnableBranchParallelExecution() const override { return enable_branch_parallel_execution_; }
+
  private:
   ShapeMap* shape_map_;
+  bool enable_branch_parallel_execution_;
 };
 
 class PlannerTest : public ::testing::Test {
@@ -210,7 +216,8 @@ class PlannerTest : public ::testing::Test {
     }
   }
 
-  void CreatePlan(const std::vector<const NodeArg*>& outer_scope_node_args = {}) {
+  void CreatePlan(const std::vector<const NodeArg*>& outer_scope_node_args = {},
+                  bool enable_branch_parallel_execution = false) {
     EXPECT_EQ(graph_.Resolve(), Status::OK());
     state_.SetGraphViewer(std::make_unique<GraphViewer>(graph_));
 
@@ -232,7 +239,7 @@ class PlannerTest : public ::testing::Test {
     ExecutionProviders execution_providers;
     execution_providers.Add(onnxruntime::kCpuExecutionProvider, std::move(cpu_execution_provider));
 
-    SequentialPlannerTestContext test_context(&shape_map_);
+    SequentialPlannerTestContext test_context(&shape_map_, enable_branch_parallel_execution);
     auto status = SequentialPlanner::CreatePlan(
         GraphViewer(graph_), outer_scope_node_args, execution_providers, kernel_registry_manager,
         mlvalue_name_idx_map, test_context, plan_);
@@ -247,6 +254,15 @@ class PlannerTest : public ::testing::Test {
     EXPECT_EQ(plan_->allocation_plan[id].alloc_kind, kind) << "Error in allocation kind for " << name;
   }
 
+  const MemoryBlock* GetStaticBlock(const std::string& name) {
+    int id;
+    index(name, id);
+    EXPECT_NE(plan_->static_mem_patterns, nullptr);
+    if (plan_->static_mem_patterns == nullptr) return nullptr;
+    EXPECT_EQ(plan_->static_mem_patterns->patterns.size(), 1);
+    return plan_->static_mem_patterns->patterns[0].GetBlock(id);
+  }
+
   void CheckFreed(int step_number, std::initializer_list<std::string> freed_items) {
     // create set and check equality
     std::unordered_set<int> expected;
@@ -409,6 +425,164 @@ TEST_F(PlannerTest, InPlaceSizeMismatchTest) {
   CheckFreed(3, {X2});
 }
 
+// StaticMemoryPlanTest: Check that tensors with static shapes are assigned offsets in a single buffer,
+// that tensors live at the same time don't overlap and that tensors with disjoint lifetimes share memory.
+TEST_F(PlannerTest, StaticMemoryPlanTest) {
+  // tensor variables:
+  std::string X1("X1"), X2("X2"), X3("X3"), X4("X4"), X5("X5");
+
+  // graph structure:
+  AddNormalNode(X1, X2);  // X1: input; X2: temporary, live in steps 0-1
+  AddNormalNode(X2, X3);  // X3: temporary, live in steps 1-2
+  AddNormalNode(X3, X4);  // X4: temporary, live in steps 2-3
+  AddNormalNode(X4, X5);  // X5: output
+
+  // simulate shape-inference results. the sizes differ, so no buffer is reused by the allocation plan.
+  Shape shape_x1{2, 2};
+  Shape shape_x2{8, 8};
+  Shape shape_x3{16, 16};
+  Shape shape_x4{4, 4};
+  Shape shape_x5{2, 2};
+  SetShape({{X1, &shape_x1.value}, {X2, &shape_x2.value}, {X3, &shape_x3.value},
+            {X4, &shape_x4.value}, {X5, &shape_x5.value}});
+
+  CreatePlan();
+
+  CheckAllocKind(X2, AllocKind::kAllocate);
+  CheckAllocKind(X3, AllocKind::kAllocate);
+  CheckAllocKind(X4, AllocKind::kAllocate);
+
+  auto x2 = GetStaticBlock(X2);
+  auto x3 = GetStaticBlock(X3);
+  auto x4 = GetStaticBlock(X4);
+  ASSERT_TRUE(x2 != nullptr && x3 != nullptr && x4 != nullptr);
+
+  // inputs and outputs are not part of the plan
+  EXPECT_EQ(GetStaticBlock(X1), nullptr);
+  EXPECT_EQ(GetStaticBlock(X5), nullptr);
+
+  EXPECT_EQ(x2->size_, 256);
+  EXPECT_EQ(x3->size_, 1024);
+  EXPECT_EQ(x4->size_, 64);
+
+  // the largest tensor is placed first, X2 and X4 don't overlap with X3 and share the same memory.
+  EXPECT_EQ(x3->offset_, 0);
+  EXPECT_EQ(x2->offset_, 1024);
+  EXPECT_EQ(x4->offset_, 1024);
+
+  EXPECT_EQ(GetPlan().static_mem_patterns->patterns[0].PeakSize(), 1024 + 256);
+  ASSERT_EQ(GetPlan().static_mem_naive_sizes.size(), 1);
+  EXPECT_EQ(GetPlan().static_mem_naive_sizes[0], 256 + 1024 + 64);
+}
+
+// StaticMemoryPlanReuseTest: Check that a buffer reused by the allocation plan is live until its last user is done.
+TEST_F(PlannerTest, StaticMemoryPlanReuseTest) {
+  // tensor variables:
+  std::string W("W"), X("X"), B("B"), Y("Y"), Z("Z");
+
+  ONNX_NAMESPACE::TensorProto tensor;
+  tensor.add_dims(1);
+  tensor.add_float_data(1.0f);
+  tensor.set_data_type(TensorProto_DataType_FLOAT);
+  tensor.set_name("W");
+  GetGraph().AddInitializedTensor(tensor);
+
+  AddNormalNode(W, X);
+  AddNormalNode(X, B);
+  AddNormalNode(B, Y);
+  AddNormalNode(Y, Z);
+
+  Shape shape1{50, 100};
+  auto shape = &shape1.value;
+  SetShape({{X, shape}, {B, shape}, {Y, shape}, {Z, shape}});
+
+  CreatePlan();
+
+  // Y reuses the buffer of X, so X's buffer is live in steps 0-3 and B can't share it.
+  CheckAllocKind(Y, AllocKind::kReuse);
+  auto x = GetStaticBlock(X);
+  auto b = GetStaticBlock(B);
+  ASSERT_TRUE(x != nullptr && b != nullptr);
+  EXPECT_EQ(GetStaticBlock(Y), nullptr);
+
+  size_t size;
+  ASSERT_TRUE(IAllocator::CalcMemSizeForArrayWithAlignment<64>(50 * 100, sizeof(float), &size));
+  EXPECT_EQ(x->size_, size);
+  EXPECT_EQ(b->size_, size);
+  EXPECT_TRUE(x->offset_ + x->size_ <= b->offset_ || b->offset_ + b->size_ <= x->offset_);
+  EXPECT_EQ(GetPlan().static_mem_patterns->patterns[0].PeakSize(), 2 * size);
+}
+
+// StaticMemoryPlanSymbolicShapeTest: Check that nothing is planned statically if a tensor size is not known.
+TEST_F(PlannerTest, StaticMemoryPlanSymbolicShapeTest) {
+  // tensor variables:
+  std::string X1("X1"), X2("X2"), X3("X3"), X4("X4");
+
+  AddNormalNode(X1, X2);
+  AddNormalNode(X2, X3);
+  AddNormalNode(X3, X4);
+
+  Shape static_shape{4, 4};
+  Shape symbolic_shape{"M", "N"};
+  SetShape({{X1, &static_shape.value}, {X2, &static_shape.value}, {X3, &symbolic_shape.value},
+            {X4, &static_shape.value}});
+
+  CreatePlan();
+
+  EXPECT_EQ(GetPlan().static_mem_patterns, nullptr);
+  EXPECT_TRUE(GetPlan().static_mem_naive_sizes.empty());
+}
+
+// BranchParallelTest: Check the chains of a plan for branch parallel execution, and that buffers are only shared
+// or freed when no other chain can still use them.
+TEST_F(PlannerTest, BranchParallelTest) {
+  // tensor variables:
+  std::string X("X"), A1("A1"), A2("A2"), A3("A3"), A4("A4"), A5("A5"), C1("C1"), B1("B1"), B2("B2");
+
+  // graph structure: X -> A1 -> A2 -> A3 -> A4 -> A5, A1 -> C1 and X -> B1 -> B2
+  AddNormalNode(X, A1);
+  AddNormalNode(A1, A2);
+  AddNormalNode(A2, A3);
+  AddNormalNode(A3, A4);
+  AddNormalNode(A4, A5);
+  AddNormalNode(A1, C1);
+  AddNormalNode(X, B1);
+  AddNormalNode(B1, B2);
+
+  Shape shape1{50, 100};
+  auto shape = &shape1.value;
+  SetShape({{X, shape}, {A1, shape}, {A2, shape}, {A3, shape}, {A4, shape}, {A5, shape}, {C1, shape},
+            {B1, shape}, {B2, shape}});
+
+  CreatePlan({}, true);
+
+  // chains: [A1], [A2 A3 A4 A5] and [C1] after [A1], [B1 B2]
+  const auto& chains = GetPlan().chains;
+  ASSERT_EQ(chains.size(), 4);
+  std::vector<size_t> chain_sizes;
+  for (const auto& chain : chains) {
+    chain_sizes.push_back(chain.steps.size());
+    if (chain.steps.size() == 1 && chain.dependency_count == 0) {
+      EXPECT_EQ(chain.successors.size(), 2);
+    }
+  }
+  std::sort(chain_sizes.begin(), chain_sizes.end());
+  EXPECT_EQ(chain_sizes, (std::vector<size_t>{1, 1, 2, 4}));
+
+  // A1 is used by two chains, so it is never freed and A3 can't reuse it. A4 reuses A2, which is freed in its chain.
+  // B1 can't reuse a buffer freed in the chain of A2.
+  int a1_index;
+  ASSERT_TRUE(GetState().GetMLValueNameIdxMap().GetIdx(A1, a1_index).IsOK());
+  const auto& to_be_freed = GetPlan().to_be_freed;
+  EXPECT_EQ(std::find(to_be_freed.begin(), to_be_freed.end(), a1_index), to_be_freed.end());
+  CheckAllocKind(A3, AllocKind::kAllocate);
+  CheckAllocKind(A4, AllocKind::kReuse);
+  CheckAllocKind(B1, AllocKind::kAllocate);
+
+  // the concurrent chains may allocate in any order
+  EXPECT_EQ(GetPlan().static_mem_patterns, nullptr);
+}
+
 // Test operator<< to output details of an allocation & execution plan.
 TEST_F(PlannerTest, PlanOutputTest) {
   // tensor variables:
@@ -0,0 +1,174 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/batching_session.h"
+
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "core/session/inference_session.h"
+#include "test/test_environment.h"
+#include "test_utils.h"
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+// Y = X * W, with W = {{1, 2}, {3, 4}, {5, 6}}
+static const std::string MODEL_URI = "testdata/mul_1.pb";
+static const std::vector<float> W = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+
+struct RunResult {
+  Status status;
+  std::vector<MLValue> fetches;
+};
+
+class BatchingSessionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SessionOptions so;
+    so.session_logid = "BatchingSessionTest";
+    session_ = std::make_unique<InferenceSession>(so, &DefaultLoggingManager());
+    ASSERT_TRUE(session_->Load(MODEL_URI).IsOK());
+    ASSERT_TRUE(session_->Initialize().IsOK());
+  }
+
+  // submit X with the given dims, filled with W scaled by 'scale'
+  std::future<RunResult> Submit(BatchingSession& batching_session, const std::vector<int64_t>& dims, float scale) {
+    std::vector<float> values(static_cast<size_t>(TensorShape(dims).Size()));
+    for (size_t i = 0; i < values.size(); ++i) {
+      values[i] = W[i % W.size()] * scale;
+    }
+
+    MLValue x;
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims, values, &x);
+
+    auto promise = std::make_shared<std::promise<RunResult>>();
+    auto future = promise->get_future();
+    auto status = batching_session.Submit({{"X", x}}, {"Y"},
+                                          [promise](const Status& run_status, std::vector<MLValue>& fetches) {
+                                            promise->set_value(RunResult{run_status, fetches});
+                                          });
+    EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+    return future;
+  }
+
+  // check Y = X * W for an X submitted with the given scale
+  static void VerifyResult(const RunResult& result, const std::vector<int64_t>& expected_dims, float scale) {
+    ASSERT_TRUE(result.status.IsOK()) << result.status.ErrorMessage();
+    ASSERT_EQ(1u, result.fetches.size());
+    const auto& y = result.fetches[0].Get<Tensor>();
+    ASSERT_EQ(TensorShape(expected_dims), y.Shape());
+    for (int64_t i = 0; i < y.Shape().Size(); ++i) {
+      const float w = W[i % W.size()];
+      EXPECT_EQ(w * w * scale, y.Data<float>()[i]);
+    }
+  }
+
+  std::unique_ptr<InferenceSession> session_;
+};
+
+TEST_F(BatchingSessionTest, FullBatch) {
+  BatchingOptions options;
+  options.max_batch_size = 4;
+  options.batch_timeout_micros = 60 * 1000 * 1000;  // only a full batch runs
+  BatchingSession batching_session(*session_, options);
+
+  std::vector<std::future<RunResult>> futures;
+  futures.push_back(Submit(batching_session, {1, 3, 2}, 1.0f));
+  futures.push_back(Submit(batching_session, {2, 3, 2}, 2.0f));
+  futures.push_back(Submit(batching_session, {1, 3, 2}, 3.0f));
+
+  std::vector<RunResult> results;
+  for (auto& future : futures) {
+    results.push_back(future.get());
+  }
+
+  VerifyResult(results[0], {1, 3, 2}, 1.0f);
+  VerifyResult(results[1], {2, 3, 2}, 2.0f);
+  VerifyResult(results[2], {1, 3, 2}, 3.0f);
+
+  // the requests ran as one batch, so the outputs are consecutive slices of the same buffer
+  const float* y0 = results[0].fetches[0].Get<Tensor>().Data<float>();
+  EXPECT_EQ(y0 + 6, results[1].fetches[0].Get<Tensor>().Data<float>());
+  EXPECT_EQ(y0 + 18, results[2].fetches[0].Get<Tensor>().Data<float>());
+}
+
+TEST_F(BatchingSessionTest, OutputsOutliveBatch) {
+  BatchingOptions options;
+  options.max_batch_size = 2;
+  options.batch_timeout_micros = 60 * 1000 * 1000;
+  BatchingSession batching_session(*session_, options);
+
+  auto future0 = Submit(batching_session, {1, 3, 2}, 1.0f);
+  auto future1 = Submit(batching_session, {1, 3, 2}, 2.0f);
+  RunResult result1 = future1.get();
+  {
+    // releasing the other slice must not release the shared output buffer
+    RunResult result0 = future0.get();
+    VerifyResult(result0, {1, 3, 2}, 1.0f);
+  }
+  VerifyResult(result1, {1, 3, 2}, 2.0f);
+}
+
+TEST_F(BatchingSessionTest, PartialBatchAfterTimeout) {
+  BatchingOptions options;
+  options.max_batch_size = 8;
+  options.batch_timeout_micros = 1000;
+  BatchingSession batching_session(*session_, options);
+
+  auto future = Submit(batching_session, {1, 3, 2}, 5.0f);
+  VerifyResult(future.get(), {1, 3, 2}, 5.0f);
+}
+
+TEST_F(BatchingSessionTest, IncompatibleRequestsRunSeparately) {
+  BatchingOptions options;
+  options.max_batch_size = 4;
+  options.batch_timeout_micros = 10 * 1000;
+  BatchingSession batching_session(*session_, options);
+
+  // X of {3, 2} has a different rank, so it can't be batched with a {1, 3, 2} X,
+  // and X of {5, 3, 2} is larger than max_batch_size.
+  auto future0 = Submit(batching_session, {1, 3, 2}, 1.0f);
+  auto future1 = Submit(batching_session, {3, 2}, 2.0f);
+  auto future2 = Submit(batching_session, {1, 3, 2}, 3.0f);
+  auto future3 = Submit(batching_session, {5, 3, 2}, 4.0f);
+
+  VerifyResult(future0.get(), {1, 3, 2}, 1.0f);
+  VerifyResult(future1.get(), {3, 2}, 2.0f);
+  VerifyResult(future2.get(), {1, 3, 2}, 3.0f);
+  VerifyResult(future3.get(), {5, 3, 2}, 4.0f);
+}
+
+TEST_F(BatchingSessionTest, RunFailureIsReportedToAllRequests) {
+  BatchingOptions options;
+  options.max_batch_size = 2;
+  options.batch_timeout_micros = 60 * 1000 * 1000;
+  BatchingSession batching_session(*session_, options);
+
+  // each X of {1, 2} broadcasts against W, but the batched {2, 2} X doesn't
+  auto future0 = Submit(batching_session, {1, 2}, 1.0f);
+  auto future1 = Submit(batching_session, {1, 2}, 2.0f);
+
+  for (auto* future : {&future0, &future1}) {
+    RunResult result = future->get();
+    EXPECT_FALSE(result.status.IsOK());
+    EXPECT_TRUE(result.fetches.empty());
+  }
+}
+
+TEST_F(BatchingSessionTest, QueuedRequestsRunOnDestruction) {
+  std::future<RunResult> future;
+  {
+    BatchingOptions options;
+    options.max_batch_size = 8;
+    options.batch_timeout_micros = 60 * 1000 * 1000;
+    BatchingSession batching_session(*session_, options);
+    future = Submit(batching_session, {1, 3, 2}, 1.0f);
+  }
+
+  ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(0)));
+  VerifyResult(future.get(), {1, 3, 2}, 1.0f);
+}
+}  // namespace test
+}  // namespace onnxruntime
@@ -259,5 +259,75 @@ TEST(ExecutionFrameTest, MemPatternTest) {
   EXPECT_EQ(p->GetBlock(3)->offset_, 0);
   EXPECT_EQ(p->GetBlock(4)->offset_, 64);
 }
+
+TEST(ExecutionFrameTest, MemPatternDimBucketTest) {
+  auto cpu_xp = CreateCPUExecutionProvider();
+  auto xp_type = cpu_xp->Type();
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 7;
+  onnxruntime::Model model("test", true, ModelMetaData(), IOnnxRuntimeOpSchemaRegistryList(), domain_to_version);
+  onnxruntime::Graph& graph = model.MainGraph();
+  // X is [batch, 3]
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  auto* input_shape = tensor_float.mutable_tensor_type()->mutable_shape();
+  input_shape->add_dim()->set_dim_param("batch");
+  input_shape->add_dim()->set_dim_value(3);
+  onnxruntime::NodeArg input_def("X", &tensor_float), clip1_out_def("T", &tensor_float),
+      clip2_out_def("Y", &tensor_float);
+
+  graph.AddNode("node1", "Clip", "clip1", ArgMap{&input_def}, ArgMap{&clip1_out_def})
+      .SetExecutionProviderType(xp_type);
+  graph.AddNode("node2", "Clip", "clip2", ArgMap{&clip1_out_def}, ArgMap{&clip2_out_def})
+      .SetExecutionProviderType(xp_type);
+
+  auto status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  KernelRegistryManager kernel_registry_manager;
+  kernel_registry_manager.RegisterKernelRegistry(cpu_xp->GetKernelRegistry(), KernelRegistryPriority::LowPriority);
+
+  ExecutionProviders execution_providers;
+  execution_providers.Add(xp_type, std::move(cpu_xp));
+
+  SessionState state{execution_providers};
+  state.SetGraphViewer(std::make_unique<GraphViewer>(graph));
+  state.SetMemoryPatternCacheOptions(0, 8);
+
+  MLValueNameIdxMap& mlvalue_name_idx_map{state.GetMLValueNameIdxMap()};
+  int x_idx = mlvalue_name_idx_map.Add("X");
+  int t_idx = mlvalue_name_idx_map.Add("T");
+  mlvalue_name_idx_map.Add("Y");
+
+  auto cpu_allocator = execution_providers.Get(xp_type)->GetAllocator(0, OrtMemTypeDefault);
+
+  MLValue x;
+  CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{5, 3}, std::vector<float>(15, 1.0f), &x);
+
+  std::unique_ptr<SequentialExecutionPlan> p_seq_exec_plan = std::make_unique<SequentialExecutionPlan>();
+  status = SequentialPlanner::CreatePlan(GraphViewer(graph), {}, execution_providers, kernel_registry_manager,
+                                         mlvalue_name_idx_map, p_seq_exec_plan);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  state.SetExecutionPlan(std::move(p_seq_exec_plan));
+  state.CalculateNodeIndexInfo();
+
+  vector<MLValue> outputs;
+  ExecutionFrame frame(std::vector<int>{x_idx}, std::vector<MLValue>{x}, {}, outputs, state);
+  ASSERT_TRUE(frame.HasPlan());
+
+  status = frame.AllocateMLValueTensorSelfOwnBuffer(t_idx, DataTypeImpl::GetType<float>(), cpu_allocator->Info(),
+                                                    TensorShape(std::vector<int64_t>{5, 3}));
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  MemoryPatternGroup pattern;
+  status = frame.GeneratePatterns(&pattern);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  // T is traced with the symbolic batch dim rounded up to its bucket, [8, 3], so the pattern fits every batch
+  // size in the bucket. The fixed dim is not rounded up. [5, 3] would only need 64 bytes.
+  auto p = pattern.GetPatterns(cpu_allocator->Info());
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(p->GetBlock(t_idx)->size_, 128u);  // 8 * 3 * sizeof(float), 64-byte aligned
+}
 }  // namespace test
 }  // namespace onnxruntime
@@ -4,8 +4,11 @@
 #include "core/session/inference_session.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cfloat>
+#include <cstdio>
 #include <functional>
+#include <future>
 #include <iterator>
 #include <thread>
 #include <fstream>
@@ -17,6 +20,7 @@
 #include "core/framework/execution_provider.h"
 #include "core/framework/kernel_registry.h"
 #include "core/framework/op_kernel.h"
+#include "core/framework/prepared_run.h"
 #include "core/framework/session_state.h"
 #include "core/graph/graph_viewer.h"
 #include "core/framework/compute_capability.h"
@@ -325,6 +329,197 @@ TEST(InferenceSessionTests, NoTimeout) {
   RunModel(session_object, run_options);
 }
 
+TEST(InferenceSessionTests, ParallelExecutionRepeatedRuns) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.ParallelExecutionRepeatedRuns";
+  so.enable_sequential_execution = false;
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  // the per run dependency counts must be reset for every run
+  RunOptions run_options;
+  run_options.run_tag = "parallel execution";
+  for (int i = 0; i < 10; ++i) {
+    RunModel(session_object, run_options);
+  }
+}
+
+TEST(InferenceSessionTests, BranchParallelExecution) {
+  // two branches joined by the last node: M = (X + X) + (X + X) + (X * X) + (X * X)
+  onnxruntime::Model model("branch_parallel");
+  auto& graph = model.MainGraph();
+
+  ONNX_NAMESPACE::TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& a1 = graph.GetOrCreateNodeArg("A1", &float_tensor);
+  auto& a2 = graph.GetOrCreateNodeArg("A2", &float_tensor);
+  auto& b1 = graph.GetOrCreateNodeArg("B1", &float_tensor);
+  auto& b2 = graph.GetOrCreateNodeArg("B2", &float_tensor);
+  auto& m = graph.GetOrCreateNodeArg("M", &float_tensor);
+  graph.AddNode("a1", "Add", "branch a", {&x, &x}, {&a1});
+  graph.AddNode("a2", "Add", "branch a", {&a1, &a1}, {&a2});
+  graph.AddNode("b1", "Mul", "branch b", {&x, &x}, {&b1});
+  graph.AddNode("b2", "Add", "branch b", {&b1, &b1}, {&b2});
+  graph.AddNode("m", "Add", "join", {&a2, &b2}, {&m});
+  ASSERT_TRUE(graph.Resolve().IsOK());
+
+  std::string model_file_name = "branch_parallel_test_graph.onnx";
+  ASSERT_TRUE(onnxruntime::Model::Save(model, model_file_name).IsOK());
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.BranchParallelExecution";
+  so.branch_parallel_num_threads = 4;
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(model_file_name).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  std::vector<int64_t> dims_x = {3, 2};
+  std::vector<float> values_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  MLValue ml_value_x;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_x, values_x, &ml_value_x);
+  NameMLValMap feeds{{"X", ml_value_x}};
+  std::vector<std::string> output_names{"M"};
+  std::vector<float> expected_values_m = {6.0f, 16.0f, 30.0f, 48.0f, 70.0f, 96.0f};
+
+  // the chains run in a different order on every run
+  RunOptions run_options;
+  run_options.run_tag = "branch parallel execution";
+  for (int i = 0; i < 10; ++i) {
+    std::vector<MLValue> fetches;
+    ASSERT_TRUE(session_object.Run(run_options, feeds, output_names, &fetches).IsOK());
+    VerifyOutputs(fetches, dims_x, expected_values_m);
+  }
+}
+
+static NameMLValMap CreateMulFeeds() {
+  std::vector<int64_t> dims_mul_x = {3, 2};
+  std::vector<float> values_mul_x = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  MLValue ml_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), dims_mul_x, values_mul_x,
+                       &ml_value);
+  return {{"X", ml_value}};
+}
+
+TEST(InferenceSessionTests, RunAsync) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.RunAsync";
+  so.session_thread_pool_size = 2;
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  NameMLValMap feeds = CreateMulFeeds();
+  std::vector<std::promise<std::vector<MLValue>>> promises(8);
+  for (auto& promise : promises) {
+    auto status = session_object.RunAsync(feeds, {"Y"},
+                                          [&promise](const Status& run_status, std::vector<MLValue>& fetches) {
+                                            EXPECT_TRUE(run_status.IsOK()) << run_status.ErrorMessage();
+                                            promise.set_value(fetches);
+                                          });
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  }
+
+  for (auto& promise : promises) {
+    VerifyOutputs(promise.get_future().get(), {3, 2}, {1.0f, 4.0f, 9.0f, 16.0f, 25.0f, 36.0f});
+  }
+}
+
+TEST(InferenceSessionTests, RunAsyncTerminate) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.RunAsyncTerminate";
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  RunOptions run_options;
+  run_options.terminate = true;
+  std::promise<Status> done;
+  auto status = session_object.RunAsync(run_options, CreateMulFeeds(), {"Y"},
+                                        [&done](const Status& run_status, std::vector<MLValue>& fetches) {
+                                          EXPECT_TRUE(fetches.empty());
+                                          done.set_value(run_status);
+                                        });
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  EXPECT_FALSE(done.get_future().get().IsOK());
+}
+
+TEST(InferenceSessionTests, RunAsyncPendingRunsCompleteOnDestruction) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.RunAsyncPendingRunsCompleteOnDestruction";
+  so.session_thread_pool_size = 1;
+
+  std::atomic<int> num_completed{0};
+  {
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+    ASSERT_TRUE(session_object.Initialize().IsOK());
+
+    NameMLValMap feeds = CreateMulFeeds();
+    for (int i = 0; i < 16; ++i) {
+      auto status = session_object.RunAsync(feeds, {"Y"},
+                                            [&num_completed](const Status& run_status, std::vector<MLValue>&) {
+                                              EXPECT_TRUE(run_status.IsOK());
+                                              ++num_completed;
+                                            });
+      ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+    }
+  }
+
+  EXPECT_EQ(16, num_completed);
+}
+
+TEST(InferenceSessionTests, PreparedRun) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.PreparedRun";
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  RunOptions run_options;
+  std::unique_ptr<PreparedRun> prepared_run;
+  ASSERT_FALSE(session_object.PrepareRun(run_options, {"X"}, {"Z"}, &prepared_run).IsOK());
+  ASSERT_FALSE(session_object.PrepareRun(run_options, {}, {"Y"}, &prepared_run).IsOK());
+  auto status = session_object.PrepareRun(run_options, {"X"}, {"Y"}, &prepared_run);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+
+  // the frame is reused while the shapes stay the same, and rebuilt when they change
+  const std::vector<std::vector<int64_t>> dims = {{3, 2}, {3, 2}, {3, 2}, {2, 2}, {3, 2}};
+  for (size_t run = 0; run < dims.size(); ++run) {
+    std::vector<float> values_x(static_cast<size_t>(dims[run][0] * dims[run][1]));
+    std::vector<float> expected_values_y(values_x.size());
+    for (size_t i = 0; i < values_x.size(); ++i) {
+      values_x[i] = static_cast<float>(i + run);
+      expected_values_y[i] = values_x[i] * values_x[i];
+    }
+
+    std::vector<MLValue> feeds(1);
+    CreateMLValue<float>(allocator, dims[run], values_x, &feeds[0]);
+    std::vector<MLValue> fetches;
+    status = session_object.Run(*prepared_run, feeds, &fetches);
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+    VerifyOutputs(fetches, dims[run], expected_values_y);
+  }
+
+  // a wrong element type is rejected
+  std::vector<MLValue> feeds(1);
+  CreateMLValue<int64_t>(allocator, {3, 2}, {1, 2, 3, 4, 5, 6}, &feeds[0]);
+  std::vector<MLValue> fetches;
+  ASSERT_FALSE(session_object.Run(*prepared_run, feeds, &fetches).IsOK());
+}
+
 TEST(InferenceSessionTests, DisableCPUArena) {
   SessionOptions so;
 
@@ -543,6 +738,56 @@ TEST(InferenceSessionTests, CheckRunProfilerWithStartProfile) {
   }
 }
 
+TEST(InferenceSessionTests, Metrics) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.Metrics";
+  so.enable_metrics = true;
+
+  InferenceSession session_object(so);
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  std::string metrics;
+  ASSERT_FALSE(session_object.GetMetrics(metrics).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  RunOptions run_options;
+  for (int i = 0; i < 3; ++i) {
+    RunModel(session_object, run_options);
+  }
+
+  ASSERT_TRUE(session_object.GetMetrics(metrics).IsOK());
+  EXPECT_NE(metrics.find("\"runs\":{\"count\":3,"), std::string::npos) << metrics;
+  EXPECT_NE(metrics.find("\"failed\":0"), std::string::npos) << metrics;
+  EXPECT_NE(metrics.find("\"Mul\":{\"count\":3,"), std::string::npos) << metrics;
+  EXPECT_NE(metrics.find("\"name\":\"mul_1\",\"op_type\":\"Mul\",\"count\":3,"), std::string::npos) << metrics;
+  EXPECT_NE(metrics.find("\"mem_pattern_cache\":{"), std::string::npos) << metrics;
+  EXPECT_NE(metrics.find("\"arenas\":[{\"provider\":\"CPUExecutionProvider\""), std::string::npos) << metrics;
+
+  ASSERT_TRUE(session_object.ResetMetrics().IsOK());
+  ASSERT_TRUE(session_object.GetMetrics(metrics).IsOK());
+  EXPECT_NE(metrics.find("\"runs\":{\"count\":0,"), std::string::npos) << metrics;
+  EXPECT_NE(metrics.find("\"op_types\":{},\"nodes\":[]"), std::string::npos) << metrics;
+  EXPECT_NE(metrics.find("\"mem_pattern_cache\":{\"hits\":0,\"misses\":0,"), std::string::npos) << metrics;
+
+  RunModel(session_object, run_options);
+  ASSERT_TRUE(session_object.GetMetrics(metrics).IsOK());
+  EXPECT_NE(metrics.find("\"runs\":{\"count\":1,"), std::string::npos) << metrics;
+}
+
+TEST(InferenceSessionTests, MetricsDisabled) {
+  SessionOptions so;
+
+  so.session_logid = "InferenceSessionTests.MetricsDisabled";
+
+  InferenceSession session_object(so);
+  ASSERT_TRUE(session_object.Load(MODEL_URI).IsOK());
+  ASSERT_TRUE(session_object.Initialize().IsOK());
+
+  std::string metrics;
+  ASSERT_FALSE(session_object.GetMetrics(metrics).IsOK());
+  ASSERT_FALSE(session_object.ResetMetrics().IsOK());
+}
+
 TEST(InferenceSessionTests, MultipleSessionsNoTimeout) {
   SessionOptions session_options;
 
@@ -1291,5 +1536,266 @@ TEST(InferenceSessionTests, TestTruncatedSequence) {
   }
 }
 
+// Y = (X + W1) + W2 with W1 and W2 stored as external data in the same file.
+// W1 is at offset 0 so it is used in place, W2 is at an unaligned offset so it is copied.
+// The initializers refer to the data file by 'location', which defaults to data_file_name.
+static void CreateModelWithExternalData(const std::string& model_file_name, const std::string& data_file_name,
+                                        const std::string& location = {}) {
+  const std::vector<float> w1 = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+  const std::vector<float> w2 = {10.f, 20.f, 30.f, 40.f, 50.f, 60.f};
+  const size_t w2_offset = sizeof(float) * w1.size() + sizeof(float);  // skip a float to misalign w2
+
+  std::ofstream data_file(data_file_name, std::ios::binary);
+  data_file.write(reinterpret_cast<const char*>(w1.data()), sizeof(float) * w1.size());
+  const float padding = 0.f;
+  data_file.write(reinterpret_cast<const char*>(&padding), sizeof(padding));
+  data_file.write(reinterpret_cast<const char*>(w2.data()), sizeof(float) * w2.size());
+  data_file.close();
+
+  onnxruntime::Model model("ModelWithExternalData");
+  auto& graph = model.MainGraph();
+
+  auto add_external_initializer = [&](const std::string& name, size_t offset) {
+    ONNX_NAMESPACE::TensorProto tensor_proto;
+    tensor_proto.set_name(name);
+    tensor_proto.set_data_type(TensorProto_DataType_FLOAT);
+    tensor_proto.add_dims(3);
+    tensor_proto.add_dims(2);
+    tensor_proto.set_data_location(TensorProto_DataLocation_EXTERNAL);
+    auto* location_entry = tensor_proto.add_external_data();
+    location_entry->set_key("location");
+    location_entry->set_value(location.empty() ? data_file_name : location);
+    auto* offset_entry = tensor_proto.add_external_data();
+    offset_entry->set_key("offset");
+    offset_entry->set_value(std::to_string(offset));
+    graph.AddInitializedTensor(tensor_proto);
+  };
+  add_external_initializer("W1", 0);
+  add_external_initializer("W2", w2_offset);
+
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& w1_arg = graph.GetOrCreateNodeArg("W1", &float_tensor);
+  auto& w2_arg = graph.GetOrCreateNodeArg("W2", &float_tensor);
+  auto& t = graph.GetOrCreateNodeArg("T", &float_tensor);
+  auto& y = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  graph.AddNode("add_1", "Add", "add W1", {&x, &w1_arg}, {&t});
+  graph.AddNode("add_2", "Add", "add W2", {&t, &w2_arg}, {&y});
+
+  auto status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  status = onnxruntime::Model::Save(model, model_file_name);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+}
+
+TEST(InferenceSessionTests, ExternalDataInitializers) {
+  const std::string model_file_name = "external_data_test.onnx";
+  const std::string data_file_name = "external_data_test.bin";
+  CreateModelWithExternalData(model_file_name, data_file_name);
+
+  // with and without the memory pattern, which preallocates the weights of non-external initializers
+  for (bool enable_mem_pattern : {true, false}) {
+    SessionOptions so;
+    so.session_logid = "InferenceSessionTests.ExternalDataInitializers";
+    so.enable_mem_pattern = enable_mem_pattern;
+
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    // the data file is found relative to the directory of the model
+    auto status = session_object.Load("./" + model_file_name);
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+    status = session_object.Initialize();
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+    MLValue ml_value_x;
+    CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {3, 2},
+                         {1.f, 1.f, 1.f, 1.f, 1.f, 1.f}, &ml_value_x);
+    NameMLValMap feeds;
+    feeds.insert(std::make_pair("X", ml_value_x));
+
+    std::vector<MLValue> fetches;
+    RunOptions run_options;
+    status = session_object.Run(run_options, feeds, {"Y"}, &fetches);
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+    VerifyOutputs(fetches, {3, 2}, {12.f, 23.f, 34.f, 45.f, 56.f, 67.f});
+  }
+}
+
+TEST(InferenceSessionTests, ExternalDataOutOfBounds) {
+  const std::string model_file_name = "external_data_out_of_bounds_test.onnx";
+  const std::string data_file_name = "external_data_out_of_bounds_test.bin";
+  CreateModelWithExternalData(model_file_name, data_file_name);
+
+  // truncate the data file so W2 no longer fits
+  std::ofstream data_file(data_file_name, std::ios::binary | std::ios::trunc);
+  const std::vector<float> w1(6, 1.f);
+  data_file.write(reinterpret_cast<const char*>(w1.data()), sizeof(float) * w1.size());
+  data_file.close();
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.ExternalDataOutOfBounds";
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  auto status = session_object.Load(model_file_name);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  status = session_object.Initialize();
+  ASSERT_FALSE(status.IsOK());
+  EXPECT_NE(status.ErrorMessage().find("out of the bounds"), std::string::npos) << status.ErrorMessage();
+}
+
+TEST(InferenceSessionTests, ExternalDataOutsideModelDirectory) {
+  const std::string model_file_name = "external_data_outside_test.onnx";
+  const std::string data_file_name = "external_data_outside_test.bin";
+
+  // a model must not be able to read files outside of its directory
+  for (const std::string location : {"../" + data_file_name, "sub/../" + data_file_name, "/" + data_file_name}) {
+    CreateModelWithExternalData(model_file_name, data_file_name, location);
+
+    SessionOptions so;
+    so.session_logid = "InferenceSessionTests.ExternalDataOutsideModelDirectory";
+    InferenceSession session_object{so, &DefaultLoggingManager()};
+    auto status = session_object.Load(model_file_name);
+    ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+    status = session_object.Initialize();
+    ASSERT_FALSE(status.IsOK()) << location;
+    EXPECT_NE(status.ErrorMessage().find("must be a relative path"), std::string::npos) << status.ErrorMessage();
+  }
+}
+
+TEST(InferenceSessionTests, ExternalDataWithoutModelFile) {
+  const std::string model_file_name = "external_data_stream_test.onnx";
+  const std::string data_file_name = "external_data_stream_test.bin";
+  CreateModelWithExternalData(model_file_name, data_file_name);
+
+  // without a model file there is no directory to resolve the location against, not even the working directory
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.ExternalDataWithoutModelFile";
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  std::ifstream model_stream(model_file_name, std::ios::binary);
+  auto status = session_object.Load(model_stream);
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+  status = session_object.Initialize();
+  ASSERT_FALSE(status.IsOK());
+  EXPECT_NE(status.ErrorMessage().find("not loaded from a file"), std::string::npos) << status.ErrorMessage();
+}
+
+// Counts how often the graph is optimized.
+class CountingTransformer : public GraphTransformer {
+ public:
+  explicit CountingTransformer(int& count) : GraphTransformer("CountingTransformer", "Counts its calls"),
+                                             count_{count} {}
+
+ private:
+  Status ApplyImpl(Graph& /*graph*/, bool& /*modified*/, int graph_level) const override {
+    if (graph_level == 0) {
+      ++count_;
+    }
+    return Status::OK();
+  }
+
+  int& count_;
+};
+
+static void InitializeWithOptimizedModelCache(const std::string& cache_path, unsigned transformation_steps,
+                                              int& transform_count, const std::string& model_uri = MODEL_URI) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.OptimizedModelCache";
+  so.optimized_model_cache_path = cache_path;
+  so.max_num_graph_transformation_steps = transformation_steps;
+
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.RegisterGraphTransformer(std::make_unique<CountingTransformer>(transform_count)).IsOK());
+  ASSERT_TRUE(session_object.Load(model_uri).IsOK());
+  auto status = session_object.Initialize();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  // the metadata is the one of the original model
+  const std::pair<common::Status, const ModelMetadata*> metadata = session_object.GetModelMetadata();
+  ASSERT_TRUE(metadata.first.IsOK());
+  EXPECT_EQ(metadata.second->custom_metadata_map.count("onnxruntime.optimized_model_cache.key"), 0u);
+
+  RunOptions run_options;
+  run_options.run_tag = so.session_logid;
+  RunModel(session_object, run_options);
+}
+
+TEST(InferenceSessionTests, OptimizedModelCache) {
+  const std::string cache_path = "optimized_model_cache_test.onnx";
+  std::remove(cache_path.c_str());
+
+  // the first session optimizes the model and writes the cache
+  int transform_count = 0;
+  InitializeWithOptimizedModelCache(cache_path, 5, transform_count);
+  EXPECT_GT(transform_count, 0);
+  ASSERT_TRUE(std::ifstream(cache_path).good());
+
+  // the next session loads the optimized model and skips the transformers
+  transform_count = 0;
+  InitializeWithOptimizedModelCache(cache_path, 5, transform_count);
+  EXPECT_EQ(transform_count, 0);
+
+  // a different configuration invalidates the cache
+  InitializeWithOptimizedModelCache(cache_path, 3, transform_count);
+  EXPECT_GT(transform_count, 0);
+
+  // a corrupted cache is ignored and rewritten
+  std::ofstream(cache_path, std::ios::trunc) << "not a model";
+  transform_count = 0;
+  InitializeWithOptimizedModelCache(cache_path, 3, transform_count);
+  EXPECT_GT(transform_count, 0);
+  transform_count = 0;
+  InitializeWithOptimizedModelCache(cache_path, 3, transform_count);
+  EXPECT_EQ(transform_count, 0);
+
+  // the model is identified by its file, so changing the file invalidates the cache
+  const std::string model_copy = "optimized_model_cache_test_model.onnx";
+  {
+    std::ifstream source(MODEL_URI, std::ios::binary);
+    std::ofstream(model_copy, std::ios::binary | std::ios::trunc) << source.rdbuf();
+  }
+  transform_count = 0;
+  InitializeWithOptimizedModelCache(cache_path, 3, transform_count, model_copy);
+  EXPECT_GT(transform_count, 0);
+  transform_count = 0;
+  InitializeWithOptimizedModelCache(cache_path, 3, transform_count, model_copy);
+  EXPECT_EQ(transform_count, 0);
+
+  // append an unknown varint field (number 1000, value 0) that changes the size but not the model
+  std::ofstream(model_copy, std::ios::binary | std::ios::app) << '\xC0' << '\x3E' << '\x00';
+  InitializeWithOptimizedModelCache(cache_path, 3, transform_count, model_copy);
+  EXPECT_GT(transform_count, 0);
+
+  std::remove(model_copy.c_str());
+  std::remove(cache_path.c_str());
+}
+
+TEST(InferenceSessionTests, OptimizedModelCacheConcurrentSessions) {
+  const std::string cache_path = "optimized_model_cache_concurrent_test.onnx";
+  std::remove(cache_path.c_str());
+
+  // sessions initializing at the same time all save the cache, each through its own temporary file
+  constexpr int kNumSessions = 4;
+  std::vector<int> transform_counts(kNumSessions, 0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumSessions; ++i) {
+    threads.emplace_back([&cache_path, &transform_counts, i]() {
+      InitializeWithOptimizedModelCache(cache_path, 5, transform_counts[i]);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // the cache left behind is complete
+  int transform_count = 0;
+  InitializeWithOptimizedModelCache(cache_path, 5, transform_count);
+  EXPECT_EQ(transform_count, 0);
+
+  std::remove(cache_path.c_str());
+}
+
 }  // namespace test
 }  // namespace onnxruntime
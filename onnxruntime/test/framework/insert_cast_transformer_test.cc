@@ -117,5 +117,61 @@ TEST(TransformerTest, InsertCastAllCPUTest) {
     EXPECT_EQ((*it).OpType(), "Cast");
   }
 }
+
+TEST(TransformerTest, InsertCastHalfWeightTest) {
+  auto model = std::make_shared<onnxruntime::Model>("test");
+  onnxruntime::Graph& graph = model->MainGraph();
+
+  TypeProto tensor_float_16;
+  tensor_float_16.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT16);
+  onnxruntime::NodeArg i1_def("I1", &tensor_float_16),
+      w_def("W", &tensor_float_16),
+      o1_def("O1", &tensor_float_16);
+
+  TensorProto weight;
+  weight.set_name("W");
+  weight.set_data_type(TensorProto_DataType_FLOAT16);
+  weight.add_dims(2);
+  weight.add_dims(2);
+  for (int i = 0; i < 4; ++i) {
+    weight.add_int32_data(0x3C00);  // 1.0 in float16
+  }
+  graph.AddInitializedTensor(weight);
+
+  graph.AddNode("node1", "MatMul", "cpu operator1", ArgMap{&i1_def, &w_def}, ArgMap{&o1_def});
+
+  auto status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  auto cpu_execution_provider = TestCPUExecutionProvider();
+  InsertCastTransformer transformer("Test");
+  transformer.AddKernelRegistry(*cpu_execution_provider->GetKernelRegistry().get());
+
+  bool modified = true;
+  EXPECT_TRUE(transformer.Apply(graph, modified).IsOK());
+  status = graph.Resolve();
+  EXPECT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  // the MatMul becomes a MatMulHalfWeight that reads W as float16, so only I1 and O1 are cast
+  EXPECT_EQ(graph.NumberOfNodes(), 3);
+  int half_weight_nodes = 0;
+  for (auto& node : graph.Nodes()) {
+    if (node.OpType() == "MatMulHalfWeight") {
+      ++half_weight_nodes;
+      EXPECT_EQ(node.Domain(), kMSDomain);
+      EXPECT_EQ(node.GetExecutionProviderType(), kCpuExecutionProvider);
+      EXPECT_EQ(node.InputDefs()[1]->Name(), "W");
+      for (auto it = node.InputNodesBegin(); it != node.InputNodesEnd(); ++it) {
+        EXPECT_EQ((*it).OpType(), "Cast");
+      }
+      for (auto it = node.OutputNodesBegin(); it != node.OutputNodesEnd(); ++it) {
+        EXPECT_EQ((*it).OpType(), "Cast");
+      }
+    } else {
+      EXPECT_EQ(node.OpType(), "Cast");
+    }
+  }
+  EXPECT_EQ(half_weight_nodes, 1);
+}
 }  // namespace test
 }  // namespace onnxruntime
@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/mem_pattern_cache.h"
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+TEST(MemPatternCacheTest, FindInsertTest) {
+  MemoryPatternCache cache;
+
+  std::vector<TensorShape> shapes{TensorShape({2, 3}), TensorShape({4})};
+  EXPECT_EQ(cache.Find(shapes), nullptr);
+
+  auto patterns = std::make_unique<MemoryPatternGroup>();
+  const MemoryPatternGroup* raw_patterns = patterns.get();
+  cache.Insert(shapes, std::move(patterns));
+  EXPECT_EQ(cache.Find(shapes).get(), raw_patterns);
+
+  // the dims are the same but split differently between the inputs, so this must not match.
+  EXPECT_EQ(cache.Find({TensorShape({2}), TensorShape({3, 4})}), nullptr);
+  // inputs with the same xor of all dims used to collide.
+  EXPECT_EQ(cache.Find({TensorShape({3, 2}), TensorShape({4})}), nullptr);
+
+  // the first pattern inserted for a key is kept.
+  cache.Insert(shapes, std::make_unique<MemoryPatternGroup>());
+  EXPECT_EQ(cache.Find(shapes).get(), raw_patterns);
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.misses, 3u);
+  EXPECT_EQ(stats.evictions, 0u);
+  EXPECT_EQ(stats.num_entries, 1u);
+}
+
+TEST(MemPatternCacheTest, EvictLeastRecentlyUsedTest) {
+  MemoryPatternCache cache;
+  cache.Configure(2, 0);
+
+  std::vector<TensorShape> a{TensorShape({1})};
+  std::vector<TensorShape> b{TensorShape({2})};
+  std::vector<TensorShape> c{TensorShape({3})};
+
+  // the recency is tracked per insertion: b found here is as recent as a, and a found after inserting it is
+  // more recent than b
+  cache.Insert(b, std::make_unique<MemoryPatternGroup>());
+  auto b_patterns = cache.Find(b);
+  cache.Insert(a, std::make_unique<MemoryPatternGroup>());
+  ASSERT_NE(cache.Find(a), nullptr);
+
+  // b is the least recently used entry
+  cache.Insert(c, std::make_unique<MemoryPatternGroup>());
+  EXPECT_NE(cache.Find(a), nullptr);
+  EXPECT_EQ(cache.Find(b), nullptr);
+  EXPECT_NE(cache.Find(c), nullptr);
+
+  // a pattern held by a caller stays valid after eviction.
+  ASSERT_NE(b_patterns, nullptr);
+  EXPECT_TRUE(b_patterns->locations.empty());
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.num_entries, 2u);
+}
+
+TEST(MemPatternCacheTest, DimBucketTest) {
+  MemoryPatternCache cache;
+  cache.Configure(0, 8);
+
+  cache.Insert({TensorShape({1, 3})}, std::make_unique<MemoryPatternGroup>());
+  EXPECT_NE(cache.Find({TensorShape({8, 5})}), nullptr);
+  EXPECT_EQ(cache.Find({TensorShape({9, 5})}), nullptr);
+  EXPECT_EQ(cache.Find({TensorShape({8})}), nullptr);
+}
+}  // namespace test
+}  // namespace onnxruntime
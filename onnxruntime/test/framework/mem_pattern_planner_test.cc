@@ -34,5 +34,27 @@ TEST(MemPatternPlannerTest, TraceAllocaitonTest) {
   EXPECT_EQ(pattern.GetBlock(5)->offset_, 1024 + 256 + 512);
   EXPECT_EQ(pattern.GetBlock(6)->offset_, 1024);
 }
+
+TEST(MemPatternPlannerTest, StaticPlanTest) {
+  StaticMemPatternPlanner planner;
+  planner.AddTensor(0, 256, 0, 1);
+  planner.AddTensor(1, 1024, 1, 2);
+  planner.AddTensor(2, 512, 2, 3);
+  planner.AddTensor(3, 128, 3, 4);
+  planner.AddTensor(4, 1024, 4, 4);
+
+  EXPECT_EQ(planner.NaiveSize(), 256 + 1024 + 512 + 128 + 1024);
+
+  auto pattern = planner.GenerateMemPattern();
+
+  // placed by decreasing size: 1 and 4 don't overlap in time, 2 and 0 go after 1, 3 goes after 4 and 2.
+  EXPECT_EQ(pattern.GetBlock(1)->offset_, 0);
+  EXPECT_EQ(pattern.GetBlock(4)->offset_, 0);
+  EXPECT_EQ(pattern.GetBlock(2)->offset_, 1024);
+  EXPECT_EQ(pattern.GetBlock(0)->offset_, 1024);
+  EXPECT_EQ(pattern.GetBlock(3)->offset_, 1024 + 512);
+  EXPECT_EQ(pattern.PeakSize(), 1024 + 512 + 128);
+  EXPECT_EQ(pattern.GetBlock(5), nullptr);
+}
 }  // namespace test
 }  // namespace onnxruntime
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include <iostream>
 
 #include "core/framework/execution_providers.h"
@@ -65,5 +66,45 @@ TEST(SessionStateTest, AddGetKernelTest) {
   std::cout << "orig: " << orig_num_outputs << " new: " << test_kernel->Node().OutputDefs().size() << std::endl;
   EXPECT_EQ(orig_num_outputs, test_kernel->Node().OutputDefs().size());
 }
+
+TEST(SessionStateTest, NodeDependencyInfoTest) {
+  ExecutionProviders execution_providers;
+  SessionState s{execution_providers};
+
+  // X -> relu_1 -> Y1 -> add -> Z
+  //   -> relu_2 -> Y2 ->
+  onnxruntime::Model model("graph_2");
+  auto& graph = model.MainGraph();
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  tensor_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+  auto& x = graph.GetOrCreateNodeArg("X", &tensor_float);
+  auto& y1 = graph.GetOrCreateNodeArg("Y1", &tensor_float);
+  auto& y2 = graph.GetOrCreateNodeArg("Y2", &tensor_float);
+  auto& z = graph.GetOrCreateNodeArg("Z", &tensor_float);
+  auto& relu_1 = graph.AddNode("relu_1", "Relu", "relu 1.", {&x}, {&y1});
+  auto& relu_2 = graph.AddNode("relu_2", "Relu", "relu 2.", {&x}, {&y2});
+  auto& add = graph.AddNode("add", "Add", "add.", {&y1, &y2}, {&z});
+  auto status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status.ErrorMessage();
+
+  s.SetGraphViewer(std::make_unique<GraphViewer>(graph));
+  s.CalculateNodeDependencyInfo();
+  const auto& info = s.GetNodeDependencyInfo();
+
+  EXPECT_EQ(info.GetDependencyCount(relu_1.Index()), 0);
+  EXPECT_EQ(info.GetDependencyCount(relu_2.Index()), 0);
+  EXPECT_EQ(info.GetDependencyCount(add.Index()), 2);
+
+  std::vector<NodeIndex> roots = info.GetRootNodes();
+  std::sort(roots.begin(), roots.end());
+  EXPECT_EQ(roots, std::vector<NodeIndex>({relu_1.Index(), relu_2.Index()}));
+
+  auto successors = info.GetSuccessors(relu_1.Index());
+  ASSERT_EQ(successors.size(), 1);
+  EXPECT_EQ(successors[0], add.Index());
+  EXPECT_EQ(info.GetSuccessors(relu_2.Index()).size(), 1);
+  EXPECT_EQ(info.GetSuccessors(add.Index()).size(), 0);
+}
 }  // namespace test
 }  // namespace onnxruntime
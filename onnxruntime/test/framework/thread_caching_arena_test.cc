@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/thread_caching_arena.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace onnxruntime {
+namespace test {
+static std::unique_ptr<ThreadCachingArena> CreateArena() {
+  return std::make_unique<ThreadCachingArena>(std::unique_ptr<IDeviceAllocator>(new CPUAllocator()), 1 << 30);
+}
+
+TEST(ThreadCachingArenaTest, ReuseFreedBlock) {
+  auto a = CreateArena();
+
+  void* p1 = a->Alloc(100);
+  ASSERT_NE(p1, nullptr);
+  a->Free(p1);
+
+  // a block of the same bin comes back from the thread cache.
+  void* p2 = a->Alloc(150);
+  EXPECT_EQ(p1, p2);
+
+  AllocatorStats stats;
+  a->GetStats(&stats);
+  EXPECT_EQ(stats.num_cache_misses, 1);
+  EXPECT_EQ(stats.num_cache_hits, 1);
+  EXPECT_EQ(stats.num_allocs, 2);
+  EXPECT_EQ(stats.bytes_cached, 0);
+  EXPECT_EQ(stats.bytes_in_use, static_cast<int64_t>(ThreadCachingArena::kMinCachedSize));
+
+  a->Free(p2);
+  a->GetStats(&stats);
+  EXPECT_EQ(stats.bytes_cached, static_cast<int64_t>(ThreadCachingArena::kMinCachedSize));
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(a->Used(), 0u);
+}
+
+TEST(ThreadCachingArenaTest, NoOverlap) {
+  auto a = CreateArena();
+
+  std::vector<std::pair<char*, size_t>> ptrs;
+  for (size_t s = 1; s < 100000; s = s * 3 / 2 + 1) {
+    auto p = static_cast<char*>(a->Alloc(s));
+    ASSERT_NE(p, nullptr);
+    memset(p, 0xcd, s);
+    ptrs.emplace_back(p, s);
+  }
+
+  std::sort(ptrs.begin(), ptrs.end());
+  for (size_t i = 1; i < ptrs.size(); i++) {
+    ASSERT_GE(static_cast<size_t>(ptrs[i].first - ptrs[i - 1].first), ptrs[i - 1].second);
+  }
+
+  for (auto& p : ptrs) {
+    a->Free(p.first);
+  }
+  EXPECT_EQ(a->Used(), 0u);
+}
+
+TEST(ThreadCachingArenaTest, LargeAllocationsBypassCache) {
+  auto a = CreateArena();
+
+  void* p = a->Alloc(ThreadCachingArena::kMaxCachedSize);
+  ASSERT_NE(p, nullptr);
+  a->Free(p);
+
+  void* r = a->Reserve(100);
+  ASSERT_NE(r, nullptr);
+  a->Free(r);
+
+  AllocatorStats stats;
+  a->GetStats(&stats);
+  EXPECT_EQ(stats.num_cache_hits, 0);
+  EXPECT_EQ(stats.num_cache_misses, 0);
+  EXPECT_EQ(stats.bytes_cached, 0);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+}
+
+TEST(ThreadCachingArenaTest, FreeListIsBounded) {
+  auto a = CreateArena();
+
+  const size_t size = ThreadCachingArena::kMaxCachedSize / 2;
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; i++) {
+    ptrs.push_back(a->Alloc(size));
+  }
+  for (void* p : ptrs) {
+    a->Free(p);
+  }
+
+  AllocatorStats stats;
+  a->GetStats(&stats);
+  EXPECT_LE(stats.bytes_cached, static_cast<int64_t>(ThreadCachingArena::kMaxCachedBytesPerBin));
+  EXPECT_EQ(stats.bytes_in_use, 0);
+}
+
+TEST(ThreadCachingArenaTest, MultiThreaded) {
+  auto a = CreateArena();
+
+  const int num_threads = 4;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&a, t]() {
+      std::vector<void*> ptrs;
+      for (int i = 0; i < 500; i++) {
+        for (size_t s = 1; s < 20000; s = s * 2 + 7 * t) {
+          void* p = a->Alloc(s);
+          ASSERT_NE(p, nullptr);
+          memset(p, t, s);
+          ptrs.push_back(p);
+        }
+        for (void* p : ptrs) {
+          a->Free(p);
+        }
+        ptrs.clear();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // the caches of the exited threads were given back to the shared arena.
+  AllocatorStats stats;
+  a->GetStats(&stats);
+  EXPECT_GT(stats.num_cache_hits, 0);
+  EXPECT_EQ(stats.bytes_cached, 0);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(a->Used(), 0u);
+}
+}  // namespace test
+}  // namespace onnxruntime
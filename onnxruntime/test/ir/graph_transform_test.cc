@@ -2,6 +2,10 @@
 // Licensed under the MIT License.
 
 #include "core/session/inference_session.h"
+
+#include <cstdio>
+#include <fstream>
+
 #include "core/graph/graph_viewer.h"
 #include "core/graph/model.h"
 #include "core/optimizer/graph_transformer.h"
@@ -15,8 +19,10 @@
 #include "core/optimizer/conv_activation_fusion.h"
 #include "core/optimizer/matmul_add_fusion.h"
 #include "core/optimizer/gemm_activation_fusion.h"
+#include "core/optimizer/nchwc_transformer.h"
 #include "core/platform/env.h"
 #include "test/capturing_sink.h"
+#include "test/framework/test_utils.h"
 #include "test/test_environment.h"
 #include "gtest/gtest.h"
 
@@ -282,5 +288,284 @@ TEST(GraphTransformationTests, Gemm_Relu_three_input) {
 }
 
 
+static void AddNchwcTestInitializer(Graph& graph, const std::string& name, const std::vector<int64_t>& dims) {
+  TensorProto tensor_proto;
+  tensor_proto.set_name(name);
+  tensor_proto.set_data_type(TensorProto_DataType_FLOAT);
+  int64_t size = 1;
+  for (auto d : dims) {
+    tensor_proto.add_dims(d);
+    size *= d;
+  }
+  for (int64_t i = 0; i < size; i++) {
+    tensor_proto.add_float_data(static_cast<float>(i % 13 - 6) / 32.f);
+  }
+  graph.AddInitializedTensor(tensor_proto);
+}
+
+static NodeAttributes NchwcTestAttributes(const std::vector<std::pair<std::string, std::vector<int64_t>>>& attrs) {
+  NodeAttributes attributes;
+  for (const auto& attr : attrs) {
+    AttributeProto attribute;
+    attribute.set_name(attr.first);
+    attribute.set_type(AttributeProto_AttributeType_INTS);
+    for (auto v : attr.second) {
+      attribute.add_ints(v);
+    }
+    attributes[attr.first] = attribute;
+  }
+  return attributes;
+}
+
+// Builds X -> Conv -> Relu -> MaxPool -> {Conv, Conv} -> Add -> GlobalAveragePool -> Y. The first convolution has
+// three input channels, so it consumes the NCHW input directly.
+static std::string BuildNchwcTestModel() {
+  Model model("NchwcTransformer", false, ModelMetaData(), IOnnxRuntimeOpSchemaRegistryList(),
+              {{kOnnxDomain, 9}, {kMSDomain, 1}});
+  Graph& graph = model.MainGraph();
+
+  TypeProto input_type;
+  input_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  for (auto d : {1, 3, 17, 17}) {
+    input_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(d);
+  }
+
+  TypeProto float_type;
+  float_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+
+  AddNchwcTestInitializer(graph, "W1", {32, 3, 3, 3});
+  AddNchwcTestInitializer(graph, "B1", {32});
+  AddNchwcTestInitializer(graph, "W2", {32, 32, 3, 3});
+  AddNchwcTestInitializer(graph, "B2", {32});
+  AddNchwcTestInitializer(graph, "W3", {32, 32, 1, 1});
+
+  auto arg = [&](const std::string& name) { return &graph.GetOrCreateNodeArg(name, &float_type); };
+
+  NodeArg* X = &graph.GetOrCreateNodeArg("X", &input_type);
+  NodeAttributes conv_attrs = NchwcTestAttributes({{"kernel_shape", {3, 3}}, {"pads", {1, 1, 1, 1}}});
+  NodeAttributes pool_attrs = NchwcTestAttributes({{"kernel_shape", {3, 3}}, {"strides", {2, 2}}});
+
+  graph.AddNode("conv1", "Conv", "", {X, arg("W1"), arg("B1")}, {arg("C1")}, &conv_attrs);
+  graph.AddNode("relu1", "Relu", "", {arg("C1")}, {arg("R1")});
+  graph.AddNode("pool1", "MaxPool", "", {arg("R1")}, {arg("P1")}, &pool_attrs);
+  graph.AddNode("conv2", "Conv", "", {arg("P1"), arg("W2"), arg("B2")}, {arg("C2")}, &conv_attrs);
+  graph.AddNode("conv3", "Conv", "", {arg("P1"), arg("W3")}, {arg("C3")});
+  graph.AddNode("add", "Add", "", {arg("C2"), arg("C3")}, {arg("S")});
+  graph.AddNode("pool2", "GlobalAveragePool", "", {arg("S")}, {arg("Y")});
+
+  EXPECT_TRUE(graph.Resolve().IsOK());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+  return model_data;
+}
+
+static void RunNchwcTestModel(const std::string& model_data, bool use_nchwc, std::vector<float>& output) {
+  SessionOptions so;
+  so.session_logid = "GraphTransformationTests.NchwcTransformer";
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  std::stringstream model_stream(model_data);
+  ASSERT_TRUE(session_object.Load(model_stream).IsOK());
+
+  if (use_nchwc) {
+    session_object.RegisterGraphTransformer(std::make_unique<NchwcTransformer>());
+  }
+
+  auto status = session_object.Initialize();
+  ASSERT_TRUE(status.IsOK()) << status;
+
+  std::vector<float> input_values(3 * 17 * 17);
+  for (size_t i = 0; i < input_values.size(); i++) {
+    input_values[i] = static_cast<float>(i % 11) / 8.f - 0.5f;
+  }
+
+  MLValue input_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {1, 3, 17, 17}, input_values,
+                       &input_value);
+  NameMLValMap feeds{{"X", input_value}};
+
+  std::vector<MLValue> fetches;
+  status = session_object.Run(feeds, {"Y"}, &fetches);
+  ASSERT_TRUE(status.IsOK()) << status;
+
+  const Tensor& Y = fetches[0].Get<Tensor>();
+  ASSERT_EQ(Y.Shape(), TensorShape({1, 32, 1, 1}));
+  output.assign(Y.Data<float>(), Y.Data<float>() + Y.Shape().Size());
+}
+
+TEST(GraphTransformationTests, NchwcTransformer) {
+  std::string model_data = BuildNchwcTestModel();
+
+  std::shared_ptr<Model> p_model;
+  {
+    ModelProto model_proto;
+    ASSERT_TRUE(model_proto.ParseFromString(model_data));
+    ASSERT_TRUE(Model::Load(model_proto, p_model).IsOK());
+  }
+  Graph& graph = p_model->MainGraph();
+
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
+  graph_transformation_mgr.Register(std::make_unique<NchwcTransformer>());
+  ASSERT_TRUE(graph_transformation_mgr.ApplyAll(graph).IsOK());
+
+  std::map<std::string, int> op_to_count = CountOpsInGraph(graph);
+  EXPECT_EQ(op_to_count["Conv"], 0);
+  EXPECT_EQ(op_to_count["Relu"], 0);
+  EXPECT_EQ(op_to_count["MaxPool"], 0);
+  EXPECT_EQ(op_to_count["GlobalAveragePool"], 0);
+  EXPECT_EQ(op_to_count["NchwcConv"], 3);
+  EXPECT_EQ(op_to_count["NchwcMaxPool"], 1);
+  EXPECT_EQ(op_to_count["NchwcGlobalAveragePool"], 1);
+  EXPECT_EQ(op_to_count["Add"], 1);
+  EXPECT_EQ(op_to_count["ReorderInput"], 0);
+  EXPECT_EQ(op_to_count["ReorderOutput"], 1);
+
+  std::vector<float> expected_output;
+  std::vector<float> nchwc_output;
+  RunNchwcTestModel(model_data, false, expected_output);
+  RunNchwcTestModel(model_data, true, nchwc_output);
+
+  ASSERT_EQ(expected_output.size(), nchwc_output.size());
+  for (size_t i = 0; i < expected_output.size(); i++) {
+    EXPECT_NEAR(expected_output[i], nchwc_output[i], 1e-4f) << "i=" << i;
+  }
+}
+
+// Builds X -> Conv -> BatchNormalization -> Add -> Y with every initializer stored as external data, which the
+// optimizers can't read when they run.
+static void BuildExternalDataConvBNModel(const std::string& model_file_name, const std::string& data_file_name) {
+  Model model("ExternalDataConvBN", false, ModelMetaData(), IOnnxRuntimeOpSchemaRegistryList(),
+              {{kOnnxDomain, 9}, {kMSDomain, 1}});
+  Graph& graph = model.MainGraph();
+
+  std::ofstream data_file(data_file_name, std::ios::binary | std::ios::trunc);
+  size_t offset = 0;
+  auto add_external_initializer = [&](const std::string& name, const std::vector<int64_t>& dims, float bias) {
+    TensorProto tensor_proto;
+    tensor_proto.set_name(name);
+    tensor_proto.set_data_type(TensorProto_DataType_FLOAT);
+    int64_t size = 1;
+    for (auto d : dims) {
+      tensor_proto.add_dims(d);
+      size *= d;
+    }
+    std::vector<float> values(static_cast<size_t>(size));
+    for (size_t i = 0; i < values.size(); i++) {
+      values[i] = bias + static_cast<float>(i % 7) / 16.f;
+    }
+    data_file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+
+    tensor_proto.set_data_location(TensorProto_DataLocation_EXTERNAL);
+    auto* location = tensor_proto.add_external_data();
+    location->set_key("location");
+    location->set_value(data_file_name);
+    auto* offset_entry = tensor_proto.add_external_data();
+    offset_entry->set_key("offset");
+    offset_entry->set_value(std::to_string(offset));
+    offset += values.size() * sizeof(float);
+    graph.AddInitializedTensor(tensor_proto);
+  };
+  add_external_initializer("W", {32, 32, 1, 1}, -0.2f);
+  add_external_initializer("B", {32}, 0.1f);
+  add_external_initializer("scale", {32}, 0.5f);
+  add_external_initializer("bn_B", {32}, -0.3f);
+  add_external_initializer("mean", {32}, 0.05f);
+  add_external_initializer("var", {32}, 1.f);
+  add_external_initializer("A", {32, 1, 1}, 0.25f);
+  data_file.close();
+
+  TypeProto input_type;
+  input_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  for (auto d : {1, 32, 5, 5}) {
+    input_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(d);
+  }
+  TypeProto float_type;
+  float_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  auto arg = [&](const std::string& name) { return &graph.GetOrCreateNodeArg(name, &float_type); };
+
+  NodeArg* X = &graph.GetOrCreateNodeArg("X", &input_type);
+  graph.AddNode("conv", "Conv", "", {X, arg("W"), arg("B")}, {arg("C")});
+  graph.AddNode("bn", "BatchNormalization", "", {arg("C"), arg("scale"), arg("bn_B"), arg("mean"), arg("var")},
+                {arg("N")});
+  graph.AddNode("add", "Add", "", {arg("N"), arg("A")}, {arg("Y")});
+
+  auto status = graph.Resolve();
+  ASSERT_TRUE(status.IsOK()) << status;
+  status = Model::Save(model, model_file_name);
+  ASSERT_TRUE(status.IsOK()) << status;
+}
+
+static void RunExternalDataConvBNModel(const std::string& model_file_name, bool optimize, std::vector<float>& output) {
+  SessionOptions so;
+  so.session_logid = "GraphTransformationTests.ExternalDataInitializers";
+  InferenceSession session_object{so, &DefaultLoggingManager()};
+  ASSERT_TRUE(session_object.Load(model_file_name).IsOK());
+
+  if (optimize) {
+    session_object.RegisterGraphTransformer(std::make_unique<ConvBNFusion>());
+    session_object.RegisterGraphTransformer(std::make_unique<ConvMulFusion>());
+    session_object.RegisterGraphTransformer(std::make_unique<ConvAddFusion>());
+    session_object.RegisterGraphTransformer(std::make_unique<NchwcTransformer>());
+  }
+
+  auto status = session_object.Initialize();
+  ASSERT_TRUE(status.IsOK()) << status;
+
+  std::vector<float> input_values(32 * 5 * 5);
+  for (size_t i = 0; i < input_values.size(); i++) {
+    input_values[i] = static_cast<float>(i % 11) / 8.f - 0.5f;
+  }
+
+  MLValue input_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault), {1, 32, 5, 5}, input_values,
+                       &input_value);
+  NameMLValMap feeds{{"X", input_value}};
+
+  std::vector<MLValue> fetches;
+  status = session_object.Run(feeds, {"Y"}, &fetches);
+  ASSERT_TRUE(status.IsOK()) << status;
+
+  const Tensor& Y = fetches[0].Get<Tensor>();
+  ASSERT_EQ(Y.Shape(), TensorShape({1, 32, 5, 5}));
+  output.assign(Y.Data<float>(), Y.Data<float>() + Y.Shape().Size());
+}
+
+TEST(GraphTransformationTests, ExternalDataInitializers) {
+  const std::string model_file_name = "external_data_conv_bn.onnx";
+  const std::string data_file_name = "external_data_conv_bn.bin";
+  BuildExternalDataConvBNModel(model_file_name, data_file_name);
+
+  // the transformers leave the nodes with external initializers alone instead of failing
+  std::shared_ptr<Model> p_model;
+  ASSERT_TRUE(Model::Load(model_file_name, p_model).IsOK());
+  Graph& graph = p_model->MainGraph();
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
+  graph_transformation_mgr.Register(std::make_unique<ConvBNFusion>());
+  graph_transformation_mgr.Register(std::make_unique<ConvMulFusion>());
+  graph_transformation_mgr.Register(std::make_unique<ConvAddFusion>());
+  graph_transformation_mgr.Register(std::make_unique<NchwcTransformer>());
+  auto status = graph_transformation_mgr.ApplyAll(graph);
+  ASSERT_TRUE(status.IsOK()) << status;
+
+  std::map<std::string, int> op_to_count = CountOpsInGraph(graph);
+  EXPECT_EQ(op_to_count["Conv"], 1);
+  EXPECT_EQ(op_to_count["BatchNormalization"], 1);
+  EXPECT_EQ(op_to_count["Add"], 1);
+  EXPECT_EQ(op_to_count["NchwcConv"], 0);
+
+  std::vector<float> expected_output;
+  std::vector<float> optimized_output;
+  RunExternalDataConvBNModel(model_file_name, false, expected_output);
+  RunExternalDataConvBNModel(model_file_name, true, optimized_output);
+
+  ASSERT_EQ(expected_output.size(), optimized_output.size());
+  for (size_t i = 0; i < expected_output.size(); i++) {
+    EXPECT_NEAR(expected_output[i], optimized_output[i], 1e-4f) << "i=" << i;
+  }
+
+  std::remove(model_file_name.c_str());
+  std::remove(data_file_name.c_str());
+}
+
 }  // namespace test
 }  // namespace onnxruntime
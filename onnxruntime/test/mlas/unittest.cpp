@@ -17,8 +17,13 @@ Abstract:
 #include <stdio.h>
 #include <memory.h>
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <mlas.h>
+#include <memory>
+#include <vector>
+
+#include "core/platform/threadpool.h"
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -30,6 +35,13 @@ Abstract:
 #define _countof(_Array) (sizeof(_Array) / sizeof(_Array[0]))
 #endif
 
+//
+// Thread pool passed to the MLAS routines under test. Tests are executed with
+// the platform threading implementation (nullptr) and then with a thread pool.
+//
+
+MLAS_THREADPOOL* threadpool = nullptr;
+
 class MatrixGuardBuffer
 {
 public:
@@ -240,7 +252,7 @@ TrialSgemm(
         CReference[f] = -0.5f;
     }
 
-    MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    MlasSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, threadpool);
     ReferenceSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, CReference, ldc);
 
     for (size_t f = 0; f < M * N; f++) {
@@ -368,702 +380,1990 @@ ExecuteSgemmTests(
 }
 
 void
-ReferenceConv2D(
-    size_t BatchCount,
-    size_t GroupCount,
-    size_t InputChannels,
-    size_t InputHeight,
-    size_t InputWidth,
-    size_t FilterCount,
-    size_t KernelHeight,
-    size_t KernelWidth,
-    size_t PaddingLeftHeight,
-    size_t PaddingLeftWidth,
-    size_t DilationHeight,
-    size_t DilationWidth,
-    size_t StrideHeight,
-    size_t StrideWidth,
-    size_t OutputHeight,
-    size_t OutputWidth,
-    const float* Input,
-    const float* Filter,
-    const float* Bias,
-    float* Output
+TrialSgemmPackedB(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const float* B,
+    size_t ldb,
+    float beta,
+    float* C,
+    float* CReference,
+    size_t ldc
     )
 {
-    size_t InputSize = InputHeight * InputWidth;
-    size_t OutputSize = OutputHeight * OutputWidth;
-    size_t KernelSize = KernelHeight * KernelWidth;
+    for (size_t f = 0; f < M * N; f++) {
+        C[f] = -0.5f;
+        CReference[f] = -0.5f;
+    }
 
-    size_t K = InputChannels * KernelSize;
-    size_t Im2ColBufferElements = OutputSize * K;
+    std::vector<uint8_t> PackedBuffer(MlasSgemmPackBSize(N, K) + 64);
+    void* PackedB = (void*)(((uintptr_t)PackedBuffer.data() + 63) & ~uintptr_t(63));
 
-    MatrixGuardBuffer BufferIm2Col(Im2ColBufferElements, false);
+    MlasSgemmPackB(TransB, N, K, B, ldb, PackedB);
+    MlasSgemmPackedB(TransA, M, N, K, alpha, A, lda, PackedB, beta, C, ldc, threadpool);
+    ReferenceSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, CReference, ldc);
 
-    for (size_t b = 0; b < BatchCount; b++) {
+    for (size_t f = 0; f < M * N; f++) {
+        // Sensitive to comparing positive/negative zero.
+        if (C[f] != CReference[f]) {
+            printf("mismatch packed TransA=%d, TransB=%d, M=%zd, N=%zd, K=%zd, alpha=%f, beta=%f!\n", TransA, TransB, M, N, K, alpha, beta);
+            break;
+        }
+    }
+}
 
-        const float* filter = Filter;
-        const float* bias = Bias;
+unsigned short
+ReferenceFloatToHalf(
+    float Value
+    )
+{
+    //
+    // Only supports values that are exactly representable as normal half
+    // precision floats or zero, such as the small integers of the test
+    // matrices.
+    //
 
-        for (size_t g = 0; g < GroupCount; g++) {
+    uint32_t Bits;
+    memcpy(&Bits, &Value, sizeof(float));
 
-            //
-            // Transform the image using IM2COL and invoke the GEMM.
-            //
+    unsigned short Sign = (unsigned short)((Bits >> 16) & 0x8000);
 
-            float* Im2Col = BufferIm2Col.GetBuffer(Im2ColBufferElements);
-            float* Im2ColOut = Im2Col;
+    if ((Bits & 0x7FFFFFFF) == 0) {
+        return Sign;
+    }
 
-            for (size_t c = 0; c < InputChannels; c++) {
+    unsigned short Exponent = (unsigned short)(((Bits >> 23) & 0xFF) - 127 + 15);
+    unsigned short Mantissa = (unsigned short)((Bits >> 13) & 0x3FF);
 
-                for (size_t ky = 0; ky < KernelHeight; ky++) {
+    return Sign | (Exponent << 10) | Mantissa;
+}
 
-                    for (size_t kx = 0; kx < KernelWidth; kx++) {
+void
+TrialSgemmPackedBHalf(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const float* B,
+    size_t ldb,
+    float beta,
+    float* C,
+    float* CReference,
+    size_t ldc
+    )
+{
+    for (size_t f = 0; f < M * N; f++) {
+        C[f] = -0.5f;
+        CReference[f] = -0.5f;
+    }
 
-                        for (size_t oh = 0; oh < OutputHeight; oh++) {
+    const size_t BElements = (TransB == CblasNoTrans) ? K * ldb : N * ldb;
 
-                            size_t ih = oh * StrideHeight + ky * DilationHeight - PaddingLeftHeight;
+    std::vector<unsigned short> BHalf(BElements);
 
-                            for (size_t ow = 0; ow < OutputWidth; ow++) {
+    for (size_t f = 0; f < BElements; f++) {
+        BHalf[f] = ReferenceFloatToHalf(B[f]);
+    }
 
-                                size_t iw = ow * StrideWidth + kx * DilationWidth - PaddingLeftWidth;
+    std::vector<uint8_t> PackedBuffer(MlasSgemmPackBHalfSize(N, K) + 64);
+    void* PackedB = (void*)(((uintptr_t)PackedBuffer.data() + 63) & ~uintptr_t(63));
 
-                                *Im2ColOut++ = (ih < InputHeight && iw < InputWidth) ?
-                                    Input[ih * InputWidth + iw] : 0;
-                            }
-                        }
-                    }
-                }
+    MlasSgemmPackBHalf(TransB, N, K, BHalf.data(), ldb, PackedB);
+    MlasSgemmPackedBHalf(TransA, M, N, K, alpha, A, lda, PackedB, beta, C, ldc, threadpool);
+    ReferenceSgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, CReference, ldc);
 
-                Input += InputSize;
-            }
+    for (size_t f = 0; f < M * N; f++) {
+        // Sensitive to comparing positive/negative zero.
+        if (C[f] != CReference[f]) {
+            printf("mismatch packed half TransA=%d, TransB=%d, M=%zd, N=%zd, K=%zd, alpha=%f, beta=%f!\n", TransA, TransB, M, N, K, alpha, beta);
+            break;
+        }
+    }
+}
 
-            MlasSgemm(CblasNoTrans, CblasNoTrans, FilterCount, OutputSize, K, 1.0f,
-                filter, K, Im2Col, OutputSize, 0.0f, Output, OutputSize);
+void
+TrialSgemmPackedB(
+    size_t M,
+    size_t N,
+    size_t K,
+    float alpha,
+    MatrixGuardBuffer& BufferA,
+    MatrixGuardBuffer& BufferB,
+    float beta,
+    MatrixGuardBuffer& BufferC,
+    MatrixGuardBuffer& BufferCReference
+    )
+{
+    const float* A = BufferA.GetBuffer(K * M);
+    const float* B = BufferB.GetBuffer(N * K);
+    float* C = BufferC.GetBuffer(N * M);
+    float* CReference = BufferCReference.GetBuffer(N * M);
 
-            //
-            // Apply the bias.
-            //
+    TrialSgemmPackedB(CblasNoTrans, CblasNoTrans, M, N, K, alpha, A, K, B, N, beta, C, CReference, N);
+    TrialSgemmPackedB(CblasNoTrans, CblasTrans, M, N, K, alpha, A, K, B, K, beta, C, CReference, N);
+    TrialSgemmPackedB(CblasTrans, CblasNoTrans, M, N, K, alpha, A, M, B, N, beta, C, CReference, N);
+    TrialSgemmPackedB(CblasTrans, CblasTrans, M, N, K, alpha, A, M, B, K, beta, C, CReference, N);
 
-            for (size_t f = 0; f < FilterCount; f++) {
+    TrialSgemmPackedBHalf(CblasNoTrans, CblasNoTrans, M, N, K, alpha, A, K, B, N, beta, C, CReference, N);
+    TrialSgemmPackedBHalf(CblasNoTrans, CblasTrans, M, N, K, alpha, A, K, B, K, beta, C, CReference, N);
+    TrialSgemmPackedBHalf(CblasTrans, CblasNoTrans, M, N, K, alpha, A, M, B, N, beta, C, CReference, N);
+    TrialSgemmPackedBHalf(CblasTrans, CblasTrans, M, N, K, alpha, A, M, B, K, beta, C, CReference, N);
+}
 
-                float biasValue = *bias++;
+void
+ExecuteSgemmPackedBTests(
+    void
+    )
+{
+    constexpr size_t MaximumDimension = 640;
 
-                for (size_t o = 0; o < OutputSize; o++) {
-                    *Output++ += biasValue;
-                }
-            }
+    MatrixGuardBuffer BufferA(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer BufferB(MaximumDimension * MaximumDimension, true);
+    MatrixGuardBuffer BufferC(MaximumDimension * MaximumDimension, false);
+    MatrixGuardBuffer BufferCReference(MaximumDimension * MaximumDimension, false);
 
-            filter += FilterCount * InputChannels * KernelSize;
+    // Trial balloons.
+    for (size_t b = 1; b < 16; b++) {
+        TrialSgemmPackedB(b, b, b, 1.0f, BufferA, BufferB, 0.0f, BufferC, BufferCReference);
+    }
+    for (size_t b = 16; b <= 256; b <<= 1) {
+        TrialSgemmPackedB(b, b, b, 1.0f, BufferA, BufferB, 0.0f, BufferC, BufferCReference);
+    }
+
+    static const float multipliers[] = { 0.0f, -0.0f, 0.25f, -0.5f, 1.0f, -1.0f };
+
+    for (size_t a = 0; a < _countof(multipliers); a++) {
+        for (size_t b = 0; b < _countof(multipliers); b++) {
+            TrialSgemmPackedB(1, 37, 300, multipliers[a], BufferA, BufferB, multipliers[b], BufferC, BufferCReference);
+            TrialSgemmPackedB(29, 143, 67, multipliers[a], BufferA, BufferB, multipliers[b], BufferC, BufferCReference);
+        }
+    }
+
+    for (size_t M = 1; M < 160; M += 17) {
+        for (size_t N = 1; N < 320; N += 29) {
+
+            static const size_t ks[] = { 1, 3, 16, 31, 128, 255, 256, 257, 513, 600 };
+            for (size_t k = 0; k < _countof(ks); k++) {
+                TrialSgemmPackedB(M, N, ks[k], 1.0f, BufferA, BufferB, 0.0f, BufferC, BufferCReference);
+            }
         }
     }
 }
 
 void
-TrialConv2D(
+TrialSgemmBatch(
+    CBLAS_TRANSPOSE TransA,
+    CBLAS_TRANSPOSE TransB,
+    size_t M,
+    size_t N,
+    size_t K,
     size_t BatchCount,
-    size_t GroupCount,
-    size_t InputChannels,
-    size_t InputHeight,
-    size_t InputWidth,
-    size_t FilterCount,
-    size_t KernelHeight,
-    size_t KernelWidth,
-    size_t PaddingLeftHeight,
-    size_t PaddingLeftWidth,
-    size_t PaddingRightHeight,
-    size_t PaddingRightWidth,
-    size_t DilationHeight,
-    size_t DilationWidth,
-    size_t StrideHeight,
-    size_t StrideWidth
+    float alpha,
+    const float* A,
+    size_t lda,
+    const float* B,
+    size_t ldb,
+    float beta,
+    float* C,
+    float* CReference,
+    size_t ldc
     )
 {
-    int64_t OutputHeight64 =
-        ((int64_t(InputHeight) + int64_t(PaddingLeftHeight) + int64_t(PaddingRightHeight)) -
-        (int64_t(DilationHeight) * (int64_t(KernelHeight) - 1) + 1)) / int64_t(StrideHeight) + 1;
-    int64_t OutputWidth64 =
-        ((int64_t(InputWidth) + int64_t(PaddingLeftWidth) + int64_t(PaddingRightWidth)) -
-        (int64_t(DilationWidth) * (int64_t(KernelWidth) - 1) + 1)) / int64_t(StrideWidth) + 1;
+    //
+    // Each operation pairs matrix A (i / 2) with matrix B (i % 2) to mimic a
+    // broadcast between the batch dimensions of the two inputs.
+    //
+
+    std::vector<MLAS_SGEMM_DATA_PARAMS> Data(BatchCount);
+
+    for (size_t i = 0; i < BatchCount; i++) {
+        Data[i].A = A + (i / 2) * M * K;
+        Data[i].lda = lda;
+        Data[i].B = B + (i % 2) * K * N;
+        Data[i].ldb = ldb;
+        Data[i].C = C + i * M * N;
+        Data[i].ldc = ldc;
+    }
 
-    if (OutputHeight64 <= 0 || OutputWidth64 <= 0) {
-        return;
+    for (size_t f = 0; f < M * N * BatchCount; f++) {
+        C[f] = -0.5f;
+        CReference[f] = -0.5f;
     }
 
-    int64_t InputShape[] = { int64_t(InputHeight), int64_t(InputWidth) };
-    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
-    int64_t DilationShape[] = { int64_t(DilationHeight), int64_t(DilationWidth) };
-    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
-    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
-    int64_t OutputShape[] = { OutputHeight64, OutputWidth64 };
+    MlasSgemmBatch(TransA, TransB, M, N, K, alpha, Data.data(), beta, BatchCount, threadpool);
 
-    MLAS_ACTIVATION Activation;
-    Activation.ActivationKind = MlasIdentityActivation;
+    for (size_t i = 0; i < BatchCount; i++) {
+        ReferenceSgemm(TransA, TransB, M, N, K, alpha, Data[i].A, lda, Data[i].B, ldb, beta, CReference + i * M * N, ldc);
+    }
 
-    MLAS_CONV_PARAMETERS Parameters;
-    size_t WorkingBufferSize;
+    for (size_t f = 0; f < M * N * BatchCount; f++) {
+        // Sensitive to comparing positive/negative zero.
+        if (C[f] != CReference[f]) {
+            printf("mismatch batch TransA=%d, TransB=%d, M=%zd, N=%zd, K=%zd, BatchCount=%zd, alpha=%f, beta=%f!\n", TransA, TransB, M, N, K, BatchCount, alpha, beta);
+            break;
+        }
+    }
+}
 
-    MlasConvPrepare(&Parameters,
-                    2,
-                    BatchCount,
-                    GroupCount,
-                    InputChannels,
-                    InputShape,
-                    KernelShape,
-                    DilationShape,
-                    Padding,
-                    StrideShape,
-                    OutputShape,
-                    FilterCount,
-                    &Activation,
-                    &WorkingBufferSize);
+void
+TrialSgemmBatch(
+    size_t M,
+    size_t N,
+    size_t K,
+    size_t BatchCount,
+    float alpha,
+    MatrixGuardBuffer& BufferA,
+    MatrixGuardBuffer& BufferB,
+    float beta,
+    MatrixGuardBuffer& BufferC,
+    MatrixGuardBuffer& BufferCReference
+    )
+{
+    const float* A = BufferA.GetBuffer(K * M * ((BatchCount + 1) / 2));
+    const float* B = BufferB.GetBuffer(N * K * 2);
+    float* C = BufferC.GetBuffer(N * M * BatchCount);
+    float* CReference = BufferCReference.GetBuffer(N * M * BatchCount);
+
+    TrialSgemmBatch(CblasNoTrans, CblasNoTrans, M, N, K, BatchCount, alpha, A, K, B, N, beta, C, CReference, N);
+    TrialSgemmBatch(CblasNoTrans, CblasTrans, M, N, K, BatchCount, alpha, A, K, B, K, beta, C, CReference, N);
+    TrialSgemmBatch(CblasTrans, CblasNoTrans, M, N, K, BatchCount, alpha, A, M, B, N, beta, C, CReference, N);
+    TrialSgemmBatch(CblasTrans, CblasTrans, M, N, K, BatchCount, alpha, A, M, B, K, beta, C, CReference, N);
+}
 
-    size_t OutputHeight = size_t(OutputHeight64);
-    size_t OutputWidth = size_t(OutputWidth64);
+void
+ExecuteSgemmBatchTests(
+    void
+    )
+{
+    constexpr size_t MaximumDimension = 160;
+    constexpr size_t MaximumBatchCount = 33;
 
-    size_t InputSize = InputHeight * InputWidth;
-    size_t KernelSize = KernelHeight * KernelWidth;
-    size_t OutputSize = OutputHeight * OutputWidth;
+    MatrixGuardBuffer BufferA(MaximumDimension * MaximumDimension * ((MaximumBatchCount + 1) / 2), true);
+    MatrixGuardBuffer BufferB(MaximumDimension * MaximumDimension * 2, true);
+    MatrixGuardBuffer BufferC(MaximumDimension * MaximumDimension * MaximumBatchCount, false);
+    MatrixGuardBuffer BufferCReference(MaximumDimension * MaximumDimension * MaximumBatchCount, false);
 
-    size_t InputBufferElements = BatchCount * GroupCount * InputChannels * InputSize;
-    size_t FilterBufferElements = GroupCount * FilterCount * InputChannels * KernelSize;
-    size_t BiasBufferElements = GroupCount * FilterCount;
-    size_t OutputBufferElements = BatchCount * GroupCount * FilterCount * OutputSize;
-
-    MatrixGuardBuffer BufferInput(InputBufferElements, true);
-    MatrixGuardBuffer BufferFilter(FilterBufferElements, true);
-    MatrixGuardBuffer BufferBias(BiasBufferElements, true);
-    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
-    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
-
-    const float* Input = BufferInput.GetBuffer(InputBufferElements);
-    const float* Filter = BufferFilter.GetBuffer(FilterBufferElements);
-    const float* Bias = BufferBias.GetBuffer(BiasBufferElements);
-    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
-    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
-
-    MatrixGuardBuffer BufferWorking(WorkingBufferSize, false);
+    static const float multipliers[] = { 0.0f, -0.0f, 0.25f, -0.5f, 1.0f, -1.0f };
 
-    MlasConv(&Parameters,
-             Input,
-             Filter,
-             Bias,
-             BufferWorking.GetBuffer(WorkingBufferSize),
-             Output);
+    for (size_t a = 0; a < _countof(multipliers); a++) {
+        for (size_t b = 0; b < _countof(multipliers); b++) {
+            TrialSgemmBatch(1, 37, 60, 5, multipliers[a], BufferA, BufferB, multipliers[b], BufferC, BufferCReference);
+            TrialSgemmBatch(29, 143, 67, 3, multipliers[a], BufferA, BufferB, multipliers[b], BufferC, BufferCReference);
+        }
+    }
 
-    ReferenceConv2D(BatchCount,
-                    GroupCount,
-                    InputChannels,
-                    InputHeight, InputWidth,
-                    FilterCount,
-                    KernelHeight, KernelWidth,
-                    PaddingLeftHeight, PaddingLeftWidth,
-                    DilationHeight, DilationWidth,
-                    StrideHeight, StrideWidth,
-                    OutputHeight, OutputWidth,
-                    Input,
-                    Filter,
-                    Bias,
-                    OutputReference);
+    static const size_t BatchCounts[] = { 1, 2, 3, 8, 33 };
 
-    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
-        printf("mismatch: batch=%zd,group=%zd,input(%zd,%zd,%zd),filter=%zd,kernel(%zd,%zd)!!!\n",
-            BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
-            KernelHeight, KernelWidth);
+    for (size_t bc = 0; bc < _countof(BatchCounts); bc++) {
+        for (size_t M = 1; M < MaximumDimension; M += 19) {
+            for (size_t N = 1; N < MaximumDimension; N += 23) {
+                for (size_t K = 1; K < MaximumDimension; K += 37) {
+                    TrialSgemmBatch(M, N, K, BatchCounts[bc], 1.0f, BufferA, BufferB, 0.0f, BufferC, BufferCReference);
+                }
+            }
+        }
     }
 }
 
+template<typename BType>
 void
-ExecuteConvTests(
-    void
+ReferenceQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    const uint8_t* A,
+    size_t lda,
+    uint8_t offa,
+    const BType* B,
+    size_t ldb,
+    BType offb,
+    int32_t* C,
+    size_t ldc
     )
 {
-    static const unsigned cs[] = { 32, 14, 1 };
-    static const unsigned is[] = { 53, 11, 5, 1 };
-
-    for (unsigned i = 1; i < 256; i <<= 1) {
-        TrialConv2D(1, 1, 16, i, i, 32, 3, 3, 0, 0, 0, 0, 1, 1, 1, 1);
-        TrialConv2D(1, 1, 16, i, i, 32, 3, 3, 0, 0, 0, 0, 1, 1, 2, 2);
-        TrialConv2D(1, 1, 16, i, i, 32, 3, 3, 0, 0, 0, 0, 2, 2, 1, 1);
-        TrialConv2D(1, 1, 16, i, i, 32, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1);
-        TrialConv2D(1, 1, 16, i, i, 32, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1);
-        TrialConv2D(1, 1, 16, i, i, 32, i, 1, 0, 0, 0, 0, 1, 1, 1, 1);
-        TrialConv2D(1, 1, 16, i, i, 32, 1, i, 0, 0, 0, 0, 1, 1, 1, 1);
-    }
+    for (size_t m = 0; m < M; m++) {
+        for (size_t n = 0; n < N; n++) {
+
+            const uint8_t* a = A + (m * lda);
+            const BType* b = B + n;
+            int32_t* c = C + (m * ldc) + n;
+            int32_t sum = 0;
+
+            for (size_t k = 0; k < K; k++) {
+                sum += (int32_t(*a) - offa) * (int32_t(*b) - offb);
+                b += ldb;
+                a += 1;
+            }
 
-    for (unsigned i = 1; i <= 32; i++) {
-        TrialConv2D(4, 18, 1, 32, 89, 48, i, 89, 0, 0, 0, 0, 1, 1, 1, 1);
-        TrialConv2D(4, 18, 1, 32, 89, 48, i, 89, 1, 1, 1, 1, 1, 1, 1, 1);
-        TrialConv2D(4, 18, 2, 32, 89, 48, i, 89, 0, 0, 0, 0, 1, 1, 1, 1);
+            *c = sum;
+        }
     }
+}
 
-    for (unsigned b = 1; b < 64; b++) {
-        TrialConv2D(b, 1, 64, 11, 11, 128, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1);
-    }
+uint8_t
+ReferenceQgemmRequantize(
+    int32_t Value,
+    int32_t Bias,
+    const MLAS_QGEMM_REQUANTIZE* Requantize
+    )
+{
+    double Scale = double(Requantize->Multiplier) / double(1ll << 31) / double(1ll << Requantize->RightShift);
+    double ScaledValue = std::round(double(Value + Bias) * Scale) + Requantize->ZeroPoint;
 
-    for (unsigned ic = 0; ic < _countof(cs); ic++) {
-        for (unsigned ih = 0; ih < _countof(is); ih++) {
-            for (unsigned iw = 0; iw < _countof(is); iw++) {
-                fprintf(stderr, "Handling %dx%dx%d\n", cs[ic], is[ih], is[iw]);
-                for (unsigned fc = 0; fc < _countof(cs); fc++) {
-                    for (unsigned kh = 1; kh <= 5; kh++) {
-                        if (kh == 4) continue;
-                        for (unsigned kw = 1; kw <= 5; kw++) {
-                            if (kw == 4) continue;
-                            for (unsigned p0 = 0; p0 < 2; p0++) {
-                                for (unsigned p1 = 0; p1 < 2; p1++) {
-                                    for (unsigned p2 = 0; p2 < 2; p2++) {
-                                        for (unsigned p3 = 0; p3 < 2; p3++) {
-                                            for (unsigned dh = 1; dh <= 2; dh++) {
-                                                for (unsigned dw = 1; dw <= 2; dw++) {
-                                                    for (unsigned sh = 1; sh <= 2; sh++) {
-                                                        for (unsigned sw = 1; sw <= 2; sw++) {
-                                                            TrialConv2D(1, 1, cs[ic], is[ih], is[iw], cs[fc], kh, kw, p0, p1, p2, p3, dh, dw, sh, sw);
-                                                        }
-                                                    }
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
+    return uint8_t(std::min(std::max(ScaledValue, 0.0), 255.0));
 }
 
+template<typename BType>
 void
-ReferenceMaximumPool2D(
-    const int64_t* InputShape,
-    const int64_t* KernelShape,
-    const int64_t* Padding,
-    const int64_t* StrideShape,
-    const float* Input,
-    float* Output
+TrialQgemm(
+    size_t M,
+    size_t N,
+    size_t K,
+    uint8_t offa,
+    BType offb,
+    bool UseBias
     )
 {
-    int64_t ChannelCount = InputShape[0] * InputShape[1];
+    std::vector<uint8_t> A(M * K);
+    std::vector<BType> B(K * N);
+    std::vector<int32_t> Bias(M);
+    std::vector<int32_t> C(M * N);
+    std::vector<int32_t> CReference(M * N);
+    std::vector<uint8_t> C8(M * N);
+
+    //
+    // Fill the matrices using a linear congruential generator so that the
+    // full range of element values is covered.
+    //
+
+    uint32_t Seed = uint32_t(M * 131 + N * 31 + K);
+
+    auto NextValue = [&Seed]() {
+        Seed = Seed * 1103515245 + 12345;
+        return uint8_t(Seed >> 16);
+    };
+
+    for (size_t f = 0; f < A.size(); f++) {
+        A[f] = NextValue();
+    }
+    for (size_t f = 0; f < B.size(); f++) {
+        B[f] = BType(NextValue());
+    }
+    for (size_t f = 0; f < Bias.size(); f++) {
+        Bias[f] = int32_t(NextValue()) * 64 - 8192;
+    }
 
-    int64_t InputHeight = InputShape[2];
-    int64_t InputWidth = InputShape[3];
+    std::fill(C.begin(), C.end(), -1);
 
-    int64_t KernelHeight = KernelShape[0];
-    int64_t KernelWidth = KernelShape[1];
+    MlasQgemm(M, N, K, A.data(), K, offa, B.data(), N, offb, C.data(), N, threadpool);
+    ReferenceQgemm(M, N, K, A.data(), K, offa, B.data(), N, offb, CReference.data(), N);
 
-    int64_t PaddingLeftY = Padding[0];
-    int64_t PaddingLeftX = Padding[1];
-    int64_t PaddingRightY = Padding[2];
-    int64_t PaddingRightX = Padding[3];
+    for (size_t f = 0; f < M * N; f++) {
+        if (C[f] != CReference[f]) {
+            printf("mismatch M=%zd, N=%zd, K=%zd, offa=%d, offb=%d!\n", M, N, K, int(offa), int(offb));
+            break;
+        }
+    }
 
-    int64_t StrideHeight = StrideShape[0];
-    int64_t StrideWidth = StrideShape[1];
+    //
+    // Requantize using a scale that maps the typical range of the result to
+    // the 8-bit output range.
+    //
 
-    int64_t OutputHeight = (InputHeight + PaddingLeftY + PaddingRightY - KernelHeight) / StrideHeight + 1;
-    int64_t OutputWidth = (InputWidth + PaddingLeftX + PaddingRightX - KernelWidth) / StrideWidth + 1;
+    MLAS_QGEMM_REQUANTIZE Requantize;
 
-    for (int64_t c = 0; c < ChannelCount; c++) {
+    Requantize.Bias = UseBias ? Bias.data() : nullptr;
+    Requantize.Multiplier = 1518500250;
+    Requantize.RightShift = int32_t(std::min(size_t(8) + K / 64, size_t(24)));
+    Requantize.ZeroPoint = 117;
 
-        for (int64_t ph = 0; ph < OutputHeight; ph++) {
+    MlasQgemm(M, N, K, A.data(), K, offa, B.data(), N, offb, &Requantize, C8.data(), N, threadpool);
 
-            int64_t ihStart = ph * StrideHeight - PaddingLeftY;
-            int64_t ihEnd = ihStart + KernelHeight;
+    for (size_t m = 0; m < M; m++) {
+        for (size_t n = 0; n < N; n++) {
 
-            ihStart = (std::max)(ihStart, int64_t(0));
-            ihEnd = (std::min)(ihEnd, InputHeight);
+            int32_t Expected = ReferenceQgemmRequantize(CReference[m * N + n], UseBias ? Bias[m] : 0, &Requantize);
 
-            for (int64_t pw = 0; pw < OutputWidth; pw++) {
+            // The fixed point rounding may differ from the reference by one.
+            if (std::abs(int32_t(C8[m * N + n]) - Expected) > 1) {
+                printf("mismatch requantize M=%zd, N=%zd, K=%zd, offa=%d, offb=%d!\n", M, N, K, int(offa), int(offb));
+                m = M;
+                break;
+            }
+        }
+    }
+}
 
-                int64_t iwStart = pw * StrideWidth - PaddingLeftX;
-                int64_t iwEnd = iwStart + KernelWidth;
+void
+ExecuteQgemmTests(
+    void
+    )
+{
+    for (size_t b = 1; b < 16; b++) {
+        TrialQgemm<uint8_t>(b, b, b, 14, 211, false);
+        TrialQgemm<int8_t>(b, b, b, 14, -23, false);
+    }
+    for (size_t b = 16; b <= 256; b <<= 1) {
+        TrialQgemm<uint8_t>(b, b, b, 34, 1, true);
+        TrialQgemm<int8_t>(b, b, b, 34, 1, true);
+    }
+    for (size_t b = 256; b < 320; b += 32) {
+        TrialQgemm<uint8_t>(b, b, b, 85, 173, true);
+        TrialQgemm<int8_t>(b, b, b, 85, -97, true);
+    }
 
-                iwStart = (std::max)(iwStart, int64_t(0));
-                iwEnd = (std::min)(iwEnd, InputWidth);
+    static const uint8_t zero_points[] = { 0, 128, 255 };
 
-                float m = std::numeric_limits<float>::lowest();
+    for (size_t a = 0; a < _countof(zero_points); a++) {
+        for (size_t b = 0; b < _countof(zero_points); b++) {
 
-                for (int64_t ih = ihStart; ih < ihEnd; ih++) {
-                    for (int64_t iw = iwStart; iw < iwEnd; iw++) {
-                        m = (std::max)(m, Input[ih * InputWidth + iw]);
+            uint8_t offa = zero_points[a];
+            uint8_t offb = zero_points[b];
+
+            for (size_t M = 1; M < 160; M += 23) {
+                for (size_t N = 1; N < 160; N += 19) {
+
+                    static const size_t ks[] = { 1, 2, 3, 4, 5, 7, 8, 31, 64, 257 };
+                    for (size_t k = 0; k < _countof(ks); k++) {
+                        size_t K = ks[k];
+
+                        TrialQgemm<uint8_t>(M, N, K, offa, offb, (M & 1) != 0);
+                        TrialQgemm<int8_t>(M, N, K, offa, int8_t(offb), (N & 1) != 0);
                     }
                 }
-
-                Output[ph * OutputWidth + pw] = m;
             }
+            printf("offa %d offb %d\n", int(offa), int(offb));
         }
-
-        Input += InputHeight * InputWidth;
-        Output += OutputHeight * OutputWidth;
     }
 }
 
 void
-ReferenceMaximumPool3D(
-    const int64_t* InputShape,
-    const int64_t* KernelShape,
-    const int64_t* Padding,
-    const int64_t* StrideShape,
+ReferenceConv2D(
+    size_t BatchCount,
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t FilterCount,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t DilationHeight,
+    size_t DilationWidth,
+    size_t StrideHeight,
+    size_t StrideWidth,
+    size_t OutputHeight,
+    size_t OutputWidth,
     const float* Input,
+    const float* Filter,
+    const float* Bias,
     float* Output
     )
 {
-    int64_t ChannelCount = InputShape[0] * InputShape[1];
+    size_t InputSize = InputHeight * InputWidth;
+    size_t OutputSize = OutputHeight * OutputWidth;
+    size_t KernelSize = KernelHeight * KernelWidth;
 
-    int64_t InputDepth = InputShape[2];
-    int64_t InputHeight = InputShape[3];
-    int64_t InputWidth = InputShape[4];
+    size_t K = InputChannels * KernelSize;
+    size_t Im2ColBufferElements = OutputSize * K;
 
-    int64_t KernelDepth = KernelShape[0];
-    int64_t KernelHeight = KernelShape[1];
-    int64_t KernelWidth = KernelShape[2];
+    MatrixGuardBuffer BufferIm2Col(Im2ColBufferElements, false);
 
-    int64_t PaddingLeftZ = Padding[0];
-    int64_t PaddingLeftY = Padding[1];
-    int64_t PaddingLeftX = Padding[2];
-    int64_t PaddingRightZ = Padding[3];
-    int64_t PaddingRightY = Padding[4];
-    int64_t PaddingRightX = Padding[5];
+    for (size_t b = 0; b < BatchCount; b++) {
 
-    int64_t StrideDepth = StrideShape[0];
-    int64_t StrideHeight = StrideShape[1];
-    int64_t StrideWidth = StrideShape[2];
+        const float* filter = Filter;
+        const float* bias = Bias;
 
-    int64_t OutputDepth = (InputDepth + PaddingLeftZ + PaddingRightZ - KernelDepth) / StrideDepth + 1;
-    int64_t OutputHeight = (InputHeight + PaddingLeftY + PaddingRightY - KernelHeight) / StrideHeight + 1;
-    int64_t OutputWidth = (InputWidth + PaddingLeftX + PaddingRightX - KernelWidth) / StrideWidth + 1;
+        for (size_t g = 0; g < GroupCount; g++) {
 
-    for (int64_t c = 0; c < ChannelCount; c++) {
+            //
+            // Transform the image using IM2COL and invoke the GEMM.
+            //
 
-        for (int64_t pd = 0; pd < OutputDepth; pd++) {
+            float* Im2Col = BufferIm2Col.GetBuffer(Im2ColBufferElements);
+            float* Im2ColOut = Im2Col;
 
-            int64_t idStart = pd * StrideDepth - PaddingLeftZ;
-            int64_t idEnd = idStart + KernelDepth;
+            for (size_t c = 0; c < InputChannels; c++) {
 
-            idStart = (std::max)(idStart, int64_t(0));
-            idEnd = (std::min)(idEnd, InputDepth);
+                for (size_t ky = 0; ky < KernelHeight; ky++) {
 
-            for (int64_t ph = 0; ph < OutputHeight; ph++) {
+                    for (size_t kx = 0; kx < KernelWidth; kx++) {
 
-                int64_t ihStart = ph * StrideHeight - PaddingLeftY;
-                int64_t ihEnd = ihStart + KernelHeight;
+                        for (size_t oh = 0; oh < OutputHeight; oh++) {
 
-                ihStart = (std::max)(ihStart, int64_t(0));
-                ihEnd = (std::min)(ihEnd, InputHeight);
+                            size_t ih = oh * StrideHeight + ky * DilationHeight - PaddingLeftHeight;
+
+                            for (size_t ow = 0; ow < OutputWidth; ow++) {
+
+                                size_t iw = ow * StrideWidth + kx * DilationWidth - PaddingLeftWidth;
+
+                                *Im2ColOut++ = (ih < InputHeight && iw < InputWidth) ?
+                                    Input[ih * InputWidth + iw] : 0;
+                            }
+                        }
+                    }
+                }
+
+                Input += InputSize;
+            }
+
+            MlasSgemm(CblasNoTrans, CblasNoTrans, FilterCount, OutputSize, K, 1.0f,
+                filter, K, Im2Col, OutputSize, 0.0f, Output, OutputSize, threadpool);
+
+            //
+            // Apply the bias.
+            //
+
+            for (size_t f = 0; f < FilterCount; f++) {
+
+                float biasValue = *bias++;
+
+                for (size_t o = 0; o < OutputSize; o++) {
+                    *Output++ += biasValue;
+                }
+            }
+
+            filter += FilterCount * InputChannels * KernelSize;
+        }
+    }
+}
+
+void
+TrialConv2D(
+    size_t BatchCount,
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t FilterCount,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t DilationHeight,
+    size_t DilationWidth,
+    size_t StrideHeight,
+    size_t StrideWidth,
+    bool UseTransformedFilter = false
+    )
+{
+    int64_t OutputHeight64 =
+        ((int64_t(InputHeight) + int64_t(PaddingLeftHeight) + int64_t(PaddingRightHeight)) -
+        (int64_t(DilationHeight) * (int64_t(KernelHeight) - 1) + 1)) / int64_t(StrideHeight) + 1;
+    int64_t OutputWidth64 =
+        ((int64_t(InputWidth) + int64_t(PaddingLeftWidth) + int64_t(PaddingRightWidth)) -
+        (int64_t(DilationWidth) * (int64_t(KernelWidth) - 1) + 1)) / int64_t(StrideWidth) + 1;
+
+    if (OutputHeight64 <= 0 || OutputWidth64 <= 0) {
+        return;
+    }
+
+    int64_t InputShape[] = { int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t DilationShape[] = { int64_t(DilationHeight), int64_t(DilationWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { OutputHeight64, OutputWidth64 };
+
+    size_t OutputHeight = size_t(OutputHeight64);
+    size_t OutputWidth = size_t(OutputWidth64);
+
+    size_t InputSize = InputHeight * InputWidth;
+    size_t KernelSize = KernelHeight * KernelWidth;
+    size_t OutputSize = OutputHeight * OutputWidth;
+
+    size_t InputBufferElements = BatchCount * GroupCount * InputChannels * InputSize;
+    size_t FilterBufferElements = GroupCount * FilterCount * InputChannels * KernelSize;
+    size_t BiasBufferElements = GroupCount * FilterCount;
+    size_t OutputBufferElements = BatchCount * GroupCount * FilterCount * OutputSize;
+
+    MatrixGuardBuffer BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer BufferFilter(FilterBufferElements, true);
+    MatrixGuardBuffer BufferBias(BiasBufferElements, true);
+    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    const float* Filter = BufferFilter.GetBuffer(FilterBufferElements);
+    const float* Bias = BufferBias.GetBuffer(BiasBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+
+    //
+    // Optionally transform the filter ahead of time as done by a kernel that
+    // caches the transformed filter for a constant filter tensor.
+    //
+
+    size_t TransformedFilterElements = 0;
+
+    if (UseTransformedFilter) {
+        TransformedFilterElements = MlasConvWinogradGetFilterSize(GroupCount, InputChannels, FilterCount);
+    }
+
+    MatrixGuardBuffer BufferTransformedFilter(TransformedFilterElements, false);
+
+    float* TransformedFilter = nullptr;
+
+    if (UseTransformedFilter) {
+        TransformedFilter = BufferTransformedFilter.GetBuffer(TransformedFilterElements);
+        MlasConvWinogradTransformFilter(GroupCount, InputChannels, FilterCount, Filter, TransformedFilter);
+    }
+
+    MLAS_ACTIVATION Activation;
+    Activation.ActivationKind = MlasIdentityActivation;
+
+    MLAS_CONV_PARAMETERS Parameters;
+    size_t WorkingBufferSize;
+
+    MlasConvPrepare(&Parameters,
+                    2,
+                    BatchCount,
+                    GroupCount,
+                    InputChannels,
+                    InputShape,
+                    KernelShape,
+                    DilationShape,
+                    Padding,
+                    StrideShape,
+                    OutputShape,
+                    FilterCount,
+                    TransformedFilter,
+                    &Activation,
+                    &WorkingBufferSize,
+                    threadpool);
+
+    //
+    // A kernel only transforms a filter ahead of time when the channel counts
+    // allow the Winograd algorithm, so it must not be selected otherwise.
+    //
+
+    if (Parameters.Algorithm == MlasConvAlgorithmWinograd &&
+        !MlasConvWinogradIsSupported(InputChannels, FilterCount)) {
+        printf("mismatch Winograd support: G=%zd C=%zd F=%zd\n", GroupCount, InputChannels, FilterCount);
+    }
+
+    MatrixGuardBuffer BufferWorking(WorkingBufferSize, false);
+
+    MlasConv(&Parameters,
+             Input,
+             Filter,
+             Bias,
+             BufferWorking.GetBuffer(WorkingBufferSize),
+             Output,
+             threadpool);
+
+    ReferenceConv2D(BatchCount,
+                    GroupCount,
+                    InputChannels,
+                    InputHeight, InputWidth,
+                    FilterCount,
+                    KernelHeight, KernelWidth,
+                    PaddingLeftHeight, PaddingLeftWidth,
+                    DilationHeight, DilationWidth,
+                    StrideHeight, StrideWidth,
+                    OutputHeight, OutputWidth,
+                    Input,
+                    Filter,
+                    Bias,
+                    OutputReference);
+
+    if (Parameters.Algorithm == MlasConvAlgorithmWinograd) {
+
+        //
+        // The Winograd algorithm trades precision for fewer multiplies, so
+        // bound the error relative to the magnitude of the reference output.
+        //
+
+        float MaximumReference = 0.0f;
+        float MaximumError = 0.0f;
+
+        for (size_t i = 0; i < OutputBufferElements; i++) {
+            MaximumReference = std::max(MaximumReference, std::abs(OutputReference[i]));
+            MaximumError = std::max(MaximumError, std::abs(Output[i] - OutputReference[i]));
+        }
+
+        if (MaximumError > MaximumReference * 1e-4f) {
+            printf("mismatch winograd: batch=%zd,group=%zd,input(%zd,%zd,%zd),filter=%zd,error=%g!!!\n",
+                BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
+                MaximumError / MaximumReference);
+        }
+
+    } else if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: batch=%zd,group=%zd,input(%zd,%zd,%zd),filter=%zd,kernel(%zd,%zd)!!!\n",
+            BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
+            KernelHeight, KernelWidth);
+    }
+}
+
+void
+ExecuteConvTests(
+    void
+    )
+{
+    static const unsigned cs[] = { 32, 14, 1 };
+    static const unsigned is[] = { 53, 11, 5, 1 };
+
+    for (unsigned i = 1; i < 256; i <<= 1) {
+        TrialConv2D(1, 1, 16, i, i, 32, 3, 3, 0, 0, 0, 0, 1, 1, 1, 1);
+        TrialConv2D(1, 1, 16, i, i, 32, 3, 3, 0, 0, 0, 0, 1, 1, 2, 2);
+        TrialConv2D(1, 1, 16, i, i, 32, 3, 3, 0, 0, 0, 0, 2, 2, 1, 1);
+        TrialConv2D(1, 1, 16, i, i, 32, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1);
+        TrialConv2D(1, 1, 16, i, i, 32, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1);
+        TrialConv2D(1, 1, 16, i, i, 32, i, 1, 0, 0, 0, 0, 1, 1, 1, 1);
+        TrialConv2D(1, 1, 16, i, i, 32, 1, i, 0, 0, 0, 0, 1, 1, 1, 1);
+    }
+
+    for (unsigned i = 1; i <= 32; i++) {
+        TrialConv2D(4, 18, 1, 32, 89, 48, i, 89, 0, 0, 0, 0, 1, 1, 1, 1);
+        TrialConv2D(4, 18, 1, 32, 89, 48, i, 89, 1, 1, 1, 1, 1, 1, 1, 1);
+        TrialConv2D(4, 18, 2, 32, 89, 48, i, 89, 0, 0, 0, 0, 1, 1, 1, 1);
+    }
+
+    for (unsigned b = 1; b < 64; b++) {
+        TrialConv2D(b, 1, 64, 11, 11, 128, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1);
+    }
+
+    //
+    // Exercise the Winograd algorithm with partial tiles, asymmetric padding,
+    // multiple groups and a filter transformed ahead of time.
+    //
+
+    for (unsigned i = 4; i <= 64; i += 5) {
+        TrialConv2D(1, 1, 32, i, i, 32, 3, 3, 0, 0, 0, 0, 1, 1, 1, 1);
+        TrialConv2D(1, 1, 64, i, i + 3, 96, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1);
+        TrialConv2D(2, 3, 40, i + 1, i, 32, 3, 3, 1, 0, 2, 1, 1, 1, 1, 1);
+        TrialConv2D(3, 2, 32, i, i, 48, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, true);
+    }
+
+    TrialConv2D(1, 1, 512, 14, 14, 512, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, true);
+
+    //
+    // Exercise the depthwise algorithm.
+    //
+
+    for (unsigned i = 1; i <= 33; i += 4) {
+        for (unsigned k = 3; k <= 5; k += 2) {
+            for (unsigned s = 1; s <= 2; s++) {
+                TrialConv2D(1, 32, 1, i, i, 1, k, k, k / 2, k / 2, k / 2, k / 2, 1, 1, s, s);
+                TrialConv2D(3, 19, 1, i + 2, i, 1, k, k, 0, 1, 1, 0, 1, 1, s, s);
+                TrialConv2D(2, 8, 1, i, i + 7, 1, k, k, 0, 0, 0, 0, 1, 1, s, s);
+            }
+        }
+    }
+
+    for (unsigned ic = 0; ic < _countof(cs); ic++) {
+        for (unsigned ih = 0; ih < _countof(is); ih++) {
+            for (unsigned iw = 0; iw < _countof(is); iw++) {
+                fprintf(stderr, "Handling %dx%dx%d\n", cs[ic], is[ih], is[iw]);
+                for (unsigned fc = 0; fc < _countof(cs); fc++) {
+                    for (unsigned kh = 1; kh <= 5; kh++) {
+                        if (kh == 4) continue;
+                        for (unsigned kw = 1; kw <= 5; kw++) {
+                            if (kw == 4) continue;
+                            for (unsigned p0 = 0; p0 < 2; p0++) {
+                                for (unsigned p1 = 0; p1 < 2; p1++) {
+                                    for (unsigned p2 = 0; p2 < 2; p2++) {
+                                        for (unsigned p3 = 0; p3 < 2; p3++) {
+                                            for (unsigned dh = 1; dh <= 2; dh++) {
+                                                for (unsigned dw = 1; dw <= 2; dw++) {
+                                                    for (unsigned sh = 1; sh <= 2; sh++) {
+                                                        for (unsigned sw = 1; sw <= 2; sw++) {
+                                                            TrialConv2D(1, 1, cs[ic], is[ih], is[iw], cs[fc], kh, kw, p0, p1, p2, p3, dh, dw, sh, sw);
+                                                        }
+                                                    }
+                                                }
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+ReferenceConvTranspose2D(
+    size_t BatchCount,
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t FilterCount,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t DilationHeight,
+    size_t DilationWidth,
+    size_t StrideHeight,
+    size_t StrideWidth,
+    size_t OutputHeight,
+    size_t OutputWidth,
+    const float* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output
+    )
+{
+    size_t InputSize = InputHeight * InputWidth;
+    size_t OutputSize = OutputHeight * OutputWidth;
+    size_t KernelSize = KernelHeight * KernelWidth;
+
+    for (size_t b = 0; b < BatchCount; b++) {
+
+        for (size_t g = 0; g < GroupCount; g++) {
+
+            for (size_t f = 0; f < FilterCount; f++) {
+
+                float biasValue = Bias[g * FilterCount + f];
+
+                for (size_t o = 0; o < OutputSize; o++) {
+                    Output[o] = biasValue;
+                }
+
+                //
+                // Scatter each input element across the output using the
+                // filter in IOHW format.
+                //
+
+                for (size_t c = 0; c < InputChannels; c++) {
+
+                    const float* input = Input + c * InputSize;
+                    const float* filter = Filter + ((g * InputChannels + c) * FilterCount + f) * KernelSize;
+
+                    for (size_t ih = 0; ih < InputHeight; ih++) {
+
+                        for (size_t iw = 0; iw < InputWidth; iw++) {
+
+                            for (size_t ky = 0; ky < KernelHeight; ky++) {
+
+                                size_t oh = ih * StrideHeight + ky * DilationHeight - PaddingLeftHeight;
+
+                                for (size_t kx = 0; kx < KernelWidth; kx++) {
+
+                                    size_t ow = iw * StrideWidth + kx * DilationWidth - PaddingLeftWidth;
+
+                                    if (oh < OutputHeight && ow < OutputWidth) {
+                                        Output[oh * OutputWidth + ow] +=
+                                            input[ih * InputWidth + iw] * filter[ky * KernelWidth + kx];
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+
+                Output += OutputSize;
+            }
+
+            Input += InputChannels * InputSize;
+        }
+    }
+}
+
+void
+TrialConvTranspose2D(
+    size_t BatchCount,
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t FilterCount,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t DilationHeight,
+    size_t DilationWidth,
+    size_t StrideHeight,
+    size_t StrideWidth
+    )
+{
+    int64_t OutputHeight64 =
+        int64_t(StrideHeight) * (int64_t(InputHeight) - 1) + int64_t(DilationHeight) * (int64_t(KernelHeight) - 1) + 1 -
+        (int64_t(PaddingLeftHeight) + int64_t(PaddingRightHeight));
+    int64_t OutputWidth64 =
+        int64_t(StrideWidth) * (int64_t(InputWidth) - 1) + int64_t(DilationWidth) * (int64_t(KernelWidth) - 1) + 1 -
+        (int64_t(PaddingLeftWidth) + int64_t(PaddingRightWidth));
+
+    if (OutputHeight64 <= 0 || OutputWidth64 <= 0) {
+        return;
+    }
+
+    int64_t InputShape[] = { int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t DilationShape[] = { int64_t(DilationHeight), int64_t(DilationWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { OutputHeight64, OutputWidth64 };
+
+    size_t OutputHeight = size_t(OutputHeight64);
+    size_t OutputWidth = size_t(OutputWidth64);
+
+    size_t InputSize = InputHeight * InputWidth;
+    size_t KernelSize = KernelHeight * KernelWidth;
+    size_t OutputSize = OutputHeight * OutputWidth;
+
+    size_t InputBufferElements = BatchCount * GroupCount * InputChannels * InputSize;
+    size_t FilterBufferElements = GroupCount * InputChannels * FilterCount * KernelSize;
+    size_t BiasBufferElements = GroupCount * FilterCount;
+    size_t OutputBufferElements = BatchCount * GroupCount * FilterCount * OutputSize;
+
+    MatrixGuardBuffer BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer BufferFilter(FilterBufferElements, true);
+    MatrixGuardBuffer BufferBias(BiasBufferElements, true);
+    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    const float* Filter = BufferFilter.GetBuffer(FilterBufferElements);
+    const float* Bias = BufferBias.GetBuffer(BiasBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+
+    MLAS_ACTIVATION Activation;
+    Activation.ActivationKind = MlasIdentityActivation;
+
+    MLAS_CONV_PARAMETERS Parameters;
+    size_t WorkingBufferSize;
+
+    MlasConvTransposePrepare(&Parameters,
+                             2,
+                             BatchCount,
+                             GroupCount,
+                             InputChannels,
+                             InputShape,
+                             KernelShape,
+                             DilationShape,
+                             Padding,
+                             StrideShape,
+                             OutputShape,
+                             FilterCount,
+                             &Activation,
+                             &WorkingBufferSize,
+                             threadpool);
+
+    MatrixGuardBuffer BufferWorking(WorkingBufferSize, false);
+
+    MlasConvTranspose(&Parameters,
+                      Input,
+                      Filter,
+                      Bias,
+                      BufferWorking.GetBuffer(WorkingBufferSize),
+                      Output,
+                      threadpool);
+
+    ReferenceConvTranspose2D(BatchCount,
+                             GroupCount,
+                             InputChannels,
+                             InputHeight, InputWidth,
+                             FilterCount,
+                             KernelHeight, KernelWidth,
+                             PaddingLeftHeight, PaddingLeftWidth,
+                             DilationHeight, DilationWidth,
+                             StrideHeight, StrideWidth,
+                             OutputHeight, OutputWidth,
+                             Input,
+                             Filter,
+                             Bias,
+                             OutputReference);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch convtranspose: batch=%zd,group=%zd,input(%zd,%zd,%zd),filter=%zd,kernel(%zd,%zd)!!!\n",
+            BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
+            KernelHeight, KernelWidth);
+    }
+}
+
+void
+ExecuteConvTransposeTests(
+    void
+    )
+{
+    for (unsigned i = 1; i <= 40; i += 3) {
+        for (unsigned k = 1; k <= 5; k++) {
+            for (unsigned s = 1; s <= 3; s++) {
+                TrialConvTranspose2D(1, 1, 16, i, i, 8, k, k, 0, 0, 0, 0, 1, 1, s, s);
+                TrialConvTranspose2D(2, 3, 5, i, i + 2, 4, k, k + 1, k / 2, 0, 0, k / 2, 1, 1, s, s);
+                TrialConvTranspose2D(3, 1, 7, i + 1, i, 3, k, k, 1, 1, 1, 1, 2, 2, s, s + 1);
+            }
+        }
+    }
+
+    for (unsigned b = 1; b < 8; b++) {
+        TrialConvTranspose2D(b, 2, 64, 13, 17, 32, 4, 4, 1, 1, 1, 1, 1, 1, 2, 2);
+    }
+
+    TrialConvTranspose2D(1, 1, 256, 28, 28, 128, 2, 2, 0, 0, 0, 0, 1, 1, 2, 2);
+}
+
+void
+ReferenceMaximumPool2D(
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const float* Input,
+    float* Output
+    )
+{
+    int64_t ChannelCount = InputShape[0] * InputShape[1];
+
+    int64_t InputHeight = InputShape[2];
+    int64_t InputWidth = InputShape[3];
+
+    int64_t KernelHeight = KernelShape[0];
+    int64_t KernelWidth = KernelShape[1];
+
+    int64_t PaddingLeftY = Padding[0];
+    int64_t PaddingLeftX = Padding[1];
+    int64_t PaddingRightY = Padding[2];
+    int64_t PaddingRightX = Padding[3];
+
+    int64_t StrideHeight = StrideShape[0];
+    int64_t StrideWidth = StrideShape[1];
+
+    int64_t OutputHeight = (InputHeight + PaddingLeftY + PaddingRightY - KernelHeight) / StrideHeight + 1;
+    int64_t OutputWidth = (InputWidth + PaddingLeftX + PaddingRightX - KernelWidth) / StrideWidth + 1;
+
+    for (int64_t c = 0; c < ChannelCount; c++) {
+
+        for (int64_t ph = 0; ph < OutputHeight; ph++) {
+
+            int64_t ihStart = ph * StrideHeight - PaddingLeftY;
+            int64_t ihEnd = ihStart + KernelHeight;
+
+            ihStart = (std::max)(ihStart, int64_t(0));
+            ihEnd = (std::min)(ihEnd, InputHeight);
+
+            for (int64_t pw = 0; pw < OutputWidth; pw++) {
+
+                int64_t iwStart = pw * StrideWidth - PaddingLeftX;
+                int64_t iwEnd = iwStart + KernelWidth;
+
+                iwStart = (std::max)(iwStart, int64_t(0));
+                iwEnd = (std::min)(iwEnd, InputWidth);
+
+                float m = std::numeric_limits<float>::lowest();
+
+                for (int64_t ih = ihStart; ih < ihEnd; ih++) {
+                    for (int64_t iw = iwStart; iw < iwEnd; iw++) {
+                        m = (std::max)(m, Input[ih * InputWidth + iw]);
+                    }
+                }
+
+                Output[ph * OutputWidth + pw] = m;
+            }
+        }
+
+        Input += InputHeight * InputWidth;
+        Output += OutputHeight * OutputWidth;
+    }
+}
+
+void
+ReferenceMaximumPool3D(
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const float* Input,
+    float* Output
+    )
+{
+    int64_t ChannelCount = InputShape[0] * InputShape[1];
+
+    int64_t InputDepth = InputShape[2];
+    int64_t InputHeight = InputShape[3];
+    int64_t InputWidth = InputShape[4];
+
+    int64_t KernelDepth = KernelShape[0];
+    int64_t KernelHeight = KernelShape[1];
+    int64_t KernelWidth = KernelShape[2];
+
+    int64_t PaddingLeftZ = Padding[0];
+    int64_t PaddingLeftY = Padding[1];
+    int64_t PaddingLeftX = Padding[2];
+    int64_t PaddingRightZ = Padding[3];
+    int64_t PaddingRightY = Padding[4];
+    int64_t PaddingRightX = Padding[5];
+
+    int64_t StrideDepth = StrideShape[0];
+    int64_t StrideHeight = StrideShape[1];
+    int64_t StrideWidth = StrideShape[2];
+
+    int64_t OutputDepth = (InputDepth + PaddingLeftZ + PaddingRightZ - KernelDepth) / StrideDepth + 1;
+    int64_t OutputHeight = (InputHeight + PaddingLeftY + PaddingRightY - KernelHeight) / StrideHeight + 1;
+    int64_t OutputWidth = (InputWidth + PaddingLeftX + PaddingRightX - KernelWidth) / StrideWidth + 1;
+
+    for (int64_t c = 0; c < ChannelCount; c++) {
+
+        for (int64_t pd = 0; pd < OutputDepth; pd++) {
+
+            int64_t idStart = pd * StrideDepth - PaddingLeftZ;
+            int64_t idEnd = idStart + KernelDepth;
+
+            idStart = (std::max)(idStart, int64_t(0));
+            idEnd = (std::min)(idEnd, InputDepth);
+
+            for (int64_t ph = 0; ph < OutputHeight; ph++) {
+
+                int64_t ihStart = ph * StrideHeight - PaddingLeftY;
+                int64_t ihEnd = ihStart + KernelHeight;
+
+                ihStart = (std::max)(ihStart, int64_t(0));
+                ihEnd = (std::min)(ihEnd, InputHeight);
+
+                for (int64_t pw = 0; pw < OutputWidth; pw++) {
+
+                    int64_t iwStart = pw * StrideWidth - PaddingLeftX;
+                    int64_t iwEnd = iwStart + KernelWidth;
+
+                    iwStart = (std::max)(iwStart, int64_t(0));
+                    iwEnd = (std::min)(iwEnd, InputWidth);
+
+                    float m = std::numeric_limits<float>::lowest();
+
+                    for (int64_t id = idStart; id < idEnd; id++) {
+                        for (int64_t ih = ihStart; ih < ihEnd; ih++) {
+                            for (int64_t iw = iwStart; iw < iwEnd; iw++) {
+                                m = (std::max)(m, Input[id * InputHeight * InputWidth + ih * InputWidth + iw]);
+                            }
+                        }
+                    }
+
+                    Output[pd * OutputHeight * OutputWidth + ph * OutputWidth + pw] = m;
+                }
+            }
+        }
+
+        Input += InputDepth * InputHeight * InputWidth;
+        Output += OutputDepth * OutputHeight * OutputWidth;
+    }
+}
+
+void
+ReferenceAveragePool2D(
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const float* Input,
+    float* Output,
+    MLAS_POOLING_KIND PoolingKind
+    )
+{
+    int64_t ChannelCount = InputShape[0] * InputShape[1];
+
+    int64_t InputHeight = InputShape[2];
+    int64_t InputWidth = InputShape[3];
+
+    int64_t KernelHeight = KernelShape[0];
+    int64_t KernelWidth = KernelShape[1];
+
+    int64_t PaddingLeftY = Padding[0];
+    int64_t PaddingLeftX = Padding[1];
+    int64_t PaddingRightY = Padding[2];
+    int64_t PaddingRightX = Padding[3];
+
+    int64_t StrideHeight = StrideShape[0];
+    int64_t StrideWidth = StrideShape[1];
+
+    int64_t OutputHeight = (InputHeight + PaddingLeftY + PaddingRightY - KernelHeight) / StrideHeight + 1;
+    int64_t OutputWidth = (InputWidth + PaddingLeftX + PaddingRightX - KernelWidth) / StrideWidth + 1;
+
+    for (int64_t c = 0; c < ChannelCount; c++) {
+
+        for (int64_t ph = 0; ph < OutputHeight; ph++) {
+
+            int64_t ihStart = ph * StrideHeight - PaddingLeftY;
+            int64_t ihEnd = ihStart + KernelHeight;
+
+            ihStart = (std::max)(ihStart, int64_t(0));
+            ihEnd = (std::min)(ihEnd, InputHeight);
+
+            for (int64_t pw = 0; pw < OutputWidth; pw++) {
+
+                int64_t iwStart = pw * StrideWidth - PaddingLeftX;
+                int64_t iwEnd = iwStart + KernelWidth;
+
+                iwStart = (std::max)(iwStart, int64_t(0));
+                iwEnd = (std::min)(iwEnd, InputWidth);
+
+                float m = 0.0f;
+
+                for (int64_t ih = ihStart; ih < ihEnd; ih++) {
+                    for (int64_t iw = iwStart; iw < iwEnd; iw++) {
+                        m += Input[ih * InputWidth + iw];
+                    }
+                }
+
+                if (PoolingKind == MlasAveragePoolingIncludePad) {
+                    m /= (KernelHeight * KernelWidth);
+                } else if (PoolingKind == MlasAveragePoolingExcludePad) {
+                    m /= (ihEnd - ihStart) * (iwEnd - iwStart);
+                }
+
+                Output[ph * OutputWidth + pw] = m;
+            }
+        }
+
+        Input += InputHeight * InputWidth;
+        Output += OutputHeight * OutputWidth;
+    }
+}
+
+void
+ReferenceAveragePool3D(
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const float* Input,
+    float* Output,
+    MLAS_POOLING_KIND PoolingKind
+    )
+{
+    int64_t ChannelCount = InputShape[0] * InputShape[1];
+
+    int64_t InputDepth = InputShape[2];
+    int64_t InputHeight = InputShape[3];
+    int64_t InputWidth = InputShape[4];
+
+    int64_t KernelDepth = KernelShape[0];
+    int64_t KernelHeight = KernelShape[1];
+    int64_t KernelWidth = KernelShape[2];
+
+    int64_t PaddingLeftZ = Padding[0];
+    int64_t PaddingLeftY = Padding[1];
+    int64_t PaddingLeftX = Padding[2];
+    int64_t PaddingRightZ = Padding[3];
+    int64_t PaddingRightY = Padding[4];
+    int64_t PaddingRightX = Padding[5];
+
+    int64_t StrideDepth = StrideShape[0];
+    int64_t StrideHeight = StrideShape[1];
+    int64_t StrideWidth = StrideShape[2];
+
+    int64_t OutputDepth = (InputDepth + PaddingLeftZ + PaddingRightZ - KernelDepth) / StrideDepth + 1;
+    int64_t OutputHeight = (InputHeight + PaddingLeftY + PaddingRightY - KernelHeight) / StrideHeight + 1;
+    int64_t OutputWidth = (InputWidth + PaddingLeftX + PaddingRightX - KernelWidth) / StrideWidth + 1;
+
+    for (int64_t c = 0; c < ChannelCount; c++) {
+
+        for (int64_t pd = 0; pd < OutputDepth; pd++) {
+
+            int64_t idStart = pd * StrideDepth - PaddingLeftZ;
+            int64_t idEnd = idStart + KernelDepth;
+
+            idStart = (std::max)(idStart, int64_t(0));
+            idEnd = (std::min)(idEnd, InputDepth);
+
+            for (int64_t ph = 0; ph < OutputHeight; ph++) {
+
+                int64_t ihStart = ph * StrideHeight - PaddingLeftY;
+                int64_t ihEnd = ihStart + KernelHeight;
+
+                ihStart = (std::max)(ihStart, int64_t(0));
+                ihEnd = (std::min)(ihEnd, InputHeight);
 
                 for (int64_t pw = 0; pw < OutputWidth; pw++) {
 
-                    int64_t iwStart = pw * StrideWidth - PaddingLeftX;
-                    int64_t iwEnd = iwStart + KernelWidth;
+                    int64_t iwStart = pw * StrideWidth - PaddingLeftX;
+                    int64_t iwEnd = iwStart + KernelWidth;
+
+                    iwStart = (std::max)(iwStart, int64_t(0));
+                    iwEnd = (std::min)(iwEnd, InputWidth);
+
+                    float m = 0.0f;
+
+                    for (int64_t id = idStart; id < idEnd; id++) {
+                        for (int64_t ih = ihStart; ih < ihEnd; ih++) {
+                            for (int64_t iw = iwStart; iw < iwEnd; iw++) {
+                                m += Input[id * InputHeight * InputWidth + ih * InputWidth + iw];
+                            }
+                        }
+                    }
+
+                    if (PoolingKind == MlasAveragePoolingIncludePad) {
+                        m /= (KernelDepth * KernelHeight * KernelWidth);
+                    } else if (PoolingKind == MlasAveragePoolingExcludePad) {
+                        m /= (idEnd - idStart) * (ihEnd - ihStart) * (iwEnd - iwStart);
+                    }
+
+                    Output[pd * OutputHeight * OutputWidth + ph * OutputWidth + pw] = m;
+                }
+            }
+        }
+
+        Input += InputDepth * InputHeight * InputWidth;
+        Output += OutputDepth * OutputHeight * OutputWidth;
+    }
+}
+
+void
+TrialPool2D(
+    size_t BatchCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t StrideHeight,
+    size_t StrideWidth
+    )
+{
+    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0, 0 };
+
+    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[2] - KernelShape[0]) / StrideShape[0] + 1;
+    OutputShape[3] = (InputShape[3] + Padding[1] + Padding[3] - KernelShape[1]) / StrideShape[1] + 1;
 
-                    iwStart = (std::max)(iwStart, int64_t(0));
-                    iwEnd = (std::min)(iwEnd, InputWidth);
+    size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2] * InputShape[3]);
+    size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2] * OutputShape[3]);
 
-                    float m = std::numeric_limits<float>::lowest();
+    MatrixGuardBuffer BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+
+    MlasPool(MlasMaximumPooling, 2, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output, threadpool);
+    ReferenceMaximumPool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: maximum input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    }
+
+    MlasPool(MlasAveragePoolingExcludePad, 2, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output, threadpool);
+    ReferenceAveragePool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, MlasAveragePoolingExcludePad);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: averageexcpad input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    }
+
+    MlasPool(MlasAveragePoolingIncludePad, 2, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output, threadpool);
+    ReferenceAveragePool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, MlasAveragePoolingIncludePad);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: averageincpad input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    }
+
+    MlasPool(MlasSumPooling, 2, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output, threadpool);
+    ReferenceAveragePool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, MlasSumPooling);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: sum input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    }
+}
+
+void
+TrialPool3D(
+    size_t BatchCount,
+    size_t InputChannels,
+    size_t InputDepth,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t KernelDepth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftDepth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightDepth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t StrideDepth,
+    size_t StrideHeight,
+    size_t StrideWidth
+    )
+{
+    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputDepth), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t KernelShape[] = { int64_t(KernelDepth), int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftDepth), int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightDepth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideDepth), int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0, 0, 0 };
+
+    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[3] - KernelShape[0]) / StrideShape[0] + 1;
+    OutputShape[3] = (InputShape[3] + Padding[1] + Padding[4] - KernelShape[1]) / StrideShape[1] + 1;
+    OutputShape[4] = (InputShape[4] + Padding[2] + Padding[5] - KernelShape[2]) / StrideShape[2] + 1;
+
+    size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2] * InputShape[3] * InputShape[4]);
+    size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2] * OutputShape[3] * OutputShape[4]);
+
+    MatrixGuardBuffer BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+
+    MlasPool(MlasMaximumPooling, 3, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output, threadpool);
+    ReferenceMaximumPool3D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: maximum input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n",
+            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+    }
+
+    MlasPool(MlasAveragePoolingExcludePad, 3, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output, threadpool);
+    ReferenceAveragePool3D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, MlasAveragePoolingExcludePad);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: averageexcpad input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n",
+            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+    }
+
+    MlasPool(MlasAveragePoolingIncludePad, 3, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output, threadpool);
+    ReferenceAveragePool3D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, MlasAveragePoolingIncludePad);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: averageincpad input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n",
+            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+    }
+
+    MlasPool(MlasSumPooling, 3, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output, threadpool);
+    ReferenceAveragePool3D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, MlasSumPooling);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: sum input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n",
+            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+    }
+}
+
+void
+TrialNchwcConv2D(
+    size_t BatchCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t FilterCount,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t DilationHeight,
+    size_t DilationWidth,
+    size_t StrideHeight,
+    size_t StrideWidth
+    )
+{
+    int64_t OutputHeight64 =
+        ((int64_t(InputHeight) + int64_t(PaddingLeftHeight) + int64_t(PaddingRightHeight)) -
+        (int64_t(DilationHeight) * (int64_t(KernelHeight) - 1) + 1)) / int64_t(StrideHeight) + 1;
+    int64_t OutputWidth64 =
+        ((int64_t(InputWidth) + int64_t(PaddingLeftWidth) + int64_t(PaddingRightWidth)) -
+        (int64_t(DilationWidth) * (int64_t(KernelWidth) - 1) + 1)) / int64_t(StrideWidth) + 1;
+
+    if (OutputHeight64 <= 0 || OutputWidth64 <= 0) {
+        return;
+    }
+
+    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t FilterShape[] = { int64_t(FilterCount), int64_t(InputChannels), int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t DilationShape[] = { int64_t(DilationHeight), int64_t(DilationWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(FilterCount), OutputHeight64, OutputWidth64 };
+
+    size_t OutputHeight = size_t(OutputHeight64);
+    size_t OutputWidth = size_t(OutputWidth64);
+
+    size_t InputBufferElements = BatchCount * InputChannels * InputHeight * InputWidth;
+    size_t FilterBufferElements = FilterCount * InputChannels * KernelHeight * KernelWidth;
+    size_t BiasBufferElements = FilterCount;
+    size_t OutputBufferElements = BatchCount * FilterCount * OutputHeight * OutputWidth;
+
+    MatrixGuardBuffer BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer BufferFilter(FilterBufferElements, true);
+    MatrixGuardBuffer BufferBias(BiasBufferElements, true);
+    MatrixGuardBuffer BufferNchwcInput(InputBufferElements, false);
+    MatrixGuardBuffer BufferNchwcFilter(FilterBufferElements, false);
+    MatrixGuardBuffer BufferNchwcOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    const float* Filter = BufferFilter.GetBuffer(FilterBufferElements);
+    const float* Bias = BufferBias.GetBuffer(BiasBufferElements);
+    float* NchwcInput = BufferNchwcInput.GetBuffer(InputBufferElements);
+    float* NchwcFilter = BufferNchwcFilter.GetBuffer(FilterBufferElements);
+    float* NchwcOutput = BufferNchwcOutput.GetBuffer(OutputBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+
+    //
+    // Inputs with a partial channel block are consumed in NCHW format.
+    //
+
+    const size_t BlockSize = MlasNchwcGetBlockSize();
+
+    if ((InputChannels % BlockSize) == 0) {
+        MlasReorderInput(InputShape, Input, NchwcInput);
+        MlasReorderFilterOIHWBiBo(FilterShape, Filter, NchwcFilter);
+    } else {
+        memcpy(NchwcInput, Input, InputBufferElements * sizeof(float));
+        MlasReorderFilterOIHWBo(FilterShape, Filter, NchwcFilter);
+    }
+
+    MLAS_ACTIVATION Activation;
+    Activation.ActivationKind = MlasIdentityActivation;
+
+    MlasNchwcConv(InputShape,
+                  KernelShape,
+                  DilationShape,
+                  Padding,
+                  StrideShape,
+                  OutputShape,
+                  NchwcInput,
+                  NchwcFilter,
+                  Bias,
+                  NchwcOutput,
+                  &Activation,
+                  threadpool);
+
+    MlasReorderOutput(OutputShape, NchwcOutput, Output);
+
+    ReferenceConv2D(BatchCount,
+                    1,
+                    InputChannels,
+                    InputHeight, InputWidth,
+                    FilterCount,
+                    KernelHeight, KernelWidth,
+                    PaddingLeftHeight, PaddingLeftWidth,
+                    DilationHeight, DilationWidth,
+                    StrideHeight, StrideWidth,
+                    OutputHeight, OutputWidth,
+                    Input,
+                    Filter,
+                    Bias,
+                    OutputReference);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: nchwc batch=%zd,input(%zd,%zd,%zd),filter=%zd,kernel(%zd,%zd)!!!\n",
+            BatchCount, InputChannels, InputHeight, InputWidth, FilterCount,
+            KernelHeight, KernelWidth);
+    }
+}
+
+void
+TrialNchwcPool2D(
+    size_t BatchCount,
+    size_t InputChannels,
+    size_t InputHeight,
+    size_t InputWidth,
+    size_t KernelHeight,
+    size_t KernelWidth,
+    size_t PaddingLeftHeight,
+    size_t PaddingLeftWidth,
+    size_t PaddingRightHeight,
+    size_t PaddingRightWidth,
+    size_t StrideHeight,
+    size_t StrideWidth
+    )
+{
+    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputHeight), int64_t(InputWidth) };
+    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
+    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
+    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
+    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0, 0 };
+
+    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[2] - KernelShape[0]) / StrideShape[0] + 1;
+    OutputShape[3] = (InputShape[3] + Padding[1] + Padding[3] - KernelShape[1]) / StrideShape[1] + 1;
+
+    size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2] * InputShape[3]);
+    size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2] * OutputShape[3]);
+
+    MatrixGuardBuffer BufferInput(InputBufferElements, true);
+    MatrixGuardBuffer BufferNchwcInput(InputBufferElements, false);
+    MatrixGuardBuffer BufferNchwcOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
+    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+
+    const float* Input = BufferInput.GetBuffer(InputBufferElements);
+    float* NchwcInput = BufferNchwcInput.GetBuffer(InputBufferElements);
+    float* NchwcOutput = BufferNchwcOutput.GetBuffer(OutputBufferElements);
+    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+
+    MlasReorderInput(InputShape, Input, NchwcInput);
+
+    MlasNchwcPool(MlasMaximumPooling, InputShape, KernelShape, Padding, StrideShape, OutputShape, NchwcInput, NchwcOutput, threadpool);
+    MlasReorderOutput(OutputShape, NchwcOutput, Output);
+    ReferenceMaximumPool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: nchwc maximum input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    }
+
+    MlasNchwcPool(MlasAveragePoolingExcludePad, InputShape, KernelShape, Padding, StrideShape, OutputShape, NchwcInput, NchwcOutput, threadpool);
+    MlasReorderOutput(OutputShape, NchwcOutput, Output);
+    ReferenceAveragePool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, MlasAveragePoolingExcludePad);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: nchwc averageexcpad input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    }
+
+    MlasNchwcPool(MlasAveragePoolingIncludePad, InputShape, KernelShape, Padding, StrideShape, OutputShape, NchwcInput, NchwcOutput, threadpool);
+    MlasReorderOutput(OutputShape, NchwcOutput, Output);
+    ReferenceAveragePool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, MlasAveragePoolingIncludePad);
+
+    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
+        printf("mismatch: nchwc averageincpad input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
+            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    }
+}
+
+void
+ExecuteNchwcTests(
+    void
+    )
+{
+    static const unsigned is[] = { 53, 11, 5, 1 };
 
-                    for (int64_t id = idStart; id < idEnd; id++) {
-                        for (int64_t ih = ihStart; ih < ihEnd; ih++) {
-                            for (int64_t iw = iwStart; iw < iwEnd; iw++) {
-                                m = (std::max)(m, Input[id * InputHeight * InputWidth + ih * InputWidth + iw]);
-                            }
+    for (unsigned ih = 0; ih < _countof(is); ih++) {
+        for (unsigned iw = 0; iw < _countof(is); iw++) {
+            fprintf(stderr, "Handling nchwc %dx%d\n", is[ih], is[iw]);
+            for (unsigned k = 1; k <= 3; k += 2) {
+                for (unsigned p = 0; p < k; p++) {
+                    for (unsigned d = 1; d <= 2; d++) {
+                        for (unsigned s = 1; s <= 2; s++) {
+                            TrialNchwcConv2D(1, 3, is[ih], is[iw], 32, k, k, p, p, p, p, d, d, s, s);
+                            TrialNchwcConv2D(2, 32, is[ih], is[iw], 80, k, k, p, 0, 0, p, d, d, s, s);
                         }
                     }
-
-                    Output[pd * OutputHeight * OutputWidth + ph * OutputWidth + pw] = m;
+                }
+            }
+            for (unsigned kh = 1; kh <= 3; kh++) {
+                if (kh > is[ih]) break;
+                for (unsigned kw = 1; kw <= 3; kw++) {
+                    if (kw > is[iw]) break;
+                    for (unsigned s = 1; s <= 2; s++) {
+                        TrialNchwcPool2D(2, 32, is[ih], is[iw], kh, kw, 0, 0, 0, 0, s, s);
+                        TrialNchwcPool2D(2, 32, is[ih], is[iw], kh, kw, kh - 1, kw - 1, kh - 1, kw - 1, s, s);
+                    }
                 }
             }
         }
-
-        Input += InputDepth * InputHeight * InputWidth;
-        Output += OutputDepth * OutputHeight * OutputWidth;
     }
 }
 
 void
-ReferenceAveragePool2D(
-    const int64_t* InputShape,
-    const int64_t* KernelShape,
-    const int64_t* Padding,
-    const int64_t* StrideShape,
+TrialComputeUnary(
+    const char* Name,
+    void (MLASCALL* ComputeRoutine)(const float*, float*, size_t),
+    double (*ReferenceRoutine)(double),
     const float* Input,
-    float* Output,
-    bool CountIncludePad
+    size_t N,
+    double RelativeTolerance,
+    double AbsoluteTolerance
     )
 {
-    int64_t ChannelCount = InputShape[0] * InputShape[1];
+    std::vector<float> Output(N);
 
-    int64_t InputHeight = InputShape[2];
-    int64_t InputWidth = InputShape[3];
+    ComputeRoutine(Input, Output.data(), N);
 
-    int64_t KernelHeight = KernelShape[0];
-    int64_t KernelWidth = KernelShape[1];
+    for (size_t n = 0; n < N; n++) {
 
-    int64_t PaddingLeftY = Padding[0];
-    int64_t PaddingLeftX = Padding[1];
-    int64_t PaddingRightY = Padding[2];
-    int64_t PaddingRightX = Padding[3];
+        double Reference = double(float(ReferenceRoutine(double(Input[n]))));
+        double Value = double(Output[n]);
 
-    int64_t StrideHeight = StrideShape[0];
-    int64_t StrideWidth = StrideShape[1];
+        if (std::isnan(Reference) || std::isinf(Reference)) {
+            if (std::isnan(Reference) != std::isnan(Value) || (std::isinf(Reference) && Reference != Value)) {
+                printf("mismatch %s: input=%g,output=%g,reference=%g!!!\n", Name, Input[n], Value, Reference);
+            }
+            continue;
+        }
 
-    int64_t OutputHeight = (InputHeight + PaddingLeftY + PaddingRightY - KernelHeight) / StrideHeight + 1;
-    int64_t OutputWidth = (InputWidth + PaddingLeftX + PaddingRightX - KernelWidth) / StrideWidth + 1;
+        double Error = std::abs(Value - Reference);
 
-    for (int64_t c = 0; c < ChannelCount; c++) {
+        if (Error > AbsoluteTolerance && Error > std::abs(Reference) * RelativeTolerance) {
+            printf("mismatch %s: input=%g,output=%g,reference=%g!!!\n", Name, Input[n], Value, Reference);
+        }
+    }
+}
 
-        for (int64_t ph = 0; ph < OutputHeight; ph++) {
+void
+TrialSoftmax(
+    size_t N,
+    size_t D,
+    bool LogSoftmax
+    )
+{
+    std::vector<float> Input(N * D);
+    std::vector<float> Output(N * D);
 
-            int64_t ihStart = ph * StrideHeight - PaddingLeftY;
-            int64_t ihEnd = ihStart + KernelHeight;
+    for (size_t i = 0; i < N * D; i++) {
+        Input[i] = float(int(i % 97) - 48) * 0.25f + float(i % 7);
+    }
 
-            ihStart = (std::max)(ihStart, int64_t(0));
-            ihEnd = (std::min)(ihEnd, InputHeight);
+    MlasComputeSoftmax(Input.data(), Output.data(), N, D, LogSoftmax, threadpool);
 
-            for (int64_t pw = 0; pw < OutputWidth; pw++) {
+    for (size_t n = 0; n < N; n++) {
 
-                int64_t iwStart = pw * StrideWidth - PaddingLeftX;
-                int64_t iwEnd = iwStart + KernelWidth;
+        const float* input = &Input[n * D];
+        const float* output = &Output[n * D];
 
-                iwStart = (std::max)(iwStart, int64_t(0));
-                iwEnd = (std::min)(iwEnd, InputWidth);
+        double Maximum = input[0];
 
-                float m = 0.0f;
+        for (size_t d = 0; d < D; d++) {
+            Maximum = std::max(Maximum, double(input[d]));
+        }
 
-                for (int64_t ih = ihStart; ih < ihEnd; ih++) {
-                    for (int64_t iw = iwStart; iw < iwEnd; iw++) {
-                        m += Input[ih * InputWidth + iw];
-                    }
-                }
+        double Sum = 0.0;
 
-                if (CountIncludePad) {
-                    m /= (KernelHeight * KernelWidth);
-                } else {
-                    m /= (ihEnd - ihStart) * (iwEnd - iwStart);
-                }
+        for (size_t d = 0; d < D; d++) {
+            Sum += std::exp(double(input[d]) - Maximum);
+        }
 
-                Output[ph * OutputWidth + pw] = m;
+        for (size_t d = 0; d < D; d++) {
+
+            double Reference = double(input[d]) - Maximum;
+
+            if (LogSoftmax) {
+                Reference -= std::log(Sum);
+            } else {
+                Reference = std::exp(Reference) / Sum;
             }
-        }
 
-        Input += InputHeight * InputWidth;
-        Output += OutputHeight * OutputWidth;
+            if (std::abs(double(output[d]) - Reference) > 1e-6 + std::abs(Reference) * 1e-5) {
+                printf("mismatch %s: N=%zd,D=%zd,n=%zd,d=%zd,output=%g,reference=%g!!!\n",
+                    LogSoftmax ? "logsoftmax" : "softmax", N, D, n, d, output[d], Reference);
+                return;
+            }
+        }
     }
 }
 
 void
-ReferenceAveragePool3D(
-    const int64_t* InputShape,
-    const int64_t* KernelShape,
-    const int64_t* Padding,
-    const int64_t* StrideShape,
-    const float* Input,
-    float* Output,
-    bool CountIncludePad
+TrialConvertHalfToFloat(
+    void
     )
 {
-    int64_t ChannelCount = InputShape[0] * InputShape[1];
-
-    int64_t InputDepth = InputShape[2];
-    int64_t InputHeight = InputShape[3];
-    int64_t InputWidth = InputShape[4];
-
-    int64_t KernelDepth = KernelShape[0];
-    int64_t KernelHeight = KernelShape[1];
-    int64_t KernelWidth = KernelShape[2];
-
-    int64_t PaddingLeftZ = Padding[0];
-    int64_t PaddingLeftY = Padding[1];
-    int64_t PaddingLeftX = Padding[2];
-    int64_t PaddingRightZ = Padding[3];
-    int64_t PaddingRightY = Padding[4];
-    int64_t PaddingRightX = Padding[5];
+    //
+    // Convert every half precision value, including denormals, infinities and
+    // NaNs, with each starting alignment of the kernel tail.
+    //
 
-    int64_t StrideDepth = StrideShape[0];
-    int64_t StrideHeight = StrideShape[1];
-    int64_t StrideWidth = StrideShape[2];
+    std::vector<unsigned short> Source(65536 + 17);
+    std::vector<float> Destination(Source.size());
 
-    int64_t OutputDepth = (InputDepth + PaddingLeftZ + PaddingRightZ - KernelDepth) / StrideDepth + 1;
-    int64_t OutputHeight = (InputHeight + PaddingLeftY + PaddingRightY - KernelHeight) / StrideHeight + 1;
-    int64_t OutputWidth = (InputWidth + PaddingLeftX + PaddingRightX - KernelWidth) / StrideWidth + 1;
+    for (size_t f = 0; f < Source.size(); f++) {
+        Source[f] = (unsigned short)f;
+    }
 
-    for (int64_t c = 0; c < ChannelCount; c++) {
+    for (size_t offset = 0; offset <= 17; offset += 17) {
 
-        for (int64_t pd = 0; pd < OutputDepth; pd++) {
+        MlasConvertHalfToFloatBuffer(Source.data() + offset, Destination.data(), 65536);
 
-            int64_t idStart = pd * StrideDepth - PaddingLeftZ;
-            int64_t idEnd = idStart + KernelDepth;
+        for (size_t f = 0; f < 65536; f++) {
 
-            idStart = (std::max)(idStart, int64_t(0));
-            idEnd = (std::min)(idEnd, InputDepth);
+            const unsigned short Half = Source[offset + f];
+            const int Exponent = (Half >> 10) & 0x1F;
+            const int Mantissa = Half & 0x3FF;
 
-            for (int64_t ph = 0; ph < OutputHeight; ph++) {
+            float Reference;
 
-                int64_t ihStart = ph * StrideHeight - PaddingLeftY;
-                int64_t ihEnd = ihStart + KernelHeight;
+            if (Exponent == 0x1F) {
+                Reference = (Mantissa == 0) ? std::numeric_limits<float>::infinity() :
+                    std::numeric_limits<float>::quiet_NaN();
+            } else if (Exponent == 0) {
+                Reference = std::ldexp(float(Mantissa), -24);
+            } else {
+                Reference = std::ldexp(float(Mantissa + 1024), Exponent - 25);
+            }
 
-                ihStart = (std::max)(ihStart, int64_t(0));
-                ihEnd = (std::min)(ihEnd, InputHeight);
+            if ((Half & 0x8000) != 0) {
+                Reference = -Reference;
+            }
 
-                for (int64_t pw = 0; pw < OutputWidth; pw++) {
+            const float Value = Destination[f];
 
-                    int64_t iwStart = pw * StrideWidth - PaddingLeftX;
-                    int64_t iwEnd = iwStart + KernelWidth;
+            if (std::isnan(Reference) ? !std::isnan(Value) :
+                (Value != Reference || std::signbit(Value) != std::signbit(Reference))) {
+                printf("mismatch convert half to float: half=%04x, value=%g, reference=%g!\n", Half, Value, Reference);
+                break;
+            }
+        }
+    }
 
-                    iwStart = (std::max)(iwStart, int64_t(0));
-                    iwEnd = (std::min)(iwEnd, InputWidth);
+    //
+    // Convert short buffers to exercise the partial vector handling.
+    //
 
-                    float m = 0.0f;
+    for (size_t n = 1; n <= 33; n++) {
 
-                    for (int64_t id = idStart; id < idEnd; id++) {
-                        for (int64_t ih = ihStart; ih < ihEnd; ih++) {
-                            for (int64_t iw = iwStart; iw < iwEnd; iw++) {
-                                m += Input[id * InputHeight * InputWidth + ih * InputWidth + iw];
-                            }
-                        }
-                    }
+        std::fill(Destination.begin(), Destination.end(), -1.0f);
 
-                    if (CountIncludePad) {
-                        m /= (KernelDepth * KernelHeight * KernelWidth);
-                    } else {
-                        m /= (idEnd - idStart) * (ihEnd - ihStart) * (iwEnd - iwStart);
-                    }
+        MlasConvertHalfToFloatBuffer(Source.data() + 0x3C00, Destination.data(), n);
 
-                    Output[pd * OutputHeight * OutputWidth + ph * OutputWidth + pw] = m;
-                }
+        for (size_t f = 0; f <= n; f++) {
+            float Reference = (f < n) ? 1.0f + float(f) / 1024.0f : -1.0f;
+            if (Destination[f] != Reference) {
+                printf("mismatch convert half to float: count=%zd, index=%zd!\n", n, f);
+                break;
             }
         }
-
-        Input += InputDepth * InputHeight * InputWidth;
-        Output += OutputDepth * OutputHeight * OutputWidth;
     }
 }
 
 void
-TrialPool2D(
-    size_t BatchCount,
-    size_t InputChannels,
-    size_t InputHeight,
-    size_t InputWidth,
-    size_t KernelHeight,
-    size_t KernelWidth,
-    size_t PaddingLeftHeight,
-    size_t PaddingLeftWidth,
-    size_t PaddingRightHeight,
-    size_t PaddingRightWidth,
-    size_t StrideHeight,
-    size_t StrideWidth
+ExecuteComputeTests(
+    void
     )
 {
-    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputHeight), int64_t(InputWidth) };
-    int64_t KernelShape[] = { int64_t(KernelHeight), int64_t(KernelWidth) };
-    int64_t Padding[] = { int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
-    int64_t StrideShape[] = { int64_t(StrideHeight), int64_t(StrideWidth) };
-    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0, 0 };
+    std::vector<float> Input;
 
-    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[2] - KernelShape[0]) / StrideShape[0] + 1;
-    OutputShape[3] = (InputShape[3] + Padding[1] + Padding[3] - KernelShape[1]) / StrideShape[1] + 1;
+    //
+    // Sweep the exponential across the full float range including the
+    // underflow and overflow regions.
+    //
 
-    size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2] * InputShape[3]);
-    size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2] * OutputShape[3]);
+    for (float x = -110.0f; x <= 90.0f; x += 0.0625f) {
+        Input.push_back(x);
+    }
 
-    MatrixGuardBuffer BufferInput(InputBufferElements, true);
-    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
-    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+    Input.push_back(std::numeric_limits<float>::infinity());
+    Input.push_back(-std::numeric_limits<float>::infinity());
 
-    const float* Input = BufferInput.GetBuffer(InputBufferElements);
-    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
-    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+    for (size_t n = 1; n <= 17; n++) {
+        TrialComputeUnary("exp", MlasComputeExp, std::exp, Input.data() + Input.size() - n, n, 2e-6, 0.0);
+    }
 
-    MlasPool(MlasMaximumPooling, 2, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
-    ReferenceMaximumPool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference);
+    TrialComputeUnary("exp", MlasComputeExp, std::exp, Input.data(), Input.size() - 2, 2e-6, 1e-37);
 
-    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
-        printf("mismatch: maximum input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
-            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    //
+    // Sweep the natural logarithm across the normal float range and the
+    // special inputs.
+    //
+
+    Input.clear();
+
+    for (float x = 1e-37f; x < 1e37f; x *= 1.0625f) {
+        Input.push_back(x);
     }
 
-    MlasPool(MlasAveragePoolingExcludePad, 2, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
-    ReferenceAveragePool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, false);
+    Input.push_back(0.0f);
+    Input.push_back(-1.0f);
+    Input.push_back(std::numeric_limits<float>::infinity());
+    Input.push_back(std::numeric_limits<float>::quiet_NaN());
 
-    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
-        printf("mismatch: averageexcpad input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
-            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    TrialComputeUnary("log", MlasComputeLog, std::log, Input.data(), Input.size(), 1e-6, 1e-7);
+
+    //
+    // Sweep the error function across its transition region.
+    //
+
+    Input.clear();
+
+    for (float x = -5.0f; x <= 5.0f; x += 0.01f) {
+        Input.push_back(x);
     }
 
-    MlasPool(MlasAveragePoolingIncludePad, 2, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
-    ReferenceAveragePool2D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, true);
+    TrialComputeUnary("erf", MlasComputeErf, std::erf, Input.data(), Input.size(), 1e-6, 1e-6);
 
-    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
-        printf("mismatch: averageincpad input(%zd,%zd,%zd),kernel(%zd,%zd)!!!\n",
-            InputChannels, InputHeight, InputWidth, KernelHeight, KernelWidth);
+    //
+    // Exercise the softmax with partial vectors and multiple threads.
+    //
+
+    for (size_t d = 1; d <= 67; d++) {
+        TrialSoftmax(3, d, false);
+        TrialSoftmax(3, d, true);
     }
+
+    TrialSoftmax(128, 1000, false);
+    TrialSoftmax(128, 1000, true);
+    TrialSoftmax(2, 50257, false);
+    TrialSoftmax(2, 50257, true);
+
+    TrialConvertHalfToFloat();
 }
 
 void
-TrialPool3D(
-    size_t BatchCount,
-    size_t InputChannels,
-    size_t InputDepth,
-    size_t InputHeight,
-    size_t InputWidth,
-    size_t KernelDepth,
-    size_t KernelHeight,
-    size_t KernelWidth,
-    size_t PaddingLeftDepth,
-    size_t PaddingLeftHeight,
-    size_t PaddingLeftWidth,
-    size_t PaddingRightDepth,
-    size_t PaddingRightHeight,
-    size_t PaddingRightWidth,
-    size_t StrideDepth,
-    size_t StrideHeight,
-    size_t StrideWidth
+ExecuteIsaLevelTests(
+    void
     )
 {
-    int64_t InputShape[] = { int64_t(BatchCount), int64_t(InputChannels), int64_t(InputDepth), int64_t(InputHeight), int64_t(InputWidth) };
-    int64_t KernelShape[] = { int64_t(KernelDepth), int64_t(KernelHeight), int64_t(KernelWidth) };
-    int64_t Padding[] = { int64_t(PaddingLeftDepth), int64_t(PaddingLeftHeight), int64_t(PaddingLeftWidth), int64_t(PaddingRightDepth), int64_t(PaddingRightHeight), int64_t(PaddingRightWidth) };
-    int64_t StrideShape[] = { int64_t(StrideDepth), int64_t(StrideHeight), int64_t(StrideWidth) };
-    int64_t OutputShape[] = { int64_t(BatchCount), int64_t(InputChannels), 0, 0, 0 };
+    const MLAS_ISA_LEVEL SupportedIsaLevel = MlasGetSupportedIsaLevel();
 
-    OutputShape[2] = (InputShape[2] + Padding[0] + Padding[3] - KernelShape[0]) / StrideShape[0] + 1;
-    OutputShape[3] = (InputShape[3] + Padding[1] + Padding[4] - KernelShape[1]) / StrideShape[1] + 1;
-    OutputShape[4] = (InputShape[4] + Padding[2] + Padding[5] - KernelShape[2]) / StrideShape[2] + 1;
+    //
+    // Step down through the instruction set levels and run the tests of the
+    // entry points with dispatched kernels against each kernel variant.
+    //
 
-    size_t InputBufferElements = size_t(InputShape[0] * InputShape[1] * InputShape[2] * InputShape[3] * InputShape[4]);
-    size_t OutputBufferElements = size_t(OutputShape[0] * OutputShape[1] * OutputShape[2] * OutputShape[3] * OutputShape[4]);
+    for (int level = int(SupportedIsaLevel); level >= int(MlasIsaLevelGeneric); level--) {
 
-    MatrixGuardBuffer BufferInput(InputBufferElements, true);
-    MatrixGuardBuffer BufferOutput(OutputBufferElements, false);
-    MatrixGuardBuffer BufferOutputReference(OutputBufferElements, false);
+        MLAS_ISA_LEVEL IsaLevel = MlasSetMaximumIsaLevel(MLAS_ISA_LEVEL(level));
 
-    const float* Input = BufferInput.GetBuffer(InputBufferElements);
-    float* Output = BufferOutput.GetBuffer(OutputBufferElements);
-    float* OutputReference = BufferOutputReference.GetBuffer(OutputBufferElements);
+        if (IsaLevel != MLAS_ISA_LEVEL(level) || MlasGetIsaLevel() != IsaLevel) {
+            printf("mismatch isa level: requested=%d, selected=%d!\n", level, int(IsaLevel));
+        }
 
-    MlasPool(MlasMaximumPooling, 3, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
-    ReferenceMaximumPool3D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference);
+        const MLAS_KERNEL_SELECTION* KernelSelection;
+        size_t KernelSelectionCount = MlasGetKernelSelection(&KernelSelection);
 
-    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
-        printf("mismatch: maximum input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n",
-            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
-    }
+        printf("isa level %s:", MlasGetIsaLevelName(IsaLevel));
+        for (size_t i = 0; i < KernelSelectionCount; i++) {
+            printf(" %s=%s", KernelSelection[i].EntryPoint, KernelSelection[i].Variant);
+        }
+        printf("\n");
 
-    MlasPool(MlasAveragePoolingExcludePad, 3, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
-    ReferenceAveragePool3D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, false);
+        for (size_t b = 1; b < 16; b++) {
+            TrialQgemm<uint8_t>(b, b, b, 14, 211, false);
+            TrialQgemm<int8_t>(b, b, b, 14, -23, false);
+        }
+        for (size_t b = 16; b <= 256; b <<= 1) {
+            TrialQgemm<uint8_t>(b, b, b, 34, 1, true);
+            TrialQgemm<int8_t>(b, b, b, 34, 1, true);
+        }
 
-    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
-        printf("mismatch: averageexcpad input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n",
-            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+        ExecuteComputeTests();
     }
 
-    MlasPool(MlasAveragePoolingIncludePad, 3, InputShape, KernelShape, Padding, StrideShape, OutputShape, Input, Output);
-    ReferenceAveragePool3D(InputShape, KernelShape, Padding, StrideShape, Input, OutputReference, true);
+    //
+    // Requesting a level above the supported level selects the supported level.
+    //
 
-    if (memcmp(Output, OutputReference, OutputBufferElements * sizeof(float)) != 0) {
-        printf("mismatch: averageincpad input(%zd,%zd,%zd,%zd),kernel(%zd,%zd,%zd)!!!\n",
-            InputChannels, InputDepth, InputHeight, InputWidth, KernelDepth, KernelHeight, KernelWidth);
+    if (MlasSetMaximumIsaLevel(MlasIsaLevelAvx512Vnni) != SupportedIsaLevel) {
+        printf("mismatch isa level: supported level not restored!\n");
     }
 }
 
@@ -1190,7 +2490,7 @@ EvaluateThreadingPerformance(
                 DWORD start = GetTickCount();
                 DWORD stop;
                 do {
-                    MlasSgemm(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, A, K, B, N, 0.0f, C, N);
+                    MlasSgemm(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, A, K, B, N, 0.0f, C, N, nullptr);
                     stop = GetTickCount();
                     NumberIterations++;
                 } while ((stop - start) <= 5000);
@@ -1210,7 +2510,7 @@ EvaluateThreadingPerformance(
 
                     start = GetTickCount();
                     for (size_t iters = 0; iters < NumberIterations; iters++) {
-                        MlasSgemm(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, A, K, B, N, 0.0f, C, N);
+                        MlasSgemm(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, A, K, B, N, 0.0f, C, N, nullptr);
                         stop = GetTickCount();
                         if ((stop - start) > 20000) {
                             break;
@@ -1238,10 +2538,31 @@ main(
     void
     )
 {
-//    ExecuteSgemmTests();
-    ExecuteConvTests();
-//    ExecutePool2DTests();
-//    ExecutePool3DTests();
+    onnxruntime::concurrency::ThreadPoolOptions ThreadPoolOptions;
+    ThreadPoolOptions.num_threads = 3;
+
+    std::unique_ptr<onnxruntime::concurrency::ThreadPool> ThreadPool =
+        std::make_unique<onnxruntime::concurrency::ThreadPool>("MlasTest", ThreadPoolOptions);
+
+    for (int i = 0; i < 2; i++) {
+
+        printf("%s\n", (threadpool == nullptr) ? "SingleThread" : "ThreadPool");
+
+//        ExecuteSgemmTests();
+        ExecuteSgemmPackedBTests();
+        ExecuteSgemmBatchTests();
+        ExecuteQgemmTests();
+        ExecuteConvTests();
+        ExecuteConvTransposeTests();
+        ExecuteNchwcTests();
+        ExecuteComputeTests();
+        ExecuteIsaLevelTests();
+//        ExecutePool2DTests();
+//        ExecutePool3DTests();
+
+        threadpool = ThreadPool.get();
+    }
+
 //    EvaluateThreadingPerformance();
 
     return 0;
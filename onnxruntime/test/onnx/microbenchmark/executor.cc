@@ -0,0 +1,170 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <core/graph/onnx_protobuf.h>
+#include <core/framework/allocator.h>
+#include <core/framework/prepared_run.h>
+#include <core/framework/tensor.h>
+#include <core/graph/model.h>
+#include <core/session/inference_session.h>
+#include <sstream>
+
+using namespace onnxruntime;
+
+// Build a model with num_chains independent chains of chain_length Add nodes on a tiny tensor, so the run time is
+// dominated by the per node overhead of the executor rather than by the kernels.
+static std::string CreateAddChainsModel(int num_chains, int chain_length) {
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[kOnnxDomain] = 7;
+  Model model("executor_benchmark", false, ModelMetaData(), IOnnxRuntimeOpSchemaRegistryList(), domain_to_version);
+  Graph& graph = model.MainGraph();
+
+  ONNX_NAMESPACE::TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  tensor_float.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(16);
+
+  auto& input_arg = graph.GetOrCreateNodeArg("X", &tensor_float);
+  for (int chain = 0; chain < num_chains; ++chain) {
+    NodeArg* prev_arg = &input_arg;
+    for (int i = 0; i < chain_length; ++i) {
+      std::string name = "chain_" + std::to_string(chain) + "_" + std::to_string(i);
+      std::string output_name = i + 1 == chain_length ? "Y_" + std::to_string(chain) : name;
+      auto& output_arg = graph.GetOrCreateNodeArg(output_name, &tensor_float);
+      graph.AddNode(name, "Add", "", {prev_arg, &input_arg}, {&output_arg});
+      prev_arg = &output_arg;
+    }
+  }
+
+  auto status = graph.Resolve();
+  if (!status.IsOK()) {
+    printf("Resolve graph failed: %s", status.ErrorMessage().c_str());
+    abort();
+  }
+
+  std::string serialized;
+  model.ToProto().SerializeToString(&serialized);
+  return serialized;
+}
+
+// state.range(0): 1 for the SequentialExecutor, 0 for the ParallelExecutor, 2 for the SequentialExecutor running
+// the independent chains on 4 threads
+// state.range(1): number of independent chains. The graph always has 2048 nodes.
+static void BM_ExecutorAddChains(benchmark::State& state) {
+  const bool sequential = state.range(0) != 0;
+  const bool branch_parallel = state.range(0) == 2;
+  const int num_chains = static_cast<int>(state.range(1));
+  const int chain_length = 2048 / num_chains;
+
+  SessionOptions so;
+  so.session_logid = "BM_ExecutorAddChains";
+  so.enable_sequential_execution = sequential;
+  so.session_thread_pool_size = 4;
+  so.branch_parallel_num_threads = branch_parallel ? 4 : 0;
+
+  InferenceSession session{so};
+  std::istringstream model_stream(CreateAddChainsModel(num_chains, chain_length));
+  auto status = session.Load(model_stream);
+  if (status.IsOK()) {
+    status = session.Initialize();
+  }
+  if (!status.IsOK()) {
+    state.SkipWithError(status.ErrorMessage().c_str());
+    return;
+  }
+
+  AllocatorPtr allocator = std::make_shared<CPUAllocator>();
+  std::vector<float> values(16, 0.5f);
+  auto input_tensor = std::make_unique<Tensor>(DataTypeImpl::GetType<float>(), TensorShape({16}), values.data(),
+                                               allocator->Info());
+  MLValue input;
+  input.Init(input_tensor.release(), DataTypeImpl::GetType<Tensor>(), DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+
+  NameMLValMap feeds{{"X", input}};
+  std::vector<std::string> output_names;
+  for (int chain = 0; chain < num_chains; ++chain) {
+    output_names.push_back("Y_" + std::to_string(chain));
+  }
+
+  for (auto _ : state) {
+    std::vector<MLValue> fetches;
+    status = session.Run(feeds, output_names, &fetches);
+    if (!status.IsOK()) {
+      state.SkipWithError(status.ErrorMessage().c_str());
+      break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * 2048);
+}
+
+BENCHMARK(BM_ExecutorAddChains)
+    ->ArgNames({"executor", "chains"})
+    ->Args({1, 1})
+    ->Args({0, 1})
+    ->Args({1, 4})
+    ->Args({0, 4})
+    ->Args({2, 4})
+    ->Args({1, 16})
+    ->Args({0, 16})
+    ->Args({2, 16})
+    ->UseRealTime();
+
+// state.range(0): 1 to run through a PreparedRun, 0 for the regular Run
+// A single Add on 16 floats, so the time is the per run overhead of the framework.
+static void BM_RunOverheadAdd(benchmark::State& state) {
+  const bool prepared = state.range(0) != 0;
+
+  SessionOptions so;
+  so.session_logid = "BM_RunOverheadAdd";
+
+  InferenceSession session{so};
+  std::istringstream model_stream(CreateAddChainsModel(1, 1));
+  auto status = session.Load(model_stream);
+  if (status.IsOK()) {
+    status = session.Initialize();
+  }
+  if (!status.IsOK()) {
+    state.SkipWithError(status.ErrorMessage().c_str());
+    return;
+  }
+
+  AllocatorPtr allocator = std::make_shared<CPUAllocator>();
+  std::vector<float> values(16, 0.5f);
+  auto input_tensor = std::make_unique<Tensor>(DataTypeImpl::GetType<float>(), TensorShape({16}), values.data(),
+                                               allocator->Info());
+  MLValue input;
+  input.Init(input_tensor.release(), DataTypeImpl::GetType<Tensor>(), DataTypeImpl::GetType<Tensor>()->GetDeleteFunc());
+
+  RunOptions run_options;
+  std::unique_ptr<PreparedRun> prepared_run;
+  if (prepared) {
+    status = session.PrepareRun(run_options, {"X"}, {"Y_0"}, &prepared_run);
+    if (!status.IsOK()) {
+      state.SkipWithError(status.ErrorMessage().c_str());
+      return;
+    }
+  }
+
+  NameMLValMap feeds{{"X", input}};
+  std::vector<MLValue> feed_values{input};
+  std::vector<std::string> output_names{"Y_0"};
+
+  for (auto _ : state) {
+    std::vector<MLValue> fetches;
+    if (prepared) {
+      status = session.Run(*prepared_run, feed_values, &fetches);
+    } else {
+      status = session.Run(run_options, feeds, output_names, &fetches);
+    }
+    if (!status.IsOK()) {
+      state.SkipWithError(status.ErrorMessage().c_str());
+      break;
+    }
+  }
+}
+
+BENCHMARK(BM_RunOverheadAdd)
+    ->ArgNames({"prepared"})
+    ->Arg(0)
+    ->Arg(1);
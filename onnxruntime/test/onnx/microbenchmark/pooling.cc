@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <core/mlas/inc/mlas.h>
+#include <core/platform/threadpool.h>
+#include <memory>
+#include <vector>
+
+using namespace onnxruntime;
+
+// state.range(0): MLAS_POOLING_KIND
+// state.range(1): channels
+// state.range(2): input height and width
+// state.range(3): kernel height and width, 0 for global pooling
+// state.range(4): stride
+// state.range(5): worker threads, 0 to run on the calling thread only
+static void BM_MlasPool2D(benchmark::State& state) {
+  const auto kind = static_cast<MLAS_POOLING_KIND>(state.range(0));
+  const int64_t channels = state.range(1);
+  const int64_t input_size = state.range(2);
+  const int64_t kernel = state.range(3);
+  const int64_t stride = state.range(4);
+  const int num_threads = static_cast<int>(state.range(5));
+  const bool global_pooling = kernel == 0;
+
+  // Pad symmetrically so that a 3x3 stride 2 window yields the usual ResNet stem output size.
+  const int64_t pad = global_pooling ? 0 : kernel / 2;
+  const int64_t output_size = global_pooling ? 1 : (input_size + 2 * pad - kernel) / stride + 1;
+
+  const int64_t input_shape[] = {1, channels, input_size, input_size};
+  const int64_t kernel_shape[] = {kernel, kernel};
+  const int64_t padding[] = {pad, pad, pad, pad};
+  const int64_t stride_shape[] = {stride, stride};
+  const int64_t output_shape[] = {1, channels, output_size, output_size};
+
+  std::vector<float> input(static_cast<size_t>(channels * input_size * input_size));
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = static_cast<float>(i % 97) * 0.25f - 12.0f;
+  }
+  std::vector<float> output(static_cast<size_t>(channels * output_size * output_size));
+
+  std::unique_ptr<concurrency::ThreadPool> thread_pool;
+  if (num_threads > 0) {
+    concurrency::ThreadPoolOptions options;
+    options.num_threads = num_threads;
+    thread_pool = std::make_unique<concurrency::ThreadPool>("BM_MlasPool2D", options);
+  }
+
+  for (auto _ : state) {
+    MlasPool(kind,
+             2,
+             input_shape,
+             global_pooling ? nullptr : kernel_shape,
+             global_pooling ? nullptr : padding,
+             global_pooling ? nullptr : stride_shape,
+             output_shape,
+             input.data(),
+             output.data(),
+             thread_pool.get());
+    benchmark::DoNotOptimize(output.data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(input.size() * sizeof(float)));
+}
+
+BENCHMARK(BM_MlasPool2D)
+    ->ArgNames({"kind", "C", "HW", "K", "S", "threads"})
+    // ResNet stem MaxPool 3x3 stride 2.
+    ->Args({MlasMaximumPooling, 64, 112, 3, 2, 0})
+    ->Args({MlasMaximumPooling, 64, 112, 3, 2, 4})
+    // Inception style AveragePool 3x3 stride 1.
+    ->Args({MlasAveragePoolingExcludePad, 192, 35, 3, 1, 0})
+    ->Args({MlasAveragePoolingExcludePad, 192, 35, 3, 1, 4})
+    // Sum pooling as used by LpPool.
+    ->Args({MlasSumPooling, 192, 35, 3, 1, 0})
+    ->Args({MlasSumPooling, 192, 35, 3, 1, 4})
+    // GlobalAveragePool at the end of ResNet-50 and MobileNet.
+    ->Args({MlasAveragePoolingIncludePad, 2048, 7, 0, 1, 0})
+    ->Args({MlasAveragePoolingIncludePad, 2048, 7, 0, 1, 4})
+    ->Args({MlasAveragePoolingIncludePad, 1280, 7, 0, 1, 0})
+    ->Args({MlasMaximumPooling, 512, 14, 0, 1, 0})
+    ->UseRealTime();
@@ -34,12 +34,16 @@ namespace perftest {
       "\t-s: Show statistics result, like P75, P90.\n"
       "\t-v: Show verbose information.\n"
       "\t-x: Use parallel executor, default (without -x): sequential executor.\n"
+      "\t-c [concurrent_clients]: Run as a load generator with this many concurrent clients, and compare unbatched\n"
+      "\t\truns with dynamically batched runs. Each client sends the test data as one request at a time.\n"
+      "\t-b [max_batch_size]: Specifies the maximum batch size in load generator mode. Default:8.\n"
+      "\t-d [batch_timeout_micros]: Specifies how long a request waits for a batch to fill in load generator mode. Default:1000.\n"
       "\t-h: help\n");
 }
 
 /*static*/ bool CommandLineParser::ParseArguments(PerformanceTestConfig& test_config, int argc, char* argv[]) {
   int ch;
-  while ((ch = getopt(argc, argv, "m:e:r:t:p:xvhs")) != -1) {
+  while ((ch = getopt(argc, argv, "m:e:r:t:p:c:b:d:xvhs")) != -1) {
     switch (ch) {
       case 'm':
         if (!strcmp(optarg, "duration")) {
@@ -80,6 +84,28 @@ namespace perftest {
           return false;
         }
         break;
+      case 'c': {
+        long value = strtol(optarg, nullptr, 10);
+        if (value <= 0) {
+          return false;
+        }
+        test_config.run_config.concurrent_clients = static_cast<size_t>(value);
+        break;
+      }
+      case 'b': {
+        long value = strtol(optarg, nullptr, 10);
+        if (value <= 0) {
+          return false;
+        }
+        test_config.run_config.max_batch_size = static_cast<size_t>(value);
+        break;
+      }
+      case 'd':
+        test_config.run_config.batch_timeout_micros = strtol(optarg, nullptr, 10);
+        if (test_config.run_config.batch_timeout_micros < 0) {
+          return false;
+        }
+        break;
       case 's':
         test_config.run_config.f_dump_statistics = true;
         break;
@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "load_generator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include <core/session/batching_session.h>
+
+namespace onnxruntime {
+namespace perftest {
+
+void LoadResult::Print(const std::string& name) const {
+  std::cout << name << ": " << num_requests << " requests in " << wall_time << " sec, throughput "
+            << (wall_time > 0 ? num_requests / wall_time : 0) << " requests/sec" << std::endl;
+  if (latencies.empty()) {
+    return;
+  }
+
+  std::vector<double> sorted_latencies = latencies;
+  std::sort(sorted_latencies.begin(), sorted_latencies.end());
+  const size_t total = sorted_latencies.size();
+  for (double percentile : {0.5, 0.9, 0.95, 0.99}) {
+    std::cout << "  P" << static_cast<int>(percentile * 100) << " Latency is "
+              << sorted_latencies[static_cast<size_t>(total * percentile)] * 1000 << " ms" << std::endl;
+  }
+}
+
+Status LoadGenerator::RunUnbatched(LoadResult& result) {
+  auto send_request = [this]() {
+    std::vector<MLValue> fetches;
+    return session_.Run(feeds_, output_names_, &fetches);
+  };
+  return Run(send_request, result);
+}
+
+Status LoadGenerator::RunBatched(LoadResult& result) {
+  BatchingOptions options;
+  options.max_batch_size = run_config_.max_batch_size;
+  options.batch_timeout_micros = run_config_.batch_timeout_micros;
+  BatchingSession batching_session(session_, options);
+
+  auto send_request = [this, &batching_session]() {
+    std::promise<Status> done;
+    ORT_RETURN_IF_ERROR(batching_session.Submit(feeds_, output_names_,
+                                                [&done](const Status& status, std::vector<MLValue>& /*fetches*/) {
+                                                  done.set_value(status);
+                                                }));
+    return done.get_future().get();
+  };
+  return Run(send_request, result);
+}
+
+Status LoadGenerator::Run(const std::function<Status()>& send_request, LoadResult& result) {
+  const bool fixed_duration = run_config_.test_mode == TestMode::kFixDurationMode;
+  const auto start = std::chrono::high_resolution_clock::now();
+  const auto end = start + std::chrono::seconds(run_config_.duration_in_seconds);
+  std::atomic<size_t> num_sent{0};
+
+  std::mutex mutex;
+  Status first_error;
+  std::vector<double> latencies;
+
+  std::vector<std::thread> clients;
+  for (size_t i = 0; i < run_config_.concurrent_clients; ++i) {
+    clients.emplace_back([&]() {
+      std::vector<double> client_latencies;
+      Status status;
+      while (true) {
+        if (fixed_duration ? std::chrono::high_resolution_clock::now() >= end
+                           : num_sent++ >= run_config_.repeated_times) {
+          break;
+        }
+
+        auto request_start = std::chrono::high_resolution_clock::now();
+        status = send_request();
+        if (!status.IsOK()) {
+          break;
+        }
+        std::chrono::duration<double> latency = std::chrono::high_resolution_clock::now() - request_start;
+        client_latencies.push_back(latency.count());
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      latencies.insert(latencies.end(), client_latencies.begin(), client_latencies.end());
+      if (!status.IsOK() && first_error.IsOK()) {
+        first_error = status;
+      }
+    });
+  }
+
+  for (auto& client : clients) {
+    client.join();
+  }
+
+  std::chrono::duration<double> wall_time = std::chrono::high_resolution_clock::now() - start;
+  result.num_requests = latencies.size();
+  result.wall_time = wall_time.count();
+  result.latencies = std::move(latencies);
+  return first_error;
+}
+}  // namespace perftest
+}  // namespace onnxruntime
@@ -0,0 +1,51 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <core/common/status.h>
+#include <core/framework/framework_common.h>
+#include <core/session/inference_session.h>
+
+#include "test_configuration.h"
+
+namespace onnxruntime {
+namespace perftest {
+
+struct LoadResult {
+  size_t num_requests{0};
+  double wall_time{0};            // seconds
+  std::vector<double> latencies;  // seconds, one per request
+
+  void Print(const std::string& name) const;
+};
+
+// Sends the same request to a session from run_config.concurrent_clients threads. Each client waits for its
+// request to complete before it sends the next one. Runs for run_config.duration_in_seconds, or until
+// run_config.repeated_times requests were sent, depending on the test mode.
+class LoadGenerator {
+ public:
+  LoadGenerator(InferenceSession& session, const RunConfig& run_config,
+                const NameMLValMap& feeds, const std::vector<std::string>& output_names)
+      : session_(session), run_config_(run_config), feeds_(feeds), output_names_(output_names) {}
+
+  // every client calls InferenceSession::Run directly
+  Status RunUnbatched(LoadResult& result);
+
+  // the clients submit to a BatchingSession
+  Status RunBatched(LoadResult& result);
+
+ private:
+  Status Run(const std::function<Status()>& send_request, LoadResult& result);
+
+  InferenceSession& session_;
+  const RunConfig& run_config_;
+  const NameMLValMap& feeds_;
+  const std::vector<std::string>& output_names_;
+};
+}  // namespace perftest
+}  // namespace onnxruntime
@@ -11,6 +11,7 @@
 #include "utils.h"
 #include "testenv.h"
 #include "providers.h"
+#include "load_generator.h"
 
 using namespace std::experimental::filesystem::v1;
 using onnxruntime::Status;
@@ -29,15 +30,19 @@ Status PerformanceRunner::Run() {
     session_object_->StartProfiling(performance_test_config_.run_config.profile_file);
 
   std::unique_ptr<utils::ICPUUsage> p_ICPUUsage = utils::CreateICPUUsage();
-  switch (performance_test_config_.run_config.test_mode) {
-    case TestMode::kFixDurationMode:
-      ORT_RETURN_IF_ERROR(RunFixDuration());
-      break;
-    case TestMode::KFixRepeatedTimesMode:
-      ORT_RETURN_IF_ERROR(RunRepeatedTimes());
-      break;
-    default:
-      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "unknown test mode.");
+  if (performance_test_config_.run_config.concurrent_clients > 0) {
+    ORT_RETURN_IF_ERROR(RunLoadGenerator());
+  } else {
+    switch (performance_test_config_.run_config.test_mode) {
+      case TestMode::kFixDurationMode:
+        ORT_RETURN_IF_ERROR(RunFixDuration());
+        break;
+      case TestMode::KFixRepeatedTimesMode:
+        ORT_RETURN_IF_ERROR(RunRepeatedTimes());
+        break;
+      default:
+        return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "unknown test mode.");
+    }
   }
   performance_result_.average_CPU_usage = p_ICPUUsage->GetUsage();
   performance_result_.peak_workingset_size = utils::GetPeakWorkingSetSize();
@@ -51,6 +56,35 @@ Status PerformanceRunner::Run() {
   return Status::OK();
 }
 
+Status PerformanceRunner::RunLoadGenerator() {
+  const auto& run_config = performance_test_config_.run_config;
+  LoadGenerator load_generator(*session_object_, run_config, feeds_, output_names_);
+
+  std::cout << "Load generator: " << run_config.concurrent_clients << " concurrent clients, max batch size "
+            << run_config.max_batch_size << ", batch timeout " << run_config.batch_timeout_micros << " us" << std::endl;
+
+  LoadResult unbatched;
+  ORT_RETURN_IF_ERROR(load_generator.RunUnbatched(unbatched));
+  unbatched.Print("Unbatched");
+
+  LoadResult batched;
+  ORT_RETURN_IF_ERROR(load_generator.RunBatched(batched));
+  batched.Print("Batched");
+
+  if (unbatched.wall_time > 0 && batched.wall_time > 0 && unbatched.num_requests > 0) {
+    std::cout << "Batched throughput is "
+              << (batched.num_requests / batched.wall_time) / (unbatched.num_requests / unbatched.wall_time)
+              << "x of unbatched" << std::endl;
+  }
+
+  // the result file records the latencies of the batched requests
+  performance_result_.time_costs = batched.latencies;
+  for (double latency : batched.latencies) {
+    performance_result_.total_time_cost += latency;
+  }
+  return Status::OK();
+}
+
 bool PerformanceRunner::Initialize() {
   path model_path(performance_test_config_.model_info.model_file_path);
   if (model_path.extension() != ".onnx") {
@@ -107,6 +141,7 @@ bool PerformanceRunner::Initialize() {
   for (auto feed : feeds) {
     io_binding_->BindInput(feed.first, feed.second);
   }
+  feeds_ = feeds;
   auto outputs = session_object_->GetModelOutputs();
   auto status = outputs.first;
   if (!outputs.first.IsOK()) {
@@ -121,6 +156,7 @@ bool PerformanceRunner::Initialize() {
     auto output = outputs.second->at(i_output);
     if (!output) continue;
     io_binding_->BindOutput(output->Name(), output_mlvalues[i_output]);
+    output_names_.push_back(output->Name());
   }
 
   return true;
@@ -79,6 +79,8 @@ class PerformanceRunner {
  private:
   bool Initialize();
 
+  Status RunLoadGenerator();
+
   inline Status RunOneIteration(bool isWarmup = false) {
     auto start = std::chrono::high_resolution_clock::now();
     ORT_RETURN_IF_ERROR(session_object_->Run(*io_binding_));
@@ -116,6 +118,10 @@ class PerformanceRunner {
 
   std::shared_ptr<::onnxruntime::InferenceSession> session_object_;
   std::unique_ptr<IOBinding> io_binding_;
+
+  // used by the load generator
+  NameMLValMap feeds_;
+  std::vector<std::string> output_names_;
 };
 }  // namespace perftest
 }  // namespace onnxruntime
@@ -41,6 +41,12 @@ struct RunConfig {
   bool f_dump_statistics{false};
   bool f_verbose{false};
   bool enable_sequential_execution{true};
+
+  // load generator mode: if non-zero, this many clients send requests concurrently,
+  // first straight to the session and then through a BatchingSession.
+  size_t concurrent_clients{0};
+  size_t max_batch_size{8};
+  int64_t batch_timeout_micros{1000};
 };
 
 struct PerformanceTestConfig {
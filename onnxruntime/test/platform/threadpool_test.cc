@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/platform/threadpool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+std::unique_ptr<concurrency::ThreadPool> CreateThreadPool(int num_threads) {
+  concurrency::ThreadPoolOptions options;
+  options.num_threads = num_threads;
+  return std::make_unique<concurrency::ThreadPool>("test", options);
+}
+}  // namespace
+
+TEST(ThreadPoolTest, ParallelForCoversRangeOnce) {
+  auto tp = CreateThreadPool(3);
+  EXPECT_EQ(tp->NumThreads(), 3);
+
+  for (std::ptrdiff_t grain : {1, 7, 100, 10000}) {
+    std::vector<std::atomic<int>> counts(1000);
+    for (auto& count : counts) {
+      count = 0;
+    }
+
+    tp->ParallelFor(0, static_cast<std::ptrdiff_t>(counts.size()), grain,
+                    [&counts, grain](std::ptrdiff_t first, std::ptrdiff_t last) {
+                      EXPECT_LT(first, last);
+                      EXPECT_TRUE(last - first >= grain || last == static_cast<std::ptrdiff_t>(counts.size()));
+                      for (std::ptrdiff_t i = first; i < last; i++) {
+                        counts[i]++;
+                      }
+                    });
+
+    for (size_t i = 0; i < counts.size(); i++) {
+      EXPECT_EQ(counts[i], 1) << "index " << i << " grain " << grain;
+    }
+  }
+}
+
+TEST(ThreadPoolTest, ParallelForEmptyRange) {
+  auto tp = CreateThreadPool(2);
+  bool called = false;
+  tp->ParallelFor(5, 5, 1, [&called](std::ptrdiff_t, std::ptrdiff_t) { called = true; });
+  EXPECT_FALSE(called);
+}
+
+TEST(ThreadPoolTest, TryParallelForWithoutPoolRunsInline) {
+  std::ptrdiff_t begin = -1;
+  std::ptrdiff_t end = -1;
+  int calls = 0;
+  concurrency::ThreadPool::TryParallelFor(nullptr, 3, 42, 1, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+    begin = first;
+    end = last;
+    calls++;
+  });
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(begin, 3);
+  EXPECT_EQ(end, 42);
+}
+
+TEST(ThreadPoolTest, NestedParallelFor) {
+  auto tp = CreateThreadPool(2);
+  std::atomic<int> total{0};
+
+  tp->ParallelFor(0, 16, 1, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+    for (std::ptrdiff_t i = first; i < last; i++) {
+      tp->ParallelFor(0, 64, 1, [&total](std::ptrdiff_t inner_first, std::ptrdiff_t inner_last) {
+        total += static_cast<int>(inner_last - inner_first);
+      });
+    }
+  });
+
+  EXPECT_EQ(total, 16 * 64);
+}
+
+TEST(ThreadPoolTest, ParallelForPropagatesException) {
+  auto tp = CreateThreadPool(3);
+  std::atomic<int> executed{0};
+
+  EXPECT_THROW(tp->ParallelFor(0, 100, 1,
+                               [&executed](std::ptrdiff_t first, std::ptrdiff_t last) {
+                                 executed += static_cast<int>(last - first);
+                                 if (first <= 50 && 50 < last) {
+                                   throw std::runtime_error("failed block");
+                                 }
+                               }),
+               std::runtime_error);
+
+  // the failure of one block does not prevent the remaining blocks from running.
+  EXPECT_EQ(executed, 100);
+
+  // the pool is still usable afterwards.
+  std::atomic<int> count{0};
+  tp->ParallelFor(0, 10, 1, [&count](std::ptrdiff_t first, std::ptrdiff_t last) {
+    count += static_cast<int>(last - first);
+  });
+  EXPECT_EQ(count, 10);
+}
+
+TEST(ThreadPoolTest, ScheduleRunsOnWorkerThreads) {
+  auto tp = CreateThreadPool(2);
+  std::atomic<int> done{0};
+  std::atomic<int> on_worker{0};
+
+  for (int i = 0; i < 8; i++) {
+    tp->Schedule([&]() {
+      if (tp->CurrentThreadId() >= 0) {
+        on_worker++;
+      }
+      done++;
+    });
+  }
+
+  while (done < 8) {
+    std::this_thread::yield();
+  }
+
+  EXPECT_EQ(on_worker, 8);
+  EXPECT_EQ(tp->CurrentThreadId(), -1);
+}
+
+TEST(ThreadPoolTest, InvalidThreadCount) {
+  concurrency::ThreadPoolOptions options;
+  options.num_threads = 0;
+  EXPECT_THROW(concurrency::ThreadPool("test", options), OnnxRuntimeException);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -61,19 +61,22 @@ TEST(MathOpTest, MatMul) {
        {20, 23, 26, 29, 56, 68, 80, 92, 92, 113, 134, 155, 128, 158, 188, 218}},
   };
 
-  for (auto t : testcases) {
-    OpTester test("MatMul");
+  // run each case again with B as an initializer, which lets the kernel prepack it
+  for (bool b_is_initializer : {false, true}) {
+    for (auto t : testcases) {
+      OpTester test("MatMul");
 
-    int64_t size0 = TensorShape::ReinterpretBaseType(t.input0_dims).SizeHelper(0, t.input0_dims.size());
-    std::vector<float> input0_vals(vals.cbegin(), vals.cbegin() + size0);
-    test.AddInput<float>("A", t.input0_dims, input0_vals);
+      int64_t size0 = TensorShape::ReinterpretBaseType(t.input0_dims).SizeHelper(0, t.input0_dims.size());
+      std::vector<float> input0_vals(vals.cbegin(), vals.cbegin() + size0);
+      test.AddInput<float>("A", t.input0_dims, input0_vals);
 
-    int64_t size1 = TensorShape::ReinterpretBaseType(t.input1_dims).SizeHelper(0, t.input1_dims.size());
-    std::vector<float> input1_vals(vals.cbegin(), vals.cbegin() + size1);
-    test.AddInput<float>("B", t.input1_dims, input1_vals);
+      int64_t size1 = TensorShape::ReinterpretBaseType(t.input1_dims).SizeHelper(0, t.input1_dims.size());
+      std::vector<float> input1_vals(vals.cbegin(), vals.cbegin() + size1);
+      test.AddInput<float>("B", t.input1_dims, input1_vals, b_is_initializer);
 
-    test.AddOutput<float>("Y", t.expected_dims, t.expected_vals);
-    test.Run();
+      test.AddOutput<float>("Y", t.expected_dims, t.expected_vals);
+      test.Run();
+    }
   }
 }
 
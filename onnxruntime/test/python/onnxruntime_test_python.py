@@ -2,6 +2,7 @@
 # Licensed under the MIT License.
 
 # -*- coding: UTF-8 -*-
+import gc
 import unittest
 import os
 import sys
@@ -72,10 +73,86 @@ class TestInferenceSession(unittest.TestCase):
         output_expected = np.array([[5.0], [11.0], [17.0]], dtype=np.float32)
         np.testing.assert_allclose(output_expected, res[0], rtol=1e-05, atol=1e-08)
 
+    def testRunModelNonContiguousInput(self):
+        sess = onnxrt.InferenceSession(self.get_name("mul_1.pb"))
+        x = np.asfortranarray(np.array([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]], dtype=np.float32))
+        res = sess.run(["Y"], {"X": x})
+        output_expected = np.array([[1.0, 4.0], [9.0, 16.0], [25.0, 36.0]], dtype=np.float32)
+        np.testing.assert_allclose(output_expected, res[0], rtol=1e-05, atol=1e-08)
+
+    def testOutputOutlivesSession(self):
+        sess = onnxrt.InferenceSession(self.get_name("mul_1.pb"))
+        x = np.array([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]], dtype=np.float32)
+        res = sess.run(["Y"], {"X": x})
+        del sess
+        output_expected = np.array([[1.0, 4.0], [9.0, 16.0], [25.0, 36.0]], dtype=np.float32)
+        np.testing.assert_allclose(output_expected, res[0], rtol=1e-05, atol=1e-08)
+
+    def testIOBinding(self):
+        sess = onnxrt.InferenceSession(self.get_name("mul_1.pb"))
+        x = np.array([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]], dtype=np.float32)
+        y = np.zeros((3, 2), dtype=np.float32)
+        binding = sess.io_binding()
+        binding.bind_input("X", x)
+        binding.bind_output("Y", y)
+        sess.run_with_iobinding(binding)
+        np.testing.assert_allclose(np.array([[1.0, 4.0], [9.0, 16.0], [25.0, 36.0]], dtype=np.float32), y,
+                                   rtol=1e-05, atol=1e-08)
+        self.assertTrue(binding.get_outputs()[0] is y)
+
+        # the bound arrays are used in place, so updating the input is seen by the next run
+        x *= 2.0
+        sess.run_with_iobinding(binding)
+        np.testing.assert_allclose(np.array([[4.0, 16.0], [36.0, 64.0], [100.0, 144.0]], dtype=np.float32), y,
+                                   rtol=1e-05, atol=1e-08)
+
+        # an output bound without an array is allocated by the session
+        binding.bind_output("Y")
+        sess.run_with_iobinding(binding)
+        np.testing.assert_allclose(np.array([[4.0, 16.0], [36.0, 64.0], [100.0, 144.0]], dtype=np.float32),
+                                   binding.get_outputs()[0], rtol=1e-05, atol=1e-08)
+
+        with self.assertRaises(RuntimeError):
+            binding.bind_output("Y", np.zeros((2, 3), dtype=np.float32).T)
+        # arrays the session can't write into in place aren't copied either
+        with self.assertRaises(RuntimeError):
+            binding.bind_output("Y", np.array([["a", "b"], ["c", "d"], ["e", "f"]]))
+
     def testRunDevice(self):
         device = onnxrt.get_device()
         self.assertTrue('CPU' in device or 'GPU' in device)
 
+    def testMlasIsaLevel(self):
+        report = onnxrt.get_mlas_kernel_selection()
+        self.assertTrue('Sgemm' in report)
+        supported = report['SupportedIsaLevel']
+
+        with self.assertRaises(RuntimeError):
+            onnxrt.set_mlas_isa_level('not_an_isa')
+
+        # the level can't change under a session, which laid out its weights for the current kernels
+        sess = onnxrt.InferenceSession(self.get_name("mul_1.pb"))
+        onnxrt.set_mlas_isa_level(report['IsaLevel'])
+        if report['IsaLevel'] != 'generic':
+            with self.assertRaises(RuntimeError):
+                onnxrt.set_mlas_isa_level('generic')
+        self.assertEqual(onnxrt.get_mlas_kernel_selection()['IsaLevel'], report['IsaLevel'])
+
+        del sess
+        gc.collect()
+        onnxrt.set_mlas_isa_level('generic')
+        self.assertEqual(onnxrt.get_mlas_kernel_selection()['IsaLevel'], 'generic')
+        sess = onnxrt.InferenceSession(self.get_name("mul_1.pb"))
+        x = np.array([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]], dtype=np.float32)
+        res = sess.run([sess.get_outputs()[0].name], {sess.get_inputs()[0].name: x})
+        np.testing.assert_allclose(np.array([[1.0, 4.0], [9.0, 16.0], [25.0, 36.0]], dtype=np.float32), res[0],
+                                   rtol=1e-05, atol=1e-08)
+
+        del sess
+        gc.collect()
+        onnxrt.set_mlas_isa_level(supported)
+        self.assertEqual(onnxrt.get_mlas_kernel_selection()['IsaLevel'], supported)
+
     def testRunModelSymbolicInput(self):
         sess = onnxrt.InferenceSession(self.get_name("matmul_2.pb"))
         x = np.array([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]], dtype=np.float32)
@@ -355,6 +432,25 @@ class TestInferenceSession(unittest.TestCase):
                     self.assertTrue(tag in lines[i])
             self.assertTrue(']' in lines[8])
 
+    def testMetrics(self):
+        so = onnxrt.SessionOptions()
+        so.enable_metrics = True
+        sess = onnxrt.InferenceSession(self.get_name("mul_1.pb"), sess_options=so)
+        x = np.array([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]], dtype=np.float32)
+        sess.run([], {'X': x})
+        sess.run([], {'X': x})
+
+        metrics = sess.get_metrics()
+        self.assertEqual(metrics['runs']['count'], 2)
+        self.assertEqual(metrics['op_types']['Mul']['count'], 2)
+        self.assertEqual(metrics['nodes'][0]['op_type'], 'Mul')
+        self.assertGreaterEqual(metrics['runs']['p99_us'], metrics['runs']['p50_us'])
+
+        sess.reset_metrics()
+        metrics = sess.get_metrics()
+        self.assertEqual(metrics['runs']['count'], 0)
+        self.assertEqual(metrics['nodes'], [])
+
     def testDictVectorizer(self):
         sess = onnxrt.InferenceSession(self.get_name("pipeline_vectorize.onnx"))
         input_name = sess.get_inputs()[0].name
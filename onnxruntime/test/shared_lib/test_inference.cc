@@ -224,6 +224,69 @@ TEST_F(CApiTest, create_tensor_with_data) {
   OrtReleaseTypeInfo(type_info);
 }
 
+TEST_F(CApiTest, io_binding) {
+  SessionOptionsWrapper sf(env);
+  std::unique_ptr<OrtSession, decltype(&OrtReleaseSession)>
+      inference_session(sf.OrtCreateSession(MODEL_URI), OrtReleaseSession);
+  std::unique_ptr<OrtIoBinding, decltype(&OrtReleaseIoBinding)> binding(nullptr, OrtReleaseIoBinding);
+  {
+    OrtIoBinding* binding_ptr;
+    ORT_THROW_ON_ERROR(OrtCreateIoBinding(inference_session.get(), &binding_ptr));
+    binding.reset(binding_ptr);
+  }
+
+  // bind caller owned buffers on both sides
+  float values_x[] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  float values_y[6] = {};
+  std::vector<size_t> dims = {3, 2};
+  OrtAllocatorInfo* info;
+  ORT_THROW_ON_ERROR(OrtCreateCpuAllocatorInfo(OrtDeviceAllocator, OrtMemTypeDefault, &info));
+  std::unique_ptr<OrtValue, decltype(&OrtReleaseValue)> value_x(
+      OrtCreateTensorWithDataAsOrtValue(info, values_x, sizeof(values_x), dims, ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT),
+      OrtReleaseValue);
+  std::unique_ptr<OrtValue, decltype(&OrtReleaseValue)> value_y(
+      OrtCreateTensorWithDataAsOrtValue(info, values_y, sizeof(values_y), dims, ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT),
+      OrtReleaseValue);
+  OrtReleaseAllocatorInfo(info);
+  ORT_THROW_ON_ERROR(OrtBindInput(binding.get(), "X", value_x.get()));
+  ORT_THROW_ON_ERROR(OrtBindOutput(binding.get(), "Y", value_y.get()));
+
+  // the binding is reused with new data in the same input buffer and the result lands in the output buffer
+  for (int run = 0; run != 2; ++run) {
+    for (size_t i = 0; i != 6; ++i) {
+      values_x[i] = static_cast<float>(i + 1 + run);
+    }
+    ORT_THROW_ON_ERROR(OrtRunWithBinding(inference_session.get(), nullptr, binding.get()));
+    for (size_t i = 0; i != 6; ++i) {
+      ASSERT_EQ(values_x[i] * values_x[i], values_y[i]);
+    }
+  }
+
+  OrtValue* output;
+  ORT_THROW_ON_ERROR(OrtGetBoundOutputValues(binding.get(), &output, 1));
+  void* output_data;
+  ORT_THROW_ON_ERROR(OrtGetTensorMutableData(output, &output_data));
+  ASSERT_EQ(output_data, values_y);
+  OrtReleaseValue(output);
+
+  // an output bound without a value is allocated by the session
+  ORT_THROW_ON_ERROR(OrtBindOutput(binding.get(), "Y", nullptr));
+  ORT_THROW_ON_ERROR(OrtRunWithBinding(inference_session.get(), nullptr, binding.get()));
+  ORT_THROW_ON_ERROR(OrtGetBoundOutputValues(binding.get(), &output, 1));
+  float* f;
+  ORT_THROW_ON_ERROR(OrtGetTensorMutableData(output, (void**)&f));
+  ASSERT_NE(f, values_y);
+  for (size_t i = 0; i != 6; ++i) {
+    ASSERT_EQ(values_x[i] * values_x[i], f[i]);
+  }
+  OrtReleaseValue(output);
+
+  OrtStatus* status = OrtGetBoundOutputValues(binding.get(), &output, 2);
+  ASSERT_NE(status, nullptr);
+  ASSERT_EQ(OrtGetErrorCode(status), ORT_INVALID_ARGUMENT);
+  OrtReleaseStatus(status);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();